@@ -3,6 +3,11 @@ cbuffer cbPerObject : register(b0)
     float4x4 WVP;
 };
 
+cbuffer cbPerFrame : register(b1)
+{
+    float4x4 ViewProjection;
+};
+
 struct VS_OUTPUT
 {
     float4 Pos : SV_POSITION;
@@ -19,6 +24,20 @@ VS_OUTPUT VS(float4 inPos : POSITION, float4 inColor : COLOR)
     return output;
 }
 
+// Instanced variant: the world matrix and a tint come from the per-instance stream in slot 1
+VS_OUTPUT VSInstanced(float4 inPos : POSITION, float4 inColor : COLOR0,
+    float4 world0 : WORLD0, float4 world1 : WORLD1, float4 world2 : WORLD2, float4 world3 : WORLD3,
+    float4 instanceColor : COLOR1)
+{
+    VS_OUTPUT output;
+
+    float4x4 world = float4x4(world0, world1, world2, world3);
+    output.Pos = mul(mul(inPos, world), ViewProjection);
+    output.Color = inColor * instanceColor;
+
+    return output;
+}
+
 float4 PS(VS_OUTPUT input) : SV_TARGET
 {
     return input.Color;
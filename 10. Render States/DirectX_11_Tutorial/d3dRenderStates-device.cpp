@@ -0,0 +1,290 @@
+// Render States on top of the RenderDevice layer in Common/.
+// Same scene and keys as d3dRenderStates-exercise.cpp, but the Direct3D code lives in
+// D3D11RenderDevice and the scene in RenderStatesScene, so this file only owns the window.
+// Excluded from the build by default; swap it with d3dRenderStates-exercise.cpp to run it.
+// Pass "-benchmark N" to render N frames with FrameBenchmark and write frame_benchmark.json,
+// and "-instanced N" to draw a grid of N cubes with one DrawIndexedInstanced instead.
+// "-parallel N" draws the grid one cube at a time, recorded on deferred contexts by every core.
+// "-packed" stores the cube as 12-byte SNORM16 + RGBA8 vertices, "-packed half" as half floats.
+// Compiled shaders are kept in ShaderCache.bin in the working directory.
+
+#include <windows.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+
+#include "../../Common/D3D11RenderDevice.h"
+#include "../../Common/FrameBenchmark.h"
+#include "../../Common/InstancedCubesScene.h"
+#include "../../Common/JobSystem.h"
+#include "../../Common/ParallelRecorder.h"
+#include "../../Common/RenderStatesScene.h"
+#include "../../Common/ShaderCache.h"
+
+// Window constants
+constexpr LPCTSTR WndClassName = L"DirectXWindow";
+constexpr int Width = 800;
+constexpr int Height = 600;
+
+// Global Declarations
+D3D11RenderDevice g_RenderDevice;
+ShaderCache g_ShaderCache("ShaderCache.bin");
+RenderStatesScene g_Scene;
+std::unique_ptr<InstancedCubesScene> g_InstancedScene;
+std::unique_ptr<JobSystem> g_JobSystem;
+std::unique_ptr<ParallelRecorder> g_ParallelRecorder;
+Scene* g_ActiveScene = &g_Scene;
+RECT g_WindowRect = {};
+bool g_Resizing = false;
+
+// Function Prototypes
+bool InitializeWindow(HINSTANCE hInstance, int nCmdShow);
+void ResizeBuffers(HWND hWnd);
+void ToggleFullscreen(HWND hWnd);
+bool RunBenchmark(uint32_t frames);
+LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam);
+
+// Entry point
+int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine, int nCmdShow)
+{
+    if (!InitializeWindow(hInstance, nCmdShow))
+    {
+        MessageBox(nullptr, L"Window Initialization Failed", L"Error", MB_OK);
+        return 0;
+    }
+
+    // A missing or stale cache file only means the shaders are compiled this time
+    g_ShaderCache.Load();
+    g_RenderDevice.SetShaderCache(&g_ShaderCache);
+
+    if (!g_RenderDevice.Initialize(GetActiveWindow()))
+    {
+        MessageBox(nullptr, L"Direct3D Initialization Failed", L"Error", MB_OK);
+        return 0;
+    }
+
+    if (const char* packed = std::strstr(lpCmdLine, "-packed"))
+        g_Scene.SetVertexFormat(std::strncmp(packed + 7, " half", 5) == 0 ? VertexFormat::Half16 : VertexFormat::Snorm16);
+
+    if (const char* instanced = std::strstr(lpCmdLine, "-instanced"))
+    {
+        int cubeCount = std::atoi(instanced + 10);
+        g_InstancedScene = std::make_unique<InstancedCubesScene>(cubeCount > 0 ? static_cast<uint32_t>(cubeCount) : 10000);
+        g_ActiveScene = g_InstancedScene.get();
+    }
+    else if (const char* parallel = std::strstr(lpCmdLine, "-parallel"))
+    {
+        int cubeCount = std::atoi(parallel + 9);
+        g_InstancedScene = std::make_unique<InstancedCubesScene>(cubeCount > 0 ? static_cast<uint32_t>(cubeCount) : 10000, false);
+
+        // A few chunks per core, so one slow chunk does not leave the other cores idle
+        g_JobSystem = std::make_unique<JobSystem>();
+        g_ParallelRecorder = std::make_unique<ParallelRecorder>(g_RenderDevice, *g_JobSystem);
+        if (!g_ParallelRecorder->Initialize(4 * g_JobSystem->GetWorkerCount()))
+        {
+            MessageBox(nullptr, L"Deferred Context Creation Failed", L"Error", MB_OK);
+            return 0;
+        }
+        g_InstancedScene->SetParallelRecorder(g_ParallelRecorder.get());
+        g_ActiveScene = g_InstancedScene.get();
+    }
+
+    if (!g_ActiveScene->Initialize(g_RenderDevice))
+    {
+        MessageBox(nullptr, L"Scene Initialization Failed", L"Error", MB_OK);
+        return 0;
+    }
+    g_ShaderCache.Save();
+
+    if (const char* benchmark = std::strstr(lpCmdLine, "-benchmark"))
+    {
+        int frames = std::atoi(benchmark + 10);
+        bool succeeded = RunBenchmark(frames > 0 ? static_cast<uint32_t>(frames) : 1000);
+        g_RenderDevice.Cleanup();
+        return succeeded ? 0 : 1;
+    }
+
+    ULONGLONG dwTimeStart = GetTickCount64();
+
+    // Main message loop
+    MSG msg = { 0 };
+    while (WM_QUIT != msg.message)
+    {
+        if (PeekMessage(&msg, nullptr, 0, 0, PM_REMOVE))
+        {
+            TranslateMessage(&msg);
+            DispatchMessage(&msg);
+        }
+        else
+        {
+            g_ActiveScene->Update((GetTickCount64() - dwTimeStart) / 1000.0f);
+            g_ActiveScene->Draw(g_RenderDevice.GetImmediateContext());
+            if (!g_RenderDevice.Present())
+            {
+                MessageBox(GetActiveWindow(), L"Failed to present swap chain buffer", L"Error", MB_OK);
+                break;
+            }
+        }
+    }
+
+    g_RenderDevice.Cleanup();
+    return static_cast<int>(msg.wParam);
+}
+
+bool InitializeWindow(HINSTANCE hInstance, int nCmdShow)
+{
+    WNDCLASSEX wcex = { 0 };
+    wcex.cbSize = sizeof(WNDCLASSEX);
+    wcex.style = CS_HREDRAW | CS_VREDRAW;
+    wcex.lpfnWndProc = WndProc;
+    wcex.hInstance = hInstance;
+    wcex.hCursor = LoadCursor(nullptr, IDC_ARROW);
+    wcex.hbrBackground = reinterpret_cast<HBRUSH>(COLOR_WINDOW + 1);
+    wcex.lpszClassName = WndClassName;
+
+    if (!RegisterClassEx(&wcex))
+        return false;
+
+    RECT rc = { 0, 0, Width, Height };
+    AdjustWindowRect(&rc, WS_OVERLAPPEDWINDOW, FALSE);
+
+    HWND hWnd = CreateWindow(WndClassName, L"DirectX 11 Demo", WS_OVERLAPPEDWINDOW,
+        CW_USEDEFAULT, CW_USEDEFAULT, rc.right - rc.left, rc.bottom - rc.top, nullptr, nullptr, hInstance, nullptr);
+
+    if (!hWnd)
+        return false;
+
+    ShowWindow(hWnd, nCmdShow);
+    UpdateWindow(hWnd);
+
+    return true;
+}
+
+bool RunBenchmark(uint32_t frames)
+{
+    FrameBenchmarkOptions options;
+    options.Frames = frames;
+    FrameBenchmarkResult result = RunFrameBenchmark(*g_ActiveScene, g_RenderDevice, options);
+
+    FILE* file = nullptr;
+    if (fopen_s(&file, "frame_benchmark.json", "wb") != 0 || !file)
+        return false;
+
+    std::string json = FrameBenchmarkToJson(result);
+    std::fwrite(json.data(), 1, json.size(), file);
+    std::fputc('\n', file);
+    std::fclose(file);
+    return result.Frames == frames;
+}
+
+void ResizeBuffers(HWND hWnd)
+{
+    RECT rc;
+    GetClientRect(hWnd, &rc);
+    UINT width = rc.right - rc.left;
+    UINT height = rc.bottom - rc.top;
+
+    if (!g_RenderDevice.Resize(width, height))
+    {
+        MessageBox(hWnd, L"Failed to resize swap chain buffers", L"Error", MB_OK);
+        return;
+    }
+    g_ActiveScene->Resize(width, height);
+}
+
+void ToggleFullscreen(HWND hWnd)
+{
+    IDXGISwapChain1* swapChain = g_RenderDevice.GetSwapChain();
+    BOOL fullscreen;
+    HRESULT hr = swapChain->GetFullscreenState(&fullscreen, nullptr);
+    if (FAILED(hr))
+    {
+        MessageBox(hWnd, L"Failed to get fullscreen state", L"Error", MB_OK);
+        return;
+    }
+
+    if (fullscreen)
+    {
+        // Switch to windowed mode
+        hr = swapChain->SetFullscreenState(FALSE, nullptr);
+        if (FAILED(hr))
+        {
+            MessageBox(hWnd, L"Failed to switch to windowed mode", L"Error", MB_OK);
+            return;
+        }
+        SetWindowLong(hWnd, GWL_STYLE, WS_OVERLAPPEDWINDOW);
+        SetWindowPos(hWnd, HWND_TOP,
+            g_WindowRect.left, g_WindowRect.top,
+            g_WindowRect.right - g_WindowRect.left,
+            g_WindowRect.bottom - g_WindowRect.top,
+            SWP_FRAMECHANGED | SWP_SHOWWINDOW);
+    }
+    else
+    {
+        // Switch to fullscreen mode
+        GetWindowRect(hWnd, &g_WindowRect);
+        SetWindowLong(hWnd, GWL_STYLE, WS_POPUP);
+        hr = swapChain->SetFullscreenState(TRUE, nullptr);
+        if (FAILED(hr))
+        {
+            MessageBox(hWnd, L"Failed to switch to fullscreen mode", L"Error", MB_OK);
+            return;
+        }
+    }
+
+    ResizeBuffers(hWnd);
+}
+
+LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
+{
+    switch (message)
+    {
+    case WM_KEYDOWN:
+        switch (wParam)
+        {
+        case '1':  // Toggle first cube between solid and wireframe
+            g_Scene.ToggleFillMode(0);
+            return 0;
+        case '2':  // Toggle second cube between solid and wireframe
+            g_Scene.ToggleFillMode(1);
+            return 0;
+        case '3':  // Toggle culling
+            g_Scene.ToggleCulling();
+            return 0;
+        case VK_ESCAPE:
+            DestroyWindow(hWnd);
+            return 0;
+        case VK_F11:
+            ToggleFullscreen(hWnd);
+            return 0;
+        }
+        return 0;
+    case WM_DESTROY:
+        PostQuitMessage(0);
+        return 0;
+    case WM_ENTERSIZEMOVE:
+        g_Resizing = true;
+        return 0;
+    case WM_EXITSIZEMOVE:
+        g_Resizing = false;
+        ResizeBuffers(hWnd);
+        return 0;
+    case WM_SIZE:
+        if (g_RenderDevice.GetD3DDevice())
+        {
+            if (wParam == SIZE_MINIMIZED)
+            {
+                return 0;
+            }
+            else if (wParam == SIZE_MAXIMIZED || (wParam == SIZE_RESTORED && !g_Resizing))
+            {
+                ResizeBuffers(hWnd);
+            }
+        }
+        return 0;
+    default:
+        return DefWindowProc(hWnd, message, wParam, lParam);
+    }
+}
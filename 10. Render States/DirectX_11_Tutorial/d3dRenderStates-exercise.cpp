@@ -9,6 +9,8 @@
 #include <d3dcompiler.h>
 #include <wrl/client.h>
 
+#include "../../Common/D3D11StateCache.h"
+
 using namespace Microsoft::WRL;
 using namespace DirectX;
 
@@ -29,6 +31,7 @@ ComPtr<ID3D11RasterizerState> g_pRasterizerStateSolid;
 ComPtr<ID3D11RasterizerState> g_pRasterizerStateWireframe;
 ComPtr<ID3D11RasterizerState> g_pCurrentRasterizerState1;
 ComPtr<ID3D11RasterizerState> g_pCurrentRasterizerState2;
+D3D11StateCache g_StateCache;
 
 // Window constants
 constexpr LPCTSTR WndClassName = L"DirectXWindow";
@@ -239,6 +242,7 @@ void CleanupDirect3D()
     g_pRasterizerStateWireframe.Reset();
     g_pCurrentRasterizerState1.Reset();
     g_pCurrentRasterizerState2.Reset();
+    g_StateCache.Clear();
 }
 
 bool InitializeScene()
@@ -379,7 +383,8 @@ bool InitializeScene()
     // Initialize the projection matrix
     g_Projection = XMMatrixPerspectiveFovLH(XM_PIDIV2, Width / (FLOAT)Height, 0.01f, 100.0f);
 
-    // Create the rasterizer states
+    // Create the rasterizer states through the cache so toggles reuse them
+    g_StateCache.SetDevice(g_pd3dDevice.Get());
     D3D11_RASTERIZER_DESC rasterDesc;
     ZeroMemory(&rasterDesc, sizeof(D3D11_RASTERIZER_DESC));
 
@@ -388,15 +393,15 @@ bool InitializeScene()
     rasterDesc.CullMode = D3D11_CULL_BACK;
     rasterDesc.FrontCounterClockwise = false;
     rasterDesc.DepthClipEnable = true;
-    hr = g_pd3dDevice->CreateRasterizerState(&rasterDesc, &g_pRasterizerStateSolid);
-    if (FAILED(hr))
+    g_pRasterizerStateSolid = g_StateCache.GetRasterizerState(rasterDesc);
+    if (!g_pRasterizerStateSolid)
         return false;
 
     // Wireframe rasterizer state
     rasterDesc.FillMode = D3D11_FILL_WIREFRAME;
     rasterDesc.CullMode = D3D11_CULL_NONE;
-    hr = g_pd3dDevice->CreateRasterizerState(&rasterDesc, &g_pRasterizerStateWireframe);
-    if (FAILED(hr))
+    g_pRasterizerStateWireframe = g_StateCache.GetRasterizerState(rasterDesc);
+    if (!g_pRasterizerStateWireframe)
         return false;
 
     g_pCurrentRasterizerState1 = g_pRasterizerStateSolid;
@@ -550,6 +555,7 @@ bool RecreateDevice()
     g_pRasterizerStateWireframe.Reset();
     g_pCurrentRasterizerState1.Reset();
     g_pCurrentRasterizerState2.Reset();
+    g_StateCache.Clear();
 
     // Recreate the device and swap chain
     if (!InitializeDirect3D())
@@ -707,10 +713,11 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
             D3D11_RASTERIZER_DESC desc;
             g_pCurrentRasterizerState1->GetDesc(&desc);
             desc.CullMode = (desc.CullMode == D3D11_CULL_BACK) ? D3D11_CULL_NONE : D3D11_CULL_BACK;
-            g_pd3dDevice->CreateRasterizerState(&desc, &g_pCurrentRasterizerState1);
+            g_pCurrentRasterizerState1 = g_StateCache.GetRasterizerState(desc);
             g_pCurrentRasterizerState2->GetDesc(&desc);
             desc.CullMode = (desc.CullMode == D3D11_CULL_BACK) ? D3D11_CULL_NONE : D3D11_CULL_BACK;
-            g_pd3dDevice->CreateRasterizerState(&desc, &g_pCurrentRasterizerState2);
+            g_pCurrentRasterizerState2 = g_StateCache.GetRasterizerState(desc);
+            return 0;
         }
         }
         if (wParam == VK_ESCAPE)
@@ -0,0 +1,461 @@
+// Checks and timings of Bvh, the bounding volume hierarchy over object boxes.
+// The checks validate the tree (every object in one leaf, nodes holding their
+// children, contiguous ranges, parents), that serial and parallel builds give
+// the same tree, that frustum, ray and box queries return what a flat loop
+// over every object returns, and that Refit after moving objects touches only
+// their ancestors and leaves every box tight. The timings build over 1M boxes
+// on 1 to N threads, refit after moving part of them, and compare queries
+// with the flat list: FrustumCulling's CullBounds and loops over every box.
+//
+// Build (from the repository root):
+//   g++ -std=c++20 -O2 -mavx2 -pthread -ICommon Benchmarks/BvhBenchmark.cpp Common/Bvh.cpp
+//       Common/FrustumCulling.cpp Common/JobSystem.cpp -o BvhBenchmark
+//
+// Usage: BvhBenchmark [--objects N] [--threads N]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "Bvh.h"
+#include "FrustumCulling.h"
+#include "JobSystem.h"
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    int g_Failures = 0;
+
+    void Check(bool condition, const char* what)
+    {
+        if (!condition)
+        {
+            std::fprintf(stderr, "FAILED: %s\n", what);
+            ++g_Failures;
+        }
+    }
+
+    double ElapsedMs(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    // A city: boxes spread over the ground, up to 40 units high, denser towards the middle
+    BoundsArray CityBounds(size_t count, float halfSize, uint32_t seed)
+    {
+        std::mt19937 random(seed);
+        std::normal_distribution<float> position(0.0f, halfSize * 0.4f);
+        std::uniform_real_distribution<float> height(0.0f, 40.0f);
+        std::uniform_real_distribution<float> extent(0.5f, 5.0f);
+        BoundsArray bounds(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            float x = std::clamp(position(random), -halfSize, halfSize);
+            float z = std::clamp(position(random), -halfSize, halfSize);
+            bounds.Set(i, { x, height(random), z }, { extent(random), extent(random), extent(random) });
+        }
+        return bounds;
+    }
+
+    BvhBox ObjectBox(const BoundsArray& bounds, size_t object)
+    {
+        Float3 c = bounds.GetCenter(object), e = bounds.GetExtents(object);
+        return { { c.x - e.x, c.y - e.y, c.z - e.z }, { c.x + e.x, c.y + e.y, c.z + e.z } };
+    }
+
+    bool BoxContains(const BvhBox& outer, const BvhBox& inner)
+    {
+        return inner.Min.x >= outer.Min.x && inner.Max.x <= outer.Max.x && inner.Min.y >= outer.Min.y &&
+            inner.Max.y <= outer.Max.y && inner.Min.z >= outer.Min.z && inner.Max.z <= outer.Max.z;
+    }
+
+    bool BoxEquals(const BvhBox& a, const BvhBox& b)
+    {
+        return BoxContains(a, b) && BoxContains(b, a);
+    }
+
+    // Structure of the tree over bounds; tight also requires every box to be the exact union
+    bool Validate(const Bvh& bvh, const BoundsArray& bounds, bool tight)
+    {
+        const std::vector<BvhNode>& nodes = bvh.GetNodes();
+        const std::vector<uint32_t>& order = bvh.GetObjectOrder();
+        if (bounds.GetCount() == 0)
+            return nodes.empty();
+        if (order.size() != bounds.GetCount() || nodes[0].First != 0 || nodes[0].Count != order.size() ||
+            bvh.GetParent(0) != Bvh::NoNode || bvh.GetDepth() >= Bvh::MaxDepth)
+        {
+            return false;
+        }
+
+        std::vector<int> seen(order.size(), 0);
+        for (uint32_t object : order)
+        {
+            if (object >= seen.size() || seen[object]++)
+                return false;
+        }
+        for (uint32_t n = 0; n < nodes.size(); ++n)
+        {
+            const BvhNode& node = nodes[n];
+            BvhBox exact = { { 1e30f, 1e30f, 1e30f }, { -1e30f, -1e30f, -1e30f } };
+            auto grow = [&exact](const BvhBox& box)
+            {
+                exact.Min = { std::min(exact.Min.x, box.Min.x), std::min(exact.Min.y, box.Min.y),
+                    std::min(exact.Min.z, box.Min.z) };
+                exact.Max = { std::max(exact.Max.x, box.Max.x), std::max(exact.Max.y, box.Max.y),
+                    std::max(exact.Max.z, box.Max.z) };
+            };
+            if (node.IsLeaf())
+            {
+                for (uint32_t i = node.First; i < node.First + node.Count; ++i)
+                    grow(ObjectBox(bounds, order[i]));
+            }
+            else
+            {
+                const BvhNode& left = nodes[node.Left];
+                const BvhNode& right = nodes[node.Left + 1];
+                if (node.Left <= n || node.Left + 1 >= nodes.size() || bvh.GetParent(node.Left) != n ||
+                    bvh.GetParent(node.Left + 1) != n || left.First != node.First ||
+                    right.First != left.First + left.Count || left.Count + right.Count != node.Count ||
+                    left.Count == 0 || right.Count == 0)
+                {
+                    return false;
+                }
+                grow(left.Bounds);
+                grow(right.Bounds);
+            }
+            if (!BoxContains(node.Bounds, exact) || (tight && !BoxEquals(node.Bounds, exact)))
+                return false;
+        }
+        return true;
+    }
+
+    std::vector<uint32_t> Sorted(std::vector<uint32_t> objects)
+    {
+        std::sort(objects.begin(), objects.end());
+        return objects;
+    }
+
+    std::vector<uint32_t> FlatFrustum(const Frustum& frustum, const BoundsArray& bounds)
+    {
+        std::vector<uint32_t> visible(bounds.GetCount());
+        visible.resize(CullBounds(frustum, bounds, CullShape::Box, 0, bounds.GetCount(), visible.data()));
+        return visible;
+    }
+
+    std::vector<uint32_t> FlatBox(const BvhBox& query, const BoundsArray& bounds)
+    {
+        std::vector<uint32_t> objects;
+        for (size_t i = 0; i < bounds.GetCount(); ++i)
+        {
+            BvhBox box = ObjectBox(bounds, i);
+            if (box.Min.x <= query.Max.x && box.Max.x >= query.Min.x && box.Min.y <= query.Max.y &&
+                box.Max.y >= query.Min.y && box.Min.z <= query.Max.z && box.Max.z >= query.Min.z)
+            {
+                objects.push_back(static_cast<uint32_t>(i));
+            }
+        }
+        return objects;
+    }
+
+    // Closest box along the ray by testing every one; returns the distance or infinity
+    float FlatRaycast(const BoundsArray& bounds, const Float3& origin, const Float3& direction, float maxDistance,
+        uint32_t* object)
+    {
+        float closest = std::numeric_limits<float>::infinity();
+        Float3 inverse = { 1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z };
+        for (size_t i = 0; i < bounds.GetCount(); ++i)
+        {
+            BvhBox box = ObjectBox(bounds, i);
+            float x1 = (box.Min.x - origin.x) * inverse.x, x2 = (box.Max.x - origin.x) * inverse.x;
+            float y1 = (box.Min.y - origin.y) * inverse.y, y2 = (box.Max.y - origin.y) * inverse.y;
+            float z1 = (box.Min.z - origin.z) * inverse.z, z2 = (box.Max.z - origin.z) * inverse.z;
+            float entry = std::max(std::max(std::min(x1, x2), std::min(y1, y2)), std::max(std::min(z1, z2), 0.0f));
+            float exit = std::min(std::min(std::max(x1, x2), std::max(y1, y2)),
+                std::min(std::max(z1, z2), maxDistance));
+            if (entry <= exit && entry < closest)
+            {
+                closest = entry;
+                *object = static_cast<uint32_t>(i);
+            }
+        }
+        return closest;
+    }
+
+    Frustum StreetFrustum(float angle, float farZ)
+    {
+        Float3 eye = { 30.0f * std::cos(angle), 8.0f, 30.0f * std::sin(angle) };
+        Float3 at = { eye.x + std::sin(angle), 7.9f, eye.z + std::cos(angle) };
+        return ExtractFrustum(MatrixLookAtLH(eye, at, { 0.0f, 1.0f, 0.0f }) *
+            MatrixPerspectiveFovLH(MathPiDiv2, 16.0f / 9.0f, 0.1f, farZ));
+    }
+
+    struct Ray
+    {
+        Float3 Origin;
+        Float3 Direction;
+    };
+
+    std::vector<Ray> RandomRays(size_t count, float halfSize, uint32_t seed)
+    {
+        std::mt19937 random(seed);
+        std::uniform_real_distribution<float> position(-halfSize * 0.5f, halfSize * 0.5f);
+        std::uniform_real_distribution<float> angle(0.0f, 2.0f * MathPi);
+        std::uniform_real_distribution<float> slope(-0.3f, 0.05f);
+        std::vector<Ray> rays(count);
+        for (Ray& ray : rays)
+        {
+            float a = angle(random);
+            ray.Origin = { position(random), 20.0f, position(random) };
+            ray.Direction = Vector3Normalize({ std::cos(a), slope(random), std::sin(a) });
+        }
+        return rays;
+    }
+
+    std::vector<BvhBox> RandomBoxes(size_t count, float halfSize, float size, uint32_t seed)
+    {
+        std::mt19937 random(seed);
+        std::uniform_real_distribution<float> position(-halfSize * 0.5f, halfSize * 0.5f);
+        std::vector<BvhBox> boxes(count);
+        for (BvhBox& box : boxes)
+        {
+            float x = position(random), z = position(random);
+            box = { { x, 0.0f, z }, { x + size, size, z + size } };
+        }
+        return boxes;
+    }
+
+    // Moves every step-th object a little, in the tree and in bounds
+    void MoveObjects(Bvh* bvh, BoundsArray* bounds, size_t step, float t)
+    {
+        for (size_t i = 0; i < bounds->GetCount(); i += step)
+        {
+            Float3 c = bounds->GetCenter(i), e = bounds->GetExtents(i);
+            c = { c.x + 2.0f * std::cos(t + i), c.y, c.z + 2.0f * std::sin(t + i) };
+            bounds->Set(i, c, e);
+            if (bvh)
+                bvh->Update(static_cast<uint32_t>(i), c, e);
+        }
+    }
+
+    void CheckBvh(JobSystem& jobSystem)
+    {
+        Bvh empty;
+        BoundsArray none;
+        empty.Build(&jobSystem, none);
+        std::vector<uint32_t> result;
+        BvhRayHit hit;
+        empty.CullFrustum(StreetFrustum(0.0f, 100.0f), &result);
+        Check(Validate(empty, none, true) && result.empty() && !empty.Raycast({ 0, 0, 0 }, { 1, 0, 0 }, 10.0f, &hit) &&
+            empty.Refit() == 0, "bvh: empty tree");
+
+        BoundsArray one(1);
+        one.Set(0, { 1.0f, 2.0f, 3.0f }, { 1.0f, 1.0f, 1.0f });
+        Bvh single;
+        single.Build(nullptr, one);
+        Check(Validate(single, one, true) && single.GetNodes().size() == 1 &&
+            single.Raycast({ 1.0f, 2.0f, -10.0f }, { 0.0f, 0.0f, 1.0f }, 100.0f, &hit) && hit.Object == 0 &&
+            std::fabs(hit.Distance - 12.0f) < 1e-5f, "bvh: single object");
+
+        // Large enough for the parallel build to split into subtrees and bin in chunks
+        BoundsArray bounds = CityBounds(300007, 800.0f, 5);
+        Bvh serial, parallel;
+        serial.Build(nullptr, bounds);
+        parallel.Build(&jobSystem, bounds);
+        Check(Validate(serial, bounds, true) && Validate(parallel, bounds, true), "bvh: built trees are valid");
+        Check(serial.GetNodes().size() == parallel.GetNodes().size() && serial.GetDepth() == parallel.GetDepth() &&
+            std::fabs(serial.GetCost() - parallel.GetCost()) < 1e-9 * serial.GetCost() &&
+            serial.GetObjectOrder() == parallel.GetObjectOrder(), "bvh: parallel build gives the serial tree");
+
+        auto checkQueries = [&](const Bvh& bvh, const char* frustumWhat, const char* rayWhat, const char* boxWhat)
+        {
+            bool same = true;
+            for (int camera = 0; camera < 6; ++camera)
+            {
+                Frustum frustum = StreetFrustum(camera * 1.1f, camera % 2 ? 150.0f : 900.0f);
+                bvh.CullFrustum(frustum, &result);
+                same = same && Sorted(result) == FlatFrustum(frustum, bounds);
+            }
+            Check(same, frustumWhat);
+
+            int rayMismatches = 0;
+            for (const Ray& ray : RandomRays(200, 800.0f, 8))
+            {
+                uint32_t flatObject = 0;
+                float flat = FlatRaycast(bounds, ray.Origin, ray.Direction, 1000.0f, &flatObject);
+                bool found = bvh.Raycast(ray.Origin, ray.Direction, 1000.0f, &hit);
+                rayMismatches += found != (flat != std::numeric_limits<float>::infinity()) ||
+                    (found && hit.Distance != flat);
+            }
+            Check(rayMismatches == 0, rayWhat);
+
+            same = true;
+            for (const BvhBox& query : RandomBoxes(50, 800.0f, 60.0f, 9))
+            {
+                bvh.QueryBox(query, &result);
+                same = same && Sorted(result) == FlatBox(query, bounds);
+            }
+            Check(same, boxWhat);
+        };
+        checkQueries(parallel, "bvh: frustum culling finds the objects of the flat list",
+            "bvh: rays hit the closest box at the flat loop's distance",
+            "bvh: box queries find the objects of the flat loop");
+
+        // Refit after moving some objects: only their ancestors are touched and boxes end up tight
+        Check(parallel.Refit() == 0, "refit: nothing to do without updates");
+        parallel.Update(17, bounds.GetCenter(17), bounds.GetExtents(17));
+        size_t touched = parallel.Refit();
+        const std::vector<uint32_t>& order = parallel.GetObjectOrder();
+        uint32_t position = static_cast<uint32_t>(std::find(order.begin(), order.end(), 17u) - order.begin());
+        size_t pathLength = 0;
+        for (uint32_t node = 0; node != Bvh::NoNode; ++pathLength)
+        {
+            const BvhNode& n = parallel.GetNodes()[node];
+            const BvhNode& left = parallel.GetNodes()[n.Left];
+            node = n.IsLeaf() ? Bvh::NoNode : position < left.First + left.Count ? n.Left : n.Left + 1;
+        }
+        Check(touched == pathLength, "refit: one update touches the path from its leaf to the root");
+
+        MoveObjects(&parallel, &bounds, 7, 1.0f);
+        touched = parallel.Refit();
+        Check(touched > 0 && touched < parallel.GetNodes().size(), "refit: clean subtrees are skipped");
+        Check(parallel.Refit() == 0, "refit: a second refit has nothing to do");
+        Check(Validate(parallel, bounds, true), "refit: every box is tight after moving objects");
+        checkQueries(parallel, "refit: frustum culling still matches the flat list",
+            "refit: rays still hit the closest box", "refit: box queries still match the flat loop");
+        MoveObjects(&parallel, &bounds, 1, 2.0f);
+        Check(parallel.Refit() == parallel.GetNodes().size() && Validate(parallel, bounds, true),
+            "refit: moving every object touches every node");
+    }
+}
+
+int main(int argc, char** argv)
+{
+    size_t objectCount = 1000000;
+    unsigned int maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--objects") == 0 && i + 1 < argc)
+            objectCount = static_cast<size_t>(std::max(10000, std::atoi(argv[++i])));
+        else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+            maxThreads = static_cast<unsigned int>(std::max(1, std::atoi(argv[++i])));
+    }
+
+    {
+        JobSystem jobSystem(4);
+        CheckBvh(jobSystem);
+    }
+    if (g_Failures > 0)
+    {
+        std::fprintf(stderr, "%d check(s) failed\n", g_Failures);
+        return 1;
+    }
+    std::printf("Bvh checks passed\n\n");
+
+    float halfSize = 2000.0f;
+    BoundsArray bounds = CityBounds(objectCount, halfSize, 1);
+    Bvh bvh;
+    std::printf("%zu objects\n%-22s %12s %12s %10s %8s\n", objectCount, "Build", "ms", "speedup", "nodes", "depth");
+    bvh.Build(nullptr, bounds);
+    double serialMs = 0.0;
+    {
+        Clock::time_point start = Clock::now();
+        bvh.Build(nullptr, bounds);
+        serialMs = ElapsedMs(start);
+        std::printf("%-22s %12.1f %11.2fx %10zu %8u\n", "serial", serialMs, 1.0, bvh.GetNodes().size(),
+            bvh.GetDepth());
+    }
+    for (unsigned int threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        JobSystem jobSystem(threads);
+        Clock::time_point start = Clock::now();
+        bvh.Build(&jobSystem, bounds);
+        double ms = ElapsedMs(start);
+        std::printf("%-22s %12.1f %11.2fx %10zu %8u\n", (std::to_string(threads) + " threads").c_str(), ms,
+            serialMs / ms, bvh.GetNodes().size(), bvh.GetDepth());
+    }
+
+    // Refit after moving 1%, 10% and all of the objects, 20 frames each
+    double freshCost = bvh.GetCost();
+    std::printf("\n%-22s %12s %14s %12s %12s\n", "Refit, objects moved", "ms/frame", "nodes touched", "SAH cost",
+        "rebuilt cost");
+    for (size_t step : { 100u, 10u, 1u })
+    {
+        BoundsArray moving = bounds;
+        bvh.Build(nullptr, moving);
+        double ms = 0.0;
+        size_t touched = 0;
+        for (int frame = 0; frame < 20; ++frame)
+        {
+            Clock::time_point start = Clock::now();
+            MoveObjects(&bvh, &moving, step, 0.3f * frame);
+            touched = bvh.Refit();
+            ms += ElapsedMs(start);
+        }
+        Bvh rebuilt;
+        rebuilt.Build(nullptr, moving);
+        std::printf("%-22s %12.2f %14zu %12.2f %12.2f\n", (std::to_string(100 / step) + "%").c_str(), ms / 20,
+            touched, bvh.GetCost(), rebuilt.GetCost());
+    }
+    std::printf("(fresh tree cost %.2f)\n", freshCost);
+
+    // Queries against the flat list
+    bvh.Build(nullptr, bounds);
+    std::vector<uint32_t> result;
+    std::printf("\n%-22s %14s %14s %10s %12s\n", "Query", "flat us", "bvh us", "speedup", "results");
+    for (float farZ : { 200.0f, 1000.0f, 4000.0f })
+    {
+        const int frames = 20;
+        size_t count = 0;
+        Clock::time_point start = Clock::now();
+        for (int frame = 0; frame < frames; ++frame)
+            count = FlatFrustum(StreetFrustum(0.05f * frame, farZ), bounds).size();
+        double flatUs = ElapsedMs(start) * 1000.0 / frames;
+        start = Clock::now();
+        for (int frame = 0; frame < frames; ++frame)
+            bvh.CullFrustum(StreetFrustum(0.05f * frame, farZ), &result);
+        double bvhUs = ElapsedMs(start) * 1000.0 / frames;
+        std::printf("%-22s %14.1f %14.1f %9.1fx %12zu\n", ("frustum, far " + std::to_string(int(farZ))).c_str(),
+            flatUs, bvhUs, flatUs / bvhUs, count);
+    }
+    {
+        std::vector<Ray> rays = RandomRays(20000, halfSize, 3);
+        size_t flatRays = 20, hits = 0;
+        uint32_t object = 0;
+        Clock::time_point start = Clock::now();
+        for (size_t i = 0; i < flatRays; ++i)
+            FlatRaycast(bounds, rays[i].Origin, rays[i].Direction, 4000.0f, &object);
+        double flatUs = ElapsedMs(start) * 1000.0 / flatRays;
+        BvhRayHit hit;
+        start = Clock::now();
+        for (const Ray& ray : rays)
+            hits += bvh.Raycast(ray.Origin, ray.Direction, 4000.0f, &hit);
+        double bvhUs = ElapsedMs(start) * 1000.0 / rays.size();
+        std::printf("%-22s %14.1f %14.2f %9.0fx %12zu\n", "ray, closest hit", flatUs, bvhUs, flatUs / bvhUs, hits);
+    }
+    {
+        std::vector<BvhBox> boxes = RandomBoxes(5000, halfSize, 50.0f, 4);
+        size_t flatQueries = 20, found = 0;
+        Clock::time_point start = Clock::now();
+        for (size_t i = 0; i < flatQueries; ++i)
+            FlatBox(boxes[i], bounds);
+        double flatUs = ElapsedMs(start) * 1000.0 / flatQueries;
+        start = Clock::now();
+        for (const BvhBox& box : boxes)
+        {
+            bvh.QueryBox(box, &result);
+            found += result.size();
+        }
+        double bvhUs = ElapsedMs(start) * 1000.0 / boxes.size();
+        std::printf("%-22s %14.1f %14.2f %9.0fx %12.1f\n", "box 50^3", flatUs, bvhUs, flatUs / bvhUs,
+            double(found) / boxes.size());
+    }
+    return 0;
+}
@@ -0,0 +1,291 @@
+// Checks and throughput of ConstantBufferRing, the per-frame constant allocator behind
+// RenderContext::AllocateConstants. The checks cover alignment, wraparound, frame
+// fencing, a randomized overlap test and several frames through a backend's Present;
+// the benchmark measures raw allocations/s and per-draw constant uploads through the
+// ring versus UpdateBuffer on a Default buffer.
+//
+// Build (from the repository root):
+//   g++ -std=c++20 -O2 -ICommon Benchmarks/ConstantBufferRingBenchmark.cpp Common/ConstantBufferRing.cpp
+//       Common/CommandBuffer.cpp Common/CpuRenderDevice.cpp Common/NullRenderDevice.cpp
+//       -o ConstantBufferRingBenchmark
+//
+// Usage: ConstantBufferRingBenchmark [--draws N]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <random>
+#include <vector>
+
+#include "ConstantBufferRing.h"
+#include "MathUtil.h"
+#include "NullRenderDevice.h"
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    int g_Failures = 0;
+
+    void Check(bool condition, const char* what)
+    {
+        if (!condition)
+        {
+            std::fprintf(stderr, "FAILED: %s\n", what);
+            ++g_Failures;
+        }
+    }
+
+    void CheckAlignment()
+    {
+        ConstantBufferRing ring(1 << 16);
+        const uint32_t sizes[] = { 1, 64, 80, 255, 256, 257, 1000, 4096 };
+        for (uint32_t size : sizes)
+        {
+            uint32_t offset = 1;
+            Check(ring.Allocate(size, &offset), "allocation fits");
+            Check(offset % ConstantBufferRing::Alignment == 0, "offset is 256-byte aligned");
+        }
+        Check(ring.GetUsedBytes() == 256 * 5 + 512 + 1024 + 4096, "sizes are rounded up to 256 bytes");
+        Check(ConstantBufferRing(1000).GetCapacity() == 768, "capacity is rounded down to 256 bytes");
+    }
+
+    void CheckInvalidSizes()
+    {
+        ConstantBufferRing ring(1024);
+        uint32_t offset;
+        Check(!ring.Allocate(0, &offset), "zero-sized allocation fails");
+        Check(!ring.Allocate(1025, &offset), "allocation larger than the ring fails");
+        Check(!ring.Allocate(0xFFFFFFFFu, &offset), "allocation that overflows when aligned fails");
+        Check(ring.Allocate(1024, &offset) && offset == 0, "allocation of the whole ring succeeds");
+    }
+
+    void CheckWraparound()
+    {
+        ConstantBufferRing ring(1024);
+        uint32_t offset;
+        for (int i = 0; i < 2; ++i)
+            ring.Allocate(256, &offset);
+        ring.EndFrame();
+        Check(ring.Allocate(256, &offset) && offset == 512, "allocation continues at the head");
+        ring.EndFrame();
+        ring.RetireFrames(0);
+
+        // 512 bytes do not fit in the last 256: skip them and use the front, which frame 0 freed
+        Check(ring.Allocate(512, &offset) && offset == 0, "allocation wraps to the front");
+        Check(ring.GetStats().Wraps == 1, "wrap is counted");
+        Check(ring.GetUsedBytes() == 1024, "skipped tail belongs to the frame that wrapped");
+
+        ring.EndFrame();
+        ring.RetireFrames(1);
+        Check(ring.GetUsedBytes() == 768, "retiring the older frame keeps the skipped tail reserved");
+        ring.RetireFrames(2);
+        Check(ring.GetUsedBytes() == 0, "retiring the wrapping frame releases the skipped tail");
+    }
+
+    void CheckFencing()
+    {
+        ConstantBufferRing ring(1024);
+        uint32_t offset;
+        for (int i = 0; i < 4; ++i)
+            ring.Allocate(256, &offset);
+        ring.EndFrame();
+        Check(!ring.Allocate(256, &offset), "full ring refuses to overwrite a frame in flight");
+        Check(ring.GetFramesInFlight() == 1, "closed frame is in flight");
+
+        ring.RetireFrames(0);
+        Check(ring.GetFramesInFlight() == 0 && ring.GetUsedBytes() == 0, "retired frame releases its bytes");
+        Check(ring.Allocate(256, &offset) && offset == 0, "empty ring restarts at the front");
+
+        // Retiring a frame that is still being recorded must not release anything
+        ring.RetireFrames(5);
+        Check(ring.GetUsedBytes() == 256, "open frame is never retired");
+    }
+
+    // Random sizes and frame lengths; every allocation is compared against all
+    // ranges of frames the simulated GPU has not finished yet
+    void CheckRandomized()
+    {
+        struct Range
+        {
+            uint64_t Frame;
+            uint32_t Begin;
+            uint32_t End;
+        };
+
+        const uint32_t capacity = 64 * 1024;
+        const uint32_t framesInFlight = 3;
+        ConstantBufferRing ring(capacity);
+        std::mt19937 random(1234);
+        std::deque<Range> live;
+        uint64_t allocations = 0;
+        bool overlap = false;
+
+        for (int frame = 0; frame < 20000 && !overlap; ++frame)
+        {
+            int draws = static_cast<int>(random() % 40);
+            for (int draw = 0; draw < draws && !overlap; ++draw)
+            {
+                uint32_t size = 1 + random() % 2048;
+                uint32_t offset;
+                if (!ring.Allocate(size, &offset))
+                    break;
+
+                uint32_t end = offset + ConstantBufferRing::AlignSize(size);
+                overlap = end > capacity;
+                for (const Range& range : live)
+                    overlap = overlap || (offset < range.End && range.Begin < end);
+                live.push_back({ ring.GetFrameIndex(), offset, end });
+                ++allocations;
+            }
+
+            ring.EndFrame();
+            if (ring.GetFrameIndex() > framesInFlight)
+            {
+                uint64_t completed = ring.GetFrameIndex() - framesInFlight - 1;
+                ring.RetireFrames(completed);
+                while (!live.empty() && live.front().Frame <= completed)
+                    live.pop_front();
+            }
+        }
+
+        Check(!overlap, "no allocation overlaps data of a frame in flight");
+        Check(allocations > 100000, "randomized test made progress");
+    }
+
+    // Several frames through a backend's AllocateConstants and Present, each filling most of the
+    // ring: the ring only keeps up when Present closes every frame and retires the finished ones.
+    // Otherwise it fills in the second frame and has to fall back to starting over.
+    void CheckDeviceFrames()
+    {
+        NullRenderDevice device(64, 64);
+        CpuRenderContext& context = static_cast<CpuRenderContext&>(device.GetImmediateContext());
+        const uint32_t drawsPerFrame = CpuRenderContext::ConstantRingSize / 256 * 3 / 4;
+        const int frames = 10;
+        bool intact = true;
+        for (int frame = 0; frame < frames; ++frame)
+        {
+            std::vector<ConstantBufferRange> ranges(drawsPerFrame);
+            for (uint32_t draw = 0; draw < drawsPerFrame; ++draw)
+            {
+                uint32_t value = frame * drawsPerFrame + draw;
+                ranges[draw] = context.AllocateConstants(&value, sizeof(value));
+            }
+            const uint8_t* data = device.GetBuffer(ranges[0].Buffer)->Data.data();
+            for (uint32_t draw = 0; draw < drawsPerFrame; ++draw)
+            {
+                uint32_t value;
+                std::memcpy(&value, data + ranges[draw].Offset, sizeof(value));
+                intact = intact && value == frame * drawsPerFrame + draw;
+            }
+            device.Present();
+            Check(context.GetConstantRing().GetFrameIndex() == static_cast<uint64_t>(frame) + 1,
+                "every Present closes one frame of the constant ring");
+            Check(context.GetConstantRing().GetFramesInFlight() == 0, "Present retires the frames it finished");
+        }
+        Check(context.GetConstantRing().GetStats().Failures == 0,
+            "frames that each fill most of the ring never run out of space");
+        Check(intact, "constants of a frame are intact when it is presented");
+    }
+
+    double ElapsedNs(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    }
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t draws = 100000;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--draws") == 0 && i + 1 < argc)
+            draws = static_cast<uint32_t>(std::atoi(argv[++i]));
+        else
+        {
+            std::fprintf(stderr, "Usage: %s [--draws N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    CheckAlignment();
+    CheckInvalidSizes();
+    CheckWraparound();
+    CheckFencing();
+    CheckRandomized();
+    CheckDeviceFrames();
+    if (g_Failures)
+    {
+        std::fprintf(stderr, "%d check(s) failed\n", g_Failures);
+        return 1;
+    }
+    std::printf("ConstantBufferRing checks passed\n\n");
+
+    // Raw allocator: 64-byte WVP allocations, 1000 draws per frame, 3 frames in flight
+    {
+        ConstantBufferRing ring(4 << 20);
+        const uint64_t count = 50000000;
+        uint32_t offset = 0;
+        uint64_t checksum = 0;
+        auto start = Clock::now();
+        for (uint64_t i = 0; i < count; ++i)
+        {
+            if (!ring.Allocate(sizeof(Float4x4), &offset))
+                return 1;
+            checksum += offset;
+            if (i % 1000 == 999)
+            {
+                ring.EndFrame();
+                if (ring.GetFrameIndex() > 3)
+                    ring.RetireFrames(ring.GetFrameIndex() - 4);
+            }
+        }
+        double ns = ElapsedNs(start);
+        std::printf("Allocate: %.2f ns/allocation, %.1f M allocations/s, %llu wraps (checksum %llu)\n\n", ns / count,
+            count / ns * 1000.0, static_cast<unsigned long long>(ring.GetStats().Wraps), static_cast<unsigned long long>(checksum));
+    }
+
+    // Per-draw constants through the null backend: the DrawScene() pattern against the ring
+    NullRenderDevice device(800, 600);
+    RenderContext& context = device.GetImmediateContext();
+    BufferDesc desc;
+    desc.ByteWidth = sizeof(Float4x4);
+    desc.Bind = BufferBind::ConstantBuffer;
+    BufferHandle constantBuffer;
+    if (!device.CreateBuffer(desc, nullptr, &constantBuffer))
+        return 1;
+
+    std::vector<Float4x4> matrices(draws);
+    for (uint32_t i = 0; i < draws; ++i)
+        matrices[i] = MatrixTranspose(MatrixTranslation(static_cast<float>(i), 0.0f, 0.0f));
+
+    std::printf("%-28s %12s %12s\n", "path", "ns/draw", "MB/s");
+    for (int path = 0; path < 2; ++path)
+    {
+        const int frames = 20;
+        auto start = Clock::now();
+        for (int frame = 0; frame < frames; ++frame)
+        {
+            for (uint32_t i = 0; i < draws; ++i)
+            {
+                if (path == 0)
+                {
+                    context.UpdateBuffer(constantBuffer, &matrices[i], sizeof(Float4x4));
+                    context.SetVSConstantBuffer(0, constantBuffer);
+                }
+                else
+                {
+                    context.SetVSConstantBufferRange(0, context.AllocateConstants(&matrices[i], sizeof(Float4x4)));
+                }
+            }
+            device.Present();
+        }
+        double ns = ElapsedNs(start) / (static_cast<double>(frames) * draws);
+        std::printf("%-28s %12.2f %12.1f\n", path == 0 ? "UpdateBuffer + SetVSConstant" : "AllocateConstants + range",
+            ns, sizeof(Float4x4) / ns * 1000.0);
+    }
+
+    return 0;
+}
@@ -0,0 +1,385 @@
+// Checks and timings of DrawQueue, the sorted draw-key queue with redundant-bind
+// elimination. The scene is many cubes that each pick one of several shader pairs,
+// the solid or wireframe rasterizer state of the Render States tutorial and one of
+// several meshes. Drawing them in submission order (what DrawScene does) is compared
+// with submitting them to the queue, on the null backend so only CPU cost counts.
+// Also compares the radix sort with std::sort.
+//
+// Build (from the repository root):
+//   g++ -std=c++20 -O2 -ICommon Benchmarks/DrawQueueBenchmark.cpp Common/DrawQueue.cpp Common/CommandBuffer.cpp
+//       Common/CpuRenderDevice.cpp Common/NullRenderDevice.cpp Common/ConstantBufferRing.cpp -o DrawQueueBenchmark
+//
+// Usage: DrawQueueBenchmark [--max N]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <random>
+#include <tuple>
+#include <vector>
+
+#include "CubeMesh.h"
+#include "DrawQueue.h"
+#include "MathUtil.h"
+#include "NullRenderDevice.h"
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    int g_Failures = 0;
+
+    void Check(bool condition, const char* what)
+    {
+        if (!condition)
+        {
+            std::fprintf(stderr, "FAILED: %s\n", what);
+            ++g_Failures;
+        }
+    }
+
+    double ElapsedNs(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    }
+
+    constexpr uint32_t ShaderCount = 8;
+    constexpr uint32_t MeshCount = 16;
+
+    struct Object
+    {
+        uint32_t Shader;
+        uint32_t Rasterizer;
+        uint32_t Mesh;
+        float Depth;
+        Float4x4 World;
+    };
+
+    struct Resources
+    {
+        VertexShaderHandle VertexShaders[ShaderCount];
+        PixelShaderHandle PixelShaders[ShaderCount];
+        RasterizerStateHandle RasterizerStates[2];
+        BufferHandle VertexBuffers[MeshCount];
+        BufferHandle IndexBuffers[MeshCount];
+    };
+
+    bool CreateResources(RenderDevice& device, Resources& resources)
+    {
+        for (uint32_t i = 0; i < ShaderCount; ++i)
+        {
+            ShaderDesc vsDesc = { "Effects.fx", "VS", "vs_5_0", { std::begin(VertexInputLayout), std::end(VertexInputLayout) } };
+            vsDesc.Defines = { { "MATERIAL", std::to_string(i) } };
+            ShaderDesc psDesc = { "Effects.fx", "PS", "ps_5_0", {} };
+            psDesc.Defines = vsDesc.Defines;
+            if (!device.CreateVertexShader(vsDesc, &resources.VertexShaders[i]) ||
+                !device.CreatePixelShader(psDesc, &resources.PixelShaders[i]))
+                return false;
+        }
+
+        RasterizerDesc rasterDesc;
+        if (!device.CreateRasterizerState(rasterDesc, &resources.RasterizerStates[0]))
+            return false;
+        rasterDesc.Fill = FillMode::Wireframe;
+        rasterDesc.Cull = CullMode::None;
+        if (!device.CreateRasterizerState(rasterDesc, &resources.RasterizerStates[1]))
+            return false;
+
+        for (uint32_t i = 0; i < MeshCount; ++i)
+        {
+            BufferDesc vbDesc = { sizeof(CubeVertices), BufferBind::VertexBuffer, BufferUsage::Immutable };
+            BufferDesc ibDesc = { sizeof(CubeIndices), BufferBind::IndexBuffer, BufferUsage::Immutable };
+            if (!device.CreateBuffer(vbDesc, CubeVertices, &resources.VertexBuffers[i]) ||
+                !device.CreateBuffer(ibDesc, CubeIndices, &resources.IndexBuffers[i]))
+                return false;
+        }
+        return true;
+    }
+
+    std::vector<Object> MakeObjects(uint32_t count)
+    {
+        std::mt19937 random(1234);
+        std::vector<Object> objects(count);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            Object& object = objects[i];
+            object.Shader = random() % ShaderCount;
+            object.Rasterizer = random() % 2;
+            object.Mesh = random() % MeshCount;
+            object.Depth = static_cast<float>(random() % 10000) / 10000.0f;
+            object.World = MatrixTranslation(static_cast<float>(i % 100), static_cast<float>(i / 100), object.Depth);
+        }
+        return objects;
+    }
+
+    DrawCommand MakeCommand(const Resources& resources, const Object& object, const ConstantBufferRange& constants)
+    {
+        DrawCommand command;
+        command.VertexShader = resources.VertexShaders[object.Shader];
+        command.PixelShader = resources.PixelShaders[object.Shader];
+        command.RasterizerState = resources.RasterizerStates[object.Rasterizer];
+        command.VertexBuffer = resources.VertexBuffers[object.Mesh];
+        command.VertexStride = sizeof(Vertex);
+        command.IndexBuffer = resources.IndexBuffers[object.Mesh];
+        command.IndexFormat = Format::R16UInt;
+        command.VSConstants = constants;
+        command.IndexCount = CubeIndexCount;
+        return command;
+    }
+
+    uint64_t MakeKey(const Resources& resources, const Object& object)
+    {
+        return MakeDrawKey(0, resources.VertexShaders[object.Shader].Id, resources.RasterizerStates[object.Rasterizer].Id,
+            resources.VertexBuffers[object.Mesh].Id, QuantizeDrawDepth(object.Depth));
+    }
+
+    // DrawScene(): bind everything, then draw, for every object in order
+    void DrawDirect(RenderContext& context, const Resources& resources, const std::vector<Object>& objects)
+    {
+        for (const Object& object : objects)
+        {
+            DrawCommand command = MakeCommand(resources, object, context.AllocateConstants(&object.World, sizeof(Float4x4)));
+            context.SetRasterizerState(command.RasterizerState);
+            context.SetVertexShader(command.VertexShader);
+            context.SetPixelShader(command.PixelShader);
+            context.SetVertexBuffer(0, command.VertexBuffer, command.VertexStride, 0);
+            context.SetIndexBuffer(command.IndexBuffer, command.IndexFormat, 0);
+            context.SetVSConstantBufferRange(0, command.VSConstants);
+            context.DrawIndexed(command.IndexCount, 0, 0);
+        }
+    }
+
+    void DrawQueued(RenderContext& context, DrawQueue& queue, const Resources& resources, const std::vector<Object>& objects)
+    {
+        for (const Object& object : objects)
+        {
+            ConstantBufferRange constants = context.AllocateConstants(&object.World, sizeof(Float4x4));
+            queue.Submit(MakeKey(resources, object), MakeCommand(resources, object, constants));
+        }
+        queue.Execute(context);
+    }
+
+    // Records every draw together with the state bound at that moment
+    class RecordingContext final : public RenderContext
+    {
+    public:
+        using DrawRecord = std::tuple<uint32_t, uint32_t, uint32_t, uint32_t, uint32_t, uint32_t, uint32_t>;
+
+        void ClearRenderTarget(const float[4]) override {}
+        void ClearDepthStencil(float, uint8_t) override {}
+        void SetViewport(const Viewport&) override {}
+        void SetRasterizerState(RasterizerStateHandle state) override { m_Rasterizer = state.Id; }
+        void SetVertexShader(VertexShaderHandle shader) override { m_VertexShader = shader.Id; }
+        void SetPixelShader(PixelShaderHandle shader) override { m_PixelShader = shader.Id; }
+        void SetVertexBuffer(uint32_t, BufferHandle buffer, uint32_t, uint32_t) override { m_VertexBuffer = buffer.Id; }
+        void SetIndexBuffer(BufferHandle buffer, Format, uint32_t) override { m_IndexBuffer = buffer.Id; }
+        void SetVSConstantBuffer(uint32_t, BufferHandle) override {}
+        void SetPSConstantBuffer(uint32_t, BufferHandle) override {}
+        void UpdateBuffer(BufferHandle, const void*, uint32_t) override {}
+        void UpdateBufferRange(BufferHandle, uint32_t, const void*, uint32_t) override {}
+        ConstantBufferRange AllocateConstants(const void*, uint32_t size) override
+        {
+            ConstantBufferRange range;
+            range.Buffer.Id = 1;
+            range.Offset = m_NextOffset;
+            range.Size = size;
+            m_NextOffset += 256;
+            return range;
+        }
+        void SetVSConstantBufferRange(uint32_t, const ConstantBufferRange& range) override { m_Constants = range.Offset; }
+        void SetPSConstantBufferRange(uint32_t, const ConstantBufferRange&) override {}
+        void DrawIndexed(uint32_t indexCount, uint32_t, int32_t) override
+        {
+            Draws.emplace_back(m_Rasterizer, m_VertexShader, m_PixelShader, m_VertexBuffer, m_IndexBuffer, m_Constants,
+                indexCount);
+        }
+        void DrawIndexedInstanced(uint32_t, uint32_t, uint32_t, int32_t, uint32_t) override {}
+
+        std::vector<DrawRecord> Draws;
+
+    private:
+        uint32_t m_Rasterizer = 0;
+        uint32_t m_VertexShader = 0;
+        uint32_t m_PixelShader = 0;
+        uint32_t m_VertexBuffer = 0;
+        uint32_t m_IndexBuffer = 0;
+        uint32_t m_Constants = 0;
+        uint32_t m_NextOffset = 0;
+    };
+
+    void CheckRadixSort()
+    {
+        std::mt19937_64 random(42);
+        for (size_t count : { 0u, 1u, 2u, 255u, 4096u, 100000u })
+        {
+            std::vector<DrawSortEntry> entries(count);
+            for (size_t i = 0; i < count; ++i)
+            {
+                // Few distinct keys in some fields, like real scenes, so equal keys are common
+                uint64_t key = (random() % 4) << 60 | (random() % 8) << 48 | (random() & 0xffff);
+                entries[i] = { count > 1000 && i % 3 == 0 ? random() : key, static_cast<uint32_t>(i) };
+            }
+            std::vector<DrawSortEntry> expected = entries;
+            std::stable_sort(expected.begin(), expected.end(),
+                [](const DrawSortEntry& a, const DrawSortEntry& b) { return a.Key < b.Key; });
+
+            std::vector<DrawSortEntry> scratch(count);
+            RadixSortDrawKeys(entries.data(), scratch.data(), count);
+            bool same = std::equal(entries.begin(), entries.end(), expected.begin(),
+                [](const DrawSortEntry& a, const DrawSortEntry& b) { return a.Key == b.Key && a.Index == b.Index; });
+            Check(same, "radix sort matches std::stable_sort");
+        }
+
+        // All keys equal: every pass is skipped and the order is untouched
+        std::vector<DrawSortEntry> equal(100, DrawSortEntry{ 7, 0 });
+        for (uint32_t i = 0; i < equal.size(); ++i)
+            equal[i].Index = i;
+        std::vector<DrawSortEntry> scratch(equal.size());
+        RadixSortDrawKeys(equal.data(), scratch.data(), equal.size());
+        Check(equal[0].Index == 0 && equal[99].Index == 99, "equal keys keep submission order");
+    }
+
+    void CheckKeyLayout()
+    {
+        Check(MakeDrawKey(1, 0, 0, 0, 0) > MakeDrawKey(0, 4095, 255, 65535, 0xffffff), "pass is the most significant field");
+        Check(MakeDrawKey(0, 1, 0, 0, 0) > MakeDrawKey(0, 0, 255, 65535, 0xffffff), "shader sorts before rasterizer state");
+        Check(MakeDrawKey(0, 0, 1, 0, 0) > MakeDrawKey(0, 0, 0, 65535, 0xffffff), "rasterizer state sorts before mesh");
+        Check(MakeDrawKey(0, 0, 0, 1, 0) > MakeDrawKey(0, 0, 0, 0, 0xffffff), "mesh sorts before depth");
+        Check(MakeDrawKey(0, 4096, 0, 0, 0) == 0, "fields are truncated to their width");
+        Check(QuantizeDrawDepth(0.25f) < QuantizeDrawDepth(0.5f), "front to back");
+        Check(QuantizeDrawDepth(0.25f, true) > QuantizeDrawDepth(0.5f, true), "back to front");
+        Check(QuantizeDrawDepth(-1.0f) == 0 && QuantizeDrawDepth(2.0f) == (1u << DrawKeyDepthBits) - 1, "depth is clamped");
+    }
+
+    // The queue must issue the same draws with the same bound state, just in another order
+    void CheckReplay()
+    {
+        NullRenderDevice device(64, 64);
+        Resources resources;
+        Check(CreateResources(device, resources), "resources");
+        std::vector<Object> objects = MakeObjects(5000);
+
+        RecordingContext direct;
+        DrawDirect(direct, resources, objects);
+        RecordingContext queued;
+        DrawQueue queue;
+        DrawQueued(queued, queue, resources, objects);
+
+        Check(queue.GetStats().Draws == objects.size() && queue.GetSize() == 0, "every draw is replayed");
+        std::vector<RecordingContext::DrawRecord> sortedDirect = direct.Draws;
+        std::vector<RecordingContext::DrawRecord> sortedQueued = queued.Draws;
+        std::sort(sortedDirect.begin(), sortedDirect.end());
+        std::sort(sortedQueued.begin(), sortedQueued.end());
+        Check(sortedDirect == sortedQueued, "queued draws see the same state as direct draws");
+
+        // Replayed order follows the keys: shaders never come back once left
+        bool grouped = true;
+        for (size_t i = 2; i < queued.Draws.size(); ++i)
+            grouped = grouped && std::get<1>(queued.Draws[i]) >= std::get<1>(queued.Draws[i - 1]);
+        Check(grouped, "draws are grouped by shader");
+
+        const DrawQueueStats& stats = queue.GetStats();
+        Check(stats.Binds + stats.SkippedBinds == objects.size() * 6, "every bind is issued or skipped");
+        Check(stats.Binds < objects.size() * 3, "most shader, state and mesh binds are skipped");
+    }
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t maxCount = 100000;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--max") == 0 && i + 1 < argc)
+            maxCount = static_cast<uint32_t>(std::atoi(argv[++i]));
+        else
+        {
+            std::fprintf(stderr, "Usage: %s [--max N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    CheckRadixSort();
+    CheckKeyLayout();
+    CheckReplay();
+    if (g_Failures)
+    {
+        std::fprintf(stderr, "%d check(s) failed\n", g_Failures);
+        return 1;
+    }
+    std::printf("DrawQueue checks passed\n\n");
+
+    std::printf("%u shader pairs, 2 rasterizer states, %u meshes, null backend\n", ShaderCount, MeshCount);
+    std::printf("%8s %14s %14s %12s %14s %14s %10s\n", "objects", "direct ns/draw", "queued ns/draw", "sort ns/draw",
+        "direct binds", "queued binds", "saved");
+    for (uint32_t count = 100; count <= maxCount; count *= 10)
+    {
+        NullRenderDevice device(800, 600);
+        Resources resources;
+        if (!CreateResources(device, resources))
+            return 1;
+        std::vector<Object> objects = MakeObjects(count);
+        RenderContext& context = device.GetImmediateContext();
+        DrawQueue queue;
+
+        const int frames = std::max(3, static_cast<int>(1000000 / count));
+        double ns[2] = {};
+        uint64_t binds[2] = {};
+        for (int path = 0; path < 2; ++path)
+        {
+            context.ResetStats();
+            queue.ResetStats();
+            auto start = Clock::now();
+            for (int frame = 0; frame < frames; ++frame)
+            {
+                if (path == 0)
+                    DrawDirect(context, resources, objects);
+                else
+                    DrawQueued(context, queue, resources, objects);
+                device.Present();
+            }
+            ns[path] = ElapsedNs(start) / (static_cast<double>(frames) * count);
+            binds[path] = context.GetStats().StateChanges / frames;
+        }
+        double sortNs = queue.GetStats().SortMs * 1e6 / (static_cast<double>(frames) * count);
+        std::printf("%8u %14.1f %14.1f %12.1f %14llu %14llu %9.1f%%\n", count, ns[0], ns[1], sortNs,
+            static_cast<unsigned long long>(binds[0]), static_cast<unsigned long long>(binds[1]),
+            100.0 * (1.0 - static_cast<double>(binds[1]) / binds[0]));
+    }
+
+    // Sort alone: radix versus std::sort on the same (key, index) pairs
+    std::printf("\n%10s %16s %16s\n", "keys", "radix Mkeys/s", "std::sort Mkeys/s");
+    for (uint32_t count = 1000; count <= std::max(maxCount * 10, 1000u); count *= 10)
+    {
+        std::mt19937_64 random(count);
+        std::vector<DrawSortEntry> input(count);
+        for (uint32_t i = 0; i < count; ++i)
+            input[i] = { MakeDrawKey(random() % 4, random() % 64, random() % 4, random() % 1024,
+                static_cast<uint32_t>(random())), i };
+
+        std::vector<DrawSortEntry> entries(count);
+        std::vector<DrawSortEntry> scratch(count);
+        const int repeats = std::max(3, static_cast<int>(10000000 / count));
+        double rate[2] = {};
+        for (int path = 0; path < 2; ++path)
+        {
+            double totalNs = 0.0;
+            for (int r = 0; r < repeats; ++r)
+            {
+                entries = input;
+                auto start = Clock::now();
+                if (path == 0)
+                    RadixSortDrawKeys(entries.data(), scratch.data(), count);
+                else
+                    std::sort(entries.begin(), entries.end(),
+                        [](const DrawSortEntry& a, const DrawSortEntry& b) { return a.Key < b.Key; });
+                totalNs += ElapsedNs(start);
+            }
+            rate[path] = count * 1000.0 * repeats / totalNs;
+        }
+        std::printf("%10u %16.1f %16.1f\n", count, rate[0], rate[1]);
+    }
+    return 0;
+}
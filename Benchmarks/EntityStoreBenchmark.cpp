@@ -0,0 +1,786 @@
+// Checks and timings of EntityStore, the archetype entity storage with 16 KB
+// structure-of-arrays chunks, and of the scene systems in SceneComponents. The
+// checks cover handle generations, packed removal, component values kept and
+// zeroed across AddComponents/RemoveComponents, chunk layouts that fit 16 KB
+// with cache-line aligned arrays, queries that visit each matching entity
+// exactly once, and systems that give the same results serially, in parallel
+// and by direct math. A random churn of creates, destroys and component
+// changes is compared with a reference map after every step batch.
+//
+// The timings use 1M scene entities (transform, world, bounds, mesh, render
+// state; half of them animated). They compare one frame of the systems, and a
+// read of one component, with the same data as one heap object per entity
+// (what a global per object, like g_World1 and g_World2, grows into) and as one
+// array of such structs. They then time a frame of churn and report the memory
+// used per entity.
+//
+// Build (from the repository root):
+//   g++ -std=c++20 -O2 -pthread -ICommon Benchmarks/EntityStoreBenchmark.cpp Common/EntityStore.cpp
+//       Common/SceneComponents.cpp Common/JobSystem.cpp -o EntityStoreBenchmark
+//
+// Usage: EntityStoreBenchmark [--entities N] [--threads N]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "EntityStore.h"
+#include "JobSystem.h"
+#include "MathUtil.h"
+#include "SceneComponents.h"
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    int g_Failures = 0;
+
+    void Check(bool condition, const char* what)
+    {
+        if (!condition)
+        {
+            std::fprintf(stderr, "FAILED: %s\n", what);
+            ++g_Failures;
+        }
+    }
+
+    double ElapsedMs(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    float RandomFloat(std::mt19937& random, float low, float high)
+    {
+        return std::uniform_real_distribution<float>(low, high)(random);
+    }
+
+    Float3 RandomAxis(std::mt19937& random)
+    {
+        return Vector3Normalize({ RandomFloat(random, -1.0f, 1.0f), RandomFloat(random, -1.0f, 1.0f),
+            RandomFloat(random, -1.0f, 1.0f) + 2.0f });
+    }
+
+    // Random values for every scene component of an entity
+    void FillSceneEntity(EntityStore& store, const SceneComponentIds& ids, Entity entity, std::mt19937& random)
+    {
+        if (TransformComponent* t = store.Get<TransformComponent>(entity, ids.Transform))
+        {
+            t->Position = { RandomFloat(random, -100.0f, 100.0f), RandomFloat(random, -10.0f, 10.0f),
+                RandomFloat(random, -100.0f, 100.0f) };
+            t->Rotation = QuaternionRotationAxis(RandomAxis(random), RandomFloat(random, 0.0f, MathTwoPi));
+            float scale = RandomFloat(random, 0.5f, 2.0f);
+            t->Scale = { scale, scale, scale };
+        }
+        if (MeshComponent* mesh = store.Get<MeshComponent>(entity, ids.Mesh))
+        {
+            mesh->Mesh = random() % 16;
+            mesh->IndexCount = 36;
+            mesh->Center = { 0.0f, RandomFloat(random, 0.0f, 1.0f), 0.0f };
+            mesh->Extents = { 1.0f, RandomFloat(random, 0.5f, 2.0f), 1.0f };
+        }
+        if (RenderStateComponent* state = store.Get<RenderStateComponent>(entity, ids.RenderState))
+            *state = { 0, static_cast<uint32_t>(random() % 4), static_cast<uint32_t>(random() % 2) };
+        if (AnimationComponent* animation = store.Get<AnimationComponent>(entity, ids.Animation))
+            *animation = { RandomAxis(random), RandomFloat(random, -3.0f, 3.0f), 0.0f };
+    }
+
+    void CheckLifetime()
+    {
+        EntityStore store;
+        uint32_t a = store.RegisterComponent<Float4>();
+        uint32_t b = store.RegisterComponent<uint32_t>();
+        Check(a == 0 && b == 1, "component ids are handed out in order");
+
+        Entity first = store.Create(ComponentBit(a));
+        Entity second = store.Create(ComponentBit(a) | ComponentBit(b));
+        Entity bare = store.Create(0);
+        Check(store.IsAlive(first) && store.IsAlive(second) && store.IsAlive(bare), "created entities are alive");
+        Check(store.GetEntityCount() == 3 && store.GetArchetypeCount() == 3, "three entities in three archetypes");
+        Check(store.GetComponents(second) == (ComponentBit(a) | ComponentBit(b)), "GetComponents of a new entity");
+        Check(store.Get<uint32_t>(first, b) == nullptr, "a missing component is null");
+
+        store.Destroy(first);
+        Check(!store.IsAlive(first) && store.GetEntityCount() == 2, "a destroyed entity is dead");
+        Check(store.Get<Float4>(first, a) == nullptr && store.GetComponents(first) == 0,
+            "a dead handle has no components");
+        store.Destroy(first);
+        Check(store.GetEntityCount() == 2, "destroying a dead handle does nothing");
+        Check(!store.AddComponents(first, ComponentBit(b)), "a dead handle cannot gain components");
+
+        Entity reused = store.Create(ComponentBit(a));
+        Check(reused.Index == first.Index && reused.Generation != first.Generation,
+            "a freed index is reused with a new generation");
+        Check(store.IsAlive(reused) && !store.IsAlive(first), "the old handle stays dead after reuse");
+        Check(!store.IsAlive(Entity{}), "the invalid handle is dead");
+
+        Check(store.Create(ComponentBit(5)).Index == ~0u, "unregistered components are refused");
+        uint32_t huge = store.RegisterComponent(static_cast<uint32_t>(EntityStore::ChunkSize), 4);
+        Check(huge != EntityStore::NoComponent && store.Create(ComponentBit(huge)).Index == ~0u,
+            "a component larger than a chunk is refused");
+        Check(!store.AddComponents(second, ComponentBit(huge)) &&
+            store.GetComponents(second) == (ComponentBit(a) | ComponentBit(b)),
+            "a failed AddComponents leaves the entity as it was");
+        Check(store.RegisterComponent(4, 3) == EntityStore::NoComponent &&
+            store.RegisterComponent(4, 128) == EntityStore::NoComponent, "bad alignments are refused");
+
+        EntityStore full;
+        uint32_t last = 0;
+        for (uint32_t i = 0; i < EntityStore::MaxComponents; ++i)
+            last = full.RegisterComponent<float>();
+        Check(last == EntityStore::MaxComponents - 1 && full.RegisterComponent<float>() == EntityStore::NoComponent,
+            "at most MaxComponents components");
+        Entity everything = full.Create(~ComponentMask(0));
+        Check(full.IsAlive(everything) && full.Get<float>(everything, last) != nullptr,
+            "an entity can have all MaxComponents components");
+        uint32_t capacity = full.GetChunkCapacity(~ComponentMask(0));
+        for (uint32_t i = 1; i < capacity; ++i)
+            full.Create(~ComponentMask(0));
+        bool fits = full.GetChunkCount() == 1;
+        full.ForEachChunk(nullptr, 0, [&](const EntityChunk& chunk, unsigned int)
+        {
+            const uint8_t* end = reinterpret_cast<const uint8_t*>(chunk.GetEntities()) + EntityStore::ChunkSize;
+            fits &= chunk.GetCount() == capacity && chunk.Get<uint8_t>(last) + capacity * sizeof(float) <= end;
+        });
+        Check(fits, "a full chunk of MaxComponents arrays fits in ChunkSize bytes");
+    }
+
+    void CheckPackedRemoval()
+    {
+        EntityStore store;
+        uint32_t value = store.RegisterComponent<uint64_t>();
+        uint32_t capacity = store.GetChunkCapacity(ComponentBit(value));
+        const uint32_t count = capacity * 5 + 7;
+        std::vector<Entity> entities;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            entities.push_back(store.Create(ComponentBit(value)));
+            *store.Get<uint64_t>(entities.back(), value) = 1000 + i;
+        }
+        Check(store.GetChunkCount() == 6, "rows fill whole chunks before a new one is taken");
+
+        std::mt19937 random(3);
+        std::vector<uint32_t> order(count);
+        for (uint32_t i = 0; i < count; ++i)
+            order[i] = i;
+        std::shuffle(order.begin(), order.end(), random);
+        order.resize(count / 2 + capacity);
+        for (uint32_t i : order)
+            store.Destroy(entities[i]);
+
+        std::vector<bool> destroyed(count, false);
+        for (uint32_t i : order)
+            destroyed[i] = true;
+        bool valuesKept = true;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            if (!destroyed[i])
+                valuesKept &= store.IsAlive(entities[i]) && *store.Get<uint64_t>(entities[i], value) == 1000 + i;
+        }
+        Check(valuesKept, "entities moved to fill removed rows keep their values");
+        size_t remaining = count - order.size();
+        Check(store.GetChunkCount() == (remaining + capacity - 1) / capacity, "emptied chunks are released");
+
+        size_t visited = 0;
+        bool handlesMatch = true;
+        store.ForEachChunk(nullptr, ComponentBit(value), [&](const EntityChunk& chunk, unsigned int)
+        {
+            for (uint32_t i = 0; i < chunk.GetCount(); ++i)
+            {
+                Entity entity = chunk.GetEntities()[i];
+                handlesMatch &= store.IsAlive(entity) && chunk.Get<uint64_t>(value)[i] == 1000 + entity.Index;
+            }
+            visited += chunk.GetCount();
+        });
+        Check(visited == remaining && handlesMatch, "the packed rows are exactly the live entities");
+    }
+
+    void CheckComponentChanges()
+    {
+        EntityStore store;
+        SceneComponentIds ids = RegisterSceneComponents(store);
+        ComponentMask renderable = ComponentBit(ids.Transform) | ComponentBit(ids.World) | ComponentBit(ids.Mesh);
+        std::mt19937 random(5);
+
+        Entity entity = store.Create(renderable);
+        Entity other = store.Create(renderable);
+        FillSceneEntity(store, ids, entity, random);
+        FillSceneEntity(store, ids, other, random);
+        TransformComponent transform = *store.Get<TransformComponent>(entity, ids.Transform);
+        MeshComponent mesh = *store.Get<MeshComponent>(entity, ids.Mesh);
+        MeshComponent otherMesh = *store.Get<MeshComponent>(other, ids.Mesh);
+
+        Check(store.AddComponents(entity, ComponentBit(ids.Animation)), "AddComponents succeeds");
+        Check(store.GetComponents(entity) == (renderable | ComponentBit(ids.Animation)), "the component was added");
+        const AnimationComponent* animation = store.Get<AnimationComponent>(entity, ids.Animation);
+        Check(animation != nullptr && animation->Speed == 0.0f && animation->Angle == 0.0f &&
+            animation->Axis.x == 0.0f, "an added component starts zeroed");
+        Check(std::memcmp(store.Get<TransformComponent>(entity, ids.Transform), &transform, sizeof(transform)) == 0 &&
+            std::memcmp(store.Get<MeshComponent>(entity, ids.Mesh), &mesh, sizeof(mesh)) == 0,
+            "components are kept when one is added");
+        Check(std::memcmp(store.Get<MeshComponent>(other, ids.Mesh), &otherMesh, sizeof(otherMesh)) == 0,
+            "the entity that fills the vacated row keeps its values");
+
+        store.Get<AnimationComponent>(entity, ids.Animation)->Speed = 2.0f;
+        Check(store.RemoveComponents(entity, ComponentBit(ids.World) | ComponentBit(ids.Mesh)),
+            "RemoveComponents succeeds");
+        Check(store.GetComponents(entity) == (ComponentBit(ids.Transform) | ComponentBit(ids.Animation)),
+            "the components were removed");
+        Check(store.Get<MeshComponent>(entity, ids.Mesh) == nullptr, "a removed component is null");
+        Check(store.Get<AnimationComponent>(entity, ids.Animation)->Speed == 2.0f &&
+            std::memcmp(store.Get<TransformComponent>(entity, ids.Transform), &transform, sizeof(transform)) == 0,
+            "components are kept when others are removed");
+
+        Check(store.AddComponents(entity, ComponentBit(ids.Mesh)), "a removed component can be added back");
+        const MeshComponent* readded = store.Get<MeshComponent>(entity, ids.Mesh);
+        Check(readded != nullptr && readded->IndexCount == 0, "a component added back starts zeroed");
+        size_t archetypes = store.GetArchetypeCount();
+        Check(store.AddComponents(entity, ComponentBit(ids.Transform)) && store.GetArchetypeCount() == archetypes,
+            "adding a component the entity has changes nothing");
+        Check(store.RemoveComponents(entity, ~ComponentMask(0)) && store.GetComponents(entity) == 0 &&
+            store.IsAlive(entity), "an entity without components stays alive");
+    }
+
+    void CheckLayouts()
+    {
+        // Ids 0 to 5, in the order of sizes
+        EntityStore store;
+        RegisterSceneComponents(store);
+        const uint32_t sizes[] = { sizeof(TransformComponent), sizeof(WorldComponent), sizeof(BoundsComponent),
+            sizeof(MeshComponent), sizeof(RenderStateComponent), sizeof(AnimationComponent) };
+
+        bool fits = true, aligned = true, tight = true;
+        for (ComponentMask mask = 0; mask < 64; ++mask)
+        {
+            uint32_t capacity = store.GetChunkCapacity(mask);
+            size_t rowSize = sizeof(Entity);
+            for (uint32_t component = 0; component < 6; ++component)
+            {
+                if (mask & ComponentBit(component))
+                    rowSize += sizes[component];
+            }
+            // Up to 63 bytes of padding before each array
+            size_t padded = EntityStore::ChunkSize - 64 * 6;
+            tight &= capacity <= EntityStore::ChunkSize / rowSize && capacity >= padded / rowSize;
+
+            // One full chunk, its arrays checked against the chunk's bounds
+            std::vector<Entity> entities;
+            for (uint32_t i = 0; i < capacity; ++i)
+                entities.push_back(store.Create(mask));
+            store.ForEachChunk(nullptr, mask, [&](const EntityChunk& chunk, unsigned int)
+            {
+                if (store.GetComponents(chunk.GetEntities()[0]) != mask)
+                    return;
+                const uint8_t* base = reinterpret_cast<const uint8_t*>(chunk.GetEntities());
+                aligned &= reinterpret_cast<uintptr_t>(base) % 64 == 0 && chunk.GetCount() == capacity;
+                for (uint32_t component = 0; component < 6; ++component)
+                {
+                    if (!(mask & ComponentBit(component)))
+                    {
+                        aligned &= !chunk.Has(component);
+                        continue;
+                    }
+                    const uint8_t* array = chunk.Get<uint8_t>(component);
+                    aligned &= chunk.Has(component) && reinterpret_cast<uintptr_t>(array) % 64 == 0;
+                    fits &= array >= base + capacity * sizeof(Entity) &&
+                        array + capacity * sizes[component] <= base + EntityStore::ChunkSize;
+                }
+            });
+            for (Entity entity : entities)
+                store.Destroy(entity);
+        }
+        Check(fits, "the arrays of a full chunk fit in ChunkSize bytes");
+        Check(aligned, "chunks and their arrays start on cache lines");
+        Check(tight, "chunk capacity is within the padding of ChunkSize / row size");
+        Check(store.GetArchetypeCount() == 64 && store.GetChunkCount() == 0, "every archetype was emptied");
+    }
+
+    void CheckQueries()
+    {
+        EntityStore store;
+        SceneComponentIds ids = RegisterSceneComponents(store);
+        std::mt19937 random(11);
+        std::vector<Entity> entities;
+        for (int i = 0; i < 20000; ++i)
+            entities.push_back(store.Create(random() % 64));
+        for (int i = 0; i < 5000; ++i)
+            store.Destroy(entities[random() % entities.size()]);
+
+        bool exact = true;
+        for (ComponentMask required : { ComponentMask(0), ComponentBit(ids.Transform), ComponentBit(ids.Animation),
+            ComponentBit(ids.World) | ComponentBit(ids.Mesh) | ComponentBit(ids.Bounds), ComponentMask(63) })
+        {
+            std::vector<int> visits(entities.size() + 1, 0);
+            store.ForEachChunk(nullptr, required, [&](const EntityChunk& chunk, unsigned int)
+            {
+                for (uint32_t i = 0; i < chunk.GetCount(); ++i)
+                    ++visits[std::min<size_t>(chunk.GetEntities()[i].Index, entities.size())];
+            });
+            for (size_t index = 0; index < entities.size(); ++index)
+            {
+                // No index was reused: every destroy came after every create
+                bool matches = store.IsAlive(entities[index]) &&
+                    (store.GetComponents(entities[index]) & required) == required;
+                exact &= visits[index] == (matches ? 1 : 0);
+            }
+            exact &= visits[entities.size()] == 0;
+        }
+        Check(exact, "a query visits each entity with the required components exactly once");
+    }
+
+    struct SceneSnapshot
+    {
+        std::vector<TransformComponent> Transforms;
+        std::vector<WorldComponent> Worlds;
+        std::vector<BoundsComponent> Bounds;
+        std::vector<AnimationComponent> Animations;
+    };
+
+    SceneSnapshot Snapshot(EntityStore& store, const SceneComponentIds& ids, const std::vector<Entity>& entities)
+    {
+        SceneSnapshot snapshot;
+        for (Entity entity : entities)
+        {
+            const TransformComponent* transform = store.Get<TransformComponent>(entity, ids.Transform);
+            snapshot.Transforms.push_back(transform ? *transform : TransformComponent{});
+            snapshot.Worlds.push_back(*store.Get<WorldComponent>(entity, ids.World));
+            snapshot.Bounds.push_back(*store.Get<BoundsComponent>(entity, ids.Bounds));
+            const AnimationComponent* animation = store.Get<AnimationComponent>(entity, ids.Animation);
+            snapshot.Animations.push_back(animation ? *animation : AnimationComponent{});
+        }
+        return snapshot;
+    }
+
+    bool SameBytes(const SceneSnapshot& a, const SceneSnapshot& b)
+    {
+        auto same = [](const auto& x, const auto& y)
+        {
+            return x.size() == y.size() && std::memcmp(x.data(), y.data(), x.size() * sizeof(x[0])) == 0;
+        };
+        return same(a.Transforms, b.Transforms) && same(a.Worlds, b.Worlds) && same(a.Bounds, b.Bounds) &&
+            same(a.Animations, b.Animations);
+    }
+
+    bool Near(float a, float b)
+    {
+        return std::fabs(a - b) <= 1e-4f * std::max(1.0f, std::fabs(b));
+    }
+
+    void CheckSystems()
+    {
+        const ComponentMask scene[2] = { ComponentMask(0x1f), ComponentMask(0x3f) };
+        // Static objects: a world matrix and bounds but no transform
+        const ComponentMask placed = ComponentMask(0x1e);
+        // Systems one at a time serially, then in parallel, then UpdateScene in parallel
+        SceneSnapshot results[3];
+        std::vector<Entity> entities;
+        for (int run = 0; run < 3; ++run)
+        {
+            EntityStore store;
+            SceneComponentIds ids = RegisterSceneComponents(store);
+            JobSystem jobSystem(4);
+            std::mt19937 random(13);
+            entities.clear();
+            for (int i = 0; i < 10000; ++i)
+            {
+                entities.push_back(store.Create(i % 5 == 4 ? placed : scene[i % 3 == 0]));
+                FillSceneEntity(store, ids, entities.back(), random);
+                if (i % 5 == 4)
+                {
+                    store.Get<WorldComponent>(entities.back(), ids.World)->World = MatrixRotationY(
+                        RandomFloat(random, 0.0f, MathTwoPi)) * MatrixTranslation(RandomFloat(random, -100.0f, 100.0f),
+                        0.0f, RandomFloat(random, -100.0f, 100.0f));
+                }
+            }
+            SceneSnapshot before = Snapshot(store, ids, entities);
+
+            JobSystem* jobs = run == 0 ? nullptr : &jobSystem;
+            for (int frame = 0; frame < 3; ++frame)
+            {
+                if (run == 2)
+                {
+                    UpdateScene(store, jobs, ids, 1.0f / 60.0f);
+                    continue;
+                }
+                AnimateRotations(store, jobs, ids, 1.0f / 60.0f);
+                UpdateWorldMatrices(store, jobs, ids);
+                UpdateWorldBounds(store, jobs, ids);
+            }
+            results[run] = Snapshot(store, ids, entities);
+            if (run != 0)
+                continue;
+
+            // The same frames by direct math, per entity
+            bool matches = true;
+            for (size_t i = 0; i < entities.size(); ++i)
+            {
+                TransformComponent t = before.Transforms[i];
+                AnimationComponent animation = before.Animations[i];
+                ComponentMask components = store.GetComponents(entities[i]);
+                if (components & ComponentBit(ids.Animation))
+                {
+                    for (int frame = 0; frame < 3; ++frame)
+                        animation.Angle = std::fmod(animation.Angle + animation.Speed / 60.0f, MathTwoPi);
+                    t.Rotation = QuaternionRotationAxis(animation.Axis, animation.Angle);
+                }
+                Float4x4 world = before.Worlds[i].World;
+                if (components & ComponentBit(ids.Transform))
+                {
+                    world = MatrixScaling(t.Scale.x, t.Scale.y, t.Scale.z) * MatrixRotationQuaternion(t.Rotation) *
+                        MatrixTranslation(t.Position.x, t.Position.y, t.Position.z);
+                }
+                for (int row = 0; row < 4; ++row)
+                {
+                    for (int col = 0; col < 4; ++col)
+                        matches &= Near(results[0].Worlds[i].World.m[row][col], world.m[row][col]);
+                }
+
+                // Bounds from the 8 transformed corners of the local box
+                const MeshComponent& mesh = *store.Get<MeshComponent>(entities[i], ids.Mesh);
+                Float3 low = { 1e30f, 1e30f, 1e30f }, high = { -1e30f, -1e30f, -1e30f };
+                for (int corner = 0; corner < 8; ++corner)
+                {
+                    Float3 p = { mesh.Center.x + (corner & 1 ? mesh.Extents.x : -mesh.Extents.x),
+                        mesh.Center.y + (corner & 2 ? mesh.Extents.y : -mesh.Extents.y),
+                        mesh.Center.z + (corner & 4 ? mesh.Extents.z : -mesh.Extents.z) };
+                    Float4 w = Vector3Transform(p, world);
+                    low = { std::min(low.x, w.x), std::min(low.y, w.y), std::min(low.z, w.z) };
+                    high = { std::max(high.x, w.x), std::max(high.y, w.y), std::max(high.z, w.z) };
+                }
+                const BoundsComponent& bounds = results[0].Bounds[i];
+                matches &= Near(bounds.Center.x, 0.5f * (low.x + high.x)) &&
+                    Near(bounds.Center.y, 0.5f * (low.y + high.y)) &&
+                    Near(bounds.Center.z, 0.5f * (low.z + high.z)) &&
+                    Near(bounds.Extents.x, 0.5f * (high.x - low.x)) &&
+                    Near(bounds.Extents.y, 0.5f * (high.y - low.y)) &&
+                    Near(bounds.Extents.z, 0.5f * (high.z - low.z));
+            }
+            Check(matches, "the systems give the worlds and bounds of direct math, with or without a transform");
+        }
+        Check(SameBytes(results[0], results[1]), "the systems give the same results serially and in parallel");
+        Check(SameBytes(results[0], results[2]), "UpdateScene gives the results of the systems one at a time");
+    }
+
+    // Live entities as the store should see them: components and a tag kept in the first one
+    struct Expected
+    {
+        Entity Handle;
+        ComponentMask Components;
+        uint32_t Tag;
+    };
+
+    bool MatchesStore(EntityStore& store, const std::vector<Expected>& live, uint32_t tagged)
+    {
+        bool matches = store.GetEntityCount() == live.size();
+        for (const Expected& expected : live)
+        {
+            matches &= store.IsAlive(expected.Handle) && store.GetComponents(expected.Handle) == expected.Components;
+            if (expected.Components & ComponentBit(tagged))
+                matches &= *store.Get<uint32_t>(expected.Handle, tagged) == expected.Tag;
+        }
+        size_t visited = 0;
+        store.ForEachChunk(nullptr, 0, [&](const EntityChunk& chunk, unsigned int) { visited += chunk.GetCount(); });
+        return matches && visited == live.size();
+    }
+
+    void CheckChurn()
+    {
+        EntityStore store;
+        uint32_t tagged = store.RegisterComponent<uint32_t>();
+        for (int i = 0; i < 5; ++i)
+            store.RegisterComponent(24 + 16 * i, 4);
+        std::mt19937 random(17);
+        std::vector<Expected> live;
+        std::vector<Entity> dead;
+        bool consistent = true;
+        uint32_t nextTag = 1;
+        for (int step = 0; step < 200000; ++step)
+        {
+            uint32_t operation = random() % 8;
+            if (operation < 3 || live.empty())
+            {
+                ComponentMask mask = (random() % 64) | ComponentBit(tagged);
+                Expected expected = { store.Create(mask), mask, nextTag++ };
+                *store.Get<uint32_t>(expected.Handle, tagged) = expected.Tag;
+                live.push_back(expected);
+                continue;
+            }
+            size_t pick = random() % live.size();
+            Expected& expected = live[pick];
+            ComponentMask change = ComponentBit(1 + random() % 5);
+            if (operation < 6)
+            {
+                store.Destroy(expected.Handle);
+                dead.push_back(expected.Handle);
+                expected = live.back();
+                live.pop_back();
+            }
+            else if (operation == 6)
+            {
+                consistent &= store.AddComponents(expected.Handle, change);
+                expected.Components |= change;
+            }
+            else
+            {
+                consistent &= store.RemoveComponents(expected.Handle, change);
+                expected.Components &= ~change;
+            }
+            if (step % 20000 == 0)
+                consistent &= MatchesStore(store, live, tagged);
+        }
+        consistent &= MatchesStore(store, live, tagged);
+        for (Entity entity : dead)
+            consistent &= !store.IsAlive(entity);
+        Check(consistent, "random churn keeps every entity and its components");
+
+        // All chunks go to the pool and come back from it
+        size_t memory = store.GetMemoryUsage();
+        for (const Expected& expected : live)
+            store.Destroy(expected.Handle);
+        Check(store.GetEntityCount() == 0 && store.GetChunkCount() == 0, "destroying everything empties every chunk");
+        size_t pooled = store.GetMemoryUsage();
+        Check(pooled >= memory, "emptied chunks are pooled, not freed");
+        std::vector<Entity> recreated;
+        for (const Expected& expected : live)
+            recreated.push_back(store.Create(expected.Components));
+        Check(store.GetMemoryUsage() == pooled, "new chunks come from the pool");
+        size_t chunks = store.GetChunkCount();
+        for (Entity entity : recreated)
+            store.Destroy(entity);
+        store.ReleasePooledChunks();
+        Check(store.GetEntityCount() == 0 && store.GetMemoryUsage() == pooled - chunks * EntityStore::ChunkSize,
+            "ReleasePooledChunks frees the pool");
+    }
+
+    // The same scene data as one struct per entity
+    struct SceneObject
+    {
+        TransformComponent Transform;
+        WorldComponent World;
+        BoundsComponent Bounds;
+        MeshComponent Mesh;
+        RenderStateComponent RenderState;
+        AnimationComponent Animation;
+        bool Animated;
+    };
+
+    void UpdateObject(SceneObject& object, float dt)
+    {
+        if (object.Animated)
+        {
+            AnimationComponent& animation = object.Animation;
+            animation.Angle = std::fmod(animation.Angle + animation.Speed * dt, MathTwoPi);
+            object.Transform.Rotation = QuaternionRotationAxis(animation.Axis, animation.Angle);
+        }
+        const TransformComponent& t = object.Transform;
+        object.World.World = MatrixScaleRotationTranslation(t.Scale, t.Rotation, t.Position);
+
+        const Float4x4& world = object.World.World;
+        const float c[3] = { object.Mesh.Center.x, object.Mesh.Center.y, object.Mesh.Center.z };
+        const float e[3] = { object.Mesh.Extents.x, object.Mesh.Extents.y, object.Mesh.Extents.z };
+        float center[3], extents[3];
+        for (int j = 0; j < 3; ++j)
+        {
+            center[j] = world.m[3][j];
+            extents[j] = 0.0f;
+            for (int k = 0; k < 3; ++k)
+            {
+                center[j] += c[k] * world.m[k][j];
+                extents[j] += e[k] * std::fabs(world.m[k][j]);
+            }
+        }
+        object.Bounds.Center = { center[0], center[1], center[2] };
+        object.Bounds.Extents = { extents[0], extents[1], extents[2] };
+    }
+
+    // Minimum of several runs, in ms
+    template <typename Function>
+    double MeasureMs(int runs, Function&& function)
+    {
+        double best = 1e30;
+        for (int run = 0; run < runs; ++run)
+        {
+            Clock::time_point start = Clock::now();
+            function();
+            best = std::min(best, ElapsedMs(start));
+        }
+        return best;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    size_t entityCount = 1000000;
+    unsigned int threads = 0;
+    for (int i = 1; i < argc; ++i)
+    {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--entities") == 0 && hasValue)
+            entityCount = static_cast<size_t>(std::max(10000, std::atoi(argv[++i])));
+        else if (std::strcmp(argv[i], "--threads") == 0 && hasValue)
+            threads = static_cast<unsigned int>(std::atoi(argv[++i]));
+        else
+        {
+            std::fprintf(stderr, "Usage: %s [--entities N] [--threads N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    CheckLifetime();
+    CheckPackedRemoval();
+    CheckComponentChanges();
+    CheckLayouts();
+    CheckQueries();
+    CheckSystems();
+    CheckChurn();
+    if (g_Failures > 0)
+    {
+        std::fprintf(stderr, "%d check(s) failed\n", g_Failures);
+        return 1;
+    }
+    std::printf("EntityStore checks passed\n\n");
+
+    JobSystem jobSystem(threads);
+    EntityStore store;
+    SceneComponentIds ids = RegisterSceneComponents(store);
+    const ComponentMask staticMask = ComponentBit(ids.Transform) | ComponentBit(ids.World) | ComponentBit(ids.Bounds) |
+        ComponentBit(ids.Mesh) | ComponentBit(ids.RenderState);
+    const ComponentMask animatedMask = staticMask | ComponentBit(ids.Animation);
+
+    std::mt19937 random(1);
+    std::vector<Entity> entities(entityCount);
+    Clock::time_point start = Clock::now();
+    for (size_t i = 0; i < entityCount; ++i)
+    {
+        entities[i] = store.Create(i % 2 ? animatedMask : staticMask);
+        FillSceneEntity(store, ids, entities[i], random);
+    }
+    std::printf("%zu entities in %zu chunks: created in %.1f ms\n\n", entityCount, store.GetChunkCount(),
+        ElapsedMs(start));
+
+    const float dt = 1.0f / 60.0f;
+    const int runs = 5;
+    double storeSystemsMs = MeasureMs(runs, [&]
+    {
+        AnimateRotations(store, nullptr, ids, dt);
+        UpdateWorldMatrices(store, nullptr, ids);
+        UpdateWorldBounds(store, nullptr, ids);
+    });
+    double storeSerialMs = MeasureMs(runs, [&] { UpdateScene(store, nullptr, ids, dt); });
+    double storeParallelMs = MeasureMs(runs, [&] { UpdateScene(store, &jobSystem, ids, dt); });
+
+    // Summing the world centers reads one 24-byte component per entity
+    double checksum = 0.0;
+    double storeReadMs = MeasureMs(runs, [&]
+    {
+        store.ForEachChunk(nullptr, ComponentBit(ids.Bounds), [&](const EntityChunk& chunk, unsigned int)
+        {
+            const BoundsComponent* bounds = chunk.Get<BoundsComponent>(ids.Bounds);
+            for (uint32_t i = 0; i < chunk.GetCount(); ++i)
+                checksum += bounds[i].Center.x + bounds[i].Center.y + bounds[i].Center.z;
+        });
+    });
+
+    // The same objects, one heap allocation each, then one array of them
+    double heapFrameMs, heapReadMs, arrayFrameMs, arrayReadMs;
+    {
+        std::vector<std::unique_ptr<SceneObject>> objects(entityCount);
+        for (size_t i = 0; i < entityCount; ++i)
+        {
+            Entity entity = entities[i];
+            objects[i] = std::make_unique<SceneObject>();
+            SceneObject& object = *objects[i];
+            object.Transform = *store.Get<TransformComponent>(entity, ids.Transform);
+            object.Mesh = *store.Get<MeshComponent>(entity, ids.Mesh);
+            object.RenderState = *store.Get<RenderStateComponent>(entity, ids.RenderState);
+            object.Animated = i % 2 == 1;
+            if (object.Animated)
+                object.Animation = *store.Get<AnimationComponent>(entity, ids.Animation);
+        }
+        heapFrameMs = MeasureMs(runs, [&]
+        {
+            for (const std::unique_ptr<SceneObject>& object : objects)
+                UpdateObject(*object, dt);
+        });
+        heapReadMs = MeasureMs(runs, [&]
+        {
+            for (const std::unique_ptr<SceneObject>& object : objects)
+                checksum += object->Bounds.Center.x + object->Bounds.Center.y + object->Bounds.Center.z;
+        });
+
+        std::vector<SceneObject> array(entityCount);
+        for (size_t i = 0; i < entityCount; ++i)
+            array[i] = *objects[i];
+        objects.clear();
+        arrayFrameMs = MeasureMs(runs, [&]
+        {
+            for (SceneObject& object : array)
+                UpdateObject(object, dt);
+        });
+        arrayReadMs = MeasureMs(runs, [&]
+        {
+            for (const SceneObject& object : array)
+                checksum += object.Bounds.Center.x + object.Bounds.Center.y + object.Bounds.Center.z;
+        });
+    }
+
+    std::printf("%-36s %14s %14s\n", "One frame, ms", "systems", "read bounds");
+    std::printf("%-36s %14.2f %14.2f\n", "heap object per entity", heapFrameMs, heapReadMs);
+    std::printf("%-36s %14.2f %14.2f\n", "array of structs", arrayFrameMs, arrayReadMs);
+    std::printf("%-36s %14.2f %14.2f\n", "EntityStore, one system at a time", storeSystemsMs, storeReadMs);
+    std::printf("%-36s %14.2f %14s\n", "EntityStore, UpdateScene", storeSerialMs, "");
+    char label[64];
+    std::snprintf(label, sizeof(label), "EntityStore, UpdateScene, %u threads", jobSystem.GetWorkerCount());
+    std::printf("%-36s %14.2f %14s\n\n", label, storeParallelMs, "");
+
+    // Churn: every frame 1% of the entities are replaced and 1% start or stop animating
+    size_t churn = entityCount / 100;
+    const int churnFrames = 20;
+    start = Clock::now();
+    for (int f = 0; f < churnFrames; ++f)
+    {
+        for (size_t i = 0; i < churn; ++i)
+        {
+            size_t pick = random() % entityCount;
+            store.Destroy(entities[pick]);
+            entities[pick] = store.Create(random() % 2 ? animatedMask : staticMask);
+        }
+        for (size_t i = 0; i < churn; ++i)
+        {
+            Entity entity = entities[random() % entityCount];
+            if (store.GetComponents(entity) & ComponentBit(ids.Animation))
+                store.RemoveComponents(entity, ComponentBit(ids.Animation));
+            else
+                store.AddComponents(entity, ComponentBit(ids.Animation));
+        }
+    }
+    double churnMs = ElapsedMs(start) / churnFrames;
+    std::printf("Churn of %zu destroy + create and %zu component changes: %.2f ms/frame (%.0f ns each)\n",
+        churn, churn, churnMs, churnMs * 1e6 / (2 * churn));
+    Check(store.GetEntityCount() == entityCount, "churn keeps the entity count");
+
+    size_t rows = 0;
+    store.ForEachChunk(nullptr, 0, [&](const EntityChunk& chunk, unsigned int)
+    {
+        rows += store.GetChunkCapacity(store.GetComponents(chunk.GetEntities()[0]));
+    });
+    size_t componentBytes = sizeof(TransformComponent) + sizeof(WorldComponent) + sizeof(BoundsComponent) +
+        sizeof(MeshComponent) + sizeof(RenderStateComponent) + sizeof(AnimationComponent) / 2;
+    std::printf("Memory: %.1f MB, %.1f bytes/entity for %zu bytes of components, chunks %.1f%% full\n",
+        store.GetMemoryUsage() / 1048576.0, double(store.GetMemoryUsage()) / entityCount, componentBytes,
+        100.0 * entityCount / rows);
+    std::printf("        array of structs: %zu bytes/entity; rows per chunk: %u static, %u animated\n",
+        sizeof(SceneObject), store.GetChunkCapacity(staticMask), store.GetChunkCapacity(animatedMask));
+    std::printf("(checksum %g)\n", checksum);
+    if (g_Failures > 0)
+    {
+        std::fprintf(stderr, "%d check(s) failed\n", g_Failures);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,356 @@
+// Checks and timings of FrustumCulling, the view-frustum test run before
+// DrawIndexed. The checks compare the extracted planes with the clip-space
+// test of View * Projection, the sphere and box tests with a brute-force test
+// in double precision, the AVX2 kernel with the scalar one over ranges with
+// tails, the chunked parallel list with the single-threaded one, and the
+// "09. Transformations" scene's draws with the cubes' corners in clip space.
+// The timings cull 1M objects per frame with each kernel and then with 1 to
+// N threads.
+//
+// Build (from the repository root; -mavx2 selects the AVX2 kernel, otherwise scalar):
+//   g++ -std=c++20 -O2 -mavx2 -pthread -ICommon Benchmarks/FrustumCullingBenchmark.cpp Common/FrustumCulling.cpp
+//       Common/TransformationsScene.cpp Common/TransformBatch.cpp Common/JobSystem.cpp Common/CommandBuffer.cpp
+//       Common/CpuRenderDevice.cpp Common/NullRenderDevice.cpp Common/ConstantBufferRing.cpp Common/SceneGraph.cpp
+//       -o FrustumCullingBenchmark
+//
+// Usage: FrustumCullingBenchmark [--objects N] [--threads N]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "CubeMesh.h"
+#include "FrustumCulling.h"
+#include "JobSystem.h"
+#include "NullRenderDevice.h"
+#include "TransformationsScene.h"
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    int g_Failures = 0;
+
+    void Check(bool condition, const char* what)
+    {
+        if (!condition)
+        {
+            std::fprintf(stderr, "FAILED: %s\n", what);
+            ++g_Failures;
+        }
+    }
+
+    double ElapsedMs(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    Float4x4 CameraViewProjection(const Float3& eye, const Float3& at, float aspect, float farZ)
+    {
+        return MatrixLookAtLH(eye, at, { 0.0f, 1.0f, 0.0f }) * MatrixPerspectiveFovLH(MathPiDiv2, aspect, 0.1f, farZ);
+    }
+
+    double PlaneDistance(const Float4& plane, double x, double y, double z)
+    {
+        return double(plane.x) * x + double(plane.y) * y + double(plane.z) * z + plane.w;
+    }
+
+    // Random world-space boxes in a cube of the given half size
+    BoundsArray RandomBounds(size_t count, float halfSize, float maxExtent, uint32_t seed)
+    {
+        std::mt19937 random(seed);
+        std::uniform_real_distribution<float> position(-halfSize, halfSize);
+        std::uniform_real_distribution<float> extent(0.01f, maxExtent);
+        BoundsArray bounds(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            bounds.Set(i, { position(random), position(random), position(random) },
+                { extent(random), extent(random), extent(random) });
+        }
+        return bounds;
+    }
+
+    void CheckFrustum()
+    {
+        // A point passes all six planes exactly when its clip coordinates are inside the volume
+        std::mt19937 random(3);
+        std::uniform_real_distribution<float> coordinate(-60.0f, 60.0f);
+        int mismatches = 0;
+        for (int camera = 0; camera < 8; ++camera)
+        {
+            Float3 eye = { coordinate(random) * 0.2f, coordinate(random) * 0.2f, coordinate(random) * 0.2f };
+            Float4x4 viewProjection = CameraViewProjection(eye, { coordinate(random), 0.0f, coordinate(random) },
+                1.0f + camera * 0.25f, 50.0f);
+            Frustum frustum = ExtractFrustum(viewProjection);
+            for (int i = 0; i < 20000; ++i)
+            {
+                Float3 p = { coordinate(random), coordinate(random), coordinate(random) };
+                Float4 clip = Vector3Transform(p, viewProjection);
+                bool clipInside = clip.w > 0.0f && std::fabs(clip.x) <= clip.w && std::fabs(clip.y) <= clip.w &&
+                    clip.z >= 0.0f && clip.z <= clip.w;
+                double nearest = 1e30;
+                bool planesInside = true;
+                for (const Float4& plane : frustum.Planes)
+                {
+                    double distance = PlaneDistance(plane, p.x, p.y, p.z);
+                    nearest = std::min(nearest, std::fabs(distance));
+                    planesInside = planesInside && distance >= 0.0;
+                }
+                mismatches += nearest > 1e-3 && clipInside != planesInside;
+            }
+        }
+        Check(mismatches == 0, "frustum: planes agree with the clip-space test");
+
+        Frustum frustum = ExtractFrustum(CameraViewProjection({ 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 1.0f }, 1.0f, 50.0f));
+        bool unit = true;
+        for (const Float4& plane : frustum.Planes)
+            unit = unit && std::fabs(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z - 1.0f) < 1e-5f;
+        Check(unit && std::fabs(frustum.Planes[4].w + 0.1f) < 1e-5f && std::fabs(frustum.Planes[5].w - 50.0f) < 1e-3f,
+            "frustum: normalized planes at the near and far distances");
+    }
+
+    // Visible flags of a brute-force test in double; objects within tolerance of a plane are marked ambiguous
+    void BruteForce(const Frustum& frustum, const BoundsArray& bounds, CullShape shape, std::vector<int>* result)
+    {
+        result->assign(bounds.GetCount(), 1);
+        for (size_t i = 0; i < bounds.GetCount(); ++i)
+        {
+            Float3 c = bounds.GetCenter(i), e = bounds.GetExtents(i);
+            double radius = std::sqrt(double(e.x) * e.x + double(e.y) * e.y + double(e.z) * e.z);
+            for (const Float4& plane : frustum.Planes)
+            {
+                // Sphere: the center's distance; box: the corner farthest along the normal
+                double farthest = -1e30;
+                if (shape == CullShape::Sphere)
+                {
+                    farthest = PlaneDistance(plane, c.x, c.y, c.z) + radius;
+                }
+                else
+                {
+                    for (int corner = 0; corner < 8; ++corner)
+                    {
+                        farthest = std::max(farthest, PlaneDistance(plane, c.x + (corner & 1 ? e.x : -e.x),
+                            c.y + (corner & 2 ? e.y : -e.y), c.z + (corner & 4 ? e.z : -e.z)));
+                    }
+                }
+                if (std::fabs(farthest) < 1e-3)
+                    (*result)[i] = -1;
+                else if (farthest < 0.0 && (*result)[i] == 1)
+                    (*result)[i] = 0;
+            }
+        }
+    }
+
+    void CheckCulling(JobSystem& jobSystem)
+    {
+        BoundsArray bounds = RandomBounds(1003, 40.0f, 3.0f, 7);
+        Frustum frustum = ExtractFrustum(CameraViewProjection({ 1.0f, 2.0f, -3.0f }, { 5.0f, -1.0f, 20.0f },
+            16.0f / 9.0f, 35.0f));
+        std::vector<uint32_t> visible(bounds.GetCount()), scalar(bounds.GetCount());
+        for (CullShape shape : { CullShape::Sphere, CullShape::Box })
+        {
+            std::vector<int> expected;
+            BruteForce(frustum, bounds, shape, &expected);
+            size_t count = CullBounds(frustum, bounds, shape, 0, bounds.GetCount(), visible.data());
+            std::vector<int> flags(bounds.GetCount(), 0);
+            bool ascending = true;
+            for (size_t i = 0; i < count; ++i)
+            {
+                ascending = ascending && visible[i] < bounds.GetCount() && (i == 0 || visible[i] > visible[i - 1]);
+                flags[visible[i]] = 1;
+            }
+            int mismatches = 0, visibleCount = 0;
+            for (size_t i = 0; i < bounds.GetCount(); ++i)
+            {
+                mismatches += expected[i] >= 0 && expected[i] != flags[i];
+                visibleCount += flags[i];
+            }
+            Check(ascending, "cull: compact ascending list");
+            Check(mismatches == 0, shape == CullShape::Sphere ? "cull: sphere test matches the brute-force test" :
+                "cull: box test matches the brute-force test");
+            Check(visibleCount > 20 && visibleCount < 900, "cull: the frustum keeps some objects and culls others");
+
+            // Every sub-range, with tails of 0 to 7 objects, gives the scalar result
+            bool same = true;
+            const size_t ranges[][2] = { { 0, 1003 }, { 3, 500 }, { 5, 12 }, { 7, 7 }, { 1000, 1003 }, { 16, 48 } };
+            for (const size_t* range : ranges)
+            {
+                size_t simdCount = CullBounds(frustum, bounds, shape, range[0], range[1], visible.data());
+                size_t scalarCount = CullBoundsScalar(frustum, bounds, shape, range[0], range[1], scalar.data());
+                same = same && simdCount == scalarCount && std::equal(visible.begin(), visible.begin() + simdCount,
+                    scalar.begin());
+            }
+            Check(same, "cull: batched kernel gives the scalar result");
+        }
+
+        // Chunks culled on several threads are moved together in order
+        BoundsArray many = RandomBounds(100003, 200.0f, 2.0f, 9);
+        Frustum wide = ExtractFrustum(CameraViewProjection({ 0.0f, 0.0f, 0.0f }, { 0.3f, 0.1f, 1.0f }, 1.5f, 150.0f));
+        FrustumCuller serial, parallel;
+        size_t serialCount = serial.Cull(nullptr, wide, many, CullShape::Box);
+        size_t parallelCount = parallel.Cull(&jobSystem, wide, many, CullShape::Box);
+        Check(serialCount > 0 && serialCount == parallelCount && std::equal(serial.GetVisible(),
+            serial.GetVisible() + serialCount, parallel.GetVisible()), "cull: parallel list equals the serial one");
+        Check(parallel.Cull(&jobSystem, wide, many, CullShape::Box) == parallelCount && std::equal(serial.GetVisible(),
+            serial.GetVisible() + serialCount, parallel.GetVisible()), "cull: culling again gives the same list");
+
+        // The box around a transformed box holds its corners
+        BoundsArray transformed(1);
+        Float4x4 world = MatrixScaling(0.5f, 2.0f, 1.0f) * MatrixRotationAxis(Vector3Normalize({ 1.0f, 2.0f, 3.0f }),
+            0.7f) * MatrixTranslation(3.0f, -1.0f, 2.0f);
+        transformed.SetTransformed(0, { 0.5f, 0.0f, -0.5f }, { 1.0f, 0.5f, 0.25f }, world);
+        Float3 c = transformed.GetCenter(0), e = transformed.GetExtents(0);
+        bool contained = true;
+        for (int corner = 0; corner < 8; ++corner)
+        {
+            Float4 p = Vector3Transform({ 0.5f + (corner & 1 ? 1.0f : -1.0f), corner & 2 ? 0.5f : -0.5f,
+                -0.5f + (corner & 4 ? 0.25f : -0.25f) }, world);
+            contained = contained && std::fabs(p.x - c.x) <= e.x + 1e-5f && std::fabs(p.y - c.y) <= e.y + 1e-5f &&
+                std::fabs(p.z - c.z) <= e.z + 1e-5f;
+        }
+        Check(contained, "bounds: transformed box contains the transformed corners");
+    }
+
+    // The scene's cubes, as TransformationsScene::Update places them
+    Float4x4 CubeWorld(int cube, float t)
+    {
+        if (cube == 1)
+            return MatrixTranslation(4.0f * std::cos(t), 2.0f * std::sin(t), 0.0f) * MatrixRotationZ(t * 3.0f);
+
+        Float4x4 orbit = MatrixRotationAxis(Vector3Normalize({ 1.0f, 1.0f, 1.0f }), t);
+        float scale = 0.5f + 0.25f * std::sin(t);
+        return MatrixScaling(scale, scale, scale) * MatrixRotationY(t * 2.0f) *
+            MatrixTranslation(5.0f * std::sin(t * 0.5f), 0.0f, 0.0f) * orbit;
+    }
+
+    // All corners of the cube outside the same clip plane
+    bool CubeOutside(const Float4x4& wvp)
+    {
+        for (int plane = 0; plane < 6; ++plane)
+        {
+            bool allOutside = true;
+            for (const Vertex& vertex : CubeVertices)
+            {
+                Float4 clip = Vector3Transform(vertex.Position, wvp);
+                float sides[6] = { clip.w + clip.x, clip.w - clip.x, clip.w + clip.y, clip.w - clip.y, clip.z,
+                    clip.w - clip.z };
+                allOutside = allOutside && sides[plane] < 0.0f;
+            }
+            if (allOutside)
+                return true;
+        }
+        return false;
+    }
+
+    void CheckScene()
+    {
+        // The cubes stay on screen at 4:3; a narrow window lets them leave the frustum
+        NullRenderDevice device(80, 720);
+        RenderContext& context = device.GetImmediateContext();
+        TransformationsScene scene;
+        Check(scene.Initialize(device), "scene: initialized");
+        Float4x4 viewProjection = MatrixLookAtLH({ 0.0f, 3.0f, -8.0f }, { 0.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }) *
+            MatrixPerspectiveFovLH(MathPiDiv2, 80.0f / 720.0f, 0.01f, 100.0f);
+        int culledFrames = 0, wrongFrames = 0;
+        for (int frame = 0; frame < 1000; ++frame)
+        {
+            float t = frame * 0.025f;
+            scene.Update(t);
+            context.ResetStats();
+            scene.Draw(context);
+
+            // Every cube with a corner inside must be drawn
+            uint64_t onScreen = 0;
+            for (int cube = 0; cube < 2; ++cube)
+                onScreen += !CubeOutside(CubeWorld(cube, t) * viewProjection);
+            uint64_t draws = context.GetStats().Draws;
+            culledFrames += draws < 2;
+            wrongFrames += draws < onScreen || draws > 2;
+        }
+        Check(culledFrames > 0, "scene: cubes leave the frustum and are skipped");
+        Check(wrongFrames == 0, "scene: only cubes entirely outside the frustum are skipped");
+    }
+}
+
+int main(int argc, char** argv)
+{
+    size_t objectCount = 1000000;
+    unsigned int maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--objects") == 0 && i + 1 < argc)
+            objectCount = static_cast<size_t>(std::max(1000, std::atoi(argv[++i])));
+        else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+            maxThreads = static_cast<unsigned int>(std::max(1, std::atoi(argv[++i])));
+    }
+
+    {
+        JobSystem jobSystem(4);
+        CheckFrustum();
+        CheckCulling(jobSystem);
+        CheckScene();
+    }
+    if (g_Failures > 0)
+    {
+        std::fprintf(stderr, "%d check(s) failed\n", g_Failures);
+        return 1;
+    }
+    std::printf("FrustumCulling checks passed\n\n");
+
+    // Objects spread through a 1000-unit cube around a camera that turns a little every frame
+    BoundsArray bounds = RandomBounds(objectCount, 500.0f, 4.0f, 1);
+    std::vector<uint32_t> visible(objectCount);
+    const int frames = 20;
+    auto frameFrustum = [](int frame)
+    {
+        float angle = 0.05f * frame;
+        return ExtractFrustum(CameraViewProjection({ 0.0f, 0.0f, 0.0f }, { std::sin(angle), 0.1f, std::cos(angle) },
+            16.0f / 9.0f, 600.0f));
+    };
+
+    std::printf("kernel: %s, %zu objects\n", GetFrustumCullingInstructionSet(), objectCount);
+    std::printf("%-16s %12s %12s %12s\n", "Single thread", "ms/frame", "ns/object", "visible %");
+    for (CullShape shape : { CullShape::Sphere, CullShape::Box })
+    {
+        for (bool batched : { false, true })
+        {
+            size_t count = 0;
+            Clock::time_point start = Clock::now();
+            for (int frame = 0; frame < frames; ++frame)
+            {
+                Frustum frustum = frameFrustum(frame);
+                count = batched ? CullBounds(frustum, bounds, shape, 0, objectCount, visible.data()) :
+                    CullBoundsScalar(frustum, bounds, shape, 0, objectCount, visible.data());
+            }
+            double ms = ElapsedMs(start) / frames;
+            char name[32];
+            std::snprintf(name, sizeof(name), "%s %s", shape == CullShape::Sphere ? "sphere" : "box",
+                batched ? GetFrustumCullingInstructionSet() : "scalar");
+            std::printf("%-16s %12.3f %12.2f %12.1f\n", name, ms, ms * 1e6 / objectCount,
+                100.0 * count / objectCount);
+        }
+    }
+
+    std::printf("\n%-16s %12s %12s %12s\n", "Box, threads", "ms/frame", "ns/object", "speedup");
+    double singleMs = 0.0;
+    for (unsigned int threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        JobSystem jobSystem(threads);
+        FrustumCuller culler;
+        culler.Cull(&jobSystem, frameFrustum(0), bounds, CullShape::Box);
+        Clock::time_point start = Clock::now();
+        for (int frame = 0; frame < frames; ++frame)
+            culler.Cull(&jobSystem, frameFrustum(frame), bounds, CullShape::Box);
+        double ms = ElapsedMs(start) / frames;
+        if (threads == 1)
+            singleMs = ms;
+        std::printf("%-16u %12.3f %12.2f %11.2fx\n", threads, ms, ms * 1e6 / objectCount, singleMs / ms);
+    }
+    return 0;
+}
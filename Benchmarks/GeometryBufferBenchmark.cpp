@@ -0,0 +1,667 @@
+// Checks and timings of RangeAllocator, the TLSF allocator behind
+// GeometryBuffer, and of drawing many meshes from one shared vertex and index
+// buffer. The allocator is checked against a reference bitmap under random
+// allocations and frees, then compared with two classic free lists (first fit
+// and best fit, both merging neighbours on free) on operations per second and
+// on fragmentation while meshes stream in and out of a buffer held at a given
+// load. The draw part submits the same objects through DrawQueue with a
+// buffer pair per mesh and with one GeometryBuffer, on the null backend, and
+// renders both on the software backend to check they draw the same image.
+//
+// Build (from the repository root):
+//   g++ -std=c++20 -O2 -pthread -ICommon Benchmarks/GeometryBufferBenchmark.cpp Common/GeometryBuffer.cpp
+//       Common/RangeAllocator.cpp Common/DrawQueue.cpp Common/CommandBuffer.cpp Common/CpuRenderDevice.cpp
+//       Common/NullRenderDevice.cpp Common/SoftwareRenderDevice.cpp Common/SoftwareRasterizer.cpp
+//       Common/ConstantBufferRing.cpp Common/PackedVertex.cpp Common/JobSystem.cpp -o GeometryBufferBenchmark
+//
+// Usage: GeometryBufferBenchmark [--operations N] [--objects N]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <map>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "GeometryBuffer.h"
+#include "JobSystem.h"
+#include "NullRenderDevice.h"
+#include "Primitives.h"
+#include "RangeAllocator.h"
+#include "SoftwareRenderDevice.h"
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    int g_Failures = 0;
+
+    void Check(bool condition, const char* what)
+    {
+        if (!condition)
+        {
+            std::fprintf(stderr, "FAILED: %s\n", what);
+            ++g_Failures;
+        }
+    }
+
+    double ElapsedMs(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    // Free ranges by offset; the first one large enough wins
+    class FirstFitAllocator
+    {
+    public:
+        struct Handle
+        {
+            uint32_t Offset;
+            uint32_t Size;
+        };
+
+        explicit FirstFitAllocator(uint32_t capacity) { m_Free[0] = capacity; }
+
+        bool Allocate(uint32_t size, Handle* handle)
+        {
+            for (auto it = m_Free.begin(); it != m_Free.end(); ++it)
+            {
+                if (it->second < size)
+                    continue;
+                *handle = { it->first, size };
+                if (it->second > size)
+                    m_Free[it->first + size] = it->second - size;
+                m_Free.erase(it);
+                return true;
+            }
+            return false;
+        }
+
+        void Free(const Handle& handle) { Insert(handle.Offset, handle.Size); }
+
+        uint32_t GetLargestFreeRange() const
+        {
+            uint32_t largest = 0;
+            for (const auto& range : m_Free)
+                largest = std::max(largest, range.second);
+            return largest;
+        }
+        uint32_t GetFreeRangeCount() const { return static_cast<uint32_t>(m_Free.size()); }
+
+    protected:
+        // Adds a free range merged with its neighbours and returns it
+        std::map<uint32_t, uint32_t>::iterator Insert(uint32_t offset, uint32_t size)
+        {
+            auto next = m_Free.lower_bound(offset);
+            if (next != m_Free.end() && offset + size == next->first)
+            {
+                size += next->second;
+                next = m_Free.erase(next);
+            }
+            if (next != m_Free.begin())
+            {
+                auto prev = std::prev(next);
+                if (prev->first + prev->second == offset)
+                {
+                    prev->second += size;
+                    return prev;
+                }
+            }
+            return m_Free.emplace_hint(next, offset, size);
+        }
+
+        std::map<uint32_t, uint32_t> m_Free;
+    };
+
+    // The same free list plus an index by size; the smallest range large enough wins
+    class BestFitAllocator : public FirstFitAllocator
+    {
+    public:
+        explicit BestFitAllocator(uint32_t capacity) : FirstFitAllocator(capacity) { m_BySize.insert({ capacity, 0 }); }
+
+        bool Allocate(uint32_t size, Handle* handle)
+        {
+            auto best = m_BySize.lower_bound({ size, 0 });
+            if (best == m_BySize.end())
+                return false;
+            uint32_t offset = best->second, rangeSize = best->first;
+            m_BySize.erase(best);
+            m_Free.erase(offset);
+            if (rangeSize > size)
+            {
+                m_Free[offset + size] = rangeSize - size;
+                m_BySize.insert({ rangeSize - size, offset + size });
+            }
+            *handle = { offset, size };
+            return true;
+        }
+
+        void Free(const Handle& handle)
+        {
+            // Drop the neighbours Insert is going to merge from the size index
+            auto next = m_Free.lower_bound(handle.Offset);
+            if (next != m_Free.end() && next->first == handle.Offset + handle.Size)
+                m_BySize.erase({ next->second, next->first });
+            if (next != m_Free.begin())
+            {
+                auto prev = std::prev(next);
+                if (prev->first + prev->second == handle.Offset)
+                    m_BySize.erase({ prev->second, prev->first });
+            }
+            auto merged = Insert(handle.Offset, handle.Size);
+            m_BySize.insert({ merged->second, merged->first });
+        }
+
+        uint32_t GetLargestFreeRange() const { return m_BySize.empty() ? 0 : m_BySize.rbegin()->first; }
+
+    private:
+        std::set<std::pair<uint32_t, uint32_t>> m_BySize;
+    };
+
+    class TlsfAllocator
+    {
+    public:
+        using Handle = RangeAllocation;
+
+        explicit TlsfAllocator(uint32_t capacity) : m_Allocator(capacity) {}
+
+        bool Allocate(uint32_t size, Handle* handle) { return m_Allocator.Allocate(size, handle); }
+        void Free(const Handle& handle) { m_Allocator.Free(handle); }
+        uint32_t GetLargestFreeRange() const { return m_Allocator.GetLargestFreeRange(); }
+        uint32_t GetFreeRangeCount() const { return m_Allocator.GetFreeRangeCount(); }
+
+    private:
+        RangeAllocator m_Allocator;
+    };
+
+    // Mesh sizes spread evenly over the orders of magnitude from 64 to 65536 elements
+    uint32_t RandomMeshSize(std::mt19937& random)
+    {
+        return static_cast<uint32_t>(std::exp2(std::uniform_real_distribution<float>(6.0f, 16.0f)(random)));
+    }
+
+    void CheckAllocator()
+    {
+        RangeAllocator allocator(1000);
+        RangeAllocation a, b, c, d, e;
+        Check(allocator.Allocate(100, &a) && allocator.Allocate(200, &b) && allocator.Allocate(300, &c),
+            "allocator: three ranges");
+        Check(a.Offset == 0 && b.Offset == 100 && c.Offset == 300 && allocator.GetSize(b) == 200,
+            "allocator: ranges packed front to back");
+        allocator.Free(b);
+        allocator.Free(b);
+        Check(allocator.GetFreeRangeCount() == 2 && allocator.GetFreeSize() == 600 &&
+            allocator.GetLargestFreeRange() == 400, "allocator: freed range is a hole, freeing twice is ignored");
+        Check(allocator.Allocate(150, &d) && d.Offset == 100 && allocator.GetFreeSize() == 450,
+            "allocator: hole is reused");
+        Check(!allocator.Allocate(0, &e) && !e && !allocator.Allocate(451, &e) && !e,
+            "allocator: empty and oversized requests fail");
+        allocator.Free(a);
+        allocator.Free(c);
+        allocator.Free(d);
+        Check(allocator.GetFreeRangeCount() == 1 && allocator.GetLargestFreeRange() == 1000,
+            "allocator: freeing everything merges back to one range");
+        Check(allocator.Allocate(1000, &e) && e.Offset == 0 && allocator.GetFreeSize() == 0,
+            "allocator: a request as large as the only free range succeeds");
+        Check(allocator.GetStats().Allocations == 5 && allocator.GetStats().Frees == 4 &&
+            allocator.GetStats().Failures == 2, "allocator: stats");
+
+        // The only range that fits sits behind many smaller ones of the same bin
+        std::vector<RangeAllocation> ranges(41);
+        allocator.Reset(20 * 1001 + 1015);
+        bool filled = true;
+        for (uint32_t i = 0; i < 41; ++i)
+            filled = filled && allocator.Allocate(i == 40 ? 1015 : (i % 2 ? 1 : 1000), &ranges[i]);
+        allocator.Free(ranges[40]);
+        for (uint32_t i = 0; i < 40; i += 2)
+            allocator.Free(ranges[i]);
+        RangeAllocation fit;
+        Check(filled && allocator.GetFreeRangeCount() == 21 && allocator.Allocate(1010, &fit) &&
+            fit.Offset == 20 * 1001, "allocator: a fitting range is found among smaller ones of its bin");
+
+        // Random work against a bitmap of the used elements
+        constexpr uint32_t capacity = 1 << 20;
+        allocator.Reset(capacity);
+        std::mt19937 random(7);
+        std::vector<uint8_t> used(capacity, 0);
+        std::vector<RangeAllocation> live;
+        uint64_t liveSize = 0;
+        bool disjoint = true, consistent = true, exact = true;
+        for (int step = 0; step < 200000; ++step)
+        {
+            if (live.empty() || random() % 100 < 52)
+            {
+                uint32_t size = std::max(1u, RandomMeshSize(random) / 4);
+                uint32_t largest = allocator.GetLargestFreeRange();
+                RangeAllocation allocation;
+                bool allocated = allocator.Allocate(size, &allocation);
+                exact = exact && allocated == (size <= largest);
+                if (!allocated)
+                    continue;
+                for (uint32_t i = allocation.Offset; i < allocation.Offset + size && disjoint; ++i)
+                {
+                    disjoint = i < capacity && !used[i];
+                    used[i] = 1;
+                }
+                live.push_back(allocation);
+                liveSize += size;
+            }
+            else
+            {
+                size_t index = random() % live.size();
+                uint32_t size = allocator.GetSize(live[index]);
+                std::fill(used.begin() + live[index].Offset, used.begin() + live[index].Offset + size, uint8_t(0));
+                allocator.Free(live[index]);
+                liveSize -= size;
+                live[index] = live.back();
+                live.pop_back();
+            }
+            consistent = consistent && allocator.GetFreeSize() == capacity - liveSize;
+        }
+        Check(disjoint, "allocator: ranges never overlap");
+        Check(consistent && exact, "allocator: free size tracked, fails only when nothing fits");
+
+        // Free ranges in the bitmap match the allocator's count once everything is settled
+        uint32_t freeRuns = 0;
+        for (uint32_t i = 0; i < capacity; ++i)
+            freeRuns += !used[i] && (i == 0 || used[i - 1]);
+        Check(freeRuns == allocator.GetFreeRangeCount(), "allocator: neighbouring free ranges are merged");
+        for (const RangeAllocation& allocation : live)
+            allocator.Free(allocation);
+        Check(allocator.GetFreeRangeCount() == 1 && allocator.GetLargestFreeRange() == capacity,
+            "allocator: back to one range");
+    }
+
+    struct PrimitiveMesh
+    {
+        std::vector<Vertex> Vertices;
+        std::vector<uint16_t> Indices;
+    };
+
+    std::vector<PrimitiveMesh> MakeMeshes(uint32_t count)
+    {
+        std::vector<PrimitiveMesh> meshes(count);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            uint32_t detail = 4 + i % 13;
+            std::vector<Vertex>* vertices = &meshes[i].Vertices;
+            std::vector<uint16_t>* indices = &meshes[i].Indices;
+            switch (i % 6)
+            {
+            case 0: GeneratePrimitive(CubeShape{ detail }, nullptr, vertices, indices); break;
+            case 1: GeneratePrimitive(UvSphereShape{ 2 * detail, detail }, nullptr, vertices, indices); break;
+            case 2: GeneratePrimitive(IcosphereShape{ detail / 2 }, nullptr, vertices, indices); break;
+            case 3: GeneratePrimitive(CylinderShape{ 2 * detail, 2 }, nullptr, vertices, indices); break;
+            case 4: GeneratePrimitive(TorusShape{ 2 * detail, detail }, nullptr, vertices, indices); break;
+            default: GeneratePrimitive(CapsuleShape{ 2 * detail, detail }, nullptr, vertices, indices); break;
+            }
+        }
+        return meshes;
+    }
+
+    // A Default buffer pair per mesh, the way every tutorial creates them
+    struct SeparateBuffers
+    {
+        BufferHandle VertexBuffer;
+        BufferHandle IndexBuffer;
+        uint32_t IndexCount;
+    };
+
+    std::vector<SeparateBuffers> CreateSeparateBuffers(RenderDevice& device, const std::vector<PrimitiveMesh>& meshes)
+    {
+        std::vector<SeparateBuffers> buffers(meshes.size());
+        for (size_t i = 0; i < meshes.size(); ++i)
+        {
+            BufferDesc bd;
+            bd.ByteWidth = static_cast<uint32_t>(meshes[i].Vertices.size() * sizeof(Vertex));
+            bd.Bind = BufferBind::VertexBuffer;
+            device.CreateBuffer(bd, meshes[i].Vertices.data(), &buffers[i].VertexBuffer);
+            bd.ByteWidth = static_cast<uint32_t>(meshes[i].Indices.size() * sizeof(uint16_t));
+            bd.Bind = BufferBind::IndexBuffer;
+            device.CreateBuffer(bd, meshes[i].Indices.data(), &buffers[i].IndexBuffer);
+            buffers[i].IndexCount = static_cast<uint32_t>(meshes[i].Indices.size());
+        }
+        return buffers;
+    }
+
+    bool AddMeshes(RenderContext& context, GeometryBuffer& geometry, const std::vector<PrimitiveMesh>& meshes,
+        std::vector<GeometryRange>* ranges)
+    {
+        ranges->resize(meshes.size());
+        bool added = true;
+        for (size_t i = 0; i < meshes.size(); ++i)
+        {
+            added = added && geometry.Add(context, meshes[i].Vertices.data(),
+                static_cast<uint32_t>(meshes[i].Vertices.size()), meshes[i].Indices.data(),
+                static_cast<uint32_t>(meshes[i].Indices.size()), &(*ranges)[i]);
+        }
+        return added;
+    }
+
+    void CheckGeometryBuffer()
+    {
+        NullRenderDevice device(640, 480);
+        RenderContext& context = device.GetImmediateContext();
+        std::vector<PrimitiveMesh> meshes = MakeMeshes(12);
+        GeometryBuffer geometry;
+        Check(geometry.Initialize(device, { sizeof(Vertex), 20000, 100000, Format::R16UInt }),
+            "geometry: buffers created");
+        std::vector<GeometryRange> ranges;
+        Check(AddMeshes(context, geometry, meshes, &ranges), "geometry: meshes added");
+
+        // The bytes land at the ranges' offsets
+        const CpuBuffer* vertexBuffer = device.GetBuffer(geometry.GetVertexBuffer());
+        const CpuBuffer* indexBuffer = device.GetBuffer(geometry.GetIndexBuffer());
+        bool placed = true;
+        for (size_t i = 0; i < meshes.size(); ++i)
+        {
+            const PrimitiveMesh& mesh = meshes[i];
+            placed = placed && std::memcmp(vertexBuffer->Data.data() + ranges[i].BaseVertex * sizeof(Vertex),
+                mesh.Vertices.data(), mesh.Vertices.size() * sizeof(Vertex)) == 0;
+            placed = placed && std::memcmp(indexBuffer->Data.data() + ranges[i].FirstIndex * sizeof(uint16_t),
+                mesh.Indices.data(), mesh.Indices.size() * sizeof(uint16_t)) == 0;
+        }
+        Check(placed, "geometry: vertices and indices uploaded into their ranges");
+
+        // A mesh that does not fit leaves nothing behind; removing one makes room
+        uint32_t freeVertices = geometry.GetVertexAllocator().GetFreeSize();
+        uint32_t freeIndices = geometry.GetIndexAllocator().GetFreeSize();
+        std::vector<Vertex> big(freeVertices - 10);
+        std::vector<uint16_t> bigIndices(freeIndices + 1);
+        GeometryRange range;
+        Check(!geometry.Add(context, big.data(), static_cast<uint32_t>(big.size()), bigIndices.data(),
+            static_cast<uint32_t>(bigIndices.size()), &range) && !range &&
+            geometry.GetVertexAllocator().GetFreeSize() == freeVertices, "geometry: failed add allocates nothing");
+        std::vector<Vertex> tooMany(65537);
+        Check(!geometry.Add(context, tooMany.data(), 65537, bigIndices.data(), 3, &range),
+            "geometry: 16-bit indices cannot address more than 65536 vertices");
+        geometry.Remove(&ranges[3]);
+        Check(!ranges[3] && geometry.GetVertexAllocator().GetFreeSize() == freeVertices + meshes[3].Vertices.size() &&
+            geometry.GetIndexAllocator().GetFreeSize() == freeIndices + meshes[3].Indices.size(),
+            "geometry: remove releases both ranges");
+        Check(geometry.Add(context, meshes[3].Vertices.data(), static_cast<uint32_t>(meshes[3].Vertices.size()),
+            meshes[3].Indices.data(), static_cast<uint32_t>(meshes[3].Indices.size()), &ranges[3]),
+            "geometry: removed mesh added again");
+
+        // What Initialize does with the vertex buffer when the index buffer cannot be created
+        BufferHandle vertexHandle = geometry.GetVertexBuffer();
+        device.ReleaseBuffer(vertexHandle);
+        BufferHandle next;
+        Check(!device.GetBuffer(vertexHandle) && device.CreateBuffer({ 64, BufferBind::VertexBuffer,
+            BufferUsage::Default }, nullptr, &next) && next.Id != vertexHandle.Id, "geometry: released buffer is gone");
+    }
+
+    struct Constants
+    {
+        Float4x4 WVP;
+        Float4 AdditionalColor;
+    };
+
+    Float4x4 ObjectWorld(uint32_t object, uint32_t objectCount)
+    {
+        uint32_t side = static_cast<uint32_t>(std::ceil(std::sqrt(double(objectCount))));
+        float x = float(object % side) - side * 0.5f, z = float(object / side);
+        return MatrixScaling(0.4f, 0.4f, 0.4f) * MatrixRotationY(0.7f * object) * MatrixTranslation(x, 0.0f, z);
+    }
+
+    // Draws objectCount objects on the software backend, with a buffer pair per mesh or one GeometryBuffer
+    std::vector<uint32_t> RenderImage(JobSystem& jobSystem, const std::vector<PrimitiveMesh>& meshes,
+        uint32_t objectCount, bool shared)
+    {
+        SoftwareRenderDevice device(jobSystem, 320, 240);
+        RenderContext& context = device.GetImmediateContext();
+        VertexShaderHandle vertexShader;
+        PixelShaderHandle pixelShader;
+        ShaderDesc vsDesc = { "Effects.fx", "VS", "vs_5_0",
+            { std::begin(VertexInputLayout), std::end(VertexInputLayout) } };
+        ShaderDesc psDesc = { "Effects.fx", "PS", "ps_5_0", {} };
+        Check(device.CreateVertexShader(vsDesc, &vertexShader) && device.CreatePixelShader(psDesc, &pixelShader),
+            "image: shaders created");
+
+        std::vector<SeparateBuffers> separate;
+        GeometryBuffer geometry;
+        std::vector<GeometryRange> ranges;
+        if (shared)
+        {
+            Check(geometry.Initialize(device, { sizeof(Vertex), 1 << 16, 1 << 18, Format::R16UInt }) &&
+                AddMeshes(context, geometry, meshes, &ranges), "image: geometry buffer filled");
+        }
+        else
+        {
+            separate = CreateSeparateBuffers(device, meshes);
+        }
+
+        Float4x4 viewProjection = MatrixLookAtLH({ 0.0f, 4.0f, -5.0f }, { 0.0f, 0.0f, 3.0f }, { 0.0f, 1.0f, 0.0f }) *
+            MatrixPerspectiveFovLH(MathPiDiv2, 320.0f / 240.0f, 0.1f, 100.0f);
+        float clearColor[4] = { 0.0f, 0.125f, 0.3f, 1.0f };
+        context.ClearRenderTarget(clearColor);
+        context.ClearDepthStencil(1.0f, 0);
+        context.SetViewport(device.GetDefaultViewport());
+        context.SetVertexShader(vertexShader);
+        context.SetPixelShader(pixelShader);
+        if (shared)
+            geometry.Bind(context);
+        for (uint32_t object = 0; object < objectCount; ++object)
+        {
+            uint32_t mesh = object % meshes.size();
+            Constants constants = { MatrixTranspose(ObjectWorld(object, objectCount) * viewProjection),
+                { 1.0f, 1.0f, 1.0f, 1.0f } };
+            context.SetVSConstantBufferRange(0, context.AllocateConstants(&constants, sizeof(constants)));
+            if (shared)
+            {
+                GeometryBuffer::Draw(context, ranges[mesh]);
+            }
+            else
+            {
+                context.SetVertexBuffer(0, separate[mesh].VertexBuffer, sizeof(Vertex), 0);
+                context.SetIndexBuffer(separate[mesh].IndexBuffer, Format::R16UInt, 0);
+                context.DrawIndexed(separate[mesh].IndexCount, 0, 0);
+            }
+        }
+        device.Present();
+        const uint32_t* pixels = device.GetRasterizer().GetColorBuffer();
+        return std::vector<uint32_t>(pixels, pixels + 320 * 240);
+    }
+
+    // Random allocations and frees with about `live` allocations alive; returns ns per operation
+    template <typename Allocator>
+    double TimeOperations(uint32_t capacity, uint32_t live, uint32_t operations)
+    {
+        Allocator allocator(capacity);
+        std::mt19937 random(11);
+        std::vector<uint32_t> sizes(1024);
+        for (uint32_t& size : sizes)
+            size = std::max(1u, RandomMeshSize(random) / 16);
+        std::vector<typename Allocator::Handle> handles;
+        handles.reserve(live);
+        for (uint32_t i = 0; i < live; ++i)
+        {
+            typename Allocator::Handle handle;
+            if (allocator.Allocate(sizes[i % sizes.size()], &handle))
+                handles.push_back(handle);
+        }
+
+        Clock::time_point start = Clock::now();
+        for (uint32_t i = 0; i < operations / 2; ++i)
+        {
+            size_t index = random() % handles.size();
+            allocator.Free(handles[index]);
+            if (!allocator.Allocate(sizes[i % sizes.size()], &handles[index]))
+            {
+                handles[index] = handles.back();
+                handles.pop_back();
+            }
+        }
+        return ElapsedMs(start) * 1e6 / operations;
+    }
+
+    struct StreamingResult
+    {
+        double FailedPercent;
+        double LargestFreePercent;      // Largest free range, percent of the free space
+        double FreeRanges;
+    };
+
+    // Meshes stream in and out of a buffer held at a load: every step removes a random
+    // mesh and adds meshes until the load is back, counting the adds that fail
+    template <typename Allocator>
+    StreamingResult Stream(uint32_t capacity, double load, uint32_t steps)
+    {
+        Allocator allocator(capacity);
+        std::mt19937 random(5);
+        struct Live
+        {
+            typename Allocator::Handle Handle;
+            uint32_t Size;
+        };
+        std::vector<Live> live;
+        uint64_t used = 0, attempts = 0, failures = 0;
+        double largestFree = 0.0, freeRanges = 0.0;
+        uint64_t target = static_cast<uint64_t>(capacity * load);
+        for (uint32_t step = 0; step < steps; ++step)
+        {
+            if (!live.empty())
+            {
+                size_t index = random() % live.size();
+                allocator.Free(live[index].Handle);
+                used -= live[index].Size;
+                live[index] = live.back();
+                live.pop_back();
+            }
+            while (used < target)
+            {
+                uint32_t size = RandomMeshSize(random);
+                Live mesh = { {}, size };
+                ++attempts;
+                if (!allocator.Allocate(size, &mesh.Handle))
+                {
+                    ++failures;
+                    break;
+                }
+                live.push_back(mesh);
+                used += size;
+            }
+            largestFree += 100.0 * allocator.GetLargestFreeRange() / std::max<uint64_t>(1, capacity - used);
+            freeRanges += allocator.GetFreeRangeCount();
+        }
+        return { 100.0 * failures / std::max<uint64_t>(1, attempts), largestFree / steps, freeRanges / steps };
+    }
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t operations = 2000000;
+    uint32_t objectCount = 4096;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--operations") == 0 && i + 1 < argc)
+            operations = static_cast<uint32_t>(std::max(1000, std::atoi(argv[++i])));
+        else if (std::strcmp(argv[i], "--objects") == 0 && i + 1 < argc)
+            objectCount = static_cast<uint32_t>(std::max(1, std::atoi(argv[++i])));
+    }
+
+    JobSystem jobSystem;
+    std::vector<PrimitiveMesh> meshes = MakeMeshes(64);
+    CheckAllocator();
+    CheckGeometryBuffer();
+    Check(RenderImage(jobSystem, meshes, 100, true) == RenderImage(jobSystem, meshes, 100, false),
+        "image: shared buffers draw the same image as a buffer pair per mesh");
+    if (g_Failures > 0)
+    {
+        std::fprintf(stderr, "%d check(s) failed\n", g_Failures);
+        return 1;
+    }
+    std::printf("GeometryBuffer checks passed\n\n");
+
+    // Allocator speed with a given number of live allocations
+    std::printf("%-22s %12s %12s %12s\n", "ns per alloc/free", "TLSF", "First fit", "Best fit");
+    for (uint32_t live : { 1000u, 10000u, 100000u })
+    {
+        uint32_t capacity = live * 4096;
+        std::printf("%-22s %12.1f %12.1f %12.1f\n", (std::to_string(live) + " live").c_str(),
+            TimeOperations<TlsfAllocator>(capacity, live, operations),
+            TimeOperations<FirstFitAllocator>(capacity, live, std::min(operations, 200000u)),
+            TimeOperations<BestFitAllocator>(capacity, live, operations));
+    }
+
+    // Fragmentation of a 64M-element buffer streaming meshes of 64 to 65536 elements
+    std::printf("\n%-6s %-10s %10s %16s %12s\n", "Load", "Allocator", "Failed %", "Largest free %", "Free ranges");
+    for (double load : { 0.7, 0.85, 0.95 })
+    {
+        uint32_t capacity = 64u << 20, steps = 20000;
+        StreamingResult results[] = { Stream<TlsfAllocator>(capacity, load, steps),
+            Stream<FirstFitAllocator>(capacity, load, steps / 10), Stream<BestFitAllocator>(capacity, load, steps) };
+        const char* names[] = { "TLSF", "First fit", "Best fit" };
+        for (int i = 0; i < 3; ++i)
+        {
+            std::printf("%-6.2f %-10s %10.2f %16.1f %12.0f\n", load, names[i], results[i].FailedPercent,
+                results[i].LargestFreePercent, results[i].FreeRanges);
+        }
+    }
+
+    // Submitting objects that cycle through 64 meshes, through DrawQueue on the null backend
+    NullRenderDevice device(1280, 720);
+    RenderContext& context = device.GetImmediateContext();
+    std::vector<SeparateBuffers> separate = CreateSeparateBuffers(device, meshes);
+    GeometryBuffer geometry;
+    std::vector<GeometryRange> ranges;
+    if (!geometry.Initialize(device, { sizeof(Vertex), 1 << 16, 1 << 18, Format::R16UInt }) ||
+        !AddMeshes(context, geometry, meshes, &ranges))
+    {
+        std::fprintf(stderr, "Could not fill the geometry buffer\n");
+        return 1;
+    }
+    VertexShaderHandle vertexShader;
+    PixelShaderHandle pixelShader;
+    ShaderDesc vsDesc = { "Effects.fx", "VS", "vs_5_0",
+        { std::begin(VertexInputLayout), std::end(VertexInputLayout) } };
+    ShaderDesc psDesc = { "Effects.fx", "PS", "ps_5_0", {} };
+    device.CreateVertexShader(vsDesc, &vertexShader);
+    device.CreatePixelShader(psDesc, &pixelShader);
+
+    std::printf("\n%u objects over %zu meshes, DrawQueue on the null backend:\n", objectCount, meshes.size());
+    std::printf("%-22s %12s %12s %14s\n", "Buffers", "Binds/frame", "Skipped", "us per frame");
+    const int frames = 50;
+    for (bool shared : { false, true })
+    {
+        DrawQueue queue;
+        Clock::time_point start = Clock::now();
+        for (int frame = 0; frame < frames; ++frame)
+        {
+            for (uint32_t object = 0; object < objectCount; ++object)
+            {
+                uint32_t mesh = object % meshes.size();
+                DrawCommand command;
+                command.VertexShader = vertexShader;
+                command.PixelShader = pixelShader;
+                if (shared)
+                {
+                    geometry.FillDrawCommand(ranges[mesh], &command);
+                }
+                else
+                {
+                    command.VertexBuffer = separate[mesh].VertexBuffer;
+                    command.VertexStride = sizeof(Vertex);
+                    command.IndexBuffer = separate[mesh].IndexBuffer;
+                    command.IndexCount = separate[mesh].IndexCount;
+                }
+                Constants constants = { MatrixTranspose(ObjectWorld(object, objectCount)), {} };
+                command.VSConstants = context.AllocateConstants(&constants, sizeof(constants));
+                // Sorted by depth only, as a front-to-back pass would be, so meshes interleave
+                queue.Submit(MakeDrawKey(0, vertexShader.Id, 0, 0, QuantizeDrawDepth(float(object) / objectCount)),
+                    command);
+            }
+            queue.Execute(context);
+            device.Present();
+        }
+        double us = ElapsedMs(start) * 1000.0 / frames;
+        std::printf("%-22s %12.0f %12.0f %14.1f\n", shared ? "One GeometryBuffer" : "Pair per mesh",
+            double(queue.GetStats().Binds) / frames, double(queue.GetStats().SkippedBinds) / frames, us);
+    }
+    return 0;
+}
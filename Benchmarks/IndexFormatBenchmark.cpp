@@ -0,0 +1,575 @@
+// Test corpus and benchmark for the index format choice of WriteMeshFile and
+// for SplitMeshForIndex16 (MeshSplitter.h). The corpus writes meshes at the
+// 16-bit boundaries (65535, 65536 and 65537 vertices, index 0xFFFF, a vertex
+// range that only fits after rebasing BaseVertex, submeshes of mixed widths
+// and empty ones, degenerate triangles, forced formats) and checks the format,
+// BaseVertex and FirstIndex of every submesh, and that every index read back
+// from the file addresses the vertex it did before. The splitter checks cover
+// the chunk limit with shared and degenerate vertices, dropped vertices and
+// the bytes-saved decision, and the software backend draws a split mesh with
+// 16-bit submeshes identically to the same mesh with 32-bit indices. The
+// benchmark splits grids of millions of triangles in three orders and reports
+// chunks, duplicated vertices and the bytes of both index widths.
+//
+// Build (from the repository root):
+//   g++ -std=c++20 -O2 -pthread -ICommon Benchmarks/IndexFormatBenchmark.cpp Common/MeshSplitter.cpp
+//       Common/MeshFile.cpp Common/MeshOptimizer.cpp Common/PackedVertex.cpp Common/MappedFile.cpp
+//       Common/JobSystem.cpp Common/SoftwareRasterizer.cpp Common/CommandBuffer.cpp Common/CpuRenderDevice.cpp
+//       Common/SoftwareRenderDevice.cpp Common/ConstantBufferRing.cpp -o IndexFormatBenchmark
+//
+// Usage: IndexFormatBenchmark [--triangles N] [--dir PATH]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "JobSystem.h"
+#include "MeshFile.h"
+#include "MeshOptimizer.h"
+#include "MeshSplitter.h"
+#include "SoftwareRenderDevice.h"
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    int g_Failures = 0;
+
+    void Check(bool condition, const char* what)
+    {
+        if (!condition)
+        {
+            std::fprintf(stderr, "FAILED: %s\n", what);
+            ++g_Failures;
+        }
+    }
+
+    double ElapsedMs(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    // vertexCount vertices on rows of 256, with one triangle (i, i + 1, i + 2) for every i
+    // from firstVertex, so the triangles reference exactly [firstVertex, vertexCount)
+    MeshData MakeStrip(uint32_t vertexCount, uint32_t firstVertex = 0)
+    {
+        MeshData mesh;
+        mesh.Vertices.resize(vertexCount);
+        for (uint32_t i = 0; i < vertexCount; ++i)
+            mesh.Vertices[i] = { { float(i % 256), float(i / 256), float(i % 3) }, { 1.0f, 1.0f, 1.0f, 1.0f } };
+        for (uint32_t i = firstVertex; i + 2 < vertexCount; ++i)
+            mesh.Indices.insert(mesh.Indices.end(), { i, i + 1, i + 2 });
+        return mesh;
+    }
+
+    // columns x rows quads in row order, colored by position so that a wrong vertex shows
+    MeshData MakeGrid(uint32_t columns, uint32_t rows)
+    {
+        MeshData mesh;
+        for (uint32_t y = 0; y <= rows; ++y)
+        {
+            for (uint32_t x = 0; x <= columns; ++x)
+            {
+                Float4 color = { float(x) / columns, float(y) / rows, float((x * 7 + y * 13) % 17) / 16.0f, 1.0f };
+                mesh.Vertices.push_back({ { float(x), float(y), 0.0f }, color });
+            }
+        }
+        for (uint32_t y = 0; y < rows; ++y)
+        {
+            for (uint32_t x = 0; x < columns; ++x)
+            {
+                uint32_t a = y * (columns + 1) + x, b = a + 1, c = b + columns + 1, d = c - 1;
+                mesh.Indices.insert(mesh.Indices.end(), { a, d, c, a, c, b });
+            }
+        }
+        return mesh;
+    }
+
+    void ShuffleTriangles(MeshData* mesh, uint32_t seed)
+    {
+        std::mt19937 random(seed);
+        size_t triangleCount = mesh->Indices.size() / 3;
+        for (size_t t = triangleCount; t > 1; --t)
+        {
+            size_t other = random() % t;
+            std::swap_ranges(mesh->Indices.begin() + (t - 1) * 3, mesh->Indices.begin() + t * 3,
+                mesh->Indices.begin() + other * 3);
+        }
+    }
+
+    uint32_t ReadIndex(const MeshFile& file, Format format, size_t i)
+    {
+        const uint8_t* data = static_cast<const uint8_t*>(file.GetIndexData());
+        if (format == Format::R16UInt)
+        {
+            uint16_t index;
+            std::memcpy(&index, data + i * 2, sizeof(index));
+            return index;
+        }
+        uint32_t index;
+        std::memcpy(&index, data + i * 4, sizeof(index));
+        return index;
+    }
+
+    // Every index the file draws, resolved to a vertex the way the input assembler does,
+    // against the vertex the desc's index addressed
+    bool SameVertices(const MeshFile& file, const MeshFileDesc& desc, const std::vector<MeshSubmesh>& submeshes)
+    {
+        const std::vector<MeshSubmesh>& written = file.GetSubmeshes();
+        if (written.size() != submeshes.size())
+            return false;
+        for (size_t s = 0; s < written.size(); ++s)
+        {
+            const MeshSubmesh& submesh = written[s];
+            if (submesh.IndexCount != submeshes[s].IndexCount ||
+                uint64_t(submesh.FirstIndex + submesh.IndexCount) * GetFormatSize(submesh.IndexFormat) >
+                file.GetIndexBytes())
+                return false;
+            for (uint32_t i = 0; i < submesh.IndexCount; ++i)
+            {
+                int64_t vertex = int64_t(ReadIndex(file, submesh.IndexFormat, submesh.FirstIndex + i)) +
+                    submesh.BaseVertex;
+                int64_t expected = int64_t(desc.Indices[submeshes[s].FirstIndex + i]) + submeshes[s].BaseVertex;
+                if (vertex != expected)
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    struct CorpusCase
+    {
+        const char* Name = nullptr;
+        MeshData Mesh;
+        std::vector<uint32_t> Indices;          // Replaces Mesh.Indices when not empty
+        std::vector<MeshSubmesh> Submeshes;     // Empty for one submesh over everything
+        Format IndexFormat = Format::Unknown;
+        // Expected per submesh, or the error WriteMeshFile gives
+        std::vector<Format> Formats;
+        std::vector<int32_t> BaseVertices;
+        const char* Error = nullptr;
+    };
+
+    std::vector<CorpusCase> MakeCorpus()
+    {
+        const Format R16 = Format::R16UInt;
+        const Format R32 = Format::R32UInt;
+        std::vector<CorpusCase> corpus;
+
+        corpus.push_back({ "65535 vertices", MakeStrip(0xFFFF), {}, {}, Format::Unknown, { R16 }, { 0 } });
+        corpus.push_back({ "65536 vertices, index 0xFFFF", MakeStrip(0x10000), {}, {}, Format::Unknown,
+            { R16 }, { 0 } });
+        corpus.push_back({ "65537 vertices", MakeStrip(0x10001), {}, {}, Format::Unknown, { R32 }, { 0 } });
+        corpus.push_back({ "65537 vertices, vertex 0 unused", MakeStrip(0x10001, 1), {}, {}, Format::Unknown,
+            { R16 }, { 1 } });
+        corpus.push_back({ "forced 32-bit", MakeStrip(100), {}, {}, R32, { R32 }, { 0 } });
+        corpus.push_back({ "forced 16-bit, rebased", MakeStrip(0x10001, 1), {}, {}, R16, { R16 }, { 1 } });
+        corpus.push_back({ "forced 16-bit, 65537 apart", MakeStrip(0x10001), {}, {}, R16, {}, {}, "16 bits" });
+
+        // Indices already relative to the submesh's BaseVertex are kept as they are
+        {
+            CorpusCase rebased;
+            rebased.Name = "base vertex kept";
+            rebased.Mesh = MakeStrip(70000);
+            rebased.Indices = rebased.Mesh.Indices;
+            uint32_t split = 60000 * 3;
+            for (size_t i = split; i < rebased.Indices.size(); ++i)
+                rebased.Indices[i] -= 60000;
+            rebased.Submeshes = { { 0, split, 0 }, { split, uint32_t(rebased.Indices.size()) - split, 60000 } };
+            rebased.Formats = { R16, R16 };
+            rebased.BaseVertices = { 0, 60000 };
+            corpus.push_back(std::move(rebased));
+        }
+
+        // 16-bit, 32-bit, empty and rebased 16-bit ranges in one index stream
+        {
+            CorpusCase mixed;
+            mixed.Name = "mixed widths";
+            mixed.Mesh = MakeStrip(100000);
+            uint32_t indexCount = static_cast<uint32_t>(mixed.Mesh.Indices.size());
+            mixed.Submeshes = { { 0, 3, 0 }, { 0, indexCount, 0 }, { 30, 0, 0 }, { indexCount - 30, 30, 0 } };
+            mixed.Formats = { R16, R32, R16, R16 };
+            mixed.BaseVertices = { 0, 0, 0, 100000 - 12 };
+            corpus.push_back(std::move(mixed));
+        }
+
+        {
+            CorpusCase degenerate;
+            degenerate.Name = "degenerate triangles";
+            degenerate.Mesh = MakeStrip(10);
+            degenerate.Indices = degenerate.Mesh.Indices;
+            degenerate.Indices.insert(degenerate.Indices.end(), { 0, 0, 0, 5, 5, 9 });
+            degenerate.Formats = { R16 };
+            degenerate.BaseVertices = { 0 };
+            corpus.push_back(std::move(degenerate));
+        }
+
+        {
+            CorpusCase empty;
+            empty.Name = "only empty submeshes";
+            empty.Mesh = MakeStrip(10);
+            empty.Submeshes = { { 0, 0, 0 }, { 3, 0, 0 } };
+            empty.Error = "no indices";
+            corpus.push_back(std::move(empty));
+        }
+        return corpus;
+    }
+
+    void CheckCorpus(const std::filesystem::path& directory)
+    {
+        std::string path = (directory / "IndexFormatBenchmark-corpus.mesh").string();
+        for (CorpusCase& corpusCase : MakeCorpus())
+        {
+            if (!corpusCase.Indices.empty())
+                corpusCase.Mesh.Indices = corpusCase.Indices;
+            std::vector<uint8_t> storage;
+            MeshFileDesc desc = MakeMeshFileDesc(corpusCase.Mesh, VertexFormat::Float32, &storage);
+            desc.Submeshes = corpusCase.Submeshes;
+            desc.IndexFormat = corpusCase.IndexFormat;
+            std::vector<MeshSubmesh> submeshes = desc.Submeshes;
+            if (submeshes.empty())
+                submeshes.push_back({ 0, desc.IndexCount, 0 });
+
+            std::string error;
+            bool written = WriteMeshFile(path, desc, &error);
+            std::string what;
+            if (corpusCase.Error)
+            {
+                if (written || error.find(corpusCase.Error) == std::string::npos)
+                    what = "expected the error \"" + std::string(corpusCase.Error) + "\", got \"" + error + "\"";
+            }
+            else
+            {
+                MeshFile file;
+                if (!written || !file.Open(path, &error))
+                {
+                    what = "write / open: " + error;
+                }
+                else
+                {
+                    const std::vector<MeshSubmesh>& loaded = file.GetSubmeshes();
+                    for (size_t s = 0; s < loaded.size() && s < corpusCase.Formats.size(); ++s)
+                    {
+                        if (loaded[s].IndexFormat != corpusCase.Formats[s] ||
+                            loaded[s].BaseVertex != corpusCase.BaseVertices[s])
+                        {
+                            what = "submesh " + std::to_string(s) + " has format " +
+                                std::to_string(GetFormatSize(loaded[s].IndexFormat) * 8) + " bits, base vertex " +
+                                std::to_string(loaded[s].BaseVertex);
+                        }
+                    }
+                    if (!SameVertices(file, desc, submeshes))
+                        what = "indices read back address other vertices";
+                    const MeshStream& stream = file.GetStream(0);
+                    if (!ValidateMeshFile(static_cast<const uint8_t*>(file.GetMappedFile().GetData()),
+                        file.GetMappedFile().GetSize(), MeshFileValidation::Full, &error))
+                        what = "full validation: " + error;
+                    if (stream.Data == nullptr || file.GetVertexCount() != corpusCase.Mesh.Vertices.size())
+                        what = "vertex count";
+                }
+            }
+            if (!what.empty())
+            {
+                std::fprintf(stderr, "FAILED: corpus: %s: %s\n", corpusCase.Name, what.c_str());
+                ++g_Failures;
+            }
+        }
+
+        // The 32-bit range after three 16-bit indices starts on the next 4-byte boundary, and
+        // 0xFFFF is stored as an ordinary index
+        MeshData strip = MakeStrip(100000);
+        std::vector<uint8_t> storage;
+        MeshFileDesc desc = MakeMeshFileDesc(strip, VertexFormat::Float32, &storage);
+        desc.Submeshes = { { 0, 3, 0 }, { 0, desc.IndexCount, 0 } };
+        std::string error;
+        MeshFile file;
+        Check(WriteMeshFile(path, desc, &error) && file.Open(path, &error), "corpus: mixed widths write");
+        if (file.IsOpen())
+        {
+            Check(file.GetSubmeshes()[1].FirstIndex == 2 && file.GetIndexBytes() == 8 + desc.IndexCount * 4 &&
+                file.GetIndexCount() == 3 + desc.IndexCount, "corpus: 32-bit range aligned after 16-bit one");
+        }
+        file.Close();
+
+        MeshData full = MakeStrip(0x10000);
+        desc = MakeMeshFileDesc(full, VertexFormat::Float32, &storage);
+        Check(WriteMeshFile(path, desc, &error) && file.Open(path, &error), "corpus: 65536 vertices write");
+        if (file.IsOpen())
+        {
+            uint32_t last = file.GetIndexCount() - 1;
+            Check(ReadIndex(file, Format::R16UInt, last) == 0xFFFF, "corpus: 0xFFFF stored as an index");
+        }
+        file.Close();
+        std::filesystem::remove(path);
+    }
+
+    // Every chunk references at most maxVertices vertices, all inside its own contiguous range,
+    // and every triangle still has its positions and colors
+    bool ValidSplit(const MeshData& mesh, const MeshData& split, const std::vector<MeshSubmesh>& chunks,
+        uint32_t maxVertices)
+    {
+        if (split.Indices.size() != mesh.Indices.size())
+            return false;
+        uint32_t nextIndex = 0;
+        uint32_t nextVertex = 0;
+        for (const MeshSubmesh& chunk : chunks)
+        {
+            if (chunk.FirstIndex != nextIndex || chunk.IndexCount == 0 || chunk.IndexCount % 3 != 0)
+                return false;
+            uint32_t firstVertex = nextVertex;
+            for (uint32_t i = chunk.FirstIndex; i < chunk.FirstIndex + chunk.IndexCount; ++i)
+            {
+                uint32_t index = split.Indices[i];
+                if (index < firstVertex || index > nextVertex || index - firstVertex >= maxVertices)
+                    return false;
+                nextVertex = std::max(nextVertex, index + 1);
+                const Vertex& a = split.Vertices[index];
+                const Vertex& b = mesh.Vertices[mesh.Indices[i]];
+                if (std::memcmp(&a, &b, sizeof(Vertex)) != 0)
+                    return false;
+            }
+            nextIndex += chunk.IndexCount;
+        }
+        return nextIndex == mesh.Indices.size() && nextVertex == split.Vertices.size();
+    }
+
+    void CheckSplitter()
+    {
+        MeshData grid = MakeGrid(40, 30);
+        MeshData split;
+        std::vector<MeshSubmesh> chunks;
+        uint32_t duplicated = SplitMesh(grid, 100, &split, &chunks);
+        Check(chunks.size() > 10 && ValidSplit(grid, split, chunks, 100), "splitter: chunks of 100 vertices");
+        Check(split.Vertices.size() == grid.Vertices.size() + duplicated && duplicated > 0,
+            "splitter: duplicated vertex count");
+
+        // Degenerate triangles count each vertex once: (0, 0, 1) takes 2, (1, 2, 3) needs a second chunk
+        MeshData degenerate = MakeStrip(4);
+        degenerate.Indices = { 0, 0, 1, 1, 2, 3, 3, 3, 3 };
+        Check(SplitMesh(degenerate, 3, &split, &chunks) == 1 && chunks.size() == 2 &&
+            chunks[1].FirstIndex == 3 && chunks[1].IndexCount == 6 && ValidSplit(degenerate, split, chunks, 3),
+            "splitter: degenerate triangles");
+
+        MeshData unreferenced = MakeStrip(1000);
+        unreferenced.Indices.resize(30);
+        Check(SplitMesh(unreferenced, 0x10000, &split, &chunks) == 0 && split.Vertices.size() == 12 &&
+            chunks.size() == 1, "splitter: unreferenced vertices dropped");
+        MeshData empty;
+        Check(SplitMesh(empty, 0x10000, &split, &chunks) == 0 && chunks.empty(), "splitter: empty mesh");
+
+        // The 16-bit boundary: 65536 vertices fit, 65537 need two chunks sharing two vertices
+        MeshData fits = MakeStrip(0x10000);
+        std::vector<MeshSubmesh> submeshes = { { 0, 3, 0 } };
+        MeshSplitStats stats;
+        Check(!SplitMeshForIndex16(&fits, &submeshes, {}, &stats) && submeshes.empty() &&
+            fits.Vertices.size() == 0x10000 && stats.Chunks == 1, "splitter: 65536 vertices are not split");
+        MeshData over = MakeStrip(0x10001);
+        MeshData original = over;
+        Check(SplitMeshForIndex16(&over, &submeshes, {}, &stats) && stats.Chunks == 2 &&
+            stats.DuplicatedVertices == 2 && stats.BytesAfter < stats.BytesBefore &&
+            ValidSplit(original, over, submeshes, 0x10000), "splitter: 65537 vertices make two chunks");
+
+        // Shuffled triangles share vertices across every chunk: not worth it unless forced
+        MeshData shuffled = MakeGrid(300, 250);
+        ShuffleTriangles(&shuffled, 7);
+        original = shuffled;
+        Check(!SplitMeshForIndex16(&shuffled, &submeshes, {}, &stats) && stats.BytesAfter >= stats.BytesBefore &&
+            shuffled.Vertices.size() == original.Vertices.size(), "splitter: shuffled grid is left alone");
+        MeshSplitOptions force;
+        force.Force = true;
+        Check(SplitMeshForIndex16(&shuffled, &submeshes, force, &stats) &&
+            ValidSplit(original, shuffled, submeshes, 0x10000), "splitter: forced split");
+    }
+
+    // Draws every submesh of a .mesh file with its own index format and base vertex
+    std::vector<uint32_t> RenderMeshFile(JobSystem& jobSystem, const std::string& path, size_t* draws)
+    {
+        MeshFile file;
+        if (!file.Open(path, nullptr))
+            return {};
+
+        SoftwareRenderDevice device(jobSystem, 320, 240);
+        VertexShaderHandle vertexShader;
+        PixelShaderHandle pixelShader;
+        RasterizerStateHandle rasterizerState;
+        BufferHandle vertexBuffer, indexBuffer;
+        RasterizerDesc rasterizerDesc;
+        rasterizerDesc.Cull = CullMode::None;
+        if (!device.CreateVertexShader({ "Effects.fx", "VS", "vs_5_0", file.GetStream(0).Layout }, &vertexShader) ||
+            !device.CreatePixelShader({ "Effects.fx", "PS", "ps_5_0", {} }, &pixelShader) ||
+            !device.CreateRasterizerState(rasterizerDesc, &rasterizerState) ||
+            !file.CreateBuffers(device, &vertexBuffer, &indexBuffer))
+            return {};
+
+        // Fit the grid into the viewport
+        Float3 size = Vector3Subtract(file.GetBoundsMax(), file.GetBoundsMin());
+        Float4x4 world = MatrixTranslation(-file.GetBoundsMin().x - size.x / 2, -file.GetBoundsMin().y - size.y / 2,
+            0.5f) * MatrixScaling(1.9f / size.x, 1.9f / size.y, 1.0f);
+        Float4x4 constants = MatrixTranspose(world);
+
+        RenderContext& context = device.GetImmediateContext();
+        float clearColor[4] = { 0.0f, 0.125f, 0.3f, 1.0f };
+        context.ClearRenderTarget(clearColor);
+        context.ClearDepthStencil(1.0f, 0);
+        context.SetViewport(device.GetDefaultViewport());
+        context.SetVertexBuffer(0, vertexBuffer, file.GetStream(0).Stride, 0);
+        context.SetVertexShader(vertexShader);
+        context.SetPixelShader(pixelShader);
+        context.SetRasterizerState(rasterizerState);
+        context.SetVSConstantBufferRange(0, context.AllocateConstants(&constants, sizeof(constants)));
+        for (const MeshSubmesh& submesh : file.GetSubmeshes())
+        {
+            context.SetIndexBuffer(indexBuffer, submesh.IndexFormat, 0);
+            context.DrawIndexed(submesh.IndexCount, submesh.FirstIndex, submesh.BaseVertex);
+        }
+        device.Present();
+
+        *draws = file.GetSubmeshes().size();
+        const uint32_t* pixels = device.GetRasterizer().GetColorBuffer();
+        return std::vector<uint32_t>(pixels, pixels + 320 * 240);
+    }
+
+    void CheckImages(JobSystem& jobSystem, const std::filesystem::path& directory)
+    {
+        std::string path32 = (directory / "IndexFormatBenchmark-32.mesh").string();
+        std::string path16 = (directory / "IndexFormatBenchmark-16.mesh").string();
+        MeshData mesh = MakeGrid(300, 250);
+        std::vector<uint8_t> storage;
+        std::string error;
+        MeshFileDesc desc = MakeMeshFileDesc(mesh, VertexFormat::Float32, &storage);
+        Check(WriteMeshFile(path32, desc, &error), "software: write the 32-bit mesh");
+
+        std::vector<MeshSubmesh> submeshes;
+        Check(SplitMeshForIndex16(&mesh, &submeshes) && submeshes.size() == 2, "software: grid splits in two");
+        std::vector<uint8_t> splitStorage;
+        MeshFileDesc splitDesc = MakeMeshFileDesc(mesh, VertexFormat::Float32, &splitStorage);
+        splitDesc.Submeshes = submeshes;
+        Check(WriteMeshFile(path16, splitDesc, &error), "software: write the split mesh");
+
+        size_t draws32 = 0, draws16 = 0;
+        std::vector<uint32_t> reference = RenderMeshFile(jobSystem, path32, &draws32);
+        std::vector<uint32_t> image = RenderMeshFile(jobSystem, path16, &draws16);
+        Check(!reference.empty() && draws32 == 1, "software: 32-bit mesh renders");
+        Check(image == reference && draws16 == 2, "software: 16-bit chunks draw the same image");
+        uint32_t clear = reference.empty() ? 0 : reference[0];
+        Check(std::count(reference.begin(), reference.end(), clear) < 320 * 240 / 4,
+            "software: the grid covers the viewport");
+
+        std::filesystem::remove(path32);
+        std::filesystem::remove(path16);
+    }
+
+    struct SplitResult
+    {
+        uint32_t Vertices = 0;
+        MeshSplitStats Stats;
+        // What WriteMeshFile stores: the index format it picks and the vertex and index bytes
+        const char* Decision = "";
+        uint64_t StoredBytes = 0;
+        double SplitMs = 0.0;
+    };
+
+    SplitResult MeasureSplit(const MeshData& mesh)
+    {
+        SplitResult result;
+        result.Vertices = static_cast<uint32_t>(mesh.Vertices.size());
+        std::vector<double> times;
+        bool split = false;
+        for (int run = 0; run < 3; ++run)
+        {
+            MeshData copy = mesh;
+            std::vector<MeshSubmesh> submeshes;
+            Clock::time_point start = Clock::now();
+            split = SplitMeshForIndex16(&copy, &submeshes, {}, &result.Stats);
+            times.push_back(ElapsedMs(start));
+        }
+        std::sort(times.begin(), times.end());
+        result.SplitMs = times[1];
+
+        // An unsplit mesh is one submesh, 16-bit when its vertices fit (MeshFile.h)
+        if (split)
+        {
+            result.Decision = "16-bit chunks";
+            result.StoredBytes = result.Stats.BytesAfter;
+        }
+        else if (mesh.Vertices.size() <= 0x10000)
+        {
+            result.Decision = "16-bit";
+            result.StoredBytes = result.Stats.BytesBefore - mesh.Indices.size() * 2;
+        }
+        else
+        {
+            result.Decision = "32-bit";
+            result.StoredBytes = result.Stats.BytesBefore;
+        }
+        return result;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t triangles = 2000000;
+    std::filesystem::path directory = std::filesystem::temp_directory_path();
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--triangles") == 0 && i + 1 < argc)
+            triangles = static_cast<uint32_t>(std::max(2000, std::atoi(argv[++i])));
+        else if (std::strcmp(argv[i], "--dir") == 0 && i + 1 < argc)
+            directory = argv[++i];
+    }
+
+    JobSystem jobSystem(1);
+    CheckCorpus(directory);
+    CheckSplitter();
+    CheckImages(jobSystem, directory);
+    if (g_Failures > 0)
+    {
+        std::fprintf(stderr, "%d check(s) failed\n", g_Failures);
+        return 1;
+    }
+    std::printf("Index format checks passed\n\n");
+
+    // A square-ish grid with the requested number of triangles, in three triangle orders
+    uint32_t gridColumns = 1;
+    while (uint64_t(gridColumns + 1) * (gridColumns + 1) * 2 <= triangles)
+        ++gridColumns;
+    uint32_t gridRows = std::max(1u, triangles / (gridColumns * 2));
+    MeshData rowOrder = MakeGrid(gridColumns, gridRows);
+    MeshData shuffled = rowOrder;
+    ShuffleTriangles(&shuffled, 1);
+    MeshData optimized = shuffled;
+    OptimizeMesh(&optimized);
+
+    struct Row
+    {
+        const char* Name;
+        const MeshData* Mesh;
+    };
+    const Row meshes[] =
+    {
+        { "grid, row order", &rowOrder },
+        { "grid, shuffled", &shuffled },
+        { "grid, shuffled + OptimizeMesh", &optimized },
+    };
+
+    std::printf("%u triangles, %u-byte vertices, chunks of up to 65536 vertices\n", rowOrder.GetTriangleCount(),
+        uint32_t(sizeof(Vertex)));
+    std::printf("%-30s %9s %7s %8s %10s %10s %8s %9s %s\n", "Mesh", "Vertices", "Chunks", "Dup %", "32-bit MB",
+        "Stored MB", "Saved %", "Split ms", "Stored as");
+    for (const Row& row : meshes)
+    {
+        SplitResult result = MeasureSplit(*row.Mesh);
+        const MeshSplitStats& stats = result.Stats;
+        double saved = 100.0 * (double(stats.BytesBefore) - double(result.StoredBytes)) / double(stats.BytesBefore);
+        std::printf("%-30s %9u %7u %7.2f%% %10.1f %10.1f %7.1f%% %9.2f %s\n", row.Name, result.Vertices, stats.Chunks,
+            100.0 * stats.DuplicatedVertices / result.Vertices, stats.BytesBefore / 1048576.0,
+            result.StoredBytes / 1048576.0, saved, result.SplitMs, result.Decision);
+    }
+    return 0;
+}
@@ -0,0 +1,418 @@
+// Checks and speed of the quadric simplifier (MeshSimplifier.h), the LOD chains
+// built from it and LodSelector. The simplifier checks cover a flat grid that
+// must collapse to a few triangles with its area and borders intact, a cube
+// whose faces have their own vertices (seams that must not crack), and an
+// icosphere reduced tenfold that must stay watertight, unflipped and close to
+// its volume, also with one half on vertices of its own. The selector checks
+// cover monotone levels over distance, the pixel error bound, batch against
+// single selection, and that hysteresis stops an object oscillating around a
+// switching distance from popping. The benchmark simplifies meshes of about a
+// million triangles, builds a LOD chain and flies a camera over a dense grid
+// of objects, reporting the triangles drawn with and without LODs and the
+// level switches per frame.
+//
+// Build (from the repository root):
+//   g++ -std=c++20 -O2 -pthread -ICommon Benchmarks/LodBenchmark.cpp Common/MeshSimplifier.cpp
+//       Common/LodSelector.cpp Common/TransformBatch.cpp Common/VertexWelder.cpp Common/JobSystem.cpp
+//       -o LodBenchmark
+//
+// Usage: LodBenchmark [--triangles N] [--objects N] [--frames N]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "LodSelector.h"
+#include "MeshSimplifier.h"
+#include "Primitives.h"
+#include "VertexWelder.h"
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    int g_Failures = 0;
+
+    void Check(bool condition, const char* what)
+    {
+        if (!condition)
+        {
+            std::fprintf(stderr, "FAILED: %s\n", what);
+            ++g_Failures;
+        }
+    }
+
+    double ElapsedMs(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    template <typename Shape>
+    MeshData MakeMesh(const Shape& shape)
+    {
+        MeshData mesh;
+        GeneratePrimitive(shape, nullptr, &mesh.Vertices, &mesh.Indices);
+        return mesh;
+    }
+
+    // Icosphere with bumps, so that simplification has curvature of several scales to keep
+    MeshData MakeBumpySphere(uint32_t frequency)
+    {
+        MeshData mesh = MakeMesh(IcosphereShape{ frequency });
+        for (Vertex& v : mesh.Vertices)
+        {
+            Float3& p = v.Position;
+            float scale = 0.85f + 0.1f * std::sin(5.0f * p.x) * std::sin(7.0f * p.y) * std::sin(3.0f * p.z) +
+                0.05f * std::sin(23.0f * p.x + 17.0f * p.z);
+            p = { p.x * scale, p.y * scale, p.z * scale };
+        }
+        return mesh;
+    }
+
+    Float3 TriangleNormal(const MeshData& mesh, const uint32_t* triangle)
+    {
+        const Float3& p0 = mesh.Vertices[triangle[0]].Position;
+        return Vector3Cross(Vector3Subtract(mesh.Vertices[triangle[1]].Position, p0),
+            Vector3Subtract(mesh.Vertices[triangle[2]].Position, p0));
+    }
+
+    double Area(const MeshData& mesh, const std::vector<uint32_t>& indices)
+    {
+        double area = 0.0;
+        for (size_t i = 0; i < indices.size(); i += 3)
+        {
+            Float3 n = TriangleNormal(mesh, &indices[i]);
+            area += 0.5 * std::sqrt(double(Vector3Dot(n, n)));
+        }
+        return area;
+    }
+
+    double Volume(const MeshData& mesh, const std::vector<uint32_t>& indices)
+    {
+        double volume = 0.0;
+        for (size_t i = 0; i < indices.size(); i += 3)
+        {
+            const Float3& a = mesh.Vertices[indices[i]].Position;
+            Float3 n = TriangleNormal(mesh, &indices[i]);
+            volume += Vector3Dot(a, n) / 6.0;
+        }
+        return std::fabs(volume);
+    }
+
+    // Every edge used once in each direction, after welding the vertices by position
+    bool IsWatertight(const MeshData& mesh, const std::vector<uint32_t>& indices)
+    {
+        std::vector<Vertex> soup;
+        for (uint32_t index : indices)
+            soup.push_back({ mesh.Vertices[index].Position, { 0.0f, 0.0f, 0.0f, 0.0f } });
+        MeshData welded;
+        WeldVertices(soup.data(), soup.size(), {}, nullptr, &welded);
+        std::vector<uint64_t> edges;
+        for (size_t i = 0; i < welded.Indices.size(); i += 3)
+        {
+            for (size_t k = 0; k < 3; ++k)
+                edges.push_back(uint64_t(welded.Indices[i + k]) << 32 | welded.Indices[i + (k + 1) % 3]);
+        }
+        std::sort(edges.begin(), edges.end());
+        if (welded.Indices.size() != indices.size() || std::adjacent_find(edges.begin(), edges.end()) != edges.end())
+            return false;
+        for (uint64_t edge : edges)
+        {
+            if (!std::binary_search(edges.begin(), edges.end(), edge << 32 | edge >> 32))
+                return false;
+        }
+        return true;
+    }
+
+    std::vector<uint32_t> Simplify(const MeshData& mesh, size_t targetIndexCount, float targetError,
+        float* resultError = nullptr)
+    {
+        std::vector<uint32_t> result(mesh.Indices.size());
+        size_t count = SimplifyMesh(result.data(), mesh.Indices.data(), mesh.Indices.size(), mesh.Vertices.data(),
+            static_cast<uint32_t>(mesh.Vertices.size()), targetIndexCount, targetError, resultError);
+        result.resize(count);
+        return result;
+    }
+
+    void CheckSimplifier()
+    {
+        // A flat grid loses every inner and every straight border vertex at no error
+        MeshData plane = MakeMesh(PlaneShape{ 64, 64 });
+        float error = 1.0f;
+        std::vector<uint32_t> flat = Simplify(plane, 0, 1e-5f, &error);
+        bool up = true;
+        for (size_t i = 0; i < flat.size(); i += 3)
+            up = up && TriangleNormal(plane, &flat[i]).y > 0.0f;
+        Check(flat.size() / 3 <= 8 && error < 1e-5f, "plane: flat grid collapses to a few triangles");
+        Check(std::fabs(Area(plane, flat) - 4.0) < 1e-4 && up, "plane: area and facing kept");
+
+        // Faces with their own vertices: the seams stay closed
+        MeshData cube = MakeMesh(CubeShape{ 16 });
+        std::vector<uint32_t> box = Simplify(cube, 0, 1e-5f);
+        bool faces = true;
+        for (size_t i = 0; i < box.size(); i += 3)
+        {
+            Float3 n = Vector3Normalize(TriangleNormal(cube, &box[i]));
+            const Float4& normal = cube.Vertices[box[i]].Color;
+            Float3 expected = { normal.x * 2.0f - 1.0f, normal.y * 2.0f - 1.0f, normal.z * 2.0f - 1.0f };
+            faces = faces && Vector3Dot(n, expected) > 0.999f;
+        }
+        Check(box.size() < cube.Indices.size() / 4, "cube: flat faces simplified");
+        Check(IsWatertight(cube, box) && std::fabs(Area(cube, box) - 24.0) < 1e-3 && faces,
+            "cube: seams stay closed, faces keep their plane");
+
+        // Tenfold reduction of a closed surface
+        MeshData sphere = MakeBumpySphere(48);
+        size_t target = sphere.Indices.size() / 10 / 3 * 3;
+        std::vector<uint32_t> reduced = Simplify(sphere, target, 1e30f, &error);
+        // Slivers along the great circles of the icosahedron's edges stand on edge, so allow a margin
+        bool outward = true;
+        for (size_t i = 0; i < reduced.size(); i += 3)
+        {
+            Float3 p = Vector3Normalize(sphere.Vertices[reduced[i]].Position);
+            outward = outward && Vector3Dot(Vector3Normalize(TriangleNormal(sphere, &reduced[i])), p) > -0.1f;
+        }
+        double volumeChange = Volume(sphere, reduced) / Volume(sphere, sphere.Indices) - 1.0;
+        Check(reduced.size() <= target && reduced.size() > target * 9 / 10, "sphere: reaches the target count");
+        Check(IsWatertight(sphere, reduced) && outward, "sphere: watertight and unflipped");
+        Check(std::fabs(volumeChange) < 0.02 && error > 0.0f && error < 0.02f, "sphere: volume and error bounded");
+
+        // The half x > 0 gets its own vertices, in another color: the seam between the halves stays closed
+        MeshData seamed = sphere;
+        std::vector<uint32_t> copies(sphere.Vertices.size(), UINT32_MAX);
+        for (size_t i = 0; i < seamed.Indices.size(); i += 3)
+        {
+            const Vertex* v = sphere.Vertices.data();
+            if (v[seamed.Indices[i]].Position.x + v[seamed.Indices[i + 1]].Position.x +
+                v[seamed.Indices[i + 2]].Position.x <= 0.0f)
+            {
+                continue;
+            }
+            for (size_t k = i; k < i + 3; ++k)
+            {
+                uint32_t& copy = copies[seamed.Indices[k]];
+                if (copy == UINT32_MAX)
+                {
+                    copy = static_cast<uint32_t>(seamed.Vertices.size());
+                    seamed.Vertices.push_back({ v[seamed.Indices[k]].Position, { 1.0f, 0.0f, 0.0f, 1.0f } });
+                }
+                seamed.Indices[k] = copy;
+            }
+        }
+        std::vector<uint32_t> halves = Simplify(seamed, target, 1e30f);
+        Check(halves.size() < seamed.Indices.size() / 4 && IsWatertight(seamed, halves),
+            "seamed sphere: the seam stays closed");
+
+        // The error limit stops it, in place works and the result is repeatable
+        float limitedError = 0.0f;
+        std::vector<uint32_t> limited = Simplify(sphere, 0, 0.002f, &limitedError);
+        std::vector<uint32_t> inPlace = sphere.Indices;
+        inPlace.resize(SimplifyMesh(inPlace.data(), inPlace.data(), inPlace.size(), sphere.Vertices.data(),
+            static_cast<uint32_t>(sphere.Vertices.size()), 0, 0.002f));
+        Check(limitedError <= 0.002f && limited.size() > reduced.size() && limited.size() < sphere.Indices.size(),
+            "sphere: error limit respected");
+        Check(inPlace == limited, "sphere: in place and repeatable");
+    }
+
+    void CheckLodChain(const MeshLodChain& chain, const LodChainOptions& options, uint32_t vertexCount)
+    {
+        bool ordered = chain.Lods.size() >= 3 && chain.Lods[0].FirstIndex == 0 && chain.Lods[0].Error == 0.0f;
+        uint32_t next = 0;
+        for (size_t i = 0; i < chain.Lods.size(); ++i)
+        {
+            const MeshLod& lod = chain.Lods[i];
+            ordered = ordered && lod.FirstIndex == next && lod.IndexCount % 3 == 0;
+            next = lod.FirstIndex + lod.IndexCount;
+            if (i > 0)
+            {
+                ordered = ordered && lod.IndexCount <= chain.Lods[i - 1].IndexCount * options.MaxTriangleRatio &&
+                    lod.Error >= chain.Lods[i - 1].Error && lod.Error <= options.Errors.back() * chain.Radius;
+            }
+        }
+        bool inRange = next == chain.Indices.size();
+        for (uint32_t index : chain.Indices)
+            inRange = inRange && index < vertexCount;
+        Check(ordered, "chain: levels shrink, errors grow within the limits");
+        Check(inRange, "chain: levels back to back, indices address the shared vertices");
+    }
+
+    void CheckSelector(const MeshLodChain& chain)
+    {
+        float height = 720.0f;
+        Float4x4 projection = MatrixPerspectiveFovLH(MathPiDiv2, 1280.0f / height, 0.01f, 1000.0f);
+        Float4x4 view = MatrixLookAtLH({ 0.0f, 0.0f, -1.0f }, { 0.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f });
+        LodSelector selector;
+        selector.SetView(view, projection, height);
+
+        // Walking away: levels never get finer and the error stays under the pixel limit
+        uint32_t level = 0, highest = 0;
+        bool monotone = true, bounded = true;
+        for (float distance = 0.5f; distance < 2000.0f; distance *= 1.05f)
+        {
+            uint32_t selected = selector.Select(chain, MatrixTranslation(0.0f, 0.0f, distance - 1.0f), level);
+            monotone = monotone && selected >= level && (distance > chain.Radius || selected == 0);
+            float pixels = chain.Lods[selected].Error * selector.GetPixelsPerUnit(distance - chain.Radius);
+            bounded = bounded && pixels <= 1.25f;
+            level = selected;
+            highest = std::max(highest, selected);
+        }
+        Check(monotone && highest + 1 == chain.Lods.size(), "selector: coarser with distance, all levels used");
+        Check(bounded, "selector: projected error within the pixel limit and hysteresis");
+
+        // Distance where level 1 starts to be allowed, then oscillate 2% around it
+        float switchDistance = chain.Lods[1].Error * selector.GetPixelsPerUnit(1.0f) + chain.Radius;
+        auto countSwitches = [&](float hysteresis)
+        {
+            LodSelector oscillating({ 1.0f, hysteresis });
+            oscillating.SetView(view, projection, height);
+            uint32_t current = 0, switches = 0;
+            for (int frame = 0; frame < 100; ++frame)
+            {
+                float distance = switchDistance * (frame % 2 ? 1.02f : 0.98f);
+                uint32_t selected = oscillating.Select(chain, MatrixTranslation(0.0f, 0.0f, distance - 1.0f), current);
+                switches += selected != current;
+                current = selected;
+            }
+            return switches;
+        };
+        Check(countSwitches(0.0f) >= 90, "selector: without hysteresis the level pops every frame");
+        Check(countSwitches(0.25f) <= 1, "selector: hysteresis holds the level");
+
+        // Batch selection equals one-by-one selection, with scaled and rotated worlds
+        WorldMatrixArray worlds(64);
+        std::vector<uint8_t> batch(64, 0);
+        std::vector<uint32_t> single(64, 0);
+        for (uint32_t i = 0; i < 64; ++i)
+        {
+            float scale = 0.5f + 0.1f * (i % 7);
+            worlds.Set(i, MatrixScaling(scale, scale, scale) * MatrixRotationY(0.3f * i) *
+                MatrixTranslation(float(i % 8) * 3.0f, 0.0f, float(i) * 5.0f));
+        }
+        selector.Select(chain, worlds, 0, 64, batch.data());
+        bool same = true;
+        for (uint32_t i = 0; i < 64; ++i)
+            same = same && batch[i] == selector.Select(chain, worlds.Get(i), single[i]);
+        Check(same, "selector: batch equals single selection");
+    }
+}
+
+int main(int argc, char** argv)
+{
+    double triangleCount = 1000000.0;
+    uint32_t objectCount = 10000;
+    uint32_t frameCount = 300;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--triangles") == 0 && i + 1 < argc)
+            triangleCount = std::max(20000.0, std::atof(argv[++i]));
+        else if (std::strcmp(argv[i], "--objects") == 0 && i + 1 < argc)
+            objectCount = static_cast<uint32_t>(std::max(1, std::atoi(argv[++i])));
+        else if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+            frameCount = static_cast<uint32_t>(std::max(1, std::atoi(argv[++i])));
+    }
+
+    LodChainOptions chainOptions;
+    MeshData object = MakeBumpySphere(40);
+    MeshLodChain chain;
+    BuildLodChain(object, chainOptions, &chain);
+
+    CheckSimplifier();
+    CheckLodChain(chain, chainOptions, static_cast<uint32_t>(object.Vertices.size()));
+    CheckSelector(chain);
+    if (g_Failures > 0)
+    {
+        std::fprintf(stderr, "%d check(s) failed\n", g_Failures);
+        return 1;
+    }
+    std::printf("LOD checks passed\n\n");
+
+    // Simplification speed
+    uint32_t frequency = static_cast<uint32_t>(std::sqrt(triangleCount / 20.0));
+    struct Input
+    {
+        const char* Name;
+        MeshData Mesh;
+    };
+    uint32_t torusSides = static_cast<uint32_t>(std::sqrt(triangleCount / 4.0));
+    Input inputs[] =
+    {
+        { "icosphere", MakeMesh(IcosphereShape{ frequency }) },
+        { "bumpy sphere", MakeBumpySphere(frequency) },
+        { "torus", MakeMesh(TorusShape{ 2 * torusSides, torusSides }) },
+    };
+    std::printf("%-14s %10s %9s %10s %9s %10s %9s\n", "Mesh", "Triangles", "Target", "Result", "ms", "Mtri/s",
+        "Error");
+    for (const Input& input : inputs)
+    {
+        for (size_t divisor : { 10u, 100u })
+        {
+            size_t target = input.Mesh.Indices.size() / divisor / 3 * 3;
+            float error = 0.0f;
+            Clock::time_point start = Clock::now();
+            std::vector<uint32_t> result = Simplify(input.Mesh, target, 1e30f, &error);
+            double ms = ElapsedMs(start);
+            std::printf("%-14s %10u %9zu %10zu %9.1f %10.2f %9.5f\n", input.Name, input.Mesh.GetTriangleCount(),
+                target / 3, result.size() / 3, ms, input.Mesh.GetTriangleCount() / ms / 1000.0, error);
+        }
+    }
+
+    Clock::time_point start = Clock::now();
+    MeshLodChain bigChain;
+    BuildLodChain(inputs[1].Mesh, chainOptions, &bigChain);
+    std::printf("\nLOD chain of the bumpy sphere in %.1f ms (radius %.3f):\n", ElapsedMs(start), bigChain.Radius);
+    for (size_t i = 0; i < bigChain.Lods.size(); ++i)
+    {
+        std::printf("  LOD %zu: %8u triangles, error %.5f\n", i, bigChain.GetTriangleCount(uint32_t(i)),
+            bigChain.Lods[i].Error);
+    }
+
+    // A camera flying low over a grid of objects; the same chain for every object
+    uint32_t gridSize = static_cast<uint32_t>(std::ceil(std::sqrt(double(objectCount))));
+    float spacing = 3.0f;
+    WorldMatrixArray worlds(objectCount);
+    for (uint32_t i = 0; i < objectCount; ++i)
+        worlds.Set(i, MatrixTranslation(float(i % gridSize) * spacing, 0.0f, float(i / gridSize) * spacing));
+    float height = 720.0f;
+    Float4x4 projection = MatrixPerspectiveFovLH(MathPiDiv2, 1280.0f / height, 0.01f, 1000.0f);
+
+    std::printf("\n%u objects of %u triangles, %u frames, 1 px error at 720p, FOV 90:\n", objectCount,
+        chain.GetTriangleCount(0), frameCount);
+    std::printf("%-12s %16s %16s %10s %14s\n", "Hysteresis", "Triangles/frame", "Full detail", "Reduction",
+        "Switches/frame");
+    for (float hysteresis : { 0.0f, 0.25f })
+    {
+        LodSelector selector({ 1.0f, hysteresis });
+        std::vector<uint8_t> lods(objectCount, 0);
+        uint64_t triangles = 0, switches = 0;
+        double selectMs = 0.0;
+        std::vector<uint8_t> previous;
+        for (uint32_t frame = 0; frame < frameCount; ++frame)
+        {
+            // Forward along the grid with a small sway, like a hand-held camera
+            float z = -10.0f + frame * 0.2f;
+            float sway = 0.3f * std::sin(frame * 0.7f);
+            Float3 eye = { gridSize * spacing * 0.5f + sway, 4.0f, z };
+            Float4x4 view = MatrixLookAtLH(eye, { eye.x, 0.0f, z + 20.0f }, { 0.0f, 1.0f, 0.0f });
+            selector.SetView(view, projection, height);
+            previous = lods;
+            start = Clock::now();
+            selector.Select(chain, worlds, 0, objectCount, lods.data());
+            selectMs += ElapsedMs(start);
+            for (uint32_t i = 0; i < objectCount; ++i)
+            {
+                triangles += chain.GetTriangleCount(lods[i]);
+                switches += frame > 0 && lods[i] != previous[i];
+            }
+        }
+        uint64_t full = uint64_t(chain.GetTriangleCount(0)) * objectCount;
+        std::printf("%-12.2f %16.0f %16llu %9.1fx %14.1f   (%.1f ns per object)\n", hysteresis,
+            double(triangles) / frameCount, static_cast<unsigned long long>(full),
+            double(full) * frameCount / double(triangles), double(switches) / std::max(1u, frameCount - 1),
+            selectMs * 1e6 / (double(objectCount) * frameCount));
+    }
+    return 0;
+}
@@ -0,0 +1,672 @@
+// Checks and load times of MeshFile, the memory-mapped binary .mesh container.
+// The checks round-trip meshes through WriteMeshFile / MeshFile::Open (16- and
+// 32-bit indices, several streams, compact vertex formats, submesh bounds),
+// verify that the loader hands out pointers into the mapping at 64-byte
+// aligned offsets, and feed corrupted files to the validator. The benchmark
+// writes a large grid as .mesh and .obj and times loading it into buffers of
+// the null backend with a cold page cache (the file's pages dropped with
+// posix_fadvise) and a warm one: mapped .mesh, .mesh read into memory and
+// copied, and the OBJ importer.
+//
+// Build (from the repository root):
+//   g++ -std=c++20 -O2 -pthread -ICommon Benchmarks/MeshFileBenchmark.cpp Common/MeshFile.cpp
+//       Common/MeshImporter.cpp Common/PackedVertex.cpp Common/MappedFile.cpp Common/JobSystem.cpp
+//       Common/NullRenderDevice.cpp Common/CpuRenderDevice.cpp Common/CommandBuffer.cpp
+//       Common/ConstantBufferRing.cpp -o MeshFileBenchmark
+//
+// Usage: MeshFileBenchmark [--triangles N] [--repeat N] [--threads N]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "JobSystem.h"
+#include "MeshFile.h"
+#include "MeshImporter.h"
+#include "NullRenderDevice.h"
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    int g_Failures = 0;
+
+    void Check(bool condition, const char* what)
+    {
+        if (!condition)
+        {
+            std::fprintf(stderr, "FAILED: %s\n", what);
+            ++g_Failures;
+        }
+    }
+
+    double ElapsedMs(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    // A height field of columns x rows quads with a color gradient
+    MeshData MakeGridMesh(uint32_t columns, uint32_t rows)
+    {
+        MeshData mesh;
+        mesh.Vertices.reserve(size_t(columns + 1) * (rows + 1));
+        for (uint32_t y = 0; y <= rows; ++y)
+        {
+            for (uint32_t x = 0; x <= columns; ++x)
+            {
+                float height = 0.25f * std::sin(x * 0.1f) * std::cos(y * 0.1f);
+                mesh.Vertices.push_back({ { x * 0.01f, height, y * 0.01f },
+                    { x / static_cast<float>(columns), y / static_cast<float>(rows), 0.5f, 1.0f } });
+            }
+        }
+        mesh.Indices.reserve(size_t(columns) * rows * 6);
+        for (uint32_t y = 0; y < rows; ++y)
+        {
+            for (uint32_t x = 0; x < columns; ++x)
+            {
+                uint32_t a = y * (columns + 1) + x, b = a + 1, c = b + columns + 1, d = c - 1;
+                mesh.Indices.insert(mesh.Indices.end(), { a, d, c, a, c, b });
+            }
+        }
+        return mesh;
+    }
+
+    std::string MakeObj(const MeshData& mesh)
+    {
+        std::string obj;
+        char line[160];
+        for (const Vertex& vertex : mesh.Vertices)
+        {
+            std::snprintf(line, sizeof(line), "v %.6f %.6f %.6f %.4f %.4f %.4f\n", vertex.Position.x,
+                vertex.Position.y, vertex.Position.z, vertex.Color.x, vertex.Color.y, vertex.Color.z);
+            obj += line;
+        }
+        for (size_t i = 0; i < mesh.Indices.size(); i += 3)
+        {
+            std::snprintf(line, sizeof(line), "f %u %u %u\n", mesh.Indices[i] + 1, mesh.Indices[i + 1] + 1,
+                mesh.Indices[i + 2] + 1);
+            obj += line;
+        }
+        return obj;
+    }
+
+    bool WriteFile(const std::string& path, const void* data, size_t size)
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        return static_cast<bool>(out.write(static_cast<const char*>(data), static_cast<std::streamsize>(size)));
+    }
+
+    bool ReadFile(const std::string& path, std::vector<uint8_t>* bytes)
+    {
+        std::ifstream in(path, std::ios::binary);
+        if (!in)
+            return false;
+        in.seekg(0, std::ios::end);
+        bytes->resize(static_cast<size_t>(in.tellg()));
+        in.seekg(0);
+        return static_cast<bool>(in.read(reinterpret_cast<char*>(bytes->data()),
+            static_cast<std::streamsize>(bytes->size())));
+    }
+
+    // Offset of pointer from the start of the mapping, or SIZE_MAX if it lies outside
+    size_t MappedOffset(const MeshFile& file, const void* pointer, size_t size)
+    {
+        const uint8_t* begin = file.GetMappedFile().GetData();
+        const uint8_t* bytes = static_cast<const uint8_t*>(pointer);
+        size_t fileSize = file.GetMappedFile().GetSize();
+        if (bytes < begin || bytes > begin + fileSize || size > size_t(begin + fileSize - bytes))
+            return SIZE_MAX;
+        return static_cast<size_t>(bytes - begin);
+    }
+
+    // Bounds of the vertices a submesh references, from the float source mesh
+    void ReferenceBounds(const MeshData& mesh, const MeshSubmesh& submesh, Float3* boundsMin, Float3* boundsMax)
+    {
+        for (uint32_t i = 0; i < submesh.IndexCount; ++i)
+        {
+            const Float3& p = mesh.Vertices[mesh.Indices[submesh.FirstIndex + i] + submesh.BaseVertex].Position;
+            if (i == 0)
+                *boundsMin = *boundsMax = p;
+            *boundsMin = { std::min(boundsMin->x, p.x), std::min(boundsMin->y, p.y), std::min(boundsMin->z, p.z) };
+            *boundsMax = { std::max(boundsMax->x, p.x), std::max(boundsMax->y, p.y), std::max(boundsMax->z, p.z) };
+        }
+    }
+
+    bool Near(const Float3& a, const Float3& b, float tolerance)
+    {
+        return std::fabs(a.x - b.x) <= tolerance && std::fabs(a.y - b.y) <= tolerance &&
+            std::fabs(a.z - b.z) <= tolerance;
+    }
+
+    void CheckRoundTrip(const std::filesystem::path& directory)
+    {
+        std::string path = (directory / "MeshFileBenchmark-roundtrip.mesh").string();
+        MeshData mesh = MakeGridMesh(20, 10);
+
+        // Two submeshes; the second addresses its vertices relative to a base vertex
+        std::vector<uint8_t> storage;
+        MeshFileDesc desc = MakeMeshFileDesc(mesh, VertexFormat::Float32, &storage);
+        uint32_t half = static_cast<uint32_t>(mesh.Indices.size() / 2);
+        int32_t baseVertex = 100;
+        std::vector<uint32_t> indices = mesh.Indices;
+        for (size_t i = half; i < indices.size(); ++i)
+            indices[i] -= std::min<uint32_t>(indices[i], baseVertex);
+        bool rebased = true;
+        for (size_t i = half; i < indices.size(); ++i)
+            rebased = rebased && indices[i] + baseVertex == mesh.Indices[i];
+        Check(rebased, "round trip: second half addressable from the base vertex");
+        desc.Indices = indices.data();
+        desc.Submeshes = { { 0, half, 0 }, { half, desc.IndexCount - half, baseVertex } };
+
+        std::string error;
+        Check(WriteMeshFile(path, desc, &error), "round trip: write");
+        MeshFile file;
+        Check(file.Open(path, &error), "round trip: open");
+        if (!file.IsOpen())
+            return;
+
+        Check(file.GetVertexCount() == mesh.Vertices.size() && file.GetStreamCount() == 1 &&
+            file.GetIndexCount() == mesh.Indices.size() && file.GetIndexBytes() == mesh.Indices.size() * 2,
+            "round trip: counts and index stream size");
+        const MeshStream& stream = file.GetStream(0);
+        Check(stream.Stride == sizeof(Vertex) && stream.Layout.size() == 2 &&
+            std::strcmp(stream.Layout[0].SemanticName, "POSITION") == 0 &&
+            stream.Layout[0].ElementFormat == Format::R32G32B32Float &&
+            std::strcmp(stream.Layout[1].SemanticName, "COLOR") == 0 && stream.Layout[1].AlignedByteOffset == 12,
+            "round trip: layout");
+        Check(std::memcmp(stream.Data, mesh.Vertices.data(), mesh.Vertices.size() * sizeof(Vertex)) == 0,
+            "round trip: vertex bytes");
+
+        std::vector<uint16_t> narrowed(file.GetIndexCount());
+        std::memcpy(narrowed.data(), file.GetIndexData(), narrowed.size() * sizeof(uint16_t));
+        Check(std::equal(narrowed.begin(), narrowed.end(), indices.begin()), "round trip: narrowed indices");
+
+        // Zero copy: everything points into the mapping, on cache-line boundaries
+        size_t vertexOffset = MappedOffset(file, stream.Data, mesh.Vertices.size() * sizeof(Vertex));
+        size_t indexOffset = MappedOffset(file, file.GetIndexData(), narrowed.size() * sizeof(uint16_t));
+        size_t nameOffset = MappedOffset(file, stream.Layout[0].SemanticName, 9);
+        Check(vertexOffset != SIZE_MAX && indexOffset != SIZE_MAX && nameOffset != SIZE_MAX,
+            "round trip: pointers into the mapping");
+        Check(vertexOffset % MeshFile::DataAlignment == 0 && indexOffset % MeshFile::DataAlignment == 0,
+            "round trip: 64-byte aligned streams");
+
+        const std::vector<MeshSubmesh>& submeshes = file.GetSubmeshes();
+        Check(submeshes.size() == 2 && submeshes[1].FirstIndex == half && submeshes[1].BaseVertex == baseVertex,
+            "round trip: submesh ranges");
+        Check(submeshes.size() == 2 && submeshes[0].IndexFormat == Format::R16UInt &&
+            submeshes[1].IndexFormat == Format::R16UInt, "round trip: small mesh picks 16-bit indices");
+        bool boundsMatch = true;
+        for (const MeshSubmesh& submesh : submeshes)
+        {
+            Float3 boundsMin, boundsMax;
+            ReferenceBounds(mesh, { submesh.FirstIndex, submesh.IndexCount, 0 }, &boundsMin, &boundsMax);
+            boundsMatch = boundsMatch && Near(submesh.BoundsMin, boundsMin, 0.0f) &&
+                Near(submesh.BoundsMax, boundsMax, 0.0f);
+        }
+        Check(boundsMatch, "round trip: submesh bounds");
+        Check(submeshes.size() == 2 && submeshes[0].FirstVertex == 0 &&
+            submeshes[1].FirstVertex + submeshes[1].VertexCount == mesh.Vertices.size(),
+            "round trip: submesh vertex ranges");
+        Float3 meshMin, meshMax;
+        ReferenceBounds(mesh, { 0, desc.IndexCount, 0 }, &meshMin, &meshMax);
+        Check(Near(file.GetBoundsMin(), meshMin, 0.0f) && Near(file.GetBoundsMax(), meshMax, 0.0f),
+            "round trip: mesh bounds");
+
+        // Buffers come out byte for byte. A CPU backend's buffers are its own copies, so here the
+        // file can go away afterwards; D3D11 keeps pointers into the mapping instead.
+        NullRenderDevice device(64, 64);
+        BufferHandle vertexBuffer, indexBuffer;
+        Check(file.CreateBuffers(device, &vertexBuffer, &indexBuffer), "round trip: create buffers");
+        BufferDesc defaultDesc = { 64, BufferBind::VertexBuffer, BufferUsage::Default };
+        BufferHandle unused;
+        Check(!device.CreateBufferNoCopy(defaultDesc, file.GetIndexData(), &unused),
+            "round trip: only immutable buffers are created without a copy");
+        file.Close();
+        CpuBuffer* vertices = device.GetBuffer(vertexBuffer);
+        CpuBuffer* indexData = device.GetBuffer(indexBuffer);
+        Check(vertices && vertices->Desc.Usage == BufferUsage::Immutable &&
+            vertices->Data.size() == mesh.Vertices.size() * sizeof(Vertex) &&
+            std::memcmp(vertices->Data.data(), mesh.Vertices.data(), vertices->Data.size()) == 0,
+            "round trip: vertex buffer contents");
+        Check(indexData && indexData->Desc.Bind == BufferBind::IndexBuffer &&
+            indexData->Data.size() == narrowed.size() * sizeof(uint16_t) &&
+            std::memcmp(indexData->Data.data(), narrowed.data(), indexData->Data.size()) == 0,
+            "round trip: index buffer contents");
+
+        std::filesystem::remove(path);
+    }
+
+    // Packed positions and colors in stream 0, float normals in stream 1, 32-bit indices
+    void CheckStreams(const std::filesystem::path& directory)
+    {
+        std::string path = (directory / "MeshFileBenchmark-streams.mesh").string();
+        MeshData mesh = MakeGridMesh(300, 250);
+        Check(mesh.Vertices.size() > 0x10000, "streams: mesh needs 32-bit indices");
+
+        std::vector<uint8_t> storage;
+        MeshFileDesc desc = MakeMeshFileDesc(mesh, VertexFormat::Snorm16, &storage);
+        Check(desc.Streams[0].Stride == sizeof(PackedVertex), "streams: packed desc");
+        std::vector<Float3> normals(mesh.Vertices.size(), Float3{ 0.0f, 1.0f, 0.0f });
+        MeshStream normalStream;
+        normalStream.Stride = sizeof(Float3);
+        normalStream.Layout = { { "NORMAL", 0, Format::R32G32B32Float, 1, 0, false, 0 } };
+        normalStream.Data = normals.data();
+        desc.Streams.push_back(normalStream);
+
+        std::string error;
+        desc.IndexFormat = Format::R16UInt;
+        Check(!WriteMeshFile(path, desc, &error) && error.find("16 bits") != std::string::npos,
+            "streams: forced 16-bit indices do not fit");
+        desc.IndexFormat = Format::Unknown;
+        Check(WriteMeshFile(path, desc, &error), "streams: write");
+        MeshFile file;
+        Check(file.Open(path, &error), "streams: open");
+        if (!file.IsOpen())
+            return;
+
+        Check(file.GetStreamCount() == 2 && file.GetSubmeshes()[0].IndexFormat == Format::R32UInt,
+            "streams: counts and 32-bit indices");
+        Check(file.GetStream(1).Layout.size() == 1 && file.GetStream(1).Layout[0].InputSlot == 1 &&
+            std::memcmp(file.GetStream(1).Data, normals.data(), normals.size() * sizeof(Float3)) == 0,
+            "streams: second stream");
+        Check(std::memcmp(file.GetStream(0).Data, storage.data(), storage.size()) == 0 &&
+            std::memcmp(file.GetIndexData(), mesh.Indices.data(), mesh.Indices.size() * sizeof(uint32_t)) == 0,
+            "streams: packed vertices and indices");
+        Check(MappedOffset(file, file.GetStream(1).Data, 1) % MeshFile::DataAlignment == 0,
+            "streams: second stream aligned");
+
+        // Bounds are in object space: dequantized, so within SNORM16 precision of the floats
+        const PositionQuantization& quantization = file.GetQuantization();
+        Check(Near(quantization.Center, desc.Quantization.Center, 0.0f) &&
+            Near(quantization.Extent, desc.Quantization.Extent, 0.0f), "streams: quantization");
+        Float3 boundsMin, boundsMax;
+        ReferenceBounds(mesh, { 0, static_cast<uint32_t>(mesh.Indices.size()), 0 }, &boundsMin, &boundsMax);
+        Check(Near(file.GetBoundsMin(), boundsMin, 1e-4f) && Near(file.GetBoundsMax(), boundsMax, 1e-4f),
+            "streams: dequantized bounds");
+
+        NullRenderDevice device(64, 64);
+        BufferHandle vertexBuffers[2], indexBuffer;
+        Check(file.CreateBuffers(device, vertexBuffers, &indexBuffer) &&
+            device.GetBuffer(vertexBuffers[1])->Data.size() == normals.size() * sizeof(Float3),
+            "streams: create buffers");
+
+        file.Close();
+        std::filesystem::remove(path);
+    }
+
+    void CheckWriterErrors(const std::filesystem::path& directory)
+    {
+        std::string path = (directory / "MeshFileBenchmark-errors.mesh").string();
+        MeshData mesh = MakeGridMesh(4, 4);
+        std::vector<uint8_t> storage;
+        std::string error;
+
+        MeshFileDesc desc = MakeMeshFileDesc(mesh, VertexFormat::Float32, &storage);
+        std::vector<uint32_t> indices = mesh.Indices;
+        desc.Indices = indices.data();
+        indices[5] = 70000;
+        Check(!WriteMeshFile(path, desc, &error) && error.find("out of range") != std::string::npos,
+            "writer: index past the vertices");
+        indices = mesh.Indices;
+        desc.Submeshes = { { 0, 6, -1 } };
+        Check(!WriteMeshFile(path, desc, &error), "writer: negative base vertex");
+        desc.Submeshes = { { 6, desc.IndexCount, 0 } };
+        Check(!WriteMeshFile(path, desc, &error), "writer: submesh past the indices");
+        desc.Submeshes.clear();
+
+        MeshFileDesc badLayout = desc;
+        badLayout.Streams[0].Layout[1].AlignedByteOffset = 16;
+        Check(!WriteMeshFile(path, badLayout, &error), "writer: element past the stride");
+        badLayout = desc;
+        badLayout.Streams[0].Layout[1].SemanticName = "A_VERY_LONG_SEMANTIC";
+        Check(!WriteMeshFile(path, badLayout, &error), "writer: semantic name too long");
+        badLayout = desc;
+        badLayout.IndexFormat = Format::R32G32B32Float;
+        Check(!WriteMeshFile(path, badLayout, &error), "writer: index format");
+        Check(!std::filesystem::exists(path) && !std::filesystem::exists(path + ".tmp"),
+            "writer: nothing left behind on failure");
+
+        Check(WriteMeshFile(path, desc, &error), "writer: valid desc after failures");
+        std::filesystem::remove(path);
+    }
+
+    template <typename T>
+    void Poke(std::vector<uint8_t>& bytes, size_t offset, T value)
+    {
+        std::memcpy(bytes.data() + offset, &value, sizeof(value));
+    }
+
+    void CheckValidator(const std::filesystem::path& directory)
+    {
+        std::string path = (directory / "MeshFileBenchmark-validate.mesh").string();
+        MeshData mesh = MakeGridMesh(8, 8);
+        std::vector<uint8_t> storage;
+        MeshFileDesc desc = MakeMeshFileDesc(mesh, VertexFormat::Float32, &storage);
+        std::string error;
+        std::vector<uint8_t> valid;
+        Check(WriteMeshFile(path, desc, &error) && ReadFile(path, &valid), "validator: write");
+        Check(ValidateMeshFile(valid.data(), valid.size(), MeshFileValidation::Full, &error),
+            "validator: written file is valid");
+
+        // Offsets follow the layout in MeshFile.cpp: 128-byte header, then one 288-byte stream
+        const size_t streamTable = 128;
+        const size_t submeshTable = streamTable + 288;
+        uint64_t vertexOffset, indexOffset;
+        std::memcpy(&vertexOffset, valid.data() + streamTable, sizeof(vertexOffset));
+        std::memcpy(&indexOffset, valid.data() + 48, sizeof(indexOffset));
+
+        struct Corruption
+        {
+            const char* Name;
+            void (*Apply)(std::vector<uint8_t>& bytes, uint64_t vertexOffset, uint64_t indexOffset);
+            bool StructureFails;        // Otherwise only the full validation catches it
+            const char* FullError;      // Expected in the full validation's message
+        };
+        const Corruption corruptions[] =
+        {
+            { "truncated", [](std::vector<uint8_t>& b, uint64_t, uint64_t) { b.pop_back(); }, true, "size" },
+            { "header only", [](std::vector<uint8_t>& b, uint64_t, uint64_t) { b.resize(100); }, true, "smaller" },
+            { "magic", [](std::vector<uint8_t>& b, uint64_t, uint64_t) { b[0] = 'X'; }, true, "not a mesh" },
+            { "version", [](std::vector<uint8_t>& b, uint64_t, uint64_t) { Poke<uint32_t>(b, 8, 1); },
+                true, "version" },
+            { "index count", [](std::vector<uint8_t>& b, uint64_t, uint64_t) { Poke<uint32_t>(b, 40, 1u << 30); },
+                true, "index count" },
+            { "index bytes", [](std::vector<uint8_t>& b, uint64_t, uint64_t) { Poke<uint32_t>(b, 44, 1u << 30); },
+                true, "index stream" },
+            { "misaligned indices", [](std::vector<uint8_t>& b, uint64_t, uint64_t i) { Poke<uint64_t>(b, 48, i + 2); },
+                true, "index stream" },
+            { "stream count", [](std::vector<uint8_t>& b, uint64_t, uint64_t) { Poke<uint32_t>(b, 36, 9); },
+                true, "stream count" },
+            { "stream past the end", [](std::vector<uint8_t>& b, uint64_t, uint64_t)
+                { Poke<uint64_t>(b, streamTable, b.size() / 64 * 64); }, true, "data out of range" },
+            { "stride", [](std::vector<uint8_t>& b, uint64_t, uint64_t) { Poke<uint32_t>(b, streamTable + 16, 32); },
+                true, "stride" },
+            { "unterminated semantic", [](std::vector<uint8_t>& b, uint64_t, uint64_t)
+                { std::memset(b.data() + streamTable + 32, 'A', 16); }, true, "semantic" },
+            { "element format", [](std::vector<uint8_t>& b, uint64_t, uint64_t)
+                { Poke<uint32_t>(b, streamTable + 32 + 20, 57); }, true, "element format" },
+            { "element past the stride", [](std::vector<uint8_t>& b, uint64_t, uint64_t)
+                { Poke<uint32_t>(b, streamTable + 32 + 24, 20); }, true, "stride" },
+            { "submesh indices", [](std::vector<uint8_t>& b, uint64_t, uint64_t)
+                { Poke<uint32_t>(b, submeshTable, 1); }, true, "index range" },
+            { "submesh index format", [](std::vector<uint8_t>& b, uint64_t, uint64_t)
+                { Poke<uint32_t>(b, submeshTable + 20, 6); }, true, "index format" },
+            { "submesh 32-bit indices", [](std::vector<uint8_t>& b, uint64_t, uint64_t)
+                { Poke<uint32_t>(b, submeshTable + 20, 42); }, true, "index range" },
+            { "submesh bounds", [](std::vector<uint8_t>& b, uint64_t, uint64_t)
+                { Poke<float>(b, submeshTable + 24, std::nanf("")); }, true, "bounds" },
+            { "index outside the submesh", [](std::vector<uint8_t>& b, uint64_t, uint64_t i)
+                { Poke<uint16_t>(b, i + 4, 200); }, false, "outside the submesh" },
+            { "vertex data", [](std::vector<uint8_t>& b, uint64_t v, uint64_t) { b[v + 5] ^= 1; }, false, "hash" },
+            { "padding", [](std::vector<uint8_t>& b, uint64_t, uint64_t i) { b[i - 1] ^= 1; }, false, "hash" },
+        };
+
+        for (const Corruption& corruption : corruptions)
+        {
+            std::vector<uint8_t> bytes = valid;
+            corruption.Apply(bytes, vertexOffset, indexOffset);
+            bool structure = ValidateMeshFile(bytes.data(), bytes.size(), MeshFileValidation::Structure, &error);
+            bool full = ValidateMeshFile(bytes.data(), bytes.size(), MeshFileValidation::Full, &error);
+            if (structure != !corruption.StructureFails || full ||
+                error.find(corruption.FullError) == std::string::npos)
+            {
+                std::fprintf(stderr, "FAILED: validator: %s (structure %d, full %d: %s)\n", corruption.Name,
+                    structure, full, error.c_str());
+                ++g_Failures;
+            }
+        }
+
+        // Open refuses a corrupt file and stays closed
+        std::vector<uint8_t> bytes = valid;
+        Poke<uint32_t>(bytes, 8, 1);
+        MeshFile file;
+        Check(WriteFile(path, bytes.data(), bytes.size()) && !file.Open(path, &error) && !file.IsOpen() &&
+            error.find("version") != std::string::npos, "validator: open rejects a corrupt file");
+        Check(!file.Open((directory / "MeshFileBenchmark-missing.mesh").string(), &error), "validator: missing file");
+        std::filesystem::remove(path);
+    }
+
+    // Evicts the file from the page cache. Only clean pages can be dropped, so the data
+    // is synced first; returns false where that is not possible.
+    bool DropFileCache(const std::string& path)
+    {
+#ifndef _WIN32
+        int descriptor = open(path.c_str(), O_RDONLY);
+        if (descriptor < 0)
+            return false;
+        fdatasync(descriptor);
+        bool dropped = posix_fadvise(descriptor, 0, 0, POSIX_FADV_DONTNEED) == 0;
+        close(descriptor);
+        return dropped;
+#else
+        (void)path;
+        return false;
+#endif
+    }
+
+    // Fraction of the file's pages in the page cache, or -1 if unknown
+    double ResidentFraction(const std::string& path)
+    {
+#ifndef _WIN32
+        MappedFile file;
+        if (!file.Open(path) || file.GetSize() == 0)
+            return -1.0;
+        size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        size_t pages = (file.GetSize() + pageSize - 1) / pageSize;
+        std::vector<unsigned char> residency(pages);
+        if (mincore(const_cast<uint8_t*>(file.GetData()), file.GetSize(), residency.data()) != 0)
+            return -1.0;
+        size_t resident = 0;
+        for (unsigned char page : residency)
+            resident += page & 1;
+        return static_cast<double>(resident) / pages;
+#else
+        (void)path;
+        return -1.0;
+#endif
+    }
+
+    struct LoadTimes
+    {
+        double ColdMs = 0.0;
+        double WarmMs = 0.0;
+        double ColdResident = 0.0;     // Fraction of the file cached right before the cold loads
+        bool Succeeded = true;
+    };
+
+    // Runs load repeat times after dropping the file from the cache and repeat times
+    // with it cached, keeping the median of each
+    template <typename Load>
+    LoadTimes TimeLoads(const std::string& path, int repeat, Load&& load)
+    {
+        LoadTimes times;
+        std::vector<double> cold, warm;
+        for (int i = 0; i < repeat; ++i)
+        {
+            DropFileCache(path);
+            times.ColdResident += ResidentFraction(path) / repeat;
+            auto start = Clock::now();
+            times.Succeeded = load() && times.Succeeded;
+            cold.push_back(ElapsedMs(start));
+        }
+        load();
+        for (int i = 0; i < repeat; ++i)
+        {
+            auto start = Clock::now();
+            times.Succeeded = load() && times.Succeeded;
+            warm.push_back(ElapsedMs(start));
+        }
+        std::sort(cold.begin(), cold.end());
+        std::sort(warm.begin(), warm.end());
+        times.ColdMs = cold[cold.size() / 2];
+        times.WarmMs = warm[warm.size() / 2];
+        return times;
+    }
+
+    // Baseline for the mapped load: the file read into memory, then copied into the buffers
+    bool LoadCopied(const std::string& path)
+    {
+        std::vector<uint8_t> bytes;
+        if (!ReadFile(path, &bytes) || !ValidateMeshFile(bytes.data(), bytes.size(),
+            MeshFileValidation::Structure, nullptr))
+            return false;
+
+        uint64_t vertexOffset, vertexBytes, indexOffset;
+        uint32_t indexBytes;
+        std::memcpy(&vertexOffset, bytes.data() + 128, sizeof(vertexOffset));
+        std::memcpy(&vertexBytes, bytes.data() + 136, sizeof(vertexBytes));
+        std::memcpy(&indexBytes, bytes.data() + 44, sizeof(indexBytes));
+        std::memcpy(&indexOffset, bytes.data() + 48, sizeof(indexOffset));
+
+        NullRenderDevice device(64, 64);
+        BufferHandle vertexBuffer, indexBuffer;
+        BufferDesc vertexDesc = { static_cast<uint32_t>(vertexBytes), BufferBind::VertexBuffer,
+            BufferUsage::Immutable };
+        BufferDesc indexDesc = { indexBytes, BufferBind::IndexBuffer, BufferUsage::Immutable };
+        return device.CreateBuffer(vertexDesc, bytes.data() + vertexOffset, &vertexBuffer) &&
+            device.CreateBuffer(indexDesc, bytes.data() + indexOffset, &indexBuffer);
+    }
+
+    bool LoadMapped(const std::string& path)
+    {
+        MeshFile file;
+        NullRenderDevice device(64, 64);
+        BufferHandle vertexBuffers[MeshFile::MaxStreams], indexBuffer;
+        return file.Open(path, nullptr) && file.CreateBuffers(device, vertexBuffers, &indexBuffer);
+    }
+
+    double FileMB(const std::string& path)
+    {
+        std::error_code error;
+        return std::filesystem::file_size(path, error) / (1024.0 * 1024.0);
+    }
+
+    void PrintLoad(const char* name, const std::string& path, const LoadTimes& times)
+    {
+        if (times.ColdResident < 0.0)
+            std::printf("%-28s %9.1f %10s %10.2f %10s\n", name, FileMB(path), "n/a", times.WarmMs, "n/a");
+        else
+            std::printf("%-28s %9.1f %10.2f %10.2f %9.0f%%\n", name, FileMB(path), times.ColdMs, times.WarmMs,
+                times.ColdResident * 100.0);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    unsigned int threads = std::max(1u, std::thread::hardware_concurrency());
+    uint32_t triangles = 2000000;
+    int repeat = 5;
+    for (int i = 1; i < argc; ++i)
+    {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--triangles") == 0 && hasValue)
+            triangles = static_cast<uint32_t>(std::max(2, std::atoi(argv[++i])));
+        else if (std::strcmp(argv[i], "--repeat") == 0 && hasValue)
+            repeat = std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--threads") == 0 && hasValue)
+            threads = static_cast<unsigned int>(std::max(1, std::atoi(argv[++i])));
+        else
+        {
+            std::fprintf(stderr, "Usage: %s [--triangles N] [--repeat N] [--threads N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    std::filesystem::path directory = std::filesystem::temp_directory_path();
+    CheckRoundTrip(directory);
+    CheckStreams(directory);
+    CheckWriterErrors(directory);
+    CheckValidator(directory);
+    if (g_Failures)
+    {
+        std::fprintf(stderr, "%d check(s) failed\n", g_Failures);
+        return 1;
+    }
+    std::printf("MeshFile checks passed\n\n");
+
+    uint32_t columns = static_cast<uint32_t>(std::sqrt(triangles / 2.0)) + 1;
+    uint32_t rows = std::max(1u, triangles / (2 * columns));
+    MeshData mesh = MakeGridMesh(columns, rows);
+
+    std::string floatPath = (directory / "MeshFileBenchmark-float.mesh").string();
+    std::string packedPath = (directory / "MeshFileBenchmark-packed.mesh").string();
+    std::string objPath = (directory / "MeshFileBenchmark.obj").string();
+    std::string error;
+    std::vector<uint8_t> floatStorage, packedStorage;
+    std::string obj = MakeObj(mesh);
+    bool written = WriteMeshFile(floatPath, MakeMeshFileDesc(mesh, VertexFormat::Float32, &floatStorage), &error) &&
+        WriteMeshFile(packedPath, MakeMeshFileDesc(mesh, VertexFormat::Snorm16, &packedStorage), &error) &&
+        WriteFile(objPath, obj.data(), obj.size());
+    obj.clear();
+    obj.shrink_to_fit();
+    if (!written)
+    {
+        std::fprintf(stderr, "Failed to write the test files to %s: %s\n", directory.string().c_str(),
+            error.c_str());
+        return 1;
+    }
+
+    std::printf("%u vertices, %u triangles, median of %d loads into null-backend buffers\n",
+        static_cast<uint32_t>(mesh.Vertices.size()), mesh.GetTriangleCount(), repeat);
+    std::printf("%-28s %9s %10s %10s %10s\n", "Loader", "File MB", "Cold ms", "Warm ms", "Resident");
+
+    JobSystem jobSystem(threads);
+    MeshImportOptions options;
+    options.ConvertToLeftHanded = false;
+    LoadTimes mapped = TimeLoads(floatPath, repeat, [&] { return LoadMapped(floatPath); });
+    LoadTimes copied = TimeLoads(floatPath, repeat, [&] { return LoadCopied(floatPath); });
+    LoadTimes packed = TimeLoads(packedPath, repeat, [&] { return LoadMapped(packedPath); });
+    LoadTimes imported = TimeLoads(objPath, repeat, [&]
+    {
+        MeshData importedMesh;
+        NullRenderDevice device(64, 64);
+        BufferHandle vertexBuffer, indexBuffer;
+        return ImportMesh(objPath, options, &jobSystem, &importedMesh, nullptr) &&
+            device.CreateBuffer({ static_cast<uint32_t>(importedMesh.Vertices.size() * sizeof(Vertex)),
+                BufferBind::VertexBuffer, BufferUsage::Immutable }, importedMesh.Vertices.data(), &vertexBuffer) &&
+            device.CreateBuffer({ static_cast<uint32_t>(importedMesh.Indices.size() * sizeof(uint32_t)),
+                BufferBind::IndexBuffer, BufferUsage::Immutable }, importedMesh.Indices.data(), &indexBuffer);
+    });
+    PrintLoad(".mesh mapped (float32)", floatPath, mapped);
+    PrintLoad(".mesh read + copy (float32)", floatPath, copied);
+    PrintLoad(".mesh mapped (snorm16)", packedPath, packed);
+    char objName[64];
+    std::snprintf(objName, sizeof(objName), "OBJ import (%u threads)", threads);
+    PrintLoad(objName, objPath, imported);
+
+    // Open alone only reads the header and tables; the full check scans everything
+    MeshFile file;
+    auto start = Clock::now();
+    bool opened = file.Open(floatPath, &error);
+    double openMs = ElapsedMs(start);
+    start = Clock::now();
+    bool validated = opened && ValidateMeshFile(file.GetMappedFile().GetData(), file.GetMappedFile().GetSize(),
+        MeshFileValidation::Full, &error);
+    double validateMs = ElapsedMs(start);
+    std::printf("\nOpen (map + structure check): %.3f ms, full validation: %.1f ms (%.0f MB/s)\n", openMs,
+        validateMs, FileMB(floatPath) / (validateMs / 1000.0));
+    file.Close();
+
+    bool succeeded = mapped.Succeeded && copied.Succeeded && packed.Succeeded && imported.Succeeded && validated;
+    if (!succeeded)
+        std::fprintf(stderr, "A load failed%s%s\n", error.empty() ? "" : ": ", error.c_str());
+    std::filesystem::remove(floatPath);
+    std::filesystem::remove(packedPath);
+    std::filesystem::remove(objPath);
+    return succeeded ? 0 : 1;
+}
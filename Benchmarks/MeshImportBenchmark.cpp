@@ -0,0 +1,567 @@
+// Checks and throughput of MeshImporter, the memory-mapped OBJ / GLB loader.
+// The checks cover the OBJ syntax the importer accepts (polygons, negative
+// indices, v/vt/vn corners, vertex colors, CRLF), error lines, chunked parsing
+// against a single chunk, and GLB node transforms, strides, strips and bounds
+// checks. The benchmark writes a large OBJ and GLB grid to the temp directory
+// and imports them with 1..N threads, reporting MB/s and triangles/s.
+//
+// Build (from the repository root):
+//   g++ -std=c++20 -O2 -pthread -ICommon Benchmarks/MeshImportBenchmark.cpp Common/MeshImporter.cpp
+//       Common/MappedFile.cpp Common/JobSystem.cpp -o MeshImportBenchmark
+//
+// Usage: MeshImportBenchmark [--triangles N] [--threads N] [--file mesh.obj|mesh.glb]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "JobSystem.h"
+#include "MeshImporter.h"
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    int g_Failures = 0;
+
+    void Check(bool condition, const char* what)
+    {
+        if (!condition)
+        {
+            std::fprintf(stderr, "FAILED: %s\n", what);
+            ++g_Failures;
+        }
+    }
+
+    double ElapsedMs(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    const uint8_t* Bytes(const std::string& text)
+    {
+        return reinterpret_cast<const uint8_t*>(text.data());
+    }
+
+    bool Near(const Float3& a, const Float3& b)
+    {
+        return std::fabs(a.x - b.x) < 1e-5f && std::fabs(a.y - b.y) < 1e-5f && std::fabs(a.z - b.z) < 1e-5f;
+    }
+
+    bool SameMesh(const MeshData& a, const MeshData& b)
+    {
+        return a.Vertices.size() == b.Vertices.size() && a.Indices == b.Indices &&
+            std::memcmp(a.Vertices.data(), b.Vertices.data(), a.Vertices.size() * sizeof(Vertex)) == 0;
+    }
+
+    bool WriteFile(const std::string& path, const void* data, size_t size)
+    {
+        FILE* file = std::fopen(path.c_str(), "wb");
+        if (!file)
+            return false;
+        bool written = std::fwrite(data, 1, size, file) == size;
+        return std::fclose(file) == 0 && written;
+    }
+
+    // GLB container around a JSON document and a BIN chunk, both padded to 4 bytes
+    std::vector<uint8_t> MakeGlb(std::string json, std::vector<uint8_t> bin)
+    {
+        json.resize((json.size() + 3) & ~size_t(3), ' ');
+        bin.resize((bin.size() + 3) & ~size_t(3), 0);
+
+        std::vector<uint8_t> glb;
+        auto append = [&](const void* data, size_t size)
+        {
+            const uint8_t* bytes = static_cast<const uint8_t*>(data);
+            glb.insert(glb.end(), bytes, bytes + size);
+        };
+        auto appendU32 = [&](uint32_t value) { append(&value, 4); };
+
+        appendU32(0x46546c67);
+        appendU32(2);
+        appendU32(static_cast<uint32_t>(12 + 8 + json.size() + (bin.empty() ? 0 : 8 + bin.size())));
+        appendU32(static_cast<uint32_t>(json.size()));
+        appendU32(0x4e4f534a);
+        append(json.data(), json.size());
+        if (!bin.empty())
+        {
+            appendU32(static_cast<uint32_t>(bin.size()));
+            appendU32(0x004e4942);
+            append(bin.data(), bin.size());
+        }
+        return glb;
+    }
+
+    template <typename T>
+    void AppendBytes(std::vector<uint8_t>& bin, const T* data, size_t count)
+    {
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+        bin.insert(bin.end(), bytes, bytes + count * sizeof(T));
+    }
+
+    void CheckObjSyntax()
+    {
+        // A quad with v/vt/vn corners, a triangle with negative indices, colors, comments and CRLF
+        const std::string obj =
+            "# exported\r\n"
+            "mtllib scene.mtl\r\n"
+            "o Quad\r\n"
+            "v 0 0 0 1 0 0\r\n"
+            "v 1 0 0 0 1 0\r\n"
+            "v +1 1 0 0 0 1\r\n"
+            "v 0 1.5e0 0\r\n"
+            "vt 0 0\r\n"
+            "vn 0 0 1\r\n"
+            "\r\n"
+            "  f 1/1/1 2/1/1 3/1/1 4/1/1   # quad\r\n"
+            "v 0 0 2\n"
+            "f -1 -4 -3\n"
+            "s off\n"
+            "l 1 2\n";
+
+        MeshImportOptions options;
+        options.DefaultColor = { 0.5f, 0.5f, 0.5f, 1.0f };
+        options.ConvertToLeftHanded = false;
+        MeshData mesh;
+        std::string error;
+        Check(ImportObj(Bytes(obj), obj.size(), options, nullptr, &mesh, &error), "obj: syntax sample imports");
+        Check(mesh.Vertices.size() == 5 && mesh.GetTriangleCount() == 3, "obj: 5 vertices, quad + triangle");
+        Check(mesh.Indices == std::vector<uint32_t>({ 0, 1, 2, 0, 2, 3, 4, 1, 2 }), "obj: fan and negative indices");
+        Check(mesh.Vertices.size() == 5 && Near(mesh.Vertices[3].Position, { 0.0f, 1.5f, 0.0f }) &&
+            Near(mesh.Vertices[2].Position, { 1.0f, 1.0f, 0.0f }), "obj: positions");
+        Check(mesh.Vertices.size() == 5 && mesh.Vertices[1].Color.y == 1.0f && mesh.Vertices[1].Color.w == 1.0f &&
+            mesh.Vertices[3].Color.x == 0.5f, "obj: vertex colors and default color");
+
+        // Left-handed: Z negated and the triangles reversed
+        MeshData leftHanded;
+        options.ConvertToLeftHanded = true;
+        Check(ImportObj(Bytes(obj), obj.size(), options, nullptr, &leftHanded, &error), "obj: left-handed import");
+        Check(leftHanded.Indices == std::vector<uint32_t>({ 0, 2, 1, 0, 3, 2, 4, 2, 1 }), "obj: winding reversed");
+        Check(leftHanded.Vertices.size() == 5 && leftHanded.Vertices[4].Position.z == -2.0f, "obj: Z negated");
+
+        // An empty file is an empty mesh
+        Check(ImportObj(Bytes(obj), 0, options, nullptr, &mesh, &error) && mesh.Vertices.empty(), "obj: empty file");
+    }
+
+    void CheckObjErrors()
+    {
+        struct Case
+        {
+            const char* Text;
+            const char* Error;
+        };
+        const Case cases[] =
+        {
+            { "v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 4\n", "line 4: face index out of range" },
+            { "v 0 0 0\nv 1 0 0\nf 1 2\n", "line 3: face needs at least 3 vertices" },
+            { "v 0 0\n", "line 1: vertex needs x, y and z" },
+            { "v 0 0 0\nv 1 0 0\nv 0 1 0\nf 0 1 2\n", "line 4: bad face index" },
+            { "v 0 0 0\nf -2 -1 1\n", "line 2: face index out of range" },
+            { "v 0 0 0\nf a b c\n", "line 2: bad face index" },
+        };
+        for (const Case& test : cases)
+        {
+            MeshData mesh;
+            std::string error;
+            std::string text = test.Text;
+            bool imported = ImportObj(Bytes(text), text.size(), MeshImportOptions(), nullptr, &mesh, &error);
+            Check(!imported && error == test.Error && mesh.Vertices.empty(), test.Error);
+        }
+
+        // The line number counts the lines of the chunks before the failing one
+        std::string text;
+        for (int i = 0; i < 1000; ++i)
+            text += "v 0 0 0\n";
+        text += "f 1 2 1001\n";
+        MeshImportOptions options;
+        options.ObjChunkBytes = 100;
+        MeshData mesh;
+        std::string error;
+        Check(!ImportObj(Bytes(text), text.size(), options, nullptr, &mesh, &error) &&
+            error == "line 1001: face index out of range", "obj: error line across chunks");
+    }
+
+    // Grid of quads with colors and v/vt/vn corners, faces interleaved with the vertices
+    // and using negative indices, so chunks depend on vertices defined in earlier chunks
+    std::string MakeGridObj(uint32_t columns, uint32_t rows)
+    {
+        std::string obj = "# grid\no Grid\n";
+        char line[160];
+        for (uint32_t y = 0; y <= rows; ++y)
+        {
+            for (uint32_t x = 0; x <= columns; ++x)
+            {
+                float height = 0.25f * std::sin(x * 0.1f) * std::cos(y * 0.1f);
+                std::snprintf(line, sizeof(line), "v %.6f %.6f %.6f %.4f %.4f %.4f\n", x * 0.01f, height, y * 0.01f,
+                    x / static_cast<float>(columns), y / static_cast<float>(rows), 0.5f);
+                obj += line;
+            }
+            if (y == 0)
+                continue;
+
+            // Row y - 1 to y, relative to the end of row y
+            int32_t rowStart = -static_cast<int32_t>(2 * (columns + 1));
+            for (uint32_t x = 0; x < columns; ++x)
+            {
+                int32_t a = rowStart + static_cast<int32_t>(x), b = a + 1;
+                int32_t c = b + static_cast<int32_t>(columns + 1), d = c - 1;
+                std::snprintf(line, sizeof(line), "f %d/%d/1 %d/%d/1 %d/%d/1 %d/%d/1\n", a, a, d, d, c, c, b, b);
+                obj += line;
+            }
+        }
+        return obj;
+    }
+
+    void CheckObjChunks(unsigned int maxThreads)
+    {
+        std::string obj = MakeGridObj(40, 30);
+        MeshImportOptions options;
+        options.ObjChunkBytes = obj.size();
+        MeshData reference;
+        std::string error;
+        Check(ImportObj(Bytes(obj), obj.size(), options, nullptr, &reference, &error), "obj chunks: reference import");
+        Check(reference.Vertices.size() == 41 * 31 && reference.GetTriangleCount() == 40 * 30 * 2,
+            "obj chunks: grid counts");
+
+        bool same = true;
+        for (unsigned int threads = 1; threads <= maxThreads; threads = threads * 2)
+        {
+            JobSystem jobSystem(threads);
+            for (size_t chunkBytes : { size_t(1), size_t(7), size_t(100), size_t(4096), size_t(30000) })
+            {
+                options.ObjChunkBytes = chunkBytes;
+                MeshData mesh;
+                same = same && ImportObj(Bytes(obj), obj.size(), options, &jobSystem, &mesh, &error) &&
+                    SameMesh(mesh, reference);
+            }
+        }
+        Check(same, "obj chunks: every chunk size and thread count matches one chunk");
+
+        // No trailing newline, and the split landing inside the last line
+        std::string tail = "v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 3";
+        options.ObjChunkBytes = 5;
+        MeshData mesh;
+        Check(ImportObj(Bytes(tail), tail.size(), options, nullptr, &mesh, &error) && mesh.GetTriangleCount() == 1,
+            "obj chunks: last line without newline");
+    }
+
+    void CheckGlb()
+    {
+        // Mesh 0: indexed triangles, uint16 indices, interleaved position + normalized RGBA8 color.
+        // Mesh 1: a non-indexed strip without colors.
+        struct InterleavedVertex
+        {
+            float Position[3];
+            uint8_t Color[4];
+        };
+        const InterleavedVertex quad[4] =
+        {
+            { { 0, 0, 0 }, { 255, 0, 0, 255 } },
+            { { 1, 0, 0 }, { 0, 255, 0, 255 } },
+            { { 1, 1, 0 }, { 0, 0, 255, 255 } },
+            { { 0, 1, 0 }, { 255, 255, 255, 51 } },
+        };
+        const uint16_t quadIndices[6] = { 0, 1, 2, 0, 2, 3 };
+        const float strip[4][3] = { { 0, 0, 0 }, { 1, 0, 0 }, { 0, 1, 0 }, { 1, 1, 0 } };
+
+        std::vector<uint8_t> bin;
+        AppendBytes(bin, quad, 4);              // 0..63
+        AppendBytes(bin, quadIndices, 6);       // 64..75
+        AppendBytes(bin, &strip[0][0], 12);     // 76..123
+
+        // Node 0 translates mesh 0; node 1 scales by 2 and its child turns mesh 1 by 90 degrees about Y
+        const char* json = R"({
+            "asset": { "version": "2.0" },
+            "scene": 0,
+            "scenes": [ { "nodes": [ 0, 1 ] } ],
+            "nodes": [
+                { "mesh": 0, "translation": [ 1, 2, 3 ] },
+                { "scale": [ 2, 2, 2 ], "children": [ 2 ] },
+                { "mesh": 1, "rotation": [ 0, 0.70710678, 0, 0.70710678 ] }
+            ],
+            "meshes": [
+                { "primitives": [ { "attributes": { "POSITION": 0, "COLOR_0": 1 }, "indices": 2 } ] },
+                { "primitives": [ { "attributes": { "POSITION": 3 }, "mode": 5 },
+                                  { "attributes": { "POSITION": 3 }, "mode": 1 } ] }
+            ],
+            "buffers": [ { "byteLength": 124 } ],
+            "bufferViews": [
+                { "buffer": 0, "byteOffset": 0, "byteLength": 64, "byteStride": 16 },
+                { "buffer": 0, "byteOffset": 64, "byteLength": 12 },
+                { "buffer": 0, "byteOffset": 76, "byteLength": 48 }
+            ],
+            "accessors": [
+                { "bufferView": 0, "componentType": 5126, "count": 4, "type": "VEC3" },
+                { "bufferView": 0, "byteOffset": 12, "componentType": 5121, "normalized": true, "count": 4,
+                  "type": "VEC4" },
+                { "bufferView": 1, "componentType": 5123, "count": 6, "type": "SCALAR" },
+                { "bufferView": 2, "componentType": 5126, "count": 4, "type": "VEC3" }
+            ]
+        })";
+
+        std::vector<uint8_t> glb = MakeGlb(json, bin);
+        MeshImportOptions options;
+        options.ConvertToLeftHanded = false;
+        options.DefaultColor = { 0.25f, 0.25f, 0.25f, 1.0f };
+        MeshData mesh;
+        std::string error;
+        bool imported = ImportGlb(glb.data(), glb.size(), options, nullptr, &mesh, &error);
+        Check(imported, "glb: sample imports");
+        if (!imported)
+        {
+            std::fprintf(stderr, "  %s\n", error.c_str());
+            return;
+        }
+
+        Check(mesh.Vertices.size() == 8 && mesh.GetTriangleCount() == 4,
+            "glb: 8 vertices, 2 + 2 triangles (lines skipped)");
+        Check(mesh.Indices == std::vector<uint32_t>({ 0, 1, 2, 0, 2, 3, 4, 5, 6, 5, 7, 6 }),
+            "glb: index offsets and strip winding");
+        Check(Near(mesh.Vertices[2].Position, { 2.0f, 3.0f, 3.0f }), "glb: translation");
+        Check(mesh.Vertices[3].Color.w == 0.2f && mesh.Vertices[0].Color.x == 1.0f && mesh.Vertices[0].Color.y == 0.0f,
+            "glb: strided normalized colors");
+        // (1, 0, 0) turned 90 degrees about +Y is (0, 0, -1), then scaled by 2
+        Check(Near(mesh.Vertices[5].Position, { 0.0f, 0.0f, -2.0f }) &&
+            Near(mesh.Vertices[6].Position, { 0.0f, 2.0f, 0.0f }),
+            "glb: rotation and parent scale");
+        Check(mesh.Vertices[4].Color.x == 0.25f, "glb: default color without COLOR_0");
+
+        // Left-handed: Z negated, triangles reversed
+        options.ConvertToLeftHanded = true;
+        MeshData leftHanded;
+        Check(ImportGlb(glb.data(), glb.size(), options, nullptr, &leftHanded, &error) &&
+            leftHanded.Indices[1] == 2 && leftHanded.Indices[2] == 1 &&
+            Near(leftHanded.Vertices[2].Position, { 2.0f, 3.0f, -3.0f }),
+            "glb: left-handed conversion");
+
+        // Damaged files fail with the mesh left empty
+        auto expectFailure = [&](std::vector<uint8_t> file, const char* what)
+        {
+            MeshData failed;
+            std::string message;
+            bool imported = ImportGlb(file.data(), file.size(), options, nullptr, &failed, &message);
+            Check(!imported && failed.Vertices.empty() && !message.empty(), what);
+        };
+        std::vector<uint8_t> badMagic = glb;
+        badMagic[0] = 'x';
+        expectFailure(badMagic, "glb: bad magic");
+        expectFailure(std::vector<uint8_t>(glb.begin(), glb.begin() + 40), "glb: truncated");
+
+        std::string outside = json;
+        outside.replace(outside.find("\"count\": 6"), 10, "\"count\": 7");
+        expectFailure(MakeGlb(outside, bin), "glb: accessor outside its view");
+
+        std::vector<uint8_t> badIndex = bin;
+        badIndex[64 + 2 * 5] = 9;
+        expectFailure(MakeGlb(json, badIndex), "glb: index out of range");
+
+        std::string badJson = json;
+        badJson.resize(badJson.size() / 2);
+        expectFailure(MakeGlb(badJson, bin), "glb: truncated JSON");
+
+        std::string external = json;
+        external.replace(external.find("\"byteLength\": 124"), 17, "\"uri\": \"mesh.bin\"");
+        expectFailure(MakeGlb(external, bin), "glb: external buffer");
+    }
+
+    // The grid as a GLB: float positions, RGBA8 colors and uint32 indices in separate views
+    std::vector<uint8_t> MakeGridGlb(uint32_t columns, uint32_t rows)
+    {
+        uint32_t vertexCount = (columns + 1) * (rows + 1);
+        std::vector<float> positions;
+        std::vector<uint8_t> colors;
+        std::vector<uint32_t> indices;
+        for (uint32_t y = 0; y <= rows; ++y)
+        {
+            for (uint32_t x = 0; x <= columns; ++x)
+            {
+                float height = 0.25f * std::sin(x * 0.1f) * std::cos(y * 0.1f);
+                positions.insert(positions.end(), { x * 0.01f, height, y * 0.01f });
+                colors.insert(colors.end(), { static_cast<uint8_t>(x), static_cast<uint8_t>(y), 128, 255 });
+            }
+        }
+        for (uint32_t y = 0; y < rows; ++y)
+        {
+            for (uint32_t x = 0; x < columns; ++x)
+            {
+                uint32_t a = y * (columns + 1) + x, b = a + 1, c = b + columns + 1, d = c - 1;
+                indices.insert(indices.end(), { a, d, c, a, c, b });
+            }
+        }
+
+        std::vector<uint8_t> bin;
+        AppendBytes(bin, positions.data(), positions.size());
+        AppendBytes(bin, colors.data(), colors.size());
+        AppendBytes(bin, indices.data(), indices.size());
+
+        size_t positionBytes = positions.size() * 4, colorBytes = colors.size(), indexBytes = indices.size() * 4;
+        char json[2048];
+        std::snprintf(json, sizeof(json), R"({"asset":{"version":"2.0"},"scene":0,"scenes":[{"nodes":[0]}],)"
+            R"("nodes":[{"mesh":0}],"meshes":[{"primitives":[{"attributes":{"POSITION":0,"COLOR_0":1},"indices":2}]}],)"
+            R"("buffers":[{"byteLength":%zu}],"bufferViews":[{"buffer":0,"byteLength":%zu},)"
+            R"({"buffer":0,"byteOffset":%zu,"byteLength":%zu},{"buffer":0,"byteOffset":%zu,"byteLength":%zu}],)"
+            R"("accessors":[{"bufferView":0,"componentType":5126,"count":%u,"type":"VEC3"},)"
+            R"({"bufferView":1,"componentType":5121,"normalized":true,"count":%u,"type":"VEC4"},)"
+            R"({"bufferView":2,"componentType":5125,"count":%zu,"type":"SCALAR"}]})",
+            bin.size(), positionBytes, positionBytes, colorBytes, positionBytes + colorBytes, indexBytes,
+            vertexCount, vertexCount, indices.size());
+        return MakeGlb(json, bin);
+    }
+
+    void CheckFiles(const std::filesystem::path& directory)
+    {
+        std::string obj = MakeGridObj(8, 8);
+        std::vector<uint8_t> glb = MakeGridGlb(8, 8);
+        std::string objPath = (directory / "MeshImportCheck.OBJ").string();
+        std::string glbPath = (directory / "MeshImportCheck.glb").string();
+        Check(WriteFile(objPath, obj.data(), obj.size()) && WriteFile(glbPath, glb.data(), glb.size()),
+            "files: write samples");
+
+        MeshData fromObj, fromGlb;
+        std::string error;
+        Check(ImportMesh(objPath, MeshImportOptions(), nullptr, &fromObj, &error) && fromObj.GetTriangleCount() == 128,
+            "files: OBJ by extension");
+        Check(ImportMesh(glbPath, MeshImportOptions(), nullptr, &fromGlb, &error) && fromGlb.GetTriangleCount() == 128,
+            "files: GLB by magic");
+
+        // Both describe the same grid; positions match, the triangles may only differ in their first corner
+        bool same = fromObj.Vertices.size() == fromGlb.Vertices.size();
+        for (size_t i = 0; same && i < fromObj.Vertices.size(); ++i)
+            same = Near(fromObj.Vertices[i].Position, fromGlb.Vertices[i].Position);
+        Check(same, "files: OBJ and GLB grids agree");
+
+        std::string missingPath = (directory / "MeshImportMissing.obj").string();
+        Check(!ImportMesh(missingPath, MeshImportOptions(), nullptr, &fromObj, &error), "files: missing file fails");
+        std::filesystem::remove(objPath);
+        std::filesystem::remove(glbPath);
+    }
+
+    struct ImportTiming
+    {
+        double Ms = 0.0;
+        MeshData Mesh;
+        std::string Error;
+    };
+
+    // Best of a few imports; the file stays in the page cache, so this is the parse cost
+    bool TimeImport(const std::string& path, const MeshImportOptions& options, JobSystem* jobSystem,
+        ImportTiming* timing)
+    {
+        timing->Ms = 1e30;
+        for (int run = 0; run < 3; ++run)
+        {
+            auto start = Clock::now();
+            if (!ImportMesh(path, options, jobSystem, &timing->Mesh, &timing->Error))
+                return false;
+            timing->Ms = std::min(timing->Ms, ElapsedMs(start));
+        }
+        return true;
+    }
+
+    bool BenchmarkFile(const std::string& path, unsigned int maxThreads)
+    {
+        size_t bytes = std::filesystem::file_size(path);
+        std::printf("%s: %.1f MB\n", path.c_str(), bytes / 1e6);
+        std::printf("%8s %12s %10s %10s %14s %9s\n", "threads", "mode", "ms", "MB/s", "M tris/s", "speedup");
+
+        // The whole file as one OBJ chunk on the calling thread is the serial baseline
+        MeshImportOptions serialOptions;
+        serialOptions.ObjChunkBytes = SIZE_MAX;
+        ImportTiming serial;
+        if (!TimeImport(path, serialOptions, nullptr, &serial))
+        {
+            std::fprintf(stderr, "Import failed: %s\n", serial.Error.c_str());
+            return false;
+        }
+        auto report = [&](const char* threads, const char* mode, const ImportTiming& timing)
+        {
+            std::printf("%8s %12s %10.1f %10.1f %14.2f %8.2fx\n", threads, mode, timing.Ms,
+                bytes / (timing.Ms * 1000.0),
+                timing.Mesh.GetTriangleCount() / (timing.Ms * 1000.0), serial.Ms / timing.Ms);
+        };
+        report("1", "serial", serial);
+
+        // 1, 2, 4, ... and maxThreads
+        for (unsigned int threads = 1; threads <= maxThreads;
+            threads = threads < maxThreads && threads * 2 > maxThreads ? maxThreads : threads * 2)
+        {
+            JobSystem jobSystem(threads);
+            ImportTiming parallel;
+            if (!TimeImport(path, MeshImportOptions(), &jobSystem, &parallel) || !SameMesh(parallel.Mesh, serial.Mesh))
+            {
+                std::fprintf(stderr, "Parallel import differs from the serial one\n");
+                return false;
+            }
+            char threadText[16];
+            std::snprintf(threadText, sizeof(threadText), "%u", threads);
+            report(threadText, "jobs", parallel);
+        }
+        std::printf("\n");
+        return true;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    unsigned int maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    uint32_t triangles = 2000000;
+    std::string file;
+    for (int i = 1; i < argc; ++i)
+    {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--triangles") == 0 && hasValue)
+            triangles = static_cast<uint32_t>(std::max(2, std::atoi(argv[++i])));
+        else if (std::strcmp(argv[i], "--threads") == 0 && hasValue)
+            maxThreads = static_cast<unsigned int>(std::max(1, std::atoi(argv[++i])));
+        else if (std::strcmp(argv[i], "--file") == 0 && hasValue)
+            file = argv[++i];
+        else
+        {
+            std::fprintf(stderr, "Usage: %s [--triangles N] [--threads N] [--file mesh.obj|mesh.glb]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    std::filesystem::path directory = std::filesystem::temp_directory_path();
+    CheckObjSyntax();
+    CheckObjErrors();
+    CheckObjChunks(maxThreads);
+    CheckGlb();
+    CheckFiles(directory);
+    if (g_Failures)
+    {
+        std::fprintf(stderr, "%d check(s) failed\n", g_Failures);
+        return 1;
+    }
+    std::printf("MeshImporter checks passed\n\n");
+
+    if (!file.empty())
+        return BenchmarkFile(file, maxThreads) ? 0 : 1;
+
+    // A square-ish grid with the requested number of triangles
+    uint32_t columns = static_cast<uint32_t>(std::sqrt(triangles / 2.0)) + 1;
+    uint32_t rows = std::max(1u, triangles / (2 * columns));
+    std::string objPath = (directory / "MeshImportBenchmark.obj").string();
+    std::string glbPath = (directory / "MeshImportBenchmark.glb").string();
+    std::string obj = MakeGridObj(columns, rows);
+    std::vector<uint8_t> glb = MakeGridGlb(columns, rows);
+    if (!WriteFile(objPath, obj.data(), obj.size()) || !WriteFile(glbPath, glb.data(), glb.size()))
+    {
+        std::fprintf(stderr, "Failed to write the test files to %s\n", directory.string().c_str());
+        return 1;
+    }
+    obj.clear();
+    obj.shrink_to_fit();
+
+    bool succeeded = BenchmarkFile(objPath, maxThreads) && BenchmarkFile(glbPath, maxThreads);
+    std::filesystem::remove(objPath);
+    std::filesystem::remove(glbPath);
+    return succeeded ? 0 : 1;
+}
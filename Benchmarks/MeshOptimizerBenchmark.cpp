@@ -0,0 +1,410 @@
+// Checks and speed of MeshOptimizer, the index / vertex reordering passes.
+// The checks cover the FIFO and LRU cache simulators on hand-counted
+// sequences, that every pass only permutes triangles (in place or not),
+// the ACMR the cache passes reach on a shuffled grid, the overdraw pass on
+// stacked layers drawn back to front, and the vertex fetch remap. The
+// benchmark optimizes a row of overlapping lumpy spheres with millions of
+// triangles, once in authoring order and once with triangles and vertices
+// shuffled, and reports the time of every pass with ACMR / ATVR (FIFO and
+// LRU), overdraw and vertex fetch overfetch before and after.
+//
+// Build (from the repository root):
+//   g++ -std=c++20 -O2 -pthread -ICommon Benchmarks/MeshOptimizerBenchmark.cpp Common/MeshOptimizer.cpp
+//       -o MeshOptimizerBenchmark
+//
+// Usage: MeshOptimizerBenchmark [--triangles N] [--cache N]
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "CubeMesh.h"
+#include "MeshOptimizer.h"
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    int g_Failures = 0;
+
+    void Check(bool condition, const char* what)
+    {
+        if (!condition)
+        {
+            std::fprintf(stderr, "FAILED: %s\n", what);
+            ++g_Failures;
+        }
+    }
+
+    double ElapsedMs(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    // columns x rows quads in the plane z = depth, facing -z
+    void AppendGrid(MeshData* mesh, uint32_t columns, uint32_t rows, float depth)
+    {
+        uint32_t base = static_cast<uint32_t>(mesh->Vertices.size());
+        for (uint32_t y = 0; y <= rows; ++y)
+        {
+            for (uint32_t x = 0; x <= columns; ++x)
+                mesh->Vertices.push_back({ { float(x), float(y), depth }, { 1.0f, 1.0f, 1.0f, 1.0f } });
+        }
+        for (uint32_t y = 0; y < rows; ++y)
+        {
+            for (uint32_t x = 0; x < columns; ++x)
+            {
+                uint32_t a = base + y * (columns + 1) + x, b = a + 1, c = b + columns + 1, d = c - 1;
+                mesh->Indices.insert(mesh->Indices.end(), { a, d, c, a, c, b });
+            }
+        }
+    }
+
+    // count spheres of radius 1 along x, overlapping, with a bumpy surface so that they
+    // also occlude themselves; rings x segments quads each, triangles facing outward
+    MeshData MakeSpheres(uint32_t count, uint32_t rings, uint32_t segments)
+    {
+        MeshData mesh;
+        for (uint32_t s = 0; s < count; ++s)
+        {
+            uint32_t base = static_cast<uint32_t>(mesh.Vertices.size());
+            float centerX = s * 1.4f;
+            for (uint32_t r = 0; r <= rings; ++r)
+            {
+                float theta = MathPi * r / rings;
+                for (uint32_t g = 0; g <= segments; ++g)
+                {
+                    float phi = MathTwoPi * g / segments;
+                    float radius = 1.0f + 0.15f * std::sin(7.0f * theta) * std::sin(5.0f * phi);
+                    Float3 p = { centerX + radius * std::sin(theta) * std::cos(phi), radius * std::cos(theta),
+                        radius * std::sin(theta) * std::sin(phi) };
+                    mesh.Vertices.push_back({ p, { float(r) / rings, float(g) / segments, float(s) / count, 1.0f } });
+                }
+            }
+            for (uint32_t r = 0; r < rings; ++r)
+            {
+                for (uint32_t g = 0; g < segments; ++g)
+                {
+                    uint32_t a = base + r * (segments + 1) + g, b = a + 1, c = b + segments + 1, d = c - 1;
+                    mesh.Indices.insert(mesh.Indices.end(), { a, b, c, a, c, d });
+                }
+            }
+        }
+        return mesh;
+    }
+
+    void ShuffleTriangles(std::vector<uint32_t>* indices, uint32_t seed)
+    {
+        size_t triangleCount = indices->size() / 3;
+        std::vector<uint32_t> order(triangleCount);
+        std::iota(order.begin(), order.end(), 0u);
+        std::shuffle(order.begin(), order.end(), std::mt19937(seed));
+        std::vector<uint32_t> shuffled(indices->size());
+        for (size_t t = 0; t < triangleCount; ++t)
+            std::memcpy(&shuffled[t * 3], &(*indices)[size_t(order[t]) * 3], 3 * sizeof(uint32_t));
+        *indices = std::move(shuffled);
+    }
+
+    // Renumbers the vertices at random, like a tool that does not keep neighbors together
+    void ShuffleVertices(MeshData* mesh, uint32_t seed)
+    {
+        std::vector<uint32_t> remap(mesh->Vertices.size());
+        std::iota(remap.begin(), remap.end(), 0u);
+        std::shuffle(remap.begin(), remap.end(), std::mt19937(seed));
+        std::vector<Vertex> vertices(mesh->Vertices.size());
+        for (size_t v = 0; v < vertices.size(); ++v)
+            vertices[remap[v]] = mesh->Vertices[v];
+        mesh->Vertices = std::move(vertices);
+        for (uint32_t& index : mesh->Indices)
+            index = remap[index];
+    }
+
+    // The triangles as a sorted list, for comparing orders
+    std::vector<std::array<uint32_t, 3>> SortedTriangles(const std::vector<uint32_t>& indices)
+    {
+        std::vector<std::array<uint32_t, 3>> triangles(indices.size() / 3);
+        for (size_t t = 0; t < triangles.size(); ++t)
+            triangles[t] = { indices[t * 3], indices[t * 3 + 1], indices[t * 3 + 2] };
+        std::sort(triangles.begin(), triangles.end());
+        return triangles;
+    }
+
+    // Triangles by position, so that meshes with renumbered vertices compare equal
+    std::vector<std::array<float, 9>> SortedPositions(const MeshData& mesh)
+    {
+        std::vector<std::array<float, 9>> triangles(mesh.Indices.size() / 3);
+        for (size_t t = 0; t < triangles.size(); ++t)
+        {
+            for (int k = 0; k < 3; ++k)
+            {
+                const Float3& p = mesh.Vertices[mesh.Indices[t * 3 + k]].Position;
+                triangles[t][k * 3] = p.x;
+                triangles[t][k * 3 + 1] = p.y;
+                triangles[t][k * 3 + 2] = p.z;
+            }
+        }
+        std::sort(triangles.begin(), triangles.end());
+        return triangles;
+    }
+
+    float Acmr(const std::vector<uint32_t>& indices, uint32_t vertexCount, uint32_t cacheSize = 16)
+    {
+        return AnalyzeVertexCache(indices.data(), indices.size(), vertexCount, cacheSize, VertexCacheModel::Fifo).Acmr;
+    }
+
+    void CheckCacheModels()
+    {
+        // Cache of 3: FIFO evicts 0 when 3 comes in although 0 was just used, LRU evicts 1
+        const uint32_t sequence[] = { 0, 1, 2, 0, 3, 0 };
+        VertexCacheStats fifo = AnalyzeVertexCache(sequence, 6, 4, 3, VertexCacheModel::Fifo);
+        VertexCacheStats lru = AnalyzeVertexCache(sequence, 6, 4, 3, VertexCacheModel::Lru);
+        Check(fifo.VertexTransforms == 5 && fifo.Acmr == 2.5f && fifo.Atvr == 1.25f, "cache models: FIFO");
+        Check(lru.VertexTransforms == 4 && lru.Acmr == 2.0f && lru.Atvr == 1.0f, "cache models: LRU");
+
+        const uint32_t quad[] = { 0, 1, 2, 2, 1, 3 };
+        VertexCacheStats shared = AnalyzeVertexCache(quad, 6, 4, 16, VertexCacheModel::Fifo);
+        Check(shared.VertexTransforms == 4 && shared.Acmr == 2.0f && shared.Atvr == 1.0f, "cache models: shared edge");
+        VertexCacheStats empty = AnalyzeVertexCache(quad, 0, 4, 16, VertexCacheModel::Lru);
+        Check(empty.VertexTransforms == 0 && empty.Acmr == 0.0f, "cache models: no triangles");
+
+        // The cube's 8 vertices fit any cache, so its authored order is already optimal
+        std::vector<uint32_t> cube(CubeIndices, CubeIndices + CubeIndexCount);
+        Check(std::fabs(Acmr(cube, CubeVertexCount) - 8.0f / 12.0f) < 1e-6f, "cache models: cube ACMR");
+    }
+
+    void CheckPermutations()
+    {
+        MeshData mesh;
+        AppendGrid(&mesh, 60, 40, 0.0f);
+        ShuffleTriangles(&mesh.Indices, 1);
+        uint32_t vertexCount = static_cast<uint32_t>(mesh.Vertices.size());
+        auto reference = SortedTriangles(mesh.Indices);
+
+        std::vector<uint32_t> forsyth(mesh.Indices.size()), tipsify(mesh.Indices.size()), overdraw(mesh.Indices.size());
+        OptimizeVertexCache(forsyth.data(), mesh.Indices.data(), mesh.Indices.size(), vertexCount);
+        OptimizeVertexCacheTipsify(tipsify.data(), mesh.Indices.data(), mesh.Indices.size(), vertexCount);
+        OptimizeOverdraw(overdraw.data(), forsyth.data(), forsyth.size(), mesh.Vertices.data(), vertexCount);
+        Check(SortedTriangles(forsyth) == reference, "permutations: Forsyth keeps the triangles");
+        Check(SortedTriangles(tipsify) == reference, "permutations: Tipsify keeps the triangles");
+        Check(SortedTriangles(overdraw) == reference, "permutations: overdraw keeps the triangles");
+
+        std::vector<uint32_t> inPlace = mesh.Indices;
+        OptimizeVertexCache(inPlace.data(), inPlace.data(), inPlace.size(), vertexCount);
+        Check(inPlace == forsyth, "permutations: Forsyth in place");
+        inPlace = mesh.Indices;
+        OptimizeVertexCacheTipsify(inPlace.data(), inPlace.data(), inPlace.size(), vertexCount);
+        Check(inPlace == tipsify, "permutations: Tipsify in place");
+        inPlace = forsyth;
+        OptimizeOverdraw(inPlace.data(), inPlace.data(), inPlace.size(), mesh.Vertices.data(), vertexCount);
+        Check(inPlace == overdraw, "permutations: overdraw in place");
+
+        // Degenerate and repeated triangles, a lone triangle and no triangles at all
+        std::vector<uint32_t> odd = { 0, 0, 1, 2, 3, 4, 2, 3, 4, 4, 4, 4, 5, 6, 7 };
+        std::vector<uint32_t> output(odd.size());
+        OptimizeVertexCache(output.data(), odd.data(), odd.size(), 8);
+        Check(SortedTriangles(output) == SortedTriangles(odd), "permutations: Forsyth with degenerate triangles");
+        OptimizeVertexCacheTipsify(output.data(), odd.data(), odd.size(), 8);
+        Check(SortedTriangles(output) == SortedTriangles(odd), "permutations: Tipsify with degenerate triangles");
+        OptimizeVertexCache(output.data(), odd.data(), 0, 8);
+        OptimizeVertexCacheTipsify(output.data(), odd.data(), 0, 8);
+        OptimizeOverdraw(output.data(), odd.data(), 0, mesh.Vertices.data(), 8);
+    }
+
+    void CheckCacheQuality(uint32_t cacheSize)
+    {
+        MeshData mesh;
+        AppendGrid(&mesh, 200, 200, 0.0f);
+        ShuffleTriangles(&mesh.Indices, 2);
+        uint32_t vertexCount = static_cast<uint32_t>(mesh.Vertices.size());
+
+        std::vector<uint32_t> forsyth(mesh.Indices.size()), tipsify(mesh.Indices.size());
+        OptimizeVertexCache(forsyth.data(), mesh.Indices.data(), mesh.Indices.size(), vertexCount, cacheSize);
+        OptimizeVertexCacheTipsify(tipsify.data(), mesh.Indices.data(), mesh.Indices.size(), vertexCount, cacheSize);
+
+        // A regular grid needs at least 0.5 transforms per triangle; a shuffled one is near 3
+        Check(Acmr(mesh.Indices, vertexCount, cacheSize) > 2.5f, "cache quality: shuffled input");
+        Check(Acmr(forsyth, vertexCount, cacheSize) < 0.75f, "cache quality: Forsyth");
+        Check(Acmr(tipsify, vertexCount, cacheSize) < 0.8f, "cache quality: Tipsify");
+        Check(AnalyzeVertexCache(forsyth.data(), forsyth.size(), vertexCount, cacheSize, VertexCacheModel::Lru).Acmr <
+            0.75f, "cache quality: Forsyth under LRU");
+    }
+
+    void CheckOverdraw()
+    {
+        // Eight stacked layers facing -z, drawn from the back: every pixel of the -z view is
+        // shaded eight times, and the other views see only edges and back faces
+        MeshData mesh;
+        for (int layer = 7; layer >= 0; --layer)
+            AppendGrid(&mesh, 12, 12, float(layer));
+        uint32_t vertexCount = static_cast<uint32_t>(mesh.Vertices.size());
+        OverdrawStats before = AnalyzeOverdraw(mesh.Indices.data(), mesh.Indices.size(), mesh.Vertices.data(),
+            vertexCount);
+        Check(std::fabs(before.Overdraw - 8.0f) < 0.01f, "overdraw: back to front");
+
+        std::vector<uint32_t> sorted(mesh.Indices.size());
+        OptimizeOverdraw(sorted.data(), mesh.Indices.data(), mesh.Indices.size(), mesh.Vertices.data(), vertexCount);
+        OverdrawStats after = AnalyzeOverdraw(sorted.data(), sorted.size(), mesh.Vertices.data(), vertexCount);
+        Check(after.PixelsCovered == before.PixelsCovered && std::fabs(after.Overdraw - 1.0f) < 0.01f,
+            "overdraw: front to back after sorting");
+        Check(Acmr(sorted, vertexCount) <= Acmr(mesh.Indices, vertexCount) * 1.05f, "overdraw: ACMR kept");
+
+        // Shared edges are rasterized once: a single layer has no overdraw at all
+        MeshData single;
+        AppendGrid(&single, 37, 23, 0.0f);
+        OverdrawStats flat = AnalyzeOverdraw(single.Indices.data(), single.Indices.size(), single.Vertices.data(),
+            static_cast<uint32_t>(single.Vertices.size()));
+        Check(flat.PixelsCovered > 0 && flat.PixelsShaded == flat.PixelsCovered, "overdraw: no double-shaded edges");
+    }
+
+    void CheckVertexFetch()
+    {
+        // Vertices in reverse order plus one nobody references
+        MeshData mesh;
+        AppendGrid(&mesh, 20, 20, 0.0f);
+        uint32_t last = static_cast<uint32_t>(mesh.Vertices.size()) - 1;
+        std::reverse(mesh.Vertices.begin(), mesh.Vertices.end());
+        for (uint32_t& index : mesh.Indices)
+            index = last - index;
+        mesh.Vertices.push_back({ { 100.0f, 100.0f, 100.0f }, { 0.0f, 0.0f, 0.0f, 1.0f } });
+        uint32_t vertexCount = static_cast<uint32_t>(mesh.Vertices.size());
+        auto reference = SortedPositions(mesh);
+
+        VertexFetchStats before = AnalyzeVertexFetch(mesh.Indices.data(), mesh.Indices.size(), vertexCount,
+            sizeof(Vertex));
+        MeshData optimized = mesh;
+        uint32_t count = OptimizeVertexFetch(optimized.Vertices.data(), optimized.Indices.data(),
+            optimized.Indices.size(), mesh.Vertices.data(), vertexCount);
+        optimized.Vertices.resize(count);
+        Check(count == vertexCount - 1, "vertex fetch: unreferenced vertex dropped");
+        Check(SortedPositions(optimized) == reference, "vertex fetch: same triangles");
+
+        uint32_t next = 0;
+        bool firstUse = true;
+        for (uint32_t index : optimized.Indices)
+        {
+            firstUse = firstUse && index <= next;
+            next = std::max(next, index + 1);
+        }
+        Check(firstUse, "vertex fetch: vertices in first-use order");
+        VertexFetchStats after = AnalyzeVertexFetch(optimized.Indices.data(), optimized.Indices.size(), count,
+            sizeof(Vertex));
+        Check(after.BytesFetched <= before.BytesFetched && after.Overfetch < 1.2f, "vertex fetch: overfetch");
+
+        // The whole pipeline on a shuffled sphere keeps the geometry and beats the input
+        MeshData spheres = MakeSpheres(2, 30, 40);
+        ShuffleTriangles(&spheres.Indices, 3);
+        auto sphereReference = SortedPositions(spheres);
+        float acmrBefore = Acmr(spheres.Indices, static_cast<uint32_t>(spheres.Vertices.size()));
+        for (VertexCacheAlgorithm algorithm : { VertexCacheAlgorithm::Forsyth, VertexCacheAlgorithm::Tipsify })
+        {
+            MeshData copy = spheres;
+            MeshOptimizeOptions options;
+            options.CacheAlgorithm = algorithm;
+            OptimizeMesh(&copy, options);
+            Check(SortedPositions(copy) == sphereReference, "optimize mesh: same triangles");
+            Check(Acmr(copy.Indices, static_cast<uint32_t>(copy.Vertices.size())) < acmrBefore * 0.4f,
+                "optimize mesh: ACMR");
+        }
+    }
+
+    void PrintRow(const char* name, double ms, const std::vector<uint32_t>& indices, const MeshData& mesh,
+        uint32_t cacheSize)
+    {
+        uint32_t vertexCount = static_cast<uint32_t>(mesh.Vertices.size());
+        VertexCacheStats fifo = AnalyzeVertexCache(indices.data(), indices.size(), vertexCount, cacheSize,
+            VertexCacheModel::Fifo);
+        VertexCacheStats lru = AnalyzeVertexCache(indices.data(), indices.size(), vertexCount, cacheSize,
+            VertexCacheModel::Lru);
+        OverdrawStats overdraw = AnalyzeOverdraw(indices.data(), indices.size(), mesh.Vertices.data(), vertexCount);
+        VertexFetchStats fetch = AnalyzeVertexFetch(indices.data(), indices.size(), vertexCount, sizeof(Vertex));
+        double triangles = indices.size() / 3.0;
+        if (ms > 0.0)
+            std::printf("  %-26s %9.1f %9.2f", name, ms, triangles / (ms * 1000.0));
+        else
+            std::printf("  %-26s %9s %9s", name, "-", "-");
+        std::printf(" %10.3f %10.3f %8.3f %9.3f %9.3f\n", fifo.Acmr, lru.Acmr, fifo.Atvr, overdraw.Overdraw,
+            fetch.Overfetch);
+    }
+
+    void Benchmark(const char* title, const MeshData& input, uint32_t cacheSize)
+    {
+        uint32_t vertexCount = static_cast<uint32_t>(input.Vertices.size());
+        size_t indexCount = input.Indices.size();
+        std::printf("%s: %u vertices, %zu triangles\n", title, vertexCount, indexCount / 3);
+        std::printf("  %-26s %9s %9s %10s %10s %8s %9s %9s\n", "Order", "ms", "Mtris/s", "ACMR FIFO", "ACMR LRU",
+            "ATVR", "Overdraw", "Overfetch");
+        PrintRow("input", 0.0, input.Indices, input, cacheSize);
+
+        std::vector<uint32_t> forsyth(indexCount), tipsify(indexCount), overdraw(indexCount);
+        auto start = Clock::now();
+        OptimizeVertexCache(forsyth.data(), input.Indices.data(), indexCount, vertexCount, cacheSize);
+        PrintRow("Forsyth", ElapsedMs(start), forsyth, input, cacheSize);
+
+        start = Clock::now();
+        OptimizeVertexCacheTipsify(tipsify.data(), input.Indices.data(), indexCount, vertexCount, cacheSize);
+        PrintRow("Tipsify", ElapsedMs(start), tipsify, input, cacheSize);
+
+        start = Clock::now();
+        OptimizeOverdraw(overdraw.data(), tipsify.data(), indexCount, input.Vertices.data(), vertexCount, cacheSize);
+        PrintRow("Tipsify + overdraw", ElapsedMs(start), overdraw, input, cacheSize);
+
+        MeshData fetched;
+        fetched.Indices = overdraw;
+        fetched.Vertices.resize(vertexCount);
+        start = Clock::now();
+        fetched.Vertices.resize(OptimizeVertexFetch(fetched.Vertices.data(), fetched.Indices.data(), indexCount,
+            input.Vertices.data(), vertexCount));
+        PrintRow("  + vertex fetch", ElapsedMs(start), fetched.Indices, fetched, cacheSize);
+        std::printf("\n");
+    }
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t triangles = 2000000;
+    uint32_t cacheSize = 16;
+    for (int i = 1; i < argc; ++i)
+    {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--triangles") == 0 && hasValue)
+            triangles = static_cast<uint32_t>(std::max(1000, std::atoi(argv[++i])));
+        else if (std::strcmp(argv[i], "--cache") == 0 && hasValue)
+            cacheSize = static_cast<uint32_t>(std::clamp(std::atoi(argv[++i]), 4, 64));
+        else
+        {
+            std::fprintf(stderr, "Usage: %s [--triangles N] [--cache N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    CheckCacheModels();
+    CheckPermutations();
+    CheckCacheQuality(cacheSize);
+    CheckOverdraw();
+    CheckVertexFetch();
+    if (g_Failures)
+    {
+        std::fprintf(stderr, "%d check(s) failed\n", g_Failures);
+        return 1;
+    }
+    std::printf("MeshOptimizer checks passed\n\n");
+
+    // Eight spheres with rings x 2 * rings quads each
+    constexpr uint32_t SphereCount = 8;
+    uint32_t rings = std::max(4u, static_cast<uint32_t>(std::sqrt(triangles / (SphereCount * 4.0))));
+    MeshData spheres = MakeSpheres(SphereCount, rings, rings * 2);
+    std::printf("Post-transform cache of %u entries\n\n", cacheSize);
+    Benchmark("Spheres in authoring order", spheres, cacheSize);
+    ShuffleTriangles(&spheres.Indices, 4);
+    ShuffleVertices(&spheres, 5);
+    Benchmark("Spheres with shuffled triangles and vertices", spheres, cacheSize);
+    return 0;
+}
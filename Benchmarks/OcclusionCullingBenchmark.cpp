@@ -0,0 +1,481 @@
+// Checks and timings of OcclusionBuffer, the CPU occlusion stage between
+// frustum culling and DrawIndexed. The checks compare the rasterized depth
+// with the depth of each pixel center computed in double (including a ground
+// plane clipped at the near plane), the block maxima with their pixels, the
+// parallel rasterization with the serial one, and boxes reported hidden with
+// points sampled on their faces. A street scene is then drawn on the software
+// rasterizer at the buffer's resolution, once with every object and once with
+// only the visible ones, and the two images must match. The timings rasterize
+// occluders and cull 100K objects on 1 to N threads, then draw frames of the
+// street with and without the occlusion stage.
+//
+// Build (from the repository root; -mavx2 selects the AVX2 rasterizer, otherwise scalar):
+//   g++ -std=c++20 -O2 -mavx2 -pthread -ICommon Benchmarks/OcclusionCullingBenchmark.cpp
+//       Common/OcclusionCulling.cpp Common/FrustumCulling.cpp Common/SoftwareRasterizer.cpp Common/JobSystem.cpp
+//       -o OcclusionCullingBenchmark
+//
+// Usage: OcclusionCullingBenchmark [--objects N] [--occluders N] [--threads N]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "CubeMesh.h"
+#include "FrustumCulling.h"
+#include "JobSystem.h"
+#include "OcclusionCulling.h"
+#include "SoftwareRasterizer.h"
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    int g_Failures = 0;
+
+    void Check(bool condition, const char* what)
+    {
+        if (!condition)
+        {
+            std::fprintf(stderr, "FAILED: %s\n", what);
+            ++g_Failures;
+        }
+    }
+
+    double ElapsedMs(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    constexpr float NearZ = 0.1f;
+    constexpr float FarZ = 2000.0f;
+
+    // Buildings along a grid of streets and small objects scattered between and behind
+    // them, seen from one of the streets at eye height
+    struct Street
+    {
+        BoundsArray Buildings;
+        BoundsArray Objects;
+        Float3 Eye;
+        Float4x4 ViewProjection;
+    };
+
+    Street MakeStreet(size_t objectCount, float aspect, uint32_t seed)
+    {
+        std::mt19937 random(seed);
+        std::uniform_real_distribution<float> footprint(12.0f, 18.0f);
+        std::uniform_real_distribution<float> height(20.0f, 60.0f);
+        Street street;
+        street.Buildings.Resize(13 * 25);
+        for (int block = 0; block < 13 * 25; ++block)
+        {
+            float h = height(random);
+            street.Buildings.Set(block, { (block % 13 - 6) * 40.0f, 0.5f * h, (block / 13) * 40.0f + 20.0f },
+                { footprint(random), 0.5f * h, footprint(random) });
+        }
+
+        std::uniform_real_distribution<float> x(-260.0f, 260.0f);
+        std::uniform_real_distribution<float> y(0.0f, 10.0f);
+        std::uniform_real_distribution<float> z(-10.0f, 1000.0f);
+        std::uniform_real_distribution<float> size(0.5f, 2.0f);
+        street.Objects.Resize(objectCount);
+        for (size_t i = 0; i < objectCount; ++i)
+            street.Objects.Set(i, { x(random), y(random), z(random) }, { size(random), size(random), size(random) });
+
+        street.Eye = { 20.0f, 3.0f, -30.0f };
+        street.ViewProjection = MatrixLookAtLH(street.Eye, { 20.0f, 3.0f, 100.0f }, { 0.0f, 1.0f, 0.0f }) *
+            MatrixPerspectiveFovLH(MathPiDiv2, aspect, NearZ, FarZ);
+        return street;
+    }
+
+    Float4x4 BoxWorld(const BoundsArray& bounds, uint32_t index)
+    {
+        Float3 c = bounds.GetCenter(index), e = bounds.GetExtents(index);
+        return MatrixScaling(e.x, e.y, e.z) * MatrixTranslation(c.x, c.y, c.z);
+    }
+
+    std::vector<uint32_t> Visible(FrustumCuller& culler, const Street& street, const BoundsArray& bounds)
+    {
+        culler.Cull(nullptr, ExtractFrustum(street.ViewProjection), bounds, CullShape::Box);
+        return { culler.GetVisible(), culler.GetVisible() + culler.GetVisibleCount() };
+    }
+
+    // The largest buildings on screen, rasterized as cubes
+    void DrawOccluders(OcclusionBuffer& buffer, JobSystem* jobSystem, const Street& street, size_t maxOccluders)
+    {
+        FrustumCuller culler;
+        std::vector<uint32_t> candidates = Visible(culler, street, street.Buildings);
+        std::vector<uint32_t> occluders;
+        SelectOccluders(street.Buildings, candidates.data(), candidates.size(), street.Eye, maxOccluders, &occluders);
+
+        buffer.Begin(street.ViewProjection);
+        for (uint32_t building : occluders)
+        {
+            buffer.AddOccluder(&CubeVertices[0].Position, sizeof(Vertex), CubeVertexCount, CubeIndices,
+                CubeIndexCount, BoxWorld(street.Buildings, building));
+        }
+        buffer.Rasterize(jobSystem);
+    }
+
+    // Pixel center in normalized device coordinates
+    void PixelCenter(const OcclusionBuffer& buffer, int x, int y, double* ndcX, double* ndcY)
+    {
+        *ndcX = (x + 0.5) / buffer.GetWidth() * 2.0 - 1.0;
+        *ndcY = 1.0 - (y + 0.5) / buffer.GetHeight() * 2.0;
+    }
+
+    // An NDC position in pixels, snapped to the 1/16 pixel grid the buffer rasterizes on
+    void ToPixels(const OcclusionBuffer& buffer, const Float3& p, double* x, double* y)
+    {
+        *x = std::floor((p.x + 1.0f) * 0.5f * buffer.GetWidth() * 16.0f + 0.5f) / 16.0;
+        *y = std::floor((1.0f - p.y) * 0.5f * buffer.GetHeight() * 16.0f + 0.5f) / 16.0;
+    }
+
+    void CheckTriangles(JobSystem& jobSystem)
+    {
+        // With an identity View * Projection positions are already in NDC, with w = 1
+        std::mt19937 random(3);
+        std::uniform_real_distribution<float> xy(-1.2f, 1.2f);
+        std::uniform_real_distribution<float> depth(0.05f, 0.95f);
+        std::vector<Float3> positions(3 * 200);
+        for (Float3& p : positions)
+            p = { xy(random), xy(random), depth(random) };
+        std::vector<uint32_t> indices(positions.size());
+        for (uint32_t i = 0; i < indices.size(); ++i)
+            indices[i] = i;
+
+        OcclusionBuffer buffer;
+        buffer.Begin(MatrixIdentity());
+        buffer.AddOccluder(positions.data(), sizeof(Float3), static_cast<uint32_t>(positions.size()), indices.data(),
+            static_cast<uint32_t>(indices.size()), MatrixIdentity());
+        buffer.Rasterize(&jobSystem);
+
+        // The buffer lies between the nearest triangle clearly covering the center and the
+        // nearest one that covers it allowing for rounding
+        std::vector<double> pixelX(positions.size()), pixelY(positions.size());
+        for (size_t i = 0; i < positions.size(); ++i)
+            ToPixels(buffer, positions[i], &pixelX[i], &pixelY[i]);
+        int wrong = 0;
+        for (int y = 0; y < buffer.GetHeight(); ++y)
+        {
+            for (int x = 0; x < buffer.GetWidth(); ++x)
+            {
+                double px = x + 0.5, py = y + 0.5;
+                double strict = 1.0, loose = 1.0;
+                for (size_t t = 0; t < positions.size(); t += 3)
+                {
+                    const double* vx = &pixelX[t];
+                    const double* vy = &pixelY[t];
+                    double area = (vx[1] - vx[0]) * (vy[2] - vy[0]) - (vx[2] - vx[0]) * (vy[1] - vy[0]);
+                    if (area == 0.0)
+                        continue;
+                    double b[3];
+                    for (int k = 0; k < 3; ++k)
+                    {
+                        int a = (k + 1) % 3;
+                        int c = (k + 2) % 3;
+                        b[k] = ((vx[c] - vx[a]) * (py - vy[a]) - (vy[c] - vy[a]) * (px - vx[a])) / area;
+                    }
+                    double z = b[0] * positions[t].z + b[1] * positions[t + 1].z + b[2] * positions[t + 2].z;
+                    double smallest = std::min({ b[0], b[1], b[2] });
+                    if (smallest >= 1e-4)
+                        strict = std::min(strict, z);
+                    if (smallest >= -1e-4)
+                        loose = std::min(loose, z);
+                }
+                float stored = buffer.GetDepth()[y * buffer.GetWidth() + x];
+                wrong += stored < loose - 1e-5 || stored > strict + 1e-5;
+            }
+        }
+        Check(wrong == 0, "raster: depth is the nearest triangle at each pixel center, either winding");
+
+        OcclusionBuffer serial;
+        serial.Begin(MatrixIdentity());
+        serial.AddOccluder(positions.data(), sizeof(Float3), static_cast<uint32_t>(positions.size()), indices.data(),
+            static_cast<uint32_t>(indices.size()), MatrixIdentity());
+        serial.Rasterize(nullptr);
+        Check(std::memcmp(serial.GetDepth(), buffer.GetDepth(), sizeof(float) * buffer.GetWidth() *
+            buffer.GetHeight()) == 0, "raster: parallel tiles give the serial depth");
+    }
+
+    void CheckGround()
+    {
+        // A ground quad from behind the eye to far ahead, so it crosses the near plane
+        const Float3 corners[4] = { { -1000.0f, 0.0f, -50.0f }, { -1000.0f, 0.0f, 900.0f },
+            { 1000.0f, 0.0f, 900.0f }, { 1000.0f, 0.0f, -50.0f } };
+        const uint16_t quad[6] = { 0, 1, 2, 0, 2, 3 };
+        OcclusionBuffer buffer;
+        float aspect = float(buffer.GetWidth()) / buffer.GetHeight();
+        Float4x4 viewProjection = MatrixLookAtLH({ 0.0f, 2.0f, 0.0f }, { 0.0f, 2.0f, 1.0f }, { 0.0f, 1.0f, 0.0f }) *
+            MatrixPerspectiveFovLH(MathPiDiv2, aspect, NearZ, FarZ);
+        buffer.Begin(viewProjection);
+        buffer.AddOccluder(corners, sizeof(Float3), 4, quad, 6, MatrixIdentity());
+        buffer.Rasterize(nullptr);
+
+        // Intersect the ray through each pixel center with y = 0
+        int wrong = 0, covered = 0;
+        for (int y = 0; y < buffer.GetHeight(); ++y)
+        {
+            for (int x = 0; x < buffer.GetWidth(); ++x)
+            {
+                double px, py;
+                PixelCenter(buffer, x, y, &px, &py);
+                double dirX = px * aspect, dirY = py;   // tan(fov / 2) = 1
+                float stored = buffer.GetDepth()[y * buffer.GetWidth() + x];
+                if (dirY > -0.02)
+                {
+                    wrong += dirY > 0.02 && stored != 1.0f;
+                    continue;
+                }
+                double t = 2.0 / -dirY;
+                if (std::fabs(t * dirX) > 990.0 || t > 890.0)
+                    continue;
+                double expected = FarZ / (double(FarZ) - NearZ) * (1.0 - NearZ / t);
+                wrong += std::fabs(stored - expected) > 1e-4;
+                ++covered;
+            }
+        }
+        Check(covered > buffer.GetWidth() * buffer.GetHeight() / 3 && wrong == 0,
+            "raster: a ground plane clipped at the near plane has the depth of the ray hits");
+    }
+
+    void CheckBoxes()
+    {
+        // A wall across the view at z = 10 hides what is behind it
+        const Float3 wall[4] = { { -100.0f, -100.0f, 10.0f }, { -100.0f, 100.0f, 10.0f }, { 100.0f, 100.0f, 10.0f },
+            { 100.0f, -100.0f, 10.0f } };
+        const uint16_t quad[6] = { 0, 1, 2, 0, 2, 3 };
+        OcclusionBuffer buffer;
+        buffer.Begin(MatrixLookAtLH({ 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 1.0f }, { 0.0f, 1.0f, 0.0f }) *
+            MatrixPerspectiveFovLH(MathPiDiv2, 2.0f, NearZ, FarZ));
+        buffer.AddOccluder(wall, sizeof(Float3), 4, quad, 6, MatrixIdentity());
+        buffer.Rasterize(nullptr);
+        Check(!buffer.IsVisible({ 1.0f, 0.0f, 20.0f }, { 1.0f, 1.0f, 1.0f }), "boxes: a box behind the wall is hidden");
+        Check(buffer.IsVisible({ 1.0f, 0.0f, 5.0f }, { 1.0f, 1.0f, 1.0f }), "boxes: a box before the wall is visible");
+        Check(buffer.IsVisible({ 0.0f, 0.0f, 9.5f }, { 1.0f, 1.0f, 1.0f }), "boxes: a box through the wall is visible");
+        Check(buffer.IsVisible({ 0.0f, 0.0f, 0.0f }, { 1.0f, 1.0f, 30.0f }),
+            "boxes: a box around the eye is visible");
+        Check(!buffer.IsVisible({ 0.0f, 0.0f, -20.0f }, { 1.0f, 1.0f, 1.0f }),
+            "boxes: a box behind the eye is skipped");
+
+        bool blocksMatch = true;
+        int blocksPerRow = buffer.GetWidth() / OcclusionBuffer::BlockSize;
+        for (int by = 0; by < buffer.GetHeight() / OcclusionBuffer::BlockSize; ++by)
+        {
+            for (int bx = 0; bx < blocksPerRow; ++bx)
+            {
+                float farthest = 0.0f;
+                for (int y = 0; y < OcclusionBuffer::BlockSize; ++y)
+                {
+                    for (int x = 0; x < OcclusionBuffer::BlockSize; ++x)
+                    {
+                        farthest = std::max(farthest, buffer.GetDepth()[(by * OcclusionBuffer::BlockSize + y) *
+                            buffer.GetWidth() + bx * OcclusionBuffer::BlockSize + x]);
+                    }
+                }
+                blocksMatch = blocksMatch && buffer.GetBlockMaxDepth()[by * blocksPerRow + bx] == farthest;
+            }
+        }
+        Check(blocksMatch, "boxes: block maxima are the farthest depth of their pixels");
+    }
+
+    // Boxes reported hidden must have no face point in front of the buffer
+    void CheckStreet(JobSystem& jobSystem)
+    {
+        Street street = MakeStreet(20000, 2.0f, 7);
+        OcclusionBuffer buffer, serial;
+        DrawOccluders(buffer, &jobSystem, street, 64);
+        DrawOccluders(serial, nullptr, street, 64);
+        Check(std::memcmp(serial.GetDepth(), buffer.GetDepth(), sizeof(float) * buffer.GetWidth() *
+            buffer.GetHeight()) == 0, "street: parallel rasterization gives the serial depth");
+
+        FrustumCuller culler;
+        std::vector<uint32_t> candidates = Visible(culler, street, street.Objects);
+        int hidden = 0, seen = 0;
+        for (uint32_t object : candidates)
+        {
+            if (buffer.IsVisible(street.Objects.GetCenter(object), street.Objects.GetExtents(object)))
+                continue;
+            ++hidden;
+            Float3 c = street.Objects.GetCenter(object), e = street.Objects.GetExtents(object);
+            bool pointSeen = false;
+            for (int face = 0; face < 6 && !pointSeen; ++face)
+            {
+                for (int i = 0; i <= 8 && !pointSeen; ++i)
+                {
+                    for (int j = 0; j <= 8 && !pointSeen; ++j)
+                    {
+                        float u = i / 4.0f - 1.0f, v = j / 4.0f - 1.0f, w = face % 2 ? 1.0f : -1.0f;
+                        Float3 local = face < 2 ? Float3{ w, u, v } : face < 4 ? Float3{ u, w, v } : Float3{ u, v, w };
+                        Float4 p = Vector3Transform({ c.x + local.x * e.x, c.y + local.y * e.y, c.z + local.z * e.z },
+                            street.ViewProjection);
+                        int x = static_cast<int>((p.x / p.w * 0.5f + 0.5f) * buffer.GetWidth());
+                        int y = static_cast<int>((0.5f - p.y / p.w * 0.5f) * buffer.GetHeight());
+                        if (x < 0 || y < 0 || x >= buffer.GetWidth() || y >= buffer.GetHeight())
+                            continue;
+                        pointSeen = buffer.GetDepth()[y * buffer.GetWidth() + x] >= p.z / p.w;
+                    }
+                }
+            }
+            seen += pointSeen;
+        }
+        Check(hidden > static_cast<int>(candidates.size()) / 2, "street: most objects in the frustum are hidden");
+        Check(seen == 0, "street: no hidden box has a point in front of the occluders");
+
+        std::vector<uint32_t> expected;
+        for (uint32_t object : candidates)
+        {
+            if (buffer.IsVisible(street.Objects.GetCenter(object), street.Objects.GetExtents(object)))
+                expected.push_back(object);
+        }
+        buffer.Cull(&jobSystem, street.Objects, candidates.data(), candidates.size());
+        Check(std::vector<uint32_t>(buffer.GetVisible(), buffer.GetVisible() + buffer.GetVisibleCount()) == expected,
+            "street: parallel Cull keeps the visible candidates in order");
+    }
+
+    // Draws the buildings and the listed objects as cubes; returns the image
+    std::vector<uint32_t> DrawStreet(SoftwareRasterizer& rasterizer, const Street& street,
+        const std::vector<uint32_t>& objects)
+    {
+        const float clearColor[4] = { 0.0f, 0.125f, 0.3f, 1.0f };
+        rasterizer.ClearRenderTargetView(clearColor);
+        rasterizer.ClearDepthStencilView(1.0f, 0);
+        std::vector<Float4x4> wvps;
+        wvps.reserve(street.Buildings.GetCount() + objects.size());
+        for (uint32_t building = 0; building < street.Buildings.GetCount(); ++building)
+            wvps.push_back(BoxWorld(street.Buildings, building) * street.ViewProjection);
+        for (uint32_t object : objects)
+            wvps.push_back(BoxWorld(street.Objects, object) * street.ViewProjection);
+        for (const Float4x4& wvp : wvps)
+            rasterizer.DrawIndexed(CubeVertices, CubeVertexCount, CubeIndices, CubeIndexCount, wvp);
+        rasterizer.Flush();
+        return { rasterizer.GetColorBuffer(), rasterizer.GetColorBuffer() + rasterizer.GetWidth() *
+            rasterizer.GetHeight() };
+    }
+
+    void CheckImage(JobSystem& jobSystem)
+    {
+        OcclusionBuffer buffer;
+        SoftwareRasterizer rasterizer(jobSystem);
+        rasterizer.Resize(buffer.GetWidth(), buffer.GetHeight());
+        rasterizer.RSSetViewport({ 0.0f, 0.0f, float(buffer.GetWidth()), float(buffer.GetHeight()), 0.0f, 1.0f });
+        rasterizer.RSSetState({ FillMode::Solid, CullMode::None });
+
+        Street street = MakeStreet(20000, float(buffer.GetWidth()) / buffer.GetHeight(), 11);
+        std::vector<uint32_t> all(street.Objects.GetCount());
+        for (uint32_t i = 0; i < all.size(); ++i)
+            all[i] = i;
+        std::vector<uint32_t> everything = DrawStreet(rasterizer, street, all);
+
+        DrawOccluders(buffer, &jobSystem, street, 64);
+        FrustumCuller culler;
+        std::vector<uint32_t> candidates = Visible(culler, street, street.Objects);
+        buffer.Cull(&jobSystem, street.Objects, candidates.data(), candidates.size());
+        std::vector<uint32_t> visible(buffer.GetVisible(), buffer.GetVisible() + buffer.GetVisibleCount());
+        std::vector<uint32_t> culled = DrawStreet(rasterizer, street, visible);
+
+        size_t differing = 0;
+        for (size_t i = 0; i < everything.size(); ++i)
+            differing += everything[i] != culled[i];
+        Check(visible.size() < candidates.size() / 2, "image: the occlusion stage skips most draws");
+        Check(differing == 0, "image: skipping hidden objects leaves the image unchanged");
+    }
+}
+
+int main(int argc, char** argv)
+{
+    size_t objectCount = 100000;
+    size_t maxOccluders = 64;
+    unsigned int maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--objects") == 0 && i + 1 < argc)
+            objectCount = static_cast<size_t>(std::max(1000, std::atoi(argv[++i])));
+        else if (std::strcmp(argv[i], "--occluders") == 0 && i + 1 < argc)
+            maxOccluders = static_cast<size_t>(std::max(1, std::atoi(argv[++i])));
+        else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+            maxThreads = static_cast<unsigned int>(std::max(1, std::atoi(argv[++i])));
+    }
+
+    {
+        JobSystem jobSystem(4);
+        CheckTriangles(jobSystem);
+        CheckGround();
+        CheckBoxes();
+        CheckStreet(jobSystem);
+        CheckImage(jobSystem);
+    }
+    if (g_Failures > 0)
+    {
+        std::fprintf(stderr, "%d check(s) failed\n", g_Failures);
+        return 1;
+    }
+    std::printf("OcclusionCulling checks passed (%s)\n\n", GetOcclusionCullingInstructionSet());
+
+    OcclusionBuffer buffer;
+    Street street = MakeStreet(objectCount, 16.0f / 9.0f, 1);
+    FrustumCuller culler;
+    std::vector<uint32_t> candidates = Visible(culler, street, street.Objects);
+    std::printf("%zu objects, %zu in the frustum, %dx%d buffer\n", objectCount, candidates.size(),
+        buffer.GetWidth(), buffer.GetHeight());
+    std::printf("%-10s %10s %14s %12s %14s %10s\n", "Threads", "occluders", "rasterize ms", "triangles",
+        "cull ns/object", "visible");
+    for (unsigned int threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        JobSystem jobSystem(threads);
+        for (size_t occluders : { maxOccluders / 4, maxOccluders, maxOccluders * 4 })
+        {
+            const int frames = 50;
+            uint64_t triangles = buffer.GetTrianglesRasterized();
+            Clock::time_point start = Clock::now();
+            for (int frame = 0; frame < frames; ++frame)
+                DrawOccluders(buffer, &jobSystem, street, std::max<size_t>(1, occluders));
+            double rasterMs = ElapsedMs(start) / frames;
+            triangles = (buffer.GetTrianglesRasterized() - triangles) / frames;
+
+            start = Clock::now();
+            for (int frame = 0; frame < frames; ++frame)
+                buffer.Cull(&jobSystem, street.Objects, candidates.data(), candidates.size());
+            double cullNs = ElapsedMs(start) * 1e6 / frames / std::max<size_t>(1, candidates.size());
+            std::printf("%-10u %10zu %14.3f %12llu %14.1f %10zu\n", threads, std::max<size_t>(1, occluders),
+                rasterMs, static_cast<unsigned long long>(triangles), cullNs, buffer.GetVisibleCount());
+        }
+    }
+
+    // Whole frames on the software rasterizer: every object in the frustum, or only the visible ones
+    {
+        JobSystem jobSystem(maxThreads);
+        SoftwareRasterizer rasterizer(jobSystem);
+        rasterizer.Resize(640, 360);
+        rasterizer.RSSetViewport({ 0.0f, 0.0f, 640.0f, 360.0f, 0.0f, 1.0f });
+        rasterizer.RSSetState({ FillMode::Solid, CullMode::None });
+        std::printf("\n640x360 frames, %u threads %18s %10s\n", maxThreads, "ms/frame", "draws");
+        for (bool occlusion : { false, true })
+        {
+            const int frames = 5;
+            size_t draws = 0;
+            Clock::time_point start = Clock::now();
+            for (int frame = 0; frame < frames; ++frame)
+            {
+                std::vector<uint32_t> objects = Visible(culler, street, street.Objects);
+                if (occlusion)
+                {
+                    DrawOccluders(buffer, &jobSystem, street, maxOccluders);
+                    buffer.Cull(&jobSystem, street.Objects, objects.data(), objects.size());
+                    objects.assign(buffer.GetVisible(), buffer.GetVisible() + buffer.GetVisibleCount());
+                }
+                DrawStreet(rasterizer, street, objects);
+                draws = street.Buildings.GetCount() + objects.size();
+            }
+            std::printf("%-30s %18.2f %10zu\n", occlusion ? "frustum + occlusion" : "frustum only",
+                ElapsedMs(start) / frames, draws);
+        }
+    }
+    return 0;
+}
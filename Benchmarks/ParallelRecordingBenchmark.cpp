@@ -0,0 +1,488 @@
+// Stress test and timings of ParallelRecorder and CommandBufferContext, the portable
+// stand-ins for D3D11 deferred contexts. The checks replay command buffers against a
+// context that logs every call, record the per-object cube grid with many chunk and
+// thread counts and compare the merged draw stream with single-threaded recording,
+// and compare images on the software backend. The benchmark records the grid on the
+// null backend with 1..N threads.
+//
+// Build (from the repository root):
+//   g++ -std=c++20 -O2 -pthread -ICommon Benchmarks/ParallelRecordingBenchmark.cpp Common/ParallelRecorder.cpp
+//       Common/CommandBuffer.cpp Common/InstancedCubesScene.cpp Common/InstanceData.cpp Common/TransformBatch.cpp
+//       Common/JobSystem.cpp Common/SoftwareRasterizer.cpp Common/CpuRenderDevice.cpp Common/NullRenderDevice.cpp
+//       Common/SoftwareRenderDevice.cpp Common/ConstantBufferRing.cpp Common/PackedVertex.cpp
+//       -o ParallelRecordingBenchmark
+//
+// Usage: ParallelRecordingBenchmark [--threads N] [--cubes N]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "CommandBuffer.h"
+#include "Hash.h"
+#include "InstancedCubesScene.h"
+#include "JobSystem.h"
+#include "NullRenderDevice.h"
+#include "ParallelRecorder.h"
+#include "SoftwareRenderDevice.h"
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    int g_Failures = 0;
+
+    void Check(bool condition, const char* what)
+    {
+        if (!condition)
+        {
+            std::fprintf(stderr, "FAILED: %s\n", what);
+            ++g_Failures;
+        }
+    }
+
+    double ElapsedMs(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    // Logs every call, and every draw together with the state and constants bound at that moment.
+    // Executes command buffers like an immediate context: from the default state, leaving it behind.
+    class LoggingContext final : public RenderContext
+    {
+    public:
+        void ClearRenderTarget(const float color[4]) override
+        {
+            Log("ClearRenderTarget %g %g %g %g", color[0], color[1], color[2], color[3]);
+        }
+        void ClearDepthStencil(float depth, uint8_t stencil) override { Log("ClearDepthStencil %g %u", depth, stencil); }
+        void SetViewport(const Viewport& viewport) override
+        {
+            m_State.Viewport = HashValue(viewport);
+            Log("SetViewport %g %g %g %g", viewport.TopLeftX, viewport.TopLeftY, viewport.Width, viewport.Height);
+        }
+        void SetRasterizerState(RasterizerStateHandle state) override
+        {
+            m_State.Rasterizer = state.Id;
+            Log("SetRasterizerState %u", state.Id);
+        }
+        void SetVertexShader(VertexShaderHandle shader) override
+        {
+            m_State.VertexShader = shader.Id;
+            Log("SetVertexShader %u", shader.Id);
+        }
+        void SetPixelShader(PixelShaderHandle shader) override
+        {
+            m_State.PixelShader = shader.Id;
+            Log("SetPixelShader %u", shader.Id);
+        }
+        void SetVertexBuffer(uint32_t slot, BufferHandle buffer, uint32_t stride, uint32_t offset) override
+        {
+            if (slot == 0)
+                m_State.VertexBuffer = buffer.Id;
+            Log("SetVertexBuffer %u %u %u %u", slot, buffer.Id, stride, offset);
+        }
+        void SetIndexBuffer(BufferHandle buffer, Format format, uint32_t offset) override
+        {
+            m_State.IndexBuffer = buffer.Id;
+            Log("SetIndexBuffer %u %u %u", buffer.Id, static_cast<uint32_t>(format), offset);
+        }
+        void SetVSConstantBuffer(uint32_t slot, BufferHandle buffer) override { Log("SetVSConstantBuffer %u %u", slot, buffer.Id); }
+        void SetPSConstantBuffer(uint32_t slot, BufferHandle buffer) override { Log("SetPSConstantBuffer %u %u", slot, buffer.Id); }
+        void UpdateBuffer(BufferHandle buffer, const void* data, uint32_t size) override
+        {
+            Log("UpdateBuffer %u %u %016llx", buffer.Id, size, static_cast<unsigned long long>(HashBytes(data, size)));
+        }
+        void UpdateBufferRange(BufferHandle buffer, uint32_t offset, const void* data, uint32_t size) override
+        {
+            Log("UpdateBufferRange %u %u %u %016llx", buffer.Id, offset, size,
+                static_cast<unsigned long long>(HashBytes(data, size)));
+        }
+        ConstantBufferRange AllocateConstants(const void* data, uint32_t size) override
+        {
+            if (size == 0 || size > MaxConstantBufferSize)
+                return {};
+
+            m_Constants.push_back(HashBytes(data, size));
+            ConstantBufferRange range;
+            range.Buffer.Id = 1;
+            range.Offset = static_cast<uint32_t>(m_Constants.size() - 1) * 256;
+            range.Size = (size + 255) & ~255u;
+            Log("AllocateConstants %u %016llx", size, static_cast<unsigned long long>(m_Constants.back()));
+            return range;
+        }
+        void SetVSConstantBufferRange(uint32_t slot, const ConstantBufferRange& range) override
+        {
+            if (slot == 0)
+                m_State.Constants = range.Buffer.Id == 1 && range.Offset / 256 < m_Constants.size() ? m_Constants[range.Offset / 256] : 0;
+            Log("SetVSConstantBufferRange %u %u", slot, range.Size);
+        }
+        void SetPSConstantBufferRange(uint32_t slot, const ConstantBufferRange& range) override
+        {
+            Log("SetPSConstantBufferRange %u %u", slot, range.Size);
+        }
+        void DrawIndexed(uint32_t indexCount, uint32_t startIndexLocation, int32_t baseVertexLocation) override
+        {
+            LogDraw(indexCount, 1, startIndexLocation, baseVertexLocation, 0);
+        }
+        void DrawIndexedInstanced(uint32_t indexCountPerInstance, uint32_t instanceCount, uint32_t startIndexLocation,
+            int32_t baseVertexLocation, uint32_t startInstanceLocation) override
+        {
+            LogDraw(indexCountPerInstance, instanceCount, startIndexLocation, baseVertexLocation, startInstanceLocation);
+        }
+
+        bool ExecuteCommandList(const CommandList& list) override
+        {
+            const CommandBuffer* commands = dynamic_cast<const CommandBuffer*>(&list);
+            if (!commands)
+                return false;
+            m_State = {};
+            commands->Replay(*this, &m_ReplayConstants);
+            m_State = {};
+            ++Executed;
+            return true;
+        }
+
+        void Clear()
+        {
+            Calls.clear();
+            Draws.clear();
+            m_Constants.clear();
+            m_State = {};
+            Executed = 0;
+        }
+
+        std::vector<std::string> Calls;
+        std::vector<std::string> Draws;
+        uint32_t Executed = 0;
+
+    private:
+        struct BoundState
+        {
+            uint64_t Viewport = 0;
+            uint32_t Rasterizer = 0;
+            uint32_t VertexShader = 0;
+            uint32_t PixelShader = 0;
+            uint32_t VertexBuffer = 0;
+            uint32_t IndexBuffer = 0;
+            uint64_t Constants = 0;
+        };
+
+        template <typename... Args>
+        void Log(const char* format, Args... args)
+        {
+            char line[256];
+            std::snprintf(line, sizeof(line), format, args...);
+            Calls.emplace_back(line);
+        }
+
+        void LogDraw(uint32_t indexCount, uint32_t instanceCount, uint32_t startIndex, int32_t baseVertex, uint32_t startInstance)
+        {
+            char line[256];
+            std::snprintf(line, sizeof(line), "%016llx %u %u %u %u %u %016llx | %u %u %u %d %u",
+                static_cast<unsigned long long>(m_State.Viewport), m_State.Rasterizer, m_State.VertexShader,
+                m_State.PixelShader, m_State.VertexBuffer, m_State.IndexBuffer,
+                static_cast<unsigned long long>(m_State.Constants), indexCount, instanceCount, startIndex, baseVertex,
+                startInstance);
+            Draws.emplace_back(line);
+            Calls.emplace_back(line);
+        }
+
+        BoundState m_State;
+        std::vector<uint64_t> m_Constants;
+        std::vector<ConstantBufferRange> m_ReplayConstants;
+    };
+
+    // Issues one of every call, with payloads of awkward sizes
+    void RecordEverything(RenderContext& context, uint32_t seed)
+    {
+        float color[4] = { 0.1f * seed, 0.2f, 0.3f, 1.0f };
+        context.ClearRenderTarget(color);
+        context.ClearDepthStencil(1.0f, static_cast<uint8_t>(seed));
+        Viewport viewport;
+        viewport.Width = 640.0f + seed;
+        viewport.Height = 480.0f;
+        context.SetViewport(viewport);
+        context.SetRasterizerState(RasterizerStateHandle{ 2 + seed });
+        context.SetVertexShader(VertexShaderHandle{ 3 });
+        context.SetPixelShader(PixelShaderHandle{ 4 });
+        context.SetVertexBuffer(0, BufferHandle{ 5 }, 28, 0);
+        context.SetVertexBuffer(1, BufferHandle{ 6 }, 80, 160);
+        context.SetIndexBuffer(BufferHandle{ 7 }, Format::R32UInt, 12);
+        context.SetVSConstantBuffer(2, BufferHandle{ 8 });
+        context.SetPSConstantBuffer(3, BufferHandle{ 9 });
+
+        std::vector<uint8_t> bytes(1001);
+        for (size_t i = 0; i < bytes.size(); ++i)
+            bytes[i] = static_cast<uint8_t>(i * 7 + seed);
+        context.UpdateBuffer(BufferHandle{ 10 }, bytes.data(), 3);
+        context.UpdateBuffer(BufferHandle{ 10 }, bytes.data(), 1001);
+        context.UpdateBufferRange(BufferHandle{ 10 }, 24 + seed, bytes.data() + 5, 77);
+
+        ConstantBufferRange first = context.AllocateConstants(bytes.data(), 64);
+        ConstantBufferRange second = context.AllocateConstants(bytes.data() + 1, 250);
+        Check(!context.AllocateConstants(bytes.data(), 0), "empty constants are refused");
+        context.SetVSConstantBufferRange(0, first);
+        context.SetPSConstantBufferRange(0, second);
+        context.DrawIndexed(36, 6, 4);
+        context.SetVSConstantBufferRange(0, second);
+        context.DrawIndexedInstanced(36, 100, 0, 0, 7);
+        // Ranges from another allocation can be bound again later in the list
+        context.SetVSConstantBufferRange(0, first);
+        context.DrawIndexed(3, 0, -1);
+    }
+
+    // A CommandList the CPU backends do not know
+    class ForeignCommandList final : public CommandList
+    {
+    };
+
+    void CheckCommandBuffer()
+    {
+        LoggingContext direct;
+        RecordEverything(direct, 1);
+
+        CommandBufferContext recorder;
+        recorder.BeginCommandList();
+        RecordEverything(recorder, 1);
+        Check(recorder.GetStats().Draws == 3 && recorder.GetStats().Instances == 102, "the deferred context counts the list");
+        Check(recorder.GetCommandBuffer().GetCommandCount() == 23, "every call is recorded");
+
+        std::unique_ptr<CommandList> list;
+        Check(recorder.FinishCommandList(list) && list, "FinishCommandList");
+        Check(recorder.GetCommandBuffer().GetCommandCount() == 0 && recorder.GetStats().Draws == 0,
+            "finishing starts an empty list");
+
+        LoggingContext replayed;
+        Check(replayed.ExecuteCommandList(*list), "ExecuteCommandList");
+        Check(replayed.Calls == direct.Calls, "replay issues the recorded calls with the recorded arguments");
+
+        // A second list recycles the first one's storage and replays independently
+        const CommandList* storage = list.get();
+        recorder.BeginCommandList();
+        RecordEverything(recorder, 2);
+        std::unique_ptr<CommandList> second;
+        Check(recorder.FinishCommandList(list) && list.get() != storage, "the finished list takes the recording buffer");
+        recorder.BeginCommandList();
+        RecordEverything(recorder, 3);
+        Check(recorder.FinishCommandList(second) && second.get() == storage, "finished lists are recycled");
+
+        direct.Clear();
+        RecordEverything(direct, 2);
+        RecordEverything(direct, 3);
+        replayed.Clear();
+        replayed.ExecuteCommandList(*list);
+        replayed.ExecuteCommandList(*second);
+        Check(replayed.Calls == direct.Calls, "lists replay in execution order");
+
+        NullRenderDevice device(64, 64);
+        Check(!device.GetImmediateContext().ExecuteCommandList(ForeignCommandList()), "foreign lists are refused");
+        Check(!recorder.ExecuteCommandList(*list), "deferred contexts do not execute lists");
+    }
+
+    void CheckChunkRanges()
+    {
+        for (uint32_t itemCount : { 0u, 1u, 5u, 64u, 1000u, 1000003u })
+        {
+            for (uint32_t chunkCount : { 1u, 2u, 3u, 7u, 64u })
+            {
+                uint32_t expectedBegin = 0;
+                bool contiguous = true;
+                for (uint32_t chunk = 0; chunk < chunkCount; ++chunk)
+                {
+                    uint32_t begin, end;
+                    ParallelRecorder::GetChunkRange(itemCount, chunkCount, chunk, &begin, &end);
+                    contiguous = contiguous && begin == expectedBegin && end >= begin && end - begin <= itemCount / chunkCount + 1;
+                    expectedBegin = end;
+                }
+                Check(contiguous && expectedBegin == itemCount, "chunks are contiguous, balanced and cover every item");
+            }
+        }
+
+        NullRenderDevice device(64, 64);
+        JobSystem jobSystem(1);
+        ParallelRecorder recorder(device, jobSystem);
+        Check(recorder.Initialize(8) && recorder.GetMaxChunks() == 8, "Initialize creates the deferred contexts");
+        recorder.SetMinChunkSize(100);
+        Check(recorder.GetChunkCount(0) == 0 && recorder.GetChunkCount(1) == 1 && recorder.GetChunkCount(250) == 3 &&
+            recorder.GetChunkCount(100000) == 8, "chunk count follows the item count up to the context count");
+    }
+
+    // Draw stream of a few frames of the per-object grid, recorded serially or with a recorder
+    std::vector<std::string> RecordFrames(uint32_t cubeCount, JobSystem* jobSystem, uint32_t chunks, uint32_t* executed)
+    {
+        NullRenderDevice device(320, 240);
+        InstancedCubesScene scene(cubeCount, false);
+        Check(scene.Initialize(device), "scene initializes");
+
+        std::unique_ptr<ParallelRecorder> recorder;
+        if (jobSystem)
+        {
+            recorder = std::make_unique<ParallelRecorder>(device, *jobSystem);
+            Check(recorder->Initialize(chunks), "recorder initializes");
+            recorder->SetMinChunkSize(1);
+            scene.SetParallelRecorder(recorder.get());
+        }
+
+        LoggingContext context;
+        for (int frame = 0; frame < 3; ++frame)
+        {
+            scene.Update(frame / 60.0f);
+            scene.Draw(context);
+        }
+        if (executed)
+            *executed = context.Executed;
+        return context.Draws;
+    }
+
+    // The merged stream must equal serial recording whatever the chunk and thread counts
+    void CheckMergeOrder(unsigned int maxThreads)
+    {
+        for (uint32_t cubeCount : { 1u, 7u, 1000u })
+        {
+            std::vector<std::string> serial = RecordFrames(cubeCount, nullptr, 0, nullptr);
+            Check(serial.size() == 3 * cubeCount, "serial recording draws every cube");
+
+            for (unsigned int threads : { 1u, 2u, 4u, 8u, maxThreads })
+            {
+                JobSystem jobSystem(threads);
+                for (uint32_t chunks : { 1u, 3u, 16u, 64u })
+                {
+                    for (int repeat = 0; repeat < 3; ++repeat)
+                    {
+                        uint32_t executed = 0;
+                        std::vector<std::string> parallel = RecordFrames(cubeCount, &jobSystem, chunks, &executed);
+                        Check(parallel == serial, "parallel recording issues the serial draw stream");
+                        Check(executed == 3 * std::min(cubeCount, chunks), "one command list per chunk");
+                    }
+                }
+            }
+        }
+    }
+
+    std::vector<uint32_t> RenderImage(JobSystem& jobSystem, uint32_t cubeCount, uint32_t chunks)
+    {
+        SoftwareRenderDevice device(jobSystem, 320, 240);
+        InstancedCubesScene scene(cubeCount, false);
+        ParallelRecorder recorder(device, jobSystem);
+        Check(scene.Initialize(device), "scene initializes");
+        if (chunks)
+        {
+            Check(recorder.Initialize(chunks), "recorder initializes");
+            recorder.SetMinChunkSize(1);
+            scene.SetParallelRecorder(&recorder);
+        }
+
+        for (int frame = 0; frame < 3; ++frame)
+        {
+            scene.Update(frame / 60.0f);
+            scene.Draw(device.GetImmediateContext());
+            device.Present();
+        }
+        const uint32_t* pixels = device.GetRasterizer().GetColorBuffer();
+        return std::vector<uint32_t>(pixels, pixels + 320 * 240);
+    }
+
+    void CheckImages(JobSystem& jobSystem)
+    {
+        std::vector<uint32_t> serial = RenderImage(jobSystem, 64, 0);
+        for (uint32_t chunks : { 1u, 5u, 64u })
+            Check(RenderImage(jobSystem, 64, chunks) == serial, "software backend renders the same image");
+    }
+}
+
+int main(int argc, char** argv)
+{
+    unsigned int maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    uint32_t maxCubes = 100000;
+    for (int i = 1; i < argc; ++i)
+    {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--threads") == 0 && hasValue)
+            maxThreads = static_cast<unsigned int>(std::max(1, std::atoi(argv[++i])));
+        else if (std::strcmp(argv[i], "--cubes") == 0 && hasValue)
+            maxCubes = static_cast<uint32_t>(std::max(1, std::atoi(argv[++i])));
+        else
+        {
+            std::fprintf(stderr, "Usage: %s [--threads N] [--cubes N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    CheckCommandBuffer();
+    CheckChunkRanges();
+    CheckMergeOrder(maxThreads);
+    {
+        JobSystem jobSystem(maxThreads);
+        CheckImages(jobSystem);
+    }
+    if (g_Failures)
+    {
+        std::fprintf(stderr, "%d check(s) failed\n", g_Failures);
+        return 1;
+    }
+    std::printf("ParallelRecorder checks passed\n\n");
+
+    // Record = transforms + recording on the workers, Execute = replay on the immediate
+    // context. With D3D11 the execute step is a driver call per list instead of a replay.
+    std::printf("%8s %8s %8s %12s %12s %12s %12s %9s\n", "cubes", "threads", "chunks", "serial ms", "record ms",
+        "execute ms", "parallel ms", "speedup");
+    for (uint32_t cubeCount : { 1000u, 10000u, 100000u })
+    {
+        if (cubeCount > maxCubes)
+            break;
+
+        const int frames = static_cast<int>(std::clamp<uint32_t>(2000000 / cubeCount, 10, 200));
+        double serialMs = 0.0;
+        {
+            NullRenderDevice device(800, 600);
+            InstancedCubesScene scene(cubeCount, false);
+            scene.Initialize(device);
+            scene.Draw(device.GetImmediateContext());
+            auto start = Clock::now();
+            for (int frame = 0; frame < frames; ++frame)
+            {
+                scene.Update(frame / 60.0f);
+                scene.Draw(device.GetImmediateContext());
+                device.Present();
+            }
+            serialMs = ElapsedMs(start) / frames;
+        }
+
+        for (unsigned int threads = 1; threads <= maxThreads; threads *= 2)
+        {
+            NullRenderDevice device(800, 600);
+            JobSystem jobSystem(threads);
+            InstancedCubesScene scene(cubeCount, false);
+            ParallelRecorder recorder(device, jobSystem);
+            // A few chunks per worker so a slow chunk does not hold up the others
+            if (!scene.Initialize(device) || !recorder.Initialize(4 * threads))
+            {
+                std::fprintf(stderr, "Initialization failed\n");
+                return 1;
+            }
+            scene.SetParallelRecorder(&recorder);
+            scene.Draw(device.GetImmediateContext());
+            recorder.ResetStats();
+
+            auto start = Clock::now();
+            for (int frame = 0; frame < frames; ++frame)
+            {
+                scene.Update(frame / 60.0f);
+                scene.Draw(device.GetImmediateContext());
+                device.Present();
+            }
+            double parallelMs = ElapsedMs(start) / frames;
+            const ParallelRecorderStats& stats = recorder.GetStats();
+            std::printf("%8u %8u %8u %12.3f %12.3f %12.3f %12.3f %8.2fx\n", cubeCount, threads,
+                recorder.GetChunkCount(cubeCount), serialMs, stats.RecordMs / stats.Frames, stats.ExecuteMs / stats.Frames,
+                parallelMs, serialMs / parallelMs);
+        }
+    }
+    return 0;
+}
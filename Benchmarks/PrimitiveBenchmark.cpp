@@ -0,0 +1,302 @@
+// Checks and throughput of the procedural primitives (Primitives.h). Every
+// shape is checked at several tessellations: indices in range, unit normals,
+// bounds within [-1, 1], no degenerate triangles, every triangle clockwise
+// seen from outside, and for the closed shapes that the welded surface is
+// watertight (each edge used once in each direction) with the Euler
+// characteristic of a sphere or a torus. The compile-time tables must equal
+// the runtime generation bit for bit, and parallel generation must equal
+// serial generation. The benchmark generates every shape at millions of
+// triangles with 1..N threads.
+//
+// Build (from the repository root):
+//   g++ -std=c++20 -O2 -pthread -ICommon Benchmarks/PrimitiveBenchmark.cpp Common/VertexWelder.cpp
+//       Common/PackedVertex.cpp Common/JobSystem.cpp -o PrimitiveBenchmark
+//
+// Usage: PrimitiveBenchmark [--triangles N] [--threads N]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "JobSystem.h"
+#include "Primitives.h"
+#include "VertexWelder.h"
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    int g_Failures = 0;
+
+    void Check(bool condition, const char* what)
+    {
+        if (!condition)
+        {
+            std::fprintf(stderr, "FAILED: %s\n", what);
+            ++g_Failures;
+        }
+    }
+
+    void Check(bool condition, const std::string& what)
+    {
+        Check(condition, what.c_str());
+    }
+
+    double ElapsedMs(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    // The low-tessellation tables are built by the compiler
+    using StaticCube = StaticPrimitive<Vertex, CubeShape{}>;
+    using StaticSphere = StaticPrimitive<Vertex, UvSphereShape{ 16, 8 }>;
+    using StaticIcosphere = StaticPrimitive<Vertex, IcosphereShape{ 4 }>;
+    using StaticCylinder = StaticPrimitive<Vertex, CylinderShape{ 16, 1, true }>;
+    using StaticTorus = StaticPrimitive<Vertex, TorusShape{ 24, 12 }>;
+    using StaticPlane = StaticPrimitive<Vertex, PlaneShape{ 8, 8 }>;
+    using StaticCapsule = StaticPrimitive<Vertex, CapsuleShape{ 16, 4 }>;
+
+    static_assert(StaticCube::Vertices.size() == 24 && StaticCube::Indices.size() == 36);
+    static_assert(StaticCube::Vertices[0].Position.x == 1.0f && StaticCube::Vertices[0].Color.x == 1.0f);
+    static_assert(StaticIcosphere::Vertices.size() == 162, "frequency 4 is two midpoint subdivisions");
+    static_assert(StaticSphere::IndexFormat == Format::R16UInt);
+    static_assert(PrimitiveMath::CirclePoint(3, 12).x == 0.0f && PrimitiveMath::CirclePoint(3, 12).y == 1.0f);
+
+    Float3 Sub(const Float3& a, const Float3& b)
+    {
+        return Vector3Subtract(a, b);
+    }
+
+    template <typename Shape, typename Table>
+    void CheckStatic(const char* name, const Shape& shape)
+    {
+        std::vector<Vertex> vertices;
+        std::vector<uint16_t> indices;
+        GeneratePrimitive(shape, nullptr, &vertices, &indices);
+        Check(vertices.size() == Table::Vertices.size() && indices.size() == Table::Indices.size() &&
+            std::memcmp(vertices.data(), Table::Vertices.data(), sizeof(Table::Vertices)) == 0 &&
+            std::equal(indices.begin(), indices.end(), Table::Indices.begin()),
+            std::string(name) + ": constexpr table equals runtime generation");
+    }
+
+    // closed: the welded surface must be watertight with Euler characteristic euler
+    template <typename Shape>
+    void CheckShape(const char* name, const Shape& shape, bool closed, int euler, JobSystem& jobSystem)
+    {
+        std::string what = std::string(name) + " (" + std::to_string(shape.GetVertexCount()) + " vertices): ";
+        std::vector<PrimitivePoint> points;
+        std::vector<uint32_t> indices;
+        GeneratePrimitive(shape, nullptr, &points, &indices);
+
+        bool inRange = true, unit = true, bounded = true, facing = true, degenerate = false;
+        for (uint32_t index : indices)
+            inRange = inRange && index < points.size();
+        for (const PrimitivePoint& point : points)
+        {
+            unit = unit && std::fabs(std::sqrt(Vector3Dot(point.Normal, point.Normal)) - 1.0f) < 1e-5f;
+            for (float value : { point.Position.x, point.Position.y, point.Position.z })
+                bounded = bounded && value >= -1.0f && value <= 1.0f;
+        }
+        Check(inRange, what + "indices in range");
+        Check(unit, what + "unit normals");
+        Check(bounded, what + "inside [-1, 1]");
+        if (!inRange)
+            return;
+        for (size_t i = 0; i < indices.size(); i += 3)
+        {
+            const PrimitivePoint& a = points[indices[i]];
+            const PrimitivePoint& b = points[indices[i + 1]];
+            const PrimitivePoint& c = points[indices[i + 2]];
+            Float3 cross = Vector3Cross(Sub(b.Position, a.Position), Sub(c.Position, a.Position));
+            Float3 normal = { a.Normal.x + b.Normal.x + c.Normal.x, a.Normal.y + b.Normal.y + c.Normal.y,
+                a.Normal.z + b.Normal.z + c.Normal.z };
+            degenerate = degenerate || Vector3Dot(cross, cross) == 0.0f;
+            facing = facing && Vector3Dot(cross, normal) > 0.0f;
+        }
+        Check(!degenerate, what + "no degenerate triangles");
+        Check(facing, what + "clockwise seen from outside");
+
+        if (closed)
+        {
+            // Weld by position only, then every directed edge must have exactly one twin
+            std::vector<Vertex> soup;
+            for (uint32_t index : indices)
+                soup.push_back({ points[index].Position, { 0.0f, 0.0f, 0.0f, 0.0f } });
+            MeshData welded;
+            WeldVertices(soup.data(), soup.size(), {}, nullptr, &welded);
+            std::vector<uint64_t> edges;
+            for (size_t i = 0; i < welded.Indices.size(); i += 3)
+            {
+                for (size_t k = 0; k < 3; ++k)
+                {
+                    uint64_t from = welded.Indices[i + k], to = welded.Indices[i + (k + 1) % 3];
+                    edges.push_back(from << 32 | to);
+                }
+            }
+            std::sort(edges.begin(), edges.end());
+            bool watertight = welded.Indices.size() == indices.size() &&
+                std::adjacent_find(edges.begin(), edges.end()) == edges.end();
+            for (size_t i = 0; watertight && i < edges.size(); ++i)
+                watertight = std::binary_search(edges.begin(), edges.end(), edges[i] << 32 | edges[i] >> 32);
+            Check(watertight, what + "watertight");
+            int characteristic = int(welded.Vertices.size()) - int(edges.size() / 2) + int(welded.GetTriangleCount());
+            Check(characteristic == euler, what + "Euler characteristic " + std::to_string(euler));
+        }
+
+        std::vector<Vertex> serialVertices, parallelVertices;
+        std::vector<uint32_t> serialIndices, parallelIndices;
+        GeneratePrimitive(shape, nullptr, &serialVertices, &serialIndices);
+        GeneratePrimitive(shape, &jobSystem, &parallelVertices, &parallelIndices);
+        Check(serialIndices == parallelIndices && std::memcmp(serialVertices.data(), parallelVertices.data(),
+            serialVertices.size() * sizeof(Vertex)) == 0, what + "parallel generation equals serial");
+    }
+
+    void CheckMath()
+    {
+        double worstCircle = 0.0, worstSqrt = 0.0;
+        for (uint32_t steps : { 3u, 7u, 12u, 360u, 1000u, 65536u })
+        {
+            for (uint32_t step = 0; step < std::min(steps, 4096u); ++step)
+            {
+                Float2 point = PrimitiveMath::CirclePoint(step, steps);
+                double angle = 2.0 * PrimitiveMath::Pi * step / steps;
+                worstCircle = std::max({ worstCircle, std::fabs(point.x - std::cos(angle)),
+                    std::fabs(point.y - std::sin(angle)) });
+            }
+        }
+        for (double value = 1e-6; value < 1e6; value *= 1.37)
+            worstSqrt = std::max(worstSqrt, std::fabs(PrimitiveMath::Sqrt(value) / std::sqrt(value) - 1.0));
+        Check(worstCircle < 1e-7, "CirclePoint within float rounding of cos and sin");
+        Check(worstSqrt < 1e-15, "Sqrt within double rounding of std::sqrt");
+
+        PrimitivePoint point = UvSphereShape{ 16, 8 }.GetVertex(20);
+        PackedLitVertex packed = PrimitiveVertexTraits<PackedLitVertex>::Make(point);
+        Float3 normal = OctahedralDecode(packed.Normal);
+        Check(std::fabs(Snorm16ToFloat(packed.Position[0]) - point.Position.x) < 1e-4f &&
+            Vector3Dot(normal, point.Normal) > 0.9999f, "PackedLitVertex: position and normal survive packing");
+    }
+
+    struct BenchmarkRow
+    {
+        const char* Name;
+        std::string Parameters;
+        uint32_t Vertices;
+        uint32_t Triangles;
+    };
+
+    // Generates shape with every thread count and prints one line per count
+    template <typename Shape>
+    void Benchmark(const char* name, const std::string& parameters, const Shape& shape,
+        const std::vector<JobSystem*>& jobSystems)
+    {
+        std::vector<Vertex> vertices(shape.GetVertexCount());
+        std::vector<uint32_t> indices(shape.GetIndexCount());
+        double singleMs = 0.0;
+        for (JobSystem* jobSystem : jobSystems)
+        {
+            double best = 1e30;
+            for (int run = 0; run < 3; ++run)
+            {
+                Clock::time_point start = Clock::now();
+                GeneratePrimitive(shape, jobSystem, vertices.data(), indices.data());
+                best = std::min(best, ElapsedMs(start));
+            }
+            if (singleMs == 0.0)
+                singleMs = best;
+            uint32_t triangles = shape.GetIndexCount() / 3;
+            std::printf("%-10s %-16s %10u %10u %8u %9.1f %9.1f %8.2fx\n", name, parameters.c_str(),
+                shape.GetVertexCount(), triangles, jobSystem->GetWorkerCount(), best, triangles / best / 1000.0,
+                singleMs / best);
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    double triangleCount = 2000000.0;
+    unsigned int maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--triangles") == 0 && i + 1 < argc)
+            triangleCount = std::max(1000.0, std::atof(argv[++i]));
+        else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+            maxThreads = static_cast<unsigned int>(std::max(1, std::atoi(argv[++i])));
+    }
+
+    {
+        JobSystem jobSystem(4);
+        CheckMath();
+        CheckStatic<CubeShape, StaticCube>("cube", CubeShape{});
+        CheckStatic<UvSphereShape, StaticSphere>("UV sphere", UvSphereShape{ 16, 8 });
+        CheckStatic<IcosphereShape, StaticIcosphere>("icosphere", IcosphereShape{ 4 });
+        CheckStatic<CylinderShape, StaticCylinder>("cylinder", CylinderShape{ 16, 1, true });
+        CheckStatic<TorusShape, StaticTorus>("torus", TorusShape{ 24, 12 });
+        CheckStatic<PlaneShape, StaticPlane>("plane", PlaneShape{ 8, 8 });
+        CheckStatic<CapsuleShape, StaticCapsule>("capsule", CapsuleShape{ 16, 4 });
+
+        for (uint32_t level : { 1u, 2u, 5u, 40u })
+        {
+            CheckShape("cube", CubeShape{ level }, true, 2, jobSystem);
+            CheckShape("UV sphere", UvSphereShape{ level + 2, level + 1 }, true, 2, jobSystem);
+            CheckShape("icosphere", IcosphereShape{ level }, true, 2, jobSystem);
+            CheckShape("cylinder", CylinderShape{ level + 2, level, true }, true, 2, jobSystem);
+            CheckShape("open cylinder", CylinderShape{ level + 2, level, false }, false, 0, jobSystem);
+            CheckShape("torus", TorusShape{ level + 2, level + 2, 0.6f, 0.4f }, true, 0, jobSystem);
+            CheckShape("plane", PlaneShape{ level, level + 1 }, false, 0, jobSystem);
+            CheckShape("capsule", CapsuleShape{ level + 2, level, 0.25f, 0.75f }, true, 2, jobSystem);
+        }
+        std::vector<PrimitivePoint> points;
+        std::vector<uint32_t> indices;
+        GeneratePrimitive(IcosphereShape{ 16 }, &jobSystem, &points, &indices);
+        bool onSphere = points.size() == 10 * 16 * 16 + 2;
+        for (const PrimitivePoint& point : points)
+            onSphere = onSphere && std::fabs(Vector3Dot(point.Position, point.Position) - 1.0f) < 1e-6f;
+        Check(onSphere, "icosphere: vertices on the unit sphere");
+    }
+    if (g_Failures > 0)
+    {
+        std::fprintf(stderr, "%d check(s) failed\n", g_Failures);
+        return 1;
+    }
+    std::printf("Primitive checks passed\n\n");
+
+    size_t tableBytes = sizeof(StaticCube::Vertices) + sizeof(StaticCube::Indices) + sizeof(StaticSphere::Vertices) +
+        sizeof(StaticSphere::Indices) + sizeof(StaticIcosphere::Vertices) + sizeof(StaticIcosphere::Indices) +
+        sizeof(StaticCylinder::Vertices) + sizeof(StaticCylinder::Indices) + sizeof(StaticTorus::Vertices) +
+        sizeof(StaticTorus::Indices) + sizeof(StaticPlane::Vertices) + sizeof(StaticPlane::Indices) +
+        sizeof(StaticCapsule::Vertices) + sizeof(StaticCapsule::Indices);
+    std::printf("Compile-time tables of the 7 low-tessellation shapes: %zu bytes, 0 ms at runtime\n\n", tableBytes);
+
+    std::vector<JobSystem*> jobSystems;
+    for (unsigned int threads = 1; threads <= maxThreads; threads = threads < maxThreads ?
+        std::min(threads * 2, maxThreads) : threads + 1)
+    {
+        jobSystems.push_back(new JobSystem(threads));
+    }
+    std::printf("%-10s %-16s %10s %10s %8s %9s %9s %9s\n", "Shape", "Tessellation", "Vertices", "Triangles",
+        "Threads", "ms", "Mtri/s", "Speedup");
+    auto side = [&](double divisor) { return std::max(2u, static_cast<uint32_t>(std::sqrt(triangleCount / divisor))); };
+    uint32_t n = side(12.0);
+    Benchmark("cube", std::to_string(n), CubeShape{ n }, jobSystems);
+    n = side(4.0);
+    Benchmark("UV sphere", std::to_string(2 * n) + "x" + std::to_string(n), UvSphereShape{ 2 * n, n }, jobSystems);
+    n = side(20.0);
+    Benchmark("icosphere", std::to_string(n), IcosphereShape{ n }, jobSystems);
+    n = side(2.0);
+    Benchmark("cylinder", std::to_string(n) + "x" + std::to_string(n), CylinderShape{ n, n, true }, jobSystems);
+    n = side(4.0);
+    Benchmark("torus", std::to_string(2 * n) + "x" + std::to_string(n), TorusShape{ 2 * n, n }, jobSystems);
+    n = side(2.0);
+    Benchmark("plane", std::to_string(n) + "x" + std::to_string(n), PlaneShape{ n, n }, jobSystems);
+    n = side(16.0);
+    Benchmark("capsule", std::to_string(4 * n) + "x" + std::to_string(n), CapsuleShape{ 4 * n, n }, jobSystems);
+    for (JobSystem* jobSystem : jobSystems)
+        delete jobSystem;
+    return 0;
+}
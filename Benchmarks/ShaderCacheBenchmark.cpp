@@ -0,0 +1,341 @@
+// Checks and cold/warm timings of ShaderCache, the persistent bytecode cache behind
+// D3D11RenderDevice::SetShaderCache. D3DCompile is not available here, so a stand-in
+// compiler resolves #include "..." lines, spends a fixed time per shader the way the
+// real compiler would and returns bytecode derived from everything that affects it.
+// The checks cover hits across a save and reload, include invalidation, every part of
+// the key and corrupt cache files; the benchmark compares starting with an empty cache
+// against starting with a saved one.
+//
+// Build (from the repository root):
+//   g++ -std=c++20 -O2 -ICommon Benchmarks/ShaderCacheBenchmark.cpp Common/ShaderCache.cpp
+//       Common/MappedFile.cpp -o ShaderCacheBenchmark
+//
+// Usage: ShaderCacheBenchmark [--shaders N] [--compile-ms N]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "Hash.h"
+#include "ShaderCache.h"
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    int g_Failures = 0;
+
+    void Check(bool condition, const char* what)
+    {
+        if (!condition)
+        {
+            std::fprintf(stderr, "FAILED: %s\n", what);
+            ++g_Failures;
+        }
+    }
+
+    double ElapsedMs(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    bool WriteTextFile(const std::filesystem::path& path, const std::string& text)
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        return static_cast<bool>(file.write(text.data(), static_cast<std::streamsize>(text.size())));
+    }
+
+    // Stands in for D3DCompile: includes resolve relative to the main file like RecordingInclude
+    class StandInCompiler final : public ShaderCompiler
+    {
+    public:
+        explicit StandInCompiler(double compileMs, std::string version = "standin_1")
+            : m_CompileMs(compileMs), m_Version(std::move(version))
+        {
+        }
+
+        std::string GetVersion() const override { return m_Version; }
+
+        bool Compile(const ShaderDesc& desc, const std::string& source, std::vector<uint8_t>* bytecode,
+            std::vector<std::string>* includes, std::string* errors) override
+        {
+            ++m_Compiles;
+            auto start = Clock::now();
+
+            size_t slash = desc.FileName.find_last_of("/\\");
+            std::string directory = slash == std::string::npos ? std::string() : desc.FileName.substr(0, slash + 1);
+            std::string preprocessed;
+            if (!Preprocess(source, directory, includes, &preprocessed, errors, 0))
+                return false;
+            if (preprocessed.find(desc.EntryPoint + "(") == std::string::npos)
+            {
+                *errors = "entry point " + desc.EntryPoint + " not found";
+                return false;
+            }
+
+            uint64_t hash = HashString(preprocessed);
+            hash = HashString(desc.EntryPoint, hash);
+            hash = HashString(desc.Profile, hash);
+            hash = HashValue(desc.CompileFlags, hash);
+            for (const ShaderDefine& define : desc.Defines)
+                hash = HashString(define.Value, HashString(define.Name, hash));
+
+            // "DXBC", then a body whose size follows the source like real bytecode does
+            bytecode->assign({ 'D', 'X', 'B', 'C' });
+            size_t size = 256 + preprocessed.size();
+            for (size_t i = bytecode->size(); i < size; ++i)
+            {
+                hash = HashMix(hash + i);
+                bytecode->push_back(static_cast<uint8_t>(hash));
+            }
+
+            while (ElapsedMs(start) < m_CompileMs)
+            {
+            }
+            return true;
+        }
+
+        uint32_t GetCompileCount() const { return m_Compiles; }
+
+    private:
+        bool Preprocess(const std::string& source, const std::string& directory, std::vector<std::string>* includes,
+            std::string* output, std::string* errors, int depth)
+        {
+            if (depth > 16)
+            {
+                *errors = "#include nested too deeply";
+                return false;
+            }
+
+            size_t lineStart = 0;
+            while (lineStart < source.size())
+            {
+                size_t lineEnd = source.find('\n', lineStart);
+                if (lineEnd == std::string::npos)
+                    lineEnd = source.size();
+                std::string line = source.substr(lineStart, lineEnd - lineStart);
+                lineStart = lineEnd + 1;
+
+                size_t open = line.find("#include \"");
+                size_t close = open == std::string::npos ? open : line.find('"', open + 10);
+                if (close == std::string::npos)
+                {
+                    *output += line;
+                    *output += '\n';
+                    continue;
+                }
+
+                std::string path = directory + line.substr(open + 10, close - open - 10);
+                std::string text;
+                if (!ReadTextFile(path, &text))
+                {
+                    *errors = "cannot open include " + path;
+                    return false;
+                }
+                includes->push_back(path);
+                if (!Preprocess(text, directory, includes, output, errors, depth + 1))
+                    return false;
+            }
+            return true;
+        }
+
+        double m_CompileMs;
+        std::string m_Version;
+        uint32_t m_Compiles = 0;
+    };
+
+    bool SameBytes(const ShaderBytecode& a, const ShaderBytecode& b)
+    {
+        return a.Size == b.Size && a.Size != 0 && std::memcmp(a.Data, b.Data, a.Size) == 0;
+    }
+
+    bool SameBytes(const std::vector<uint8_t>& a, const ShaderBytecode& b)
+    {
+        return SameBytes({ a.data(), a.size() }, b);
+    }
+
+    void RunChecks(const std::filesystem::path& directory)
+    {
+        std::string shaderPath = (directory / "Effects.fx").string();
+        std::string includePath = (directory / "Common.hlsli").string();
+        std::string cachePath = (directory / "ShaderCache.bin").string();
+        std::filesystem::remove(cachePath);
+
+        WriteTextFile(includePath, "float4 Tint;\n");
+        WriteTextFile(shaderPath, "#include \"Common.hlsli\"\nfloat4 VS(float4 p : POSITION) : SV_POSITION { return p; }\n"
+            "float4 PS() : SV_TARGET { return Tint; }\n");
+
+        StandInCompiler compiler(0.0);
+        ShaderDesc vs = { shaderPath, "VS", "vs_5_0", {} };
+        ShaderBytecode first;
+        ShaderBytecode second;
+        std::vector<uint8_t> compiled;
+
+        {
+            ShaderCache cache(cachePath);
+            Check(!cache.Load(), "a missing cache file loads as empty");
+            Check(cache.GetBytecode(vs, compiler, &first), "miss compiles");
+            Check(cache.GetBytecode(vs, compiler, &second), "second request succeeds");
+            Check(compiler.GetCompileCount() == 1, "second request is a hit");
+            Check(cache.GetStats().Hits == 1 && cache.GetStats().Misses == 1, "hit and miss are counted");
+            Check(SameBytes(first, second), "hit returns the compiled bytecode");
+            compiled.assign(first.Data, first.Data + first.Size);
+
+            Check(cache.Save(), "save succeeds");
+            Check(cache.GetBytecode(vs, compiler, &second), "request after save succeeds");
+            Check(compiler.GetCompileCount() == 1, "save keeps the entries");
+            Check(SameBytes(compiled, second), "saved bytecode matches");
+            Check(reinterpret_cast<uintptr_t>(second.Data) % ShaderCache::BlobAlignment == 0, "blobs are aligned");
+        }
+
+        // A new process: everything comes from the mapped file
+        {
+            ShaderCache cache(cachePath);
+            Check(cache.Load(), "saved cache loads");
+            Check(cache.GetEntryCount() == 1, "saved cache has one entry");
+            Check(cache.GetBytecode(vs, compiler, &second), "request from a loaded cache succeeds");
+            Check(compiler.GetCompileCount() == 1 && cache.GetStats().Hits == 1, "loaded cache hits");
+            Check(SameBytes(compiled, second), "loaded bytecode matches");
+
+            // Every part of the key selects a different entry
+            ShaderDesc variants[5] = { vs, vs, vs, vs, vs };
+            variants[0].EntryPoint = "PS";
+            variants[1].Profile = "vs_4_0";
+            variants[2].Defines = { { "USE_FOG", "1" } };
+            variants[3].Defines = { { "USE_FOG", "0" } };
+            variants[4].CompileFlags = 1;
+            for (const ShaderDesc& variant : variants)
+                Check(cache.GetBytecode(variant, compiler, &second) && !SameBytes(compiled, second), "variant compiles separately");
+            Check(cache.GetStats().Misses == 5, "entry, profile, defines and flags are part of the key");
+
+            StandInCompiler newerCompiler(0.0, "standin_2");
+            Check(cache.GetBytecode(vs, newerCompiler, &second) && newerCompiler.GetCompileCount() == 1,
+                "compiler version is part of the key");
+
+            // Editing the include invalidates the entry even though Effects.fx is unchanged
+            WriteTextFile(includePath, "float4 Tint;\nfloat4 Fog;\n");
+            uint32_t compiles = compiler.GetCompileCount();
+            Check(cache.GetBytecode(vs, compiler, &second), "request after an include edit succeeds");
+            Check(compiler.GetCompileCount() == compiles + 1 && cache.GetStats().Invalidations == 1,
+                "include edit recompiles");
+            Check(cache.GetBytecode(vs, compiler, &second) && compiler.GetCompileCount() == compiles + 1,
+                "recompiled entry hits");
+
+            ShaderDesc missing = { (directory / "Missing.fx").string(), "VS", "vs_5_0", {} };
+            Check(!cache.GetBytecode(missing, compiler, &second), "missing source fails");
+            ShaderDesc badEntry = vs;
+            badEntry.EntryPoint = "Main";
+            Check(!cache.GetBytecode(badEntry, compiler, &second) && cache.GetStats().CompileFailures == 1,
+                "compile errors are not cached");
+            Check(cache.Save(), "second save succeeds");
+            Check(cache.GetEntryCount() == 7, "saved cache keeps every variant");
+        }
+
+        // Damaged files are rejected as a whole and the cache starts over
+        std::string original;
+        ReadTextFile(cachePath, &original);
+        const size_t damage[] = { 0, 8, 16, 24, original.size() - 20 };
+        for (size_t offset : damage)
+        {
+            std::string damaged = original;
+            damaged[offset] = static_cast<char>(damaged[offset] ^ 0x5a);
+            damaged[offset + 3] = static_cast<char>(damaged[offset + 3] ^ 0x7f);
+            WriteTextFile(cachePath, damaged);
+
+            ShaderCache cache(cachePath);
+            bool loaded = cache.Load();
+            // Damage to a dependency hash only turns the entry into an invalidation
+            Check(!loaded || offset == original.size() - 20, "corrupt header or index is rejected");
+            if (!loaded)
+                Check(cache.GetEntryCount() == 0, "rejected cache is empty");
+            Check(cache.GetBytecode(vs, compiler, &second), "corrupt cache still compiles");
+        }
+        WriteTextFile(cachePath, original.substr(0, original.size() / 2));
+        {
+            ShaderCache cache(cachePath);
+            Check(!cache.Load() && cache.GetEntryCount() == 0, "truncated cache is rejected");
+        }
+        WriteTextFile(cachePath, "");
+        {
+            ShaderCache cache(cachePath);
+            Check(!cache.Load() && cache.GetEntryCount() == 0, "empty cache file is rejected");
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t shaderCount = 64;
+    double compileMs = 5.0;
+    for (int i = 1; i < argc; ++i)
+    {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--shaders") == 0 && hasValue)
+            shaderCount = static_cast<uint32_t>(std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--compile-ms") == 0 && hasValue)
+            compileMs = std::atof(argv[++i]);
+        else
+        {
+            std::fprintf(stderr, "Usage: %s [--shaders N] [--compile-ms N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "ShaderCacheBenchmark";
+    std::filesystem::create_directories(directory);
+
+    RunChecks(directory);
+    if (g_Failures)
+    {
+        std::fprintf(stderr, "%d check(s) failed\n", g_Failures);
+        return 1;
+    }
+    std::printf("ShaderCache checks passed\n\n");
+
+    // One source compiled with shaderCount different defines, like permutations of an effect
+    std::string shaderPath = (directory / "Effects.fx").string();
+    std::string cachePath = (directory / "ShaderCache.bin").string();
+    std::filesystem::remove(cachePath);
+    std::vector<ShaderDesc> shaders;
+    for (uint32_t i = 0; i < shaderCount; ++i)
+    {
+        ShaderDesc desc = { shaderPath, i % 2 ? "PS" : "VS", i % 2 ? "ps_5_0" : "vs_5_0", {} };
+        desc.Defines = { { "PERMUTATION", std::to_string(i / 2) } };
+        shaders.push_back(std::move(desc));
+    }
+
+    std::printf("%u shaders, %.1f ms per compile\n", shaderCount, compileMs);
+    std::printf("%-8s %12s %12s %10s %10s\n", "run", "total ms", "ms/shader", "compiles", "speedup");
+    double coldMs = 0.0;
+    for (int run = 0; run < 2; ++run)
+    {
+        StandInCompiler compiler(compileMs);
+        auto start = Clock::now();
+        ShaderCache cache(cachePath);
+        cache.Load();
+        uint64_t checksum = 0;
+        for (const ShaderDesc& desc : shaders)
+        {
+            ShaderBytecode bytecode;
+            if (!cache.GetBytecode(desc, compiler, &bytecode))
+                return 1;
+            checksum += bytecode.Data[bytecode.Size - 1];
+        }
+        if (!cache.Save())
+            return 1;
+        double ms = ElapsedMs(start);
+        if (run == 0)
+            coldMs = ms;
+        std::printf("%-8s %12.2f %12.3f %10u %9.1fx (checksum %llu)\n", run == 0 ? "cold" : "warm", ms, ms / shaderCount,
+            compiler.GetCompileCount(), coldMs / ms, static_cast<unsigned long long>(checksum));
+    }
+    std::printf("cache file: %llu bytes\n", static_cast<unsigned long long>(std::filesystem::file_size(cachePath)));
+
+    std::filesystem::remove_all(directory);
+    return 0;
+}
@@ -0,0 +1,138 @@
+// Headless run of the "10. Render States" DrawScene() workload on the software rasterizer.
+// Renders the solid and the wireframe cube for a number of frames at every thread
+// count from 1 to N and prints frames/sec and the per-stage timings.
+//
+// Build (from the repository root):
+//   g++ -std=c++20 -O2 -pthread -ICommon Benchmarks/SoftwareRasterizerBenchmark.cpp Common/JobSystem.cpp
+//       Common/SoftwareRasterizer.cpp Common/CommandBuffer.cpp Common/CpuRenderDevice.cpp
+//       Common/SoftwareRenderDevice.cpp Common/RenderStatesScene.cpp Common/TransformBatch.cpp
+//       Common/ConstantBufferRing.cpp Common/PackedVertex.cpp -o SoftwareRasterizerBenchmark
+//
+// Usage: SoftwareRasterizerBenchmark [--frames N] [--threads N] [--width W] [--height H] [--dump file.ppm]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+
+#include "JobSystem.h"
+#include "RenderStatesScene.h"
+#include "SoftwareRenderDevice.h"
+
+namespace
+{
+    struct Options
+    {
+        int Frames = 500;
+        unsigned int MaxThreads = 0;
+        int Width = 800;
+        int Height = 600;
+        std::string DumpPath;
+    };
+
+    bool ParseOptions(int argc, char** argv, Options& options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            bool hasValue = i + 1 < argc;
+            if (std::strcmp(argv[i], "--frames") == 0 && hasValue)
+                options.Frames = std::atoi(argv[++i]);
+            else if (std::strcmp(argv[i], "--threads") == 0 && hasValue)
+                options.MaxThreads = static_cast<unsigned int>(std::atoi(argv[++i]));
+            else if (std::strcmp(argv[i], "--width") == 0 && hasValue)
+                options.Width = std::atoi(argv[++i]);
+            else if (std::strcmp(argv[i], "--height") == 0 && hasValue)
+                options.Height = std::atoi(argv[++i]);
+            else if (std::strcmp(argv[i], "--dump") == 0 && hasValue)
+                options.DumpPath = argv[++i];
+            else
+                return false;
+        }
+        return options.Frames > 0 && options.Width > 0 && options.Height > 0;
+    }
+
+    bool WritePPM(const std::string& path, const SoftwareRasterizer& rasterizer)
+    {
+        FILE* file = std::fopen(path.c_str(), "wb");
+        if (!file)
+            return false;
+
+        std::fprintf(file, "P6\n%d %d\n255\n", rasterizer.GetWidth(), rasterizer.GetHeight());
+        const uint32_t* pixels = rasterizer.GetColorBuffer();
+        size_t count = static_cast<size_t>(rasterizer.GetWidth()) * rasterizer.GetHeight();
+        for (size_t i = 0; i < count; ++i)
+        {
+            unsigned char rgb[3] = { static_cast<unsigned char>(pixels[i]), static_cast<unsigned char>(pixels[i] >> 8),
+                static_cast<unsigned char>(pixels[i] >> 16) };
+            std::fwrite(rgb, 1, 3, file);
+        }
+        std::fclose(file);
+        return true;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!ParseOptions(argc, argv, options))
+    {
+        std::fprintf(stderr, "Usage: %s [--frames N] [--threads N] [--width W] [--height H] [--dump file.ppm]\n", argv[0]);
+        return 1;
+    }
+
+    unsigned int maxThreads = options.MaxThreads ? options.MaxThreads : std::max(1u, std::thread::hardware_concurrency());
+
+    std::printf("Render States scene, %dx%d, %d frames\n", options.Width, options.Height, options.Frames);
+    std::printf("%8s %10s %10s %12s %12s %12s %10s\n", "threads", "fps", "ms/frame", "vertex ms", "binning ms", "raster ms", "speedup");
+
+    double singleThreadMs = 0.0;
+    for (unsigned int threads = 1; threads <= maxThreads; ++threads)
+    {
+        JobSystem jobSystem(threads);
+        SoftwareRenderDevice device(jobSystem, options.Width, options.Height);
+        SoftwareRasterizer& rasterizer = device.GetRasterizer();
+        RenderStatesScene scene;
+        if (!scene.Initialize(device))
+        {
+            std::fprintf(stderr, "Scene initialization failed\n");
+            return 1;
+        }
+
+        // Same as UpdateScene() + DrawScene() with a fixed 60 Hz time step
+        auto drawFrame = [&](int frame)
+        {
+            scene.Update(frame / 60.0f);
+            scene.Draw(device.GetImmediateContext());
+            device.Present();
+        };
+
+        // Warm up buffers and bins before timing
+        for (int frame = 0; frame < 10; ++frame)
+            drawFrame(frame);
+        rasterizer.ResetStats();
+
+        auto start = std::chrono::steady_clock::now();
+        for (int frame = 0; frame < options.Frames; ++frame)
+            drawFrame(frame);
+        double totalMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        double frameMs = totalMs / options.Frames;
+        if (threads == 1)
+            singleThreadMs = frameMs;
+
+        const RasterizerStats& stats = rasterizer.GetStats();
+        std::printf("%8u %10.1f %10.3f %12.3f %12.3f %12.3f %9.2fx\n", threads, 1000.0 / frameMs, frameMs,
+            stats.VertexMs / options.Frames, stats.BinningMs / options.Frames, stats.RasterMs / options.Frames,
+            singleThreadMs / frameMs);
+
+        if (threads == maxThreads && !options.DumpPath.empty() && !WritePPM(options.DumpPath, rasterizer))
+        {
+            std::fprintf(stderr, "Failed to write %s\n", options.DumpPath.c_str());
+            return 1;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,321 @@
+// Checks and lookup throughput of StateCache, the lock-free desc -> state object
+// cache behind RenderDevice::CreateRasterizerState and D3D11StateCache. The checks
+// cover deduplication, hit/miss counts, growth, -0 and NaN fields, the '3' key of
+// the Render States tutorial and concurrent inserts; the benchmark resolves
+// sampler-like descs from 1..N threads and compares it with a mutex-protected
+// std::unordered_map.
+//
+// Build (from the repository root):
+//   g++ -std=c++20 -O2 -pthread -ICommon Benchmarks/StateCacheBenchmark.cpp Common/ConstantBufferRing.cpp
+//       Common/CommandBuffer.cpp Common/CpuRenderDevice.cpp Common/NullRenderDevice.cpp Common/RenderStatesScene.cpp
+//       Common/TransformBatch.cpp Common/PackedVertex.cpp -o StateCacheBenchmark
+//
+// Usage: StateCacheBenchmark [--threads N] [--lookups N]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "NullRenderDevice.h"
+#include "RenderStatesScene.h"
+#include "StateCache.h"
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    int g_Failures = 0;
+
+    void Check(bool condition, const char* what)
+    {
+        if (!condition)
+        {
+            std::fprintf(stderr, "FAILED: %s\n", what);
+            ++g_Failures;
+        }
+    }
+
+    double ElapsedNs(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    }
+
+    // Same fields as D3D11_SAMPLER_DESC, the widest of the four state descs
+    struct SamplerDesc
+    {
+        uint32_t Filter = 0;
+        uint32_t AddressU = 1;
+        uint32_t AddressV = 1;
+        uint32_t AddressW = 1;
+        float MipLODBias = 0.0f;
+        uint32_t MaxAnisotropy = 1;
+        uint32_t ComparisonFunc = 1;
+        float BorderColor[4] = {};
+        float MinLOD = 0.0f;
+        float MaxLOD = 1000.0f;
+    };
+
+    uint64_t HashDesc(const SamplerDesc& desc)
+    {
+        uint64_t hash = HashValue(desc.Filter);
+        hash = HashValue(desc.AddressU, hash);
+        hash = HashValue(desc.AddressV, hash);
+        hash = HashValue(desc.AddressW, hash);
+        hash = HashValue(desc.MipLODBias, hash);
+        hash = HashValue(desc.MaxAnisotropy, hash);
+        hash = HashValue(desc.ComparisonFunc, hash);
+        hash = HashValue(desc.BorderColor, hash);
+        hash = HashValue(desc.MinLOD, hash);
+        return HashValue(desc.MaxLOD, hash);
+    }
+
+    bool DescEqual(const SamplerDesc& a, const SamplerDesc& b)
+    {
+        return a.Filter == b.Filter && a.AddressU == b.AddressU && a.AddressV == b.AddressV && a.AddressW == b.AddressW &&
+            FloatKeyEqual(a.MipLODBias, b.MipLODBias) && a.MaxAnisotropy == b.MaxAnisotropy &&
+            a.ComparisonFunc == b.ComparisonFunc &&
+            std::equal(a.BorderColor, a.BorderColor + 4, b.BorderColor, FloatKeyEqual) &&
+            FloatKeyEqual(a.MinLOD, b.MinLOD) && FloatKeyEqual(a.MaxLOD, b.MaxLOD);
+    }
+
+    struct SamplerDescHasher
+    {
+        size_t operator()(const SamplerDesc& desc) const { return static_cast<size_t>(HashDesc(desc)); }
+    };
+
+    struct SamplerDescEqual
+    {
+        bool operator()(const SamplerDesc& a, const SamplerDesc& b) const { return DescEqual(a, b); }
+    };
+
+    // Distinct descs the way materials vary them: filter, addressing, anisotropy and LOD bias
+    std::vector<SamplerDesc> MakeSamplerDescs(uint32_t count)
+    {
+        std::vector<SamplerDesc> descs(count);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            descs[i].Filter = i % 5;
+            descs[i].AddressU = 1 + (i / 5) % 4;
+            descs[i].AddressV = 1 + (i / 20) % 4;
+            descs[i].MaxAnisotropy = 1 + (i / 80) % 16;
+            descs[i].MipLODBias = static_cast<float>(i / 1280) * 0.25f;
+        }
+        return descs;
+    }
+
+    using SamplerCache = StateCache<SamplerDesc, uint32_t>;
+
+    bool CreateSampler(std::atomic<uint32_t>& created, uint32_t* state)
+    {
+        *state = created.fetch_add(1) + 1;
+        return true;
+    }
+
+    void CheckDeduplication()
+    {
+        SamplerCache cache(16);
+        std::atomic<uint32_t> created{ 0 };
+        auto create = [&](const SamplerDesc&, uint32_t* state) { return CreateSampler(created, state); };
+
+        std::vector<SamplerDesc> descs = MakeSamplerDescs(1000);
+        std::vector<uint32_t> states;
+        for (const SamplerDesc& desc : descs)
+            states.push_back(*cache.GetOrCreate(desc, create));
+        for (size_t i = 0; i < descs.size(); ++i)
+        {
+            SamplerDesc copy = descs[i];
+            const uint32_t* state = cache.GetOrCreate(copy, create);
+            Check(state && *state == states[i], "equal descs share a state");
+        }
+
+        StateCacheStats stats = cache.GetStats();
+        Check(created == 1000, "each desc is created once");
+        Check(stats.Entries == 1000 && stats.Misses == 1000 && stats.Hits == 1000, "hits and misses are counted");
+        Check(stats.Resizes > 0, "the table grows past its initial capacity");
+
+        SamplerDesc unknown;
+        unknown.MaxLOD = 1.0f;
+        Check(!cache.Find(unknown) && cache.Find(descs[7]) && *cache.Find(descs[7]) == states[7], "Find");
+
+        auto fail = [](const SamplerDesc&, uint32_t*) { return false; };
+        Check(!cache.GetOrCreate(unknown, fail) && cache.GetStats().Entries == 1000, "failed creation is not cached");
+
+        cache.Clear();
+        Check(cache.GetStats().Entries == 0 && !cache.Find(descs[7]), "Clear drops every state");
+    }
+
+    // -0 and +0 are the same desc, and a desc with a NaN field finds its entry again
+    // instead of adding one per lookup
+    void CheckFloatFields()
+    {
+        SamplerCache cache(16);
+        std::atomic<uint32_t> created{ 0 };
+        auto create = [&](const SamplerDesc&, uint32_t* state) { return CreateSampler(created, state); };
+
+        SamplerDesc positive;
+        SamplerDesc negative;
+        negative.MipLODBias = -0.0f;
+        negative.BorderColor[2] = -0.0f;
+        const uint32_t* state = cache.GetOrCreate(positive, create);
+        Check(state && cache.GetOrCreate(negative, create) == state && cache.Find(negative) == state,
+            "-0 and +0 fields resolve to the same state");
+
+        SamplerDesc nan;
+        nan.MinLOD = std::numeric_limits<float>::quiet_NaN();
+        for (int lookup = 0; lookup < 100; ++lookup)
+            cache.GetOrCreate(nan, create);
+        Check(cache.Find(nan) && created == 2 && cache.GetStats().Entries == 2,
+            "a desc with a NaN field is created once");
+    }
+
+    // The '3' key of the Render States tutorial: toggling culling must not create new states
+    void CheckToggleCulling()
+    {
+        NullRenderDevice device(800, 600);
+        RenderStatesScene scene;
+        Check(scene.Initialize(device), "scene initializes");
+
+        RasterizerStateHandle first;
+        RasterizerStateHandle second;
+        RasterizerDesc desc;
+        desc.Cull = CullMode::None;
+        Check(device.CreateRasterizerState(desc, &first) && device.CreateRasterizerState(desc, &second) &&
+            first.Id == second.Id, "CreateRasterizerState returns the same handle for equal descs");
+
+        for (int press = 0; press < 100; ++press)
+            Check(scene.ToggleCulling(), "ToggleCulling succeeds");
+
+        // Solid, wireframe and the two culling variants: four states no matter how often '3' is pressed
+        RasterizerDesc found;
+        Check(device.GetRasterizerDesc(RasterizerStateHandle{ 4 }, &found) &&
+            !device.GetRasterizerDesc(RasterizerStateHandle{ 5 }, &found), "toggling culling reuses states");
+    }
+
+    // Threads race to insert overlapping descs while others look them up
+    void CheckConcurrentInserts()
+    {
+        SamplerCache cache(16);
+        std::atomic<uint32_t> created{ 0 };
+        std::vector<SamplerDesc> descs = MakeSamplerDescs(4096);
+        unsigned int threadCount = std::max(4u, std::thread::hardware_concurrency());
+
+        std::vector<std::vector<uint32_t>> results(threadCount, std::vector<uint32_t>(descs.size()));
+        std::vector<std::thread> threads;
+        for (unsigned int t = 0; t < threadCount; ++t)
+        {
+            threads.emplace_back([&, t]()
+            {
+                auto create = [&](const SamplerDesc&, uint32_t* state) { return CreateSampler(created, state); };
+                for (size_t n = 0; n < descs.size(); ++n)
+                {
+                    size_t i = (n * (2 * t + 1) + t * 977) % descs.size();
+                    results[t][i] = *cache.GetOrCreate(descs[i], create);
+                }
+            });
+        }
+        for (std::thread& thread : threads)
+            thread.join();
+
+        Check(created == descs.size(), "concurrent inserts create each desc once");
+        bool agree = true;
+        for (unsigned int t = 1; t < threadCount; ++t)
+            agree = agree && results[t] == results[0];
+        Check(agree, "all threads resolve a desc to the same state");
+        StateCacheStats stats = cache.GetStats();
+        Check(stats.Hits + stats.Misses == threadCount * descs.size(), "every lookup is counted");
+    }
+}
+
+int main(int argc, char** argv)
+{
+    unsigned int maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    uint64_t lookups = 20000000;
+    for (int i = 1; i < argc; ++i)
+    {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--threads") == 0 && hasValue)
+            maxThreads = static_cast<unsigned int>(std::max(1, std::atoi(argv[++i])));
+        else if (std::strcmp(argv[i], "--lookups") == 0 && hasValue)
+            lookups = static_cast<uint64_t>(std::atoll(argv[++i]));
+        else
+        {
+            std::fprintf(stderr, "Usage: %s [--threads N] [--lookups N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    CheckDeduplication();
+    CheckFloatFields();
+    CheckToggleCulling();
+    CheckConcurrentInserts();
+    if (g_Failures)
+    {
+        std::fprintf(stderr, "%d check(s) failed\n", g_Failures);
+        return 1;
+    }
+    std::printf("StateCache checks passed\n\n");
+
+    // Resolve descs from every thread, as workers recording draw calls would
+    std::printf("%8s %8s %22s %22s\n", "descs", "threads", "StateCache ns/lookup", "mutex+map ns/lookup");
+    for (uint32_t descCount : { 16u, 256u, 4096u })
+    {
+        std::vector<SamplerDesc> descs = MakeSamplerDescs(descCount);
+        SamplerCache cache;
+        std::unordered_map<SamplerDesc, uint32_t, SamplerDescHasher, SamplerDescEqual> map;
+        std::mutex mapMutex;
+        std::atomic<uint32_t> created{ 0 };
+        for (const SamplerDesc& desc : descs)
+        {
+            uint32_t state = *cache.GetOrCreate(desc, [&](const SamplerDesc&, uint32_t* s) { return CreateSampler(created, s); });
+            map.emplace(desc, state);
+        }
+
+        for (unsigned int threadCount = 1; threadCount <= maxThreads; threadCount *= 2)
+        {
+            double ns[2] = {};
+            for (int path = 0; path < 2; ++path)
+            {
+                std::atomic<uint64_t> checksum{ 0 };
+                uint64_t perThread = lookups / threadCount;
+                auto start = Clock::now();
+                std::vector<std::thread> threads;
+                for (unsigned int t = 0; t < threadCount; ++t)
+                {
+                    threads.emplace_back([&, t]()
+                    {
+                        uint64_t sum = 0;
+                        for (uint64_t n = 0; n < perThread; ++n)
+                        {
+                            const SamplerDesc& desc = descs[(n * 7 + t) % descCount];
+                            if (path == 0)
+                            {
+                                sum += *cache.Find(desc);
+                            }
+                            else
+                            {
+                                std::lock_guard<std::mutex> lock(mapMutex);
+                                sum += map.find(desc)->second;
+                            }
+                        }
+                        checksum += sum;
+                    });
+                }
+                for (std::thread& thread : threads)
+                    thread.join();
+                ns[path] = ElapsedNs(start) / (perThread * threadCount);
+                if (checksum == 0)
+                    return 1;
+            }
+            std::printf("%8u %8u %22.2f %22.2f\n", descCount, threadCount, ns[0], ns[1]);
+        }
+    }
+    return 0;
+}
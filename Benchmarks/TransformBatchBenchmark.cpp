@@ -0,0 +1,147 @@
+// Compares the per-object WVP path of DrawScene() (Transpose(World * View * Projection)
+// for every draw) with the batched structure-of-arrays kernel in TransformBatch, from
+// 2 to 1,000,000 objects. The batched result is checked against the per-object one.
+//
+// Build (from the repository root; -mavx2 selects the AVX2 kernel, otherwise SSE2/NEON):
+//   g++ -std=c++20 -O2 -mavx2 -pthread -ICommon Benchmarks/TransformBatchBenchmark.cpp
+//       Common/TransformBatch.cpp Common/JobSystem.cpp -o TransformBatchBenchmark
+//
+// Usage: TransformBatchBenchmark [--max N] [--threads N]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "JobSystem.h"
+#include "TransformBatch.h"
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    // Runs function until at least ~20M objects were transformed and returns ns per object
+    template <typename Function>
+    double MeasureNsPerObject(size_t count, Function&& function)
+    {
+        size_t iterations = std::max<size_t>(3, 20000000 / count);
+        function(); // warm up caches and the output pages
+
+        auto start = Clock::now();
+        for (size_t i = 0; i < iterations; ++i)
+            function();
+        double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        return ns / (static_cast<double>(iterations) * count);
+    }
+
+    // Largest error relative to the magnitude of the reference matrix
+    double MaxRelativeError(const std::vector<Float4x4>& reference, const std::vector<Float4x4>& result)
+    {
+        double maxError = 0.0;
+        for (size_t i = 0; i < reference.size(); ++i)
+        {
+            double magnitude = 1.0;
+            for (int e = 0; e < 16; ++e)
+                magnitude = std::max<double>(magnitude, std::fabs((&reference[i].m[0][0])[e]));
+            for (int e = 0; e < 16; ++e)
+            {
+                double error = std::fabs((&reference[i].m[0][0])[e] - (&result[i].m[0][0])[e]) / magnitude;
+                maxError = std::max(maxError, error);
+            }
+        }
+        return maxError;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    size_t maxCount = 1000000;
+    unsigned int threads = 0;
+    for (int i = 1; i < argc; ++i)
+    {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--max") == 0 && hasValue)
+            maxCount = static_cast<size_t>(std::atoll(argv[++i]));
+        else if (std::strcmp(argv[i], "--threads") == 0 && hasValue)
+            threads = static_cast<unsigned int>(std::atoi(argv[++i]));
+        else
+        {
+            std::fprintf(stderr, "Usage: %s [--max N] [--threads N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    JobSystem jobSystem(threads);
+    Float4x4 view = MatrixLookAtLH({ 0.0f, 3.0f, -8.0f }, { 0.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f });
+    Float4x4 projection = MatrixPerspectiveFovLH(MathPiDiv2, 800.0f / 600.0f, 0.01f, 100.0f);
+
+    std::printf("kernel: %s, %u threads for the parallel column\n", GetTransformBatchInstructionSet(), jobSystem.GetWorkerCount());
+    std::printf("%10s %14s %14s %14s %14s %9s %9s %11s\n", "objects", "per-object ns", "scalar ns", "simd ns",
+        "parallel ns", "simd x", "par x", "max rel err");
+
+    const size_t counts[] = { 2, 8, 64, 512, 4096, 32768, 262144, 1000000 };
+    for (size_t count : counts)
+    {
+        if (count > maxCount)
+            break;
+
+        // Same kind of worlds as the tutorial cubes: scale, spin and orbit
+        std::vector<Float4x4> worldsAoS(count);
+        WorldMatrixArray worlds(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            float t = static_cast<float>(i) * 0.01f;
+            float scale = 0.5f + 0.25f * std::sin(t);
+            worldsAoS[i] = MatrixScaling(scale, scale, scale) * MatrixRotationY(t * 2.0f) *
+                MatrixTranslation(4.0f * std::cos(t), 2.0f * std::sin(t), static_cast<float>(i % 64)) * MatrixRotationZ(t);
+            worlds.Set(i, worldsAoS[i]);
+        }
+
+        // Upload memory stand-in, one cbuffer float4x4 per object
+        std::vector<Float4x4> reference(count);
+        std::vector<Float4x4> output(count);
+
+        double perObjectNs = MeasureNsPerObject(count, [&]
+        {
+            for (size_t i = 0; i < count; ++i)
+                reference[i] = MatrixTranspose(worldsAoS[i] * view * projection);
+        });
+
+        double scalarNs = MeasureNsPerObject(count, [&]
+        {
+            Float4x4 viewProjection = view * projection;
+            TransformWorldViewProjectionScalar(worlds, viewProjection, 0, count, output.data(), sizeof(Float4x4));
+        });
+
+        double simdNs = MeasureNsPerObject(count, [&]
+        {
+            Float4x4 viewProjection = view * projection;
+            TransformWorldViewProjection(worlds, viewProjection, 0, count, output.data(), sizeof(Float4x4));
+        });
+        double error = MaxRelativeError(reference, output);
+
+        double parallelNs = MeasureNsPerObject(count, [&]
+        {
+            Float4x4 viewProjection = view * projection;
+            jobSystem.ParallelFor(count, 16384, [&](size_t begin, size_t end, unsigned int)
+            {
+                TransformWorldViewProjection(worlds, viewProjection, begin, end, output.data() + begin, sizeof(Float4x4));
+            });
+        });
+        error = std::max(error, MaxRelativeError(reference, output));
+
+        std::printf("%10zu %14.2f %14.2f %14.2f %14.2f %8.2fx %8.2fx %11.2e\n", count, perObjectNs, scalarNs, simdNs,
+            parallelNs, perObjectNs / simdNs, perObjectNs / parallelNs, error);
+
+        if (error > 1e-5)
+        {
+            std::fprintf(stderr, "Batched result differs from the per-object path\n");
+            return 1;
+        }
+    }
+
+    return 0;
+}
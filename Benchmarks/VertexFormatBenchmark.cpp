@@ -0,0 +1,364 @@
+// Checks and encode throughput of the compact vertex formats in PackedVertex.h.
+// The checks cover half-float rounding, SNORM16/UNORM8 quantization, octahedral
+// normal error, dequantization through the world matrix and the software backend
+// drawing the Render States scene identically from all three layouts. The
+// benchmark encodes a 1M-vertex mesh into each format and reports vertices/sec
+// and the vertex fetch bytes against the 28-byte Vertex and tutorial 05's 44 bytes.
+//
+// Build (from the repository root):
+//   g++ -std=c++20 -O2 -pthread -ICommon Benchmarks/VertexFormatBenchmark.cpp Common/PackedVertex.cpp
+//       Common/JobSystem.cpp Common/SoftwareRasterizer.cpp Common/CommandBuffer.cpp Common/CpuRenderDevice.cpp
+//       Common/SoftwareRenderDevice.cpp Common/RenderStatesScene.cpp Common/TransformBatch.cpp
+//       Common/ConstantBufferRing.cpp -o VertexFormatBenchmark
+//
+// Usage: VertexFormatBenchmark [--vertices N]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "CubeMesh.h"
+#include "JobSystem.h"
+#include "PackedVertex.h"
+#include "RenderStatesScene.h"
+#include "SoftwareRenderDevice.h"
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    // "05. Color!" adds a second float4 color, COLORTWO
+    constexpr uint32_t TwoColorVertexSize = sizeof(Vertex) + sizeof(Float4);
+
+    int g_Failures = 0;
+
+    void Check(bool condition, const char* what)
+    {
+        if (!condition)
+        {
+            std::fprintf(stderr, "FAILED: %s\n", what);
+            ++g_Failures;
+        }
+    }
+
+    double ElapsedMs(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    // Positions spread over an off-center box, colors on the 1/255 grid like most authored meshes
+    std::vector<Vertex> MakeMesh(size_t count, uint32_t seed)
+    {
+        std::mt19937 random(seed);
+        std::uniform_real_distribution<float> x(-40.0f, 60.0f), y(0.0f, 3.0f), z(995.0f, 1005.0f);
+        std::uniform_int_distribution<int> channel(0, 255);
+        std::vector<Vertex> vertices(count);
+        for (Vertex& vertex : vertices)
+        {
+            vertex.Position = { x(random), y(random), z(random) };
+            vertex.Color = { channel(random) / 255.0f, channel(random) / 255.0f, channel(random) / 255.0f, 1.0f };
+        }
+        return vertices;
+    }
+
+    // Decodes vertex i of an encoded stream and applies the dequantization, like the VS would
+    Vertex DecodeVertex(VertexFormat format, const void* encoded, size_t i, const Float4x4& dequantize)
+    {
+        uint32_t count;
+        const InputElementDesc* layout = GetVertexInputLayout(format, &count);
+        const uint8_t* vertex = static_cast<const uint8_t*>(encoded) + i * GetVertexStride(format);
+
+        float position[4], color[4];
+        ReadVertexElement(layout[0].ElementFormat, vertex + layout[0].AlignedByteOffset, position);
+        ReadVertexElement(layout[1].ElementFormat, vertex + layout[1].AlignedByteOffset, color);
+        Float4 transformed = Vector3Transform({ position[0], position[1], position[2] }, dequantize);
+        return { { transformed.x, transformed.y, transformed.z }, { color[0], color[1], color[2], color[3] } };
+    }
+
+    void CheckHalf()
+    {
+        // Every finite half survives the round trip; NaN stays NaN
+        bool roundTrip = true;
+        bool nan = true;
+        for (uint32_t bits = 0; bits < 0x10000; ++bits)
+        {
+            uint16_t half = static_cast<uint16_t>(bits);
+            float value = HalfToFloat(half);
+            if ((half & 0x7c00) == 0x7c00 && (half & 0x3ff))
+                nan = nan && std::isnan(value) && (FloatToHalf(value) & 0x7fff) > 0x7c00;
+            else
+                roundTrip = roundTrip && FloatToHalf(value) == half;
+        }
+        Check(roundTrip, "half: every non-NaN half round-trips");
+        Check(nan, "half: NaN stays NaN");
+
+        // Ties round to even, overflow goes to infinity, subnormals are kept
+        Check(FloatToHalf(1.0f + std::ldexp(1.0f, -11)) == 0x3c00, "half: tie rounds down to even");
+        Check(FloatToHalf(1.0f + 3.0f * std::ldexp(1.0f, -11)) == 0x3c02, "half: tie rounds up to even");
+        Check(FloatToHalf(1.0f + std::ldexp(1.0f, -11) + std::ldexp(1.0f, -20)) == 0x3c01, "half: above tie rounds up");
+        Check(FloatToHalf(65504.0f) == 0x7bff, "half: largest finite");
+        Check(FloatToHalf(65519.0f) == 0x7bff, "half: below the overflow threshold");
+        Check(FloatToHalf(65520.0f) == 0x7c00, "half: overflow to infinity");
+        Check(FloatToHalf(-1e10f) == 0xfc00, "half: negative overflow");
+        Check(FloatToHalf(std::ldexp(1.0f, -24)) == 0x0001, "half: smallest subnormal");
+        Check(FloatToHalf(std::ldexp(1.0f, -25)) == 0x0000, "half: half the smallest subnormal rounds to 0");
+        Check(FloatToHalf(1.5f * std::ldexp(1.0f, -24)) == 0x0002, "half: subnormal tie rounds to even");
+        Check(FloatToHalf(std::ldexp(1.0f, -14) * (1.0f - std::ldexp(1.0f, -12))) == 0x0400,
+            "half: subnormal rounds up into the normal range");
+        Check(FloatToHalf(-0.0f) == 0x8000, "half: negative zero");
+    }
+
+    void CheckNormalized()
+    {
+        float maxError = 0.0f;
+        for (int i = -100000; i <= 100000; ++i)
+        {
+            float value = i / 100000.0f;
+            maxError = std::max(maxError, std::fabs(Snorm16ToFloat(FloatToSnorm16(value)) - value));
+        }
+        Check(maxError <= 0.5f / 32767.0f + 1e-7f, "snorm16: error within half a step");
+        Check(FloatToSnorm16(1.0f) == 32767 && FloatToSnorm16(-1.0f) == -32767, "snorm16: -1 and 1 are exact");
+        Check(FloatToSnorm16(2.0f) == 32767 && FloatToSnorm16(-2.0f) == -32767, "snorm16: out of range clamps");
+        Check(Snorm16ToFloat(-32768) == -1.0f, "snorm16: -32768 decodes to -1");
+
+        bool exact = true;
+        for (int k = 0; k < 256; ++k)
+            exact = exact && FloatToUnorm8(k / 255.0f) == k;
+        Check(exact, "unorm8: k / 255 encodes to k");
+        Check(FloatToUnorm8(-1.0f) == 0 && FloatToUnorm8(2.0f) == 255, "unorm8: out of range clamps");
+    }
+
+    // Largest angle in degrees between a normal and its decoded octahedral encoding
+    double MeasureOctahedralError(size_t samples)
+    {
+        std::vector<Float3> normals = { { 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 } };
+        // Fibonacci sphere, which hits the folded lower half and the fold edges evenly
+        for (size_t i = 0; i < samples; ++i)
+        {
+            float z = 1.0f - 2.0f * (i + 0.5f) / samples;
+            float radius = std::sqrt(std::max(0.0f, 1.0f - z * z));
+            float phi = 2.399963f * i;
+            normals.push_back({ radius * std::cos(phi), radius * std::sin(phi), z });
+        }
+
+        double maxDegrees = 0.0;
+        for (const Float3& normal : normals)
+        {
+            int16_t encoded[2];
+            OctahedralEncode(normal, encoded);
+            Float3 decoded = OctahedralDecode(encoded);
+            // atan2 of |a x b| and a . b in double; acos of a float dot is too coarse near 0 degrees
+            double a[3] = { decoded.x, decoded.y, decoded.z };
+            double b[3] = { normal.x, normal.y, normal.z };
+            double cross[3] = { a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0] };
+            double sine = std::sqrt(cross[0] * cross[0] + cross[1] * cross[1] + cross[2] * cross[2]);
+            double cosine = a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+            maxDegrees = std::max(maxDegrees, std::atan2(sine, cosine) * 180.0 / 3.14159265358979);
+        }
+        return maxDegrees;
+    }
+
+    void CheckOctahedral()
+    {
+        Check(MeasureOctahedralError(100000) < 0.02, "octahedral: error below 0.02 degrees");
+
+        int16_t encoded[2];
+        OctahedralEncode({ 0.0f, 0.0f, -1.0f }, encoded);
+        Float3 down = OctahedralDecode(encoded);
+        Check(down.z == -1.0f, "octahedral: -Z decodes exactly");
+        OctahedralEncode({ 0.0f, 0.0f, 0.0f }, encoded);
+        Check(OctahedralDecode(encoded).z == 1.0f, "octahedral: zero vector encodes as +Z");
+    }
+
+    void CheckLayouts()
+    {
+        for (VertexFormat format : { VertexFormat::Float32, VertexFormat::Snorm16, VertexFormat::Half16 })
+        {
+            uint32_t count;
+            const InputElementDesc* layout = GetVertexInputLayout(format, &count);
+            const InputElementDesc& last = layout[count - 1];
+            Check(count == 2 && std::strcmp(layout[0].SemanticName, "POSITION") == 0 &&
+                std::strcmp(layout[1].SemanticName, "COLOR") == 0, "layout: POSITION + COLOR");
+            Check(last.AlignedByteOffset + GetFormatSize(last.ElementFormat) == GetVertexStride(format),
+                "layout: elements fill the stride");
+        }
+        const InputElementDesc& normal = PackedLitVertexInputLayout[1];
+        const InputElementDesc& color = PackedLitVertexInputLayout[2];
+        Check(normal.AlignedByteOffset == offsetof(PackedLitVertex, Normal) &&
+            color.AlignedByteOffset == offsetof(PackedLitVertex, Color), "layout: PackedLitVertex offsets");
+    }
+
+    void CheckQuantization()
+    {
+        // The cube spans [-1, 1]: identity dequantization and a lossless encoding
+        PositionQuantization cube = ComputePositionQuantization(CubeVertices, std::size(CubeVertices));
+        Float4x4 identity = MatrixIdentity();
+        Float4x4 cubeDequantize = cube.GetDequantizeMatrix();
+        Check(std::memcmp(&identity, &cubeDequantize, sizeof(Float4x4)) == 0, "quantization: cube bounds are [-1, 1]");
+        for (VertexFormat format : { VertexFormat::Snorm16, VertexFormat::Half16 })
+        {
+            std::vector<uint8_t> encoded(GetVertexStride(format) * std::size(CubeVertices));
+            EncodeVertices(format, CubeVertices, std::size(CubeVertices), cube, encoded.data());
+            bool exact = true;
+            for (size_t i = 0; i < std::size(CubeVertices); ++i)
+            {
+                Vertex decoded = DecodeVertex(format, encoded.data(), i, cube.GetDequantizeMatrix());
+                exact = exact && std::memcmp(&decoded, &CubeVertices[i], sizeof(Vertex)) == 0;
+            }
+            Check(exact, "quantization: cube decodes exactly");
+        }
+
+        // An off-center mesh: error bounded by half a step of the bounds, colors exact
+        std::vector<Vertex> mesh = MakeMesh(10000, 7);
+        PositionQuantization quantization = ComputePositionQuantization(mesh.data(), mesh.size());
+        Check(std::fabs(quantization.Center.z - 1000.0f) < 5.0f && quantization.Extent.y <= 1.5f,
+            "quantization: bounds center and extent");
+        for (VertexFormat format : { VertexFormat::Snorm16, VertexFormat::Half16 })
+        {
+            std::vector<uint8_t> encoded(GetVertexStride(format) * mesh.size());
+            EncodeVertices(format, mesh.data(), mesh.size(), quantization, encoded.data());
+
+            // SNORM16 steps are 1/32767 of the extent; half has 11 significant bits
+            float relativeStep = format == VertexFormat::Snorm16 ? 0.5f / 32767.0f : 1.0f / 2048.0f;
+            bool positions = true;
+            bool colors = true;
+            for (size_t i = 0; i < mesh.size(); ++i)
+            {
+                Vertex decoded = DecodeVertex(format, encoded.data(), i, quantization.GetDequantizeMatrix());
+                // Plus float rounding of the dequantize transform around the center
+                positions = positions &&
+                    std::fabs(decoded.Position.x - mesh[i].Position.x) <= quantization.Extent.x * relativeStep + 1e-4f &&
+                    std::fabs(decoded.Position.y - mesh[i].Position.y) <= quantization.Extent.y * relativeStep + 1e-4f &&
+                    std::fabs(decoded.Position.z - mesh[i].Position.z) <= quantization.Extent.z * relativeStep + 1e-4f;
+                colors = colors && FloatToUnorm8(decoded.Color.x) == FloatToUnorm8(mesh[i].Color.x) &&
+                    decoded.Color.w == 1.0f;
+            }
+            Check(positions, format == VertexFormat::Snorm16 ? "snorm16 mesh: position error bound" :
+                "half mesh: position error bound");
+            Check(colors, "mesh: colors survive RGBA8");
+        }
+
+        // A flat mesh must not produce a zero scale
+        Vertex flat[2] = { { { 0.0f, 5.0f, 0.0f }, {} }, { { 1.0f, 5.0f, 1.0f }, {} } };
+        Check(ComputePositionQuantization(flat, 2).Extent.y > 0.0f, "quantization: flat axis keeps a non-zero extent");
+    }
+
+    // Renders a few frames of the Render States scene and returns the last color buffer
+    std::vector<uint32_t> RenderScene(JobSystem& jobSystem, VertexFormat format)
+    {
+        SoftwareRenderDevice device(jobSystem, 320, 240);
+        RenderStatesScene scene;
+        scene.SetVertexFormat(format);
+        if (!scene.Initialize(device))
+            return {};
+
+        for (int frame = 0; frame < 30; frame += 7)
+        {
+            scene.Update(frame / 60.0f);
+            scene.Draw(device.GetImmediateContext());
+            device.Present();
+        }
+        const uint32_t* pixels = device.GetRasterizer().GetColorBuffer();
+        return std::vector<uint32_t>(pixels, pixels + 320 * 240);
+    }
+
+    void CheckImages(JobSystem& jobSystem)
+    {
+        std::vector<uint32_t> reference = RenderScene(jobSystem, VertexFormat::Float32);
+        Check(!reference.empty(), "software: float32 scene renders");
+        Check(RenderScene(jobSystem, VertexFormat::Snorm16) == reference, "software: snorm16 image equals float32");
+        Check(RenderScene(jobSystem, VertexFormat::Half16) == reference, "software: half image equals float32");
+    }
+
+    // Best of a few runs, in million vertices per second
+    template <typename Function>
+    double MeasureMVerticesPerSecond(size_t count, const Function& function)
+    {
+        double bestMs = 1e30;
+        for (int run = 0; run < 5; ++run)
+        {
+            auto start = Clock::now();
+            function();
+            bestMs = std::min(bestMs, ElapsedMs(start));
+        }
+        return count / (bestMs * 1000.0);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    size_t vertexCount = 1000000;
+    for (int i = 1; i < argc; ++i)
+    {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--vertices") == 0 && hasValue)
+            vertexCount = static_cast<size_t>(std::max(1, std::atoi(argv[++i])));
+        else
+        {
+            std::fprintf(stderr, "Usage: %s [--vertices N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    CheckHalf();
+    CheckNormalized();
+    CheckOctahedral();
+    CheckLayouts();
+    CheckQuantization();
+    {
+        JobSystem jobSystem(1);
+        CheckImages(jobSystem);
+    }
+    if (g_Failures)
+    {
+        std::fprintf(stderr, "%d check(s) failed\n", g_Failures);
+        return 1;
+    }
+    std::printf("Vertex format checks passed\n\n");
+
+    std::vector<Vertex> mesh = MakeMesh(vertexCount, 1);
+    std::vector<Float3> normals(vertexCount);
+    for (size_t i = 0; i < vertexCount; ++i)
+        normals[i] = Vector3Normalize({ mesh[i].Position.x - 10.0f, mesh[i].Position.y - 1.5f, mesh[i].Position.z - 1000.0f });
+
+    PositionQuantization quantization;
+    double boundsRate = MeasureMVerticesPerSecond(vertexCount, [&]
+    {
+        quantization = ComputePositionQuantization(mesh.data(), mesh.size());
+    });
+
+    std::vector<uint8_t> output(sizeof(Vertex) * vertexCount);
+    std::printf("%zu vertices, bounds pass %.1f M vertices/s, octahedral max error %.4f degrees\n", vertexCount,
+        boundsRate, MeasureOctahedralError(100000));
+    std::printf("%-18s %8s %12s %12s %12s %12s\n", "format", "bytes", "M verts/s", "GB/s out", "vs Vertex", "vs 05 Color");
+
+    auto report = [&](const char* name, uint32_t stride, double rate)
+    {
+        std::printf("%-18s %8u %12.1f %12.2f %11.2fx %11.2fx\n", name, stride, rate, rate * stride / 1000.0,
+            static_cast<double>(sizeof(Vertex)) / stride, static_cast<double>(TwoColorVertexSize) / stride);
+    };
+
+    for (VertexFormat format : { VertexFormat::Float32, VertexFormat::Snorm16, VertexFormat::Half16 })
+    {
+        double rate = MeasureMVerticesPerSecond(vertexCount, [&]
+        {
+            EncodeVertices(format, mesh.data(), mesh.size(), quantization, output.data());
+        });
+        const char* name = format == VertexFormat::Float32 ? "Vertex (copy)" :
+            (format == VertexFormat::Snorm16 ? "PackedVertex" : "HalfVertex");
+        report(name, GetVertexStride(format), rate);
+    }
+
+    double litRate = MeasureMVerticesPerSecond(vertexCount, [&]
+    {
+        EncodePackedLitVertices(mesh.data(), normals.data(), mesh.size(), quantization,
+            reinterpret_cast<PackedLitVertex*>(output.data()));
+    });
+    report("PackedLitVertex", sizeof(PackedLitVertex), litRate);
+    return 0;
+}
@@ -0,0 +1,355 @@
+// Checks and timings of DynamicVertexStream, the ring of vertex data written
+// every frame through one Dynamic buffer. The checks cover where writes land,
+// that appends keep earlier writes intact, that a wrap discards and restarts
+// at the front, the per-frame byte count, and that a CPU-animated wave grid
+// streamed over several frames renders the same images on the software
+// backend as re-creating a Default buffer every frame. The timings stream
+// writes of a given size on the null backend, where a write is a copy into the
+// buffer's memory, next to plain memcpy and to re-creating buffers, and then
+// animate and stream a field of wave grids per frame.
+//
+// Build (from the repository root):
+//   g++ -std=c++20 -O2 -pthread -ICommon Benchmarks/VertexStreamBenchmark.cpp Common/DynamicVertexStream.cpp
+//       Common/CommandBuffer.cpp Common/CpuRenderDevice.cpp Common/NullRenderDevice.cpp
+//       Common/SoftwareRenderDevice.cpp Common/SoftwareRasterizer.cpp Common/ConstantBufferRing.cpp
+//       Common/PackedVertex.cpp Common/JobSystem.cpp -o VertexStreamBenchmark
+//
+// Usage: VertexStreamBenchmark [--megabytes N] [--frames N]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <vector>
+
+#include "DynamicVertexStream.h"
+#include "JobSystem.h"
+#include "NullRenderDevice.h"
+#include "Primitives.h"
+#include "SoftwareRenderDevice.h"
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    int g_Failures = 0;
+
+    void Check(bool condition, const char* what)
+    {
+        if (!condition)
+        {
+            std::fprintf(stderr, "FAILED: %s\n", what);
+            ++g_Failures;
+        }
+    }
+
+    double ElapsedMs(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    std::vector<uint8_t> Pattern(uint32_t size, uint32_t seed)
+    {
+        std::vector<uint8_t> bytes(size);
+        for (uint32_t i = 0; i < size; ++i)
+            bytes[i] = static_cast<uint8_t>(i * 31 + seed * 7 + 1);
+        return bytes;
+    }
+
+    void CheckStream()
+    {
+        NullRenderDevice device(640, 480);
+        RenderContext& context = device.GetImmediateContext();
+        DynamicVertexStream stream;
+        Check(stream.Initialize(device, 1000), "stream: buffer created");
+        const CpuBuffer* buffer = device.GetBuffer(stream.GetBuffer());
+        Check(buffer && buffer->Desc.Usage == BufferUsage::Dynamic && buffer->Desc.Bind == BufferBind::VertexBuffer,
+            "stream: buffer is a Dynamic vertex buffer");
+
+        // Appends of mixed strides start at whole vertices and keep the writes before them
+        struct Write
+        {
+            uint32_t Stride, Count;
+        };
+        const Write writes[] = { { 28, 5 }, { 12, 7 }, { 28, 3 }, { 16, 10 }, { 24, 1 } };
+        std::vector<std::vector<uint8_t>> data;
+        std::vector<VertexStreamRange> ranges;
+        bool written = true, aligned = true;
+        for (const Write& write : writes)
+        {
+            data.push_back(Pattern(write.Stride * write.Count, static_cast<uint32_t>(data.size())));
+            VertexStreamRange range;
+            written = written && stream.Write(context, data.back().data(), write.Stride, write.Count, &range);
+            aligned = aligned && range.Offset % write.Stride == 0 && range.BaseVertex * write.Stride == range.Offset &&
+                range.VertexCount == write.Count && (ranges.empty() ||
+                range.Offset >= ranges.back().Offset + ranges.back().VertexCount * writes[ranges.size() - 1].Stride);
+            ranges.push_back(range);
+        }
+        Check(written && aligned && ranges[0].Offset == 0, "stream: appends start at a multiple of their stride");
+        bool intact = true;
+        for (size_t i = 0; i < ranges.size(); ++i)
+        {
+            intact = intact && std::memcmp(buffer->Data.data() + ranges[i].Offset, data[i].data(),
+                data[i].size()) == 0;
+        }
+        Check(intact, "stream: every write of the frame is intact");
+        Check(stream.GetStats().Discards == 1 && stream.GetStats().Writes == 5,
+            "stream: only the first write discards");
+
+        uint64_t frameBytes = 0;
+        for (const std::vector<uint8_t>& bytes : data)
+            frameBytes += bytes.size();
+        Check(stream.GetFrameBytes() == frameBytes && stream.GetLastFrameBytes() == 0, "stream: frame bytes counted");
+        stream.EndFrame();
+        Check(stream.GetFrameBytes() == 0 && stream.GetLastFrameBytes() == frameBytes,
+            "stream: end of frame reports the frame's bytes");
+
+        // 528 bytes are used; 500 more do not fit, so the write discards and starts over
+        std::vector<uint8_t> wrap = Pattern(500, 9);
+        VertexStreamRange range;
+        Check(stream.Write(context, wrap.data(), 20, 25, &range) && range.Offset == 0 &&
+            stream.GetStats().Discards == 2 && std::memcmp(buffer->Data.data(), wrap.data(), 500) == 0,
+            "stream: a write past the end wraps to the front with a discard");
+        Check(stream.Write(context, wrap.data(), 20, 25, &range) && range.Offset == 500 &&
+            stream.GetStats().Discards == 2, "stream: the buffer fills exactly before wrapping");
+        Check(stream.Write(context, wrap.data(), 4, 1, &range) && range.Offset == 0 && stream.GetStats().Discards == 3,
+            "stream: a full buffer wraps on the next write");
+
+        // Nothing is written for empty or oversized writes
+        std::vector<uint8_t> before = buffer->Data;
+        std::vector<uint8_t> big = Pattern(1004, 3);
+        Check(!stream.Write(context, big.data(), 4, 251, &range) && !range && !stream.Write(context, big.data(), 4, 0,
+            &range) && stream.GetStats().Failures == 2 && buffer->Data == before,
+            "stream: empty and oversized writes fail and write nothing");
+        Check(stream.Write(context, big.data(), 4, 250, &range) && range.Offset == 0,
+            "stream: a write of the whole buffer fits");
+    }
+
+    struct Constants
+    {
+        Float4x4 WVP;
+        Float4 AdditionalColor;
+    };
+
+    // A PlaneShape grid whose heights and colors follow a travelling wave
+    void AnimateWave(const std::vector<Vertex>& rest, float time, float phase, Vertex* vertices)
+    {
+        for (size_t i = 0; i < rest.size(); ++i)
+        {
+            Float3 p = rest[i].Position;
+            float wave = std::sin(6.0f * p.x + 4.0f * p.z + 3.0f * time + phase);
+            vertices[i].Position = { p.x, 0.15f * wave, p.z };
+            vertices[i].Color = { 0.5f + 0.5f * wave, 0.4f, 0.5f - 0.5f * wave, 1.0f };
+        }
+    }
+
+    // Renders frameCount frames of objectCount wave grids on the software backend. The
+    // vertices are streamed, or copied into a Default buffer created for each grid and frame.
+    std::vector<std::vector<uint32_t>> RenderWaves(JobSystem& jobSystem, const std::vector<Vertex>& rest,
+        const std::vector<uint16_t>& indices, uint32_t objectCount, uint32_t frameCount, bool streamed,
+        uint64_t* discards)
+    {
+        SoftwareRenderDevice device(jobSystem, 160, 120);
+        RenderContext& context = device.GetImmediateContext();
+        VertexShaderHandle vertexShader;
+        PixelShaderHandle pixelShader;
+        ShaderDesc vsDesc = { "Effects.fx", "VS", "vs_5_0",
+            { std::begin(VertexInputLayout), std::end(VertexInputLayout) } };
+        ShaderDesc psDesc = { "Effects.fx", "PS", "ps_5_0", {} };
+        BufferDesc ibDesc;
+        ibDesc.ByteWidth = static_cast<uint32_t>(indices.size() * sizeof(uint16_t));
+        ibDesc.Bind = BufferBind::IndexBuffer;
+        ibDesc.Usage = BufferUsage::Immutable;
+        BufferHandle indexBuffer;
+        Check(device.CreateVertexShader(vsDesc, &vertexShader) && device.CreatePixelShader(psDesc, &pixelShader) &&
+            device.CreateBuffer(ibDesc, indices.data(), &indexBuffer), "waves: shaders and index buffer created");
+
+        // Room for a little more than two grids, so most frames wrap
+        DynamicVertexStream stream;
+        uint32_t gridBytes = static_cast<uint32_t>(rest.size() * sizeof(Vertex));
+        Check(!streamed || stream.Initialize(device, gridBytes * 5 / 2), "waves: stream created");
+
+        Float4x4 viewProjection = MatrixLookAtLH({ 0.0f, 2.0f, -2.5f }, { 0.0f, 0.0f, 0.5f }, { 0.0f, 1.0f, 0.0f }) *
+            MatrixPerspectiveFovLH(MathPiDiv2, 160.0f / 120.0f, 0.1f, 100.0f);
+        std::vector<Vertex> animated(rest.size());
+        std::vector<std::vector<uint32_t>> images;
+        for (uint32_t frame = 0; frame < frameCount; ++frame)
+        {
+            float clearColor[4] = { 0.0f, 0.125f, 0.3f, 1.0f };
+            context.ClearRenderTarget(clearColor);
+            context.ClearDepthStencil(1.0f, 0);
+            context.SetViewport(device.GetDefaultViewport());
+            context.SetVertexShader(vertexShader);
+            context.SetPixelShader(pixelShader);
+            context.SetIndexBuffer(indexBuffer, Format::R16UInt, 0);
+            for (uint32_t object = 0; object < objectCount; ++object)
+            {
+                AnimateWave(rest, 0.1f * frame, 1.3f * object, animated.data());
+                Float4x4 world = MatrixTranslation(1.1f * object - 0.55f * (objectCount - 1), 0.0f, 0.3f * object);
+                Constants constants = { MatrixTranspose(world * viewProjection), { 1.0f, 1.0f, 1.0f, 1.0f } };
+                context.SetVSConstantBufferRange(0, context.AllocateConstants(&constants, sizeof(constants)));
+                if (streamed)
+                {
+                    VertexStreamRange range;
+                    Check(stream.Write(context, animated.data(), sizeof(Vertex),
+                        static_cast<uint32_t>(animated.size()), &range), "waves: grid streamed");
+                    context.SetVertexBuffer(0, stream.GetBuffer(), sizeof(Vertex), range.Offset);
+                }
+                else
+                {
+                    BufferDesc vbDesc;
+                    vbDesc.ByteWidth = gridBytes;
+                    vbDesc.Bind = BufferBind::VertexBuffer;
+                    BufferHandle vertexBuffer;
+                    Check(device.CreateBuffer(vbDesc, animated.data(), &vertexBuffer), "waves: buffer re-created");
+                    context.SetVertexBuffer(0, vertexBuffer, sizeof(Vertex), 0);
+                }
+                context.DrawIndexed(static_cast<uint32_t>(indices.size()), 0, 0);
+            }
+            device.Present();
+            stream.EndFrame();
+            const uint32_t* pixels = device.GetRasterizer().GetColorBuffer();
+            images.emplace_back(pixels, pixels + 160 * 120);
+        }
+        *discards = stream.GetStats().Discards;
+        return images;
+    }
+
+    // Streams totalBytes in writes of writeSize bytes through a ring of capacity bytes; returns GB/s
+    double TimeStream(uint32_t capacity, uint32_t writeSize, uint64_t totalBytes, uint64_t* discards)
+    {
+        NullRenderDevice device(640, 480);
+        RenderContext& context = device.GetImmediateContext();
+        DynamicVertexStream stream;
+        stream.Initialize(device, capacity);
+        std::vector<uint8_t> source = Pattern(writeSize, 1);
+        uint64_t writes = std::max<uint64_t>(1, totalBytes / writeSize);
+
+        Clock::time_point start = Clock::now();
+        VertexStreamRange range;
+        for (uint64_t i = 0; i < writes; ++i)
+            stream.Write(context, source.data(), 4, writeSize / 4, &range);
+        double ms = ElapsedMs(start);
+        *discards = stream.GetStats().Discards;
+        return stream.GetStats().BytesWritten / (ms * 1e6);
+    }
+
+    // The same bytes copied straight into memory, the bound of any copy-in path
+    double TimeMemcpy(uint32_t capacity, uint32_t writeSize, uint64_t totalBytes)
+    {
+        std::vector<uint8_t> target(capacity);
+        std::vector<uint8_t> source = Pattern(writeSize, 1);
+        uint64_t writes = std::max<uint64_t>(1, totalBytes / writeSize);
+        uint32_t offset = 0;
+
+        Clock::time_point start = Clock::now();
+        for (uint64_t i = 0; i < writes; ++i)
+        {
+            if (offset + writeSize > capacity)
+                offset = 0;
+            std::memcpy(target.data() + offset, source.data(), writeSize);
+            offset += writeSize;
+        }
+        double ms = ElapsedMs(start);
+        volatile uint8_t sink = target[capacity / 2];
+        (void)sink;
+        return writes * writeSize / (ms * 1e6);
+    }
+
+    // A Default buffer created with the bytes for every write, as without a stream; returns GB/s
+    double TimeRecreate(uint32_t writeSize, uint64_t totalBytes)
+    {
+        NullRenderDevice device(640, 480);
+        std::vector<uint8_t> source = Pattern(writeSize, 1);
+        uint64_t writes = std::max<uint64_t>(1, totalBytes / writeSize);
+        BufferDesc desc;
+        desc.ByteWidth = writeSize;
+        desc.Bind = BufferBind::VertexBuffer;
+
+        Clock::time_point start = Clock::now();
+        BufferHandle buffer;
+        for (uint64_t i = 0; i < writes; ++i)
+            device.CreateBuffer(desc, source.data(), &buffer);
+        return writes * writeSize / (ElapsedMs(start) * 1e6);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t megabytes = 1024;
+    uint32_t frameCount = 200;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--megabytes") == 0 && i + 1 < argc)
+            megabytes = static_cast<uint32_t>(std::max(16, std::atoi(argv[++i])));
+        else if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+            frameCount = static_cast<uint32_t>(std::max(1, std::atoi(argv[++i])));
+    }
+
+    JobSystem jobSystem;
+    CheckStream();
+    std::vector<Vertex> rest;
+    std::vector<uint16_t> indices;
+    GeneratePrimitive(PlaneShape{ 24, 24 }, nullptr, &rest, &indices);
+    uint64_t discards = 0, unused = 0;
+    std::vector<std::vector<uint32_t>> streamedImages = RenderWaves(jobSystem, rest, indices, 3, 6, true, &discards);
+    Check(streamedImages == RenderWaves(jobSystem, rest, indices, 3, 6, false, &unused),
+        "waves: streamed grids draw the same frames as re-created buffers");
+    Check(streamedImages.front() != streamedImages.back(), "waves: the grids animate");
+    Check(discards >= 6, "waves: the stream wraps every frame");
+    if (g_Failures > 0)
+    {
+        std::fprintf(stderr, "%d check(s) failed\n", g_Failures);
+        return 1;
+    }
+    std::printf("DynamicVertexStream checks passed\n\n");
+
+    // Copy-in rates of a 16 MB ring by write size
+    uint32_t capacity = 16u << 20;
+    uint64_t totalBytes = uint64_t(megabytes) << 20;
+    std::printf("%-12s %12s %12s %14s %16s\n", "Write size", "Stream GB/s", "memcpy GB/s", "Re-create GB/s",
+        "Discards per GB");
+    for (uint32_t writeSize : { 256u, 4096u, 65536u, 1u << 20 })
+    {
+        double stream = TimeStream(capacity, writeSize, totalBytes, &discards);
+        double copy = TimeMemcpy(capacity, writeSize, totalBytes);
+        double recreate = TimeRecreate(writeSize, std::min<uint64_t>(totalBytes, 256u << 20));
+        std::printf("%-12u %12.2f %12.2f %14.2f %16.1f\n", writeSize, stream, copy, recreate,
+            discards * double(1 << 30) / totalBytes);
+    }
+
+    // 64 wave grids of 129x129 vertices animated and streamed every frame
+    NullRenderDevice device(640, 480);
+    RenderContext& context = device.GetImmediateContext();
+    GeneratePrimitive(PlaneShape{ 128, 128 }, nullptr, &rest, &indices);
+    DynamicVertexStream stream;
+    stream.Initialize(device, capacity);
+    std::vector<Vertex> animated(rest.size());
+    double animateMs = 0.0, streamMs = 0.0;
+    uint64_t frameBytes = 0;
+    for (uint32_t frame = 0; frame < frameCount; ++frame)
+    {
+        for (uint32_t object = 0; object < 64; ++object)
+        {
+            Clock::time_point start = Clock::now();
+            AnimateWave(rest, 0.01f * frame, 0.7f * object, animated.data());
+            animateMs += ElapsedMs(start);
+            start = Clock::now();
+            VertexStreamRange range;
+            stream.Write(context, animated.data(), sizeof(Vertex), static_cast<uint32_t>(animated.size()), &range);
+            streamMs += ElapsedMs(start);
+        }
+        stream.EndFrame();
+        frameBytes = stream.GetLastFrameBytes();
+    }
+    std::printf("\n%-26s %12s %14s %14s %12s\n", "Animated frames", "MB/frame", "Animate ms", "Stream ms",
+        "Stream GB/s");
+    std::printf("%-26s %12.2f %14.3f %14.3f %12.2f\n", "64 grids, 16641 vertices", frameBytes / double(1 << 20),
+        animateMs / frameCount, streamMs / frameCount, stream.GetStats().BytesWritten / (streamMs * 1e6));
+    std::printf("Discards: %llu over %u frames\n", static_cast<unsigned long long>(stream.GetStats().Discards),
+        frameCount);
+    return 0;
+}
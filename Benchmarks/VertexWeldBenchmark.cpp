@@ -0,0 +1,367 @@
+// Checks and throughput of VertexWelder, the triangle soup to indexed mesh
+// builder. The checks cover the tutorials' cube (36 soup vertices weld to its
+// 8), -0 against +0, attributes that must keep vertices apart, tolerance
+// welding of jittered copies, degenerate triangle removal, first-occurrence
+// order, a partial trailing triangle, and that every thread and partition
+// count gives the same mesh as a sequential std::unordered_map welder. The
+// benchmark welds the soup of a large grid (every vertex repeated by the six
+// triangles around it) with 1..N threads and reports vertices/s, the time of
+// each pass and the working memory next to the soup and the mesh.
+//
+// Build (from the repository root):
+//   g++ -std=c++20 -O2 -pthread -ICommon Benchmarks/VertexWeldBenchmark.cpp Common/VertexWelder.cpp
+//       Common/JobSystem.cpp -o VertexWeldBenchmark
+//
+// Usage: VertexWeldBenchmark [--vertices N] [--threads N]
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <sys/resource.h>
+
+#include "CubeMesh.h"
+#include "JobSystem.h"
+#include "VertexWelder.h"
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    int g_Failures = 0;
+
+    void Check(bool condition, const char* what)
+    {
+        if (!condition)
+        {
+            std::fprintf(stderr, "FAILED: %s\n", what);
+            ++g_Failures;
+        }
+    }
+
+    double ElapsedMs(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    bool SameVertex(const Vertex& a, const Vertex& b)
+    {
+        return std::memcmp(&a, &b, sizeof(Vertex)) == 0;
+    }
+
+    bool SameMesh(const MeshData& a, const MeshData& b)
+    {
+        return a.Indices == b.Indices && a.Vertices.size() == b.Vertices.size() &&
+            std::memcmp(a.Vertices.data(), b.Vertices.data(), a.Vertices.size() * sizeof(Vertex)) == 0;
+    }
+
+    // The soup of a columns x rows grid: 6 vertices per quad, colored by position
+    std::vector<Vertex> MakeGridSoup(uint32_t columns, uint32_t rows)
+    {
+        std::vector<Vertex> soup;
+        soup.reserve(size_t(columns) * rows * 6);
+        auto corner = [&](uint32_t x, uint32_t y) -> Vertex
+        {
+            return { { float(x), float(y), 0.0f }, { float(x % 7) / 6.0f, float(y % 5) / 4.0f, 0.5f, 1.0f } };
+        };
+        for (uint32_t y = 0; y < rows; ++y)
+        {
+            for (uint32_t x = 0; x < columns; ++x)
+            {
+                Vertex a = corner(x, y), b = corner(x + 1, y), c = corner(x + 1, y + 1), d = corner(x, y + 1);
+                soup.insert(soup.end(), { a, d, c, a, c, b });
+            }
+        }
+        return soup;
+    }
+
+    // Sequential reference with the same rounding as the welder
+    MeshData WeldReference(const std::vector<Vertex>& soup, const VertexWeldOptions& options)
+    {
+        using Key = std::array<uint32_t, 7>;
+        struct KeyHash
+        {
+            size_t operator()(const Key& key) const
+            {
+                size_t hash = 0;
+                for (uint32_t word : key)
+                    hash = hash * 1000003u ^ word;
+                return hash;
+            }
+        };
+        auto quantize = [](float value, float tolerance) -> uint32_t
+        {
+            if (tolerance <= 0.0f)
+            {
+                float normalized = value + 0.0f;
+                uint32_t bits;
+                std::memcpy(&bits, &normalized, sizeof(bits));
+                return bits;
+            }
+            return static_cast<uint32_t>(static_cast<int32_t>(std::floor(value * (1.0f / tolerance) + 0.5f)));
+        };
+
+        MeshData mesh;
+        std::unordered_map<Key, uint32_t, KeyHash> vertexOf;
+        float p = options.PositionTolerance, c = options.ColorTolerance;
+        for (size_t i = 0; i < soup.size() - soup.size() % 3; ++i)
+        {
+            const Vertex& v = soup[i];
+            Key key = { quantize(v.Position.x, p), quantize(v.Position.y, p), quantize(v.Position.z, p),
+                quantize(v.Color.x, c), quantize(v.Color.y, c), quantize(v.Color.z, c), quantize(v.Color.w, c) };
+            auto inserted = vertexOf.emplace(key, static_cast<uint32_t>(mesh.Vertices.size()));
+            if (inserted.second)
+                mesh.Vertices.push_back(v);
+            mesh.Indices.push_back(inserted.first->second);
+        }
+        if (options.RemoveDegenerateTriangles)
+        {
+            std::vector<uint32_t> kept;
+            for (size_t i = 0; i < mesh.Indices.size(); i += 3)
+            {
+                uint32_t a = mesh.Indices[i], b = mesh.Indices[i + 1], d = mesh.Indices[i + 2];
+                if (a != b && b != d && d != a)
+                    kept.insert(kept.end(), { a, b, d });
+            }
+            mesh.Indices = std::move(kept);
+        }
+        return mesh;
+    }
+
+    void CheckCube(JobSystem& jobSystem)
+    {
+        std::vector<Vertex> soup;
+        for (uint16_t index : CubeIndices)
+            soup.push_back(CubeVertices[index]);
+
+        MeshData mesh;
+        VertexWeldStats stats;
+        Check(WeldVertices(soup.data(), soup.size(), {}, &jobSystem, &mesh, &stats), "cube: weld");
+        Check(mesh.Vertices.size() == CubeVertexCount && mesh.Indices.size() == CubeIndexCount &&
+            stats.UniqueVertices == CubeVertexCount && stats.DegenerateTriangles == 0, "cube: 36 vertices weld to 8");
+        bool same = true;
+        for (size_t i = 0; i < mesh.Indices.size(); ++i)
+            same = same && SameVertex(mesh.Vertices[mesh.Indices[i]], soup[i]);
+        Check(same, "cube: every index addresses its soup vertex");
+        Check(SameVertex(mesh.Vertices[0], CubeVertices[CubeIndices[0]]) &&
+            SameVertex(mesh.Vertices[1], CubeVertices[CubeIndices[1]]), "cube: first-occurrence order");
+
+        // A partial trailing triangle is ignored
+        soup.push_back(CubeVertices[0]);
+        Check(WeldVertices(soup.data(), soup.size(), {}, nullptr, &mesh) && mesh.Indices.size() == CubeIndexCount,
+            "cube: partial triangle ignored");
+    }
+
+    void CheckAttributes()
+    {
+        Vertex a = { { 0.0f, 1.0f, 2.0f }, { 1.0f, 0.0f, 0.0f, 1.0f } };
+        Vertex negativeZero = a;
+        negativeZero.Position.x = -0.0f;
+        Vertex otherColor = a;
+        otherColor.Color.w = 0.5f;
+        Vertex nearby = a;
+        nearby.Position.y = std::nextafter(1.0f, 2.0f);
+        Vertex soup[] = { a, negativeZero, otherColor, a, nearby, otherColor };
+
+        MeshData mesh;
+        Check(WeldVertices(soup, 6, {}, nullptr, &mesh) && mesh.Vertices.size() == 3 &&
+            mesh.Indices == std::vector<uint32_t>{ 0, 2, 1 }, "exact: -0 welds to +0, other bits do not");
+
+        VertexWeldOptions tolerant;
+        tolerant.PositionTolerance = 1e-3f;
+        tolerant.RemoveDegenerateTriangles = false;
+        Check(WeldVertices(soup, 6, tolerant, nullptr, &mesh) && mesh.Vertices.size() == 2,
+            "tolerance: nearby position welds, color still separates");
+        tolerant.ColorTolerance = 1.0f;
+        Check(WeldVertices(soup, 6, tolerant, nullptr, &mesh) && mesh.Vertices.size() == 1 &&
+            mesh.Indices.size() == 6, "tolerance: color tolerance welds the rest, degenerate triangles kept");
+        tolerant.RemoveDegenerateTriangles = true;
+        VertexWeldStats stats;
+        Check(WeldVertices(soup, 6, tolerant, nullptr, &mesh, &stats) && mesh.Indices.empty() &&
+            stats.DegenerateTriangles == 2, "tolerance: collapsed triangles removed");
+
+        MeshData empty;
+        Check(WeldVertices(soup, 0, {}, nullptr, &empty) && empty.Vertices.empty() && empty.Indices.empty(),
+            "empty soup");
+    }
+
+    void CheckTolerance(JobSystem& jobSystem)
+    {
+        // Jitter below half the tolerance around grid points (and colors that are multiples of
+        // the color tolerance) welds back to the grid's vertices
+        std::vector<Vertex> soup = MakeGridSoup(60, 40);
+        std::vector<Vertex> jittered = soup;
+        std::mt19937 random(3);
+        std::uniform_real_distribution<float> jitter(-0.004f, 0.004f);
+        for (Vertex& v : jittered)
+        {
+            v.Position.x += jitter(random);
+            v.Position.y += jitter(random);
+            v.Color.x += jitter(random) * 0.1f;
+        }
+
+        MeshData exact, welded;
+        VertexWeldOptions options;
+        options.PositionTolerance = 0.01f;
+        options.ColorTolerance = 1.0f / 60.0f;
+        Check(WeldVertices(soup.data(), soup.size(), {}, &jobSystem, &exact) &&
+            WeldVertices(jittered.data(), jittered.size(), options, &jobSystem, &welded) &&
+            exact.Vertices.size() == 61 * 41 && welded.Indices == exact.Indices,
+            "tolerance: jittered soup welds to the grid");
+        bool near = true;
+        for (size_t i = 0; i < welded.Indices.size(); ++i)
+        {
+            const Vertex& v = welded.Vertices[welded.Indices[i]];
+            near = near && std::fabs(v.Position.x - soup[i].Position.x) < 0.005f &&
+                std::fabs(v.Position.y - soup[i].Position.y) < 0.005f;
+        }
+        Check(near, "tolerance: welded positions stay within the jitter");
+
+        MeshData unwelded;
+        Check(WeldVertices(jittered.data(), jittered.size(), {}, &jobSystem, &unwelded) &&
+            unwelded.Vertices.size() == jittered.size(), "exact: jittered soup stays apart");
+    }
+
+    void CheckDeterminism()
+    {
+        // Shuffled triangles so that partitions and blocks interleave
+        std::vector<Vertex> soup = MakeGridSoup(200, 150);
+        std::mt19937 random(5);
+        for (size_t t = soup.size() / 3; t > 1; --t)
+        {
+            size_t other = random() % t;
+            std::swap_ranges(soup.begin() + (t - 1) * 3, soup.begin() + t * 3, soup.begin() + other * 3);
+        }
+
+        VertexWeldOptions options;
+        options.PositionTolerance = 0.5f;
+        options.ColorTolerance = 0.25f;
+        for (const VertexWeldOptions& weld : { VertexWeldOptions{}, options })
+        {
+            MeshData reference = WeldReference(soup, weld);
+            bool same = true;
+            for (unsigned int threads : { 1u, 3u, 8u })
+            {
+                JobSystem jobSystem(threads);
+                for (uint32_t partitionBits : { 0u, 1u, 5u, 12u })
+                {
+                    VertexWeldOptions partitioned = weld;
+                    partitioned.PartitionBits = partitionBits;
+                    MeshData mesh;
+                    same = same && WeldVertices(soup.data(), soup.size(), partitioned, &jobSystem, &mesh) &&
+                        SameMesh(mesh, reference);
+                }
+            }
+            Check(same, weld.PositionTolerance > 0.0f ? "determinism: tolerance weld matches the reference" :
+                "determinism: exact weld matches the reference at every thread and partition count");
+        }
+    }
+
+    long PeakRssMb()
+    {
+        rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        return usage.ru_maxrss / 1024;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    size_t vertexCount = 12000000;
+    unsigned int maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--vertices") == 0 && i + 1 < argc)
+            vertexCount = static_cast<size_t>(std::max(6000.0, std::atof(argv[++i])));
+        else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+            maxThreads = static_cast<unsigned int>(std::max(1, std::atoi(argv[++i])));
+    }
+
+    {
+        JobSystem jobSystem(4);
+        CheckCube(jobSystem);
+        CheckAttributes();
+        CheckTolerance(jobSystem);
+        CheckDeterminism();
+    }
+    if (g_Failures > 0)
+    {
+        std::fprintf(stderr, "%d check(s) failed\n", g_Failures);
+        return 1;
+    }
+    std::printf("Vertex weld checks passed\n\n");
+
+    // A grid soup of about vertexCount vertices, 6 per quad
+    uint32_t columns = static_cast<uint32_t>(std::sqrt(double(vertexCount) / 6.0));
+    uint32_t rows = static_cast<uint32_t>(vertexCount / 6 / columns);
+    std::vector<Vertex> soup = MakeGridSoup(columns, rows);
+    double soupMb = soup.size() * sizeof(Vertex) / 1048576.0;
+    std::printf("%zu soup vertices (%.0f MB) welding to %u, %u hardware threads\n", soup.size(), soupMb,
+        (columns + 1) * (rows + 1), std::thread::hardware_concurrency());
+    std::printf("%-22s %8s %9s %8s %8s %8s %8s %8s %9s %9s\n", "Welder", "Threads", "Total ms", "Mvert/s",
+        "Hash", "Part.", "Weld", "Output", "Speedup", "Temp MB");
+
+    Clock::time_point start = Clock::now();
+    MeshData reference = WeldReference(soup, {});
+    double referenceMs = ElapsedMs(start);
+    std::printf("%-22s %8u %9.1f %8.1f %8s %8s %8s %8s %8.2fx %9s\n", "std::unordered_map", 1u, referenceMs,
+        soup.size() / referenceMs / 1000.0, "-", "-", "-", "-", 1.0, "-");
+
+    double singleMs = 0.0;
+    for (unsigned int threads = 1; threads <= maxThreads; threads = threads < maxThreads ? std::min(threads * 2,
+        maxThreads) : threads + 1)
+    {
+        JobSystem jobSystem(threads);
+        MeshData mesh;
+        VertexWeldStats stats;
+        std::vector<double> times;
+        for (int run = 0; run < 3; ++run)
+        {
+            start = Clock::now();
+            WeldVertices(soup.data(), soup.size(), {}, &jobSystem, &mesh, &stats);
+            times.push_back(ElapsedMs(start));
+        }
+        std::sort(times.begin(), times.end());
+        double ms = times[1];
+        if (threads == 1)
+        {
+            singleMs = ms;
+            Check(SameMesh(mesh, reference), "benchmark: welded grid matches the reference");
+        }
+        std::printf("%-22s %8u %9.1f %8.1f %8.1f %8.1f %8.1f %8.1f %8.2fx %9.1f\n", "WeldVertices", threads, ms,
+            soup.size() / ms / 1000.0, stats.HashMs, stats.PartitionMs, stats.WeldMs, stats.OutputMs,
+            referenceMs / ms, stats.TemporaryBytes / 1048576.0);
+    }
+
+    JobSystem jobSystem(maxThreads);
+    VertexWeldOptions tolerant;
+    tolerant.PositionTolerance = 1e-3f;
+    tolerant.ColorTolerance = 1.0f / 255.0f;
+    MeshData mesh;
+    VertexWeldStats stats;
+    start = Clock::now();
+    WeldVertices(soup.data(), soup.size(), tolerant, &jobSystem, &mesh, &stats);
+    double tolerantMs = ElapsedMs(start);
+    std::printf("%-22s %8u %9.1f %8.1f %8.1f %8.1f %8.1f %8.1f %8.2fx %9.1f\n", "WeldVertices, tolerance",
+        maxThreads, tolerantMs, soup.size() / tolerantMs / 1000.0, stats.HashMs, stats.PartitionMs, stats.WeldMs,
+        stats.OutputMs, referenceMs / tolerantMs, stats.TemporaryBytes / 1048576.0);
+
+    double meshMb = (mesh.Vertices.size() * sizeof(Vertex) + mesh.Indices.size() * sizeof(uint32_t)) / 1048576.0;
+    std::printf("\n%u partitions; indexed mesh %.0f MB (%.1fx smaller than the soup); single-thread speedup over "
+        "std::unordered_map %.2fx; peak RSS %ld MB\n", stats.Partitions, meshMb, soupMb / meshMb,
+        referenceMs / singleMs, PeakRssMb());
+    if (g_Failures > 0)
+    {
+        std::fprintf(stderr, "%d check(s) failed\n", g_Failures);
+        return 1;
+    }
+    return 0;
+}
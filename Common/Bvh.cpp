@@ -0,0 +1,647 @@
+#include "Bvh.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+
+#include "JobSystem.h"
+
+namespace
+{
+    constexpr uint32_t BinCount = 16;
+    constexpr uint32_t MaxLeafObjects = 8;
+
+    // Cost of visiting a node relative to testing one object
+    constexpr float TraversalCost = 1.0f;
+
+    // Objects per job when a range is summarized or binned in parallel, and the
+    // smallest range worth doing that for
+    constexpr size_t ChunkSize = 16384;
+    constexpr size_t ParallelRangeSize = 4 * ChunkSize;
+
+    // Traversal stacks: each level leaves at most one sibling behind
+    constexpr size_t StackSize = Bvh::MaxDepth + 2;
+
+    constexpr float Infinity = std::numeric_limits<float>::infinity();
+
+    BvhBox EmptyBox()
+    {
+        return { { Infinity, Infinity, Infinity }, { -Infinity, -Infinity, -Infinity } };
+    }
+
+    void Grow(BvhBox* box, const Float3& min, const Float3& max)
+    {
+        box->Min = { std::min(box->Min.x, min.x), std::min(box->Min.y, min.y), std::min(box->Min.z, min.z) };
+        box->Max = { std::max(box->Max.x, max.x), std::max(box->Max.y, max.y), std::max(box->Max.z, max.z) };
+    }
+
+    float Area(const BvhBox& box)
+    {
+        float dx = box.Max.x - box.Min.x, dy = box.Max.y - box.Min.y, dz = box.Max.z - box.Min.z;
+        return dx < 0.0f ? 0.0f : 2.0f * (dx * dy + dy * dz + dz * dx);
+    }
+
+    float Component(const Float3& v, int axis)
+    {
+        return axis == 0 ? v.x : axis == 1 ? v.y : v.z;
+    }
+
+    Float3 ObjectMin(const Float3& center, const Float3& extents)
+    {
+        return { center.x - extents.x, center.y - extents.y, center.z - extents.z };
+    }
+
+    Float3 ObjectMax(const Float3& center, const Float3& extents)
+    {
+        return { center.x + extents.x, center.y + extents.y, center.z + extents.z };
+    }
+
+    // Entry distance of the ray into box within [0, maxDistance], or Infinity
+    float RayEntry(const BvhBox& box, const Float3& origin, const Float3& inverse, float maxDistance)
+    {
+        float x1 = (box.Min.x - origin.x) * inverse.x, x2 = (box.Max.x - origin.x) * inverse.x;
+        float y1 = (box.Min.y - origin.y) * inverse.y, y2 = (box.Max.y - origin.y) * inverse.y;
+        float z1 = (box.Min.z - origin.z) * inverse.z, z2 = (box.Max.z - origin.z) * inverse.z;
+        float entry = std::max(std::max(std::min(x1, x2), std::min(y1, y2)), std::max(std::min(z1, z2), 0.0f));
+        float exit = std::min(std::min(std::max(x1, x2), std::max(y1, y2)), std::min(std::max(z1, z2), maxDistance));
+        return entry <= exit ? entry : Infinity;
+    }
+
+    bool Overlaps(const BvhBox& a, const BvhBox& b)
+    {
+        return a.Min.x <= b.Max.x && a.Max.x >= b.Min.x && a.Min.y <= b.Max.y && a.Max.y >= b.Min.y &&
+            a.Min.z <= b.Max.z && a.Max.z >= b.Min.z;
+    }
+
+    bool Contains(const BvhBox& outer, const BvhBox& inner)
+    {
+        return inner.Min.x >= outer.Min.x && inner.Max.x <= outer.Max.x && inner.Min.y >= outer.Min.y &&
+            inner.Max.y <= outer.Max.y && inner.Min.z >= outer.Min.z && inner.Max.z <= outer.Max.z;
+    }
+
+    // Box of the objects and box of their centers
+    struct RangeSummary
+    {
+        BvhBox Bounds = EmptyBox();
+        BvhBox Centers = EmptyBox();
+    };
+
+    struct Bin
+    {
+        RangeSummary Summary;
+        uint32_t Count = 0;
+    };
+
+    using Bins = std::array<Bin, 3 * BinCount>;
+
+    // An object as the build moves it around, so that ranges are contiguous in memory
+    struct Reference
+    {
+        Float3 Center;
+        Float3 Extents;
+        uint32_t Object;
+    };
+
+    struct BuildTask
+    {
+        uint32_t Node;
+        uint32_t Begin;
+        uint32_t End;
+        uint32_t Depth;
+        RangeSummary Summary;
+    };
+
+    void Merge(RangeSummary* into, const RangeSummary& from)
+    {
+        Grow(&into->Bounds, from.Bounds.Min, from.Bounds.Max);
+        Grow(&into->Centers, from.Centers.Min, from.Centers.Max);
+    }
+
+    void Merge(Bins* into, const Bins& from)
+    {
+        for (size_t i = 0; i < into->size(); ++i)
+        {
+            Merge(&(*into)[i].Summary, from[i].Summary);
+            (*into)[i].Count += from[i].Count;
+        }
+    }
+
+    // Top-down binned SAH over a range of references. Large ranges are summarized and
+    // binned on the JobSystem; tasks small enough can be handed back for building as
+    // independent subtrees.
+    class Builder
+    {
+    public:
+        explicit Builder(std::vector<Reference>& references)
+            : m_References(references)
+        {
+        }
+
+        RangeSummary Summarize(JobSystem* jobSystem, uint32_t begin, uint32_t end)
+        {
+            RangeSummary result;
+            Reduce(jobSystem, begin, end, &result, [this](uint32_t first, uint32_t last, RangeSummary* summary)
+            {
+                for (uint32_t i = first; i < last; ++i)
+                {
+                    const Reference& reference = m_References[i];
+                    Grow(&summary->Bounds, ObjectMin(reference.Center, reference.Extents),
+                        ObjectMax(reference.Center, reference.Extents));
+                    Grow(&summary->Centers, reference.Center, reference.Center);
+                }
+            });
+            return result;
+        }
+
+        // Splits root into nodes until the leaves; returns the deepest level reached. Children
+        // with at most deferSize objects go to deferred instead when it is not null.
+        uint32_t Run(JobSystem* jobSystem, std::vector<BvhNode>& nodes, const BuildTask& root, size_t deferSize,
+            std::vector<BuildTask>* deferred)
+        {
+            uint32_t depth = 0;
+            std::vector<BuildTask> stack = { root };
+            while (!stack.empty())
+            {
+                BuildTask task = stack.back();
+                stack.pop_back();
+                depth = std::max(depth, task.Depth);
+
+                uint32_t count = task.End - task.Begin;
+                BvhNode& node = nodes[task.Node];
+                node.Bounds = task.Summary.Bounds;
+                node.Left = 0;
+                node.First = task.Begin;
+                node.Count = count;
+                if (count <= 1 || task.Depth + 1 >= Bvh::MaxDepth)
+                    continue;
+
+                RangeSummary summaries[2];
+                uint32_t middle = Split(jobSystem, task, summaries);
+                if (middle == task.Begin)
+                    continue;
+
+                uint32_t left = static_cast<uint32_t>(nodes.size());
+                nodes.resize(nodes.size() + 2);
+                nodes[task.Node].Left = left;
+                const BuildTask children[2] = { { left, task.Begin, middle, task.Depth + 1, summaries[0] },
+                    { left + 1, middle, task.End, task.Depth + 1, summaries[1] } };
+                for (const BuildTask& child : children)
+                {
+                    if (deferred && child.End - child.Begin <= deferSize)
+                        deferred->push_back(child);
+                    else
+                        stack.push_back(child);
+                }
+            }
+            return depth;
+        }
+
+    private:
+        // Partitions the task's range and returns where the right child starts, or Begin for a
+        // leaf; the summaries of both children are written to children
+        uint32_t Split(JobSystem* jobSystem, const BuildTask& task, RangeSummary children[2])
+        {
+            uint32_t count = task.End - task.Begin;
+            const BvhBox& centers = task.Summary.Centers;
+            uint32_t binCount = std::min(BinCount, count);
+            Bins bins;
+            FillBins(jobSystem, task.Begin, task.End, centers, binCount, &bins);
+
+            // Sweep every plane between bins of each axis
+            float bestCost = Infinity;
+            int bestAxis = -1;
+            uint32_t bestBin = 0;
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                const Bin* axisBins = bins.data() + axis * BinCount;
+                RangeSummary right[BinCount];
+                uint32_t rightCount[BinCount];
+                RangeSummary accumulated;
+                uint32_t objects = 0;
+                for (uint32_t i = binCount - 1; i > 0; --i)
+                {
+                    Merge(&accumulated, axisBins[i].Summary);
+                    objects += axisBins[i].Count;
+                    right[i] = accumulated;
+                    rightCount[i] = objects;
+                }
+                accumulated = {};
+                objects = 0;
+                for (uint32_t i = 1; i < binCount; ++i)
+                {
+                    Merge(&accumulated, axisBins[i - 1].Summary);
+                    objects += axisBins[i - 1].Count;
+                    if (objects == 0 || rightCount[i] == 0)
+                        continue;
+                    float cost = Area(accumulated.Bounds) * objects + Area(right[i].Bounds) * rightCount[i];
+                    if (cost < bestCost)
+                    {
+                        bestCost = cost;
+                        bestAxis = axis;
+                        bestBin = i;
+                        children[0] = accumulated;
+                        children[1] = right[i];
+                    }
+                }
+            }
+
+            float area = Area(task.Summary.Bounds);
+            float splitCost = area > 0.0f ? TraversalCost + bestCost / area : Infinity;
+            Reference* begin = m_References.data() + task.Begin;
+            Reference* end = m_References.data() + task.End;
+            if (bestAxis >= 0 && splitCost < float(count))
+            {
+                float min = Component(centers.Min, bestAxis);
+                float scale = BinScale(centers, bestAxis, binCount);
+                Reference* middle = std::partition(begin, end, [&](const Reference& reference)
+                {
+                    return BinOf(Component(reference.Center, bestAxis), min, scale, binCount) < bestBin;
+                });
+                return static_cast<uint32_t>(middle - m_References.data());
+            }
+            if (count <= MaxLeafObjects)
+                return task.Begin;
+
+            // Too many objects for a leaf and no useful plane: halve along the widest axis
+            Float3 size = Vector3Subtract(centers.Max, centers.Min);
+            int axis = size.x >= size.y && size.x >= size.z ? 0 : size.y >= size.z ? 1 : 2;
+            Reference* middle = begin + count / 2;
+            std::nth_element(begin, middle, end, [axis](const Reference& a, const Reference& b)
+            {
+                return Component(a.Center, axis) < Component(b.Center, axis);
+            });
+            uint32_t split = static_cast<uint32_t>(middle - m_References.data());
+            children[0] = Summarize(jobSystem, task.Begin, split);
+            children[1] = Summarize(jobSystem, split, task.End);
+            return split;
+        }
+
+        static float BinScale(const BvhBox& centers, int axis, uint32_t binCount)
+        {
+            float size = Component(centers.Max, axis) - Component(centers.Min, axis);
+            return size > 0.0f ? binCount / size : 0.0f;
+        }
+
+        static uint32_t BinOf(float center, float min, float scale, uint32_t binCount)
+        {
+            return std::min(binCount - 1, static_cast<uint32_t>((center - min) * scale));
+        }
+
+        // Runs function(begin, end, result) over chunks of the range, on the JobSystem when it is
+        // large, and merges what the chunks found into result
+        template <typename Result, typename Function>
+        void Reduce(JobSystem* jobSystem, uint32_t begin, uint32_t end, Result* result, Function&& function)
+        {
+            size_t count = end - begin;
+            if (!jobSystem || count < ParallelRangeSize)
+            {
+                function(begin, end, result);
+                return;
+            }
+
+            std::vector<Result> partial((count + ChunkSize - 1) / ChunkSize);
+            jobSystem->ParallelFor(partial.size(), 1, [&](size_t first, size_t last, unsigned int)
+            {
+                for (size_t chunk = first; chunk < last; ++chunk)
+                {
+                    uint32_t chunkBegin = static_cast<uint32_t>(begin + chunk * ChunkSize);
+                    function(chunkBegin, std::min(end, static_cast<uint32_t>(chunkBegin + ChunkSize)), &partial[chunk]);
+                }
+            });
+            for (const Result& chunk : partial)
+                Merge(result, chunk);
+        }
+
+        void FillBins(JobSystem* jobSystem, uint32_t begin, uint32_t end, const BvhBox& centers, uint32_t binCount,
+            Bins* bins)
+        {
+            float scales[3] = { BinScale(centers, 0, binCount), BinScale(centers, 1, binCount),
+                BinScale(centers, 2, binCount) };
+            Reduce(jobSystem, begin, end, bins, [&](uint32_t first, uint32_t last, Bins* partial)
+            {
+                for (uint32_t i = first; i < last; ++i)
+                {
+                    const Reference& reference = m_References[i];
+                    Float3 min = ObjectMin(reference.Center, reference.Extents);
+                    Float3 max = ObjectMax(reference.Center, reference.Extents);
+                    for (int axis = 0; axis < 3; ++axis)
+                    {
+                        float center = Component(reference.Center, axis);
+                        Bin& bin = (*partial)[axis * BinCount +
+                            BinOf(center, Component(centers.Min, axis), scales[axis], binCount)];
+                        Grow(&bin.Summary.Bounds, min, max);
+                        Grow(&bin.Summary.Centers, reference.Center, reference.Center);
+                        ++bin.Count;
+                    }
+                }
+            });
+        }
+
+        std::vector<Reference>& m_References;
+    };
+}
+
+void Bvh::Build(JobSystem* jobSystem, const BoundsArray& bounds)
+{
+    size_t objectCount = bounds.GetCount();
+    std::vector<Reference> references(objectCount);
+    for (size_t i = 0; i < objectCount; ++i)
+        references[i] = { bounds.GetCenter(i), bounds.GetExtents(i), static_cast<uint32_t>(i) };
+
+    m_Nodes.clear();
+    m_Depth = 0;
+    if (objectCount > 0)
+    {
+        m_Nodes.reserve(2 * objectCount - 1);
+        m_Nodes.emplace_back();
+        Builder builder(references);
+        uint32_t end = static_cast<uint32_t>(objectCount);
+        BuildTask root = { 0, 0, end, 0, builder.Summarize(jobSystem, 0, end) };
+
+        // The first levels split large ranges with parallel binning, then each worker
+        // takes whole subtrees, which are spliced in after the top
+        unsigned int workers = jobSystem ? jobSystem->GetWorkerCount() : 1;
+        size_t deferSize = std::max<size_t>(ChunkSize, objectCount / (8 * workers));
+        std::vector<BuildTask> deferred;
+        m_Depth = builder.Run(jobSystem, m_Nodes, root, deferSize, workers > 1 ? &deferred : nullptr);
+
+        std::vector<std::vector<BvhNode>> subtrees(deferred.size());
+        std::vector<uint32_t> depths(deferred.size());
+        if (!deferred.empty())
+        {
+            jobSystem->ParallelFor(deferred.size(), 1, [&](size_t first, size_t last, unsigned int)
+            {
+                for (size_t i = first; i < last; ++i)
+                {
+                    subtrees[i].emplace_back();
+                    BuildTask task = deferred[i];
+                    task.Node = 0;
+                    depths[i] = builder.Run(nullptr, subtrees[i], task, 0, nullptr);
+                }
+            });
+        }
+
+        // Local node c > 0 lands at base + c - 1, the local root on the placeholder
+        for (size_t i = 0; i < deferred.size(); ++i)
+        {
+            uint32_t base = static_cast<uint32_t>(m_Nodes.size());
+            for (size_t local = 0; local < subtrees[i].size(); ++local)
+            {
+                BvhNode node = subtrees[i][local];
+                if (!node.IsLeaf())
+                    node.Left = base + node.Left - 1;
+                if (local == 0)
+                    m_Nodes[deferred[i].Node] = node;
+                else
+                    m_Nodes.push_back(node);
+            }
+            m_Depth = std::max(m_Depth, depths[i]);
+        }
+    }
+
+    m_Order.resize(objectCount);
+    m_Positions.resize(objectCount);
+    m_Centers.resize(objectCount);
+    m_Extents.resize(objectCount);
+    for (uint32_t i = 0; i < objectCount; ++i)
+    {
+        m_Order[i] = references[i].Object;
+        m_Positions[references[i].Object] = i;
+        m_Centers[i] = references[i].Center;
+        m_Extents[i] = references[i].Extents;
+    }
+
+    m_Parents.assign(m_Nodes.size(), NoNode);
+    m_ObjectLeaves.resize(objectCount);
+    m_Dirty.assign(m_Nodes.size(), 0);
+    for (uint32_t node = 0; node < m_Nodes.size(); ++node)
+    {
+        const BvhNode& n = m_Nodes[node];
+        if (!n.IsLeaf())
+        {
+            m_Parents[n.Left] = node;
+            m_Parents[n.Left + 1] = node;
+            continue;
+        }
+        for (uint32_t i = n.First; i < n.First + n.Count; ++i)
+            m_ObjectLeaves[m_Order[i]] = node;
+    }
+}
+
+void Bvh::Update(uint32_t object, const Float3& center, const Float3& extents)
+{
+    m_Centers[m_Positions[object]] = center;
+    m_Extents[m_Positions[object]] = extents;
+
+    // Ancestors already marked were marked by an earlier update, and so were theirs
+    for (uint32_t node = m_ObjectLeaves[object]; node != NoNode && !m_Dirty[node]; node = m_Parents[node])
+        m_Dirty[node] = 1;
+}
+
+size_t Bvh::Refit()
+{
+    size_t touched = 0;
+    if (!m_Nodes.empty() && m_Dirty[0])
+        RefitNode(0, &touched);
+    return touched;
+}
+
+void Bvh::RefitNode(uint32_t node, size_t* touched)
+{
+    BvhNode& n = m_Nodes[node];
+    BvhBox bounds = EmptyBox();
+    if (n.IsLeaf())
+    {
+        for (uint32_t i = n.First; i < n.First + n.Count; ++i)
+            Grow(&bounds, ObjectMin(m_Centers[i], m_Extents[i]), ObjectMax(m_Centers[i], m_Extents[i]));
+    }
+    else
+    {
+        for (uint32_t child = n.Left; child < n.Left + 2; ++child)
+        {
+            if (m_Dirty[child])
+                RefitNode(child, touched);
+            Grow(&bounds, m_Nodes[child].Bounds.Min, m_Nodes[child].Bounds.Max);
+        }
+    }
+    n.Bounds = bounds;
+    m_Dirty[node] = 0;
+    ++*touched;
+}
+
+void Bvh::CullFrustum(const Frustum& frustum, std::vector<uint32_t>* visible) const
+{
+    visible->clear();
+    if (m_Nodes.empty())
+        return;
+
+    // Planes a node is entirely inside are dropped for its subtree; with none left the
+    // whole range is visible
+    struct Item
+    {
+        uint32_t Node;
+        uint32_t Planes;
+    };
+    Item stack[StackSize];
+    size_t top = 0;
+    stack[top++] = { 0, 0x3F };
+    while (top > 0)
+    {
+        Item item = stack[--top];
+        const BvhNode& node = m_Nodes[item.Node];
+        uint32_t planes = item.Planes;
+        bool outside = false;
+        for (int p = 0; p < 6 && !outside; ++p)
+        {
+            if (!(planes & (1u << p)))
+                continue;
+
+            // The corners farthest along and against the normal
+            const Float4& plane = frustum.Planes[p];
+            const BvhBox& b = node.Bounds;
+            float farthest = plane.x * (plane.x >= 0.0f ? b.Max.x : b.Min.x) +
+                plane.y * (plane.y >= 0.0f ? b.Max.y : b.Min.y) + plane.z * (plane.z >= 0.0f ? b.Max.z : b.Min.z) +
+                plane.w;
+            float nearest = plane.x * (plane.x >= 0.0f ? b.Min.x : b.Max.x) +
+                plane.y * (plane.y >= 0.0f ? b.Min.y : b.Max.y) + plane.z * (plane.z >= 0.0f ? b.Min.z : b.Max.z) +
+                plane.w;
+            outside = farthest < 0.0f;
+            if (nearest >= 0.0f)
+                planes &= ~(1u << p);
+        }
+        if (outside)
+            continue;
+
+        if (planes == 0)
+        {
+            visible->insert(visible->end(), m_Order.begin() + node.First, m_Order.begin() + node.First + node.Count);
+        }
+        else if (node.IsLeaf())
+        {
+            // The same test as CullBoundsScalar, against the planes left
+            for (uint32_t i = node.First; i < node.First + node.Count; ++i)
+            {
+                const Float3& c = m_Centers[i];
+                const Float3& e = m_Extents[i];
+                bool inside = true;
+                for (int p = 0; p < 6; ++p)
+                {
+                    const Float4& plane = frustum.Planes[p];
+                    float d = plane.x * c.x + plane.y * c.y + plane.z * c.z + plane.w;
+                    float r = std::fabs(plane.x) * e.x + std::fabs(plane.y) * e.y + std::fabs(plane.z) * e.z;
+                    inside &= !(planes & (1u << p)) || d + r >= 0.0f;
+                }
+                if (inside)
+                    visible->push_back(m_Order[i]);
+            }
+        }
+        else
+        {
+            stack[top++] = { node.Left + 1, planes };
+            stack[top++] = { node.Left, planes };
+        }
+    }
+}
+
+bool Bvh::Raycast(const Float3& origin, const Float3& direction, float maxDistance, BvhRayHit* hit) const
+{
+    *hit = {};
+    if (m_Nodes.empty())
+        return false;
+
+    Float3 inverse = { 1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z };
+    float closest = maxDistance;
+    struct Item
+    {
+        uint32_t Node;
+        float Entry;
+    };
+    Item stack[StackSize];
+    size_t top = 0;
+    float rootEntry = RayEntry(m_Nodes[0].Bounds, origin, inverse, closest);
+    if (rootEntry != Infinity)
+        stack[top++] = { 0, rootEntry };
+    while (top > 0)
+    {
+        Item item = stack[--top];
+        if (item.Entry > closest)
+            continue;
+
+        const BvhNode& node = m_Nodes[item.Node];
+        if (node.IsLeaf())
+        {
+            for (uint32_t i = node.First; i < node.First + node.Count; ++i)
+            {
+                BvhBox box = { ObjectMin(m_Centers[i], m_Extents[i]), ObjectMax(m_Centers[i], m_Extents[i]) };
+                float entry = RayEntry(box, origin, inverse, closest);
+                if (entry < Infinity && (hit->Object == BvhRayHit::NoObject || entry < closest))
+                {
+                    closest = entry;
+                    hit->Object = m_Order[i];
+                    hit->Distance = entry;
+                }
+            }
+            continue;
+        }
+
+        // Nearer child on top of the stack
+        float left = RayEntry(m_Nodes[node.Left].Bounds, origin, inverse, closest);
+        float right = RayEntry(m_Nodes[node.Left + 1].Bounds, origin, inverse, closest);
+        Item nearer = { node.Left, left }, farther = { node.Left + 1, right };
+        if (right < left)
+            std::swap(nearer, farther);
+        if (farther.Entry != Infinity)
+            stack[top++] = farther;
+        if (nearer.Entry != Infinity)
+            stack[top++] = nearer;
+    }
+    return hit->Object != BvhRayHit::NoObject;
+}
+
+void Bvh::QueryBox(const BvhBox& box, std::vector<uint32_t>* objects) const
+{
+    objects->clear();
+    if (m_Nodes.empty())
+        return;
+
+    uint32_t stack[StackSize];
+    size_t top = 0;
+    stack[top++] = 0;
+    while (top > 0)
+    {
+        const BvhNode& node = m_Nodes[stack[--top]];
+        if (!Overlaps(node.Bounds, box))
+            continue;
+
+        if (Contains(box, node.Bounds))
+        {
+            objects->insert(objects->end(), m_Order.begin() + node.First, m_Order.begin() + node.First + node.Count);
+        }
+        else if (node.IsLeaf())
+        {
+            for (uint32_t i = node.First; i < node.First + node.Count; ++i)
+            {
+                BvhBox objectBox = { ObjectMin(m_Centers[i], m_Extents[i]), ObjectMax(m_Centers[i], m_Extents[i]) };
+                if (Overlaps(objectBox, box))
+                    objects->push_back(m_Order[i]);
+            }
+        }
+        else
+        {
+            stack[top++] = node.Left + 1;
+            stack[top++] = node.Left;
+        }
+    }
+}
+
+double Bvh::GetCost() const
+{
+    if (m_Nodes.empty() || Area(m_Nodes[0].Bounds) <= 0.0f)
+        return 0.0;
+
+    double cost = 0.0;
+    for (const BvhNode& node : m_Nodes)
+        cost += double(Area(node.Bounds)) * (node.IsLeaf() ? node.Count : TraversalCost);
+    return cost / Area(m_Nodes[0].Bounds);
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+// Bounding volume hierarchy over the world-space boxes of many objects, for
+// scenes where testing every object (FrustumCulling's flat list) no longer
+// scales. Build splits top-down with a binned surface area heuristic; below
+// the first levels the subtrees are built in parallel on a JobSystem. Objects
+// that move (like the orbiting cubes of "09. Transformations") are updated in
+// place and Refit then recomputes the boxes of their ancestors only, leaving
+// clean subtrees alone. Refit keeps the tree valid but not optimal, so scenes
+// that move far should rebuild from time to time (compare GetCost()).
+//
+// Each node covers a contiguous range of the object order, so a subtree found
+// entirely inside a query is reported without visiting its leaves.
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "FrustumCulling.h"
+#include "MathUtil.h"
+
+class JobSystem;
+
+struct BvhBox
+{
+    Float3 Min;
+    Float3 Max;
+};
+
+struct BvhNode
+{
+    BvhBox Bounds;
+    uint32_t Left = 0;      // First of two adjacent children, 0 for a leaf (the root is never a child)
+    uint32_t First = 0;     // Range of GetObjectOrder() covered by the subtree
+    uint32_t Count = 0;
+
+    bool IsLeaf() const { return Left == 0; }
+};
+
+struct BvhRayHit
+{
+    static constexpr uint32_t NoObject = ~0u;
+
+    uint32_t Object = NoObject;
+    float Distance = 0.0f;
+};
+
+class Bvh
+{
+public:
+    static constexpr uint32_t NoNode = ~0u;
+
+    // Builds over every box of bounds; jobSystem may be null to build on the calling thread
+    void Build(JobSystem* jobSystem, const BoundsArray& bounds);
+
+    // Moves one object; the tree is updated by the next Refit
+    void Update(uint32_t object, const Float3& center, const Float3& extents);
+    // Recomputes the boxes of the nodes above updated objects and returns how many it touched
+    size_t Refit();
+
+    // Objects whose boxes are not fully outside a plane, in tree order
+    void CullFrustum(const Frustum& frustum, std::vector<uint32_t>* visible) const;
+    // Closest object box hit by origin + t * direction for t in [0, maxDistance]
+    bool Raycast(const Float3& origin, const Float3& direction, float maxDistance, BvhRayHit* hit) const;
+    // Objects whose boxes overlap [min, max]
+    void QueryBox(const BvhBox& box, std::vector<uint32_t>* objects) const;
+
+    size_t GetObjectCount() const { return m_Centers.size(); }
+    const std::vector<BvhNode>& GetNodes() const { return m_Nodes; }
+    const std::vector<uint32_t>& GetObjectOrder() const { return m_Order; }
+    uint32_t GetParent(uint32_t node) const { return m_Parents[node]; }
+    uint32_t GetDepth() const { return m_Depth; }
+
+    // Surface area cost of the tree relative to its root: the expected number of node and
+    // object tests of a random ray, which grows as refits loosen the boxes
+    double GetCost() const;
+
+    // Deepest level a build creates; ranges that reach it become leaves whatever their size
+    static constexpr uint32_t MaxDepth = 64;
+
+private:
+    void RefitNode(uint32_t node, size_t* touched);
+
+    std::vector<BvhNode> m_Nodes;
+    std::vector<uint32_t> m_Order;          // Object indices in leaf order
+    std::vector<uint32_t> m_Positions;      // Index of each object in m_Order
+    std::vector<Float3> m_Centers;          // Boxes in leaf order, so leaves read them in sequence
+    std::vector<Float3> m_Extents;
+    std::vector<uint32_t> m_Parents;
+    std::vector<uint32_t> m_ObjectLeaves;
+    std::vector<uint8_t> m_Dirty;
+    uint32_t m_Depth = 0;
+};
@@ -0,0 +1,399 @@
+#include "CommandBuffer.h"
+
+#include <cstring>
+
+#include "ConstantBufferRing.h"
+
+namespace
+{
+    enum Command : uint32_t
+    {
+        ClearRenderTargetCommand,
+        ClearDepthStencilCommand,
+        SetViewportCommand,
+        SetRasterizerStateCommand,
+        SetVertexShaderCommand,
+        SetPixelShaderCommand,
+        SetVertexBufferCommand,
+        SetIndexBufferCommand,
+        SetVSConstantBufferCommand,
+        SetPSConstantBufferCommand,
+        UpdateBufferCommand,
+        UpdateBufferRangeCommand,
+        AllocateConstantsCommand,
+        SetVSConstantBufferRangeCommand,
+        SetPSConstantBufferRangeCommand,
+        DrawIndexedCommand,
+        DrawIndexedInstancedCommand,
+    };
+
+    // Every command starts with this header; Size covers the arguments and the
+    // payload, padded so the next header stays 4-byte aligned
+    struct CommandHeader
+    {
+        uint32_t Command;
+        uint32_t Size;
+    };
+
+    struct ClearDepthStencilArgs
+    {
+        float Depth;
+        uint32_t Stencil;
+    };
+
+    struct VertexBufferArgs
+    {
+        uint32_t Slot;
+        BufferHandle Buffer;
+        uint32_t Stride;
+        uint32_t Offset;
+    };
+
+    struct IndexBufferArgs
+    {
+        BufferHandle Buffer;
+        Format IndexFormat;
+        uint32_t Offset;
+    };
+
+    struct ConstantBufferArgs
+    {
+        uint32_t Slot;
+        BufferHandle Buffer;
+    };
+
+    struct UpdateBufferArgs
+    {
+        BufferHandle Buffer;
+        uint32_t Size;
+    };
+
+    struct UpdateBufferRangeArgs
+    {
+        BufferHandle Buffer;
+        uint32_t Offset;
+        uint32_t Size;
+    };
+
+    struct ConstantBufferRangeArgs
+    {
+        uint32_t Slot;
+        ConstantBufferRange Range;
+    };
+
+    struct DrawIndexedArgs
+    {
+        uint32_t IndexCount;
+        uint32_t StartIndexLocation;
+        int32_t BaseVertexLocation;
+    };
+
+    struct DrawIndexedInstancedArgs
+    {
+        uint32_t IndexCountPerInstance;
+        uint32_t InstanceCount;
+        uint32_t StartIndexLocation;
+        int32_t BaseVertexLocation;
+        uint32_t StartInstanceLocation;
+    };
+
+    template <typename Args>
+    Args Read(const uint8_t* data)
+    {
+        Args args;
+        std::memcpy(&args, data, sizeof(Args));
+        return args;
+    }
+
+    // Placeholder ranges carry their allocation index in Offset
+    ConstantBufferRange ResolveRange(const ConstantBufferRange& range, const std::vector<ConstantBufferRange>& constants)
+    {
+        if (range.Buffer.Id != CommandBufferContext::ConstantsBufferId)
+            return range;
+        uint32_t index = range.Offset / ConstantBufferRing::Alignment;
+        return index < constants.size() ? constants[index] : ConstantBufferRange{};
+    }
+}
+
+void CommandBuffer::Clear()
+{
+    m_Data.clear();
+    m_CommandCount = 0;
+    m_ConstantCount = 0;
+}
+
+void CommandBuffer::Replay(RenderContext& context, std::vector<ConstantBufferRange>* constants) const
+{
+    constants->clear();
+    constants->reserve(m_ConstantCount);
+
+    const uint8_t* data = m_Data.data();
+    const uint8_t* end = data + m_Data.size();
+    while (data < end)
+    {
+        CommandHeader header = Read<CommandHeader>(data);
+        const uint8_t* args = data + sizeof(CommandHeader);
+        data = args + header.Size;
+
+        switch (header.Command)
+        {
+        case ClearRenderTargetCommand:
+        {
+            float color[4];
+            std::memcpy(color, args, sizeof(color));
+            context.ClearRenderTarget(color);
+            break;
+        }
+        case ClearDepthStencilCommand:
+        {
+            ClearDepthStencilArgs clear = Read<ClearDepthStencilArgs>(args);
+            context.ClearDepthStencil(clear.Depth, static_cast<uint8_t>(clear.Stencil));
+            break;
+        }
+        case SetViewportCommand:
+            context.SetViewport(Read<Viewport>(args));
+            break;
+        case SetRasterizerStateCommand:
+            context.SetRasterizerState(Read<RasterizerStateHandle>(args));
+            break;
+        case SetVertexShaderCommand:
+            context.SetVertexShader(Read<VertexShaderHandle>(args));
+            break;
+        case SetPixelShaderCommand:
+            context.SetPixelShader(Read<PixelShaderHandle>(args));
+            break;
+        case SetVertexBufferCommand:
+        {
+            VertexBufferArgs vertexBuffer = Read<VertexBufferArgs>(args);
+            context.SetVertexBuffer(vertexBuffer.Slot, vertexBuffer.Buffer, vertexBuffer.Stride, vertexBuffer.Offset);
+            break;
+        }
+        case SetIndexBufferCommand:
+        {
+            IndexBufferArgs indexBuffer = Read<IndexBufferArgs>(args);
+            context.SetIndexBuffer(indexBuffer.Buffer, indexBuffer.IndexFormat, indexBuffer.Offset);
+            break;
+        }
+        case SetVSConstantBufferCommand:
+        {
+            ConstantBufferArgs constantBuffer = Read<ConstantBufferArgs>(args);
+            context.SetVSConstantBuffer(constantBuffer.Slot, constantBuffer.Buffer);
+            break;
+        }
+        case SetPSConstantBufferCommand:
+        {
+            ConstantBufferArgs constantBuffer = Read<ConstantBufferArgs>(args);
+            context.SetPSConstantBuffer(constantBuffer.Slot, constantBuffer.Buffer);
+            break;
+        }
+        case UpdateBufferCommand:
+        {
+            UpdateBufferArgs update = Read<UpdateBufferArgs>(args);
+            context.UpdateBuffer(update.Buffer, args + sizeof(UpdateBufferArgs), update.Size);
+            break;
+        }
+        case UpdateBufferRangeCommand:
+        {
+            UpdateBufferRangeArgs update = Read<UpdateBufferRangeArgs>(args);
+            context.UpdateBufferRange(update.Buffer, update.Offset, args + sizeof(UpdateBufferRangeArgs), update.Size);
+            break;
+        }
+        case AllocateConstantsCommand:
+        {
+            uint32_t size = Read<uint32_t>(args);
+            constants->push_back(context.AllocateConstants(args + sizeof(uint32_t), size));
+            break;
+        }
+        case SetVSConstantBufferRangeCommand:
+        {
+            ConstantBufferRangeArgs range = Read<ConstantBufferRangeArgs>(args);
+            context.SetVSConstantBufferRange(range.Slot, ResolveRange(range.Range, *constants));
+            break;
+        }
+        case SetPSConstantBufferRangeCommand:
+        {
+            ConstantBufferRangeArgs range = Read<ConstantBufferRangeArgs>(args);
+            context.SetPSConstantBufferRange(range.Slot, ResolveRange(range.Range, *constants));
+            break;
+        }
+        case DrawIndexedCommand:
+        {
+            DrawIndexedArgs draw = Read<DrawIndexedArgs>(args);
+            context.DrawIndexed(draw.IndexCount, draw.StartIndexLocation, draw.BaseVertexLocation);
+            break;
+        }
+        case DrawIndexedInstancedCommand:
+        {
+            DrawIndexedInstancedArgs draw = Read<DrawIndexedInstancedArgs>(args);
+            context.DrawIndexedInstanced(draw.IndexCountPerInstance, draw.InstanceCount, draw.StartIndexLocation,
+                draw.BaseVertexLocation, draw.StartInstanceLocation);
+            break;
+        }
+        }
+    }
+}
+
+CommandBufferContext::CommandBufferContext()
+    : m_Buffer(std::make_unique<CommandBuffer>())
+{
+}
+
+template <typename Args>
+void CommandBufferContext::Write(uint32_t command, const Args& args, const void* payload, uint32_t payloadSize)
+{
+    static_assert(sizeof(Args) % 4 == 0, "Command arguments must keep the stream 4-byte aligned");
+
+    CommandHeader header = { command, static_cast<uint32_t>(sizeof(Args)) + ((payloadSize + 3) & ~3u) };
+    std::vector<uint8_t>& data = m_Buffer->m_Data;
+    size_t position = data.size();
+    data.resize(position + sizeof(CommandHeader) + header.Size);
+
+    uint8_t* destination = data.data() + position;
+    std::memcpy(destination, &header, sizeof(CommandHeader));
+    std::memcpy(destination + sizeof(CommandHeader), &args, sizeof(Args));
+    if (payloadSize)
+        std::memcpy(destination + sizeof(CommandHeader) + sizeof(Args), payload, payloadSize);
+    ++m_Buffer->m_CommandCount;
+}
+
+void CommandBufferContext::ClearRenderTarget(const float color[4])
+{
+    float args[4] = { color[0], color[1], color[2], color[3] };
+    Write(ClearRenderTargetCommand, args);
+}
+
+void CommandBufferContext::ClearDepthStencil(float depth, uint8_t stencil)
+{
+    Write(ClearDepthStencilCommand, ClearDepthStencilArgs{ depth, stencil });
+}
+
+void CommandBufferContext::SetViewport(const Viewport& viewport)
+{
+    Write(SetViewportCommand, viewport);
+    ++m_Stats.StateChanges;
+}
+
+void CommandBufferContext::SetRasterizerState(RasterizerStateHandle state)
+{
+    Write(SetRasterizerStateCommand, state);
+    ++m_Stats.StateChanges;
+}
+
+void CommandBufferContext::SetVertexShader(VertexShaderHandle shader)
+{
+    Write(SetVertexShaderCommand, shader);
+    ++m_Stats.StateChanges;
+}
+
+void CommandBufferContext::SetPixelShader(PixelShaderHandle shader)
+{
+    Write(SetPixelShaderCommand, shader);
+    ++m_Stats.StateChanges;
+}
+
+void CommandBufferContext::SetVertexBuffer(uint32_t slot, BufferHandle buffer, uint32_t stride, uint32_t offset)
+{
+    Write(SetVertexBufferCommand, VertexBufferArgs{ slot, buffer, stride, offset });
+    ++m_Stats.StateChanges;
+}
+
+void CommandBufferContext::SetIndexBuffer(BufferHandle buffer, Format format, uint32_t offset)
+{
+    Write(SetIndexBufferCommand, IndexBufferArgs{ buffer, format, offset });
+    ++m_Stats.StateChanges;
+}
+
+void CommandBufferContext::SetVSConstantBuffer(uint32_t slot, BufferHandle buffer)
+{
+    Write(SetVSConstantBufferCommand, ConstantBufferArgs{ slot, buffer });
+    ++m_Stats.StateChanges;
+}
+
+void CommandBufferContext::SetPSConstantBuffer(uint32_t slot, BufferHandle buffer)
+{
+    Write(SetPSConstantBufferCommand, ConstantBufferArgs{ slot, buffer });
+    ++m_Stats.StateChanges;
+}
+
+void CommandBufferContext::UpdateBuffer(BufferHandle buffer, const void* data, uint32_t size)
+{
+    Write(UpdateBufferCommand, UpdateBufferArgs{ buffer, size }, data, size);
+    ++m_Stats.BufferUpdates;
+    m_Stats.BytesUploaded += size;
+}
+
+void CommandBufferContext::UpdateBufferRange(BufferHandle buffer, uint32_t offset, const void* data, uint32_t size)
+{
+    Write(UpdateBufferRangeCommand, UpdateBufferRangeArgs{ buffer, offset, size }, data, size);
+    ++m_Stats.BufferUpdates;
+    m_Stats.BytesUploaded += size;
+}
+
+ConstantBufferRange CommandBufferContext::AllocateConstants(const void* data, uint32_t size)
+{
+    if (size == 0 || size > MaxConstantBufferSize)
+        return {};
+
+    Write(AllocateConstantsCommand, size, data, size);
+    ++m_Stats.BufferUpdates;
+    m_Stats.BytesUploaded += size;
+
+    ConstantBufferRange range;
+    range.Buffer.Id = ConstantsBufferId;
+    range.Offset = m_Buffer->m_ConstantCount++ * ConstantBufferRing::Alignment;
+    range.Size = ConstantBufferRing::AlignSize(size);
+    return range;
+}
+
+void CommandBufferContext::SetVSConstantBufferRange(uint32_t slot, const ConstantBufferRange& range)
+{
+    Write(SetVSConstantBufferRangeCommand, ConstantBufferRangeArgs{ slot, range });
+    ++m_Stats.StateChanges;
+}
+
+void CommandBufferContext::SetPSConstantBufferRange(uint32_t slot, const ConstantBufferRange& range)
+{
+    Write(SetPSConstantBufferRangeCommand, ConstantBufferRangeArgs{ slot, range });
+    ++m_Stats.StateChanges;
+}
+
+void CommandBufferContext::DrawIndexed(uint32_t indexCount, uint32_t startIndexLocation, int32_t baseVertexLocation)
+{
+    Write(DrawIndexedCommand, DrawIndexedArgs{ indexCount, startIndexLocation, baseVertexLocation });
+    ++m_Stats.Draws;
+    m_Stats.Indices += indexCount;
+    ++m_Stats.Instances;
+}
+
+void CommandBufferContext::DrawIndexedInstanced(uint32_t indexCountPerInstance, uint32_t instanceCount,
+    uint32_t startIndexLocation, int32_t baseVertexLocation, uint32_t startInstanceLocation)
+{
+    Write(DrawIndexedInstancedCommand, DrawIndexedInstancedArgs{ indexCountPerInstance, instanceCount,
+        startIndexLocation, baseVertexLocation, startInstanceLocation });
+    ++m_Stats.Draws;
+    m_Stats.Indices += static_cast<uint64_t>(indexCountPerInstance) * instanceCount;
+    m_Stats.Instances += instanceCount;
+}
+
+void CommandBufferContext::BeginCommandList()
+{
+    // The executing context resets its state before replaying, so nothing needs recording here
+    m_Buffer->Clear();
+    m_Stats = {};
+}
+
+bool CommandBufferContext::FinishCommandList(std::unique_ptr<CommandList>& list)
+{
+    // Trade buffers with a list that already belongs to us, so steady-state recording does not allocate
+    std::unique_ptr<CommandBuffer> recycled;
+    if (dynamic_cast<CommandBuffer*>(list.get()))
+        recycled.reset(static_cast<CommandBuffer*>(list.release()));
+    else
+        recycled = std::make_unique<CommandBuffer>();
+
+    list = std::move(m_Buffer);
+    m_Buffer = std::move(recycled);
+    m_Buffer->Clear();
+    m_Stats = {};
+    return true;
+}
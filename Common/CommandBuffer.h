@@ -0,0 +1,81 @@
+#pragma once
+
+// Portable deferred context. CommandBufferContext records every RenderContext
+// call into a flat byte stream instead of touching the device, so any number
+// of them can record on worker threads at once; the CPU backends replay the
+// stream on their immediate context in ExecuteCommandList. Constants and
+// buffer updates are copied into the stream, so the caller's memory can be
+// reused as soon as the call returns, just like with a D3D11 deferred context.
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "RenderDevice.h"
+
+class CommandBuffer final : public CommandList
+{
+public:
+    void Clear();
+
+    size_t GetSize() const { return m_Data.size(); }
+    uint32_t GetCommandCount() const { return m_CommandCount; }
+
+    // Issues the recorded calls on context in recording order. Constants are allocated
+    // again on context; constants receives their ranges and is reused between replays.
+    void Replay(RenderContext& context, std::vector<ConstantBufferRange>* constants) const;
+
+private:
+    friend class CommandBufferContext;
+
+    std::vector<uint8_t> m_Data;
+    uint32_t m_CommandCount = 0;
+    uint32_t m_ConstantCount = 0;
+};
+
+class CommandBufferContext final : public RenderContext
+{
+public:
+    CommandBufferContext();
+
+    void ClearRenderTarget(const float color[4]) override;
+    void ClearDepthStencil(float depth, uint8_t stencil) override;
+    void SetViewport(const Viewport& viewport) override;
+
+    void SetRasterizerState(RasterizerStateHandle state) override;
+    void SetVertexShader(VertexShaderHandle shader) override;
+    void SetPixelShader(PixelShaderHandle shader) override;
+
+    void SetVertexBuffer(uint32_t slot, BufferHandle buffer, uint32_t stride, uint32_t offset) override;
+    void SetIndexBuffer(BufferHandle buffer, Format format, uint32_t offset) override;
+    void SetVSConstantBuffer(uint32_t slot, BufferHandle buffer) override;
+    void SetPSConstantBuffer(uint32_t slot, BufferHandle buffer) override;
+
+    void UpdateBuffer(BufferHandle buffer, const void* data, uint32_t size) override;
+    void UpdateBufferRange(BufferHandle buffer, uint32_t offset, const void* data, uint32_t size) override;
+
+    // The returned range only means something to this context's Set*ConstantBufferRange;
+    // replay swaps it for a range allocated on the executing context
+    ConstantBufferRange AllocateConstants(const void* data, uint32_t size) override;
+    void SetVSConstantBufferRange(uint32_t slot, const ConstantBufferRange& range) override;
+    void SetPSConstantBufferRange(uint32_t slot, const ConstantBufferRange& range) override;
+
+    void DrawIndexed(uint32_t indexCount, uint32_t startIndexLocation, int32_t baseVertexLocation) override;
+    void DrawIndexedInstanced(uint32_t indexCountPerInstance, uint32_t instanceCount, uint32_t startIndexLocation,
+        int32_t baseVertexLocation, uint32_t startInstanceLocation) override;
+
+    void BeginCommandList() override;
+    bool FinishCommandList(std::unique_ptr<CommandList>& list) override;
+
+    // The list being recorded
+    const CommandBuffer& GetCommandBuffer() const { return *m_Buffer; }
+
+    // Buffer id of the placeholder ranges returned by AllocateConstants
+    static constexpr uint32_t ConstantsBufferId = UINT32_MAX;
+
+private:
+    template <typename Args>
+    void Write(uint32_t command, const Args& args, const void* payload = nullptr, uint32_t payloadSize = 0);
+
+    std::unique_ptr<CommandBuffer> m_Buffer;
+};
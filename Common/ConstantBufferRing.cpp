@@ -0,0 +1,74 @@
+#include "ConstantBufferRing.h"
+
+ConstantBufferRing::ConstantBufferRing(uint32_t capacity)
+{
+    Reset(capacity);
+}
+
+void ConstantBufferRing::Reset(uint32_t capacity)
+{
+    m_Capacity = capacity & ~(Alignment - 1);
+    m_Head = 0;
+    m_Used = 0;
+    m_FrameBytes = 0;
+    m_Frames.clear();
+}
+
+bool ConstantBufferRing::Allocate(uint32_t size, uint32_t* offset)
+{
+    uint32_t alignedSize = AlignSize(size);
+    if (size == 0 || alignedSize > m_Capacity || alignedSize < size)
+    {
+        ++m_Stats.Failures;
+        return false;
+    }
+
+    // Nothing in flight: start over at the front instead of wrapping later
+    if (m_Used == 0)
+        m_Head = 0;
+
+    // Everything between the head and the end is skipped when the request does not fit there
+    uint32_t skipped = (m_Head + alignedSize > m_Capacity) ? m_Capacity - m_Head : 0;
+    if (m_Used + skipped + alignedSize > m_Capacity)
+    {
+        ++m_Stats.Failures;
+        return false;
+    }
+
+    if (skipped)
+    {
+        m_Head = 0;
+        ++m_Stats.Wraps;
+    }
+
+    *offset = m_Head;
+    m_Head += alignedSize;
+    if (m_Head == m_Capacity)
+    {
+        m_Head = 0;
+        ++m_Stats.Wraps;
+    }
+
+    m_Used += skipped + alignedSize;
+    m_FrameBytes += skipped + alignedSize;
+    ++m_Stats.Allocations;
+    m_Stats.AllocatedBytes += alignedSize;
+    return true;
+}
+
+void ConstantBufferRing::EndFrame()
+{
+    if (m_FrameBytes)
+        m_Frames.push_back({ m_FrameIndex, m_FrameBytes });
+    m_FrameBytes = 0;
+    ++m_FrameIndex;
+}
+
+void ConstantBufferRing::RetireFrames(uint64_t completedFrame)
+{
+    while (!m_Frames.empty() && m_Frames.front().FrameIndex <= completedFrame)
+    {
+        m_Used -= m_Frames.front().Bytes;
+        m_Frames.pop_front();
+    }
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+// Sub-allocator for a large dynamic constant buffer shared by every draw of a
+// frame. Allocations are 256-byte aligned (the 16-constant granularity of
+// VSSetConstantBuffers1 offsets) and handed out front to back; when the end is
+// reached the ring wraps to the start. Space is reclaimed a frame at a time:
+// EndFrame closes the current frame and RetireFrames releases frames the GPU
+// has finished with, so an allocation never overwrites data still in flight.
+// Only offsets are managed here; the backend owns the memory and the mapping.
+
+#include <cstdint>
+#include <deque>
+
+struct ConstantBufferRingStats
+{
+    uint64_t Allocations = 0;
+    uint64_t AllocatedBytes = 0;
+    uint64_t Wraps = 0;         // Times the head went back to the front
+    uint64_t Failures = 0;
+};
+
+class ConstantBufferRing
+{
+public:
+    static constexpr uint32_t Alignment = 256;
+
+    // capacity is rounded down to a multiple of Alignment
+    explicit ConstantBufferRing(uint32_t capacity = 0);
+
+    // Forgets every allocation and frame, e.g. after a WRITE_DISCARD or a new buffer
+    void Reset(uint32_t capacity);
+    void Reset() { Reset(m_Capacity); }
+
+    // Reserves size bytes (rounded up to Alignment) for the current frame. Returns
+    // false when that would overwrite a frame that has not been retired yet.
+    bool Allocate(uint32_t size, uint32_t* offset);
+
+    // Closes the current frame; its allocations stay reserved until retired
+    void EndFrame();
+    // Releases every closed frame with index <= completedFrame
+    void RetireFrames(uint64_t completedFrame);
+
+    // Index of the frame being recorded, starting at 0
+    uint64_t GetFrameIndex() const { return m_FrameIndex; }
+    uint32_t GetCapacity() const { return m_Capacity; }
+    uint32_t GetUsedBytes() const { return m_Used; }
+    uint32_t GetFramesInFlight() const { return static_cast<uint32_t>(m_Frames.size()); }
+
+    const ConstantBufferRingStats& GetStats() const { return m_Stats; }
+    void ResetStats() { m_Stats = {}; }
+
+    static uint32_t AlignSize(uint32_t size) { return (size + Alignment - 1) & ~(Alignment - 1); }
+
+private:
+    struct FrameRange
+    {
+        uint64_t FrameIndex;
+        uint32_t Bytes;     // Allocations plus the space skipped when wrapping
+    };
+
+    uint32_t m_Capacity = 0;
+    uint32_t m_Head = 0;
+    uint32_t m_Used = 0;
+    uint32_t m_FrameBytes = 0;
+    uint64_t m_FrameIndex = 0;
+    std::deque<FrameRange> m_Frames;
+    ConstantBufferRingStats m_Stats;
+};
@@ -0,0 +1,380 @@
+#include "CpuRenderDevice.h"
+
+#include <cstring>
+
+namespace
+{
+    template <typename T>
+    T* Lookup(std::vector<T>& table, uint32_t id)
+    {
+        return (id == 0 || id > table.size()) ? nullptr : &table[id - 1];
+    }
+
+    template <typename T>
+    const T* Lookup(const std::vector<T>& table, uint32_t id)
+    {
+        return (id == 0 || id > table.size()) ? nullptr : &table[id - 1];
+    }
+}
+
+bool CpuRenderDevice::CreateBuffer(const BufferDesc& desc, const void* initialData, BufferHandle* buffer)
+{
+    if (desc.ByteWidth == 0 || !buffer)
+        return false;
+
+    // Same rule as D3D11: an immutable buffer has to be initialized at creation
+    if (desc.Usage == BufferUsage::Immutable && !initialData)
+        return false;
+
+    CpuBuffer newBuffer;
+    newBuffer.Desc = desc;
+    newBuffer.Data.resize(desc.ByteWidth);
+    if (initialData)
+        std::memcpy(newBuffer.Data.data(), initialData, desc.ByteWidth);
+
+    m_Buffers.push_back(std::move(newBuffer));
+    buffer->Id = static_cast<uint32_t>(m_Buffers.size());
+    return true;
+}
+
+void CpuRenderDevice::ReleaseBuffer(BufferHandle buffer)
+{
+    if (CpuBuffer* entry = GetBuffer(buffer))
+    {
+        entry->Desc.ByteWidth = 0;
+        std::vector<uint8_t>().swap(entry->Data);
+    }
+}
+
+bool CpuRenderDevice::CreateVertexShader(const ShaderDesc& desc, VertexShaderHandle* shader)
+{
+    if (!shader || desc.EntryPoint.empty() || desc.InputLayout.empty() || !ValidateVertexShader(desc))
+        return false;
+
+    m_VertexShaders.push_back(desc);
+    shader->Id = static_cast<uint32_t>(m_VertexShaders.size());
+    return true;
+}
+
+bool CpuRenderDevice::CreatePixelShader(const ShaderDesc& desc, PixelShaderHandle* shader)
+{
+    if (!shader || desc.EntryPoint.empty())
+        return false;
+
+    m_PixelShaders.push_back(desc);
+    shader->Id = static_cast<uint32_t>(m_PixelShaders.size());
+    return true;
+}
+
+bool CpuRenderDevice::CreateRasterizerState(const RasterizerDesc& desc, RasterizerStateHandle* state)
+{
+    if (!state)
+        return false;
+
+    auto create = [this](const RasterizerDesc& newDesc, RasterizerStateHandle* newState)
+    {
+        m_RasterizerStates.push_back(newDesc);
+        newState->Id = static_cast<uint32_t>(m_RasterizerStates.size());
+        return true;
+    };
+
+    const RasterizerStateHandle* cached = m_RasterizerStateCache.GetOrCreate(desc, create);
+    if (!cached)
+        return false;
+
+    *state = *cached;
+    return true;
+}
+
+bool CpuRenderDevice::GetRasterizerDesc(RasterizerStateHandle state, RasterizerDesc* desc) const
+{
+    const RasterizerDesc* found = Lookup(m_RasterizerStates, state.Id);
+    if (!found || !desc)
+        return false;
+
+    *desc = *found;
+    return true;
+}
+
+bool CpuRenderDevice::Resize(uint32_t width, uint32_t height)
+{
+    if (width == 0 || height == 0)
+        return false;
+
+    m_Width = width;
+    m_Height = height;
+    return true;
+}
+
+RenderContext* CpuRenderDevice::CreateDeferredContext()
+{
+    m_DeferredContexts.push_back(std::make_unique<CommandBufferContext>());
+    return m_DeferredContexts.back().get();
+}
+
+CpuBuffer* CpuRenderDevice::GetBuffer(BufferHandle buffer)
+{
+    // Released buffers keep their slot with a zero ByteWidth
+    CpuBuffer* entry = Lookup(m_Buffers, buffer.Id);
+    return entry && entry->Desc.ByteWidth ? entry : nullptr;
+}
+
+const ShaderDesc* CpuRenderDevice::GetVertexShader(VertexShaderHandle shader) const
+{
+    return Lookup(m_VertexShaders, shader.Id);
+}
+
+const ShaderDesc* CpuRenderDevice::GetPixelShader(PixelShaderHandle shader) const
+{
+    return Lookup(m_PixelShaders, shader.Id);
+}
+
+CpuRenderContext::CpuRenderContext(CpuRenderDevice& device)
+    : m_Device(device)
+{
+}
+
+void CpuRenderContext::ClearRenderTarget(const float[4])
+{
+}
+
+void CpuRenderContext::ClearDepthStencil(float, uint8_t)
+{
+}
+
+void CpuRenderContext::SetViewport(const Viewport& viewport)
+{
+    m_State.View = viewport;
+    ++m_Stats.StateChanges;
+}
+
+void CpuRenderContext::SetRasterizerState(RasterizerStateHandle state)
+{
+    m_State.RasterizerState = state;
+    ++m_Stats.StateChanges;
+}
+
+void CpuRenderContext::SetVertexShader(VertexShaderHandle shader)
+{
+    m_State.VertexShader = shader;
+    ++m_Stats.StateChanges;
+}
+
+void CpuRenderContext::SetPixelShader(PixelShaderHandle shader)
+{
+    m_State.PixelShader = shader;
+    ++m_Stats.StateChanges;
+}
+
+void CpuRenderContext::SetVertexBuffer(uint32_t slot, BufferHandle buffer, uint32_t stride, uint32_t offset)
+{
+    if (slot >= CpuPipelineState::MaxVertexBuffers)
+        return;
+
+    m_State.VertexBuffers[slot] = buffer;
+    m_State.VertexStrides[slot] = stride;
+    m_State.VertexOffsets[slot] = offset;
+    ++m_Stats.StateChanges;
+}
+
+void CpuRenderContext::SetIndexBuffer(BufferHandle buffer, Format format, uint32_t offset)
+{
+    m_State.IndexBuffer = buffer;
+    m_State.IndexFormat = format;
+    m_State.IndexOffset = offset;
+    ++m_Stats.StateChanges;
+}
+
+void CpuRenderContext::SetVSConstantBuffer(uint32_t slot, BufferHandle buffer)
+{
+    if (slot >= CpuPipelineState::MaxConstantBuffers)
+        return;
+
+    m_State.VSConstantBuffers[slot] = buffer;
+    m_State.VSConstantOffsets[slot] = 0;
+    ++m_Stats.StateChanges;
+}
+
+void CpuRenderContext::SetPSConstantBuffer(uint32_t slot, BufferHandle buffer)
+{
+    if (slot >= CpuPipelineState::MaxConstantBuffers)
+        return;
+
+    m_State.PSConstantBuffers[slot] = buffer;
+    m_State.PSConstantOffsets[slot] = 0;
+    ++m_Stats.StateChanges;
+}
+
+void CpuRenderContext::UpdateBuffer(BufferHandle buffer, const void* data, uint32_t size)
+{
+    CpuBuffer* target = m_Device.GetBuffer(buffer);
+    if (!target || target->Desc.Usage == BufferUsage::Immutable || size > target->Desc.ByteWidth)
+        return;
+
+    if (target->Desc.Bind != BufferBind::ConstantBuffer)
+        OnBufferWrite(buffer);
+
+    std::memcpy(target->Data.data(), data, size);
+    ++m_Stats.BufferUpdates;
+    m_Stats.BytesUploaded += size;
+}
+
+void CpuRenderContext::UpdateBufferRange(BufferHandle buffer, uint32_t offset, const void* data, uint32_t size)
+{
+    CpuBuffer* target = m_Device.GetBuffer(buffer);
+    if (!target || target->Desc.Usage == BufferUsage::Immutable || offset > target->Desc.ByteWidth ||
+        size > target->Desc.ByteWidth - offset)
+    {
+        return;
+    }
+
+    if (target->Desc.Bind != BufferBind::ConstantBuffer)
+        OnBufferWrite(buffer);
+
+    std::memcpy(target->Data.data() + offset, data, size);
+    ++m_Stats.BufferUpdates;
+    m_Stats.BytesUploaded += size;
+}
+
+ConstantBufferRange CpuRenderContext::AllocateConstants(const void* data, uint32_t size)
+{
+    if (size == 0 || size > MaxConstantBufferSize)
+        return {};
+
+    if (!m_ConstantRingBuffer)
+    {
+        BufferDesc desc;
+        desc.ByteWidth = ConstantRingSize;
+        desc.Bind = BufferBind::ConstantBuffer;
+        desc.Usage = BufferUsage::Dynamic;
+        if (!m_Device.CreateBuffer(desc, nullptr, &m_ConstantRingBuffer))
+            return {};
+        m_ConstantRing.Reset(ConstantRingSize);
+    }
+
+    // A full ring only holds constants of draws that were already consumed, so start over
+    uint32_t offset;
+    if (!m_ConstantRing.Allocate(size, &offset))
+    {
+        m_ConstantRing.Reset();
+        if (!m_ConstantRing.Allocate(size, &offset))
+            return {};
+    }
+
+    std::memcpy(m_Device.GetBuffer(m_ConstantRingBuffer)->Data.data() + offset, data, size);
+    ++m_Stats.BufferUpdates;
+    m_Stats.BytesUploaded += size;
+
+    ConstantBufferRange range;
+    range.Buffer = m_ConstantRingBuffer;
+    range.Offset = offset;
+    range.Size = ConstantBufferRing::AlignSize(size);
+    return range;
+}
+
+void CpuRenderContext::SetVSConstantBufferRange(uint32_t slot, const ConstantBufferRange& range)
+{
+    if (slot >= CpuPipelineState::MaxConstantBuffers)
+        return;
+
+    m_State.VSConstantBuffers[slot] = range.Buffer;
+    m_State.VSConstantOffsets[slot] = range.Offset;
+    ++m_Stats.StateChanges;
+}
+
+void CpuRenderContext::SetPSConstantBufferRange(uint32_t slot, const ConstantBufferRange& range)
+{
+    if (slot >= CpuPipelineState::MaxConstantBuffers)
+        return;
+
+    m_State.PSConstantBuffers[slot] = range.Buffer;
+    m_State.PSConstantOffsets[slot] = range.Offset;
+    ++m_Stats.StateChanges;
+}
+
+bool CpuRenderContext::ExecuteCommandList(const CommandList& list)
+{
+    const CommandBuffer* commands = dynamic_cast<const CommandBuffer*>(&list);
+    if (!commands)
+        return false;
+
+    // Same contract as ExecuteCommandList(list, FALSE) on D3D11: the list cannot see
+    // the state bound before it, and leaves none of its own behind
+    ResetPipelineState();
+    commands->Replay(*this, &m_ReplayConstants);
+    ResetPipelineState();
+    return true;
+}
+
+void CpuRenderContext::ResetPipelineState()
+{
+    m_State = {};
+    m_State.View = m_Device.GetDefaultViewport();
+}
+
+void CpuRenderContext::EndFrame()
+{
+    m_ConstantRing.EndFrame();
+    m_ConstantRing.RetireFrames(m_ConstantRing.GetFrameIndex() - 1);
+}
+
+bool CpuRenderContext::ValidateDraw(uint32_t indexCount, uint32_t startIndexLocation, int32_t baseVertexLocation,
+    uint32_t instanceCount, uint32_t startInstanceLocation) const
+{
+    // Reject what the D3D11 debug layer would flag instead of reading out of bounds
+    const CpuBuffer* indexBuffer = m_Device.GetBuffer(m_State.IndexBuffer);
+    const ShaderDesc* vertexShader = m_Device.GetVertexShader(m_State.VertexShader);
+    uint32_t indexSize = GetFormatSize(m_State.IndexFormat);
+    if (!indexBuffer || indexSize == 0 || !vertexShader || !m_Device.GetPixelShader(m_State.PixelShader) ||
+        !m_Device.GetBuffer(m_State.VertexBuffers[0]))
+        return false;
+
+    uint64_t lastByte = m_State.IndexOffset + (static_cast<uint64_t>(startIndexLocation) + indexCount) * indexSize;
+    if (lastByte > indexBuffer->Data.size() || baseVertexLocation < 0)
+        return false;
+
+    // Every per-instance element must fit in its slot for the last instance drawn
+    for (const InputElementDesc& element : vertexShader->InputLayout)
+    {
+        if (!element.PerInstance)
+            continue;
+
+        const CpuBuffer* instanceBuffer = element.InputSlot < CpuPipelineState::MaxVertexBuffers ?
+            m_Device.GetBuffer(m_State.VertexBuffers[element.InputSlot]) : nullptr;
+        if (!instanceBuffer)
+            return false;
+
+        uint32_t stepRate = element.InstanceDataStepRate ? element.InstanceDataStepRate : 1;
+        uint64_t lastElement = startInstanceLocation + (static_cast<uint64_t>(instanceCount) + stepRate - 1) / stepRate;
+        uint64_t lastElementByte = m_State.VertexOffsets[element.InputSlot] +
+            (lastElement - 1) * m_State.VertexStrides[element.InputSlot] + element.AlignedByteOffset +
+            GetFormatSize(element.ElementFormat);
+        if (instanceCount && lastElementByte > instanceBuffer->Data.size())
+            return false;
+    }
+    return true;
+}
+
+void CpuRenderContext::DrawIndexed(uint32_t indexCount, uint32_t startIndexLocation, int32_t baseVertexLocation)
+{
+    if (!ValidateDraw(indexCount, startIndexLocation, baseVertexLocation, 1, 0))
+        return;
+
+    ++m_Stats.Draws;
+    m_Stats.Indices += indexCount;
+    ++m_Stats.Instances;
+    OnDrawIndexed(indexCount, startIndexLocation, baseVertexLocation);
+}
+
+void CpuRenderContext::DrawIndexedInstanced(uint32_t indexCountPerInstance, uint32_t instanceCount,
+    uint32_t startIndexLocation, int32_t baseVertexLocation, uint32_t startInstanceLocation)
+{
+    if (!ValidateDraw(indexCountPerInstance, startIndexLocation, baseVertexLocation, instanceCount, startInstanceLocation))
+        return;
+
+    ++m_Stats.Draws;
+    m_Stats.Indices += static_cast<uint64_t>(indexCountPerInstance) * instanceCount;
+    m_Stats.Instances += instanceCount;
+    OnDrawIndexedInstanced(indexCountPerInstance, instanceCount, startIndexLocation, baseVertexLocation,
+        startInstanceLocation);
+}
@@ -0,0 +1,143 @@
+#pragma once
+
+// Shared base for the backends that keep resources in system memory
+// (NullRenderDevice and SoftwareRenderDevice). Resources live in plain
+// tables indexed by handle, and the context tracks the bound pipeline state
+// the way the D3D11 runtime would.
+
+#include <memory>
+#include <vector>
+
+#include "CommandBuffer.h"
+#include "ConstantBufferRing.h"
+#include "RenderDevice.h"
+#include "StateCache.h"
+
+struct CpuBuffer
+{
+    BufferDesc Desc;
+    std::vector<uint8_t> Data;
+};
+
+class CpuRenderDevice : public RenderDevice
+{
+public:
+    bool CreateBuffer(const BufferDesc& desc, const void* initialData, BufferHandle* buffer) override;
+    void ReleaseBuffer(BufferHandle buffer) override;
+    bool CreateVertexShader(const ShaderDesc& desc, VertexShaderHandle* shader) override;
+    bool CreatePixelShader(const ShaderDesc& desc, PixelShaderHandle* shader) override;
+    bool CreateRasterizerState(const RasterizerDesc& desc, RasterizerStateHandle* state) override;
+    bool GetRasterizerDesc(RasterizerStateHandle state, RasterizerDesc* desc) const override;
+
+    bool Resize(uint32_t width, uint32_t height) override;
+    uint32_t GetWidth() const override { return m_Width; }
+    uint32_t GetHeight() const override { return m_Height; }
+
+    // A CommandBufferContext; its lists run on the immediate context by replaying them
+    RenderContext* CreateDeferredContext() override;
+
+    CpuBuffer* GetBuffer(BufferHandle buffer);
+    const ShaderDesc* GetVertexShader(VertexShaderHandle shader) const;
+    const ShaderDesc* GetPixelShader(PixelShaderHandle shader) const;
+
+protected:
+    // Lets a backend refuse vertex shaders it cannot emulate
+    virtual bool ValidateVertexShader(const ShaderDesc&) const { return true; }
+
+    uint32_t m_Width = 0;
+    uint32_t m_Height = 0;
+
+private:
+    std::vector<CpuBuffer> m_Buffers;
+    std::vector<ShaderDesc> m_VertexShaders;
+    std::vector<ShaderDesc> m_PixelShaders;
+    std::vector<RasterizerDesc> m_RasterizerStates;
+    StateCache<RasterizerDesc, RasterizerStateHandle> m_RasterizerStateCache;
+    std::vector<std::unique_ptr<CommandBufferContext>> m_DeferredContexts;
+};
+
+// Pipeline state bound on a CpuRenderContext
+struct CpuPipelineState
+{
+    static constexpr uint32_t MaxVertexBuffers = 2;
+    static constexpr uint32_t MaxConstantBuffers = 4;
+
+    RasterizerStateHandle RasterizerState;
+    VertexShaderHandle VertexShader;
+    PixelShaderHandle PixelShader;
+    BufferHandle VertexBuffers[MaxVertexBuffers];
+    uint32_t VertexStrides[MaxVertexBuffers] = {};
+    uint32_t VertexOffsets[MaxVertexBuffers] = {};
+    BufferHandle IndexBuffer;
+    Format IndexFormat = Format::Unknown;
+    uint32_t IndexOffset = 0;
+    BufferHandle VSConstantBuffers[MaxConstantBuffers];
+    BufferHandle PSConstantBuffers[MaxConstantBuffers];
+    // Byte offset of the bound window, non-zero only for ranges of the constant ring
+    uint32_t VSConstantOffsets[MaxConstantBuffers] = {};
+    uint32_t PSConstantOffsets[MaxConstantBuffers] = {};
+    Viewport View;
+};
+
+class CpuRenderContext : public RenderContext
+{
+public:
+    explicit CpuRenderContext(CpuRenderDevice& device);
+
+    void ClearRenderTarget(const float color[4]) override;
+    void ClearDepthStencil(float depth, uint8_t stencil) override;
+    void SetViewport(const Viewport& viewport) override;
+
+    void SetRasterizerState(RasterizerStateHandle state) override;
+    void SetVertexShader(VertexShaderHandle shader) override;
+    void SetPixelShader(PixelShaderHandle shader) override;
+
+    void SetVertexBuffer(uint32_t slot, BufferHandle buffer, uint32_t stride, uint32_t offset) override;
+    void SetIndexBuffer(BufferHandle buffer, Format format, uint32_t offset) override;
+    void SetVSConstantBuffer(uint32_t slot, BufferHandle buffer) override;
+    void SetPSConstantBuffer(uint32_t slot, BufferHandle buffer) override;
+
+    void UpdateBuffer(BufferHandle buffer, const void* data, uint32_t size) override;
+    void UpdateBufferRange(BufferHandle buffer, uint32_t offset, const void* data, uint32_t size) override;
+
+    ConstantBufferRange AllocateConstants(const void* data, uint32_t size) override;
+    void SetVSConstantBufferRange(uint32_t slot, const ConstantBufferRange& range) override;
+    void SetPSConstantBufferRange(uint32_t slot, const ConstantBufferRange& range) override;
+
+    void DrawIndexed(uint32_t indexCount, uint32_t startIndexLocation, int32_t baseVertexLocation) override;
+    void DrawIndexedInstanced(uint32_t indexCountPerInstance, uint32_t instanceCount, uint32_t startIndexLocation,
+        int32_t baseVertexLocation, uint32_t startInstanceLocation) override;
+
+    // Replays a CommandBuffer from the device's deferred contexts
+    bool ExecuteCommandList(const CommandList& list) override;
+
+    const CpuPipelineState& GetPipelineState() const { return m_State; }
+    const ConstantBufferRing& GetConstantRing() const { return m_ConstantRing; }
+
+    // Called by the device's Present. Constants are consumed when a draw is recorded,
+    // so a CPU backend can reuse the whole ring as soon as the frame ends.
+    void EndFrame();
+
+    static constexpr uint32_t ConstantRingSize = 1 << 20;
+
+protected:
+    // Called for every draw that passed validation
+    virtual void OnDrawIndexed(uint32_t, uint32_t, int32_t) {}
+    virtual void OnDrawIndexedInstanced(uint32_t, uint32_t, uint32_t, int32_t, uint32_t) {}
+    // Called before a vertex or index buffer is overwritten
+    virtual void OnBufferWrite(BufferHandle) {}
+
+    CpuRenderDevice& m_Device;
+    CpuPipelineState m_State;
+
+private:
+    ConstantBufferRing m_ConstantRing;
+    BufferHandle m_ConstantRingBuffer;
+    std::vector<ConstantBufferRange> m_ReplayConstants;
+
+    // Default pipeline state with the full-target viewport, what a command list starts from
+    void ResetPipelineState();
+
+    bool ValidateDraw(uint32_t indexCount, uint32_t startIndexLocation, int32_t baseVertexLocation,
+        uint32_t instanceCount, uint32_t startInstanceLocation) const;
+};
@@ -0,0 +1,47 @@
+#pragma once
+
+// The 8-vertex / 36-index colored cube shared by tutorials 07 to 10
+
+#include <cstdint>
+
+#include "RenderTypes.h"
+#include "Vertex.h"
+
+inline constexpr Vertex CubeVertices[] =
+{
+    { { -1.0f, -1.0f, -1.0f }, { 0.0f, 0.0f, 1.0f, 1.0f } },
+    { { -1.0f,  1.0f, -1.0f }, { 0.0f, 1.0f, 0.0f, 1.0f } },
+    { {  1.0f,  1.0f, -1.0f }, { 0.0f, 1.0f, 1.0f, 1.0f } },
+    { {  1.0f, -1.0f, -1.0f }, { 1.0f, 0.0f, 0.0f, 1.0f } },
+    { { -1.0f, -1.0f,  1.0f }, { 1.0f, 0.0f, 1.0f, 1.0f } },
+    { { -1.0f,  1.0f,  1.0f }, { 1.0f, 1.0f, 0.0f, 1.0f } },
+    { {  1.0f,  1.0f,  1.0f }, { 1.0f, 1.0f, 1.0f, 1.0f } },
+    { {  1.0f, -1.0f,  1.0f }, { 0.0f, 0.0f, 0.0f, 1.0f } },
+};
+
+inline constexpr uint16_t CubeIndices[] =
+{
+    3,1,0,
+    2,1,3,
+
+    0,5,4,
+    1,5,0,
+
+    3,4,7,
+    0,4,3,
+
+    1,6,5,
+    2,6,1,
+
+    2,7,6,
+    3,7,2,
+
+    6,4,5,
+    7,4,6,
+};
+
+inline constexpr uint32_t CubeVertexCount = sizeof(CubeVertices) / sizeof(CubeVertices[0]);
+inline constexpr uint32_t CubeIndexCount = sizeof(CubeIndices) / sizeof(CubeIndices[0]);
+
+// Follows the element type of CubeIndices, for SetIndexBuffer
+inline constexpr Format CubeIndexFormat = sizeof(CubeIndices[0]) == 2 ? Format::R16UInt : Format::R32UInt;
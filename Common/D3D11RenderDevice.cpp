@@ -0,0 +1,949 @@
+#pragma comment(lib, "d3d11.lib")
+#pragma comment(lib, "dxgi.lib")
+#pragma comment(lib, "d3dcompiler.lib")
+
+#include "D3D11RenderDevice.h"
+
+#include <d3dcompiler.h>
+
+#include <cstring>
+#include <string>
+
+#include "ShaderCache.h"
+
+using namespace Microsoft::WRL;
+
+namespace
+{
+    DXGI_FORMAT ToDXGIFormat(Format format)
+    {
+        switch (format)
+        {
+        case Format::R32G32B32Float: return DXGI_FORMAT_R32G32B32_FLOAT;
+        case Format::R32G32B32A32Float: return DXGI_FORMAT_R32G32B32A32_FLOAT;
+        case Format::R16G16B16A16SNorm: return DXGI_FORMAT_R16G16B16A16_SNORM;
+        case Format::R16G16B16A16Float: return DXGI_FORMAT_R16G16B16A16_FLOAT;
+        case Format::R16G16SNorm: return DXGI_FORMAT_R16G16_SNORM;
+        case Format::R8G8B8A8UNorm: return DXGI_FORMAT_R8G8B8A8_UNORM;
+        case Format::R16UInt: return DXGI_FORMAT_R16_UINT;
+        case Format::R32UInt: return DXGI_FORMAT_R32_UINT;
+        default: return DXGI_FORMAT_UNKNOWN;
+        }
+    }
+
+    template <typename T>
+    const T* Lookup(const std::vector<T>& table, uint32_t id)
+    {
+        return (id == 0 || id > table.size()) ? nullptr : &table[id - 1];
+    }
+
+    // D3D_SHADER_MACRO array for desc.Defines, terminated by a null entry
+    std::vector<D3D_SHADER_MACRO> GetShaderMacros(const ShaderDesc& desc)
+    {
+        std::vector<D3D_SHADER_MACRO> macros;
+        for (const ShaderDefine& define : desc.Defines)
+            macros.push_back({ define.Name.c_str(), define.Value.c_str() });
+        macros.push_back({ nullptr, nullptr });
+        return macros;
+    }
+
+    bool CompileShader(const ShaderDesc& desc, ComPtr<ID3DBlob>& blob)
+    {
+        std::wstring fileName(desc.FileName.begin(), desc.FileName.end());
+        std::vector<D3D_SHADER_MACRO> macros = GetShaderMacros(desc);
+        ComPtr<ID3DBlob> errors;
+        HRESULT hr = D3DCompileFromFile(fileName.c_str(), macros.data(), D3D_COMPILE_STANDARD_FILE_INCLUDE,
+            desc.EntryPoint.c_str(), desc.Profile.c_str(), desc.CompileFlags, 0, &blob, &errors);
+        if (FAILED(hr))
+        {
+            if (errors)
+                OutputDebugStringA(static_cast<const char*>(errors->GetBufferPointer()));
+            return false;
+        }
+        return true;
+    }
+
+    // Opens #include files relative to the shader's directory and records every path
+    // so the shader cache can tell when one of them changes
+    class RecordingInclude final : public ID3DInclude
+    {
+    public:
+        RecordingInclude(std::string directory, std::vector<std::string>* includes)
+            : m_Directory(std::move(directory)), m_Includes(includes)
+        {
+        }
+
+        HRESULT __stdcall Open(D3D_INCLUDE_TYPE, LPCSTR pFileName, LPCVOID, LPCVOID* ppData, UINT* pBytes) override
+        {
+            std::string path = m_Directory + pFileName;
+            std::string text;
+            if (!ReadTextFile(path, &text))
+                return E_FAIL;
+
+            char* data = new char[text.size()];
+            std::memcpy(data, text.data(), text.size());
+            *ppData = data;
+            *pBytes = static_cast<UINT>(text.size());
+            m_Includes->push_back(path);
+            return S_OK;
+        }
+
+        HRESULT __stdcall Close(LPCVOID pData) override
+        {
+            delete[] static_cast<const char*>(pData);
+            return S_OK;
+        }
+
+    private:
+        std::string m_Directory;
+        std::vector<std::string>* m_Includes;
+    };
+
+    class D3DShaderCompiler final : public ShaderCompiler
+    {
+    public:
+        std::string GetVersion() const override { return "d3dcompiler_" + std::to_string(D3D_COMPILER_VERSION); }
+
+        bool Compile(const ShaderDesc& desc, const std::string& source, std::vector<uint8_t>* bytecode,
+            std::vector<std::string>* includes, std::string* errors) override
+        {
+            size_t slash = desc.FileName.find_last_of("/\\");
+            RecordingInclude include(slash == std::string::npos ? std::string() : desc.FileName.substr(0, slash + 1),
+                includes);
+            std::vector<D3D_SHADER_MACRO> macros = GetShaderMacros(desc);
+
+            ComPtr<ID3DBlob> blob;
+            ComPtr<ID3DBlob> errorBlob;
+            HRESULT hr = D3DCompile(source.data(), source.size(), desc.FileName.c_str(), macros.data(), &include,
+                desc.EntryPoint.c_str(), desc.Profile.c_str(), desc.CompileFlags, 0, &blob, &errorBlob);
+            if (errorBlob)
+                errors->assign(static_cast<const char*>(errorBlob->GetBufferPointer()), errorBlob->GetBufferSize());
+            if (FAILED(hr))
+                return false;
+
+            const uint8_t* data = static_cast<const uint8_t*>(blob->GetBufferPointer());
+            bytecode->assign(data, data + blob->GetBufferSize());
+            return true;
+        }
+    };
+}
+
+namespace
+{
+    class D3D11CommandList final : public CommandList
+    {
+    public:
+        ComPtr<ID3D11CommandList> List;
+        // What the deferred context counted while recording, added to the immediate context's stats
+        RenderStats Stats;
+    };
+}
+
+D3D11RenderContext::D3D11RenderContext(D3D11RenderDevice& device, bool deferred)
+    : m_Device(device)
+    , m_Deferred(deferred)
+{
+}
+
+void D3D11RenderContext::SetDeviceContext(ID3D11DeviceContext1* context, bool constantBufferOffsetting)
+{
+    m_Context = context;
+    m_ConstantBufferOffsetting = constantBufferOffsetting;
+
+    // A new device starts with an empty ring; its buffer is rebuilt with the other resources
+    m_ConstantRing.Reset();
+    m_ConstantRingNeedsDiscard = true;
+}
+
+void D3D11RenderContext::ClearRenderTarget(const float color[4])
+{
+    if (ID3D11RenderTargetView* rtv = m_Device.GetRenderTargetView())
+        m_Context->ClearRenderTargetView(rtv, color);
+}
+
+void D3D11RenderContext::ClearDepthStencil(float depth, uint8_t stencil)
+{
+    if (ID3D11DepthStencilView* dsv = m_Device.GetDepthStencilView())
+        m_Context->ClearDepthStencilView(dsv, D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, depth, stencil);
+}
+
+void D3D11RenderContext::SetViewport(const Viewport& viewport)
+{
+    D3D11_VIEWPORT vp = { viewport.TopLeftX, viewport.TopLeftY, viewport.Width, viewport.Height,
+        viewport.MinDepth, viewport.MaxDepth };
+    m_Context->RSSetViewports(1, &vp);
+    ++m_Stats.StateChanges;
+}
+
+void D3D11RenderContext::SetRasterizerState(RasterizerStateHandle state)
+{
+    m_Context->RSSetState(m_Device.GetRasterizerState(state));
+    ++m_Stats.StateChanges;
+}
+
+void D3D11RenderContext::SetVertexShader(VertexShaderHandle shader)
+{
+    // The input layout belongs to the vertex shader it was validated against
+    ID3D11InputLayout* inputLayout = nullptr;
+    ID3D11VertexShader* vertexShader = m_Device.GetVertexShader(shader, &inputLayout);
+    m_Context->IASetInputLayout(inputLayout);
+    m_Context->VSSetShader(vertexShader, nullptr, 0);
+    m_Context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+    ++m_Stats.StateChanges;
+}
+
+void D3D11RenderContext::SetPixelShader(PixelShaderHandle shader)
+{
+    m_Context->PSSetShader(m_Device.GetPixelShader(shader), nullptr, 0);
+    ++m_Stats.StateChanges;
+}
+
+void D3D11RenderContext::SetVertexBuffer(uint32_t slot, BufferHandle buffer, uint32_t stride, uint32_t offset)
+{
+    ID3D11Buffer* vertexBuffer = m_Device.GetBuffer(buffer);
+    UINT strides[] = { stride };
+    UINT offsets[] = { offset };
+    m_Context->IASetVertexBuffers(slot, 1, &vertexBuffer, strides, offsets);
+    ++m_Stats.StateChanges;
+}
+
+void D3D11RenderContext::SetIndexBuffer(BufferHandle buffer, Format format, uint32_t offset)
+{
+    m_Context->IASetIndexBuffer(m_Device.GetBuffer(buffer), ToDXGIFormat(format), offset);
+    ++m_Stats.StateChanges;
+}
+
+void D3D11RenderContext::SetVSConstantBuffer(uint32_t slot, BufferHandle buffer)
+{
+    ID3D11Buffer* constantBuffer = m_Device.GetBuffer(buffer);
+    m_Context->VSSetConstantBuffers(slot, 1, &constantBuffer);
+    ++m_Stats.StateChanges;
+}
+
+void D3D11RenderContext::SetPSConstantBuffer(uint32_t slot, BufferHandle buffer)
+{
+    ID3D11Buffer* constantBuffer = m_Device.GetBuffer(buffer);
+    m_Context->PSSetConstantBuffers(slot, 1, &constantBuffer);
+    ++m_Stats.StateChanges;
+}
+
+void D3D11RenderContext::UpdateBuffer(BufferHandle buffer, const void* data, uint32_t size)
+{
+    ID3D11Buffer* target = m_Device.GetBuffer(buffer);
+    if (!target)
+        return;
+
+    if (m_Device.GetBufferUsage(buffer) == BufferUsage::Dynamic)
+    {
+        D3D11_MAPPED_SUBRESOURCE mapped;
+        if (FAILED(m_Context->Map(target, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped)))
+            return;
+        memcpy(mapped.pData, data, size);
+        m_Context->Unmap(target, 0);
+    }
+    else
+    {
+        m_Context->UpdateSubresource(target, 0, nullptr, data, 0, 0);
+    }
+
+    ++m_Stats.BufferUpdates;
+    m_Stats.BytesUploaded += size;
+}
+
+void D3D11RenderContext::UpdateBufferRange(BufferHandle buffer, uint32_t offset, const void* data, uint32_t size)
+{
+    ID3D11Buffer* target = m_Device.GetBuffer(buffer);
+    if (!target || size == 0)
+        return;
+
+    D3D11_BUFFER_DESC desc;
+    target->GetDesc(&desc);
+    if (offset > desc.ByteWidth || size > desc.ByteWidth - offset)
+        return;
+
+    if (m_Device.GetBufferUsage(buffer) == BufferUsage::Dynamic)
+    {
+        D3D11_MAPPED_SUBRESOURCE mapped;
+        if (FAILED(m_Context->Map(target, 0, D3D11_MAP_WRITE_NO_OVERWRITE, 0, &mapped)))
+            return;
+        memcpy(static_cast<uint8_t*>(mapped.pData) + offset, data, size);
+        m_Context->Unmap(target, 0);
+    }
+    else
+    {
+        D3D11_BOX box = { offset, 0, 0, offset + size, 1, 1 };
+        m_Context->UpdateSubresource(target, 0, &box, data, 0, 0);
+    }
+
+    ++m_Stats.BufferUpdates;
+    m_Stats.BytesUploaded += size;
+}
+
+ConstantBufferRange D3D11RenderContext::AllocateConstants(const void* data, uint32_t size)
+{
+    if (size == 0 || size > MaxConstantBufferSize)
+        return {};
+
+    if (!m_ConstantRingBuffer && (m_Deferred || !CreateConstantRing()))
+        return {};
+
+    uint32_t offset = 0;
+    bool discard = m_ConstantRingNeedsDiscard || !m_ConstantBufferOffsetting || !m_ConstantRing.Allocate(size, &offset);
+    if (discard)
+    {
+        // The driver hands out fresh memory, so every earlier range stays intact for the GPU
+        m_ConstantRing.Reset();
+        if (!m_ConstantRing.Allocate(size, &offset))
+            return {};
+    }
+
+    ID3D11Buffer* ringBuffer = m_Device.GetBuffer(m_ConstantRingBuffer);
+    D3D11_MAPPED_SUBRESOURCE mapped;
+    if (FAILED(m_Context->Map(ringBuffer, 0, discard ? D3D11_MAP_WRITE_DISCARD : D3D11_MAP_WRITE_NO_OVERWRITE, 0, &mapped)))
+        return {};
+    memcpy(static_cast<uint8_t*>(mapped.pData) + offset, data, size);
+    m_Context->Unmap(ringBuffer, 0);
+    m_ConstantRingNeedsDiscard = false;
+
+    ++m_Stats.BufferUpdates;
+    m_Stats.BytesUploaded += size;
+
+    ConstantBufferRange range;
+    range.Buffer = m_ConstantRingBuffer;
+    range.Offset = offset;
+    range.Size = ConstantBufferRing::AlignSize(size);
+    return range;
+}
+
+bool D3D11RenderContext::CreateConstantRing()
+{
+    if (m_ConstantRingBuffer)
+        return true;
+
+    // Without offsets the whole buffer is bound, so it must not exceed one constant buffer
+    BufferDesc desc;
+    desc.ByteWidth = m_ConstantBufferOffsetting ? ConstantRingSize : MaxConstantBufferSize;
+    desc.Bind = BufferBind::ConstantBuffer;
+    desc.Usage = BufferUsage::Dynamic;
+    if (!m_Device.CreateBuffer(desc, nullptr, &m_ConstantRingBuffer))
+        return false;
+    m_ConstantRing.Reset(desc.ByteWidth);
+    m_ConstantRingNeedsDiscard = true;
+    return true;
+}
+
+void D3D11RenderContext::SetVSConstantBufferRange(uint32_t slot, const ConstantBufferRange& range)
+{
+    ID3D11Buffer* constantBuffer = m_Device.GetBuffer(range.Buffer);
+    if (m_ConstantBufferOffsetting)
+    {
+        // Offsets and sizes are counted in 16-byte constants
+        UINT firstConstant = range.Offset / 16;
+        UINT numConstants = range.Size / 16;
+        m_Context->VSSetConstantBuffers1(slot, 1, &constantBuffer, &firstConstant, &numConstants);
+    }
+    else
+    {
+        m_Context->VSSetConstantBuffers(slot, 1, &constantBuffer);
+    }
+    ++m_Stats.StateChanges;
+}
+
+void D3D11RenderContext::SetPSConstantBufferRange(uint32_t slot, const ConstantBufferRange& range)
+{
+    ID3D11Buffer* constantBuffer = m_Device.GetBuffer(range.Buffer);
+    if (m_ConstantBufferOffsetting)
+    {
+        UINT firstConstant = range.Offset / 16;
+        UINT numConstants = range.Size / 16;
+        m_Context->PSSetConstantBuffers1(slot, 1, &constantBuffer, &firstConstant, &numConstants);
+    }
+    else
+    {
+        m_Context->PSSetConstantBuffers(slot, 1, &constantBuffer);
+    }
+    ++m_Stats.StateChanges;
+}
+
+void D3D11RenderContext::EndFrame()
+{
+    // Present blocks once MaxFrameLatency frames are queued, so anything older
+    // than that has been consumed by the GPU
+    m_ConstantRing.EndFrame();
+    uint64_t frameIndex = m_ConstantRing.GetFrameIndex();
+    if (frameIndex > MaxFrameLatency + 1)
+        m_ConstantRing.RetireFrames(frameIndex - MaxFrameLatency - 2);
+}
+
+void D3D11RenderContext::DrawIndexed(uint32_t indexCount, uint32_t startIndexLocation, int32_t baseVertexLocation)
+{
+    m_Context->DrawIndexed(indexCount, startIndexLocation, baseVertexLocation);
+    ++m_Stats.Draws;
+    m_Stats.Indices += indexCount;
+    ++m_Stats.Instances;
+}
+
+void D3D11RenderContext::DrawIndexedInstanced(uint32_t indexCountPerInstance, uint32_t instanceCount,
+    uint32_t startIndexLocation, int32_t baseVertexLocation, uint32_t startInstanceLocation)
+{
+    m_Context->DrawIndexedInstanced(indexCountPerInstance, instanceCount, startIndexLocation, baseVertexLocation,
+        startInstanceLocation);
+    ++m_Stats.Draws;
+    m_Stats.Indices += static_cast<uint64_t>(indexCountPerInstance) * instanceCount;
+    m_Stats.Instances += instanceCount;
+}
+
+void D3D11RenderContext::BeginCommandList()
+{
+    // A deferred context starts every list with nothing bound
+    if (m_Deferred)
+        BindDefaultTargets();
+}
+
+bool D3D11RenderContext::FinishCommandList(std::unique_ptr<CommandList>& list)
+{
+    if (!m_Deferred)
+        return false;
+
+    D3D11CommandList* d3dList = dynamic_cast<D3D11CommandList*>(list.get());
+    if (!d3dList)
+    {
+        list = std::make_unique<D3D11CommandList>();
+        d3dList = static_cast<D3D11CommandList*>(list.get());
+    }
+
+    // FALSE clears the deferred context's state, which also drops its references to the back buffer
+    d3dList->List.Reset();
+    HRESULT hr = m_Context->FinishCommandList(FALSE, &d3dList->List);
+    d3dList->Stats = m_Stats;
+    m_Stats = {};
+
+    // The first Map of every list has to discard, after which the ring can start from the front again
+    m_ConstantRing.Reset();
+    m_ConstantRingNeedsDiscard = true;
+    return SUCCEEDED(hr);
+}
+
+bool D3D11RenderContext::ExecuteCommandList(const CommandList& list)
+{
+    const D3D11CommandList* d3dList = dynamic_cast<const D3D11CommandList*>(&list);
+    if (m_Deferred || !d3dList || !d3dList->List)
+        return false;
+
+    // FALSE leaves the immediate context in its default state, so rebind the targets the tutorials rely on
+    m_Context->ExecuteCommandList(d3dList->List.Get(), FALSE);
+    BindDefaultTargets();
+    m_Stats += d3dList->Stats;
+    return true;
+}
+
+void D3D11RenderContext::BindDefaultTargets()
+{
+    ID3D11RenderTargetView* rtv = m_Device.GetRenderTargetView();
+    m_Context->OMSetRenderTargets(1, &rtv, m_Device.GetDepthStencilView());
+
+    D3D11_VIEWPORT vp = { 0.0f, 0.0f, static_cast<float>(m_Device.GetWidth()), static_cast<float>(m_Device.GetHeight()),
+        0.0f, 1.0f };
+    m_Context->RSSetViewports(1, &vp);
+}
+
+D3D11RenderDevice::D3D11RenderDevice()
+    : m_ImmediateContext(*this)
+{
+}
+
+D3D11RenderDevice::~D3D11RenderDevice()
+{
+    Cleanup();
+}
+
+bool D3D11RenderDevice::Initialize(HWND hWnd)
+{
+    m_hWnd = hWnd;
+
+    RECT rc;
+    GetClientRect(hWnd, &rc);
+    m_Width = static_cast<uint32_t>(rc.right - rc.left);
+    m_Height = static_cast<uint32_t>(rc.bottom - rc.top);
+
+    return CreateDeviceAndSwapChain() && CreateBackBufferViews();
+}
+
+void D3D11RenderDevice::Cleanup()
+{
+    if (m_pd3dDeviceContext)
+        m_pd3dDeviceContext->ClearState();
+
+    if (m_pSwapChain)
+    {
+        BOOL fullscreen = FALSE;
+        if (SUCCEEDED(m_pSwapChain->GetFullscreenState(&fullscreen, nullptr)) && fullscreen)
+            m_pSwapChain->SetFullscreenState(FALSE, nullptr);
+    }
+}
+
+bool D3D11RenderDevice::CreateDeviceAndSwapChain()
+{
+    UINT createDeviceFlags = 0;
+#ifdef _DEBUG
+    createDeviceFlags |= D3D11_CREATE_DEVICE_DEBUG;
+#endif
+
+    D3D_FEATURE_LEVEL featureLevels[] =
+    {
+        D3D_FEATURE_LEVEL_11_1,
+        D3D_FEATURE_LEVEL_11_0,
+    };
+
+    D3D_FEATURE_LEVEL featureLevel;
+    HRESULT hr = D3D11CreateDevice(nullptr, D3D_DRIVER_TYPE_HARDWARE, nullptr, createDeviceFlags,
+        featureLevels, ARRAYSIZE(featureLevels), D3D11_SDK_VERSION,
+        reinterpret_cast<ID3D11Device**>(m_pd3dDevice.GetAddressOf()),
+        &featureLevel,
+        reinterpret_cast<ID3D11DeviceContext**>(m_pd3dDeviceContext.GetAddressOf()));
+    if (FAILED(hr))
+        return false;
+
+    ComPtr<IDXGIFactory2> dxgiFactory;
+    hr = CreateDXGIFactory1(IID_PPV_ARGS(&dxgiFactory));
+    if (FAILED(hr))
+        return false;
+
+    DXGI_SWAP_CHAIN_DESC1 sd = {};
+    sd.Width = m_Width;
+    sd.Height = m_Height;
+    sd.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+    sd.SampleDesc.Count = 1;
+    sd.SampleDesc.Quality = 0;
+    sd.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
+    sd.BufferCount = 2;
+    sd.SwapEffect = DXGI_SWAP_EFFECT_FLIP_DISCARD;
+    sd.Flags = DXGI_SWAP_CHAIN_FLAG_ALLOW_MODE_SWITCH;
+
+    hr = dxgiFactory->CreateSwapChainForHwnd(m_pd3dDevice.Get(), m_hWnd, &sd, nullptr, nullptr, &m_pSwapChain);
+    if (FAILED(hr))
+        return false;
+
+    // Per-draw constants go through a ring with offsets when the driver supports it
+    D3D11_FEATURE_DATA_D3D11_OPTIONS options = {};
+    bool constantBufferOffsetting = SUCCEEDED(m_pd3dDevice->CheckFeatureSupport(D3D11_FEATURE_D3D11_OPTIONS,
+        &options, sizeof(options))) && options.ConstantBufferOffsetting && options.MapNoOverwriteOnDynamicConstantBuffer;
+
+    // The constant ring reclaims space assuming the CPU is at most this many frames ahead
+    ComPtr<IDXGIDevice1> dxgiDevice;
+    if (SUCCEEDED(m_pd3dDevice.As(&dxgiDevice)))
+        dxgiDevice->SetMaximumFrameLatency(D3D11RenderContext::MaxFrameLatency);
+
+    m_ConstantBufferOffsetting = constantBufferOffsetting;
+    m_ImmediateContext.SetDeviceContext(m_pd3dDeviceContext.Get(), constantBufferOffsetting);
+    return true;
+}
+
+bool D3D11RenderDevice::CreateBackBufferViews()
+{
+    m_pRenderTargetView.Reset();
+    m_pDepthStencilView.Reset();
+    m_pDepthStencilBuffer.Reset();
+
+    // Create the render target view
+    ComPtr<ID3D11Texture2D> pBackBuffer;
+    HRESULT hr = m_pSwapChain->GetBuffer(0, IID_PPV_ARGS(&pBackBuffer));
+    if (FAILED(hr))
+        return false;
+
+    hr = m_pd3dDevice->CreateRenderTargetView(pBackBuffer.Get(), nullptr, &m_pRenderTargetView);
+    if (FAILED(hr))
+        return false;
+
+    // Create depth stencil texture
+    D3D11_TEXTURE2D_DESC descDepth = {};
+    descDepth.Width = m_Width;
+    descDepth.Height = m_Height;
+    descDepth.MipLevels = 1;
+    descDepth.ArraySize = 1;
+    descDepth.Format = DXGI_FORMAT_D24_UNORM_S8_UINT;
+    descDepth.SampleDesc.Count = 1;
+    descDepth.SampleDesc.Quality = 0;
+    descDepth.Usage = D3D11_USAGE_DEFAULT;
+    descDepth.BindFlags = D3D11_BIND_DEPTH_STENCIL;
+
+    hr = m_pd3dDevice->CreateTexture2D(&descDepth, nullptr, &m_pDepthStencilBuffer);
+    if (FAILED(hr))
+        return false;
+
+    // Create the depth stencil view
+    D3D11_DEPTH_STENCIL_VIEW_DESC descDSV = {};
+    descDSV.Format = descDepth.Format;
+    descDSV.ViewDimension = D3D11_DSV_DIMENSION_TEXTURE2D;
+    descDSV.Texture2D.MipSlice = 0;
+
+    hr = m_pd3dDevice->CreateDepthStencilView(m_pDepthStencilBuffer.Get(), &descDSV, &m_pDepthStencilView);
+    if (FAILED(hr))
+        return false;
+
+    BindBackBuffer();
+    return true;
+}
+
+void D3D11RenderDevice::BindBackBuffer()
+{
+    // The flip model unbinds the back buffer on every Present
+    m_pd3dDeviceContext->OMSetRenderTargets(1, m_pRenderTargetView.GetAddressOf(), m_pDepthStencilView.Get());
+}
+
+bool D3D11RenderDevice::Resize(uint32_t width, uint32_t height)
+{
+    if (!m_pSwapChain || width == 0 || height == 0)
+        return false;
+
+    // Release all outstanding references to the swap chain's buffers
+    m_pRenderTargetView.Reset();
+    m_pDepthStencilView.Reset();
+    m_pDepthStencilBuffer.Reset();
+
+    ID3D11RenderTargetView* nullViews[] = { nullptr };
+    m_pd3dDeviceContext->OMSetRenderTargets(_countof(nullViews), nullViews, nullptr);
+    m_pd3dDeviceContext->Flush();
+
+    HRESULT hr = m_pSwapChain->ResizeBuffers(0, width, height, DXGI_FORMAT_UNKNOWN, 0);
+    if (FAILED(hr))
+        return false;
+
+    m_Width = width;
+    m_Height = height;
+    return CreateBackBufferViews();
+}
+
+bool D3D11RenderDevice::Present()
+{
+    HRESULT hr = m_pSwapChain->Present(0, 0);
+    if (hr == DXGI_ERROR_DEVICE_REMOVED || hr == DXGI_ERROR_DEVICE_RESET)
+        return RecreateDevice();
+    if (FAILED(hr))
+        return false;
+
+    m_ImmediateContext.EndFrame();
+    BindBackBuffer();
+    return true;
+}
+
+bool D3D11RenderDevice::RecreateDevice()
+{
+    // Release all device-dependent objects but keep their descriptions
+    m_pRenderTargetView.Reset();
+    m_pDepthStencilView.Reset();
+    m_pDepthStencilBuffer.Reset();
+    m_pSwapChain.Reset();
+    m_pd3dDeviceContext.Reset();
+    m_pd3dDevice.Reset();
+    m_ImmediateContext.SetDeviceContext(nullptr, false);
+    for (DeferredContextEntry& entry : m_DeferredContexts)
+    {
+        entry.DeviceContext.Reset();
+        entry.Context->SetDeviceContext(nullptr, false);
+    }
+
+    if (!CreateDeviceAndSwapChain() || !CreateBackBufferViews())
+        return false;
+
+    // Rebuild every resource in place so the scene's handles stay valid
+    for (BufferEntry& entry : m_Buffers)
+    {
+        // Released buffers keep their slot with a zero ByteWidth
+        if (entry.Desc.ByteWidth != 0 && !CreateBufferObject(entry))
+            return false;
+    }
+    for (VertexShaderEntry& entry : m_VertexShaders)
+    {
+        if (!CreateVertexShaderObject(entry))
+            return false;
+    }
+    for (PixelShaderEntry& entry : m_PixelShaders)
+    {
+        if (!CreatePixelShaderObject(entry))
+            return false;
+    }
+    for (RasterizerStateEntry& entry : m_RasterizerStates)
+    {
+        if (!CreateRasterizerStateObject(entry))
+            return false;
+    }
+    for (DeferredContextEntry& entry : m_DeferredContexts)
+    {
+        if (!CreateDeferredContextObject(entry))
+            return false;
+    }
+    return true;
+}
+
+bool D3D11RenderDevice::CreateBuffer(const BufferDesc& desc, const void* initialData, BufferHandle* buffer)
+{
+    if (!buffer || desc.ByteWidth == 0)
+        return false;
+
+    BufferEntry entry;
+    entry.Desc = desc;
+    if (initialData)
+    {
+        const uint8_t* bytes = static_cast<const uint8_t*>(initialData);
+        entry.InitialData.assign(bytes, bytes + desc.ByteWidth);
+    }
+    if (!CreateBufferObject(entry))
+        return false;
+
+    m_Buffers.push_back(std::move(entry));
+    buffer->Id = static_cast<uint32_t>(m_Buffers.size());
+    return true;
+}
+
+bool D3D11RenderDevice::CreateBufferNoCopy(const BufferDesc& desc, const void* data, BufferHandle* buffer)
+{
+    if (!buffer || desc.ByteWidth == 0 || desc.Usage != BufferUsage::Immutable || !data)
+        return false;
+
+    BufferEntry entry;
+    entry.Desc = desc;
+    entry.ExternalData = data;
+    if (!CreateBufferObject(entry))
+        return false;
+
+    m_Buffers.push_back(std::move(entry));
+    buffer->Id = static_cast<uint32_t>(m_Buffers.size());
+    return true;
+}
+
+void D3D11RenderDevice::ReleaseBuffer(BufferHandle buffer)
+{
+    if (buffer.Id == 0 || buffer.Id > m_Buffers.size())
+        return;
+    BufferEntry& entry = m_Buffers[buffer.Id - 1];
+    entry.Desc.ByteWidth = 0;
+    std::vector<uint8_t>().swap(entry.InitialData);
+    entry.ExternalData = nullptr;
+    entry.Buffer.Reset();
+}
+
+bool D3D11RenderDevice::CreateBufferObject(BufferEntry& entry)
+{
+    D3D11_BUFFER_DESC bd = {};
+    bd.ByteWidth = entry.Desc.ByteWidth;
+    switch (entry.Desc.Bind)
+    {
+    case BufferBind::VertexBuffer: bd.BindFlags = D3D11_BIND_VERTEX_BUFFER; break;
+    case BufferBind::IndexBuffer: bd.BindFlags = D3D11_BIND_INDEX_BUFFER; break;
+    case BufferBind::ConstantBuffer:
+        bd.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+        bd.ByteWidth = (bd.ByteWidth + 15) & ~15u;
+        break;
+    }
+    switch (entry.Desc.Usage)
+    {
+    case BufferUsage::Default: bd.Usage = D3D11_USAGE_DEFAULT; break;
+    case BufferUsage::Immutable: bd.Usage = D3D11_USAGE_IMMUTABLE; break;
+    case BufferUsage::Dynamic:
+        bd.Usage = D3D11_USAGE_DYNAMIC;
+        bd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+        break;
+    }
+
+    D3D11_SUBRESOURCE_DATA InitData = {};
+    InitData.pSysMem = entry.ExternalData ? entry.ExternalData : entry.InitialData.data();
+    bool hasData = (entry.ExternalData || !entry.InitialData.empty()) && bd.ByteWidth == entry.Desc.ByteWidth;
+    HRESULT hr = m_pd3dDevice->CreateBuffer(&bd, hasData ? &InitData : nullptr, entry.Buffer.ReleaseAndGetAddressOf());
+
+    // Constant buffers are refilled every frame, so there is nothing worth restoring
+    if (SUCCEEDED(hr) && entry.Desc.Usage != BufferUsage::Immutable && entry.Desc.Bind == BufferBind::ConstantBuffer)
+        entry.InitialData.clear();
+    return SUCCEEDED(hr);
+}
+
+bool D3D11RenderDevice::GetShaderBytecode(const ShaderDesc& desc, ComPtr<ID3DBlob>& blob, ShaderBytecode* bytecode)
+{
+    if (m_ShaderCache)
+    {
+        static D3DShaderCompiler compiler;
+        return m_ShaderCache->GetBytecode(desc, compiler, bytecode);
+    }
+
+    if (!CompileShader(desc, blob))
+        return false;
+    *bytecode = { static_cast<const uint8_t*>(blob->GetBufferPointer()), blob->GetBufferSize() };
+    return true;
+}
+
+bool D3D11RenderDevice::CreateVertexShader(const ShaderDesc& desc, VertexShaderHandle* shader)
+{
+    if (!shader)
+        return false;
+
+    VertexShaderEntry entry;
+    entry.Desc = desc;
+    if (!CreateVertexShaderObject(entry))
+        return false;
+
+    m_VertexShaders.push_back(std::move(entry));
+    shader->Id = static_cast<uint32_t>(m_VertexShaders.size());
+    return true;
+}
+
+bool D3D11RenderDevice::CreateVertexShaderObject(VertexShaderEntry& entry)
+{
+    ComPtr<ID3DBlob> pVSBlob;
+    ShaderBytecode bytecode;
+    if (!GetShaderBytecode(entry.Desc, pVSBlob, &bytecode))
+        return false;
+
+    HRESULT hr = m_pd3dDevice->CreateVertexShader(bytecode.Data, bytecode.Size, nullptr,
+        entry.Shader.ReleaseAndGetAddressOf());
+    if (FAILED(hr))
+        return false;
+
+    // Define the input layout
+    std::vector<D3D11_INPUT_ELEMENT_DESC> layout;
+    for (const InputElementDesc& element : entry.Desc.InputLayout)
+    {
+        layout.push_back({ element.SemanticName, element.SemanticIndex, ToDXGIFormat(element.ElementFormat),
+            element.InputSlot, element.AlignedByteOffset,
+            element.PerInstance ? D3D11_INPUT_PER_INSTANCE_DATA : D3D11_INPUT_PER_VERTEX_DATA,
+            element.InstanceDataStepRate });
+    }
+
+    hr = m_pd3dDevice->CreateInputLayout(layout.data(), static_cast<UINT>(layout.size()), bytecode.Data,
+        bytecode.Size, entry.InputLayout.ReleaseAndGetAddressOf());
+    return SUCCEEDED(hr);
+}
+
+bool D3D11RenderDevice::CreatePixelShader(const ShaderDesc& desc, PixelShaderHandle* shader)
+{
+    if (!shader)
+        return false;
+
+    PixelShaderEntry entry;
+    entry.Desc = desc;
+    if (!CreatePixelShaderObject(entry))
+        return false;
+
+    m_PixelShaders.push_back(std::move(entry));
+    shader->Id = static_cast<uint32_t>(m_PixelShaders.size());
+    return true;
+}
+
+bool D3D11RenderDevice::CreatePixelShaderObject(PixelShaderEntry& entry)
+{
+    ComPtr<ID3DBlob> pPSBlob;
+    ShaderBytecode bytecode;
+    if (!GetShaderBytecode(entry.Desc, pPSBlob, &bytecode))
+        return false;
+
+    HRESULT hr = m_pd3dDevice->CreatePixelShader(bytecode.Data, bytecode.Size, nullptr,
+        entry.Shader.ReleaseAndGetAddressOf());
+    return SUCCEEDED(hr);
+}
+
+bool D3D11RenderDevice::CreateRasterizerState(const RasterizerDesc& desc, RasterizerStateHandle* state)
+{
+    if (!state)
+        return false;
+
+    auto create = [this](const RasterizerDesc& newDesc, RasterizerStateHandle* newState)
+    {
+        RasterizerStateEntry entry;
+        entry.Desc = newDesc;
+        if (!CreateRasterizerStateObject(entry))
+            return false;
+
+        m_RasterizerStates.push_back(std::move(entry));
+        newState->Id = static_cast<uint32_t>(m_RasterizerStates.size());
+        return true;
+    };
+
+    const RasterizerStateHandle* cached = m_RasterizerStateCache.GetOrCreate(desc, create);
+    if (!cached)
+        return false;
+
+    *state = *cached;
+    return true;
+}
+
+bool D3D11RenderDevice::CreateRasterizerStateObject(RasterizerStateEntry& entry)
+{
+    D3D11_RASTERIZER_DESC rasterDesc = {};
+    rasterDesc.FillMode = entry.Desc.Fill == FillMode::Wireframe ? D3D11_FILL_WIREFRAME : D3D11_FILL_SOLID;
+    switch (entry.Desc.Cull)
+    {
+    case CullMode::None: rasterDesc.CullMode = D3D11_CULL_NONE; break;
+    case CullMode::Front: rasterDesc.CullMode = D3D11_CULL_FRONT; break;
+    case CullMode::Back: rasterDesc.CullMode = D3D11_CULL_BACK; break;
+    }
+    rasterDesc.FrontCounterClockwise = entry.Desc.FrontCounterClockwise;
+    rasterDesc.DepthClipEnable = entry.Desc.DepthClipEnable;
+
+    HRESULT hr = m_pd3dDevice->CreateRasterizerState(&rasterDesc, entry.State.ReleaseAndGetAddressOf());
+    return SUCCEEDED(hr);
+}
+
+RenderContext* D3D11RenderDevice::CreateDeferredContext()
+{
+    if (!m_pd3dDevice)
+        return nullptr;
+
+    DeferredContextEntry entry;
+    entry.Context = std::make_unique<D3D11RenderContext>(*this, true);
+    if (!CreateDeferredContextObject(entry) || !entry.Context->CreateConstantRing())
+        return nullptr;
+
+    m_DeferredContexts.push_back(std::move(entry));
+    return m_DeferredContexts.back().Context.get();
+}
+
+bool D3D11RenderDevice::CreateDeferredContextObject(DeferredContextEntry& entry)
+{
+    HRESULT hr = m_pd3dDevice->CreateDeferredContext1(0, entry.DeviceContext.ReleaseAndGetAddressOf());
+    if (FAILED(hr))
+        return false;
+
+    entry.Context->SetDeviceContext(entry.DeviceContext.Get(), m_ConstantBufferOffsetting);
+    return true;
+}
+
+bool D3D11RenderDevice::GetRasterizerDesc(RasterizerStateHandle state, RasterizerDesc* desc) const
+{
+    const RasterizerStateEntry* entry = Lookup(m_RasterizerStates, state.Id);
+    if (!entry || !desc)
+        return false;
+
+    *desc = entry->Desc;
+    return true;
+}
+
+ID3D11Buffer* D3D11RenderDevice::GetBuffer(BufferHandle buffer) const
+{
+    const BufferEntry* entry = Lookup(m_Buffers, buffer.Id);
+    return entry ? entry->Buffer.Get() : nullptr;
+}
+
+BufferUsage D3D11RenderDevice::GetBufferUsage(BufferHandle buffer) const
+{
+    const BufferEntry* entry = Lookup(m_Buffers, buffer.Id);
+    return entry ? entry->Desc.Usage : BufferUsage::Default;
+}
+
+ID3D11VertexShader* D3D11RenderDevice::GetVertexShader(VertexShaderHandle shader, ID3D11InputLayout** inputLayout) const
+{
+    const VertexShaderEntry* entry = Lookup(m_VertexShaders, shader.Id);
+    if (inputLayout)
+        *inputLayout = entry ? entry->InputLayout.Get() : nullptr;
+    return entry ? entry->Shader.Get() : nullptr;
+}
+
+ID3D11PixelShader* D3D11RenderDevice::GetPixelShader(PixelShaderHandle shader) const
+{
+    const PixelShaderEntry* entry = Lookup(m_PixelShaders, shader.Id);
+    return entry ? entry->Shader.Get() : nullptr;
+}
+
+ID3D11RasterizerState* D3D11RenderDevice::GetRasterizerState(RasterizerStateHandle state) const
+{
+    const RasterizerStateEntry* entry = Lookup(m_RasterizerStates, state.Id);
+    return entry ? entry->State.Get() : nullptr;
+}
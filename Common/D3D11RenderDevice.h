@@ -0,0 +1,207 @@
+#pragma once
+
+// RenderDevice on top of D3D11 and a flip-model swap chain. This is the
+// InitializeDirect3D / CreateDepthStencilView / ResizeDirectXBuffers /
+// RecreateDevice code of the tutorials in one place. Every resource keeps its
+// description (and initial data, or a pointer to the owner's copy of it) so a
+// removed device can be rebuilt without the scene noticing: handles stay valid
+// across RecreateDevice().
+
+#include <windows.h>
+#include <d3d11_4.h>
+#include <wrl/client.h>
+
+#include <memory>
+#include <vector>
+
+#include "ConstantBufferRing.h"
+#include "RenderDevice.h"
+#include "StateCache.h"
+
+class D3D11RenderDevice;
+class ShaderCache;
+struct ShaderBytecode;
+
+class D3D11RenderContext final : public RenderContext
+{
+public:
+    // A deferred context records command lists; the immediate one executes them
+    D3D11RenderContext(D3D11RenderDevice& device, bool deferred = false);
+
+    // constantBufferOffsetting: the device supports VSSetConstantBuffers1 offsets and
+    // WRITE_NO_OVERWRITE on dynamic constant buffers (D3D11_FEATURE_D3D11_OPTIONS)
+    void SetDeviceContext(ID3D11DeviceContext1* context, bool constantBufferOffsetting);
+
+    // Creates the constant ring now instead of on the first AllocateConstants; deferred
+    // contexts need this because they must not create resources while recording
+    bool CreateConstantRing();
+
+    void ClearRenderTarget(const float color[4]) override;
+    void ClearDepthStencil(float depth, uint8_t stencil) override;
+    void SetViewport(const Viewport& viewport) override;
+
+    void SetRasterizerState(RasterizerStateHandle state) override;
+    void SetVertexShader(VertexShaderHandle shader) override;
+    void SetPixelShader(PixelShaderHandle shader) override;
+
+    void SetVertexBuffer(uint32_t slot, BufferHandle buffer, uint32_t stride, uint32_t offset) override;
+    void SetIndexBuffer(BufferHandle buffer, Format format, uint32_t offset) override;
+    void SetVSConstantBuffer(uint32_t slot, BufferHandle buffer) override;
+    void SetPSConstantBuffer(uint32_t slot, BufferHandle buffer) override;
+
+    void UpdateBuffer(BufferHandle buffer, const void* data, uint32_t size) override;
+    void UpdateBufferRange(BufferHandle buffer, uint32_t offset, const void* data, uint32_t size) override;
+
+    ConstantBufferRange AllocateConstants(const void* data, uint32_t size) override;
+    void SetVSConstantBufferRange(uint32_t slot, const ConstantBufferRange& range) override;
+    void SetPSConstantBufferRange(uint32_t slot, const ConstantBufferRange& range) override;
+
+    // Closes the frame in the constant ring and reclaims frames the GPU must have finished
+    void EndFrame();
+
+    // Frames the CPU may run ahead of the GPU (IDXGIDevice1::SetMaximumFrameLatency)
+    static constexpr uint32_t MaxFrameLatency = 3;
+    static constexpr uint32_t ConstantRingSize = 4 << 20;
+
+    void DrawIndexed(uint32_t indexCount, uint32_t startIndexLocation, int32_t baseVertexLocation) override;
+    void DrawIndexedInstanced(uint32_t indexCountPerInstance, uint32_t instanceCount, uint32_t startIndexLocation,
+        int32_t baseVertexLocation, uint32_t startInstanceLocation) override;
+
+    void BeginCommandList() override;
+    bool FinishCommandList(std::unique_ptr<CommandList>& list) override;
+    bool ExecuteCommandList(const CommandList& list) override;
+
+private:
+    // Back buffer, depth buffer and the full-target viewport
+    void BindDefaultTargets();
+
+    D3D11RenderDevice& m_Device;
+    ID3D11DeviceContext1* m_Context = nullptr;
+    bool m_Deferred;
+
+    // One dynamic constant buffer shared by all per-draw constants. Appends use
+    // WRITE_NO_OVERWRITE; a WRITE_DISCARD renames the buffer when the ring is full
+    // or was just (re)created. Without offsetting support every allocation discards.
+    ConstantBufferRing m_ConstantRing;
+    BufferHandle m_ConstantRingBuffer;
+    bool m_ConstantBufferOffsetting = false;
+    bool m_ConstantRingNeedsDiscard = true;
+};
+
+class D3D11RenderDevice final : public RenderDevice
+{
+public:
+    D3D11RenderDevice();
+    ~D3D11RenderDevice() override;
+
+    // Creates the device, the swap chain for hWnd and the back buffer views
+    bool Initialize(HWND hWnd);
+    void Cleanup();
+
+    const char* GetName() const override { return "d3d11"; }
+
+    // Shaders created afterwards (and on RecreateDevice) take their bytecode from
+    // cache instead of compiling; the caller owns the cache and saves it
+    void SetShaderCache(ShaderCache* cache) { m_ShaderCache = cache; }
+
+    bool CreateBuffer(const BufferDesc& desc, const void* initialData, BufferHandle* buffer) override;
+    bool CreateBufferNoCopy(const BufferDesc& desc, const void* data, BufferHandle* buffer) override;
+    void ReleaseBuffer(BufferHandle buffer) override;
+    bool CreateVertexShader(const ShaderDesc& desc, VertexShaderHandle* shader) override;
+    bool CreatePixelShader(const ShaderDesc& desc, PixelShaderHandle* shader) override;
+    bool CreateRasterizerState(const RasterizerDesc& desc, RasterizerStateHandle* state) override;
+    bool GetRasterizerDesc(RasterizerStateHandle state, RasterizerDesc* desc) const override;
+
+    bool Resize(uint32_t width, uint32_t height) override;
+    uint32_t GetWidth() const override { return m_Width; }
+    uint32_t GetHeight() const override { return m_Height; }
+
+    RenderContext& GetImmediateContext() override { return m_ImmediateContext; }
+    RenderContext* CreateDeferredContext() override;
+    bool Present() override;
+
+    ID3D11Device1* GetD3DDevice() const { return m_pd3dDevice.Get(); }
+    ID3D11DeviceContext1* GetD3DDeviceContext() const { return m_pd3dDeviceContext.Get(); }
+    IDXGISwapChain1* GetSwapChain() const { return m_pSwapChain.Get(); }
+
+    ID3D11Buffer* GetBuffer(BufferHandle buffer) const;
+    BufferUsage GetBufferUsage(BufferHandle buffer) const;
+    ID3D11VertexShader* GetVertexShader(VertexShaderHandle shader, ID3D11InputLayout** inputLayout) const;
+    ID3D11PixelShader* GetPixelShader(PixelShaderHandle shader) const;
+    ID3D11RasterizerState* GetRasterizerState(RasterizerStateHandle state) const;
+
+    ID3D11RenderTargetView* GetRenderTargetView() const { return m_pRenderTargetView.Get(); }
+    ID3D11DepthStencilView* GetDepthStencilView() const { return m_pDepthStencilView.Get(); }
+
+private:
+    struct BufferEntry
+    {
+        BufferDesc Desc;
+        std::vector<uint8_t> InitialData;
+        // Owner's memory used instead of InitialData (CreateBufferNoCopy)
+        const void* ExternalData = nullptr;
+        Microsoft::WRL::ComPtr<ID3D11Buffer> Buffer;
+    };
+
+    struct VertexShaderEntry
+    {
+        ShaderDesc Desc;
+        Microsoft::WRL::ComPtr<ID3D11VertexShader> Shader;
+        Microsoft::WRL::ComPtr<ID3D11InputLayout> InputLayout;
+    };
+
+    struct PixelShaderEntry
+    {
+        ShaderDesc Desc;
+        Microsoft::WRL::ComPtr<ID3D11PixelShader> Shader;
+    };
+
+    struct RasterizerStateEntry
+    {
+        RasterizerDesc Desc;
+        Microsoft::WRL::ComPtr<ID3D11RasterizerState> State;
+    };
+
+    struct DeferredContextEntry
+    {
+        Microsoft::WRL::ComPtr<ID3D11DeviceContext1> DeviceContext;
+        std::unique_ptr<D3D11RenderContext> Context;
+    };
+
+    bool CreateDeviceAndSwapChain();
+    bool CreateBackBufferViews();
+    void BindBackBuffer();
+    bool RecreateDevice();
+
+    bool CreateBufferObject(BufferEntry& entry);
+    bool GetShaderBytecode(const ShaderDesc& desc, Microsoft::WRL::ComPtr<ID3DBlob>& blob, ShaderBytecode* bytecode);
+    bool CreateVertexShaderObject(VertexShaderEntry& entry);
+    bool CreatePixelShaderObject(PixelShaderEntry& entry);
+    bool CreateRasterizerStateObject(RasterizerStateEntry& entry);
+    bool CreateDeferredContextObject(DeferredContextEntry& entry);
+
+    HWND m_hWnd = nullptr;
+    uint32_t m_Width = 0;
+    uint32_t m_Height = 0;
+
+    Microsoft::WRL::ComPtr<IDXGISwapChain1> m_pSwapChain;
+    Microsoft::WRL::ComPtr<ID3D11Device1> m_pd3dDevice;
+    Microsoft::WRL::ComPtr<ID3D11DeviceContext1> m_pd3dDeviceContext;
+    Microsoft::WRL::ComPtr<ID3D11RenderTargetView> m_pRenderTargetView;
+    Microsoft::WRL::ComPtr<ID3D11Texture2D> m_pDepthStencilBuffer;
+    Microsoft::WRL::ComPtr<ID3D11DepthStencilView> m_pDepthStencilView;
+    bool m_ConstantBufferOffsetting = false;
+
+    std::vector<BufferEntry> m_Buffers;
+    std::vector<VertexShaderEntry> m_VertexShaders;
+    std::vector<PixelShaderEntry> m_PixelShaders;
+    std::vector<RasterizerStateEntry> m_RasterizerStates;
+    // Handles stay valid across RecreateDevice, so the cache survives it too
+    StateCache<RasterizerDesc, RasterizerStateHandle> m_RasterizerStateCache;
+
+    ShaderCache* m_ShaderCache = nullptr;
+
+    D3D11RenderContext m_ImmediateContext;
+    // Rebuilt on RecreateDevice like the resources, so the scene's pointers stay valid
+    std::vector<DeferredContextEntry> m_DeferredContexts;
+};
@@ -0,0 +1,178 @@
+#include "D3D11StateCache.h"
+
+using namespace Microsoft::WRL;
+
+// The D3D11 descs contain padding (e.g. after StencilReadMask/StencilWriteMask),
+// so they are hashed and compared field by field rather than as raw bytes.
+
+uint64_t HashDesc(const D3D11_RASTERIZER_DESC& desc)
+{
+    uint64_t hash = HashValue(desc.FillMode);
+    hash = HashValue(desc.CullMode, hash);
+    hash = HashValue(desc.FrontCounterClockwise, hash);
+    hash = HashValue(desc.DepthBias, hash);
+    hash = HashValue(desc.DepthBiasClamp, hash);
+    hash = HashValue(desc.SlopeScaledDepthBias, hash);
+    hash = HashValue(desc.DepthClipEnable, hash);
+    hash = HashValue(desc.ScissorEnable, hash);
+    hash = HashValue(desc.MultisampleEnable, hash);
+    return HashValue(desc.AntialiasedLineEnable, hash);
+}
+
+bool DescEqual(const D3D11_RASTERIZER_DESC& a, const D3D11_RASTERIZER_DESC& b)
+{
+    return a.FillMode == b.FillMode && a.CullMode == b.CullMode && a.FrontCounterClockwise == b.FrontCounterClockwise &&
+        a.DepthBias == b.DepthBias && FloatKeyEqual(a.DepthBiasClamp, b.DepthBiasClamp) &&
+        FloatKeyEqual(a.SlopeScaledDepthBias, b.SlopeScaledDepthBias) && a.DepthClipEnable == b.DepthClipEnable &&
+        a.ScissorEnable == b.ScissorEnable && a.MultisampleEnable == b.MultisampleEnable &&
+        a.AntialiasedLineEnable == b.AntialiasedLineEnable;
+}
+
+namespace
+{
+    uint64_t HashStencilOp(const D3D11_DEPTH_STENCILOP_DESC& op, uint64_t hash)
+    {
+        hash = HashValue(op.StencilFailOp, hash);
+        hash = HashValue(op.StencilDepthFailOp, hash);
+        hash = HashValue(op.StencilPassOp, hash);
+        return HashValue(op.StencilFunc, hash);
+    }
+
+    bool StencilOpEqual(const D3D11_DEPTH_STENCILOP_DESC& a, const D3D11_DEPTH_STENCILOP_DESC& b)
+    {
+        return a.StencilFailOp == b.StencilFailOp && a.StencilDepthFailOp == b.StencilDepthFailOp &&
+            a.StencilPassOp == b.StencilPassOp && a.StencilFunc == b.StencilFunc;
+    }
+
+    bool RenderTargetBlendEqual(const D3D11_RENDER_TARGET_BLEND_DESC& a, const D3D11_RENDER_TARGET_BLEND_DESC& b)
+    {
+        return a.BlendEnable == b.BlendEnable && a.SrcBlend == b.SrcBlend && a.DestBlend == b.DestBlend &&
+            a.BlendOp == b.BlendOp && a.SrcBlendAlpha == b.SrcBlendAlpha && a.DestBlendAlpha == b.DestBlendAlpha &&
+            a.BlendOpAlpha == b.BlendOpAlpha && a.RenderTargetWriteMask == b.RenderTargetWriteMask;
+    }
+}
+
+uint64_t HashDesc(const D3D11_DEPTH_STENCIL_DESC& desc)
+{
+    uint64_t hash = HashValue(desc.DepthEnable);
+    hash = HashValue(desc.DepthWriteMask, hash);
+    hash = HashValue(desc.DepthFunc, hash);
+    hash = HashValue(desc.StencilEnable, hash);
+    hash = HashValue(desc.StencilReadMask, hash);
+    hash = HashValue(desc.StencilWriteMask, hash);
+    hash = HashStencilOp(desc.FrontFace, hash);
+    return HashStencilOp(desc.BackFace, hash);
+}
+
+bool DescEqual(const D3D11_DEPTH_STENCIL_DESC& a, const D3D11_DEPTH_STENCIL_DESC& b)
+{
+    return a.DepthEnable == b.DepthEnable && a.DepthWriteMask == b.DepthWriteMask && a.DepthFunc == b.DepthFunc &&
+        a.StencilEnable == b.StencilEnable && a.StencilReadMask == b.StencilReadMask &&
+        a.StencilWriteMask == b.StencilWriteMask && StencilOpEqual(a.FrontFace, b.FrontFace) &&
+        StencilOpEqual(a.BackFace, b.BackFace);
+}
+
+uint64_t HashDesc(const D3D11_BLEND_DESC& desc)
+{
+    uint64_t hash = HashValue(desc.AlphaToCoverageEnable);
+    hash = HashValue(desc.IndependentBlendEnable, hash);
+    // Without IndependentBlendEnable only RenderTarget[0] is used, but D3D11 still
+    // creates distinct objects for descs that differ in the others, so hash them all
+    for (const D3D11_RENDER_TARGET_BLEND_DESC& target : desc.RenderTarget)
+    {
+        hash = HashValue(target.BlendEnable, hash);
+        hash = HashValue(target.SrcBlend, hash);
+        hash = HashValue(target.DestBlend, hash);
+        hash = HashValue(target.BlendOp, hash);
+        hash = HashValue(target.SrcBlendAlpha, hash);
+        hash = HashValue(target.DestBlendAlpha, hash);
+        hash = HashValue(target.BlendOpAlpha, hash);
+        hash = HashValue(target.RenderTargetWriteMask, hash);
+    }
+    return hash;
+}
+
+bool DescEqual(const D3D11_BLEND_DESC& a, const D3D11_BLEND_DESC& b)
+{
+    if (a.AlphaToCoverageEnable != b.AlphaToCoverageEnable || a.IndependentBlendEnable != b.IndependentBlendEnable)
+        return false;
+    for (int i = 0; i < D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT; ++i)
+    {
+        if (!RenderTargetBlendEqual(a.RenderTarget[i], b.RenderTarget[i]))
+            return false;
+    }
+    return true;
+}
+
+uint64_t HashDesc(const D3D11_SAMPLER_DESC& desc)
+{
+    uint64_t hash = HashValue(desc.Filter);
+    hash = HashValue(desc.AddressU, hash);
+    hash = HashValue(desc.AddressV, hash);
+    hash = HashValue(desc.AddressW, hash);
+    hash = HashValue(desc.MipLODBias, hash);
+    hash = HashValue(desc.MaxAnisotropy, hash);
+    hash = HashValue(desc.ComparisonFunc, hash);
+    hash = HashValue(desc.BorderColor, hash);
+    hash = HashValue(desc.MinLOD, hash);
+    return HashValue(desc.MaxLOD, hash);
+}
+
+bool DescEqual(const D3D11_SAMPLER_DESC& a, const D3D11_SAMPLER_DESC& b)
+{
+    return a.Filter == b.Filter && a.AddressU == b.AddressU && a.AddressV == b.AddressV && a.AddressW == b.AddressW &&
+        FloatKeyEqual(a.MipLODBias, b.MipLODBias) && a.MaxAnisotropy == b.MaxAnisotropy &&
+        a.ComparisonFunc == b.ComparisonFunc && FloatKeyEqual(a.BorderColor[0], b.BorderColor[0]) &&
+        FloatKeyEqual(a.BorderColor[1], b.BorderColor[1]) && FloatKeyEqual(a.BorderColor[2], b.BorderColor[2]) &&
+        FloatKeyEqual(a.BorderColor[3], b.BorderColor[3]) && FloatKeyEqual(a.MinLOD, b.MinLOD) &&
+        FloatKeyEqual(a.MaxLOD, b.MaxLOD);
+}
+
+void D3D11StateCache::Clear()
+{
+    m_RasterizerStates.Clear();
+    m_DepthStencilStates.Clear();
+    m_BlendStates.Clear();
+    m_SamplerStates.Clear();
+    m_Device.Reset();
+}
+
+ID3D11RasterizerState* D3D11StateCache::GetRasterizerState(const D3D11_RASTERIZER_DESC& desc)
+{
+    const ComPtr<ID3D11RasterizerState>* state = m_RasterizerStates.GetOrCreate(desc,
+        [this](const D3D11_RASTERIZER_DESC& newDesc, ComPtr<ID3D11RasterizerState>* newState)
+        {
+            return m_Device && SUCCEEDED(m_Device->CreateRasterizerState(&newDesc, newState->GetAddressOf()));
+        });
+    return state ? state->Get() : nullptr;
+}
+
+ID3D11DepthStencilState* D3D11StateCache::GetDepthStencilState(const D3D11_DEPTH_STENCIL_DESC& desc)
+{
+    const ComPtr<ID3D11DepthStencilState>* state = m_DepthStencilStates.GetOrCreate(desc,
+        [this](const D3D11_DEPTH_STENCIL_DESC& newDesc, ComPtr<ID3D11DepthStencilState>* newState)
+        {
+            return m_Device && SUCCEEDED(m_Device->CreateDepthStencilState(&newDesc, newState->GetAddressOf()));
+        });
+    return state ? state->Get() : nullptr;
+}
+
+ID3D11BlendState* D3D11StateCache::GetBlendState(const D3D11_BLEND_DESC& desc)
+{
+    const ComPtr<ID3D11BlendState>* state = m_BlendStates.GetOrCreate(desc,
+        [this](const D3D11_BLEND_DESC& newDesc, ComPtr<ID3D11BlendState>* newState)
+        {
+            return m_Device && SUCCEEDED(m_Device->CreateBlendState(&newDesc, newState->GetAddressOf()));
+        });
+    return state ? state->Get() : nullptr;
+}
+
+ID3D11SamplerState* D3D11StateCache::GetSamplerState(const D3D11_SAMPLER_DESC& desc)
+{
+    const ComPtr<ID3D11SamplerState>* state = m_SamplerStates.GetOrCreate(desc,
+        [this](const D3D11_SAMPLER_DESC& newDesc, ComPtr<ID3D11SamplerState>* newState)
+        {
+            return m_Device && SUCCEEDED(m_Device->CreateSamplerState(&newDesc, newState->GetAddressOf()));
+        });
+    return state ? state->Get() : nullptr;
+}
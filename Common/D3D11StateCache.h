@@ -0,0 +1,52 @@
+#pragma once
+
+// Shared ID3D11*State objects for code that talks to D3D11 directly, like the
+// tutorials' WM_KEYDOWN handlers. Equal descs return the same object, so
+// toggling a state flips between cached objects instead of calling
+// CreateRasterizerState on every key press. Lookups are lock-free (see
+// StateCache.h); the returned pointers are owned by the cache and stay valid
+// until Clear() or destruction.
+
+#include <windows.h>
+#include <d3d11_4.h>
+#include <wrl/client.h>
+
+#include "StateCache.h"
+
+uint64_t HashDesc(const D3D11_RASTERIZER_DESC& desc);
+uint64_t HashDesc(const D3D11_DEPTH_STENCIL_DESC& desc);
+uint64_t HashDesc(const D3D11_BLEND_DESC& desc);
+uint64_t HashDesc(const D3D11_SAMPLER_DESC& desc);
+bool DescEqual(const D3D11_RASTERIZER_DESC& a, const D3D11_RASTERIZER_DESC& b);
+bool DescEqual(const D3D11_DEPTH_STENCIL_DESC& a, const D3D11_DEPTH_STENCIL_DESC& b);
+bool DescEqual(const D3D11_BLEND_DESC& a, const D3D11_BLEND_DESC& b);
+bool DescEqual(const D3D11_SAMPLER_DESC& a, const D3D11_SAMPLER_DESC& b);
+
+class D3D11StateCache
+{
+public:
+    D3D11StateCache() = default;
+
+    // States are created on device. Clear() drops the states and the device, so
+    // call it before the device is released and SetDevice() again on a new one.
+    void SetDevice(ID3D11Device* device) { m_Device = device; }
+    void Clear();
+
+    // Return nullptr when the device rejects the desc
+    ID3D11RasterizerState* GetRasterizerState(const D3D11_RASTERIZER_DESC& desc);
+    ID3D11DepthStencilState* GetDepthStencilState(const D3D11_DEPTH_STENCIL_DESC& desc);
+    ID3D11BlendState* GetBlendState(const D3D11_BLEND_DESC& desc);
+    ID3D11SamplerState* GetSamplerState(const D3D11_SAMPLER_DESC& desc);
+
+    StateCacheStats GetRasterizerStats() const { return m_RasterizerStates.GetStats(); }
+    StateCacheStats GetDepthStencilStats() const { return m_DepthStencilStates.GetStats(); }
+    StateCacheStats GetBlendStats() const { return m_BlendStates.GetStats(); }
+    StateCacheStats GetSamplerStats() const { return m_SamplerStates.GetStats(); }
+
+private:
+    Microsoft::WRL::ComPtr<ID3D11Device> m_Device;
+    StateCache<D3D11_RASTERIZER_DESC, Microsoft::WRL::ComPtr<ID3D11RasterizerState>> m_RasterizerStates;
+    StateCache<D3D11_DEPTH_STENCIL_DESC, Microsoft::WRL::ComPtr<ID3D11DepthStencilState>> m_DepthStencilStates;
+    StateCache<D3D11_BLEND_DESC, Microsoft::WRL::ComPtr<ID3D11BlendState>> m_BlendStates;
+    StateCache<D3D11_SAMPLER_DESC, Microsoft::WRL::ComPtr<ID3D11SamplerState>> m_SamplerStates;
+};
@@ -0,0 +1,143 @@
+#include "DrawQueue.h"
+
+#include <chrono>
+#include <cstring>
+#include <utility>
+
+namespace
+{
+    bool SameRange(const ConstantBufferRange& a, const ConstantBufferRange& b)
+    {
+        return a.Buffer.Id == b.Buffer.Id && a.Offset == b.Offset && a.Size == b.Size;
+    }
+}
+
+void RadixSortDrawKeys(DrawSortEntry* entries, DrawSortEntry* scratch, size_t count)
+{
+    // One read of the keys builds the histograms of all eight bytes
+    uint32_t histograms[8][256] = {};
+    for (size_t i = 0; i < count; ++i)
+    {
+        uint64_t key = entries[i].Key;
+        for (int pass = 0; pass < 8; ++pass)
+            ++histograms[pass][(key >> (pass * 8)) & 0xff];
+    }
+
+    DrawSortEntry* source = entries;
+    DrawSortEntry* destination = scratch;
+    for (int pass = 0; pass < 8; ++pass)
+    {
+        uint32_t* histogram = histograms[pass];
+        if (count == 0 || histogram[(source[0].Key >> (pass * 8)) & 0xff] == count)
+            continue;
+
+        uint32_t offsets[256];
+        uint32_t sum = 0;
+        for (int bucket = 0; bucket < 256; ++bucket)
+        {
+            offsets[bucket] = sum;
+            sum += histogram[bucket];
+        }
+
+        for (size_t i = 0; i < count; ++i)
+            destination[offsets[(source[i].Key >> (pass * 8)) & 0xff]++] = source[i];
+        std::swap(source, destination);
+    }
+
+    if (source != entries)
+        std::memcpy(entries, source, count * sizeof(DrawSortEntry));
+}
+
+void DrawQueue::Reset()
+{
+    m_Commands.clear();
+    m_Entries.clear();
+}
+
+void DrawQueue::Submit(uint64_t key, const DrawCommand& command)
+{
+    m_Entries.push_back({ key, static_cast<uint32_t>(m_Commands.size()) });
+    m_Commands.push_back(command);
+}
+
+void DrawQueue::Execute(RenderContext& context)
+{
+    auto start = std::chrono::steady_clock::now();
+    m_Scratch.resize(m_Entries.size());
+    RadixSortDrawKeys(m_Entries.data(), m_Scratch.data(), m_Entries.size());
+    auto sorted = std::chrono::steady_clock::now();
+
+    // Nothing is known about the context's state before the first draw
+    DrawCommand bound;
+    bool first = true;
+    for (const DrawSortEntry& entry : m_Entries)
+    {
+        const DrawCommand& command = m_Commands[entry.Index];
+        uint64_t binds = m_Stats.Binds;
+
+        if (first || bound.RasterizerState.Id != command.RasterizerState.Id)
+        {
+            context.SetRasterizerState(command.RasterizerState);
+            ++m_Stats.Binds;
+        }
+        if (first || bound.VertexShader.Id != command.VertexShader.Id)
+        {
+            context.SetVertexShader(command.VertexShader);
+            ++m_Stats.Binds;
+        }
+        if (first || bound.PixelShader.Id != command.PixelShader.Id)
+        {
+            context.SetPixelShader(command.PixelShader);
+            ++m_Stats.Binds;
+        }
+        if (first || bound.VertexBuffer.Id != command.VertexBuffer.Id || bound.VertexStride != command.VertexStride ||
+            bound.VertexOffset != command.VertexOffset)
+        {
+            context.SetVertexBuffer(0, command.VertexBuffer, command.VertexStride, command.VertexOffset);
+            ++m_Stats.Binds;
+        }
+        if (first || bound.IndexBuffer.Id != command.IndexBuffer.Id || bound.IndexFormat != command.IndexFormat ||
+            bound.IndexOffset != command.IndexOffset)
+        {
+            context.SetIndexBuffer(command.IndexBuffer, command.IndexFormat, command.IndexOffset);
+            ++m_Stats.Binds;
+        }
+
+        // A draw without constants in a slot leaves whatever is bound there alone
+        uint64_t possible = 5;
+        if (command.VSConstants)
+        {
+            ++possible;
+            if (first || !SameRange(bound.VSConstants, command.VSConstants))
+            {
+                context.SetVSConstantBufferRange(0, command.VSConstants);
+                ++m_Stats.Binds;
+            }
+        }
+        if (command.PSConstants)
+        {
+            ++possible;
+            if (first || !SameRange(bound.PSConstants, command.PSConstants))
+            {
+                context.SetPSConstantBufferRange(0, command.PSConstants);
+                ++m_Stats.Binds;
+            }
+        }
+        m_Stats.SkippedBinds += possible - (m_Stats.Binds - binds);
+
+        context.DrawIndexed(command.IndexCount, command.StartIndex, command.BaseVertex);
+        ++m_Stats.Draws;
+
+        ConstantBufferRange vsConstants = command.VSConstants ? command.VSConstants : bound.VSConstants;
+        ConstantBufferRange psConstants = command.PSConstants ? command.PSConstants : bound.PSConstants;
+        bound = command;
+        bound.VSConstants = vsConstants;
+        bound.PSConstants = psConstants;
+        first = false;
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    m_Stats.SortMs += std::chrono::duration<double, std::milli>(sorted - start).count();
+    m_Stats.ExecuteMs += std::chrono::duration<double, std::milli>(end - sorted).count();
+    Reset();
+}
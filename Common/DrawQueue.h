@@ -0,0 +1,112 @@
+#pragma once
+
+// Sort-then-submit command queue. Instead of binding state in the order the
+// drawing code happens to run (DrawScene sets the rasterizer state, shaders
+// and constants before every cube), each draw is submitted with a 64-bit key
+// and its full binding set. Execute() radix-sorts the keys and replays the
+// draws, skipping every bind that matches what the previous draw left bound,
+// so draws sharing a shader or rasterizer state pay for it once.
+//
+// Key layout, most significant bits first:
+//   pass (4) | shader (12) | rasterizer state (8) | mesh (16) | depth (24)
+// Sorting groups draws by pass, then by the most expensive state to change;
+// within a group, opaque draws go front to back. Equal keys keep their
+// submission order.
+
+#include <cstdint>
+#include <vector>
+
+#include "RenderDevice.h"
+
+constexpr uint32_t DrawKeyPassBits = 4;
+constexpr uint32_t DrawKeyShaderBits = 12;
+constexpr uint32_t DrawKeyRasterizerBits = 8;
+constexpr uint32_t DrawKeyMeshBits = 16;
+constexpr uint32_t DrawKeyDepthBits = 24;
+
+static_assert(DrawKeyPassBits + DrawKeyShaderBits + DrawKeyRasterizerBits + DrawKeyMeshBits + DrawKeyDepthBits == 64,
+    "Draw key fields must fill 64 bits");
+
+// Each field is an id chosen by the caller (e.g. a handle Id) and is truncated to its width
+constexpr uint64_t MakeDrawKey(uint32_t pass, uint32_t shader, uint32_t rasterizerState, uint32_t mesh, uint32_t depth)
+{
+    uint64_t key = pass & ((1u << DrawKeyPassBits) - 1);
+    key = (key << DrawKeyShaderBits) | (shader & ((1u << DrawKeyShaderBits) - 1));
+    key = (key << DrawKeyRasterizerBits) | (rasterizerState & ((1u << DrawKeyRasterizerBits) - 1));
+    key = (key << DrawKeyMeshBits) | (mesh & ((1u << DrawKeyMeshBits) - 1));
+    key = (key << DrawKeyDepthBits) | (depth & ((1u << DrawKeyDepthBits) - 1));
+    return key;
+}
+
+// Maps a depth in [0, 1] (e.g. view depth / far plane) to the key's depth field;
+// pass backToFront for blended draws so the farthest sorts first
+inline uint32_t QuantizeDrawDepth(float depth, bool backToFront = false)
+{
+    constexpr uint32_t maxDepth = (1u << DrawKeyDepthBits) - 1;
+    // float has only 24 bits of mantissa, so scale in double to reach maxDepth exactly
+    double clamped = depth < 0.0f ? 0.0 : (depth > 1.0f ? 1.0 : depth);
+    uint32_t quantized = static_cast<uint32_t>(clamped * maxDepth + 0.5);
+    return backToFront ? maxDepth - quantized : quantized;
+}
+
+// Everything one DrawIndexed needs bound; slot 0 only, like the tutorials
+struct DrawCommand
+{
+    VertexShaderHandle VertexShader;
+    PixelShaderHandle PixelShader;
+    RasterizerStateHandle RasterizerState;
+    BufferHandle VertexBuffer;
+    uint32_t VertexStride = 0;
+    uint32_t VertexOffset = 0;
+    BufferHandle IndexBuffer;
+    Format IndexFormat = Format::R16UInt;
+    uint32_t IndexOffset = 0;
+    // From RenderContext::AllocateConstants, valid until the frame is presented
+    ConstantBufferRange VSConstants;
+    ConstantBufferRange PSConstants;
+    uint32_t IndexCount = 0;
+    uint32_t StartIndex = 0;
+    int32_t BaseVertex = 0;
+};
+
+struct DrawQueueStats
+{
+    uint64_t Draws = 0;
+    uint64_t Binds = 0;            // Set* calls issued by Execute
+    uint64_t SkippedBinds = 0;     // Set* calls avoided because the state was already bound
+    double SortMs = 0.0;
+    double ExecuteMs = 0.0;
+};
+
+struct DrawSortEntry
+{
+    uint64_t Key;
+    uint32_t Index;
+};
+
+// Stable LSD radix sort on Key, 8 bits per pass. Passes where every key has the
+// same byte are skipped. The result ends up in entries; scratch must hold count entries.
+void RadixSortDrawKeys(DrawSortEntry* entries, DrawSortEntry* scratch, size_t count);
+
+class DrawQueue
+{
+public:
+    // Empties the queue for a new frame; keeps the allocations
+    void Reset();
+
+    void Submit(uint64_t key, const DrawCommand& command);
+
+    // Sorts by key and replays on context with redundant binds removed, then empties the queue
+    void Execute(RenderContext& context);
+
+    size_t GetSize() const { return m_Commands.size(); }
+
+    const DrawQueueStats& GetStats() const { return m_Stats; }
+    void ResetStats() { m_Stats = {}; }
+
+private:
+    std::vector<DrawCommand> m_Commands;
+    std::vector<DrawSortEntry> m_Entries;
+    std::vector<DrawSortEntry> m_Scratch;
+    DrawQueueStats m_Stats;
+};
@@ -0,0 +1,58 @@
+#include "DynamicVertexStream.h"
+
+bool DynamicVertexStream::Initialize(RenderDevice& device, uint32_t capacity)
+{
+    BufferDesc desc;
+    desc.ByteWidth = capacity;
+    desc.Bind = BufferBind::VertexBuffer;
+    desc.Usage = BufferUsage::Dynamic;
+    if (!device.CreateBuffer(desc, nullptr, &m_Buffer))
+        return false;
+
+    m_Capacity = capacity;
+    m_Head = 0;
+    m_NeedsDiscard = true;
+    return true;
+}
+
+bool DynamicVertexStream::Write(RenderContext& context, const void* vertices, uint32_t stride, uint32_t vertexCount,
+    VertexStreamRange* range)
+{
+    *range = {};
+    uint64_t size = uint64_t(stride) * vertexCount;
+    if (size == 0 || size > m_Capacity)
+    {
+        ++m_Stats.Failures;
+        return false;
+    }
+
+    // Round the head up to a whole vertex so the range also works as a BaseVertex
+    uint64_t offset = (uint64_t(m_Head) + stride - 1) / stride * stride;
+    if (m_NeedsDiscard || offset + size > m_Capacity)
+    {
+        // A fresh buffer from the driver; draws already submitted keep the old one
+        offset = 0;
+        context.UpdateBuffer(m_Buffer, vertices, static_cast<uint32_t>(size));
+        m_NeedsDiscard = false;
+        ++m_Stats.Discards;
+    }
+    else
+    {
+        context.UpdateBufferRange(m_Buffer, static_cast<uint32_t>(offset), vertices, static_cast<uint32_t>(size));
+    }
+
+    m_Head = static_cast<uint32_t>(offset + size);
+    range->Offset = static_cast<uint32_t>(offset);
+    range->BaseVertex = static_cast<int32_t>(offset / stride);
+    range->VertexCount = vertexCount;
+    ++m_Stats.Writes;
+    m_Stats.BytesWritten += size;
+    m_FrameBytes += size;
+    return true;
+}
+
+void DynamicVertexStream::EndFrame()
+{
+    m_LastFrameBytes = m_FrameBytes;
+    m_FrameBytes = 0;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+// Per-frame vertex data (CPU-animated geometry, particles, debug lines) streamed
+// through one persistent Dynamic vertex buffer instead of re-creating Default
+// buffers. Writes are appended front to back, each copying only its own bytes
+// with a WRITE_NO_OVERWRITE map (RenderContext::UpdateBufferRange), so earlier
+// writes stay intact for draws already submitted. A write that does not fit
+// before the end wraps to the front with a WRITE_DISCARD map (UpdateBuffer):
+// the driver renames the buffer, so the GPU keeps reading the old contents and
+// no fences or frame tracking are needed, unlike ConstantBufferRing.
+//
+// Writes start at a multiple of their vertex stride, so a range can be drawn
+// either with its byte Offset in SetVertexBuffer or with BaseVertex and the
+// buffer bound at offset 0. Use it on the immediate context: a deferred
+// context must discard before its first NO_OVERWRITE map of a buffer.
+
+#include <cstdint>
+
+#include "RenderDevice.h"
+
+struct VertexStreamRange
+{
+    uint32_t Offset = 0;        // Bytes
+    int32_t BaseVertex = 0;     // Offset / stride
+    uint32_t VertexCount = 0;
+
+    explicit operator bool() const { return VertexCount != 0; }
+};
+
+struct VertexStreamStats
+{
+    uint64_t Writes = 0;
+    uint64_t BytesWritten = 0;
+    uint64_t Discards = 0;      // Wraps to the front
+    uint64_t Failures = 0;
+};
+
+class DynamicVertexStream
+{
+public:
+    // Creates the Dynamic vertex buffer of capacity bytes
+    bool Initialize(RenderDevice& device, uint32_t capacity);
+
+    // Copies vertexCount vertices of stride bytes into the buffer. Returns false, writing
+    // nothing, when they are empty or larger than the buffer.
+    bool Write(RenderContext& context, const void* vertices, uint32_t stride, uint32_t vertexCount,
+        VertexStreamRange* range);
+
+    // Closes the frame's byte count
+    void EndFrame();
+
+    BufferHandle GetBuffer() const { return m_Buffer; }
+    uint32_t GetCapacity() const { return m_Capacity; }
+    // Bytes written during the last closed frame and during the current one
+    uint64_t GetLastFrameBytes() const { return m_LastFrameBytes; }
+    uint64_t GetFrameBytes() const { return m_FrameBytes; }
+
+    const VertexStreamStats& GetStats() const { return m_Stats; }
+    void ResetStats() { m_Stats = {}; }
+
+private:
+    BufferHandle m_Buffer;
+    uint32_t m_Capacity = 0;
+    uint32_t m_Head = 0;
+    bool m_NeedsDiscard = true;     // Nothing written since the buffer was created
+    uint64_t m_FrameBytes = 0;
+    uint64_t m_LastFrameBytes = 0;
+    VertexStreamStats m_Stats;
+};
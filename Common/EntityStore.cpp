@@ -0,0 +1,315 @@
+#include "EntityStore.h"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+#include "JobSystem.h"
+
+namespace
+{
+    // Chunks and the arrays in them start on cache lines, so arrays of different
+    // components never share one and 8-wide SIMD loads stay aligned
+    constexpr size_t CacheLineSize = 64;
+
+    size_t AlignUp(size_t value, size_t alignment)
+    {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+
+    uint8_t* NewChunk()
+    {
+        return static_cast<uint8_t*>(::operator new(EntityStore::ChunkSize, std::align_val_t(CacheLineSize)));
+    }
+
+    void DeleteChunk(uint8_t* chunk)
+    {
+        ::operator delete(chunk, std::align_val_t(CacheLineSize));
+    }
+}
+
+EntityStore::~EntityStore()
+{
+    for (Archetype& archetype : m_Archetypes)
+    {
+        for (uint8_t* chunk : archetype.Chunks)
+            DeleteChunk(chunk);
+    }
+    ReleasePooledChunks();
+}
+
+uint32_t EntityStore::RegisterComponent(uint32_t size, uint32_t alignment)
+{
+    if (m_ComponentCount == MaxComponents || size == 0 || alignment == 0 || alignment > CacheLineSize ||
+        (alignment & (alignment - 1)) != 0)
+    {
+        return NoComponent;
+    }
+    m_ComponentSizes[m_ComponentCount] = size;
+    return m_ComponentCount++;
+}
+
+uint32_t EntityStore::Layout(ComponentMask components, uint32_t* offsets) const
+{
+    if (m_ComponentCount < MaxComponents && (components >> m_ComponentCount) != 0)
+        return 0;
+
+    // Entity handles first, then one array per component in id order; the largest row count
+    // whose arrays fit the chunk after padding
+    size_t rowSize = sizeof(Entity);
+    for (uint32_t component = 0; component < m_ComponentCount; ++component)
+    {
+        if (components & ComponentBit(component))
+            rowSize += m_ComponentSizes[component];
+    }
+    for (size_t capacity = ChunkSize / rowSize; capacity > 0; --capacity)
+    {
+        size_t offset = capacity * sizeof(Entity);
+        for (uint32_t component = 0; component < MaxComponents; ++component)
+        {
+            offsets[component] = EntityChunk::NoOffset;
+            if (components & ComponentBit(component))
+            {
+                offset = AlignUp(offset, CacheLineSize);
+                offsets[component] = static_cast<uint32_t>(offset);
+                offset += capacity * m_ComponentSizes[component];
+            }
+        }
+        if (offset <= ChunkSize)
+            return static_cast<uint32_t>(capacity);
+    }
+    return 0;
+}
+
+uint32_t EntityStore::FindArchetype(ComponentMask components)
+{
+    auto found = m_ArchetypeIndices.find(components);
+    if (found != m_ArchetypeIndices.end())
+        return found->second;
+
+    Archetype archetype;
+    archetype.Components = components;
+    archetype.Capacity = Layout(components, archetype.Offsets);
+    if (archetype.Capacity == 0)
+        return NoArchetype;
+    for (uint32_t component = 0; component < m_ComponentCount; ++component)
+    {
+        if (components & ComponentBit(component))
+            archetype.ComponentList.push_back(component);
+    }
+
+    uint32_t index = static_cast<uint32_t>(m_Archetypes.size());
+    m_Archetypes.push_back(std::move(archetype));
+    m_ArchetypeIndices.emplace(components, index);
+    return index;
+}
+
+Entity* EntityStore::GetEntitySlot(const Archetype& archetype, uint32_t row) const
+{
+    return reinterpret_cast<Entity*>(archetype.Chunks[row / archetype.Capacity]) + row % archetype.Capacity;
+}
+
+uint8_t* EntityStore::GetElement(const Archetype& archetype, uint32_t component, uint32_t row) const
+{
+    return archetype.Chunks[row / archetype.Capacity] + archetype.Offsets[component] +
+        static_cast<size_t>(row % archetype.Capacity) * m_ComponentSizes[component];
+}
+
+uint32_t EntityStore::AllocateRow(Archetype& archetype, Entity entity)
+{
+    if (archetype.EntityCount == archetype.Chunks.size() * archetype.Capacity)
+    {
+        if (m_FreeChunks.empty())
+        {
+            archetype.Chunks.push_back(NewChunk());
+        }
+        else
+        {
+            archetype.Chunks.push_back(m_FreeChunks.back());
+            m_FreeChunks.pop_back();
+        }
+        ++m_ChunkCount;
+    }
+
+    uint32_t row = archetype.EntityCount++;
+    *GetEntitySlot(archetype, row) = entity;
+    for (uint32_t component : archetype.ComponentList)
+        std::memset(GetElement(archetype, component, row), 0, m_ComponentSizes[component]);
+    return row;
+}
+
+void EntityStore::RemoveRow(Archetype& archetype, uint32_t row)
+{
+    // The last entity fills the hole, keeping the rows packed
+    uint32_t last = archetype.EntityCount - 1;
+    if (row != last)
+    {
+        for (uint32_t component : archetype.ComponentList)
+        {
+            std::memcpy(GetElement(archetype, component, row), GetElement(archetype, component, last),
+                m_ComponentSizes[component]);
+        }
+        Entity moved = *GetEntitySlot(archetype, last);
+        *GetEntitySlot(archetype, row) = moved;
+        m_Records[moved.Index].Row = row;
+    }
+
+    --archetype.EntityCount;
+    if (archetype.EntityCount <= (archetype.Chunks.size() - 1) * archetype.Capacity)
+    {
+        m_FreeChunks.push_back(archetype.Chunks.back());
+        archetype.Chunks.pop_back();
+        --m_ChunkCount;
+    }
+}
+
+Entity EntityStore::Create(ComponentMask components)
+{
+    uint32_t archetype = FindArchetype(components);
+    if (archetype == NoArchetype)
+        return Entity{};
+
+    Entity entity;
+    if (!m_FreeIndices.empty())
+    {
+        entity.Index = m_FreeIndices.back();
+        entity.Generation = m_Records[entity.Index].Generation;
+        m_FreeIndices.pop_back();
+    }
+    else
+    {
+        entity.Index = static_cast<uint32_t>(m_Records.size());
+        m_Records.push_back({ NoArchetype, 0, 0 });
+    }
+
+    uint32_t row = AllocateRow(m_Archetypes[archetype], entity);
+    m_Records[entity.Index].Archetype = archetype;
+    m_Records[entity.Index].Row = row;
+    ++m_EntityCount;
+    return entity;
+}
+
+void EntityStore::Destroy(Entity entity)
+{
+    if (!IsAlive(entity))
+        return;
+
+    Record& record = m_Records[entity.Index];
+    RemoveRow(m_Archetypes[record.Archetype], record.Row);
+    record.Archetype = NoArchetype;
+    ++record.Generation;
+    m_FreeIndices.push_back(entity.Index);
+    --m_EntityCount;
+}
+
+bool EntityStore::IsAlive(Entity entity) const
+{
+    return entity.Index < m_Records.size() && m_Records[entity.Index].Archetype != NoArchetype &&
+        m_Records[entity.Index].Generation == entity.Generation;
+}
+
+ComponentMask EntityStore::GetComponents(Entity entity) const
+{
+    return IsAlive(entity) ? m_Archetypes[m_Records[entity.Index].Archetype].Components : 0;
+}
+
+bool EntityStore::AddComponents(Entity entity, ComponentMask components)
+{
+    return MoveEntity(entity, GetComponents(entity) | components);
+}
+
+bool EntityStore::RemoveComponents(Entity entity, ComponentMask components)
+{
+    return MoveEntity(entity, GetComponents(entity) & ~components);
+}
+
+bool EntityStore::MoveEntity(Entity entity, ComponentMask components)
+{
+    if (!IsAlive(entity))
+        return false;
+    Record& record = m_Records[entity.Index];
+    if (m_Archetypes[record.Archetype].Components == components)
+        return true;
+
+    // Found before taking references: a new archetype may move the others
+    uint32_t target = FindArchetype(components);
+    if (target == NoArchetype)
+        return false;
+    Archetype& from = m_Archetypes[record.Archetype];
+    Archetype& to = m_Archetypes[target];
+
+    uint32_t row = AllocateRow(to, entity);
+    for (uint32_t component : to.ComponentList)
+    {
+        if (from.Components & ComponentBit(component))
+        {
+            std::memcpy(GetElement(to, component, row), GetElement(from, component, record.Row),
+                m_ComponentSizes[component]);
+        }
+    }
+    RemoveRow(from, record.Row);
+    record.Archetype = target;
+    record.Row = row;
+    return true;
+}
+
+void* EntityStore::GetComponent(Entity entity, uint32_t component)
+{
+    if (!IsAlive(entity) || component >= MaxComponents)
+        return nullptr;
+    const Record& record = m_Records[entity.Index];
+    const Archetype& archetype = m_Archetypes[record.Archetype];
+    if (!(archetype.Components & ComponentBit(component)))
+        return nullptr;
+    return GetElement(archetype, component, record.Row);
+}
+
+void EntityStore::ForEachChunk(JobSystem* jobSystem, ComponentMask required, const ChunkFunction& function)
+{
+    std::vector<EntityChunk> chunks;
+    for (const Archetype& archetype : m_Archetypes)
+    {
+        if ((archetype.Components & required) != required)
+            continue;
+        for (size_t chunk = 0; chunk < archetype.Chunks.size(); ++chunk)
+        {
+            EntityChunk view;
+            view.m_Data = archetype.Chunks[chunk];
+            view.m_Count = static_cast<uint32_t>(std::min<size_t>(archetype.Capacity,
+                archetype.EntityCount - chunk * archetype.Capacity));
+            view.m_Offsets = archetype.Offsets;
+            chunks.push_back(view);
+        }
+    }
+
+    if (jobSystem == nullptr)
+    {
+        for (const EntityChunk& chunk : chunks)
+            function(chunk, 0);
+        return;
+    }
+    jobSystem->ParallelFor(chunks.size(), 1, [&](size_t begin, size_t end, unsigned int workerIndex)
+    {
+        for (size_t i = begin; i < end; ++i)
+            function(chunks[i], workerIndex);
+    });
+}
+
+uint32_t EntityStore::GetChunkCapacity(ComponentMask components) const
+{
+    uint32_t offsets[MaxComponents];
+    return Layout(components, offsets);
+}
+
+size_t EntityStore::GetMemoryUsage() const
+{
+    return (m_ChunkCount + m_FreeChunks.size()) * ChunkSize + m_Records.capacity() * sizeof(Record) +
+        m_FreeIndices.capacity() * sizeof(uint32_t);
+}
+
+void EntityStore::ReleasePooledChunks()
+{
+    for (uint8_t* chunk : m_FreeChunks)
+        DeleteChunk(chunk);
+    m_FreeChunks.clear();
+}
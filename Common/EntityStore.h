@@ -0,0 +1,161 @@
+#pragma once
+
+// Entity storage for scenes with many objects, in place of a global per object
+// (the tutorials' g_World1, g_World2). An entity is a handle; its data lives in
+// components, plain structs registered once. Entities with the same set of
+// components form an archetype, stored as 16 KB chunks that hold one array per
+// component (structure of arrays). A system asks for the chunks whose
+// archetypes have the components it needs and walks their arrays linearly,
+// with chunks spread over a JobSystem.
+//
+// Chunks stay packed: removing an entity moves the archetype's last one into
+// its row, and emptied chunks go back to a pool for reuse. Adding or removing
+// components moves the entity to another archetype. Handles carry a
+// generation, so a handle to a destroyed entity is recognized as dead.
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+class JobSystem;
+
+struct Entity
+{
+    uint32_t Index = ~0u;
+    uint32_t Generation = 0;
+
+    bool operator==(const Entity& other) const = default;
+};
+
+// One bit per component id
+using ComponentMask = uint64_t;
+
+constexpr ComponentMask ComponentBit(uint32_t component)
+{
+    return ComponentMask(1) << component;
+}
+
+// The rows of one chunk, as handed to a system
+class EntityChunk
+{
+public:
+    uint32_t GetCount() const { return m_Count; }
+    const Entity* GetEntities() const { return reinterpret_cast<const Entity*>(m_Data); }
+    bool Has(uint32_t component) const { return m_Offsets[component] != NoOffset; }
+
+    // GetCount() elements; the component must be part of the query
+    template <typename T>
+    T* Get(uint32_t component) const { return reinterpret_cast<T*>(m_Data + m_Offsets[component]); }
+
+private:
+    friend class EntityStore;
+    static constexpr uint32_t NoOffset = ~0u;
+
+    uint8_t* m_Data = nullptr;
+    uint32_t m_Count = 0;
+    const uint32_t* m_Offsets = nullptr;
+};
+
+class EntityStore
+{
+public:
+    static constexpr size_t ChunkSize = 16 * 1024;
+    static constexpr uint32_t MaxComponents = 64;
+    static constexpr uint32_t NoComponent = ~0u;
+
+    // Called once per matching chunk, with the executing worker (0 without a JobSystem)
+    using ChunkFunction = std::function<void(const EntityChunk& chunk, unsigned int workerIndex)>;
+
+    EntityStore() = default;
+    ~EntityStore();
+
+    EntityStore(const EntityStore&) = delete;
+    EntityStore& operator=(const EntityStore&) = delete;
+
+    // Components are copied bytewise and start zeroed, aligned to at most 64 bytes; returns the id,
+    // or NoComponent when all MaxComponents ids are taken
+    uint32_t RegisterComponent(uint32_t size, uint32_t alignment);
+    template <typename T>
+    uint32_t RegisterComponent()
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "components are copied bytewise");
+        return RegisterComponent(sizeof(T), alignof(T));
+    }
+
+    // Returns an invalid handle (Index ~0u) when one row of these components does not fit a chunk
+    Entity Create(ComponentMask components);
+    void Destroy(Entity entity);
+    bool IsAlive(Entity entity) const;
+    ComponentMask GetComponents(Entity entity) const;
+
+    // Moves the entity to the archetype with the components added or removed; the components it
+    // keeps keep their values and new ones start zeroed
+    bool AddComponents(Entity entity, ComponentMask components);
+    bool RemoveComponents(Entity entity, ComponentMask components);
+
+    // Null when the entity is dead or lacks the component; valid until entities are created,
+    // destroyed or change components
+    void* GetComponent(Entity entity, uint32_t component);
+    template <typename T>
+    T* Get(Entity entity, uint32_t component) { return static_cast<T*>(GetComponent(entity, component)); }
+
+    // Calls function for every chunk whose entities have all the required components, in
+    // parallel when jobSystem is not null. Each call must only touch its own chunk, and no
+    // entity may be created, destroyed or changed until ForEachChunk returns.
+    void ForEachChunk(JobSystem* jobSystem, ComponentMask required, const ChunkFunction& function);
+
+    size_t GetEntityCount() const { return m_EntityCount; }
+    size_t GetArchetypeCount() const { return m_Archetypes.size(); }
+    size_t GetChunkCount() const { return m_ChunkCount; }
+    // Rows per chunk of the archetype with exactly these components, 0 if a row does not fit
+    uint32_t GetChunkCapacity(ComponentMask components) const;
+    // Chunks in use and pooled, plus the entity table
+    size_t GetMemoryUsage() const;
+    // Frees the chunks kept for reuse after entities were removed
+    void ReleasePooledChunks();
+
+private:
+    struct Archetype
+    {
+        ComponentMask Components = 0;
+        uint32_t Capacity = 0;
+        uint32_t Offsets[MaxComponents];
+        std::vector<uint32_t> ComponentList;
+        std::vector<uint8_t*> Chunks;
+        uint32_t EntityCount = 0;
+    };
+
+    // Where an entity lives: row Row of its archetype, in chunk Row / Capacity
+    struct Record
+    {
+        uint32_t Archetype;
+        uint32_t Row;
+        uint32_t Generation;
+    };
+
+    static constexpr uint32_t NoArchetype = ~0u;
+
+    uint32_t Layout(ComponentMask components, uint32_t* offsets) const;
+    uint32_t FindArchetype(ComponentMask components);
+    Entity* GetEntitySlot(const Archetype& archetype, uint32_t row) const;
+    uint8_t* GetElement(const Archetype& archetype, uint32_t component, uint32_t row) const;
+    uint32_t AllocateRow(Archetype& archetype, Entity entity);
+    void RemoveRow(Archetype& archetype, uint32_t row);
+    bool MoveEntity(Entity entity, ComponentMask components);
+
+    uint32_t m_ComponentSizes[MaxComponents] = {};
+    uint32_t m_ComponentCount = 0;
+
+    std::vector<Archetype> m_Archetypes;
+    std::unordered_map<ComponentMask, uint32_t> m_ArchetypeIndices;
+
+    std::vector<Record> m_Records;
+    std::vector<uint32_t> m_FreeIndices;
+    size_t m_EntityCount = 0;
+
+    std::vector<uint8_t*> m_FreeChunks;
+    size_t m_ChunkCount = 0;
+};
@@ -0,0 +1,155 @@
+#include "FrameBenchmark.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    double ToMs(Clock::duration duration)
+    {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    }
+
+    void AppendSummary(std::string& json, const char* name, const LatencySummary& summary)
+    {
+        char buffer[256];
+        std::snprintf(buffer, sizeof(buffer),
+            "\"%s\":{\"mean\":%.6f,\"p50\":%.6f,\"p95\":%.6f,\"p99\":%.6f,\"max\":%.6f}",
+            name, summary.Mean, summary.P50, summary.P95, summary.P99, summary.Max);
+        json += buffer;
+    }
+}
+
+LatencySummary SummarizeLatency(std::vector<double>& samples)
+{
+    LatencySummary summary;
+    if (samples.empty())
+        return summary;
+
+    std::sort(samples.begin(), samples.end());
+    auto percentile = [&](double p)
+    {
+        size_t rank = static_cast<size_t>(std::ceil(p * samples.size()));
+        return samples[std::min(samples.size(), std::max<size_t>(rank, 1)) - 1];
+    };
+
+    double sum = 0.0;
+    for (double sample : samples)
+        sum += sample;
+
+    summary.Mean = sum / samples.size();
+    summary.P50 = percentile(0.50);
+    summary.P95 = percentile(0.95);
+    summary.P99 = percentile(0.99);
+    summary.Max = samples.back();
+    return summary;
+}
+
+FrameBenchmarkResult RunFrameBenchmark(Scene& scene, RenderDevice& device, const FrameBenchmarkOptions& options)
+{
+    FrameBenchmarkResult result;
+    result.SceneName = scene.GetName();
+    result.BackendName = device.GetName();
+
+    RenderContext& context = device.GetImmediateContext();
+    float t = 0.0f;
+
+    for (uint32_t frame = 0; frame < options.WarmupFrames; ++frame)
+    {
+        scene.Update(t);
+        scene.Draw(context);
+        device.Present();
+        t += options.TimeStep;
+    }
+    context.ResetStats();
+
+    bool timed = options.DurationSeconds > 0.0;
+    if (!timed)
+        result.Timings.reserve(options.Frames);
+
+    Clock::time_point start = Clock::now();
+    Clock::time_point deadline = start + std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(options.DurationSeconds));
+
+    for (uint32_t frame = 0; timed || frame < options.Frames; ++frame)
+    {
+        Clock::time_point frameStart = Clock::now();
+        scene.Update(t);
+        Clock::time_point updateEnd = Clock::now();
+        scene.Draw(context);
+        Clock::time_point submitEnd = Clock::now();
+        bool presented = device.Present();
+        Clock::time_point presentEnd = Clock::now();
+
+        result.Timings.push_back({ ToMs(updateEnd - frameStart), ToMs(submitEnd - updateEnd),
+            ToMs(presentEnd - submitEnd), ToMs(presentEnd - frameStart) });
+        t += options.TimeStep;
+
+        if (!presented || (timed && presentEnd >= deadline))
+            break;
+    }
+
+    result.WallSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+    result.Frames = static_cast<uint32_t>(result.Timings.size());
+    result.Stats = context.GetStats();
+
+    std::vector<double> samples(result.Timings.size());
+    auto summarize = [&](double FrameTiming::*field)
+    {
+        for (size_t i = 0; i < result.Timings.size(); ++i)
+            samples[i] = result.Timings[i].*field;
+        return SummarizeLatency(samples);
+    };
+    result.Update = summarize(&FrameTiming::UpdateMs);
+    result.Submit = summarize(&FrameTiming::SubmitMs);
+    result.Present = summarize(&FrameTiming::PresentMs);
+    result.Total = summarize(&FrameTiming::TotalMs);
+    return result;
+}
+
+std::string FrameBenchmarkToJson(const FrameBenchmarkResult& result)
+{
+    double frames = std::max<double>(1.0, result.Frames);
+    char buffer[512];
+    std::snprintf(buffer, sizeof(buffer),
+        "{\"scene\":\"%s\",\"backend\":\"%s\",\"frames\":%u,\"wall_seconds\":%.6f,\"fps\":%.3f,"
+        "\"draws_per_frame\":%.3f,\"state_changes_per_frame\":%.3f,\"bytes_uploaded_per_frame\":%.3f,",
+        result.SceneName.c_str(), result.BackendName.c_str(), result.Frames, result.WallSeconds,
+        result.WallSeconds > 0.0 ? result.Frames / result.WallSeconds : 0.0,
+        result.Stats.Draws / frames, result.Stats.StateChanges / frames, result.Stats.BytesUploaded / frames);
+
+    std::string json = buffer;
+    AppendSummary(json, "update_ms", result.Update);
+    json += ',';
+    AppendSummary(json, "submit_ms", result.Submit);
+    json += ',';
+    AppendSummary(json, "present_ms", result.Present);
+    json += ',';
+    AppendSummary(json, "frame_ms", result.Total);
+    json += '}';
+    return json;
+}
+
+void PrintFrameBenchmarkHeader()
+{
+    std::printf("%-16s %-9s %8s %10s | %-29s | %-29s | %-29s | %-29s\n", "scene", "backend", "frames", "fps",
+        "update ms p50/p95/p99/max", "submit ms p50/p95/p99/max", "present ms p50/p95/p99/max", "frame ms p50/p95/p99/max");
+}
+
+void PrintFrameBenchmarkResult(const FrameBenchmarkResult& result)
+{
+    auto cell = [](const LatencySummary& s)
+    {
+        char buffer[64];
+        std::snprintf(buffer, sizeof(buffer), "%6.4f/%6.4f/%6.4f/%6.4f", s.P50, s.P95, s.P99, s.Max);
+        return std::string(buffer);
+    };
+
+    std::printf("%-16s %-9s %8u %10.1f | %-29s | %-29s | %-29s | %-29s\n", result.SceneName.c_str(),
+        result.BackendName.c_str(), result.Frames, result.WallSeconds > 0.0 ? result.Frames / result.WallSeconds : 0.0,
+        cell(result.Update).c_str(), cell(result.Submit).c_str(), cell(result.Present).c_str(), cell(result.Total).c_str());
+}
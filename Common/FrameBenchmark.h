@@ -0,0 +1,69 @@
+#pragma once
+
+// Replays Scene::Update / Scene::Draw / RenderDevice::Present for a fixed number
+// of frames (or a fixed duration) and records the CPU time of each part per frame.
+// Results are summarized as latency percentiles and can be written as JSON so
+// runs can be compared over time.
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Scene.h"
+
+struct FrameBenchmarkOptions
+{
+    // Number of measured frames; ignored when DurationSeconds > 0
+    uint32_t Frames = 1000;
+    // Run for this long instead of a fixed frame count
+    double DurationSeconds = 0.0;
+    // Frames run before measuring so buffers and caches are warm
+    uint32_t WarmupFrames = 10;
+    // Scene time advanced per frame, so runs are deterministic
+    float TimeStep = 1.0f / 60.0f;
+};
+
+// Per-frame CPU time in milliseconds
+struct FrameTiming
+{
+    double UpdateMs;
+    double SubmitMs;
+    double PresentMs;
+    double TotalMs;
+};
+
+struct LatencySummary
+{
+    double Mean = 0.0;
+    double P50 = 0.0;
+    double P95 = 0.0;
+    double P99 = 0.0;
+    double Max = 0.0;
+};
+
+struct FrameBenchmarkResult
+{
+    std::string SceneName;
+    std::string BackendName;
+    uint32_t Frames = 0;
+    double WallSeconds = 0.0;
+    LatencySummary Update;
+    LatencySummary Submit;
+    LatencySummary Present;
+    LatencySummary Total;
+    RenderStats Stats;
+    std::vector<FrameTiming> Timings;
+};
+
+// Nearest-rank percentiles of the samples (the vector is sorted in place)
+LatencySummary SummarizeLatency(std::vector<double>& samples);
+
+// The scene must already be initialized on the device
+FrameBenchmarkResult RunFrameBenchmark(Scene& scene, RenderDevice& device, const FrameBenchmarkOptions& options);
+
+// One JSON object per result, without the per-frame timings
+std::string FrameBenchmarkToJson(const FrameBenchmarkResult& result);
+
+// Human readable table row; PrintFrameBenchmarkHeader prints the matching header
+void PrintFrameBenchmarkHeader();
+void PrintFrameBenchmarkResult(const FrameBenchmarkResult& result);
@@ -0,0 +1,284 @@
+#include "FrustumCulling.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstring>
+
+#include "JobSystem.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define FRUSTUM_CULLING_AVX2 1
+#endif
+
+namespace
+{
+    enum Element
+    {
+        CenterX, CenterY, CenterZ, ExtentX, ExtentY, ExtentZ, Radius, ElementCount
+    };
+
+    // Objects per job of FrustumCuller, a multiple of the batch size
+    constexpr size_t ChunkSize = 16384;
+
+    Float4 NormalizePlane(float a, float b, float c, float d)
+    {
+        float length = std::sqrt(a * a + b * b + c * c);
+        float scale = length > 0.0f ? 1.0f / length : 0.0f;
+        return { a * scale, b * scale, c * scale, d * scale };
+    }
+
+#if defined(FRUSTUM_CULLING_AVX2)
+    constexpr size_t BatchSize = 8;
+
+    // Byte k of entry mask is the lane of the k-th set bit of mask
+    constexpr std::array<uint64_t, 256> MakeCompactionTable()
+    {
+        std::array<uint64_t, 256> table = {};
+        for (uint32_t mask = 0; mask < 256; ++mask)
+        {
+            uint32_t count = 0;
+            for (uint32_t lane = 0; lane < 8; ++lane)
+            {
+                if (mask & (1u << lane))
+                    table[mask] |= uint64_t(lane) << (8 * count++);
+            }
+        }
+        return table;
+    }
+
+    constexpr std::array<uint64_t, 256> CompactionTable = MakeCompactionTable();
+
+    size_t CullBatches(const Frustum& frustum, const BoundsArray& bounds, CullShape shape, size_t begin, size_t end,
+        uint32_t* visible, size_t* count)
+    {
+        __m256 planes[6][4], absPlanes[6][3];
+        for (int p = 0; p < 6; ++p)
+        {
+            const float plane[4] = { frustum.Planes[p].x, frustum.Planes[p].y, frustum.Planes[p].z,
+                frustum.Planes[p].w };
+            for (int k = 0; k < 4; ++k)
+                planes[p][k] = _mm256_set1_ps(plane[k]);
+            for (int k = 0; k < 3; ++k)
+                absPlanes[p][k] = _mm256_set1_ps(std::fabs(plane[k]));
+        }
+
+        const float* elements[ElementCount];
+        for (int e = 0; e < ElementCount; ++e)
+            elements[e] = bounds.GetElements(e);
+
+        const __m256 zero = _mm256_setzero_ps();
+        const __m256i laneOffsets = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+        size_t i = begin;
+        for (; i + BatchSize <= end; i += BatchSize)
+        {
+            __m256 cx = _mm256_loadu_ps(elements[CenterX] + i);
+            __m256 cy = _mm256_loadu_ps(elements[CenterY] + i);
+            __m256 cz = _mm256_loadu_ps(elements[CenterZ] + i);
+            __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+            if (shape == CullShape::Sphere)
+            {
+                __m256 radius = _mm256_loadu_ps(elements[Radius] + i);
+                for (int p = 0; p < 6; ++p)
+                {
+                    __m256 d = _mm256_add_ps(_mm256_mul_ps(cx, planes[p][0]), _mm256_mul_ps(cy, planes[p][1]));
+                    d = _mm256_add_ps(_mm256_add_ps(d, _mm256_mul_ps(cz, planes[p][2])), planes[p][3]);
+                    inside = _mm256_and_ps(inside, _mm256_cmp_ps(_mm256_add_ps(d, radius), zero, _CMP_GE_OQ));
+                }
+            }
+            else
+            {
+                __m256 ex = _mm256_loadu_ps(elements[ExtentX] + i);
+                __m256 ey = _mm256_loadu_ps(elements[ExtentY] + i);
+                __m256 ez = _mm256_loadu_ps(elements[ExtentZ] + i);
+                for (int p = 0; p < 6; ++p)
+                {
+                    __m256 d = _mm256_add_ps(_mm256_mul_ps(cx, planes[p][0]), _mm256_mul_ps(cy, planes[p][1]));
+                    d = _mm256_add_ps(_mm256_add_ps(d, _mm256_mul_ps(cz, planes[p][2])), planes[p][3]);
+                    __m256 r = _mm256_add_ps(_mm256_mul_ps(ex, absPlanes[p][0]), _mm256_mul_ps(ey, absPlanes[p][1]));
+                    r = _mm256_add_ps(r, _mm256_mul_ps(ez, absPlanes[p][2]));
+                    inside = _mm256_and_ps(inside, _mm256_cmp_ps(_mm256_add_ps(d, r), zero, _CMP_GE_OQ));
+                }
+            }
+
+            // Move the visible lanes' indices to the front; the store may write up to 8 indices,
+            // which fit because fewer than i + 8 - begin were written before
+            uint32_t mask = static_cast<uint32_t>(_mm256_movemask_ps(inside));
+            __m256i indices = _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(i)), laneOffsets);
+            __m256i permutation = _mm256_cvtepu8_epi32(
+                _mm_loadl_epi64(reinterpret_cast<const __m128i*>(&CompactionTable[mask])));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(visible + *count),
+                _mm256_permutevar8x32_epi32(indices, permutation));
+            *count += std::popcount(mask);
+        }
+        return i;
+    }
+#else
+    size_t CullBatches(const Frustum&, const BoundsArray&, CullShape, size_t begin, size_t, uint32_t*, size_t*)
+    {
+        return begin;
+    }
+#endif
+}
+
+Frustum ExtractFrustum(const Float4x4& viewProjection)
+{
+    // Clip coordinates are (x, y, z, 1) * M, so clip component j is a plane made of column j
+    Float4 columns[4];
+    for (int j = 0; j < 4; ++j)
+    {
+        columns[j] = { viewProjection.m[0][j], viewProjection.m[1][j], viewProjection.m[2][j],
+            viewProjection.m[3][j] };
+    }
+    const Float4& x = columns[0];
+    const Float4& y = columns[1];
+    const Float4& z = columns[2];
+    const Float4& w = columns[3];
+
+    // -w <= x <= w, -w <= y <= w, 0 <= z <= w
+    Frustum frustum;
+    frustum.Planes[0] = NormalizePlane(w.x + x.x, w.y + x.y, w.z + x.z, w.w + x.w);
+    frustum.Planes[1] = NormalizePlane(w.x - x.x, w.y - x.y, w.z - x.z, w.w - x.w);
+    frustum.Planes[2] = NormalizePlane(w.x + y.x, w.y + y.y, w.z + y.z, w.w + y.w);
+    frustum.Planes[3] = NormalizePlane(w.x - y.x, w.y - y.y, w.z - y.z, w.w - y.w);
+    frustum.Planes[4] = NormalizePlane(z.x, z.y, z.z, z.w);
+    frustum.Planes[5] = NormalizePlane(w.x - z.x, w.y - z.y, w.z - z.z, w.w - z.w);
+    return frustum;
+}
+
+BoundsArray::BoundsArray(size_t count)
+{
+    Resize(count);
+}
+
+void BoundsArray::Resize(size_t count)
+{
+    // Round up so a batch never reads into the next element array
+    size_t capacity = (count + 7) & ~size_t(7);
+    std::vector<float> elements(capacity * ElementCount, 0.0f);
+    size_t kept = std::min(count, m_Count);
+    for (int element = 0; element < ElementCount; ++element)
+    {
+        if (kept)
+            std::memcpy(elements.data() + element * capacity, GetElements(element), kept * sizeof(float));
+    }
+
+    m_Count = count;
+    m_Capacity = capacity;
+    m_Elements = std::move(elements);
+}
+
+void BoundsArray::Set(size_t index, const Float3& center, const Float3& extents)
+{
+    MutableElements(CenterX)[index] = center.x;
+    MutableElements(CenterY)[index] = center.y;
+    MutableElements(CenterZ)[index] = center.z;
+    MutableElements(ExtentX)[index] = extents.x;
+    MutableElements(ExtentY)[index] = extents.y;
+    MutableElements(ExtentZ)[index] = extents.z;
+    MutableElements(Radius)[index] = std::sqrt(Vector3Dot(extents, extents));
+}
+
+void BoundsArray::SetTransformed(size_t index, const Float3& center, const Float3& extents, const Float4x4& world)
+{
+    Float3 worldCenter, worldExtents;
+    BoxTransform(center, extents, world, &worldCenter, &worldExtents);
+    Set(index, worldCenter, worldExtents);
+}
+
+Float3 BoundsArray::GetCenter(size_t index) const
+{
+    return { GetElements(CenterX)[index], GetElements(CenterY)[index], GetElements(CenterZ)[index] };
+}
+
+Float3 BoundsArray::GetExtents(size_t index) const
+{
+    return { GetElements(ExtentX)[index], GetElements(ExtentY)[index], GetElements(ExtentZ)[index] };
+}
+
+size_t CullBounds(const Frustum& frustum, const BoundsArray& bounds, CullShape shape, size_t begin, size_t end,
+    uint32_t* visible)
+{
+    size_t count = 0;
+    size_t done = CullBatches(frustum, bounds, shape, begin, end, visible, &count);
+    return count + CullBoundsScalar(frustum, bounds, shape, done, end, visible + count);
+}
+
+size_t CullBoundsScalar(const Frustum& frustum, const BoundsArray& bounds, CullShape shape, size_t begin,
+    size_t end, uint32_t* visible)
+{
+    // Local copies so stores to visible cannot force reloads
+    const Frustum planes = frustum;
+    const float* elements[ElementCount];
+    for (int e = 0; e < ElementCount; ++e)
+        elements[e] = bounds.GetElements(e);
+
+    size_t count = 0;
+    for (size_t i = begin; i < end; ++i)
+    {
+        float cx = elements[CenterX][i], cy = elements[CenterY][i], cz = elements[CenterZ][i];
+        float radius = elements[Radius][i];
+        float ex = elements[ExtentX][i], ey = elements[ExtentY][i], ez = elements[ExtentZ][i];
+        bool inside = true;
+        for (const Float4& plane : planes.Planes)
+        {
+            // No early out: which plane rejects an object is as good as random
+            float d = plane.x * cx + plane.y * cy + plane.z * cz + plane.w;
+            float r = shape == CullShape::Sphere ? radius :
+                std::fabs(plane.x) * ex + std::fabs(plane.y) * ey + std::fabs(plane.z) * ez;
+            inside &= d + r >= 0.0f;
+        }
+
+        // Written either way, kept only when visible
+        visible[count] = static_cast<uint32_t>(i);
+        count += inside;
+    }
+    return count;
+}
+
+const char* GetFrustumCullingInstructionSet()
+{
+#if defined(FRUSTUM_CULLING_AVX2)
+    return "avx2";
+#else
+    return "scalar";
+#endif
+}
+
+size_t FrustumCuller::Cull(JobSystem* jobSystem, const Frustum& frustum, const BoundsArray& bounds,
+    CullShape shape)
+{
+    size_t objectCount = bounds.GetCount();
+    m_Visible.resize(objectCount);
+    size_t chunkCount = (objectCount + ChunkSize - 1) / ChunkSize;
+    if (!jobSystem || chunkCount <= 1)
+    {
+        m_VisibleCount = CullBounds(frustum, bounds, shape, 0, objectCount, m_Visible.data());
+        return m_VisibleCount;
+    }
+
+    m_ChunkCounts.resize(chunkCount);
+    jobSystem->ParallelFor(chunkCount, 1, [&](size_t first, size_t last, unsigned int)
+    {
+        for (size_t chunk = first; chunk < last; ++chunk)
+        {
+            size_t begin = chunk * ChunkSize, end = std::min(objectCount, begin + ChunkSize);
+            m_ChunkCounts[chunk] = CullBounds(frustum, bounds, shape, begin, end, m_Visible.data() + begin);
+        }
+    });
+
+    // Chunk c's indices start at c * ChunkSize; close the gaps in order
+    m_VisibleCount = 0;
+    for (size_t chunk = 0; chunk < chunkCount; ++chunk)
+    {
+        if (m_VisibleCount != chunk * ChunkSize)
+        {
+            std::memmove(m_Visible.data() + m_VisibleCount, m_Visible.data() + chunk * ChunkSize,
+                m_ChunkCounts[chunk] * sizeof(uint32_t));
+        }
+        m_VisibleCount += m_ChunkCounts[chunk];
+    }
+    return m_VisibleCount;
+}
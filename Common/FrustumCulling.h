@@ -0,0 +1,88 @@
+#pragma once
+
+// View-frustum culling of many objects before they are drawn. The six planes
+// are extracted from View * Projection once per frame; world-space bounds are
+// kept structure-of-arrays (like WorldMatrixArray) so the AVX2 kernel tests 8
+// objects per instruction, with a scalar loop for the tail and for builds
+// without AVX2. The result is a compact list of the indices that may be
+// visible, in ascending order, to loop over instead of every object.
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "MathUtil.h"
+
+class JobSystem;
+
+// Planes (a, b, c, d) with a * x + b * y + c * z + d >= 0 inside, normals of unit length:
+// left, right, bottom, top, near, far
+struct Frustum
+{
+    Float4 Planes[6];
+};
+
+// Planes of the clip volume of a row-vector View * Projection (D3D depth range 0..1)
+Frustum ExtractFrustum(const Float4x4& viewProjection);
+
+// World-space boxes given as center and half extents, plus the radius of the sphere around each
+class BoundsArray
+{
+public:
+    explicit BoundsArray(size_t count = 0);
+
+    void Resize(size_t count);
+    size_t GetCount() const { return m_Count; }
+
+    void Set(size_t index, const Float3& center, const Float3& extents);
+    // Box around the local box (center, extents) transformed by world
+    void SetTransformed(size_t index, const Float3& center, const Float3& extents, const Float4x4& world);
+
+    Float3 GetCenter(size_t index) const;
+    Float3 GetExtents(size_t index) const;
+
+    // Element arrays of GetCount() floats: center x, y, z, extents x, y, z, radius
+    const float* GetElements(int element) const { return m_Elements.data() + element * m_Capacity; }
+
+private:
+    float* MutableElements(int element) { return m_Elements.data() + element * m_Capacity; }
+
+    size_t m_Count = 0;
+    size_t m_Capacity = 0;
+    std::vector<float> m_Elements;
+};
+
+enum class CullShape
+{
+    Sphere,     // Cheapest, keeps more objects near the corners of the frustum
+    Box,
+};
+
+// Writes the indices in [begin, end) whose bounds are not fully outside a plane to visible,
+// which needs room for end - begin indices, and returns how many there are
+size_t CullBounds(const Frustum& frustum, const BoundsArray& bounds, CullShape shape, size_t begin, size_t end,
+    uint32_t* visible);
+
+// Same result one object at a time, used for the tail of a batch and as reference
+size_t CullBoundsScalar(const Frustum& frustum, const BoundsArray& bounds, CullShape shape, size_t begin,
+    size_t end, uint32_t* visible);
+
+// "avx2" or "scalar", chosen at compile time
+const char* GetFrustumCullingInstructionSet();
+
+// The visible list of a whole BoundsArray, culled in chunks on a JobSystem. Each chunk
+// writes its indices at its own position and the chunks are then moved together.
+class FrustumCuller
+{
+public:
+    // jobSystem may be null to cull on the calling thread; returns the visible count
+    size_t Cull(JobSystem* jobSystem, const Frustum& frustum, const BoundsArray& bounds, CullShape shape);
+
+    const uint32_t* GetVisible() const { return m_Visible.data(); }
+    size_t GetVisibleCount() const { return m_VisibleCount; }
+
+private:
+    std::vector<uint32_t> m_Visible;
+    std::vector<size_t> m_ChunkCounts;
+    size_t m_VisibleCount = 0;
+};
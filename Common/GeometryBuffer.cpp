@@ -0,0 +1,89 @@
+#include "GeometryBuffer.h"
+
+bool GeometryBuffer::Initialize(RenderDevice& device, const GeometryBufferDesc& desc)
+{
+    uint32_t indexSize = desc.IndexFormat == Format::R16UInt || desc.IndexFormat == Format::R32UInt ?
+        GetFormatSize(desc.IndexFormat) : 0;
+    uint64_t vertexBytes = uint64_t(desc.VertexStride) * desc.VertexCapacity;
+    uint64_t indexBytes = uint64_t(indexSize) * desc.IndexCapacity;
+    if (indexSize == 0 || vertexBytes == 0 || indexBytes == 0 || vertexBytes > UINT32_MAX || indexBytes > UINT32_MAX)
+        return false;
+
+    BufferDesc bd;
+    bd.ByteWidth = static_cast<uint32_t>(vertexBytes);
+    bd.Bind = BufferBind::VertexBuffer;
+    if (!device.CreateBuffer(bd, nullptr, &m_VertexBuffer))
+        return false;
+
+    bd.ByteWidth = static_cast<uint32_t>(indexBytes);
+    bd.Bind = BufferBind::IndexBuffer;
+    if (!device.CreateBuffer(bd, nullptr, &m_IndexBuffer))
+    {
+        device.ReleaseBuffer(m_VertexBuffer);
+        m_VertexBuffer = BufferHandle{};
+        return false;
+    }
+
+    m_Desc = desc;
+    m_IndexSize = indexSize;
+    m_VertexAllocator.Reset(desc.VertexCapacity);
+    m_IndexAllocator.Reset(desc.IndexCapacity);
+    return true;
+}
+
+bool GeometryBuffer::Add(RenderContext& context, const void* vertices, uint32_t vertexCount, const void* indices,
+    uint32_t indexCount, GeometryRange* range)
+{
+    *range = {};
+    if (vertexCount == 0 || indexCount == 0 || (m_IndexSize == 2 && vertexCount > 65536))
+        return false;
+
+    // BaseVertexLocation is signed
+    if (!m_VertexAllocator.Allocate(vertexCount, &range->Vertices) || range->Vertices.Offset > INT32_MAX)
+    {
+        m_VertexAllocator.Free(range->Vertices);
+        *range = {};
+        return false;
+    }
+    if (!m_IndexAllocator.Allocate(indexCount, &range->Indices))
+    {
+        m_VertexAllocator.Free(range->Vertices);
+        *range = {};
+        return false;
+    }
+
+    range->BaseVertex = static_cast<int32_t>(range->Vertices.Offset);
+    range->VertexCount = vertexCount;
+    range->FirstIndex = range->Indices.Offset;
+    range->IndexCount = indexCount;
+    context.UpdateBufferRange(m_VertexBuffer, range->Vertices.Offset * m_Desc.VertexStride, vertices,
+        vertexCount * m_Desc.VertexStride);
+    context.UpdateBufferRange(m_IndexBuffer, range->Indices.Offset * m_IndexSize, indices, indexCount * m_IndexSize);
+    return true;
+}
+
+void GeometryBuffer::Remove(GeometryRange* range)
+{
+    m_VertexAllocator.Free(range->Vertices);
+    m_IndexAllocator.Free(range->Indices);
+    *range = {};
+}
+
+void GeometryBuffer::Bind(RenderContext& context) const
+{
+    context.SetVertexBuffer(0, m_VertexBuffer, m_Desc.VertexStride, 0);
+    context.SetIndexBuffer(m_IndexBuffer, m_Desc.IndexFormat, 0);
+}
+
+void GeometryBuffer::FillDrawCommand(const GeometryRange& range, DrawCommand* command) const
+{
+    command->VertexBuffer = m_VertexBuffer;
+    command->VertexStride = m_Desc.VertexStride;
+    command->VertexOffset = 0;
+    command->IndexBuffer = m_IndexBuffer;
+    command->IndexFormat = m_Desc.IndexFormat;
+    command->IndexOffset = 0;
+    command->IndexCount = range.IndexCount;
+    command->StartIndex = range.FirstIndex;
+    command->BaseVertex = range.BaseVertex;
+}
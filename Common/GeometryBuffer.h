@@ -0,0 +1,80 @@
+#pragma once
+
+// One vertex buffer and one index buffer shared by every mesh of a vertex
+// format, instead of a g_pVertexBuffer / g_pIndexBuffer pair per mesh. Each
+// mesh gets a range of vertices and a range of indices from a RangeAllocator
+// and is uploaded into them with UpdateBufferRange; its indices stay relative
+// to its own first vertex, and DrawIndexed(IndexCount, FirstIndex, BaseVertex)
+// draws it. The buffers are bound once for all the meshes, so drawing many of
+// them costs no IASetVertexBuffers / IASetIndexBuffer calls in between, and
+// DrawQueue sees equal buffer bindings on every draw of the format.
+//
+// With R16UInt indices any mesh of up to 65536 vertices fits, whatever the
+// size of the shared buffer (MeshSplitter cuts larger meshes to that).
+
+#include <cstdint>
+
+#include "DrawQueue.h"
+#include "RangeAllocator.h"
+#include "RenderDevice.h"
+
+struct GeometryBufferDesc
+{
+    uint32_t VertexStride = 0;
+    uint32_t VertexCapacity = 0;        // Vertices
+    uint32_t IndexCapacity = 0;         // Indices
+    Format IndexFormat = Format::R16UInt;
+};
+
+// Where a mesh lives in a GeometryBuffer
+struct GeometryRange
+{
+    int32_t BaseVertex = 0;
+    uint32_t VertexCount = 0;
+    uint32_t FirstIndex = 0;
+    uint32_t IndexCount = 0;
+    RangeAllocation Vertices;
+    RangeAllocation Indices;
+
+    explicit operator bool() const { return static_cast<bool>(Vertices); }
+};
+
+class GeometryBuffer
+{
+public:
+    // Creates the two Default usage buffers
+    bool Initialize(RenderDevice& device, const GeometryBufferDesc& desc);
+
+    // Allocates room for a mesh and uploads it through context. indices are in the
+    // buffer's index format and relative to the first of vertices. Returns false, with
+    // nothing allocated, when either buffer has no room or the mesh has more vertices
+    // than the index format can address.
+    bool Add(RenderContext& context, const void* vertices, uint32_t vertexCount, const void* indices,
+        uint32_t indexCount, GeometryRange* range);
+    // Releases the ranges of a mesh; its draws must have been submitted already
+    void Remove(GeometryRange* range);
+
+    // Binds the shared buffers to slot 0 and the index buffer slot, once for all meshes
+    void Bind(RenderContext& context) const;
+    static void Draw(RenderContext& context, const GeometryRange& range)
+    {
+        context.DrawIndexed(range.IndexCount, range.FirstIndex, range.BaseVertex);
+    }
+
+    // Sets the buffer and draw fields of a DrawQueue command for range
+    void FillDrawCommand(const GeometryRange& range, DrawCommand* command) const;
+
+    const GeometryBufferDesc& GetDesc() const { return m_Desc; }
+    BufferHandle GetVertexBuffer() const { return m_VertexBuffer; }
+    BufferHandle GetIndexBuffer() const { return m_IndexBuffer; }
+    const RangeAllocator& GetVertexAllocator() const { return m_VertexAllocator; }
+    const RangeAllocator& GetIndexAllocator() const { return m_IndexAllocator; }
+
+private:
+    GeometryBufferDesc m_Desc;
+    uint32_t m_IndexSize = 0;
+    BufferHandle m_VertexBuffer;
+    BufferHandle m_IndexBuffer;
+    RangeAllocator m_VertexAllocator;
+    RangeAllocator m_IndexAllocator;
+};
@@ -0,0 +1,89 @@
+#pragma once
+
+// 64-bit FNV-1a, plus a word-at-a-time combine for scalars, for cache keys and
+// hash tables. Not cryptographic: keys that must survive on disk also store
+// enough context to reject a stale match.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+
+constexpr uint64_t HashSeed = 14695981039346656037ull;
+
+inline uint64_t HashBytes(const void* data, size_t size, uint64_t hash = HashSeed)
+{
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// Includes the length so that ("ab", "c") and ("a", "bc") hash differently
+inline uint64_t HashString(std::string_view text, uint64_t hash = HashSeed)
+{
+    uint64_t length = text.size();
+    hash = HashBytes(&length, sizeof(length), hash);
+    return HashBytes(text.data(), text.size(), hash);
+}
+
+// Mixes one 64-bit word in at once; much cheaper than HashBytes for scalar fields
+inline uint64_t HashWord(uint64_t word, uint64_t hash = HashSeed)
+{
+    hash ^= word;
+    hash *= 0x9e3779b97f4a7c15ull;
+    return hash ^ (hash >> 32);
+}
+
+// Scalars (integers, enums, floats, pointers) go through HashWord, arrays element by
+// element, anything else byte by byte. Floats hash -0 as +0 because the two compare equal.
+template <typename T>
+inline uint64_t HashValue(const T& value, uint64_t hash = HashSeed)
+{
+    if constexpr (std::is_scalar_v<T> && sizeof(T) <= sizeof(uint64_t))
+    {
+        T key = value;
+        if constexpr (std::is_floating_point_v<T>)
+            key = key == T(0) ? T(0) : key;
+        uint64_t word = 0;
+        std::memcpy(&word, &key, sizeof(T));
+        return HashWord(word, hash);
+    }
+    else if constexpr (std::is_array_v<T>)
+    {
+        for (const auto& element : value)
+            hash = HashValue(element, hash);
+        return hash;
+    }
+    else
+    {
+        return HashBytes(&value, sizeof(T), hash);
+    }
+}
+
+// Equality for float fields of a hashed key, consistent with HashValue: -0 equals +0 and,
+// unlike ==, a NaN equals the same NaN, so looking up a key with a NaN field finds it again
+inline bool FloatKeyEqual(float a, float b)
+{
+    if (a == b)
+        return true;
+    uint32_t bitsA, bitsB;
+    std::memcpy(&bitsA, &a, sizeof(a));
+    std::memcpy(&bitsB, &b, sizeof(b));
+    return bitsA == bitsB;
+}
+
+// Final avalanche (splitmix64) for using a hash directly as a table index
+inline uint64_t HashMix(uint64_t hash)
+{
+    hash ^= hash >> 30;
+    hash *= 0xbf58476d1ce4e5b9ull;
+    hash ^= hash >> 27;
+    hash *= 0x94d049bb133111ebull;
+    hash ^= hash >> 31;
+    return hash;
+}
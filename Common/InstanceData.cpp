@@ -0,0 +1,21 @@
+#include "InstanceData.h"
+
+void BuildInstanceData(const WorldMatrixArray& worlds, const Float4* colors, size_t begin, size_t end,
+    InstanceData* output)
+{
+    const float* elements[16];
+    for (int e = 0; e < 16; ++e)
+        elements[e] = worlds.GetElements(e / 4, e % 4);
+
+    const Float4 white = { 1.0f, 1.0f, 1.0f, 1.0f };
+    for (size_t i = begin; i < end; ++i)
+    {
+        // Fill a local copy first so the destination sees whole, sequential 80-byte writes
+        InstanceData instance;
+        float* world = &instance.World.m[0][0];
+        for (int e = 0; e < 16; ++e)
+            world[e] = elements[e][i];
+        instance.Color = colors ? colors[i] : white;
+        output[i - begin] = instance;
+    }
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+// Per-instance vertex stream for DrawIndexedInstanced. Slot 0 keeps the usual
+// Vertex stream and slot 1 steps once per instance through InstanceData, read by
+// VSInstanced in Effects.fx as WORLD0..WORLD3 + COLOR1. View * Projection comes
+// from a per-frame constant buffer, so static instances never need re-uploading.
+
+#include <cstddef>
+
+#include "TransformBatch.h"
+#include "Vertex.h"
+
+struct InstanceData
+{
+    Float4x4 World;     // Row-major, mul(pos, World) in HLSL like the CPU side
+    Float4 Color;       // Multiplied with the vertex color
+};
+
+static_assert(sizeof(InstanceData) == 80, "InstanceData must match InstancedVertexInputLayout");
+
+// Vertex stream in slot 0, instance stream in slot 1
+inline const InputElementDesc InstancedVertexInputLayout[] =
+{
+    { "POSITION", 0, Format::R32G32B32Float, 0, 0, false, 0 },
+    { "COLOR", 0, Format::R32G32B32A32Float, 0, 12, false, 0 },
+    { "WORLD", 0, Format::R32G32B32A32Float, 1, 0, true, 1 },
+    { "WORLD", 1, Format::R32G32B32A32Float, 1, 16, true, 1 },
+    { "WORLD", 2, Format::R32G32B32A32Float, 1, 32, true, 1 },
+    { "WORLD", 3, Format::R32G32B32A32Float, 1, 48, true, 1 },
+    { "COLOR", 1, Format::R32G32B32A32Float, 1, 64, true, 1 },
+};
+
+// Interleaves worlds[i] and colors[i] (white when colors is null) for i in
+// [begin, end) into output[i - begin]. output may be mapped upload memory; it
+// is only written, in order. Independent ranges can run on different threads.
+void BuildInstanceData(const WorldMatrixArray& worlds, const Float4* colors, size_t begin, size_t end,
+    InstanceData* output);
@@ -0,0 +1,182 @@
+#include "InstancedCubesScene.h"
+
+#include <cmath>
+#include <iterator>
+
+#include "CubeMesh.h"
+
+namespace
+{
+    constexpr float CubeSpacing = 3.0f;
+}
+
+InstancedCubesScene::InstancedCubesScene(uint32_t cubeCount, bool instanced)
+    : m_CubeCount(cubeCount)
+    , m_Instanced(instanced)
+{
+}
+
+bool InstancedCubesScene::Initialize(RenderDevice& device)
+{
+    m_Device = &device;
+    if (m_CubeCount == 0)
+        return false;
+
+    // Create the shaders and input layout
+    ShaderDesc vsDesc;
+    if (m_Instanced)
+        vsDesc = { "Effects.fx", "VSInstanced", "vs_5_0", { std::begin(InstancedVertexInputLayout), std::end(InstancedVertexInputLayout) } };
+    else
+        vsDesc = { "Effects.fx", "VS", "vs_5_0", { std::begin(VertexInputLayout), std::end(VertexInputLayout) } };
+    if (!device.CreateVertexShader(vsDesc, &m_VertexShader))
+        return false;
+
+    ShaderDesc psDesc = { "Effects.fx", "PS", "ps_5_0", {} };
+    if (!device.CreatePixelShader(psDesc, &m_PixelShader))
+        return false;
+
+    // Create vertex and index buffers
+    BufferDesc bd;
+    bd.ByteWidth = sizeof(CubeVertices);
+    bd.Bind = BufferBind::VertexBuffer;
+    if (!device.CreateBuffer(bd, CubeVertices, &m_VertexBuffer))
+        return false;
+
+    bd.ByteWidth = sizeof(CubeIndices);
+    bd.Bind = BufferBind::IndexBuffer;
+    if (!device.CreateBuffer(bd, CubeIndices, &m_IndexBuffer))
+        return false;
+
+    // The instance stream is rewritten every frame, so let the driver rename it
+    if (m_Instanced)
+    {
+        bd.ByteWidth = m_CubeCount * static_cast<uint32_t>(sizeof(InstanceData));
+        bd.Bind = BufferBind::VertexBuffer;
+        bd.Usage = BufferUsage::Dynamic;
+        if (!device.CreateBuffer(bd, nullptr, &m_InstanceBuffer))
+            return false;
+        m_InstanceData.resize(m_CubeCount);
+    }
+    else
+    {
+        m_ObjectConstants.resize(m_CubeCount);
+    }
+
+    // Lay the cubes out on a square grid centered on the origin; only the
+    // rotation part of each world matrix changes per frame
+    m_GridSize = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(m_CubeCount))));
+    float origin = -0.5f * CubeSpacing * (m_GridSize - 1);
+    m_Worlds.Resize(m_CubeCount);
+    m_Colors.resize(m_CubeCount);
+    for (uint32_t i = 0; i < m_CubeCount; ++i)
+    {
+        uint32_t column = i % m_GridSize;
+        uint32_t row = i / m_GridSize;
+        m_Worlds.Set(i, MatrixTranslation(origin + column * CubeSpacing, 0.0f, origin + row * CubeSpacing));
+        m_Colors[i] = { 0.5f + 0.5f * column / m_GridSize, 0.5f + 0.5f * row / m_GridSize, 1.0f, 1.0f };
+    }
+
+    // Look at the grid from above so every cube is in view
+    float extent = CubeSpacing * m_GridSize;
+    m_View = MatrixLookAtLH({ 0.0f, 3.0f + 0.6f * extent, -8.0f - 0.6f * extent }, { 0.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f });
+
+    Resize(device.GetWidth(), device.GetHeight());
+    return true;
+}
+
+void InstancedCubesScene::Resize(uint32_t width, uint32_t height)
+{
+    if (width == 0 || height == 0)
+        return;
+
+    float farZ = 100.0f + 2.0f * CubeSpacing * m_GridSize;
+    m_Viewport = m_Device->GetDefaultViewport();
+    m_Projection = MatrixPerspectiveFovLH(MathPiDiv2, width / static_cast<float>(height), 0.01f, farZ);
+}
+
+void InstancedCubesScene::Update(float t)
+{
+    // World = RotationY(angle) * Translation(position); write just the rotation elements
+    float* m00 = m_Worlds.GetElements(0, 0);
+    float* m02 = m_Worlds.GetElements(0, 2);
+    float* m20 = m_Worlds.GetElements(2, 0);
+    float* m22 = m_Worlds.GetElements(2, 2);
+    for (uint32_t i = 0; i < m_CubeCount; ++i)
+    {
+        float angle = t + 0.1f * i;
+        float s = std::sin(angle);
+        float c = std::cos(angle);
+        m00[i] = c;
+        m02[i] = -s;
+        m20[i] = s;
+        m22[i] = c;
+    }
+}
+
+void InstancedCubesScene::Draw(RenderContext& context)
+{
+    float clearColor[4] = { 0.0f, 0.125f, 0.3f, 1.0f }; // RGBA
+    context.ClearRenderTarget(clearColor);
+    context.ClearDepthStencil(1.0f, 0);
+
+    Float4x4 viewProjection = m_View * m_Projection;
+    if (!m_Instanced)
+    {
+        if (!m_Recorder)
+        {
+            DrawObjects(context, viewProjection, 0, m_CubeCount);
+            return;
+        }
+
+        // Chunks are recorded in any order but executed in cube order
+        m_Recorder->Record(m_CubeCount, [&](RenderContext& deferred, uint32_t begin, uint32_t end)
+        {
+            DrawObjects(deferred, viewProjection, begin, end);
+        });
+        m_Recorder->Execute(context);
+        return;
+    }
+
+    context.SetViewport(m_Viewport);
+
+    context.SetVertexBuffer(0, m_VertexBuffer, sizeof(Vertex), 0);
+    context.SetIndexBuffer(m_IndexBuffer, CubeIndexFormat, 0);
+
+    // Set shaders
+    context.SetVertexShader(m_VertexShader);
+    context.SetPixelShader(m_PixelShader);
+
+    // One upload for all instances, one draw for the whole grid
+    BuildInstanceData(m_Worlds, m_Colors.data(), 0, m_CubeCount, m_InstanceData.data());
+    context.UpdateBuffer(m_InstanceBuffer, m_InstanceData.data(), m_CubeCount * static_cast<uint32_t>(sizeof(InstanceData)));
+
+    FrameConstants cb;
+    cb.mViewProjection = MatrixTranspose(viewProjection);
+    context.SetVSConstantBufferRange(1, context.AllocateConstants(&cb, sizeof(cb)));
+
+    context.SetVertexBuffer(1, m_InstanceBuffer, sizeof(InstanceData), 0);
+    context.DrawIndexedInstanced(CubeIndexCount, m_CubeCount, 0, 0, 0);
+}
+
+void InstancedCubesScene::DrawObjects(RenderContext& context, const Float4x4& viewProjection, uint32_t begin,
+    uint32_t end)
+{
+    context.SetViewport(m_Viewport);
+
+    context.SetVertexBuffer(0, m_VertexBuffer, sizeof(Vertex), 0);
+    context.SetIndexBuffer(m_IndexBuffer, CubeIndexFormat, 0);
+
+    // Set shaders
+    context.SetVertexShader(m_VertexShader);
+    context.SetPixelShader(m_PixelShader);
+
+    TransformWorldViewProjection(m_Worlds, viewProjection, begin, end, m_ObjectConstants.data() + begin,
+        sizeof(ObjectConstants));
+
+    for (uint32_t i = begin; i < end; ++i)
+    {
+        ConstantBufferRange constants = context.AllocateConstants(&m_ObjectConstants[i], sizeof(ObjectConstants));
+        context.SetVSConstantBufferRange(0, constants);
+        context.DrawIndexed(CubeIndexCount, 0, 0);
+    }
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+// Many "10. Render States" cubes spinning on a square grid. In instanced mode the
+// world matrices go to a per-instance vertex stream and the whole grid is one
+// DrawIndexedInstanced; otherwise every cube costs a constant upload +
+// SetVSConstantBufferRange + DrawIndexed like DrawScene() does, for comparison.
+// With a ParallelRecorder the per-object draws are recorded on worker threads.
+
+#include <vector>
+
+#include "InstanceData.h"
+#include "ParallelRecorder.h"
+#include "Scene.h"
+
+class InstancedCubesScene final : public Scene
+{
+public:
+    explicit InstancedCubesScene(uint32_t cubeCount, bool instanced = true);
+
+    const char* GetName() const override { return m_Instanced ? "InstancedCubes" : "PerObjectCubes"; }
+
+    bool Initialize(RenderDevice& device) override;
+    void Resize(uint32_t width, uint32_t height) override;
+    void Update(float t) override;
+    void Draw(RenderContext& context) override;
+
+    uint32_t GetCubeCount() const { return m_CubeCount; }
+
+    // Per-object mode only: each chunk of cubes is transformed and recorded on its own
+    // deferred context, then the lists run on the context passed to Draw. nullptr records inline.
+    void SetParallelRecorder(ParallelRecorder* recorder) { m_Recorder = recorder; }
+
+private:
+    // b0 of VS
+    struct ObjectConstants
+    {
+        Float4x4 mWVP;
+    };
+
+    // b1 of VSInstanced
+    struct FrameConstants
+    {
+        Float4x4 mViewProjection;
+    };
+
+    uint32_t m_CubeCount;
+    bool m_Instanced;
+    uint32_t m_GridSize = 1;
+
+    RenderDevice* m_Device = nullptr;
+    ParallelRecorder* m_Recorder = nullptr;
+    VertexShaderHandle m_VertexShader;
+    PixelShaderHandle m_PixelShader;
+    BufferHandle m_VertexBuffer;
+    BufferHandle m_IndexBuffer;
+    BufferHandle m_InstanceBuffer;
+
+    WorldMatrixArray m_Worlds;
+    std::vector<Float4> m_Colors;
+    std::vector<InstanceData> m_InstanceData;
+    std::vector<ObjectConstants> m_ObjectConstants;
+
+    Float4x4 m_View = MatrixIdentity();
+    Float4x4 m_Projection = MatrixIdentity();
+    Viewport m_Viewport;
+
+    // The per-object draws of cubes [begin, end), with every binding they need
+    void DrawObjects(RenderContext& context, const Float4x4& viewProjection, uint32_t begin, uint32_t end);
+};
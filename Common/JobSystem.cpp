@@ -0,0 +1,96 @@
+#include "JobSystem.h"
+
+#include <algorithm>
+
+JobSystem::JobSystem(unsigned int workerCount)
+{
+    if (workerCount == 0)
+        workerCount = std::max(1u, std::thread::hardware_concurrency());
+    m_WorkerCount = workerCount;
+
+    // Worker 0 is the thread that calls ParallelFor
+    for (unsigned int i = 1; i < m_WorkerCount; ++i)
+        m_Threads.emplace_back(&JobSystem::WorkerLoop, this, i);
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Quit = true;
+    }
+    m_WakeCondition.notify_all();
+
+    for (std::thread& thread : m_Threads)
+        thread.join();
+}
+
+void JobSystem::ParallelFor(size_t count, size_t grainSize, const RangeFunction& function)
+{
+    if (count == 0)
+        return;
+
+    grainSize = std::max<size_t>(1, grainSize);
+
+    // Not worth waking anybody up
+    if (m_WorkerCount == 1 || count <= grainSize)
+    {
+        function(0, count, 0);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Function = &function;
+        m_Count = count;
+        m_GrainSize = grainSize;
+        m_NextIndex.store(0, std::memory_order_relaxed);
+        m_ActiveWorkers = m_WorkerCount - 1;
+        ++m_Generation;
+    }
+    m_WakeCondition.notify_all();
+
+    RunChunks(0);
+
+    // Wait for the other workers to drain their last chunk
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_DoneCondition.wait(lock, [this] { return m_ActiveWorkers == 0; });
+    m_Function = nullptr;
+}
+
+void JobSystem::WorkerLoop(unsigned int workerIndex)
+{
+    unsigned long long seenGeneration = 0;
+
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_WakeCondition.wait(lock, [&] { return m_Quit || m_Generation != seenGeneration; });
+            if (m_Quit)
+                return;
+            seenGeneration = m_Generation;
+        }
+
+        RunChunks(workerIndex);
+
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            --m_ActiveWorkers;
+        }
+        m_DoneCondition.notify_one();
+    }
+}
+
+void JobSystem::RunChunks(unsigned int workerIndex)
+{
+    for (;;)
+    {
+        size_t begin = m_NextIndex.fetch_add(m_GrainSize, std::memory_order_relaxed);
+        if (begin >= m_Count)
+            break;
+
+        size_t end = std::min(begin + m_GrainSize, m_Count);
+        (*m_Function)(begin, end, workerIndex);
+    }
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed pool of worker threads that splits index ranges across all cores.
+// The calling thread takes part in every ParallelFor, so a pool created with
+// one worker runs everything inline.
+class JobSystem
+{
+public:
+    // Range callback: [begin, end) of the index space and the executing worker (0..GetWorkerCount()-1)
+    using RangeFunction = std::function<void(size_t begin, size_t end, unsigned int workerIndex)>;
+
+    // workerCount == 0 uses every hardware thread
+    explicit JobSystem(unsigned int workerCount = 0);
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    unsigned int GetWorkerCount() const { return m_WorkerCount; }
+
+    // Runs function over [0, count) in chunks of grainSize and returns when all chunks are done
+    void ParallelFor(size_t count, size_t grainSize, const RangeFunction& function);
+
+private:
+    void WorkerLoop(unsigned int workerIndex);
+    void RunChunks(unsigned int workerIndex);
+
+    unsigned int m_WorkerCount = 1;
+    std::vector<std::thread> m_Threads;
+
+    std::mutex m_Mutex;
+    std::condition_variable m_WakeCondition;
+    std::condition_variable m_DoneCondition;
+    unsigned long long m_Generation = 0;
+    unsigned int m_ActiveWorkers = 0;
+    bool m_Quit = false;
+
+    const RangeFunction* m_Function = nullptr;
+    size_t m_Count = 0;
+    size_t m_GrainSize = 1;
+    std::atomic<size_t> m_NextIndex{ 0 };
+};
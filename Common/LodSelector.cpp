@@ -0,0 +1,85 @@
+#include "LodSelector.h"
+
+#include <algorithm>
+#include <cmath>
+
+LodSelector::LodSelector(const LodSelectorOptions& options)
+    : m_Options(options)
+{
+}
+
+void LodSelector::SetView(const Float4x4& view, const Float4x4& projection, float viewportHeight)
+{
+    m_View = view;
+    m_PixelsPerUnitAtOne = projection.m[1][1] * viewportHeight * 0.5f;
+}
+
+uint32_t LodSelector::Select(const MeshLodChain& chain, const Float4x4& world, uint32_t previous) const
+{
+    Float4 center = Vector3Transform(chain.Center, world);
+    float rowScale = 0.0f;
+    for (int row = 0; row < 3; ++row)
+    {
+        const float* m = world.m[row];
+        rowScale = std::max(rowScale, m[0] * m[0] + m[1] * m[1] + m[2] * m[2]);
+    }
+    return SelectLevel(chain, { center.x, center.y, center.z }, std::sqrt(rowScale), previous);
+}
+
+void LodSelector::Select(const MeshLodChain& chain, const WorldMatrixArray& worlds, size_t begin, size_t end,
+    uint8_t* lods) const
+{
+    const float* m[4][3];
+    for (int row = 0; row < 4; ++row)
+    {
+        for (int col = 0; col < 3; ++col)
+            m[row][col] = worlds.GetElements(row, col);
+    }
+    const Float3& c = chain.Center;
+    for (size_t i = begin; i < end; ++i)
+    {
+        Float3 center = {
+            c.x * m[0][0][i] + c.y * m[1][0][i] + c.z * m[2][0][i] + m[3][0][i],
+            c.x * m[0][1][i] + c.y * m[1][1][i] + c.z * m[2][1][i] + m[3][1][i],
+            c.x * m[0][2][i] + c.y * m[1][2][i] + c.z * m[2][2][i] + m[3][2][i],
+        };
+        float rowScale = 0.0f;
+        for (int row = 0; row < 3; ++row)
+        {
+            rowScale = std::max(rowScale, m[row][0][i] * m[row][0][i] + m[row][1][i] * m[row][1][i] +
+                m[row][2][i] * m[row][2][i]);
+        }
+        lods[i] = static_cast<uint8_t>(SelectLevel(chain, center, std::sqrt(rowScale), lods[i]));
+    }
+}
+
+uint32_t LodSelector::SelectLevel(const MeshLodChain& chain, const Float3& center, float rowScale,
+    uint32_t previous) const
+{
+    uint32_t levelCount = static_cast<uint32_t>(chain.Lods.size());
+    if (levelCount <= 1)
+        return 0;
+
+    // Inside the bounding sphere every level is too coarse
+    Float4 view = Vector3Transform(center, m_View);
+    float distance = std::sqrt(view.x * view.x + view.y * view.y + view.z * view.z) - chain.Radius * rowScale;
+    if (distance <= 0.0f)
+        return 0;
+    float pixelsPerUnit = rowScale * GetPixelsPerUnit(distance);
+
+    // The coarsest level whose error is at most limit pixels; errors grow with the level
+    auto coarsest = [&](float limit)
+    {
+        uint32_t level = levelCount - 1;
+        while (level > 0 && chain.Lods[level].Error * pixelsPerUnit > limit)
+            --level;
+        return level;
+    };
+    previous = std::min(previous, levelCount - 1);
+    uint32_t coarser = coarsest(m_Options.PixelError * (1.0f - m_Options.Hysteresis));
+    if (coarser > previous)
+        return coarser;
+    if (chain.Lods[previous].Error * pixelsPerUnit <= m_Options.PixelError * (1.0f + m_Options.Hysteresis))
+        return previous;
+    return coarsest(m_Options.PixelError);
+}
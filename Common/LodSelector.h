@@ -0,0 +1,55 @@
+#pragma once
+
+// Per-frame choice of the level of a MeshLodChain to draw. A level's object-space
+// error, scaled by the world matrix, is projected to pixels at the distance of
+// the object's bounding sphere from the eye with the vertical FOV of the
+// projection (MatrixPerspectiveFovLH's m[1][1] is 1 / tan(fovY / 2)) and the
+// viewport height. The coarsest level whose error stays under PixelError wins.
+//
+// Hysteresis keeps an object that sits near a switching distance from popping
+// back and forth: it only moves to a coarser level once that level's error is
+// below (1 - Hysteresis) * PixelError, and only back to a finer one once the
+// current level's error exceeds (1 + Hysteresis) * PixelError. The previous
+// level of every object is the state; the caller keeps it.
+
+#include <cstddef>
+#include <cstdint>
+
+#include "MathUtil.h"
+#include "MeshSimplifier.h"
+#include "TransformBatch.h"
+
+struct LodSelectorOptions
+{
+    float PixelError = 1.0f;
+    float Hysteresis = 0.25f;           // Fraction of PixelError, in [0, 1)
+};
+
+class LodSelector
+{
+public:
+    explicit LodSelector(const LodSelectorOptions& options = {});
+
+    // Once per frame: g_View, g_Projection and the viewport height in pixels
+    void SetView(const Float4x4& view, const Float4x4& projection, float viewportHeight);
+
+    // Pixels covered by one world-space unit at the given distance from the eye
+    float GetPixelsPerUnit(float distance) const { return m_PixelsPerUnitAtOne / distance; }
+
+    // Level of chain for an object with the given world matrix, drawn at level previous
+    // last frame (0 for a new object)
+    uint32_t Select(const MeshLodChain& chain, const Float4x4& world, uint32_t previous) const;
+
+    // Select for objects [begin, end) of worlds that share chain; lods[i] holds the level
+    // object i was drawn at and receives the new one
+    void Select(const MeshLodChain& chain, const WorldMatrixArray& worlds, size_t begin, size_t end,
+        uint8_t* lods) const;
+
+private:
+    // rowScale: the largest length of the world matrix's first three rows
+    uint32_t SelectLevel(const MeshLodChain& chain, const Float3& center, float rowScale, uint32_t previous) const;
+
+    LodSelectorOptions m_Options;
+    Float4x4 m_View = MatrixIdentity();
+    float m_PixelsPerUnitAtOne = 1.0f;
+};
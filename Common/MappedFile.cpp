@@ -0,0 +1,139 @@
+#include "MappedFile.h"
+
+#include <utility>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+{
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if (this != &other)
+    {
+        Close();
+        m_Data = std::exchange(other.m_Data, nullptr);
+        m_Size = std::exchange(other.m_Size, 0);
+        m_Open = std::exchange(other.m_Open, false);
+#ifdef _WIN32
+        m_File = std::exchange(other.m_File, nullptr);
+        m_Mapping = std::exchange(other.m_Mapping, nullptr);
+#endif
+    }
+    return *this;
+}
+
+#ifdef _WIN32
+
+bool MappedFile::Open(const std::string& path)
+{
+    Close();
+
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size))
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    m_File = file;
+    m_Size = static_cast<size_t>(size.QuadPart);
+    m_Open = true;
+
+    // CreateFileMapping refuses empty files
+    if (m_Size == 0)
+        return true;
+
+    m_Mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (m_Mapping)
+        m_Data = static_cast<const uint8_t*>(MapViewOfFile(m_Mapping, FILE_MAP_READ, 0, 0, 0));
+    if (!m_Data)
+    {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void MappedFile::Close()
+{
+    if (m_Data)
+        UnmapViewOfFile(m_Data);
+    if (m_Mapping)
+        CloseHandle(m_Mapping);
+    if (m_File)
+        CloseHandle(m_File);
+
+    m_Data = nullptr;
+    m_Mapping = nullptr;
+    m_File = nullptr;
+    m_Size = 0;
+    m_Open = false;
+}
+
+#else
+
+bool MappedFile::Open(const std::string& path)
+{
+    Close();
+
+    int descriptor = open(path.c_str(), O_RDONLY);
+    if (descriptor < 0)
+        return false;
+
+    struct stat info;
+    if (fstat(descriptor, &info) != 0)
+    {
+        close(descriptor);
+        return false;
+    }
+
+    m_Size = static_cast<size_t>(info.st_size);
+    if (m_Size != 0)
+    {
+        void* data = mmap(nullptr, m_Size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+        if (data == MAP_FAILED)
+        {
+            close(descriptor);
+            m_Size = 0;
+            return false;
+        }
+        m_Data = static_cast<const uint8_t*>(data);
+    }
+
+    // The mapping keeps the file alive on its own
+    close(descriptor);
+    m_Open = true;
+    return true;
+}
+
+void MappedFile::Close()
+{
+    if (m_Data)
+        munmap(const_cast<uint8_t*>(m_Data), m_Size);
+
+    m_Data = nullptr;
+    m_Size = 0;
+    m_Open = false;
+}
+
+#endif
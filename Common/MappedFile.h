@@ -0,0 +1,38 @@
+#pragma once
+
+// Read-only memory mapping of a whole file (CreateFileMapping on Windows, mmap
+// elsewhere). The pages are loaded on first touch, so opening is cheap even for
+// large files.
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    // Maps path; an existing empty file opens with GetSize() == 0
+    bool Open(const std::string& path);
+    void Close();
+
+    bool IsOpen() const { return m_Open; }
+    const uint8_t* GetData() const { return m_Data; }
+    size_t GetSize() const { return m_Size; }
+
+private:
+    const uint8_t* m_Data = nullptr;
+    size_t m_Size = 0;
+    bool m_Open = false;
+#ifdef _WIN32
+    void* m_File = nullptr;
+    void* m_Mapping = nullptr;
+#endif
+};
@@ -0,0 +1,277 @@
+#pragma once
+
+// Portable subset of the DirectXMath functionality used by the tutorials.
+// Matrices are row-major and use the row-vector convention (v * M), so
+// World * View * Projection composes exactly like the XMMATRIX code.
+
+#include <cmath>
+
+constexpr float MathPi = 3.141592654f;
+constexpr float MathTwoPi = 6.283185307f;
+constexpr float MathPiDiv2 = 1.570796327f;
+
+struct Float2
+{
+    float x;
+    float y;
+};
+
+struct Float3
+{
+    float x;
+    float y;
+    float z;
+};
+
+struct Float4
+{
+    float x;
+    float y;
+    float z;
+    float w;
+};
+
+struct Float4x4
+{
+    float m[4][4];
+};
+
+inline Float3 Vector3Subtract(const Float3& a, const Float3& b)
+{
+    return { a.x - b.x, a.y - b.y, a.z - b.z };
+}
+
+inline float Vector3Dot(const Float3& a, const Float3& b)
+{
+    return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+inline Float3 Vector3Cross(const Float3& a, const Float3& b)
+{
+    return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x };
+}
+
+inline Float3 Vector3Normalize(const Float3& v)
+{
+    float length = std::sqrt(Vector3Dot(v, v));
+    if (length <= 0.0f)
+        return v;
+    float invLength = 1.0f / length;
+    return { v.x * invLength, v.y * invLength, v.z * invLength };
+}
+
+inline Float4x4 MatrixIdentity()
+{
+    return { { { 1.0f, 0.0f, 0.0f, 0.0f },
+               { 0.0f, 1.0f, 0.0f, 0.0f },
+               { 0.0f, 0.0f, 1.0f, 0.0f },
+               { 0.0f, 0.0f, 0.0f, 1.0f } } };
+}
+
+inline Float4x4 MatrixMultiply(const Float4x4& a, const Float4x4& b)
+{
+    Float4x4 result;
+    for (int row = 0; row < 4; ++row)
+    {
+        for (int col = 0; col < 4; ++col)
+        {
+            result.m[row][col] = a.m[row][0] * b.m[0][col] + a.m[row][1] * b.m[1][col] +
+                a.m[row][2] * b.m[2][col] + a.m[row][3] * b.m[3][col];
+        }
+    }
+    return result;
+}
+
+inline Float4x4 operator*(const Float4x4& a, const Float4x4& b)
+{
+    return MatrixMultiply(a, b);
+}
+
+inline Float4x4 MatrixTranspose(const Float4x4& a)
+{
+    Float4x4 result;
+    for (int row = 0; row < 4; ++row)
+    {
+        for (int col = 0; col < 4; ++col)
+            result.m[row][col] = a.m[col][row];
+    }
+    return result;
+}
+
+inline Float4x4 MatrixTranslation(float x, float y, float z)
+{
+    Float4x4 result = MatrixIdentity();
+    result.m[3][0] = x;
+    result.m[3][1] = y;
+    result.m[3][2] = z;
+    return result;
+}
+
+inline Float4x4 MatrixScaling(float x, float y, float z)
+{
+    Float4x4 result = MatrixIdentity();
+    result.m[0][0] = x;
+    result.m[1][1] = y;
+    result.m[2][2] = z;
+    return result;
+}
+
+inline Float4x4 MatrixRotationX(float angle)
+{
+    float s = std::sin(angle);
+    float c = std::cos(angle);
+    Float4x4 result = MatrixIdentity();
+    result.m[1][1] = c;
+    result.m[1][2] = s;
+    result.m[2][1] = -s;
+    result.m[2][2] = c;
+    return result;
+}
+
+inline Float4x4 MatrixRotationY(float angle)
+{
+    float s = std::sin(angle);
+    float c = std::cos(angle);
+    Float4x4 result = MatrixIdentity();
+    result.m[0][0] = c;
+    result.m[0][2] = -s;
+    result.m[2][0] = s;
+    result.m[2][2] = c;
+    return result;
+}
+
+inline Float4x4 MatrixRotationZ(float angle)
+{
+    float s = std::sin(angle);
+    float c = std::cos(angle);
+    Float4x4 result = MatrixIdentity();
+    result.m[0][0] = c;
+    result.m[0][1] = s;
+    result.m[1][0] = -s;
+    result.m[1][1] = c;
+    return result;
+}
+
+// Same as XMMatrixRotationNormal: the axis must already be normalized
+inline Float4x4 MatrixRotationAxis(const Float3& axis, float angle)
+{
+    float s = std::sin(angle);
+    float c = std::cos(angle);
+    float t = 1.0f - c;
+    float x = axis.x;
+    float y = axis.y;
+    float z = axis.z;
+
+    Float4x4 result = MatrixIdentity();
+    result.m[0][0] = t * x * x + c;
+    result.m[0][1] = t * x * y + s * z;
+    result.m[0][2] = t * x * z - s * y;
+    result.m[1][0] = t * x * y - s * z;
+    result.m[1][1] = t * y * y + c;
+    result.m[1][2] = t * y * z + s * x;
+    result.m[2][0] = t * x * z + s * y;
+    result.m[2][1] = t * y * z - s * x;
+    result.m[2][2] = t * z * z + c;
+    return result;
+}
+
+// Unit quaternion (x, y, z, w), like XMMatrixRotationQuaternion
+inline Float4x4 MatrixRotationQuaternion(const Float4& q)
+{
+    float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+    float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+    float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+
+    Float4x4 result = MatrixIdentity();
+    result.m[0][0] = 1.0f - 2.0f * (yy + zz);
+    result.m[0][1] = 2.0f * (xy + wz);
+    result.m[0][2] = 2.0f * (xz - wy);
+    result.m[1][0] = 2.0f * (xy - wz);
+    result.m[1][1] = 1.0f - 2.0f * (xx + zz);
+    result.m[1][2] = 2.0f * (yz + wx);
+    result.m[2][0] = 2.0f * (xz + wy);
+    result.m[2][1] = 2.0f * (yz - wx);
+    result.m[2][2] = 1.0f - 2.0f * (xx + yy);
+    return result;
+}
+
+// MatrixScaling * MatrixRotationQuaternion * MatrixTranslation without the multiplications:
+// the rotation rows scaled, then the translation as the last row
+inline Float4x4 MatrixScaleRotationTranslation(const Float3& scale, const Float4& rotation, const Float3& translation)
+{
+    Float4x4 result = MatrixRotationQuaternion(rotation);
+    const float scales[3] = { scale.x, scale.y, scale.z };
+    for (int row = 0; row < 3; ++row)
+    {
+        for (int col = 0; col < 3; ++col)
+            result.m[row][col] *= scales[row];
+    }
+    result.m[3][0] = translation.x;
+    result.m[3][1] = translation.y;
+    result.m[3][2] = translation.z;
+    return result;
+}
+
+// Same as XMQuaternionRotationNormal: the axis must already be normalized
+inline Float4 QuaternionRotationAxis(const Float3& axis, float angle)
+{
+    float s = std::sin(angle * 0.5f);
+    return { axis.x * s, axis.y * s, axis.z * s, std::cos(angle * 0.5f) };
+}
+
+inline Float4x4 MatrixLookAtLH(const Float3& eye, const Float3& at, const Float3& up)
+{
+    Float3 zAxis = Vector3Normalize(Vector3Subtract(at, eye));
+    Float3 xAxis = Vector3Normalize(Vector3Cross(up, zAxis));
+    Float3 yAxis = Vector3Cross(zAxis, xAxis);
+
+    return { { { xAxis.x, yAxis.x, zAxis.x, 0.0f },
+               { xAxis.y, yAxis.y, zAxis.y, 0.0f },
+               { xAxis.z, yAxis.z, zAxis.z, 0.0f },
+               { -Vector3Dot(xAxis, eye), -Vector3Dot(yAxis, eye), -Vector3Dot(zAxis, eye), 1.0f } } };
+}
+
+inline Float4x4 MatrixPerspectiveFovLH(float fovAngleY, float aspectRatio, float nearZ, float farZ)
+{
+    float height = 1.0f / std::tan(fovAngleY * 0.5f);
+    float width = height / aspectRatio;
+    float range = farZ / (farZ - nearZ);
+
+    return { { { width, 0.0f, 0.0f, 0.0f },
+               { 0.0f, height, 0.0f, 0.0f },
+               { 0.0f, 0.0f, range, 1.0f },
+               { 0.0f, 0.0f, -range * nearZ, 0.0f } } };
+}
+
+// Transforms (x, y, z, 1) by the matrix and returns the homogeneous result
+inline Float4 Vector3Transform(const Float3& v, const Float4x4& m)
+{
+    return {
+        v.x * m.m[0][0] + v.y * m.m[1][0] + v.z * m.m[2][0] + m.m[3][0],
+        v.x * m.m[0][1] + v.y * m.m[1][1] + v.z * m.m[2][1] + m.m[3][1],
+        v.x * m.m[0][2] + v.y * m.m[1][2] + v.z * m.m[2][2] + m.m[3][2],
+        v.x * m.m[0][3] + v.y * m.m[1][3] + v.z * m.m[2][3] + m.m[3][3],
+    };
+}
+
+// Box (center, half extents) around the box transformed by an affine matrix: each world
+// axis picks up the extents along the rows of the 3x3 part, whatever their sign
+inline void BoxTransform(const Float3& center, const Float3& extents, const Float4x4& m, Float3* worldCenter,
+    Float3* worldExtents)
+{
+    const float c[3] = { center.x, center.y, center.z };
+    const float e[3] = { extents.x, extents.y, extents.z };
+    float outCenter[3], outExtents[3];
+    for (int j = 0; j < 3; ++j)
+    {
+        outCenter[j] = m.m[3][j];
+        outExtents[j] = 0.0f;
+        for (int i = 0; i < 3; ++i)
+        {
+            outCenter[j] += c[i] * m.m[i][j];
+            outExtents[j] += e[i] * std::fabs(m.m[i][j]);
+        }
+    }
+    *worldCenter = { outCenter[0], outCenter[1], outCenter[2] };
+    *worldExtents = { outExtents[0], outExtents[1], outExtents[2] };
+}
@@ -0,0 +1,675 @@
+#include "MeshFile.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+
+#include "Hash.h"
+
+namespace
+{
+    constexpr char FileMagic[8] = { 'M', 'E', 'S', 'H', 'F', 'I', 'L', 'E' };
+
+    // ContentHash covers the whole file with the field itself read as 0. IndexCount is the
+    // sum over the submeshes, IndexBytes the size of the index stream they share.
+    struct FileHeader
+    {
+        char Magic[8];
+        uint32_t Version;
+        uint32_t Flags;
+        uint64_t FileSize;
+        uint64_t ContentHash;
+        uint32_t VertexCount;
+        uint32_t StreamCount;
+        uint32_t IndexCount;
+        uint32_t IndexBytes;
+        uint64_t IndexOffset;
+        uint64_t StreamTableOffset;
+        uint64_t SubmeshTableOffset;
+        uint32_t SubmeshCount;
+        uint32_t Reserved;
+        float BoundsMin[3];
+        float BoundsMax[3];
+        float QuantizationCenter[3];
+        float QuantizationExtent[3];
+    };
+
+    struct FileElement
+    {
+        char SemanticName[MeshFile::MaxSemanticLength + 1];
+        uint32_t SemanticIndex;
+        uint32_t Format;
+        uint32_t AlignedByteOffset;
+        uint32_t Reserved;
+    };
+
+    struct FileStream
+    {
+        uint64_t DataOffset;
+        uint64_t DataSize;
+        uint32_t Stride;
+        uint32_t ElementCount;
+        uint32_t Reserved[2];
+        FileElement Elements[MeshFile::MaxStreamElements];
+    };
+
+    // FirstIndex counts indices of the submesh's format from the start of the index stream
+    struct FileSubmesh
+    {
+        uint32_t FirstIndex;
+        uint32_t IndexCount;
+        int32_t BaseVertex;
+        uint32_t FirstVertex;
+        uint32_t VertexCount;
+        uint32_t IndexFormat;
+        float BoundsMin[3];
+        float BoundsMax[3];
+    };
+
+    static_assert(sizeof(FileHeader) == 128 && sizeof(FileElement) == 32 && sizeof(FileStream) == 288 &&
+        sizeof(FileSubmesh) == 48, "The mesh file layout must not depend on the compiler's padding");
+    static_assert(sizeof(FileHeader) % MeshFile::TableAlignment == 0 &&
+        sizeof(FileStream) % MeshFile::TableAlignment == 0, "Tables must stay 16-byte aligned");
+
+    uint32_t ToFileFormat(Format format)
+    {
+        switch (format)
+        {
+        case Format::R32G32B32A32Float: return 2;
+        case Format::R32G32B32Float: return 6;
+        case Format::R16G16B16A16Float: return 10;
+        case Format::R16G16B16A16SNorm: return 13;
+        case Format::R8G8B8A8UNorm: return 28;
+        case Format::R16G16SNorm: return 37;
+        case Format::R32UInt: return 42;
+        case Format::R16UInt: return 57;
+        default: return 0;
+        }
+    }
+
+    Format FromFileFormat(uint32_t format)
+    {
+        switch (format)
+        {
+        case 2: return Format::R32G32B32A32Float;
+        case 6: return Format::R32G32B32Float;
+        case 10: return Format::R16G16B16A16Float;
+        case 13: return Format::R16G16B16A16SNorm;
+        case 28: return Format::R8G8B8A8UNorm;
+        case 37: return Format::R16G16SNorm;
+        case 42: return Format::R32UInt;
+        case 57: return Format::R16UInt;
+        default: return Format::Unknown;
+        }
+    }
+
+    bool IsIndexFormat(Format format)
+    {
+        return format == Format::R16UInt || format == Format::R32UInt;
+    }
+
+    uint64_t AlignOffset(uint64_t offset, uint64_t alignment)
+    {
+        return (offset + alignment - 1) / alignment * alignment;
+    }
+
+    bool Fail(std::string* error, const std::string& message)
+    {
+        if (error)
+            *error = message;
+        return false;
+    }
+
+    // Bytes [offset, offset + size) lie inside a file of fileSize bytes
+    bool InFile(uint64_t offset, uint64_t size, uint64_t fileSize)
+    {
+        return offset <= fileSize && size <= fileSize - offset;
+    }
+
+    uint32_t GetIndex(const uint8_t* indices, Format format, size_t i)
+    {
+        if (format == Format::R16UInt)
+        {
+            uint16_t index;
+            std::memcpy(&index, indices + i * 2, sizeof(index));
+            return index;
+        }
+        uint32_t index;
+        std::memcpy(&index, indices + i * 4, sizeof(index));
+        return index;
+    }
+
+    // The header and tables of a file that passed the structural checks
+    struct ParsedFile
+    {
+        FileHeader Header;
+        std::vector<FileStream> Streams;
+        std::vector<FileSubmesh> Submeshes;
+    };
+
+    bool ParseFile(const uint8_t* data, size_t size, ParsedFile* parsed, std::string* error)
+    {
+        FileHeader& header = parsed->Header;
+        if (size < sizeof(header))
+            return Fail(error, "file is smaller than the header");
+        std::memcpy(&header, data, sizeof(header));
+
+        if (std::memcmp(header.Magic, FileMagic, sizeof(FileMagic)) != 0)
+            return Fail(error, "not a mesh file");
+        if (header.Version != MeshFile::FileVersion)
+            return Fail(error, "unsupported version " + std::to_string(header.Version));
+        if (header.FileSize != size)
+            return Fail(error, "file size does not match the header (truncated?)");
+        if (header.VertexCount == 0 || header.IndexCount == 0)
+            return Fail(error, "mesh has no vertices or no indices");
+        if (header.StreamCount == 0 || header.StreamCount > MeshFile::MaxStreams)
+            return Fail(error, "invalid stream count");
+        if (header.SubmeshCount == 0)
+            return Fail(error, "mesh has no submeshes");
+
+        if (header.IndexOffset % MeshFile::DataAlignment != 0 || header.IndexOffset < sizeof(header) ||
+            !InFile(header.IndexOffset, header.IndexBytes, size))
+            return Fail(error, "index stream out of range");
+
+        uint64_t streamTableBytes = uint64_t(header.StreamCount) * sizeof(FileStream);
+        uint64_t submeshTableBytes = uint64_t(header.SubmeshCount) * sizeof(FileSubmesh);
+        if (header.StreamTableOffset % MeshFile::TableAlignment != 0 || header.StreamTableOffset < sizeof(header) ||
+            !InFile(header.StreamTableOffset, streamTableBytes, size) ||
+            header.SubmeshTableOffset % MeshFile::TableAlignment != 0 ||
+            header.SubmeshTableOffset < sizeof(header) || !InFile(header.SubmeshTableOffset, submeshTableBytes, size))
+            return Fail(error, "tables out of range");
+
+        parsed->Streams.resize(header.StreamCount);
+        std::memcpy(parsed->Streams.data(), data + header.StreamTableOffset, streamTableBytes);
+        for (uint32_t s = 0; s < header.StreamCount; ++s)
+        {
+            const FileStream& stream = parsed->Streams[s];
+            std::string where = "stream " + std::to_string(s) + ": ";
+            if (stream.Stride == 0 || stream.DataSize != uint64_t(stream.Stride) * header.VertexCount)
+                return Fail(error, where + "size does not match stride * vertex count");
+            if (stream.DataOffset % MeshFile::DataAlignment != 0 || stream.DataOffset < sizeof(header) ||
+                !InFile(stream.DataOffset, stream.DataSize, size) ||
+                stream.DataSize > std::numeric_limits<uint32_t>::max())
+                return Fail(error, where + "data out of range");
+            if (stream.ElementCount == 0 || stream.ElementCount > MeshFile::MaxStreamElements)
+                return Fail(error, where + "invalid element count");
+            for (uint32_t e = 0; e < stream.ElementCount; ++e)
+            {
+                const FileElement& element = stream.Elements[e];
+                // The layout hands these names out as C strings
+                if (std::memchr(element.SemanticName, '\0', sizeof(element.SemanticName)) == nullptr ||
+                    element.SemanticName[0] == '\0')
+                    return Fail(error, where + "semantic name is not terminated");
+                Format format = FromFileFormat(element.Format);
+                if (format == Format::Unknown || IsIndexFormat(format))
+                    return Fail(error, where + "invalid element format");
+                if (uint64_t(element.AlignedByteOffset) + GetFormatSize(format) > stream.Stride)
+                    return Fail(error, where + "element does not fit the stride");
+            }
+        }
+
+        parsed->Submeshes.resize(header.SubmeshCount);
+        std::memcpy(parsed->Submeshes.data(), data + header.SubmeshTableOffset, submeshTableBytes);
+        uint64_t indexCount = 0;
+        for (uint32_t s = 0; s < header.SubmeshCount; ++s)
+        {
+            const FileSubmesh& submesh = parsed->Submeshes[s];
+            std::string where = "submesh " + std::to_string(s) + ": ";
+            Format indexFormat = FromFileFormat(submesh.IndexFormat);
+            if (!IsIndexFormat(indexFormat))
+                return Fail(error, where + "invalid index format");
+            if ((uint64_t(submesh.FirstIndex) + submesh.IndexCount) * GetFormatSize(indexFormat) > header.IndexBytes)
+                return Fail(error, where + "index range out of range");
+            indexCount += submesh.IndexCount;
+            if (uint64_t(submesh.FirstVertex) + submesh.VertexCount > header.VertexCount)
+                return Fail(error, where + "vertex range out of range");
+            // Written this way round so that NaN bounds fail as well
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                if (!(submesh.BoundsMin[axis] <= submesh.BoundsMax[axis]))
+                    return Fail(error, where + "invalid bounds");
+            }
+        }
+        if (indexCount != header.IndexCount)
+            return Fail(error, "index count does not match the submeshes");
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            if (!(header.BoundsMin[axis] <= header.BoundsMax[axis]) || !(header.QuantizationExtent[axis] > 0.0f))
+                return Fail(error, "invalid bounds or quantization");
+        }
+        return true;
+    }
+
+    uint64_t HashHeader(FileHeader header)
+    {
+        header.ContentHash = 0;
+        return HashBytes(&header, sizeof(header));
+    }
+
+    // Finds POSITION in any stream
+    bool FindPosition(const MeshFileDesc& desc, const uint8_t** data, uint32_t* stride, Format* format)
+    {
+        for (const MeshStream& stream : desc.Streams)
+        {
+            for (const InputElementDesc& element : stream.Layout)
+            {
+                if (std::strcmp(element.SemanticName, "POSITION") == 0 && element.SemanticIndex == 0)
+                {
+                    *data = static_cast<const uint8_t*>(stream.Data) + element.AlignedByteOffset;
+                    *stride = stream.Stride;
+                    *format = element.ElementFormat;
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    class HashingWriter
+    {
+    public:
+        explicit HashingWriter(std::ofstream& out) : m_Out(out) {}
+
+        void Write(const void* data, size_t size)
+        {
+            m_Hash = HashBytes(data, size, m_Hash);
+            m_Out.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+            m_Offset += size;
+        }
+
+        void PadTo(uint64_t offset)
+        {
+            static const uint8_t zeros[MeshFile::DataAlignment] = {};
+            while (m_Offset < offset)
+                Write(zeros, static_cast<size_t>(std::min<uint64_t>(offset - m_Offset, sizeof(zeros))));
+        }
+
+        uint64_t GetHash() const { return m_Hash; }
+        uint64_t GetOffset() const { return m_Offset; }
+
+    private:
+        std::ofstream& m_Out;
+        uint64_t m_Hash = HashSeed;
+        uint64_t m_Offset = 0;
+    };
+
+    // Writes indices[i] - rebase as T, in blocks to keep the temporary small
+    template <typename T>
+    void WriteIndices(HashingWriter& writer, const uint32_t* indices, uint32_t count, uint32_t rebase)
+    {
+        if (sizeof(T) == sizeof(uint32_t) && rebase == 0)
+        {
+            writer.Write(indices, count * sizeof(uint32_t));
+            return;
+        }
+
+        T block[8192];
+        for (uint32_t first = 0; first < count; first += 8192)
+        {
+            uint32_t blockCount = std::min<uint32_t>(8192, count - first);
+            for (uint32_t i = 0; i < blockCount; ++i)
+                block[i] = static_cast<T>(indices[first + i] - rebase);
+            writer.Write(block, blockCount * sizeof(T));
+        }
+    }
+}
+
+MeshFileDesc MakeMeshFileDesc(const MeshData& mesh, VertexFormat format, std::vector<uint8_t>* vertexStorage)
+{
+    MeshFileDesc desc;
+    desc.VertexCount = static_cast<uint32_t>(mesh.Vertices.size());
+    if (format != VertexFormat::Float32)
+        desc.Quantization = ComputePositionQuantization(mesh.Vertices.data(), mesh.Vertices.size());
+
+    MeshStream stream;
+    stream.Stride = GetVertexStride(format);
+    uint32_t elementCount = 0;
+    const InputElementDesc* layout = GetVertexInputLayout(format, &elementCount);
+    stream.Layout.assign(layout, layout + elementCount);
+    vertexStorage->resize(size_t(desc.VertexCount) * stream.Stride);
+    EncodeVertices(format, mesh.Vertices.data(), mesh.Vertices.size(), desc.Quantization, vertexStorage->data());
+    stream.Data = vertexStorage->data();
+    desc.Streams.push_back(std::move(stream));
+
+    desc.Indices = mesh.Indices.data();
+    desc.IndexCount = static_cast<uint32_t>(mesh.Indices.size());
+    return desc;
+}
+
+bool WriteMeshFile(const std::string& path, const MeshFileDesc& desc, std::string* error)
+{
+    if (desc.VertexCount == 0 || desc.IndexCount == 0 || !desc.Indices)
+        return Fail(error, "mesh has no vertices or no indices");
+    if (desc.Streams.empty() || desc.Streams.size() > MeshFile::MaxStreams)
+        return Fail(error, "invalid stream count");
+    if (desc.IndexFormat != Format::Unknown && !IsIndexFormat(desc.IndexFormat))
+        return Fail(error, "index format must be Unknown, R16UInt or R32UInt");
+
+    FileHeader header = {};
+    std::memcpy(header.Magic, FileMagic, sizeof(FileMagic));
+    header.Version = MeshFile::FileVersion;
+    header.VertexCount = desc.VertexCount;
+    header.StreamCount = static_cast<uint32_t>(desc.Streams.size());
+
+    std::vector<FileStream> streams(desc.Streams.size());
+    for (size_t s = 0; s < desc.Streams.size(); ++s)
+    {
+        const MeshStream& stream = desc.Streams[s];
+        FileStream& fileStream = streams[s];
+        std::string where = "stream " + std::to_string(s) + ": ";
+        if (!stream.Data || stream.Stride == 0 || stream.Layout.empty() ||
+            stream.Layout.size() > MeshFile::MaxStreamElements)
+            return Fail(error, where + "needs data, a stride and 1 to 8 elements");
+        fileStream.DataSize = uint64_t(stream.Stride) * desc.VertexCount;
+        if (fileStream.DataSize > std::numeric_limits<uint32_t>::max())
+            return Fail(error, where + "larger than a buffer can be");
+        fileStream.Stride = stream.Stride;
+        fileStream.ElementCount = static_cast<uint32_t>(stream.Layout.size());
+        for (size_t e = 0; e < stream.Layout.size(); ++e)
+        {
+            const InputElementDesc& element = stream.Layout[e];
+            FileElement& fileElement = fileStream.Elements[e];
+            size_t nameLength = std::strlen(element.SemanticName);
+            if (nameLength == 0 || nameLength > MeshFile::MaxSemanticLength)
+                return Fail(error, where + "semantic name must have 1 to 15 characters");
+            std::memcpy(fileElement.SemanticName, element.SemanticName, nameLength);
+            fileElement.SemanticIndex = element.SemanticIndex;
+            fileElement.Format = ToFileFormat(element.ElementFormat);
+            fileElement.AlignedByteOffset = element.AlignedByteOffset;
+            if (fileElement.Format == 0 || IsIndexFormat(element.ElementFormat) ||
+                uint64_t(element.AlignedByteOffset) + GetFormatSize(element.ElementFormat) > stream.Stride)
+                return Fail(error, where + "element has an invalid format or does not fit the stride");
+        }
+    }
+
+    std::vector<MeshSubmesh> submeshes = desc.Submeshes;
+    if (submeshes.empty())
+        submeshes.push_back({ 0, desc.IndexCount, 0 });
+
+    // Vertex ranges, bounds and index formats, checking every index on the way
+    const uint8_t* positions = nullptr;
+    uint32_t positionStride = 0;
+    Format positionFormat = Format::Unknown;
+    bool hasPosition = FindPosition(desc, &positions, &positionStride, &positionFormat);
+    const Float3& center = desc.Quantization.Center;
+    const Float3& extent = desc.Quantization.Extent;
+    std::vector<FileSubmesh> fileSubmeshes(submeshes.size());
+    std::vector<uint32_t> rebases(submeshes.size());
+    uint64_t indexBytes = 0;
+    for (size_t s = 0; s < submeshes.size(); ++s)
+    {
+        const MeshSubmesh& submesh = submeshes[s];
+        std::string where = "submesh " + std::to_string(s) + ": ";
+        if (uint64_t(submesh.FirstIndex) + submesh.IndexCount > desc.IndexCount)
+            return Fail(error, where + "index range out of range");
+
+        int64_t firstVertex = std::numeric_limits<int64_t>::max();
+        int64_t lastVertex = -1;
+        uint32_t maxIndex = 0;
+        Float3 boundsMin = { 0.0f, 0.0f, 0.0f };
+        Float3 boundsMax = { 0.0f, 0.0f, 0.0f };
+        for (uint32_t i = 0; i < submesh.IndexCount; ++i)
+        {
+            uint32_t index = desc.Indices[submesh.FirstIndex + i];
+            int64_t vertex = int64_t(index) + submesh.BaseVertex;
+            if (vertex < 0 || vertex >= desc.VertexCount)
+                return Fail(error, where + "index " + std::to_string(index) + " is out of range");
+            firstVertex = std::min(firstVertex, vertex);
+            lastVertex = std::max(lastVertex, vertex);
+            maxIndex = std::max(maxIndex, index);
+
+            float position[4] = {};
+            if (hasPosition)
+                ReadVertexElement(positionFormat, positions + size_t(vertex) * positionStride, position);
+            Float3 p = { position[0] * extent.x + center.x, position[1] * extent.y + center.y,
+                position[2] * extent.z + center.z };
+            if (i == 0)
+                boundsMin = boundsMax = p;
+            boundsMin = { std::min(boundsMin.x, p.x), std::min(boundsMin.y, p.y), std::min(boundsMin.z, p.z) };
+            boundsMax = { std::max(boundsMax.x, p.x), std::max(boundsMax.y, p.y), std::max(boundsMax.z, p.z) };
+        }
+
+        FileSubmesh& fileSubmesh = fileSubmeshes[s];
+        fileSubmesh.IndexCount = submesh.IndexCount;
+        fileSubmesh.BaseVertex = submesh.BaseVertex;
+        fileSubmesh.FirstVertex = lastVertex < 0 ? 0 : static_cast<uint32_t>(firstVertex);
+        fileSubmesh.VertexCount = static_cast<uint32_t>(lastVertex + 1 - fileSubmesh.FirstVertex);
+
+        // 16-bit indices keep the submesh's own when they fit, otherwise count from its first vertex
+        Format indexFormat = desc.IndexFormat;
+        bool fitsRebased = fileSubmesh.VertexCount <= 0x10000;
+        if (indexFormat == Format::Unknown)
+            indexFormat = maxIndex <= 0xFFFF || fitsRebased ? Format::R16UInt : Format::R32UInt;
+        if (indexFormat == Format::R16UInt && maxIndex > 0xFFFF)
+        {
+            if (!fitsRebased)
+            {
+                return Fail(error, where + "range of " + std::to_string(fileSubmesh.VertexCount) +
+                    " vertices does not fit 16 bits");
+            }
+            fileSubmesh.BaseVertex = static_cast<int32_t>(fileSubmesh.FirstVertex);
+            rebases[s] = static_cast<uint32_t>(fileSubmesh.BaseVertex - submesh.BaseVertex);
+        }
+        fileSubmesh.IndexFormat = ToFileFormat(indexFormat);
+
+        // Each range starts on a multiple of its index size, so FirstIndex is a whole number
+        uint32_t indexSize = GetFormatSize(indexFormat);
+        indexBytes = AlignOffset(indexBytes, indexSize);
+        fileSubmesh.FirstIndex = static_cast<uint32_t>(indexBytes / indexSize);
+        indexBytes += uint64_t(submesh.IndexCount) * indexSize;
+        header.IndexCount += submesh.IndexCount;
+        std::memcpy(fileSubmesh.BoundsMin, &boundsMin, sizeof(fileSubmesh.BoundsMin));
+        std::memcpy(fileSubmesh.BoundsMax, &boundsMax, sizeof(fileSubmesh.BoundsMax));
+
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            bool first = s == 0;
+            header.BoundsMin[axis] = first ? fileSubmesh.BoundsMin[axis] :
+                std::min(header.BoundsMin[axis], fileSubmesh.BoundsMin[axis]);
+            header.BoundsMax[axis] = first ? fileSubmesh.BoundsMax[axis] :
+                std::max(header.BoundsMax[axis], fileSubmesh.BoundsMax[axis]);
+        }
+    }
+    if (header.IndexCount == 0)
+        return Fail(error, "mesh has no vertices or no indices");
+    if (indexBytes > std::numeric_limits<uint32_t>::max())
+        return Fail(error, "index stream is larger than a buffer can be");
+    header.IndexBytes = static_cast<uint32_t>(indexBytes);
+    std::memcpy(header.QuantizationCenter, &center, sizeof(header.QuantizationCenter));
+    std::memcpy(header.QuantizationExtent, &extent, sizeof(header.QuantizationExtent));
+
+    // Lay out the tables after the header, then the streams on 64-byte boundaries
+    header.StreamTableOffset = sizeof(FileHeader);
+    header.SubmeshTableOffset = header.StreamTableOffset + streams.size() * sizeof(FileStream);
+    header.SubmeshCount = static_cast<uint32_t>(fileSubmeshes.size());
+    uint64_t offset = header.SubmeshTableOffset + fileSubmeshes.size() * sizeof(FileSubmesh);
+    for (FileStream& stream : streams)
+    {
+        stream.DataOffset = AlignOffset(offset, MeshFile::DataAlignment);
+        offset = stream.DataOffset + stream.DataSize;
+    }
+    header.IndexOffset = AlignOffset(offset, MeshFile::DataAlignment);
+    header.FileSize = header.IndexOffset + header.IndexBytes;
+
+    // Write beside the file and rename over it, so a crash never leaves half a file behind.
+    // The header goes in with ContentHash = 0 and is written again once the hash is known.
+    std::string tempPath = path + ".tmp";
+    {
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        if (!out)
+            return Fail(error, "cannot create " + tempPath);
+
+        HashingWriter writer(out);
+        writer.Write(&header, sizeof(header));
+        writer.Write(streams.data(), streams.size() * sizeof(FileStream));
+        writer.Write(fileSubmeshes.data(), fileSubmeshes.size() * sizeof(FileSubmesh));
+        for (size_t s = 0; s < streams.size(); ++s)
+        {
+            writer.PadTo(streams[s].DataOffset);
+            writer.Write(desc.Streams[s].Data, static_cast<size_t>(streams[s].DataSize));
+        }
+        for (size_t s = 0; s < submeshes.size(); ++s)
+        {
+            const FileSubmesh& fileSubmesh = fileSubmeshes[s];
+            const uint32_t* indices = desc.Indices + submeshes[s].FirstIndex;
+            Format indexFormat = FromFileFormat(fileSubmesh.IndexFormat);
+            writer.PadTo(header.IndexOffset + uint64_t(fileSubmesh.FirstIndex) * GetFormatSize(indexFormat));
+            if (indexFormat == Format::R16UInt)
+                WriteIndices<uint16_t>(writer, indices, fileSubmesh.IndexCount, rebases[s]);
+            else
+                WriteIndices<uint32_t>(writer, indices, fileSubmesh.IndexCount, rebases[s]);
+        }
+        writer.PadTo(header.FileSize);
+
+        header.ContentHash = writer.GetHash();
+        out.seekp(0);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        if (!out.flush())
+        {
+            out.close();
+            std::error_code ignored;
+            std::filesystem::remove(tempPath, ignored);
+            return Fail(error, "cannot write " + tempPath);
+        }
+    }
+
+    std::error_code renameError;
+    std::filesystem::rename(tempPath, path, renameError);
+    if (renameError)
+    {
+        std::error_code ignored;
+        std::filesystem::remove(tempPath, ignored);
+        return Fail(error, "cannot replace " + path + ": " + renameError.message());
+    }
+    return true;
+}
+
+bool ValidateMeshFile(const uint8_t* data, size_t size, MeshFileValidation validation, std::string* error)
+{
+    ParsedFile parsed;
+    if (!ParseFile(data, size, &parsed, error))
+        return false;
+    if (validation == MeshFileValidation::Structure)
+        return true;
+
+    const FileHeader& header = parsed.Header;
+    const uint8_t* indices = data + header.IndexOffset;
+    for (size_t s = 0; s < parsed.Submeshes.size(); ++s)
+    {
+        const FileSubmesh& submesh = parsed.Submeshes[s];
+        Format indexFormat = FromFileFormat(submesh.IndexFormat);
+        int64_t firstVertex = submesh.FirstVertex;
+        int64_t endVertex = firstVertex + submesh.VertexCount;
+        for (uint32_t i = 0; i < submesh.IndexCount; ++i)
+        {
+            int64_t vertex = int64_t(GetIndex(indices, indexFormat, submesh.FirstIndex + i)) + submesh.BaseVertex;
+            if (vertex < firstVertex || vertex >= endVertex)
+            {
+                return Fail(error, "submesh " + std::to_string(s) + ": index " +
+                    std::to_string(submesh.FirstIndex + i) + " is outside the submesh's vertices");
+            }
+        }
+    }
+
+    uint64_t hash = HashBytes(data + sizeof(FileHeader), size - sizeof(FileHeader), HashHeader(header));
+    if (hash != header.ContentHash)
+        return Fail(error, "content hash mismatch");
+    return true;
+}
+
+void MeshFile::Close()
+{
+    m_File.Close();
+    m_VertexCount = 0;
+    m_Streams.clear();
+    m_IndexCount = 0;
+    m_IndexBytes = 0;
+    m_IndexData = nullptr;
+    m_Submeshes.clear();
+    m_BoundsMin = m_BoundsMax = { 0.0f, 0.0f, 0.0f };
+    m_Quantization = {};
+}
+
+bool MeshFile::Open(const std::string& path, std::string* error)
+{
+    Close();
+    if (!m_File.Open(path))
+        return Fail(error, "cannot open " + path);
+
+    const uint8_t* data = m_File.GetData();
+    ParsedFile parsed;
+    if (!ParseFile(data, m_File.GetSize(), &parsed, error))
+    {
+        Close();
+        return false;
+    }
+
+    const FileHeader& header = parsed.Header;
+    m_VertexCount = header.VertexCount;
+    m_Streams.resize(parsed.Streams.size());
+    for (size_t s = 0; s < parsed.Streams.size(); ++s)
+    {
+        const FileStream& fileStream = parsed.Streams[s];
+        // Names point at the mapped table; the local copy only served the checks
+        const uint8_t* table = data + header.StreamTableOffset + s * sizeof(FileStream);
+        MeshStream& stream = m_Streams[s];
+        stream.Stride = fileStream.Stride;
+        stream.Data = data + fileStream.DataOffset;
+        for (uint32_t e = 0; e < fileStream.ElementCount; ++e)
+        {
+            const FileElement& element = fileStream.Elements[e];
+            const char* name = reinterpret_cast<const char*>(
+                table + offsetof(FileStream, Elements) + e * sizeof(FileElement) + offsetof(FileElement, SemanticName));
+            stream.Layout.push_back({ name, element.SemanticIndex, FromFileFormat(element.Format),
+                static_cast<uint32_t>(s), element.AlignedByteOffset, false, 0 });
+        }
+    }
+
+    m_IndexCount = header.IndexCount;
+    m_IndexBytes = header.IndexBytes;
+    m_IndexData = data + header.IndexOffset;
+
+    m_Submeshes.resize(parsed.Submeshes.size());
+    for (size_t s = 0; s < parsed.Submeshes.size(); ++s)
+    {
+        const FileSubmesh& fileSubmesh = parsed.Submeshes[s];
+        MeshSubmesh& submesh = m_Submeshes[s];
+        submesh.FirstIndex = fileSubmesh.FirstIndex;
+        submesh.IndexCount = fileSubmesh.IndexCount;
+        submesh.BaseVertex = fileSubmesh.BaseVertex;
+        submesh.IndexFormat = FromFileFormat(fileSubmesh.IndexFormat);
+        submesh.FirstVertex = fileSubmesh.FirstVertex;
+        submesh.VertexCount = fileSubmesh.VertexCount;
+        std::memcpy(&submesh.BoundsMin, fileSubmesh.BoundsMin, sizeof(submesh.BoundsMin));
+        std::memcpy(&submesh.BoundsMax, fileSubmesh.BoundsMax, sizeof(submesh.BoundsMax));
+    }
+    std::memcpy(&m_BoundsMin, header.BoundsMin, sizeof(m_BoundsMin));
+    std::memcpy(&m_BoundsMax, header.BoundsMax, sizeof(m_BoundsMax));
+    std::memcpy(&m_Quantization.Center, header.QuantizationCenter, sizeof(m_Quantization.Center));
+    std::memcpy(&m_Quantization.Extent, header.QuantizationExtent, sizeof(m_Quantization.Extent));
+    return true;
+}
+
+bool MeshFile::CreateBuffers(RenderDevice& device, BufferHandle* vertexBuffers, BufferHandle* indexBuffer) const
+{
+    if (!IsOpen() || !vertexBuffers || !indexBuffer)
+        return false;
+
+    for (size_t s = 0; s < m_Streams.size(); ++s)
+    {
+        BufferDesc desc;
+        desc.ByteWidth = m_Streams[s].Stride * m_VertexCount;
+        desc.Bind = BufferBind::VertexBuffer;
+        desc.Usage = BufferUsage::Immutable;
+        if (!device.CreateBufferNoCopy(desc, m_Streams[s].Data, &vertexBuffers[s]))
+            return false;
+    }
+
+    BufferDesc desc;
+    desc.ByteWidth = m_IndexBytes;
+    desc.Bind = BufferBind::IndexBuffer;
+    desc.Usage = BufferUsage::Immutable;
+    return device.CreateBufferNoCopy(desc, m_IndexData, indexBuffer);
+}
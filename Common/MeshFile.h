@@ -0,0 +1,154 @@
+#pragma once
+
+// Versioned binary mesh container (.mesh) that loads without parsing or copying.
+// The file is memory-mapped and the vertex streams and the index stream are
+// stored exactly as the input assembler reads them, so MeshFile::CreateBuffers
+// hands pointers into the mapping straight to CreateBuffer as the initial data
+// (D3D11_SUBRESOURCE_DATA::pSysMem on D3D11). The only work at load time is
+// checking the header and tables; the pages are read by the driver's copy.
+//
+// File layout (little endian, see MeshFile.cpp):
+//   header | stream table | submesh table | vertex streams | index stream
+// The header and tables are 16-byte aligned, every stream starts on a 64-byte
+// boundary so the data is cache-line aligned in the mapping.
+//
+// Formats are stored as their DXGI_FORMAT values, which never change, rather
+// than as Format, whose numbering is free to grow.
+//
+// Every submesh has its own index format, so the index stream mixes 16-bit and
+// 32-bit ranges. WriteMeshFile picks the narrowest format per submesh: 16-bit
+// whenever the submesh's vertices span at most 65536 entries, moving BaseVertex
+// to its first vertex if that is what makes the indices fit. Meshes with more
+// vertices than that are cut into 16-bit chunks with SplitMeshForIndex16
+// (MeshSplitter.h) before writing.
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "MappedFile.h"
+#include "MathUtil.h"
+#include "MeshImporter.h"
+#include "PackedVertex.h"
+#include "RenderDevice.h"
+
+// A range of the index stream drawn with one DrawIndexed call:
+//   SetIndexBuffer(indexBuffer, IndexFormat, 0);
+//   DrawIndexed(IndexCount, FirstIndex, BaseVertex);
+// In a MeshFileDesc FirstIndex counts the 32-bit input indices; in a loaded file it counts
+// indices of the submesh's own format, so the byte offset is FirstIndex * its size.
+struct MeshSubmesh
+{
+    uint32_t FirstIndex = 0;
+    uint32_t IndexCount = 0;
+    int32_t BaseVertex = 0;
+    // Filled in by WriteMeshFile: the index format chosen for the submesh, the vertices it
+    // references (after BaseVertex) and their bounds in object space, i.e. after dequantization
+    Format IndexFormat = Format::Unknown;
+    uint32_t FirstVertex = 0;
+    uint32_t VertexCount = 0;
+    Float3 BoundsMin = { 0.0f, 0.0f, 0.0f };
+    Float3 BoundsMax = { 0.0f, 0.0f, 0.0f };
+};
+
+// One vertex buffer. InputSlot of the layout is ignored: stream i is bound to slot i.
+struct MeshStream
+{
+    uint32_t Stride = 0;
+    std::vector<InputElementDesc> Layout;
+    const void* Data = nullptr;             // VertexCount * Stride bytes
+};
+
+// Input of WriteMeshFile; nothing is copied before the file is written
+struct MeshFileDesc
+{
+    uint32_t VertexCount = 0;
+    std::vector<MeshStream> Streams;
+    // Unknown picks the narrowest format per submesh; R16UInt or R32UInt force one for all of
+    // them. Indices are always 32-bit and narrowed while writing.
+    Format IndexFormat = Format::Unknown;
+    const uint32_t* Indices = nullptr;
+    uint32_t IndexCount = 0;
+    // Only FirstIndex, IndexCount and BaseVertex are read; empty means one submesh for everything
+    std::vector<MeshSubmesh> Submeshes;
+    // Applied to POSITION for the bounds; the identity for float positions
+    PositionQuantization Quantization;
+};
+
+// Describes an imported mesh as one stream in the given vertex format. vertexStorage
+// receives the encoded vertices and has to outlive the desc. The index format is left
+// to WriteMeshFile.
+MeshFileDesc MakeMeshFileDesc(const MeshData& mesh, VertexFormat format, std::vector<uint8_t>* vertexStorage);
+
+// Writes desc to a temporary file beside path and renames it over path, so readers
+// never see half a file. Fails on indices that do not fit a forced index format or point
+// past the vertices, and on layouts that do not fit their stride. Indices outside every
+// submesh are not written.
+bool WriteMeshFile(const std::string& path, const MeshFileDesc& desc, std::string* error);
+
+enum class MeshFileValidation
+{
+    Structure,      // Header, tables and ranges; cost independent of the mesh size (what Open does)
+    Full,           // Also every index against its submesh and the content hash
+};
+
+// Checks a mapped .mesh file; on failure error receives the reason
+bool ValidateMeshFile(const uint8_t* data, size_t size, MeshFileValidation validation, std::string* error);
+
+class MeshFile
+{
+public:
+    static constexpr uint32_t FileVersion = 2;
+    static constexpr uint32_t TableAlignment = 16;
+    static constexpr uint32_t DataAlignment = 64;
+    static constexpr uint32_t MaxStreams = 8;
+    static constexpr uint32_t MaxStreamElements = 8;
+    static constexpr uint32_t MaxSemanticLength = 15;
+
+    MeshFile() = default;
+
+    MeshFile(const MeshFile&) = delete;
+    MeshFile& operator=(const MeshFile&) = delete;
+
+    // Maps path and validates its structure. The indices are not scanned; use
+    // ValidateMeshFile with MeshFileValidation::Full for files that are not trusted.
+    bool Open(const std::string& path, std::string* error);
+    void Close();
+
+    bool IsOpen() const { return m_File.IsOpen(); }
+    const MappedFile& GetMappedFile() const { return m_File; }
+
+    // Stream data and the semantic names of the layouts point into the mapping
+    uint32_t GetVertexCount() const { return m_VertexCount; }
+    uint32_t GetStreamCount() const { return static_cast<uint32_t>(m_Streams.size()); }
+    const MeshStream& GetStream(uint32_t index) const { return m_Streams[index]; }
+
+    // The index stream holds the submeshes' ranges in their own formats
+    uint32_t GetIndexCount() const { return m_IndexCount; }
+    uint32_t GetIndexBytes() const { return m_IndexBytes; }
+    const void* GetIndexData() const { return m_IndexData; }
+
+    const std::vector<MeshSubmesh>& GetSubmeshes() const { return m_Submeshes; }
+    const Float3& GetBoundsMin() const { return m_BoundsMin; }
+    const Float3& GetBoundsMax() const { return m_BoundsMax; }
+    const PositionQuantization& GetQuantization() const { return m_Quantization; }
+
+    // Creates one vertex buffer per stream (vertexBuffers holds GetStreamCount() handles)
+    // and the index buffer, all immutable and initialized straight from the mapping with
+    // CreateBufferNoCopy. Keep the file open while the buffers exist: the D3D11 backend
+    // holds no copy of the data and reads the mapping again if it recreates its device.
+    bool CreateBuffers(RenderDevice& device, BufferHandle* vertexBuffers, BufferHandle* indexBuffer) const;
+
+private:
+    MappedFile m_File;
+    uint32_t m_VertexCount = 0;
+    std::vector<MeshStream> m_Streams;
+    uint32_t m_IndexCount = 0;
+    uint32_t m_IndexBytes = 0;
+    const void* m_IndexData = nullptr;
+    std::vector<MeshSubmesh> m_Submeshes;
+    Float3 m_BoundsMin = { 0.0f, 0.0f, 0.0f };
+    Float3 m_BoundsMax = { 0.0f, 0.0f, 0.0f };
+    PositionQuantization m_Quantization;
+};
@@ -0,0 +1,989 @@
+#include "MeshImporter.h"
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cstring>
+
+#include "MappedFile.h"
+
+namespace
+{
+    // ---- OBJ ----
+
+    // One slice of the file, cut at a line start
+    struct ObjChunk
+    {
+        const char* Begin;
+        const char* End;
+        uint32_t Lines = 0;
+        uint32_t VertexCount = 0;
+        uint32_t TriangleCount = 0;
+        // Filled by the prefix sum over the chunks before this one
+        uint32_t FirstLine = 0;
+        uint32_t FirstVertex = 0;
+        uint32_t FirstTriangle = 0;
+        // First error of the chunk, as a line inside it
+        const char* Error = nullptr;
+        uint32_t ErrorLine = 0;
+    };
+
+    bool IsBlank(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\r';
+    }
+
+    const char* SkipBlanks(const char* p, const char* end)
+    {
+        while (p < end && IsBlank(*p))
+            ++p;
+        return p;
+    }
+
+    const char* FindLineEnd(const char* p, const char* end)
+    {
+        const void* newline = std::memchr(p, '\n', static_cast<size_t>(end - p));
+        return newline ? static_cast<const char*>(newline) : end;
+    }
+
+    // Keyword of the line at p, e.g. "v" or "f": true if it matches and is followed by a blank
+    bool IsKeyword(const char* p, const char* lineEnd, char keyword)
+    {
+        return p + 1 < lineEnd && p[0] == keyword && IsBlank(p[1]);
+    }
+
+    bool ParseFloat(const char*& p, const char* end, float* value)
+    {
+        p = SkipBlanks(p, end);
+        // from_chars rejects the leading '+' some exporters write
+        if (p < end && *p == '+')
+            ++p;
+        std::from_chars_result result = std::from_chars(p, end, *value);
+        if (result.ec != std::errc())
+            return false;
+        p = result.ptr;
+        return true;
+    }
+
+    bool ParseInt(const char*& p, const char* end, int64_t* value)
+    {
+        bool negative = p < end && *p == '-';
+        if (negative || (p < end && *p == '+'))
+            ++p;
+        if (p == end || *p < '0' || *p > '9')
+            return false;
+
+        int64_t result = 0;
+        while (p < end && *p >= '0' && *p <= '9' && result < (int64_t(1) << 40))
+            result = result * 10 + (*p++ - '0');
+        *value = negative ? -result : result;
+        return true;
+    }
+
+    // Cuts [data, data + size) into about size / chunkBytes chunks that start at line starts
+    std::vector<ObjChunk> SplitObj(const char* data, size_t size, size_t chunkBytes)
+    {
+        size_t count = std::max<size_t>(1, size / std::max<size_t>(1, chunkBytes));
+        std::vector<ObjChunk> chunks;
+        chunks.reserve(count);
+
+        const char* end = data + size;
+        const char* begin = data;
+        for (size_t i = 1; i <= count && begin < end; ++i)
+        {
+            const char* split = i == count ? end : data + size * i / count;
+            if (split < begin)
+                split = begin;
+            split = split < end ? FindLineEnd(split, end) : end;
+            if (split < end)
+                ++split;
+
+            ObjChunk chunk;
+            chunk.Begin = begin;
+            chunk.End = split;
+            chunks.push_back(chunk);
+            begin = split;
+        }
+        return chunks;
+    }
+
+    // First pass: lines, "v" lines and the triangles of "f" lines
+    void CountObjChunk(ObjChunk& chunk)
+    {
+        for (const char* line = chunk.Begin; line < chunk.End; ++chunk.Lines)
+        {
+            const char* lineEnd = FindLineEnd(line, chunk.End);
+            const char* p = SkipBlanks(line, lineEnd);
+            if (IsKeyword(p, lineEnd, 'v'))
+                ++chunk.VertexCount;
+            else if (IsKeyword(p, lineEnd, 'f'))
+            {
+                // Corners are blank-separated tokens; a face with n corners is n - 2 triangles
+                uint32_t corners = 0;
+                for (p += 1; ; ++corners)
+                {
+                    p = SkipBlanks(p, lineEnd);
+                    if (p == lineEnd || *p == '#')
+                        break;
+                    while (p < lineEnd && !IsBlank(*p))
+                        ++p;
+                }
+                chunk.TriangleCount += corners >= 3 ? corners - 2 : 0;
+            }
+            line = lineEnd + 1;
+        }
+    }
+
+    // Second pass: writes the chunk's vertices and triangles at its offsets in the mesh
+    void ParseObjChunk(ObjChunk& chunk, uint32_t totalVertices, const MeshImportOptions& options, MeshData& mesh)
+    {
+        Vertex* vertex = mesh.Vertices.data() + chunk.FirstVertex;
+        uint32_t* index = mesh.Indices.data() + static_cast<size_t>(chunk.FirstTriangle) * 3;
+        float zSign = options.ConvertToLeftHanded ? -1.0f : 1.0f;
+        // Mirroring Z keeps the on-screen order of the corners, so the winding is reversed too
+        int second = options.ConvertToLeftHanded ? 2 : 1;
+
+        uint32_t lineNumber = 0;
+        auto fail = [&](const char* message)
+        {
+            chunk.Error = message;
+            chunk.ErrorLine = lineNumber;
+        };
+
+        for (const char* line = chunk.Begin; line < chunk.End && !chunk.Error; ++lineNumber)
+        {
+            const char* lineEnd = FindLineEnd(line, chunk.End);
+            const char* p = SkipBlanks(line, lineEnd);
+
+            if (IsKeyword(p, lineEnd, 'v'))
+            {
+                // "v x y z [w]" or "v x y z r g b" (the common vertex color extension)
+                float values[6];
+                int count = 0;
+                for (p += 1; count < 6; ++count)
+                {
+                    p = SkipBlanks(p, lineEnd);
+                    if (p == lineEnd || *p == '#' || !ParseFloat(p, lineEnd, &values[count]))
+                        break;
+                }
+                if (count < 3)
+                {
+                    fail("vertex needs x, y and z");
+                    break;
+                }
+
+                vertex->Position = { values[0], values[1], values[2] * zSign };
+                vertex->Color = count == 6 ? Float4{ values[3], values[4], values[5], 1.0f } : options.DefaultColor;
+                ++vertex;
+            }
+            else if (IsKeyword(p, lineEnd, 'f'))
+            {
+                // "f v", "f v/vt", "f v//vn" or "f v/vt/vn"; only v matters for Vertex.
+                // Negative indices count back from the last vertex defined so far.
+                uint32_t verticesSoFar = static_cast<uint32_t>(vertex - mesh.Vertices.data());
+                uint32_t first = 0, previous = 0;
+                uint32_t corners = 0;
+                for (p += 1; ; ++corners)
+                {
+                    p = SkipBlanks(p, lineEnd);
+                    if (p == lineEnd || *p == '#')
+                        break;
+
+                    int64_t value;
+                    if (!ParseInt(p, lineEnd, &value) || value == 0)
+                    {
+                        fail("bad face index");
+                        break;
+                    }
+                    int64_t resolved = value > 0 ? value - 1 : verticesSoFar + value;
+                    if (resolved < 0 || resolved >= totalVertices)
+                    {
+                        fail("face index out of range");
+                        break;
+                    }
+                    // Skip the texture coordinate and normal references
+                    while (p < lineEnd && !IsBlank(*p))
+                        ++p;
+
+                    uint32_t current = static_cast<uint32_t>(resolved);
+                    if (corners == 0)
+                        first = current;
+                    else if (corners >= 2)
+                    {
+                        // Fan around the first corner
+                        index[0] = first;
+                        index[second] = previous;
+                        index[3 - second] = current;
+                        index += 3;
+                    }
+                    previous = current;
+                }
+                if (!chunk.Error && corners < 3)
+                    fail("face needs at least 3 vertices");
+            }
+            line = lineEnd + 1;
+        }
+    }
+
+    // ---- glTF ----
+
+    constexpr uint32_t GlbMagic = 0x46546c67;       // "glTF"
+    constexpr uint32_t GlbChunkJson = 0x4e4f534a;   // "JSON"
+    constexpr uint32_t GlbChunkBin = 0x004e4942;    // "BIN\0"
+
+    constexpr uint32_t GltfByte = 5120;
+    constexpr uint32_t GltfUnsignedByte = 5121;
+    constexpr uint32_t GltfShort = 5122;
+    constexpr uint32_t GltfUnsignedShort = 5123;
+    constexpr uint32_t GltfUnsignedInt = 5125;
+    constexpr uint32_t GltfFloat = 5126;
+
+    constexpr uint32_t GltfTriangles = 4;
+    constexpr uint32_t GltfTriangleStrip = 5;
+    constexpr uint32_t GltfTriangleFan = 6;
+
+    // Node hierarchies deeper than this are treated as cycles
+    constexpr int MaxNodeDepth = 64;
+    // Vertices or triangles per parallel copy job
+    constexpr uint32_t CopyBlockSize = 16384;
+
+    enum class JsonType : uint8_t
+    {
+        Null,
+        Bool,
+        Number,
+        String,
+        Array,
+        Object,
+    };
+
+    // A value of the document; strings point into the mapped file, escapes included
+    struct JsonToken
+    {
+        JsonType Type;
+        uint32_t Start;
+        uint32_t End;
+        uint32_t Count;     // Elements of an array, members of an object
+        uint32_t Next;      // Token after this value and everything inside it
+    };
+
+    // Flat token list of a JSON document, in document order (an object is followed by
+    // key, value, key, value, ...). Only the token array is allocated.
+    class JsonDocument
+    {
+    public:
+        static constexpr int None = -1;
+
+        bool Parse(const char* text, size_t size)
+        {
+            m_Text = text;
+            m_End = text + size;
+            m_Tokens.clear();
+            const char* p = text;
+            if (!ParseValue(p, 0))
+                return false;
+            p = SkipWhitespace(p);
+            // The GLB JSON chunk is padded with spaces, which SkipWhitespace already ate
+            return p == m_End || *p == '\0';
+        }
+
+        JsonType GetType(int token) const { return m_Tokens[token].Type; }
+        uint32_t GetCount(int token) const { return token == None ? 0 : m_Tokens[token].Count; }
+
+        // Member value of an object, or None
+        int Find(int object, const char* key) const
+        {
+            if (object == None || m_Tokens[object].Type != JsonType::Object)
+                return None;
+            size_t keyLength = std::strlen(key);
+            int member = object + 1;
+            for (uint32_t i = 0; i < m_Tokens[object].Count; ++i)
+            {
+                const JsonToken& name = m_Tokens[member];
+                if (name.End - name.Start == keyLength && std::memcmp(m_Text + name.Start, key, keyLength) == 0)
+                    return member + 1;
+                member = static_cast<int>(m_Tokens[member + 1].Next);
+            }
+            return None;
+        }
+
+        // Element of an array, or None
+        int At(int array, uint32_t index) const
+        {
+            if (array == None || m_Tokens[array].Type != JsonType::Array || index >= m_Tokens[array].Count)
+                return None;
+            int element = array + 1;
+            for (uint32_t i = 0; i < index; ++i)
+                element = static_cast<int>(m_Tokens[element].Next);
+            return element;
+        }
+
+        double GetNumber(int token, double fallback) const
+        {
+            if (token == None || m_Tokens[token].Type != JsonType::Number)
+                return fallback;
+            double value = fallback;
+            std::from_chars(m_Text + m_Tokens[token].Start, m_Text + m_Tokens[token].End, value);
+            return value;
+        }
+
+        // Counts and indices; negative, fractional or too large values give UINT32_MAX
+        uint32_t GetUInt(int token, uint32_t fallback) const
+        {
+            if (token == None)
+                return fallback;
+            double value = GetNumber(token, -1.0);
+            return value >= 0.0 && value < 4294967295.0 && value == static_cast<double>(static_cast<uint32_t>(value)) ?
+                static_cast<uint32_t>(value) : UINT32_MAX;
+        }
+
+        bool GetBool(int token, bool fallback) const
+        {
+            if (token == None || m_Tokens[token].Type != JsonType::Bool)
+                return fallback;
+            return m_Text[m_Tokens[token].Start] == 't';
+        }
+
+        bool Equals(int token, const char* text) const
+        {
+            if (token == None || m_Tokens[token].Type != JsonType::String)
+                return false;
+            size_t length = std::strlen(text);
+            return m_Tokens[token].End - m_Tokens[token].Start == length &&
+                std::memcmp(m_Text + m_Tokens[token].Start, text, length) == 0;
+        }
+
+    private:
+        static constexpr int MaxDepth = 128;
+
+        const char* SkipWhitespace(const char* p) const
+        {
+            while (p < m_End && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n'))
+                ++p;
+            return p;
+        }
+
+        uint32_t Offset(const char* p) const { return static_cast<uint32_t>(p - m_Text); }
+
+        bool ParseValue(const char*& p, int depth)
+        {
+            p = SkipWhitespace(p);
+            if (p == m_End || depth > MaxDepth)
+                return false;
+
+            size_t token = m_Tokens.size();
+            m_Tokens.push_back({ JsonType::Null, Offset(p), 0, 0, 0 });
+
+            if (*p == '{' || *p == '[')
+            {
+                bool object = *p == '{';
+                char close = object ? '}' : ']';
+                m_Tokens[token].Type = object ? JsonType::Object : JsonType::Array;
+                p = SkipWhitespace(p + 1);
+                uint32_t count = 0;
+                while (p < m_End && *p != close)
+                {
+                    if (count > 0)
+                    {
+                        if (*p != ',')
+                            return false;
+                        p = SkipWhitespace(p + 1);
+                    }
+                    if (object)
+                    {
+                        if (p == m_End || *p != '"' || !ParseValue(p, depth + 1))
+                            return false;
+                        p = SkipWhitespace(p);
+                        if (p == m_End || *p != ':')
+                            return false;
+                        ++p;
+                    }
+                    if (!ParseValue(p, depth + 1))
+                        return false;
+                    p = SkipWhitespace(p);
+                    ++count;
+                }
+                if (p == m_End)
+                    return false;
+                m_Tokens[token].Count = count;
+                ++p;
+            }
+            else if (*p == '"')
+            {
+                m_Tokens[token].Type = JsonType::String;
+                m_Tokens[token].Start = Offset(++p);
+                while (p < m_End && *p != '"')
+                    p += (*p == '\\' && p + 1 < m_End) ? 2 : 1;
+                if (p >= m_End)
+                    return false;
+                m_Tokens[token].End = Offset(p++);
+                m_Tokens[token].Next = static_cast<uint32_t>(m_Tokens.size());
+                return true;
+            }
+            else if (*p == 't' || *p == 'f' || *p == 'n')
+            {
+                const char* word = *p == 't' ? "true" : (*p == 'f' ? "false" : "null");
+                size_t length = std::strlen(word);
+                if (static_cast<size_t>(m_End - p) < length || std::memcmp(p, word, length) != 0)
+                    return false;
+                m_Tokens[token].Type = *p == 'n' ? JsonType::Null : JsonType::Bool;
+                p += length;
+            }
+            else
+            {
+                double value;
+                std::from_chars_result result = std::from_chars(p, m_End, value);
+                if (result.ec != std::errc())
+                    return false;
+                m_Tokens[token].Type = JsonType::Number;
+                p = result.ptr;
+            }
+
+            m_Tokens[token].End = Offset(p);
+            m_Tokens[token].Next = static_cast<uint32_t>(m_Tokens.size());
+            return true;
+        }
+
+        const char* m_Text = nullptr;
+        const char* m_End = nullptr;
+        std::vector<JsonToken> m_Tokens;
+    };
+
+    // Strided view of an accessor inside the BIN chunk
+    struct GltfAccessor
+    {
+        const uint8_t* Data = nullptr;
+        uint32_t Count = 0;
+        uint32_t Stride = 0;
+        uint32_t ComponentType = 0;
+        uint32_t Components = 0;
+        bool Normalized = false;
+    };
+
+    // One primitive placed in the scene, with its slice of the output
+    struct GltfInstance
+    {
+        GltfAccessor Position;
+        GltfAccessor Color;         // Count == 0 without COLOR_0
+        GltfAccessor Indices;       // Count == 0 for non-indexed primitives
+        uint32_t Mode = GltfTriangles;
+        Float4x4 World = MatrixIdentity();
+        uint32_t FirstVertex = 0;
+        uint32_t FirstTriangle = 0;
+        uint32_t TriangleCount = 0;
+    };
+
+    struct GltfCopyJob
+    {
+        uint32_t Instance;
+        bool Indices;       // Triangles instead of vertices
+        uint32_t Begin;
+        uint32_t End;
+    };
+
+    uint32_t GetComponentSize(uint32_t componentType)
+    {
+        switch (componentType)
+        {
+        case GltfByte:
+        case GltfUnsignedByte: return 1;
+        case GltfShort:
+        case GltfUnsignedShort: return 2;
+        case GltfUnsignedInt:
+        case GltfFloat: return 4;
+        default: return 0;
+        }
+    }
+
+    uint32_t GetComponentCount(const JsonDocument& json, int type)
+    {
+        if (json.Equals(type, "SCALAR")) return 1;
+        if (json.Equals(type, "VEC2")) return 2;
+        if (json.Equals(type, "VEC3")) return 3;
+        if (json.Equals(type, "VEC4")) return 4;
+        return 0;
+    }
+
+    // Component i of element as float, with the glTF normalization rules
+    float ReadComponent(const GltfAccessor& accessor, uint32_t element, uint32_t component)
+    {
+        const uint8_t* p = accessor.Data + static_cast<size_t>(element) * accessor.Stride +
+            component * GetComponentSize(accessor.ComponentType);
+        switch (accessor.ComponentType)
+        {
+        case GltfFloat: { float v; std::memcpy(&v, p, 4); return v; }
+        case GltfUnsignedByte: return accessor.Normalized ? *p / 255.0f : *p;
+        case GltfByte:
+        {
+            int8_t v = static_cast<int8_t>(*p);
+            return accessor.Normalized ? std::max(v / 127.0f, -1.0f) : v;
+        }
+        case GltfUnsignedShort: { uint16_t v; std::memcpy(&v, p, 2); return accessor.Normalized ? v / 65535.0f : v; }
+        case GltfShort:
+        {
+            int16_t v;
+            std::memcpy(&v, p, 2);
+            return accessor.Normalized ? std::max(v / 32767.0f, -1.0f) : v;
+        }
+        default: return 0.0f;
+        }
+    }
+
+    uint32_t ReadIndex(const GltfAccessor& accessor, uint32_t element)
+    {
+        const uint8_t* p = accessor.Data + static_cast<size_t>(element) * accessor.Stride;
+        switch (accessor.ComponentType)
+        {
+        case GltfUnsignedByte: return *p;
+        case GltfUnsignedShort: { uint16_t v; std::memcpy(&v, p, 2); return v; }
+        default: { uint32_t v; std::memcpy(&v, p, 4); return v; }
+        }
+    }
+
+    bool ResolveAccessor(const JsonDocument& json, int root, uint32_t index, const uint8_t* bin, size_t binSize,
+        GltfAccessor* accessor, std::string* error)
+    {
+        int node = json.At(json.Find(root, "accessors"), index);
+        if (node == JsonDocument::None)
+        {
+            *error = "accessor index out of range";
+            return false;
+        }
+        if (json.Find(node, "sparse") != JsonDocument::None)
+        {
+            *error = "sparse accessors are not supported";
+            return false;
+        }
+
+        accessor->Count = json.GetUInt(json.Find(node, "count"), 0);
+        accessor->ComponentType = json.GetUInt(json.Find(node, "componentType"), 0);
+        accessor->Components = GetComponentCount(json, json.Find(node, "type"));
+        accessor->Normalized = json.GetBool(json.Find(node, "normalized"), false);
+        uint32_t elementSize = GetComponentSize(accessor->ComponentType) * accessor->Components;
+        if (elementSize == 0)
+        {
+            *error = "unsupported accessor type";
+            return false;
+        }
+
+        // An accessor without a buffer view reads as zeros, which no mesh attribute needs
+        int view = json.At(json.Find(root, "bufferViews"),
+            json.GetUInt(json.Find(node, "bufferView"), UINT32_MAX));
+        if (view == JsonDocument::None)
+        {
+            *error = "accessor without a valid buffer view";
+            return false;
+        }
+        uint32_t bufferIndex = json.GetUInt(json.Find(view, "buffer"), 0);
+        int buffer = json.At(json.Find(root, "buffers"), bufferIndex);
+        if (bufferIndex != 0 || json.Find(buffer, "uri") != JsonDocument::None || !bin)
+        {
+            *error = "only the embedded GLB buffer is supported";
+            return false;
+        }
+
+        double viewOffset = json.GetNumber(json.Find(view, "byteOffset"), 0);
+        double viewLength = json.GetNumber(json.Find(view, "byteLength"), -1);
+        double accessorOffset = json.GetNumber(json.Find(node, "byteOffset"), 0);
+        accessor->Stride = json.GetUInt(json.Find(view, "byteStride"), elementSize);
+
+        // Every element must lie inside the view, and the view inside the BIN chunk
+        double last = accessor->Count ? accessorOffset + static_cast<double>(accessor->Stride) * (accessor->Count - 1) +
+            elementSize : 0.0;
+        if (viewOffset < 0 || accessorOffset < 0 || viewLength < 0 || viewOffset + viewLength > binSize ||
+            last > viewLength || accessor->Stride < elementSize)
+        {
+            *error = "accessor outside its buffer view";
+            return false;
+        }
+        accessor->Data = bin + static_cast<size_t>(viewOffset + accessorOffset);
+        return true;
+    }
+
+    // glTF stores column-major matrices for column vectors, which read row by row are the row-vector matrix
+    Float4x4 ReadNodeTransform(const JsonDocument& json, int node)
+    {
+        int matrix = json.Find(node, "matrix");
+        if (json.GetCount(matrix) == 16)
+        {
+            Float4x4 result;
+            for (uint32_t i = 0; i < 16; ++i)
+                result.m[i / 4][i % 4] = static_cast<float>(json.GetNumber(json.At(matrix, i), 0));
+            return result;
+        }
+
+        auto readVector = [&](const char* key, Float4 fallback)
+        {
+            int array = json.Find(node, key);
+            float values[4] = { fallback.x, fallback.y, fallback.z, fallback.w };
+            for (uint32_t i = 0; i < json.GetCount(array) && i < 4; ++i)
+                values[i] = static_cast<float>(json.GetNumber(json.At(array, i), values[i]));
+            return Float4{ values[0], values[1], values[2], values[3] };
+        };
+        Float4 t = readVector("translation", { 0.0f, 0.0f, 0.0f, 0.0f });
+        Float4 r = readVector("rotation", { 0.0f, 0.0f, 0.0f, 1.0f });
+        Float4 s = readVector("scale", { 1.0f, 1.0f, 1.0f, 0.0f });
+        return MatrixScaling(s.x, s.y, s.z) * MatrixRotationQuaternion(r) * MatrixTranslation(t.x, t.y, t.z);
+    }
+
+    bool AddMeshInstances(const JsonDocument& json, int root, int mesh, const Float4x4& world, const uint8_t* bin,
+        size_t binSize, std::vector<GltfInstance>& instances, std::string* error)
+    {
+        int primitives = json.Find(mesh, "primitives");
+        for (uint32_t i = 0; i < json.GetCount(primitives); ++i)
+        {
+            int primitive = json.At(primitives, i);
+            GltfInstance instance;
+            instance.Mode = json.GetUInt(json.Find(primitive, "mode"), GltfTriangles);
+            // Points and lines have no triangles
+            if (instance.Mode != GltfTriangles && instance.Mode != GltfTriangleStrip && instance.Mode != GltfTriangleFan)
+                continue;
+            instance.World = world;
+
+            int attributes = json.Find(primitive, "attributes");
+            int position = json.Find(attributes, "POSITION");
+            int color = json.Find(attributes, "COLOR_0");
+            int indices = json.Find(primitive, "indices");
+            if (position == JsonDocument::None)
+            {
+                *error = "primitive without POSITION";
+                return false;
+            }
+            if (!ResolveAccessor(json, root, json.GetUInt(position, UINT32_MAX), bin, binSize, &instance.Position,
+                error))
+                return false;
+            if (instance.Position.ComponentType != GltfFloat || instance.Position.Components != 3)
+            {
+                *error = "POSITION must be float VEC3";
+                return false;
+            }
+            if (color != JsonDocument::None)
+            {
+                if (!ResolveAccessor(json, root, json.GetUInt(color, UINT32_MAX), bin, binSize, &instance.Color, error))
+                    return false;
+                if (instance.Color.Components < 3 || instance.Color.Count < instance.Position.Count)
+                {
+                    *error = "COLOR_0 must be VEC3 or VEC4 for every vertex";
+                    return false;
+                }
+            }
+            if (indices != JsonDocument::None)
+            {
+                if (!ResolveAccessor(json, root, json.GetUInt(indices, UINT32_MAX), bin, binSize, &instance.Indices,
+                    error))
+                    return false;
+                uint32_t type = instance.Indices.ComponentType;
+                if (instance.Indices.Components != 1 ||
+                    (type != GltfUnsignedByte && type != GltfUnsignedShort && type != GltfUnsignedInt))
+                {
+                    *error = "indices must be unsigned SCALAR";
+                    return false;
+                }
+            }
+
+            uint32_t count = indices != JsonDocument::None ? instance.Indices.Count : instance.Position.Count;
+            instance.TriangleCount = instance.Mode == GltfTriangles ? count / 3 : (count >= 3 ? count - 2 : 0);
+            instances.push_back(instance);
+        }
+        return true;
+    }
+
+    bool AddNode(const JsonDocument& json, int root, uint32_t index, const Float4x4& parent, int depth,
+        const uint8_t* bin, size_t binSize, std::vector<GltfInstance>& instances, std::string* error)
+    {
+        int node = json.At(json.Find(root, "nodes"), index);
+        if (node == JsonDocument::None || depth > MaxNodeDepth)
+        {
+            *error = node == JsonDocument::None ? "node index out of range" : "node hierarchy too deep";
+            return false;
+        }
+
+        Float4x4 world = ReadNodeTransform(json, node) * parent;
+        int mesh = json.Find(node, "mesh");
+        if (mesh != JsonDocument::None)
+        {
+            int meshNode = json.At(json.Find(root, "meshes"), json.GetUInt(mesh, UINT32_MAX));
+            if (meshNode == JsonDocument::None)
+            {
+                *error = "mesh index out of range";
+                return false;
+            }
+            if (!AddMeshInstances(json, root, meshNode, world, bin, binSize, instances, error))
+                return false;
+        }
+
+        int children = json.Find(node, "children");
+        for (uint32_t i = 0; i < json.GetCount(children); ++i)
+        {
+            uint32_t child = json.GetUInt(json.At(children, i), UINT32_MAX);
+            if (!AddNode(json, root, child, world, depth + 1, bin, binSize, instances, error))
+                return false;
+        }
+        return true;
+    }
+
+    void CopyVertices(const GltfInstance& instance, uint32_t begin, uint32_t end, const MeshImportOptions& options,
+        Vertex* output)
+    {
+        float zSign = options.ConvertToLeftHanded ? -1.0f : 1.0f;
+        for (uint32_t i = begin; i < end; ++i)
+        {
+            Float3 position = { ReadComponent(instance.Position, i, 0), ReadComponent(instance.Position, i, 1),
+                ReadComponent(instance.Position, i, 2) };
+            Float4 world = Vector3Transform(position, instance.World);
+            Vertex& vertex = output[instance.FirstVertex + i];
+            vertex.Position = { world.x, world.y, world.z * zSign };
+
+            if (instance.Color.Count)
+            {
+                vertex.Color = { ReadComponent(instance.Color, i, 0), ReadComponent(instance.Color, i, 1),
+                    ReadComponent(instance.Color, i, 2),
+                    instance.Color.Components == 4 ? ReadComponent(instance.Color, i, 3) : 1.0f };
+            }
+            else
+                vertex.Color = options.DefaultColor;
+        }
+    }
+
+    // Writes triangles [begin, end) of the instance as a list, reversed if flip; false if an index is out of range
+    bool CopyTriangles(const GltfInstance& instance, uint32_t begin, uint32_t end, bool flip, uint32_t* output)
+    {
+        uint32_t vertexCount = instance.Position.Count;
+        auto corner = [&](uint32_t i)
+        {
+            return instance.Indices.Count ? ReadIndex(instance.Indices, i) : i;
+        };
+
+        bool valid = true;
+        uint32_t* triangle = output + static_cast<size_t>(instance.FirstTriangle + begin) * 3;
+        for (uint32_t i = begin; i < end; ++i, triangle += 3)
+        {
+            uint32_t a, b, c;
+            if (instance.Mode == GltfTriangles)
+            {
+                a = corner(3 * i);
+                b = corner(3 * i + 1);
+                c = corner(3 * i + 2);
+            }
+            else if (instance.Mode == GltfTriangleStrip)
+            {
+                // Odd strip triangles swap their last two corners to keep the strip's winding
+                a = corner(i);
+                b = corner(i + 1 + (i & 1));
+                c = corner(i + 2 - (i & 1));
+            }
+            else
+            {
+                a = corner(i + 1);
+                b = corner(i + 2);
+                c = corner(0);
+            }
+            if (flip)
+                std::swap(b, c);
+            valid = valid && a < vertexCount && b < vertexCount && c < vertexCount;
+            triangle[0] = instance.FirstVertex + a;
+            triangle[1] = instance.FirstVertex + b;
+            triangle[2] = instance.FirstVertex + c;
+        }
+        return valid;
+    }
+
+    // Runs function over [0, count) on the job system, or inline without one
+    void RunParallel(JobSystem* jobSystem, size_t count, const JobSystem::RangeFunction& function)
+    {
+        if (jobSystem)
+            jobSystem->ParallelFor(count, 1, function);
+        else if (count)
+            function(0, count, 0);
+    }
+
+    bool Fail(MeshData* mesh, std::string* error, const std::string& message)
+    {
+        mesh->Vertices.clear();
+        mesh->Indices.clear();
+        if (error)
+            *error = message;
+        return false;
+    }
+
+    uint32_t ReadUInt32(const uint8_t* p)
+    {
+        uint32_t value;
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    }
+}
+
+MeshFileFormat DetectMeshFileFormat(const std::string& path, const uint8_t* data, size_t size)
+{
+    if (size >= 4 && ReadUInt32(data) == GlbMagic)
+        return MeshFileFormat::Glb;
+
+    size_t dot = path.find_last_of('.');
+    std::string extension = dot == std::string::npos ? std::string() : path.substr(dot + 1);
+    for (char& c : extension)
+        c = static_cast<char>(c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c);
+    return extension == "obj" ? MeshFileFormat::Obj : MeshFileFormat::Unknown;
+}
+
+bool ImportObj(const uint8_t* data, size_t size, const MeshImportOptions& options, JobSystem* jobSystem,
+    MeshData* mesh, std::string* error)
+{
+    const char* text = reinterpret_cast<const char*>(data);
+    std::vector<ObjChunk> chunks = SplitObj(text, size, options.ObjChunkBytes);
+
+    RunParallel(jobSystem, chunks.size(), [&](size_t begin, size_t end, unsigned int)
+    {
+        for (size_t i = begin; i < end; ++i)
+            CountObjChunk(chunks[i]);
+    });
+
+    uint64_t vertexCount = 0, triangleCount = 0, lineCount = 0;
+    for (ObjChunk& chunk : chunks)
+    {
+        chunk.FirstLine = static_cast<uint32_t>(lineCount);
+        chunk.FirstVertex = static_cast<uint32_t>(vertexCount);
+        chunk.FirstTriangle = static_cast<uint32_t>(triangleCount);
+        lineCount += chunk.Lines;
+        vertexCount += chunk.VertexCount;
+        triangleCount += chunk.TriangleCount;
+    }
+    if (vertexCount > UINT32_MAX || triangleCount * 3 > UINT32_MAX)
+        return Fail(mesh, error, "mesh too large for 32-bit indices");
+
+    mesh->Vertices.resize(static_cast<size_t>(vertexCount));
+    mesh->Indices.resize(static_cast<size_t>(triangleCount) * 3);
+    RunParallel(jobSystem, chunks.size(), [&](size_t begin, size_t end, unsigned int)
+    {
+        for (size_t i = begin; i < end; ++i)
+            ParseObjChunk(chunks[i], static_cast<uint32_t>(vertexCount), options, *mesh);
+    });
+
+    for (const ObjChunk& chunk : chunks)
+    {
+        if (chunk.Error)
+        {
+            uint32_t line = chunk.FirstLine + chunk.ErrorLine + 1;
+            return Fail(mesh, error, "line " + std::to_string(line) + ": " + chunk.Error);
+        }
+    }
+    return true;
+}
+
+bool ImportGlb(const uint8_t* data, size_t size, const MeshImportOptions& options, JobSystem* jobSystem,
+    MeshData* mesh, std::string* error)
+{
+    // Header: magic, version, length; then chunks of length, type, data padded to 4 bytes
+    if (size < 20 || ReadUInt32(data) != GlbMagic || ReadUInt32(data + 4) != 2 || ReadUInt32(data + 8) > size)
+        return Fail(mesh, error, "not a glTF 2.0 binary file");
+
+    size_t length = ReadUInt32(data + 8);
+    const uint8_t* json = nullptr;
+    const uint8_t* bin = nullptr;
+    size_t jsonSize = 0, binSize = 0;
+    for (size_t offset = 12; offset + 8 <= length;)
+    {
+        size_t chunkSize = ReadUInt32(data + offset);
+        uint32_t chunkType = ReadUInt32(data + offset + 4);
+        if (chunkSize > length - offset - 8)
+            return Fail(mesh, error, "truncated GLB chunk");
+        if (chunkType == GlbChunkJson && !json)
+        {
+            json = data + offset + 8;
+            jsonSize = chunkSize;
+        }
+        else if (chunkType == GlbChunkBin && !bin)
+        {
+            bin = data + offset + 8;
+            binSize = chunkSize;
+        }
+        offset += 8 + ((chunkSize + 3) & ~size_t(3));
+    }
+
+    JsonDocument document;
+    if (!json || !document.Parse(reinterpret_cast<const char*>(json), jsonSize) ||
+        document.GetType(0) != JsonType::Object)
+        return Fail(mesh, error, "invalid glTF JSON chunk");
+
+    // Walk the default scene; a file without scenes has every mesh at the origin
+    std::vector<GltfInstance> instances;
+    std::string message;
+    int root = 0;
+    int scenes = document.Find(root, "scenes");
+    if (document.GetCount(scenes))
+    {
+        int scene = document.At(scenes, document.GetUInt(document.Find(root, "scene"), 0));
+        if (scene == JsonDocument::None)
+            return Fail(mesh, error, "scene index out of range");
+        int nodes = document.Find(scene, "nodes");
+        for (uint32_t i = 0; i < document.GetCount(nodes); ++i)
+        {
+            uint32_t node = document.GetUInt(document.At(nodes, i), UINT32_MAX);
+            if (!AddNode(document, root, node, MatrixIdentity(), 0, bin, binSize, instances, &message))
+                return Fail(mesh, error, message);
+        }
+    }
+    else
+    {
+        int meshes = document.Find(root, "meshes");
+        for (uint32_t i = 0; i < document.GetCount(meshes); ++i)
+        {
+            if (!AddMeshInstances(document, root, document.At(meshes, i), MatrixIdentity(), bin, binSize, instances,
+                &message))
+                return Fail(mesh, error, message);
+        }
+    }
+
+    // Slices of the output, then copy jobs of at most CopyBlockSize vertices or triangles
+    uint64_t vertexCount = 0, triangleCount = 0;
+    std::vector<GltfCopyJob> jobs;
+    for (uint32_t i = 0; i < instances.size(); ++i)
+    {
+        GltfInstance& instance = instances[i];
+        instance.FirstVertex = static_cast<uint32_t>(vertexCount);
+        instance.FirstTriangle = static_cast<uint32_t>(triangleCount);
+        vertexCount += instance.Position.Count;
+        triangleCount += instance.TriangleCount;
+        if (vertexCount > UINT32_MAX || triangleCount * 3 > UINT32_MAX)
+            return Fail(mesh, error, "mesh too large for 32-bit indices");
+
+        for (uint32_t begin = 0; begin < instance.Position.Count; begin += CopyBlockSize)
+            jobs.push_back({ i, false, begin, std::min(begin + CopyBlockSize, instance.Position.Count) });
+        for (uint32_t begin = 0; begin < instance.TriangleCount; begin += CopyBlockSize)
+            jobs.push_back({ i, true, begin, std::min(begin + CopyBlockSize, instance.TriangleCount) });
+    }
+
+    mesh->Vertices.resize(static_cast<size_t>(vertexCount));
+    mesh->Indices.resize(static_cast<size_t>(triangleCount) * 3);
+    std::atomic<bool> valid{ true };
+    RunParallel(jobSystem, jobs.size(), [&](size_t begin, size_t end, unsigned int)
+    {
+        for (size_t i = begin; i < end; ++i)
+        {
+            const GltfCopyJob& job = jobs[i];
+            const GltfInstance& instance = instances[job.Instance];
+            if (!job.Indices)
+                CopyVertices(instance, job.Begin, job.End, options, mesh->Vertices.data());
+            else if (!CopyTriangles(instance, job.Begin, job.End, options.ConvertToLeftHanded, mesh->Indices.data()))
+                valid.store(false, std::memory_order_relaxed);
+        }
+    });
+    if (!valid.load())
+        return Fail(mesh, error, "index out of range");
+    return true;
+}
+
+bool ImportMesh(const std::string& path, const MeshImportOptions& options, JobSystem* jobSystem, MeshData* mesh,
+    std::string* error)
+{
+    MappedFile file;
+    if (!file.Open(path))
+        return Fail(mesh, error, "cannot open " + path);
+
+    switch (DetectMeshFileFormat(path, file.GetData(), file.GetSize()))
+    {
+    case MeshFileFormat::Obj: return ImportObj(file.GetData(), file.GetSize(), options, jobSystem, mesh, error);
+    case MeshFileFormat::Glb: return ImportGlb(file.GetData(), file.GetSize(), options, jobSystem, mesh, error);
+    default: return Fail(mesh, error, path + ": unknown mesh format");
+    }
+}
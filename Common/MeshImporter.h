@@ -0,0 +1,66 @@
+#pragma once
+
+// Loads Wavefront OBJ and glTF 2.0 binary (.glb) files into the Vertex layout
+// of the tutorials, ready for RenderDevice::CreateBuffer with R32UInt indices.
+//
+// The file is memory-mapped and parsed in place: the OBJ tokenizer walks the
+// mapped bytes with pointers and std::from_chars, so parsing allocates nothing
+// beyond the output arrays. OBJ files are cut into chunks at line boundaries
+// and parsed on the job system in two passes: the first counts the vertices
+// and triangles of every chunk, the second writes each chunk straight into its
+// slice of the output. glTF primitives are copied out of the BIN chunk in
+// parallel blocks.
+//
+// Vertex only has a position and a color, so OBJ texture coordinates and
+// normals are skipped and every OBJ position becomes one vertex; glTF uses
+// POSITION and COLOR_0. Both formats are right-handed with counter-clockwise
+// front faces; with ConvertToLeftHanded (the default) Z is negated and every
+// triangle reversed, which gives the left-handed, clockwise-front convention
+// of the tutorials.
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "JobSystem.h"
+#include "MathUtil.h"
+#include "Vertex.h"
+
+struct MeshData
+{
+    std::vector<Vertex> Vertices;
+    std::vector<uint32_t> Indices;      // Triangle list
+
+    uint32_t GetTriangleCount() const { return static_cast<uint32_t>(Indices.size() / 3); }
+};
+
+struct MeshImportOptions
+{
+    // Color of vertices without one (OBJ "v x y z" lines, glTF without COLOR_0)
+    Float4 DefaultColor = { 1.0f, 1.0f, 1.0f, 1.0f };
+    bool ConvertToLeftHanded = true;
+    // OBJ chunk size for parallel parsing; smaller files are parsed in one chunk
+    size_t ObjChunkBytes = 1 << 20;
+};
+
+enum class MeshFileFormat
+{
+    Unknown,
+    Obj,
+    Glb,
+};
+
+// GLB by its magic, otherwise OBJ by the .obj extension
+MeshFileFormat DetectMeshFileFormat(const std::string& path, const uint8_t* data, size_t size);
+
+// jobSystem may be null to parse on the calling thread. On failure error receives
+// the reason (with the line number for OBJ) and mesh is left empty.
+bool ImportObj(const uint8_t* data, size_t size, const MeshImportOptions& options, JobSystem* jobSystem,
+    MeshData* mesh, std::string* error);
+bool ImportGlb(const uint8_t* data, size_t size, const MeshImportOptions& options, JobSystem* jobSystem,
+    MeshData* mesh, std::string* error);
+
+// Maps path and imports it with the matching importer
+bool ImportMesh(const std::string& path, const MeshImportOptions& options, JobSystem* jobSystem, MeshData* mesh,
+    std::string* error);
@@ -0,0 +1,677 @@
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+namespace
+{
+    constexpr uint32_t MaxCacheSize = 64;
+    constexpr uint32_t InvalidIndex = std::numeric_limits<uint32_t>::max();
+
+    uint32_t ClampCacheSize(uint32_t cacheSize)
+    {
+        return std::clamp(cacheSize, 4u, MaxCacheSize);
+    }
+
+    // Triangles around every vertex, in compressed rows: vertex v owns
+    // Triangles[Offsets[v] .. Offsets[v + 1])
+    struct TriangleAdjacency
+    {
+        std::vector<uint32_t> Offsets;
+        std::vector<uint32_t> Triangles;
+        std::vector<uint32_t> Counts;
+    };
+
+    void BuildAdjacency(const uint32_t* indices, size_t indexCount, uint32_t vertexCount, TriangleAdjacency* adjacency)
+    {
+        adjacency->Counts.assign(vertexCount, 0);
+        for (size_t i = 0; i < indexCount; ++i)
+            ++adjacency->Counts[indices[i]];
+
+        adjacency->Offsets.resize(size_t(vertexCount) + 1);
+        uint32_t offset = 0;
+        for (uint32_t v = 0; v < vertexCount; ++v)
+        {
+            adjacency->Offsets[v] = offset;
+            offset += adjacency->Counts[v];
+        }
+        adjacency->Offsets[vertexCount] = offset;
+
+        adjacency->Triangles.resize(indexCount);
+        std::vector<uint32_t> fill(adjacency->Offsets.begin(), adjacency->Offsets.end() - 1);
+        for (size_t i = 0; i < indexCount; ++i)
+            adjacency->Triangles[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+    }
+
+    // Copies the input first when the pass writes over it
+    const uint32_t* SourceIndices(uint32_t* destination, const uint32_t* indices, size_t indexCount,
+        std::vector<uint32_t>* copy)
+    {
+        if (destination != indices)
+            return indices;
+        copy->assign(indices, indices + indexCount);
+        return copy->data();
+    }
+
+    // Exact FIFO with one timestamp per vertex: the clock advances on every miss, so a
+    // vertex is still cached while fewer than cacheSize misses happened since it was loaded.
+    // Advancing the clock by cacheSize + 1 empties the cache.
+    class FifoCache
+    {
+    public:
+        FifoCache(uint32_t entryCount, uint32_t cacheSize)
+            : m_Timestamps(entryCount, 0), m_CacheSize(cacheSize), m_Time(cacheSize + 1)
+        {
+        }
+
+        bool Access(uint32_t entry)
+        {
+            if (m_Time - m_Timestamps[entry] <= m_CacheSize)
+                return true;
+            m_Timestamps[entry] = m_Time++;
+            return false;
+        }
+
+        uint32_t AccessTriangle(const uint32_t* triangle)
+        {
+            return !Access(triangle[0]) + !Access(triangle[1]) + !Access(triangle[2]);
+        }
+
+        void Flush() { m_Time += m_CacheSize + 1; }
+
+    private:
+        std::vector<uint32_t> m_Timestamps;
+        uint32_t m_CacheSize;
+        uint32_t m_Time;
+    };
+
+    uint32_t CountReferencedVertices(const uint32_t* indices, size_t indexCount, uint32_t vertexCount)
+    {
+        std::vector<uint8_t> referenced(vertexCount, 0);
+        uint32_t count = 0;
+        for (size_t i = 0; i < indexCount; ++i)
+        {
+            count += !referenced[indices[i]];
+            referenced[indices[i]] = 1;
+        }
+        return count;
+    }
+
+    // Forsyth's scoring: the three vertices of the last triangle score a fixed 0.75, older
+    // entries fall off with their position, and vertices with few triangles left get a boost
+    // so that they are finished off instead of being left behind as isolated triangles
+    class ForsythScores
+    {
+    public:
+        static constexpr uint32_t MaxValence = 32;
+
+        explicit ForsythScores(uint32_t cacheSize)
+        {
+            for (uint32_t position = 0; position < cacheSize; ++position)
+            {
+                m_Cache[position] = position < 3 ? 0.75f :
+                    std::pow(1.0f - float(position - 3) / float(cacheSize - 3), 1.5f);
+            }
+            for (uint32_t valence = 1; valence < MaxValence; ++valence)
+                m_Valence[valence] = 2.0f / std::sqrt(float(valence));
+        }
+
+        float Get(int32_t cachePosition, uint32_t liveTriangles) const
+        {
+            if (liveTriangles == 0)
+                return -1.0f;
+            float cache = cachePosition < 0 ? 0.0f : m_Cache[cachePosition];
+            float valence = liveTriangles < MaxValence ? m_Valence[liveTriangles] :
+                2.0f / std::sqrt(float(liveTriangles));
+            return cache + valence;
+        }
+
+    private:
+        float m_Cache[MaxCacheSize] = {};
+        float m_Valence[MaxValence] = {};
+    };
+
+    struct Float3Sum
+    {
+        double x = 0.0, y = 0.0, z = 0.0;
+
+        void Add(const Float3& v, double weight)
+        {
+            x += v.x * weight;
+            y += v.y * weight;
+            z += v.z * weight;
+        }
+    };
+
+    // Orthographic view along one axis direction for AnalyzeOverdraw. (u, v, direction) is
+    // right-handed for every view, so a triangle faces the viewer when its normal, in the
+    // winding of the tutorials, points against the direction.
+    struct OverdrawView
+    {
+        int U, V, Depth;
+        float Sign;
+    };
+
+    float Component(const Float3& v, int axis)
+    {
+        return axis == 0 ? v.x : (axis == 1 ? v.y : v.z);
+    }
+
+    // Edge function with a tie-break that gives a pixel center on a shared edge to exactly
+    // one of the two triangles: the edge runs the other way in the neighbor
+    struct Edge
+    {
+        float A, B, C;
+        bool Inclusive;
+
+        Edge(float ax, float ay, float bx, float by)
+            : A(ay - by), B(bx - ax), C(ax * by - ay * bx),
+              Inclusive(by - ay > 0.0f || (by == ay && bx - ax < 0.0f))
+        {
+        }
+
+        float Evaluate(float x, float y) const { return A * x + B * y + C; }
+        bool Inside(float value) const { return value > 0.0f || (value == 0.0f && Inclusive); }
+    };
+}
+
+VertexCacheStats AnalyzeVertexCache(const uint32_t* indices, size_t indexCount, uint32_t vertexCount,
+    uint32_t cacheSize, VertexCacheModel model)
+{
+    VertexCacheStats stats;
+    if (indexCount < 3 || cacheSize == 0)
+        return stats;
+
+    if (model == VertexCacheModel::Fifo)
+    {
+        FifoCache cache(vertexCount, cacheSize);
+        for (size_t i = 0; i < indexCount; ++i)
+            stats.VertexTransforms += !cache.Access(indices[i]);
+    }
+    else
+    {
+        // Most recent first; small enough that moving entries is cheaper than a list
+        std::vector<uint32_t> cache;
+        cache.reserve(cacheSize + 1);
+        for (size_t i = 0; i < indexCount; ++i)
+        {
+            auto found = std::find(cache.begin(), cache.end(), indices[i]);
+            if (found == cache.end())
+            {
+                ++stats.VertexTransforms;
+                cache.insert(cache.begin(), indices[i]);
+                if (cache.size() > cacheSize)
+                    cache.pop_back();
+            }
+            else
+            {
+                std::rotate(cache.begin(), found, found + 1);
+            }
+        }
+    }
+
+    stats.Acmr = float(double(stats.VertexTransforms) / double(indexCount / 3));
+    uint32_t referenced = CountReferencedVertices(indices, indexCount, vertexCount);
+    stats.Atvr = referenced ? float(double(stats.VertexTransforms) / referenced) : 0.0f;
+    return stats;
+}
+
+OverdrawStats AnalyzeOverdraw(const uint32_t* indices, size_t indexCount, const Vertex* vertices,
+    uint32_t vertexCount)
+{
+    constexpr int Resolution = 256;
+    OverdrawStats stats;
+    if (indexCount < 3 || vertexCount == 0)
+        return stats;
+
+    // One uniform scale for all axes keeps the views comparable
+    Float3 boundsMin = vertices[indices[0]].Position;
+    Float3 boundsMax = boundsMin;
+    for (size_t i = 0; i < indexCount; ++i)
+    {
+        const Float3& p = vertices[indices[i]].Position;
+        boundsMin = { std::min(boundsMin.x, p.x), std::min(boundsMin.y, p.y), std::min(boundsMin.z, p.z) };
+        boundsMax = { std::max(boundsMax.x, p.x), std::max(boundsMax.y, p.y), std::max(boundsMax.z, p.z) };
+    }
+    float extent = std::max({ boundsMax.x - boundsMin.x, boundsMax.y - boundsMin.y, boundsMax.z - boundsMin.z });
+    float scale = extent > 0.0f ? (Resolution - 1) / extent : 0.0f;
+
+    const OverdrawView views[6] =
+    {
+        { 1, 2, 0, 1.0f }, { 2, 1, 0, -1.0f },
+        { 2, 0, 1, 1.0f }, { 0, 2, 1, -1.0f },
+        { 0, 1, 2, 1.0f }, { 1, 0, 2, -1.0f },
+    };
+
+    std::vector<float> depth(Resolution * Resolution);
+    for (const OverdrawView& view : views)
+    {
+        std::fill(depth.begin(), depth.end(), std::numeric_limits<float>::infinity());
+        for (size_t i = 0; i + 2 < indexCount; i += 3)
+        {
+            const Float3& p0 = vertices[indices[i]].Position;
+            const Float3& p1 = vertices[indices[i + 1]].Position;
+            const Float3& p2 = vertices[indices[i + 2]].Position;
+            Float3 normal = Vector3Cross(Vector3Subtract(p1, p0), Vector3Subtract(p2, p0));
+            if (Component(normal, view.Depth) * view.Sign >= 0.0f)
+                continue;
+
+            float x[3], y[3], z[3];
+            const Float3* points[3] = { &p0, &p1, &p2 };
+            for (int k = 0; k < 3; ++k)
+            {
+                x[k] = (Component(*points[k], view.U) - Component(boundsMin, view.U)) * scale;
+                y[k] = (Component(*points[k], view.V) - Component(boundsMin, view.V)) * scale;
+                z[k] = Component(*points[k], view.Depth) * view.Sign;
+            }
+
+            // Counter-clockwise in (x, y), so all edge functions are positive inside
+            float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+            if (area == 0.0f)
+                continue;
+            if (area < 0.0f)
+            {
+                std::swap(x[1], x[2]);
+                std::swap(y[1], y[2]);
+                std::swap(z[1], z[2]);
+                area = -area;
+            }
+            Edge e0(x[1], y[1], x[2], y[2]);
+            Edge e1(x[2], y[2], x[0], y[0]);
+            Edge e2(x[0], y[0], x[1], y[1]);
+
+            int minX = std::max(0, static_cast<int>(std::floor(std::min({ x[0], x[1], x[2] }))));
+            int minY = std::max(0, static_cast<int>(std::floor(std::min({ y[0], y[1], y[2] }))));
+            int maxX = std::min(Resolution - 1, static_cast<int>(std::ceil(std::max({ x[0], x[1], x[2] }))));
+            int maxY = std::min(Resolution - 1, static_cast<int>(std::ceil(std::max({ y[0], y[1], y[2] }))));
+            float invArea = 1.0f / area;
+            for (int py = minY; py <= maxY; ++py)
+            {
+                for (int px = minX; px <= maxX; ++px)
+                {
+                    float cx = px + 0.5f, cy = py + 0.5f;
+                    float w0 = e0.Evaluate(cx, cy), w1 = e1.Evaluate(cx, cy), w2 = e2.Evaluate(cx, cy);
+                    if (!e0.Inside(w0) || !e1.Inside(w1) || !e2.Inside(w2))
+                        continue;
+                    float pixelDepth = (w0 * z[0] + w1 * z[1] + w2 * z[2]) * invArea;
+                    float& stored = depth[py * Resolution + px];
+                    if (pixelDepth < stored)
+                    {
+                        stored = pixelDepth;
+                        ++stats.PixelsShaded;
+                    }
+                }
+            }
+        }
+        for (float value : depth)
+            stats.PixelsCovered += value != std::numeric_limits<float>::infinity();
+    }
+
+    stats.Overdraw = stats.PixelsCovered ? float(double(stats.PixelsShaded) / double(stats.PixelsCovered)) : 0.0f;
+    return stats;
+}
+
+VertexFetchStats AnalyzeVertexFetch(const uint32_t* indices, size_t indexCount, uint32_t vertexCount,
+    uint32_t vertexStride)
+{
+    constexpr uint32_t LineSize = 64;
+    constexpr uint32_t CacheLines = 128 * 1024 / LineSize;
+    VertexFetchStats stats;
+    if (indexCount == 0 || vertexStride == 0)
+        return stats;
+
+    // Every index reads its vertex through the cache, as the input assembler does
+    uint64_t lineCount = (uint64_t(vertexCount) * vertexStride + LineSize - 1) / LineSize;
+    FifoCache lines(static_cast<uint32_t>(lineCount), CacheLines);
+    for (size_t i = 0; i < indexCount; ++i)
+    {
+        uint32_t vertex = indices[i];
+        uint64_t first = uint64_t(vertex) * vertexStride / LineSize;
+        uint64_t last = (uint64_t(vertex) * vertexStride + vertexStride - 1) / LineSize;
+        for (uint64_t line = first; line <= last; ++line)
+            stats.BytesFetched += lines.Access(static_cast<uint32_t>(line)) ? 0 : LineSize;
+    }
+
+    uint32_t referenced = CountReferencedVertices(indices, indexCount, vertexCount);
+    stats.Overfetch = referenced ? float(double(stats.BytesFetched) / (double(referenced) * vertexStride)) : 0.0f;
+    return stats;
+}
+
+void OptimizeVertexCache(uint32_t* destination, const uint32_t* indices, size_t indexCount, uint32_t vertexCount,
+    uint32_t cacheSize)
+{
+    std::vector<uint32_t> copy;
+    indices = SourceIndices(destination, indices, indexCount, &copy);
+    size_t triangleCount = indexCount / 3;
+    if (triangleCount == 0)
+        return;
+    cacheSize = ClampCacheSize(cacheSize);
+
+    TriangleAdjacency adjacency;
+    BuildAdjacency(indices, triangleCount * 3, vertexCount, &adjacency);
+    std::vector<uint32_t>& liveTriangles = adjacency.Counts;
+
+    ForsythScores scores(cacheSize);
+    std::vector<int32_t> cachePositions(vertexCount, -1);
+    std::vector<float> vertexScores(vertexCount);
+    for (uint32_t v = 0; v < vertexCount; ++v)
+        vertexScores[v] = scores.Get(-1, liveTriangles[v]);
+    std::vector<uint8_t> emitted(triangleCount, 0);
+
+    uint32_t cache[MaxCacheSize + 3];
+    uint32_t cacheCount = 0;
+    size_t cursor = 0;
+    uint32_t best = InvalidIndex;
+    for (size_t output = 0; output < triangleCount; ++output)
+    {
+        // Nothing in the cache has triangles left: continue in input order
+        if (best == InvalidIndex)
+        {
+            while (emitted[cursor])
+                ++cursor;
+            best = static_cast<uint32_t>(cursor);
+        }
+
+        const uint32_t* triangle = indices + size_t(best) * 3;
+        std::memcpy(destination + output * 3, triangle, 3 * sizeof(uint32_t));
+        emitted[best] = 1;
+
+        // Remove the triangle from the live part of its vertices' lists
+        for (int k = 0; k < 3; ++k)
+        {
+            uint32_t v = triangle[k];
+            uint32_t* begin = adjacency.Triangles.data() + adjacency.Offsets[v];
+            uint32_t* end = begin + liveTriangles[v];
+            std::iter_swap(std::find(begin, end, best), end - 1);
+            --liveTriangles[v];
+        }
+
+        // The triangle's vertices move to the front, everything else shifts back
+        uint32_t newCache[MaxCacheSize + 3];
+        uint32_t newCount = 0;
+        for (int k = 0; k < 3; ++k)
+        {
+            if (std::find(newCache, newCache + newCount, triangle[k]) == newCache + newCount)
+                newCache[newCount++] = triangle[k];
+        }
+        for (uint32_t i = 0; i < cacheCount; ++i)
+        {
+            if (cache[i] != triangle[0] && cache[i] != triangle[1] && cache[i] != triangle[2])
+                newCache[newCount++] = cache[i];
+        }
+
+        for (uint32_t i = 0; i < newCount; ++i)
+        {
+            uint32_t v = newCache[i];
+            cachePositions[v] = i < cacheSize ? static_cast<int32_t>(i) : -1;
+            vertexScores[v] = scores.Get(cachePositions[v], liveTriangles[v]);
+        }
+
+        // The next triangle is the best one touching the cache
+        best = InvalidIndex;
+        float bestScore = -1.0f;
+        cacheCount = std::min(newCount, cacheSize);
+        for (uint32_t i = 0; i < cacheCount; ++i)
+        {
+            uint32_t v = newCache[i];
+            cache[i] = v;
+            const uint32_t* candidates = adjacency.Triangles.data() + adjacency.Offsets[v];
+            for (uint32_t j = 0; j < liveTriangles[v]; ++j)
+            {
+                const uint32_t* candidate = indices + size_t(candidates[j]) * 3;
+                float score = vertexScores[candidate[0]] + vertexScores[candidate[1]] + vertexScores[candidate[2]];
+                if (score > bestScore)
+                {
+                    bestScore = score;
+                    best = candidates[j];
+                }
+            }
+        }
+    }
+}
+
+void OptimizeVertexCacheTipsify(uint32_t* destination, const uint32_t* indices, size_t indexCount,
+    uint32_t vertexCount, uint32_t cacheSize)
+{
+    std::vector<uint32_t> copy;
+    indices = SourceIndices(destination, indices, indexCount, &copy);
+    size_t triangleCount = indexCount / 3;
+    if (triangleCount == 0)
+        return;
+    cacheSize = ClampCacheSize(cacheSize);
+
+    TriangleAdjacency adjacency;
+    BuildAdjacency(indices, triangleCount * 3, vertexCount, &adjacency);
+    std::vector<uint32_t>& liveTriangles = adjacency.Counts;
+
+    // Same clock as FifoCache: vertex v is cached while time - timestamps[v] <= cacheSize
+    std::vector<uint32_t> timestamps(vertexCount, 0);
+    uint32_t time = cacheSize + 1;
+    std::vector<uint8_t> emitted(triangleCount, 0);
+    std::vector<uint32_t> deadEnds;
+    std::vector<uint32_t> candidates;
+    uint32_t cursor = 0;
+    size_t output = 0;
+
+    uint32_t fan = indices[0];
+    while (fan != InvalidIndex)
+    {
+        // Emit every remaining triangle around the fan vertex
+        candidates.clear();
+        for (uint32_t a = adjacency.Offsets[fan]; a < adjacency.Offsets[fan + 1]; ++a)
+        {
+            uint32_t t = adjacency.Triangles[a];
+            if (emitted[t])
+                continue;
+            emitted[t] = 1;
+            for (int k = 0; k < 3; ++k)
+            {
+                uint32_t v = indices[size_t(t) * 3 + k];
+                destination[output++] = v;
+                deadEnds.push_back(v);
+                candidates.push_back(v);
+                --liveTriangles[v];
+                if (time - timestamps[v] > cacheSize)
+                    timestamps[v] = time++;
+            }
+        }
+
+        // Prefer the candidate that will still be cached after its own fan, and among
+        // those the oldest one, which is about to be evicted
+        fan = InvalidIndex;
+        int64_t bestPriority = -1;
+        for (uint32_t v : candidates)
+        {
+            if (liveTriangles[v] == 0)
+                continue;
+            int64_t age = int64_t(time) - timestamps[v];
+            int64_t priority = age + 2 * int64_t(liveTriangles[v]) <= cacheSize ? age : 0;
+            if (priority > bestPriority)
+            {
+                bestPriority = priority;
+                fan = v;
+            }
+        }
+
+        // Dead end: back up through recently emitted vertices, then scan in input order
+        while (fan == InvalidIndex && !deadEnds.empty())
+        {
+            uint32_t v = deadEnds.back();
+            deadEnds.pop_back();
+            if (liveTriangles[v] > 0)
+                fan = v;
+        }
+        while (fan == InvalidIndex && cursor < vertexCount)
+        {
+            if (liveTriangles[cursor] > 0)
+                fan = cursor;
+            else
+                ++cursor;
+        }
+    }
+}
+
+void OptimizeOverdraw(uint32_t* destination, const uint32_t* indices, size_t indexCount, const Vertex* vertices,
+    uint32_t vertexCount, uint32_t cacheSize, float threshold)
+{
+    std::vector<uint32_t> copy;
+    indices = SourceIndices(destination, indices, indexCount, &copy);
+    size_t triangleCount = indexCount / 3;
+    if (triangleCount == 0)
+        return;
+    cacheSize = ClampCacheSize(cacheSize);
+
+    // Hard boundaries: triangles whose three vertices all miss start over anyway
+    FifoCache cache(vertexCount, cacheSize);
+    std::vector<uint32_t> hardBoundaries;
+    for (size_t t = 0; t < triangleCount; ++t)
+    {
+        if (cache.AccessTriangle(indices + t * 3) == 3)
+            hardBoundaries.push_back(static_cast<uint32_t>(t));
+    }
+    hardBoundaries.push_back(static_cast<uint32_t>(triangleCount));
+
+    // Soft boundaries: cut a hard cluster as soon as the piece since the last cut, run
+    // with an empty cache, is within threshold of the whole cluster's ACMR
+    std::vector<uint32_t> clusters;
+    for (size_t h = 0; h + 1 < hardBoundaries.size(); ++h)
+    {
+        uint32_t begin = hardBoundaries[h];
+        uint32_t end = hardBoundaries[h + 1];
+        cache.Flush();
+        uint64_t clusterMisses = 0;
+        for (uint32_t t = begin; t < end; ++t)
+            clusterMisses += cache.AccessTriangle(indices + size_t(t) * 3);
+        double limit = threshold * double(clusterMisses) / double(end - begin);
+
+        clusters.push_back(begin);
+        cache.Flush();
+        uint64_t misses = 0;
+        uint32_t triangles = 0;
+        for (uint32_t t = begin; t < end; ++t)
+        {
+            misses += cache.AccessTriangle(indices + size_t(t) * 3);
+            ++triangles;
+            if (t + 1 < end && double(misses) <= limit * triangles)
+            {
+                clusters.push_back(t + 1);
+                cache.Flush();
+                misses = 0;
+                triangles = 0;
+            }
+        }
+    }
+    clusters.push_back(static_cast<uint32_t>(triangleCount));
+    size_t clusterCount = clusters.size() - 1;
+
+    // Area-weighted centroid and normal per cluster
+    std::vector<Float3Sum> centroids(clusterCount), normals(clusterCount);
+    std::vector<double> areas(clusterCount, 0.0);
+    Float3Sum meshCentroid;
+    double meshArea = 0.0;
+    for (size_t c = 0; c < clusterCount; ++c)
+    {
+        for (uint32_t t = clusters[c]; t < clusters[c + 1]; ++t)
+        {
+            const Float3& p0 = vertices[indices[size_t(t) * 3]].Position;
+            const Float3& p1 = vertices[indices[size_t(t) * 3 + 1]].Position;
+            const Float3& p2 = vertices[indices[size_t(t) * 3 + 2]].Position;
+            Float3 normal = Vector3Cross(Vector3Subtract(p1, p0), Vector3Subtract(p2, p0));
+            double area = std::sqrt(double(Vector3Dot(normal, normal)));
+            Float3 center = { (p0.x + p1.x + p2.x) / 3.0f, (p0.y + p1.y + p2.y) / 3.0f, (p0.z + p1.z + p2.z) / 3.0f };
+            centroids[c].Add(center, area);
+            normals[c].Add(normal, 1.0);
+            areas[c] += area;
+        }
+        meshCentroid.x += centroids[c].x;
+        meshCentroid.y += centroids[c].y;
+        meshCentroid.z += centroids[c].z;
+        meshArea += areas[c];
+    }
+    if (meshArea > 0.0)
+    {
+        meshCentroid.x /= meshArea;
+        meshCentroid.y /= meshArea;
+        meshCentroid.z /= meshArea;
+    }
+
+    // Clusters that face away from the center are in front of the others from most views
+    std::vector<float> keys(clusterCount, 0.0f);
+    for (size_t c = 0; c < clusterCount; ++c)
+    {
+        double length = std::sqrt(normals[c].x * normals[c].x + normals[c].y * normals[c].y +
+            normals[c].z * normals[c].z);
+        if (areas[c] <= 0.0 || length <= 0.0)
+            continue;
+        double dx = centroids[c].x / areas[c] - meshCentroid.x;
+        double dy = centroids[c].y / areas[c] - meshCentroid.y;
+        double dz = centroids[c].z / areas[c] - meshCentroid.z;
+        keys[c] = float((dx * normals[c].x + dy * normals[c].y + dz * normals[c].z) / length);
+    }
+    std::vector<uint32_t> order(clusterCount);
+    for (size_t c = 0; c < clusterCount; ++c)
+        order[c] = static_cast<uint32_t>(c);
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return keys[a] > keys[b]; });
+
+    size_t output = 0;
+    for (uint32_t c : order)
+    {
+        size_t count = size_t(clusters[c + 1] - clusters[c]) * 3;
+        std::memcpy(destination + output, indices + size_t(clusters[c]) * 3, count * sizeof(uint32_t));
+        output += count;
+    }
+}
+
+uint32_t ComputeVertexFetchRemap(uint32_t* remap, const uint32_t* indices, size_t indexCount, uint32_t vertexCount)
+{
+    std::fill(remap, remap + vertexCount, InvalidIndex);
+    uint32_t next = 0;
+    for (size_t i = 0; i < indexCount; ++i)
+    {
+        if (remap[indices[i]] == InvalidIndex)
+            remap[indices[i]] = next++;
+    }
+    return next;
+}
+
+uint32_t OptimizeVertexFetch(Vertex* destination, uint32_t* indices, size_t indexCount, const Vertex* vertices,
+    uint32_t vertexCount)
+{
+    std::vector<uint32_t> remap(vertexCount);
+    uint32_t count = ComputeVertexFetchRemap(remap.data(), indices, indexCount, vertexCount);
+    for (uint32_t v = 0; v < vertexCount; ++v)
+    {
+        if (remap[v] != InvalidIndex)
+            destination[remap[v]] = vertices[v];
+    }
+    for (size_t i = 0; i < indexCount; ++i)
+        indices[i] = remap[indices[i]];
+    return count;
+}
+
+void OptimizeMesh(MeshData* mesh, const MeshOptimizeOptions& options)
+{
+    uint32_t* indices = mesh->Indices.data();
+    size_t indexCount = mesh->Indices.size();
+    uint32_t vertexCount = static_cast<uint32_t>(mesh->Vertices.size());
+
+    if (options.CacheAlgorithm == VertexCacheAlgorithm::Tipsify)
+        OptimizeVertexCacheTipsify(indices, indices, indexCount, vertexCount, options.CacheSize);
+    else
+        OptimizeVertexCache(indices, indices, indexCount, vertexCount, options.CacheSize);
+
+    if (options.OverdrawThreshold > 0.0f)
+        OptimizeOverdraw(indices, indices, indexCount, mesh->Vertices.data(), vertexCount, options.CacheSize,
+            options.OverdrawThreshold);
+
+    if (options.ReorderVertices)
+    {
+        std::vector<Vertex> vertices(vertexCount);
+        vertices.resize(OptimizeVertexFetch(vertices.data(), indices, indexCount, mesh->Vertices.data(),
+            vertexCount));
+        mesh->Vertices = std::move(vertices);
+    }
+}
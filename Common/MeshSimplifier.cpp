@@ -0,0 +1,557 @@
+#include "MeshSimplifier.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#include "Hash.h"
+
+namespace
+{
+    // Weight of the planes that hold open borders, per squared length of the border edge
+    constexpr double BorderWeight = 4.0;
+
+    // Cosine of the largest turn of a triangle's normal in one collapse; folds start well before 90 degrees
+    constexpr double MaxNormalTurn = 0.25;
+
+    // Triangles around every vertex, in compressed rows: vertex v owns
+    // Triangles[Offsets[v] .. Offsets[v + 1])
+    struct TriangleAdjacency
+    {
+        std::vector<uint32_t> Offsets;
+        std::vector<uint32_t> Triangles;
+        std::vector<uint32_t> Counts;
+    };
+
+    void BuildAdjacency(const uint32_t* indices, size_t indexCount, uint32_t vertexCount, TriangleAdjacency* adjacency)
+    {
+        adjacency->Counts.assign(vertexCount, 0);
+        for (size_t i = 0; i < indexCount; ++i)
+            ++adjacency->Counts[indices[i]];
+
+        adjacency->Offsets.resize(size_t(vertexCount) + 1);
+        uint32_t offset = 0;
+        for (uint32_t v = 0; v < vertexCount; ++v)
+        {
+            adjacency->Offsets[v] = offset;
+            offset += adjacency->Counts[v];
+        }
+        adjacency->Offsets[vertexCount] = offset;
+
+        adjacency->Triangles.resize(indexCount);
+        std::vector<uint32_t> fill(adjacency->Offsets.begin(), adjacency->Offsets.end() - 1);
+        for (size_t i = 0; i < indexCount; ++i)
+            adjacency->Triangles[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+    }
+
+    // Weighted sum of squared distances to planes: (n.p + d)^2 = p'Ap + 2b.p + c
+    struct Quadric
+    {
+        double A00 = 0.0, A01 = 0.0, A02 = 0.0, A11 = 0.0, A12 = 0.0, A22 = 0.0;
+        double B0 = 0.0, B1 = 0.0, B2 = 0.0;
+        double C = 0.0;
+        double Area = 0.0;              // Of the triangle planes; border planes add none
+
+        void AddPlane(const double n[3], double d, double weight)
+        {
+            A00 += weight * n[0] * n[0];
+            A01 += weight * n[0] * n[1];
+            A02 += weight * n[0] * n[2];
+            A11 += weight * n[1] * n[1];
+            A12 += weight * n[1] * n[2];
+            A22 += weight * n[2] * n[2];
+            B0 += weight * n[0] * d;
+            B1 += weight * n[1] * d;
+            B2 += weight * n[2] * d;
+            C += weight * d * d;
+        }
+
+        void Add(const Quadric& q)
+        {
+            A00 += q.A00;
+            A01 += q.A01;
+            A02 += q.A02;
+            A11 += q.A11;
+            A12 += q.A12;
+            A22 += q.A22;
+            B0 += q.B0;
+            B1 += q.B1;
+            B2 += q.B2;
+            C += q.C;
+            Area += q.Area;
+        }
+
+        double Evaluate(const Float3& p) const
+        {
+            double x = p.x, y = p.y, z = p.z;
+            return x * x * A00 + y * y * A11 + z * z * A22 + 2.0 * (x * y * A01 + x * z * A02 + y * z * A12) +
+                2.0 * (x * B0 + y * B1 + z * B2) + C;
+        }
+    };
+
+    // RMS distance of p to the planes of a and b, weighted by area
+    float GetCollapseError(const Quadric& a, const Quadric& b, const Float3& p)
+    {
+        double area = a.Area + b.Area;
+        double error = a.Evaluate(p) + b.Evaluate(p);
+        return area > 0.0 ? static_cast<float>(std::sqrt(std::max(error, 0.0) / area)) : 0.0f;
+    }
+
+    void PlaneOf(const Float3& p0, const Float3& p1, const Float3& p2, double normal[3], double* length)
+    {
+        double u[3] = { double(p1.x) - p0.x, double(p1.y) - p0.y, double(p1.z) - p0.z };
+        double v[3] = { double(p2.x) - p0.x, double(p2.y) - p0.y, double(p2.z) - p0.z };
+        normal[0] = u[1] * v[2] - u[2] * v[1];
+        normal[1] = u[2] * v[0] - u[0] * v[2];
+        normal[2] = u[0] * v[1] - u[1] * v[0];
+        *length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+    }
+
+    enum class VertexKind : uint8_t
+    {
+        Interior,       // Collapses along any edge
+        Border,         // Collapses along its open border only
+        Locked,         // Seam, non-manifold or unreferenced: never moves
+    };
+
+    // The corner of triangle t that holds vertex v
+    uint32_t CornerOf(const std::vector<uint32_t>& indices, uint32_t t, uint32_t v)
+    {
+        return indices[t * 3] == v ? 0 : (indices[t * 3 + 1] == v ? 1 : 2);
+    }
+
+    // Classifies the vertices on the current triangles. The outgoing border edge of a border
+    // vertex v is v -> borderNext[v], its incoming one borderPrev[v] -> v.
+    void ClassifyVertices(const std::vector<uint32_t>& indices, const TriangleAdjacency& adjacency,
+        const std::vector<uint8_t>& seams, std::vector<VertexKind>* kinds, std::vector<uint32_t>* borderNext,
+        std::vector<uint32_t>* borderPrev)
+    {
+        uint32_t vertexCount = static_cast<uint32_t>(seams.size());
+        for (uint32_t v = 0; v < vertexCount; ++v)
+        {
+            uint32_t begin = adjacency.Offsets[v], end = adjacency.Offsets[v + 1];
+            if (begin == end || seams[v])
+            {
+                (*kinds)[v] = VertexKind::Locked;
+                continue;
+            }
+
+            // Edge v -> next has a twin when a triangle of v holds next -> v, i.e. has next before v
+            uint32_t outgoing = 0, incoming = 0;
+            bool manifold = true;
+            for (uint32_t a = begin; a < end; ++a)
+            {
+                uint32_t t = adjacency.Triangles[a], corner = CornerOf(indices, t, v);
+                uint32_t next = indices[t * 3 + (corner + 1) % 3], prev = indices[t * 3 + (corner + 2) % 3];
+                uint32_t twins = 0, sameNext = 0, prevTwins = 0;
+                for (uint32_t b = begin; b < end; ++b)
+                {
+                    uint32_t s = adjacency.Triangles[b], sc = CornerOf(indices, s, v);
+                    uint32_t sNext = indices[s * 3 + (sc + 1) % 3], sPrev = indices[s * 3 + (sc + 2) % 3];
+                    twins += sPrev == next;
+                    sameNext += sNext == next;
+                    prevTwins += sNext == prev;
+                }
+                manifold = manifold && twins <= 1 && sameNext == 1 && prevTwins <= 1;
+                if (twins == 0)
+                {
+                    ++outgoing;
+                    (*borderNext)[v] = next;
+                }
+                if (prevTwins == 0)
+                {
+                    ++incoming;
+                    (*borderPrev)[v] = prev;
+                }
+            }
+            if (!manifold || outgoing != incoming || outgoing > 1)
+                (*kinds)[v] = VertexKind::Locked;
+            else
+                (*kinds)[v] = outgoing == 1 ? VertexKind::Border : VertexKind::Interior;
+        }
+    }
+
+    // Referenced vertices that share their position with another referenced one: collapsing
+    // them would tear the seam
+    std::vector<uint8_t> FindSeams(const Vertex* vertices, const TriangleAdjacency& adjacency)
+    {
+        uint32_t vertexCount = static_cast<uint32_t>(adjacency.Counts.size());
+        auto key = [vertices](uint32_t v)
+        {
+            // + 0.0f turns -0 into +0
+            const Float3& position = vertices[v].Position;
+            float p[3] = { position.x + 0.0f, position.y + 0.0f, position.z + 0.0f };
+            uint32_t bits[3];
+            std::memcpy(bits, p, sizeof(bits));
+            return HashWord(uint64_t(bits[0]) << 32 | bits[1], HashWord(bits[2], HashSeed));
+        };
+        auto samePosition = [vertices](uint32_t a, uint32_t b)
+        {
+            const Float3& p = vertices[a].Position;
+            const Float3& q = vertices[b].Position;
+            return p.x == q.x && p.y == q.y && p.z == q.z;
+        };
+
+        std::vector<std::pair<uint64_t, uint32_t>> order;
+        for (uint32_t v = 0; v < vertexCount; ++v)
+        {
+            if (adjacency.Counts[v] > 0)
+                order.push_back({ key(v), v });
+        }
+        std::sort(order.begin(), order.end());
+
+        std::vector<uint8_t> seams(vertexCount, 0);
+        for (size_t i = 0; i < order.size();)
+        {
+            size_t end = i + 1;
+            while (end < order.size() && order[end].first == order[i].first)
+                ++end;
+            for (size_t a = i; a < end; ++a)
+            {
+                for (size_t b = a + 1; b < end; ++b)
+                {
+                    if (samePosition(order[a].second, order[b].second))
+                        seams[order[a].second] = seams[order[b].second] = 1;
+                }
+            }
+            i = end;
+        }
+        return seams;
+    }
+
+    struct Collapse
+    {
+        uint32_t From;
+        uint32_t To;
+        float Error;
+    };
+
+    class Simplifier
+    {
+    public:
+        Simplifier(const Vertex* vertices, uint32_t vertexCount)
+            : m_Vertices(vertices)
+            , m_VertexCount(vertexCount)
+            , m_Quadrics(vertexCount)
+            , m_Kinds(vertexCount)
+            , m_BorderNext(vertexCount)
+            , m_BorderPrev(vertexCount)
+            , m_Remap(vertexCount)
+            , m_Collapsed(vertexCount)
+            , m_Marks(vertexCount, 0)
+        {
+            for (uint32_t v = 0; v < vertexCount; ++v)
+                m_Remap[v] = v;
+        }
+
+        // Returns the largest error of the collapses made
+        float Run(std::vector<uint32_t>* indices, size_t targetIndexCount, float targetError)
+        {
+            BuildAdjacency(indices->data(), indices->size(), m_VertexCount, &m_Adjacency);
+            m_Seams = FindSeams(m_Vertices, m_Adjacency);
+            ClassifyVertices(*indices, m_Adjacency, m_Seams, &m_Kinds, &m_BorderNext, &m_BorderPrev);
+            ComputeQuadrics(*indices);
+
+            float resultError = 0.0f;
+            while (indices->size() > targetIndexCount)
+            {
+                size_t triangleCount = indices->size() / 3, targetTriangles = targetIndexCount / 3;
+                if (!RunPass(*indices, triangleCount - targetTriangles, targetError, &resultError))
+                    break;
+                Compact(indices);
+                BuildAdjacency(indices->data(), indices->size(), m_VertexCount, &m_Adjacency);
+                ClassifyVertices(*indices, m_Adjacency, m_Seams, &m_Kinds, &m_BorderNext, &m_BorderPrev);
+            }
+            return resultError;
+        }
+
+    private:
+        const Float3& Position(uint32_t v) const { return m_Vertices[v].Position; }
+
+        void ComputeQuadrics(const std::vector<uint32_t>& indices)
+        {
+            std::fill(m_Quadrics.begin(), m_Quadrics.end(), Quadric());
+            for (size_t i = 0; i < indices.size(); i += 3)
+            {
+                double normal[3], length;
+                PlaneOf(Position(indices[i]), Position(indices[i + 1]), Position(indices[i + 2]), normal, &length);
+                if (length == 0.0)
+                    continue;
+                for (double& n : normal)
+                    n /= length;
+                const Float3& p0 = Position(indices[i]);
+                double d = -(normal[0] * p0.x + normal[1] * p0.y + normal[2] * p0.z);
+                for (size_t k = 0; k < 3; ++k)
+                {
+                    Quadric& q = m_Quadrics[indices[i + k]];
+                    q.AddPlane(normal, d, length * 0.5);
+                    q.Area += length * 0.5;
+                }
+
+                // A plane through each open border edge, perpendicular to the triangle
+                for (size_t k = 0; k < 3; ++k)
+                {
+                    uint32_t a = indices[i + k], b = indices[i + (k + 1) % 3];
+                    if (m_Kinds[a] == VertexKind::Interior || !IsBorderEdge(a, b))
+                        continue;
+                    const Float3& pa = Position(a);
+                    const Float3& pb = Position(b);
+                    double edge[3] = { double(pb.x) - pa.x, double(pb.y) - pa.y, double(pb.z) - pa.z };
+                    double plane[3] = { edge[1] * normal[2] - edge[2] * normal[1],
+                        edge[2] * normal[0] - edge[0] * normal[2], edge[0] * normal[1] - edge[1] * normal[0] };
+                    double planeLength = std::sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+                    if (planeLength == 0.0)
+                        continue;
+                    for (double& n : plane)
+                        n /= planeLength;
+                    double pd = -(plane[0] * pa.x + plane[1] * pa.y + plane[2] * pa.z);
+                    double weight = BorderWeight * (edge[0] * edge[0] + edge[1] * edge[1] + edge[2] * edge[2]);
+                    m_Quadrics[a].AddPlane(plane, pd, weight);
+                    m_Quadrics[b].AddPlane(plane, pd, weight);
+                }
+            }
+        }
+
+        // Whether a -> b is an edge of a triangle without a twin b -> a
+        bool IsBorderEdge(uint32_t a, uint32_t b) const
+        {
+            return (m_Kinds[a] == VertexKind::Border && m_BorderNext[a] == b) ||
+                (m_Kinds[b] == VertexKind::Border && m_BorderPrev[b] == a);
+        }
+
+        bool CanCollapse(uint32_t from, uint32_t to) const
+        {
+            if (m_Kinds[from] == VertexKind::Interior)
+                return true;
+            return m_Kinds[from] == VertexKind::Border && (m_BorderNext[from] == to || m_BorderPrev[from] == to);
+        }
+
+        // Every movable vertex proposes its cheapest collapse
+        void FindCollapses(const std::vector<uint32_t>& indices)
+        {
+            m_Collapses.clear();
+            for (uint32_t v = 0; v < m_VertexCount; ++v)
+            {
+                if (m_Kinds[v] == VertexKind::Locked)
+                    continue;
+                Collapse best = { v, v, std::numeric_limits<float>::max() };
+                for (uint32_t a = m_Adjacency.Offsets[v]; a < m_Adjacency.Offsets[v + 1]; ++a)
+                {
+                    uint32_t t = m_Adjacency.Triangles[a];
+                    for (uint32_t k = 0; k < 3; ++k)
+                    {
+                        uint32_t to = indices[t * 3 + k];
+                        if (to == v || !CanCollapse(v, to))
+                            continue;
+                        float error = GetCollapseError(m_Quadrics[v], m_Quadrics[to], Position(to));
+                        if (error < best.Error)
+                            best = { v, to, error };
+                    }
+                }
+                if (best.To != v)
+                    m_Collapses.push_back(best);
+            }
+            std::sort(m_Collapses.begin(), m_Collapses.end(), [](const Collapse& a, const Collapse& b)
+            {
+                return a.Error < b.Error || (a.Error == b.Error && a.From < b.From);
+            });
+        }
+
+        // Checks the collapse against the triangles as the collapses made in this pass left them:
+        // no triangle of from may flip, and the only vertices adjacent to both ends may be the
+        // corners opposite the edge, or the surface would fold into non-manifold edges.
+        // Returns the number of triangles the collapse removes, 0 when it is not allowed.
+        uint32_t CheckCollapse(const std::vector<uint32_t>& indices, uint32_t from, uint32_t to)
+        {
+            uint32_t stamp = ++m_Stamp;
+            uint32_t opposite[2] = { from, from };
+            uint32_t removed = 0;
+            for (uint32_t a = m_Adjacency.Offsets[from]; a < m_Adjacency.Offsets[from + 1]; ++a)
+            {
+                uint32_t t = m_Adjacency.Triangles[a];
+                uint32_t corners[3] = { m_Remap[indices[t * 3]], m_Remap[indices[t * 3 + 1]],
+                    m_Remap[indices[t * 3 + 2]] };
+                for (uint32_t corner : corners)
+                    m_Marks[corner] = stamp;
+                if (corners[0] == to || corners[1] == to || corners[2] == to)
+                {
+                    if (removed < 2)
+                        opposite[removed] = corners[0] ^ corners[1] ^ corners[2] ^ from ^ to;
+                    ++removed;
+                    continue;
+                }
+
+                double before[3], after[3], beforeLength, afterLength;
+                PlaneOf(Position(corners[0]), Position(corners[1]), Position(corners[2]), before, &beforeLength);
+                for (uint32_t& corner : corners)
+                    corner = corner == from ? to : corner;
+                PlaneOf(Position(corners[0]), Position(corners[1]), Position(corners[2]), after, &afterLength);
+                double dot = before[0] * after[0] + before[1] * after[1] + before[2] * after[2];
+                if (beforeLength > 0.0 && dot <= MaxNormalTurn * beforeLength * afterLength)
+                    return 0;
+            }
+            if (removed == 0 || removed > 2)
+                return 0;
+
+            for (uint32_t a = m_Adjacency.Offsets[to]; a < m_Adjacency.Offsets[to + 1]; ++a)
+            {
+                uint32_t t = m_Adjacency.Triangles[a];
+                for (uint32_t k = 0; k < 3; ++k)
+                {
+                    uint32_t corner = m_Remap[indices[t * 3 + k]];
+                    if (m_Marks[corner] == stamp && corner != from && corner != to && corner != opposite[0] &&
+                        corner != opposite[1])
+                    {
+                        return 0;
+                    }
+                }
+            }
+            return removed;
+        }
+
+        // Applies the cheapest collapses that do not touch each other. Returns false when
+        // none could be made.
+        bool RunPass(const std::vector<uint32_t>& indices, size_t trianglesToRemove, float targetError,
+            float* resultError)
+        {
+            FindCollapses(indices);
+            if (m_Collapses.empty() || m_Collapses[0].Error > targetError)
+                return false;
+
+            // Stay near the cheap end of the list: the pass stops at 1.5 times the error of the
+            // collapse that would end it if no candidate were skipped
+            size_t rank = std::min({ trianglesToRemove / 2, m_Collapses.size() / 3, m_Collapses.size() - 1 });
+            float passLimit = std::min(targetError, m_Collapses[rank].Error * 1.5f);
+
+            std::fill(m_Collapsed.begin(), m_Collapsed.end(), 0);
+            size_t removed = 0;
+            bool progress = false;
+            for (const Collapse& collapse : m_Collapses)
+            {
+                if (removed >= trianglesToRemove || collapse.Error > targetError ||
+                    (collapse.Error > passLimit && progress))
+                {
+                    break;
+                }
+                if (m_Collapsed[collapse.From] || m_Collapsed[collapse.To])
+                    continue;
+                uint32_t triangles = CheckCollapse(indices, collapse.From, collapse.To);
+                if (triangles == 0)
+                    continue;
+
+                m_Remap[collapse.From] = collapse.To;
+                m_Quadrics[collapse.To].Add(m_Quadrics[collapse.From]);
+                m_Collapsed[collapse.From] = m_Collapsed[collapse.To] = 1;
+                *resultError = std::max(*resultError, collapse.Error);
+                removed += triangles;
+                progress = true;
+            }
+            return progress;
+        }
+
+        void Compact(std::vector<uint32_t>* indices)
+        {
+            size_t kept = 0;
+            for (size_t i = 0; i < indices->size(); i += 3)
+            {
+                uint32_t a = m_Remap[(*indices)[i]], b = m_Remap[(*indices)[i + 1]], c = m_Remap[(*indices)[i + 2]];
+                if (a == b || b == c || c == a)
+                    continue;
+                (*indices)[kept++] = a;
+                (*indices)[kept++] = b;
+                (*indices)[kept++] = c;
+            }
+            indices->resize(kept);
+        }
+
+        const Vertex* m_Vertices;
+        uint32_t m_VertexCount;
+        std::vector<Quadric> m_Quadrics;
+        std::vector<VertexKind> m_Kinds;
+        std::vector<uint32_t> m_BorderNext;
+        std::vector<uint32_t> m_BorderPrev;
+        std::vector<uint32_t> m_Remap;
+        std::vector<uint8_t> m_Collapsed;
+        std::vector<uint32_t> m_Marks;
+        uint32_t m_Stamp = 0;
+        std::vector<uint8_t> m_Seams;
+        TriangleAdjacency m_Adjacency;
+        std::vector<Collapse> m_Collapses;
+    };
+}
+
+size_t SimplifyMesh(uint32_t* destination, const uint32_t* indices, size_t indexCount, const Vertex* vertices,
+    uint32_t vertexCount, size_t targetIndexCount, float targetError, float* resultError)
+{
+    // Degenerate triangles have no plane and would only get in the way of the topology
+    std::vector<uint32_t> work;
+    work.reserve(indexCount - indexCount % 3);
+    for (size_t i = 0; i + 2 < indexCount; i += 3)
+    {
+        uint32_t a = indices[i], b = indices[i + 1], c = indices[i + 2];
+        if (a != b && b != c && c != a)
+            work.insert(work.end(), { a, b, c });
+    }
+
+    float error = 0.0f;
+    if (work.size() > targetIndexCount)
+    {
+        Simplifier simplifier(vertices, vertexCount);
+        error = simplifier.Run(&work, targetIndexCount, targetError);
+    }
+    std::copy(work.begin(), work.end(), destination);
+    if (resultError)
+        *resultError = error;
+    return work.size();
+}
+
+void BuildLodChain(const MeshData& mesh, const LodChainOptions& options, MeshLodChain* chain)
+{
+    uint32_t vertexCount = static_cast<uint32_t>(mesh.Vertices.size());
+    size_t indexCount = mesh.Indices.size() - mesh.Indices.size() % 3;
+    chain->Indices.assign(mesh.Indices.begin(), mesh.Indices.begin() + indexCount);
+    chain->Lods.assign(1, { 0, static_cast<uint32_t>(indexCount), 0.0f });
+
+    // Bounding sphere around the center of the box of the referenced vertices
+    Float3 low = { std::numeric_limits<float>::max(), std::numeric_limits<float>::max(),
+        std::numeric_limits<float>::max() };
+    Float3 high = { -low.x, -low.y, -low.z };
+    for (uint32_t index : chain->Indices)
+    {
+        const Float3& p = mesh.Vertices[index].Position;
+        low = { std::min(low.x, p.x), std::min(low.y, p.y), std::min(low.z, p.z) };
+        high = { std::max(high.x, p.x), std::max(high.y, p.y), std::max(high.z, p.z) };
+    }
+    chain->Center = { 0.0f, 0.0f, 0.0f };
+    chain->Radius = 0.0f;
+    if (indexCount == 0)
+        return;
+    chain->Center = { (low.x + high.x) * 0.5f, (low.y + high.y) * 0.5f, (low.z + high.z) * 0.5f };
+    float radiusSquared = 0.0f;
+    for (uint32_t index : chain->Indices)
+    {
+        Float3 d = Vector3Subtract(mesh.Vertices[index].Position, chain->Center);
+        radiusSquared = std::max(radiusSquared, Vector3Dot(d, d));
+    }
+    chain->Radius = std::sqrt(radiusSquared);
+
+    std::vector<uint32_t> level;
+    for (float relativeError : options.Errors)
+    {
+        MeshLod previous = chain->Lods.back();
+        float limit = relativeError * chain->Radius - previous.Error;
+        if (limit <= 0.0f)
+            continue;
+        level.resize(previous.IndexCount);
+        float error = 0.0f;
+        size_t count = SimplifyMesh(level.data(), chain->Indices.data() + previous.FirstIndex, previous.IndexCount,
+            mesh.Vertices.data(), vertexCount, 0, limit, &error);
+        if (count == 0 || count > previous.IndexCount * options.MaxTriangleRatio)
+            continue;
+        chain->Lods.push_back({ static_cast<uint32_t>(chain->Indices.size()), static_cast<uint32_t>(count),
+            previous.Error + error });
+        chain->Indices.insert(chain->Indices.end(), level.begin(), level.begin() + count);
+    }
+}
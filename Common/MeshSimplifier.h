@@ -0,0 +1,65 @@
+#pragma once
+
+// Quadric error simplification (Garland and Heckbert, "Surface Simplification
+// Using Quadric Error Metrics") and the LOD chains LodSelector picks from.
+//
+// Every edge collapse moves one vertex onto the other end of the edge, so a
+// simplified index list still addresses the original vertex buffer: a LOD
+// chain is the mesh's vertex buffer plus one index buffer holding all levels
+// back to back, and level i is DrawIndexed(lod.IndexCount, lod.FirstIndex, 0).
+//
+// Each vertex carries the quadric of the planes of its triangles, weighted by
+// area; a collapse costs the area-weighted RMS distance of the target vertex
+// to the planes both ends have accumulated, in object-space units. Vertices
+// are classified on index topology: interior vertices collapse along any edge
+// and open border vertices only along their border, held in place by extra
+// planes through the border edges; vertices that share their position with
+// another one (a seam in color) or sit on non-manifold edges never move, so
+// seams cannot crack. Collapses run in passes: every movable vertex picks its
+// cheapest edge, the candidates are taken cheapest first as long as they touch
+// no vertex already collapsed in the pass, would not flip a triangle and keep
+// the surface manifold, and the index list is compacted before the next pass.
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "MathUtil.h"
+#include "MeshImporter.h"
+#include "Vertex.h"
+
+// Writes the simplified triangle list (at most indexCount indices) to destination and
+// returns its index count. Stops once at most targetIndexCount indices are left or when
+// the next collapse would cost more than targetError; resultError receives the largest
+// cost of the collapses made. destination may equal indices.
+size_t SimplifyMesh(uint32_t* destination, const uint32_t* indices, size_t indexCount, const Vertex* vertices,
+    uint32_t vertexCount, size_t targetIndexCount, float targetError, float* resultError = nullptr);
+
+struct MeshLod
+{
+    uint32_t FirstIndex = 0;
+    uint32_t IndexCount = 0;
+    float Error = 0.0f;                 // Object-space, 0 for the full mesh
+};
+
+struct MeshLodChain
+{
+    std::vector<uint32_t> Indices;      // Every level back to back, the full mesh first
+    std::vector<MeshLod> Lods;
+    Float3 Center = { 0.0f, 0.0f, 0.0f };   // Bounding sphere of the referenced vertices
+    float Radius = 0.0f;
+
+    uint32_t GetTriangleCount(uint32_t lod) const { return Lods[lod].IndexCount / 3; }
+};
+
+struct LodChainOptions
+{
+    // Error limit of each level after the full mesh, relative to the bounding radius
+    std::vector<float> Errors = { 0.002f, 0.006f, 0.02f, 0.06f };
+    // A level is dropped unless it has at most this fraction of the previous level's triangles
+    float MaxTriangleRatio = 0.7f;
+};
+
+// Level i + 1 is simplified from level i, which is faster than starting from the full mesh
+// every time; its Error adds up the largest collapse cost of every level up to it
+void BuildLodChain(const MeshData& mesh, const LodChainOptions& options, MeshLodChain* chain);
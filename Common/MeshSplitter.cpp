@@ -0,0 +1,93 @@
+#include "MeshSplitter.h"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+namespace
+{
+    constexpr uint32_t InvalidIndex = std::numeric_limits<uint32_t>::max();
+}
+
+uint32_t SplitMesh(const MeshData& mesh, uint32_t maxChunkVertices, MeshData* output,
+    std::vector<MeshSubmesh>* submeshes)
+{
+    maxChunkVertices = std::max(maxChunkVertices, 3u);
+    size_t triangleCount = mesh.Indices.size() / 3;
+    output->Vertices.clear();
+    output->Vertices.reserve(mesh.Vertices.size());
+    output->Indices.resize(triangleCount * 3);
+    submeshes->clear();
+
+    // The chunk that last copied each vertex and where that copy went
+    std::vector<uint32_t> chunkOf(mesh.Vertices.size(), InvalidIndex);
+    std::vector<uint32_t> copyOf(mesh.Vertices.size());
+    uint32_t chunk = 0;
+    uint32_t chunkFirstVertex = 0;
+    uint32_t chunkFirstIndex = 0;
+    uint32_t referencedVertices = 0;
+    for (size_t t = 0; t < triangleCount; ++t)
+    {
+        const uint32_t* triangle = mesh.Indices.data() + t * 3;
+        // Vertices the triangle adds to the chunk, each counted once
+        uint32_t added = (chunkOf[triangle[0]] != chunk) +
+            (chunkOf[triangle[1]] != chunk && triangle[1] != triangle[0]) +
+            (chunkOf[triangle[2]] != chunk && triangle[2] != triangle[0] && triangle[2] != triangle[1]);
+        uint32_t chunkVertices = static_cast<uint32_t>(output->Vertices.size()) - chunkFirstVertex;
+        if (chunkVertices + added > maxChunkVertices)
+        {
+            uint32_t firstIndex = static_cast<uint32_t>(t * 3);
+            submeshes->push_back({ chunkFirstIndex, firstIndex - chunkFirstIndex, 0 });
+            ++chunk;
+            chunkFirstVertex = static_cast<uint32_t>(output->Vertices.size());
+            chunkFirstIndex = firstIndex;
+        }
+
+        for (int k = 0; k < 3; ++k)
+        {
+            uint32_t vertex = triangle[k];
+            if (chunkOf[vertex] != chunk)
+            {
+                referencedVertices += chunkOf[vertex] == InvalidIndex;
+                chunkOf[vertex] = chunk;
+                copyOf[vertex] = static_cast<uint32_t>(output->Vertices.size());
+                output->Vertices.push_back(mesh.Vertices[vertex]);
+            }
+            output->Indices[t * 3 + k] = copyOf[vertex];
+        }
+    }
+    if (triangleCount > 0)
+        submeshes->push_back({ chunkFirstIndex, static_cast<uint32_t>(triangleCount * 3) - chunkFirstIndex, 0 });
+
+    return static_cast<uint32_t>(output->Vertices.size()) - referencedVertices;
+}
+
+bool SplitMeshForIndex16(MeshData* mesh, std::vector<MeshSubmesh>* submeshes, const MeshSplitOptions& options,
+    MeshSplitStats* stats)
+{
+    submeshes->clear();
+    MeshSplitStats result;
+    result.Chunks = 1;
+    result.BytesBefore = uint64_t(mesh->Vertices.size()) * options.VertexStride + mesh->Indices.size() * 4;
+    result.BytesAfter = result.BytesBefore;
+    if (mesh->Vertices.size() <= options.MaxChunkVertices)
+    {
+        if (stats)
+            *stats = result;
+        return false;
+    }
+
+    MeshData split;
+    std::vector<MeshSubmesh> chunks;
+    result.DuplicatedVertices = SplitMesh(*mesh, options.MaxChunkVertices, &split, &chunks);
+    result.Chunks = static_cast<uint32_t>(chunks.size());
+    result.BytesAfter = uint64_t(split.Vertices.size()) * options.VertexStride + split.Indices.size() * 2;
+    if (stats)
+        *stats = result;
+    if (result.BytesAfter >= result.BytesBefore && !options.Force)
+        return false;
+
+    *mesh = std::move(split);
+    *submeshes = std::move(chunks);
+    return true;
+}
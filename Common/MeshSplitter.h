@@ -0,0 +1,52 @@
+#pragma once
+
+// Cuts meshes with more vertices than 16-bit indices address into chunks that
+// each fit them, for WriteMeshFile to store as 16-bit submeshes. Every chunk
+// gets a contiguous copy of the vertices it references and is drawn with
+// BaseVertex = its first vertex, so the index stream is half the size of a
+// 32-bit one. The price is the vertices that neighbouring chunks share, which
+// are stored once per chunk; SplitMeshForIndex16 only splits when the halved
+// index stream saves more than those copies cost.
+//
+// Triangles keep their order, so run the splitter after OptimizeMesh: the
+// cache order survives, and with the vertices already in first-use order the
+// chunks share only the vertices along their borders.
+//
+// Triangle lists have no strip cut value, so 0xFFFF is an ordinary index and
+// a chunk holds the full 65536 vertices.
+
+#include <cstdint>
+#include <vector>
+
+#include "MeshFile.h"
+#include "MeshImporter.h"
+
+struct MeshSplitOptions
+{
+    uint32_t MaxChunkVertices = 0x10000;    // At least 3
+    uint32_t VertexStride = sizeof(Vertex); // Of the vertex format the mesh will be written in
+    bool Force = false;                     // Split even when it does not save bytes
+};
+
+struct MeshSplitStats
+{
+    uint32_t Chunks = 0;
+    uint32_t DuplicatedVertices = 0;        // Copies beyond the first of vertices shared by chunks
+    uint64_t BytesBefore = 0;               // Vertices and 32-bit indices
+    uint64_t BytesAfter = 0;                // Split vertices and 16-bit indices
+};
+
+// Splits the triangles of mesh greedily in their order: a chunk ends before the triangle
+// that would take it past maxChunkVertices distinct vertices. output receives the chunks'
+// vertices back to back and indices that already include each chunk's first vertex;
+// submeshes receives one FirstIndex / IndexCount range per chunk. Unreferenced vertices
+// are dropped. output must not be mesh. Returns the number of duplicated vertices.
+uint32_t SplitMesh(const MeshData& mesh, uint32_t maxChunkVertices, MeshData* output,
+    std::vector<MeshSubmesh>* submeshes);
+
+// Replaces mesh with its split and fills submeshes when the mesh has more vertices than
+// options.MaxChunkVertices and splitting saves bytes (or options.Force is set). Otherwise
+// returns false and leaves mesh alone; submeshes is cleared, meaning one submesh that
+// WriteMeshFile gives 16-bit indices if the mesh fits them and 32-bit ones if not.
+bool SplitMeshForIndex16(MeshData* mesh, std::vector<MeshSubmesh>* submeshes, const MeshSplitOptions& options = {},
+    MeshSplitStats* stats = nullptr);
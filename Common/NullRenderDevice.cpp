@@ -0,0 +1,13 @@
+#include "NullRenderDevice.h"
+
+NullRenderDevice::NullRenderDevice(uint32_t width, uint32_t height)
+    : m_Context(*this)
+{
+    Resize(width, height);
+}
+
+bool NullRenderDevice::Present()
+{
+    m_Context.EndFrame();
+    return true;
+}
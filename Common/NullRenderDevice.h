@@ -0,0 +1,21 @@
+#pragma once
+
+// Backend that validates and counts every call but never rasterizes.
+// It isolates the CPU cost of a scene's update and submission code, which is
+// what the headless benchmarks measure.
+
+#include "CpuRenderDevice.h"
+
+class NullRenderDevice final : public CpuRenderDevice
+{
+public:
+    NullRenderDevice(uint32_t width, uint32_t height);
+
+    const char* GetName() const override { return "null"; }
+
+    RenderContext& GetImmediateContext() override { return m_Context; }
+    bool Present() override;
+
+private:
+    CpuRenderContext m_Context;
+};
@@ -0,0 +1,565 @@
+#include "OcclusionCulling.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include "JobSystem.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define OCCLUSION_CULLING_AVX2 1
+#endif
+
+namespace
+{
+    // Candidates per job when boxes are tested in parallel
+    constexpr size_t ChunkSize = 4096;
+
+    // Triangles further out than this many viewports are clipped, keeping edge functions precise
+    constexpr float GuardBand = 4.0f;
+
+    // Vertices are snapped to 1/16 of a pixel like SoftwareRasterizer's 28.4 fixed point, so a center
+    // on an edge is decided the same way; D3D's grid is finer
+    constexpr float SubPixelScale = 16.0f;
+
+    constexpr float Infinity = std::numeric_limits<float>::infinity();
+
+    // Signed distance to a clip plane: >= 0 is inside
+    float PlaneDistance(const Float4& p, int plane)
+    {
+        switch (plane)
+        {
+        case 0: return p.z;                    // near: z >= 0
+        case 1: return p.w - p.z;              // far: z <= w
+        case 2: return GuardBand * p.w + p.x;  // left
+        case 3: return GuardBand * p.w - p.x;  // right
+        case 4: return GuardBand * p.w + p.y;  // bottom
+        default: return GuardBand * p.w - p.y; // top
+        }
+    }
+
+    Float4 Lerp(const Float4& a, const Float4& b, float t)
+    {
+        return { a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t, a.z + (b.z - a.z) * t, a.w + (b.w - a.w) * t };
+    }
+
+    // Sutherland-Hodgman against one plane; returns the new vertex count
+    int ClipPolygon(const Float4* in, int count, Float4* out, int plane)
+    {
+        int outCount = 0;
+        for (int i = 0; i < count; ++i)
+        {
+            const Float4& current = in[i];
+            const Float4& next = in[(i + 1) % count];
+            float dCurrent = PlaneDistance(current, plane);
+            float dNext = PlaneDistance(next, plane);
+            if (dCurrent >= 0.0f)
+                out[outCount++] = current;
+            if ((dCurrent >= 0.0f) != (dNext >= 0.0f))
+                out[outCount++] = Lerp(current, next, dCurrent / (dCurrent - dNext));
+        }
+        return outCount;
+    }
+}
+
+OcclusionBuffer::OcclusionBuffer(int width, int height)
+{
+    Resize(width, height);
+}
+
+void OcclusionBuffer::Resize(int width, int height)
+{
+    m_TilesX = (std::max(1, width) + TileSize - 1) / TileSize;
+    m_TilesY = (std::max(1, height) + TileSize - 1) / TileSize;
+    m_Width = m_TilesX * TileSize;
+    m_Height = m_TilesY * TileSize;
+    m_Depth.assign(static_cast<size_t>(m_Width) * m_Height, 1.0f);
+    m_BlockMaxDepth.assign(static_cast<size_t>(m_Width / BlockSize) * (m_Height / BlockSize), 1.0f);
+    m_Chunks.clear();
+}
+
+void OcclusionBuffer::Begin(const Float4x4& viewProjection)
+{
+    m_ViewProjection = viewProjection;
+    m_Occluders.clear();
+    m_TotalTriangles = 0;
+}
+
+void OcclusionBuffer::AddOccluder(const Float3* positions, uint32_t stride, uint32_t vertexCount,
+    const uint16_t* indices, uint32_t indexCount, const Float4x4& world)
+{
+    RecordOccluder(positions, stride, vertexCount, indices, nullptr, indexCount, world);
+}
+
+void OcclusionBuffer::AddOccluder(const Float3* positions, uint32_t stride, uint32_t vertexCount,
+    const uint32_t* indices, uint32_t indexCount, const Float4x4& world)
+{
+    RecordOccluder(positions, stride, vertexCount, nullptr, indices, indexCount, world);
+}
+
+void OcclusionBuffer::RecordOccluder(const Float3* positions, uint32_t stride, uint32_t vertexCount,
+    const uint16_t* indices16, const uint32_t* indices32, uint32_t indexCount, const Float4x4& world)
+{
+    if (vertexCount == 0 || indexCount < 3)
+        return;
+
+    Occluder occluder;
+    occluder.Positions = reinterpret_cast<const uint8_t*>(positions);
+    occluder.Stride = stride;
+    occluder.VertexCount = vertexCount;
+    occluder.Indices16 = indices16;
+    occluder.Indices32 = indices32;
+    occluder.TriangleCount = indexCount / 3;
+    occluder.FirstTriangle = m_TotalTriangles;
+    occluder.WorldViewProjection = world * m_ViewProjection;
+    m_Occluders.push_back(occluder);
+    m_TotalTriangles += occluder.TriangleCount;
+}
+
+void OcclusionBuffer::Rasterize(JobSystem* jobSystem)
+{
+    unsigned int workers = jobSystem ? jobSystem->GetWorkerCount() : 1;
+    size_t chunkCount = std::max<size_t>(1, std::min<size_t>(workers * 4, (m_TotalTriangles + 63) / 64));
+    size_t tileCount = static_cast<size_t>(m_TilesX) * m_TilesY;
+    if (m_Chunks.size() < chunkCount)
+        m_Chunks.resize(chunkCount);
+    for (BinChunk& chunk : m_Chunks)
+    {
+        chunk.Triangles.clear();
+        chunk.TileBins.resize(tileCount);
+        for (std::vector<uint32_t>& bin : chunk.TileBins)
+            bin.clear();
+    }
+
+    // Each chunk sets up a contiguous range of triangles
+    size_t trianglesPerChunk = (m_TotalTriangles + chunkCount - 1) / chunkCount;
+    auto setupChunks = [&](size_t begin, size_t end, unsigned int)
+    {
+        for (size_t chunkIndex = begin; chunkIndex < end; ++chunkIndex)
+        {
+            uint32_t first = static_cast<uint32_t>(chunkIndex * trianglesPerChunk);
+            uint32_t last = static_cast<uint32_t>(std::min<size_t>(first + trianglesPerChunk, m_TotalTriangles));
+            if (first >= last)
+                continue;
+
+            auto occluder = std::upper_bound(m_Occluders.begin(), m_Occluders.end(), first,
+                [](uint32_t triangle, const Occluder& o) { return triangle < o.FirstTriangle; }) - 1;
+            for (uint32_t triangle = first; triangle < last; ++triangle)
+            {
+                while (triangle >= occluder->FirstTriangle + occluder->TriangleCount)
+                    ++occluder;
+
+                size_t firstIndex = size_t(triangle - occluder->FirstTriangle) * 3;
+                Float4 clip[3];
+                bool valid = true;
+                for (int k = 0; k < 3; ++k)
+                {
+                    uint32_t index = occluder->Indices32 ? occluder->Indices32[firstIndex + k] :
+                        occluder->Indices16[firstIndex + k];
+                    valid = valid && index < occluder->VertexCount;
+                    if (valid)
+                    {
+                        const Float3* position = reinterpret_cast<const Float3*>(occluder->Positions +
+                            size_t(index) * occluder->Stride);
+                        clip[k] = Vector3Transform(*position, occluder->WorldViewProjection);
+                    }
+                }
+                if (valid)
+                    SetupAndBin(clip, m_Chunks[chunkIndex]);
+            }
+        }
+    };
+    if (jobSystem)
+        jobSystem->ParallelFor(chunkCount, 1, setupChunks);
+    else
+        setupChunks(0, chunkCount, 0);
+
+    for (size_t i = 0; i < chunkCount; ++i)
+        m_TrianglesRasterized += m_Chunks[i].Triangles.size();
+
+    // Tiles own their pixels and blocks, so they are drawn independently
+    if (jobSystem)
+    {
+        jobSystem->ParallelFor(tileCount, 1, [this](size_t begin, size_t end, unsigned int)
+        {
+            for (size_t tile = begin; tile < end; ++tile)
+                RasterizeTile(static_cast<int>(tile));
+        });
+    }
+    else
+    {
+        for (size_t tile = 0; tile < tileCount; ++tile)
+            RasterizeTile(static_cast<int>(tile));
+    }
+}
+
+void OcclusionBuffer::SetupAndBin(const Float4 clip[3], BinChunk& chunk)
+{
+    // Trivial reject when every vertex is outside the same plane
+    bool needsClip = false;
+    for (int plane = 0; plane < 6; ++plane)
+    {
+        int outside = (PlaneDistance(clip[0], plane) < 0.0f) + (PlaneDistance(clip[1], plane) < 0.0f) +
+            (PlaneDistance(clip[2], plane) < 0.0f);
+        if (outside == 3)
+            return;
+        needsClip |= outside > 0;
+    }
+
+    Float4 bufferA[9] = { clip[0], clip[1], clip[2] };
+    Float4 bufferB[9];
+    Float4* polygon = bufferA;
+    int count = 3;
+    if (needsClip)
+    {
+        Float4* scratch = bufferB;
+        for (int plane = 0; plane < 6 && count >= 3; ++plane)
+        {
+            count = ClipPolygon(polygon, count, scratch, plane);
+            std::swap(polygon, scratch);
+        }
+        if (count < 3)
+            return;
+    }
+
+    float screenX[9];
+    float screenY[9];
+    float screenZ[9];
+    for (int i = 0; i < count; ++i)
+    {
+        float invW = 1.0f / polygon[i].w;
+        screenX[i] = std::floor((polygon[i].x * invW + 1.0f) * 0.5f * m_Width * SubPixelScale + 0.5f) / SubPixelScale;
+        screenY[i] = std::floor((1.0f - polygon[i].y * invW) * 0.5f * m_Height * SubPixelScale + 0.5f) / SubPixelScale;
+        screenZ[i] = polygon[i].z * invW;
+    }
+
+    for (int i = 1; i + 1 < count; ++i)
+    {
+        int ids[3] = { 0, i, i + 1 };
+        float area = (screenX[ids[1]] - screenX[ids[0]]) * (screenY[ids[2]] - screenY[ids[0]]) -
+            (screenX[ids[2]] - screenX[ids[0]]) * (screenY[ids[1]] - screenY[ids[0]]);
+        if (area == 0.0f)
+            continue;
+
+        // Occluders are two-sided: either winding is made positive inside
+        if (area < 0.0f)
+        {
+            std::swap(ids[1], ids[2]);
+            area = -area;
+        }
+
+        // Centers of the pixels the triangle can cover, clamped to the buffer
+        float minX = std::min({ screenX[ids[0]], screenX[ids[1]], screenX[ids[2]] });
+        float maxX = std::max({ screenX[ids[0]], screenX[ids[1]], screenX[ids[2]] });
+        float minY = std::min({ screenY[ids[0]], screenY[ids[1]], screenY[ids[2]] });
+        float maxY = std::max({ screenY[ids[0]], screenY[ids[1]], screenY[ids[2]] });
+        SetupTriangle tri;
+        tri.MinX = std::max(0, static_cast<int>(std::ceil(minX - 0.5f)));
+        tri.MinY = std::max(0, static_cast<int>(std::ceil(minY - 0.5f)));
+        tri.MaxX = std::min(m_Width - 1, static_cast<int>(std::floor(maxX - 0.5f)));
+        tri.MaxY = std::min(m_Height - 1, static_cast<int>(std::floor(maxY - 0.5f)));
+        if (tri.MinX > tri.MaxX || tri.MinY > tri.MaxY)
+            continue;
+
+        // Edge i is opposite vertex i; it equals the area at that vertex
+        float invArea = 1.0f / area;
+        float depthA = 0.0f, depthB = 0.0f, depthC = 0.0f;
+        for (int edge = 0; edge < 3; ++edge)
+        {
+            int a = ids[(edge + 1) % 3];
+            int b = ids[(edge + 2) % 3];
+            tri.EdgeA[edge] = screenY[a] - screenY[b];
+            tri.EdgeB[edge] = screenX[b] - screenX[a];
+            tri.EdgeC[edge] = -(tri.EdgeA[edge] * screenX[a] + tri.EdgeB[edge] * screenY[a]);
+            // Top-left fill convention: centers on other edges belong to the neighbouring triangle
+            bool topLeft = tri.EdgeA[edge] > 0.0f || (tri.EdgeA[edge] == 0.0f && tri.EdgeB[edge] > 0.0f);
+            tri.EdgeMin[edge] = topLeft ? 0.0f : std::numeric_limits<float>::denorm_min();
+            float z = screenZ[ids[edge]] * invArea;
+            depthA += tri.EdgeA[edge] * z;
+            depthB += tri.EdgeB[edge] * z;
+            depthC += tri.EdgeC[edge] * z;
+        }
+        tri.DepthA = depthA;
+        tri.DepthB = depthB;
+        tri.DepthC = depthC;
+
+        uint32_t triangleIndex = static_cast<uint32_t>(chunk.Triangles.size());
+        chunk.Triangles.push_back(tri);
+        for (int ty = tri.MinY / TileSize; ty <= tri.MaxY / TileSize; ++ty)
+        {
+            for (int tx = tri.MinX / TileSize; tx <= tri.MaxX / TileSize; ++tx)
+                chunk.TileBins[static_cast<size_t>(ty) * m_TilesX + tx].push_back(triangleIndex);
+        }
+    }
+}
+
+void OcclusionBuffer::RasterizeTile(int tile)
+{
+    int tileMinX = (tile % m_TilesX) * TileSize;
+    int tileMinY = (tile / m_TilesX) * TileSize;
+    int tileMaxX = tileMinX + TileSize - 1;
+    int tileMaxY = tileMinY + TileSize - 1;
+    for (int y = tileMinY; y <= tileMaxY; ++y)
+    {
+        float* row = m_Depth.data() + static_cast<size_t>(y) * m_Width;
+        std::fill(row + tileMinX, row + tileMaxX + 1, 1.0f);
+    }
+
+    for (const BinChunk& chunk : m_Chunks)
+    {
+        if (chunk.TileBins.size() <= static_cast<size_t>(tile))
+            continue;
+
+        for (uint32_t triangleIndex : chunk.TileBins[tile])
+        {
+            const SetupTriangle& tri = chunk.Triangles[triangleIndex];
+            RasterizeTriangle(tri, std::max(tileMinX, tri.MinX), std::max(tileMinY, tri.MinY),
+                std::min(tileMaxX, tri.MaxX), std::min(tileMaxY, tri.MaxY));
+        }
+    }
+
+    // Farthest depth of each block of the tile
+    int blocksPerRow = m_Width / BlockSize;
+    for (int blockY = tileMinY / BlockSize; blockY <= tileMaxY / BlockSize; ++blockY)
+    {
+        for (int blockX = tileMinX / BlockSize; blockX <= tileMaxX / BlockSize; ++blockX)
+        {
+            float farthest = 0.0f;
+            for (int y = blockY * BlockSize; y < (blockY + 1) * BlockSize; ++y)
+            {
+                const float* row = m_Depth.data() + static_cast<size_t>(y) * m_Width + blockX * BlockSize;
+                farthest = std::max(farthest, *std::max_element(row, row + BlockSize));
+            }
+            m_BlockMaxDepth[static_cast<size_t>(blockY) * blocksPerRow + blockX] = farthest;
+        }
+    }
+}
+
+void OcclusionBuffer::RasterizeTriangle(const SetupTriangle& tri, int minX, int minY, int maxX, int maxY)
+{
+#if defined(OCCLUSION_CULLING_AVX2)
+    // Whole groups of 8 pixels; centers outside the triangle fail the edge test
+    const __m256 laneX = _mm256_setr_ps(0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f);
+    const __m256 edgeMin[3] = { _mm256_set1_ps(tri.EdgeMin[0]), _mm256_set1_ps(tri.EdgeMin[1]),
+        _mm256_set1_ps(tri.EdgeMin[2]) };
+    int firstX = minX & ~7;
+    for (int y = minY; y <= maxY; ++y)
+    {
+        float centerY = static_cast<float>(y) + 0.5f;
+        __m256 rows[4];
+        for (int edge = 0; edge < 3; ++edge)
+            rows[edge] = _mm256_set1_ps(tri.EdgeB[edge] * centerY + tri.EdgeC[edge]);
+        rows[3] = _mm256_set1_ps(tri.DepthB * centerY + tri.DepthC);
+
+        float* row = m_Depth.data() + static_cast<size_t>(y) * m_Width;
+        for (int x = firstX; x <= maxX; x += 8)
+        {
+            __m256 centerX = _mm256_add_ps(_mm256_set1_ps(static_cast<float>(x)), laneX);
+            __m256 e0 = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(tri.EdgeA[0]), centerX), rows[0]);
+            __m256 e1 = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(tri.EdgeA[1]), centerX), rows[1]);
+            __m256 e2 = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(tri.EdgeA[2]), centerX), rows[2]);
+            __m256 inside = _mm256_and_ps(_mm256_and_ps(_mm256_cmp_ps(e0, edgeMin[0], _CMP_GE_OQ),
+                _mm256_cmp_ps(e1, edgeMin[1], _CMP_GE_OQ)), _mm256_cmp_ps(e2, edgeMin[2], _CMP_GE_OQ));
+            __m256 depth = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(tri.DepthA), centerX), rows[3]);
+            __m256 old = _mm256_loadu_ps(row + x);
+            _mm256_storeu_ps(row + x, _mm256_blendv_ps(old, _mm256_min_ps(old, depth), inside));
+        }
+    }
+#else
+    for (int y = minY; y <= maxY; ++y)
+    {
+        float centerY = static_cast<float>(y) + 0.5f;
+        float rows[4];
+        for (int edge = 0; edge < 3; ++edge)
+            rows[edge] = tri.EdgeB[edge] * centerY + tri.EdgeC[edge];
+        rows[3] = tri.DepthB * centerY + tri.DepthC;
+
+        float* row = m_Depth.data() + static_cast<size_t>(y) * m_Width;
+        for (int x = minX; x <= maxX; ++x)
+        {
+            float centerX = static_cast<float>(x) + 0.5f;
+            bool inside = tri.EdgeA[0] * centerX + rows[0] >= tri.EdgeMin[0] &&
+                tri.EdgeA[1] * centerX + rows[1] >= tri.EdgeMin[1] &&
+                tri.EdgeA[2] * centerX + rows[2] >= tri.EdgeMin[2];
+            float depth = tri.DepthA * centerX + rows[3];
+            if (inside)
+                row[x] = std::min(row[x], depth);
+        }
+    }
+#endif
+}
+
+bool OcclusionBuffer::IsVisible(const Float3& center, const Float3& extents) const
+{
+    // Corners in clip space from the center and the three scaled axes
+    const Float4x4& m = m_ViewProjection;
+    Float4 c = Vector3Transform(center, m);
+    Float4 axes[3];
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        float e = axis == 0 ? extents.x : axis == 1 ? extents.y : extents.z;
+        axes[axis] = { m.m[axis][0] * e, m.m[axis][1] * e, m.m[axis][2] * e, m.m[axis][3] * e };
+    }
+
+    float minX = Infinity, minY = Infinity, maxX = -Infinity, maxY = -Infinity, nearest = Infinity;
+    int behind = 0;
+    for (int corner = 0; corner < 8; ++corner)
+    {
+        Float4 p = c;
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            float sign = corner & (1 << axis) ? 1.0f : -1.0f;
+            p = { p.x + sign * axes[axis].x, p.y + sign * axes[axis].y, p.z + sign * axes[axis].z,
+                p.w + sign * axes[axis].w };
+        }
+
+        // Corners in front of the near plane do not project; they are dealt with below
+        if (p.z < 0.0f)
+        {
+            ++behind;
+            continue;
+        }
+
+        float invW = 1.0f / p.w;
+        float x = (p.x * invW * 0.5f + 0.5f) * m_Width;
+        float y = (0.5f - p.y * invW * 0.5f) * m_Height;
+        minX = std::min(minX, x);
+        maxX = std::max(maxX, x);
+        minY = std::min(minY, y);
+        maxY = std::max(maxY, y);
+        nearest = std::min(nearest, p.z * invW);
+    }
+
+    // A box wholly nearer than the near plane is not drawn, one reaching through it may cover anything
+    if (behind > 0)
+        return behind < 8;
+
+    // Every pixel the screen rectangle touches
+    if (maxX < 0.0f || maxY < 0.0f || minX >= m_Width || minY >= m_Height)
+        return false;
+    int x0 = std::max(0, static_cast<int>(minX));
+    int y0 = std::max(0, static_cast<int>(minY));
+    int x1 = std::min(m_Width - 1, static_cast<int>(maxX));
+    int y1 = std::min(m_Height - 1, static_cast<int>(maxY));
+
+    int blocksPerRow = m_Width / BlockSize;
+    for (int blockY = y0 / BlockSize; blockY <= y1 / BlockSize; ++blockY)
+    {
+        for (int blockX = x0 / BlockSize; blockX <= x1 / BlockSize; ++blockX)
+        {
+            // Every occluder in the block is nearer than the box
+            if (m_BlockMaxDepth[static_cast<size_t>(blockY) * blocksPerRow + blockX] < nearest)
+                continue;
+
+            int firstX = blockX * BlockSize;
+            int rowBegin = std::max(y0, blockY * BlockSize);
+            int rowEnd = std::min(y1, blockY * BlockSize + BlockSize - 1);
+#if defined(OCCLUSION_CULLING_AVX2)
+            // Lanes of the block inside [x0, x1]
+            int lanes = ((1 << (std::min(x1 - firstX, 7) + 1)) - 1) & ~((1 << std::max(x0 - firstX, 0)) - 1);
+            __m256 boxDepth = _mm256_set1_ps(nearest);
+            for (int y = rowBegin; y <= rowEnd; ++y)
+            {
+                __m256 depth = _mm256_loadu_ps(m_Depth.data() + static_cast<size_t>(y) * m_Width + firstX);
+                if (_mm256_movemask_ps(_mm256_cmp_ps(depth, boxDepth, _CMP_GE_OQ)) & lanes)
+                    return true;
+            }
+#else
+            int columnBegin = std::max(x0, firstX);
+            int columnEnd = std::min(x1, firstX + BlockSize - 1);
+            for (int y = rowBegin; y <= rowEnd; ++y)
+            {
+                const float* row = m_Depth.data() + static_cast<size_t>(y) * m_Width;
+                for (int x = columnBegin; x <= columnEnd; ++x)
+                {
+                    if (row[x] >= nearest)
+                        return true;
+                }
+            }
+#endif
+        }
+    }
+    return false;
+}
+
+size_t OcclusionBuffer::Cull(JobSystem* jobSystem, const BoundsArray& bounds, const uint32_t* candidates,
+    size_t count)
+{
+    m_Visible.resize(count);
+    auto cullRange = [&](size_t begin, size_t end)
+    {
+        size_t visible = 0;
+        for (size_t i = begin; i < end; ++i)
+        {
+            uint32_t object = candidates[i];
+            m_Visible[begin + visible] = object;
+            visible += IsVisible(bounds.GetCenter(object), bounds.GetExtents(object));
+        }
+        return visible;
+    };
+
+    size_t chunkCount = (count + ChunkSize - 1) / ChunkSize;
+    if (!jobSystem || chunkCount <= 1)
+    {
+        m_VisibleCount = cullRange(0, count);
+        return m_VisibleCount;
+    }
+
+    m_ChunkCounts.resize(chunkCount);
+    jobSystem->ParallelFor(chunkCount, 1, [&](size_t first, size_t last, unsigned int)
+    {
+        for (size_t chunk = first; chunk < last; ++chunk)
+            m_ChunkCounts[chunk] = cullRange(chunk * ChunkSize, std::min(count, (chunk + 1) * ChunkSize));
+    });
+
+    // Chunk c's indices start at c * ChunkSize; close the gaps in order
+    m_VisibleCount = 0;
+    for (size_t chunk = 0; chunk < chunkCount; ++chunk)
+    {
+        if (m_VisibleCount != chunk * ChunkSize)
+        {
+            std::memmove(m_Visible.data() + m_VisibleCount, m_Visible.data() + chunk * ChunkSize,
+                m_ChunkCounts[chunk] * sizeof(uint32_t));
+        }
+        m_VisibleCount += m_ChunkCounts[chunk];
+    }
+    return m_VisibleCount;
+}
+
+void SelectOccluders(const BoundsArray& bounds, const uint32_t* candidates, size_t count, const Float3& eye,
+    size_t maxOccluders, std::vector<uint32_t>* occluders)
+{
+    struct Scored
+    {
+        float Score;
+        uint32_t Object;
+    };
+    std::vector<Scored> scored(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        Float3 e = bounds.GetExtents(candidates[i]);
+        Float3 toCenter = Vector3Subtract(bounds.GetCenter(candidates[i]), eye);
+        float face = std::max({ e.x * e.y, e.y * e.z, e.z * e.x });
+        scored[i] = { face / std::max(Vector3Dot(toCenter, toCenter), 1e-6f), candidates[i] };
+    }
+
+    size_t selected = std::min(maxOccluders, count);
+    std::partial_sort(scored.begin(), scored.begin() + selected, scored.end(), [](const Scored& a, const Scored& b)
+    {
+        return a.Score > b.Score;
+    });
+    occluders->resize(selected);
+    for (size_t i = 0; i < selected; ++i)
+        (*occluders)[i] = scored[i].Object;
+}
+
+const char* GetOcclusionCullingInstructionSet()
+{
+#if defined(OCCLUSION_CULLING_AVX2)
+    return "avx2";
+#else
+    return "scalar";
+#endif
+}
@@ -0,0 +1,135 @@
+#pragma once
+
+// CPU occlusion culling. A few large occluders are rasterized into a small
+// depth buffer (256x128 by default) and object boxes are tested against it
+// before they are drawn, so objects hidden behind them cost neither vertex
+// work nor a draw call. "07. Depth"'s depth test only rejects their pixels.
+//
+// The buffer keeps the nearest occluder depth of each pixel (D3D depth, 0 at
+// the near plane), sampled at pixel centers with D3D's top-left fill rule and
+// SoftwareRasterizer's 1/16 pixel vertex snapping, plus the farthest of those depths
+// per 8x8 block. A box whose nearest depth is behind a block's farthest depth
+// is hidden in that block without reading its pixels. Occluders are drawn
+// two-sided, 8 pixels per step with AVX2 or one at a time without it, and the
+// 32x32 tiles of the buffer are rasterized in parallel on a JobSystem.
+//
+// Tests are made at the buffer's resolution: a box is hidden when every pixel
+// it touches has an occluder in front of it.
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "FrustumCulling.h"
+#include "MathUtil.h"
+
+class JobSystem;
+
+class OcclusionBuffer
+{
+public:
+    static constexpr int DefaultWidth = 256;
+    static constexpr int DefaultHeight = 128;
+    static constexpr int TileSize = 32;
+    static constexpr int BlockSize = 8;
+
+    explicit OcclusionBuffer(int width = DefaultWidth, int height = DefaultHeight);
+
+    // Sizes are rounded up to whole tiles; the buffer always covers the whole viewport
+    void Resize(int width, int height);
+
+    int GetWidth() const { return m_Width; }
+    int GetHeight() const { return m_Height; }
+
+    // Starts a frame seen through viewProjection: drops the occluders of the previous one
+    void Begin(const Float4x4& viewProjection);
+
+    // Records a triangle list in world space, positions being stride bytes apart (Vertex data
+    // works with sizeof(Vertex)); the arrays must stay alive until Rasterize
+    void AddOccluder(const Float3* positions, uint32_t stride, uint32_t vertexCount, const uint16_t* indices,
+        uint32_t indexCount, const Float4x4& world);
+    void AddOccluder(const Float3* positions, uint32_t stride, uint32_t vertexCount, const uint32_t* indices,
+        uint32_t indexCount, const Float4x4& world);
+
+    // Clears the depth and draws the recorded occluders; jobSystem may be null
+    void Rasterize(JobSystem* jobSystem);
+
+    // False when the box is off screen or behind the occluders at every pixel it touches
+    bool IsVisible(const Float3& center, const Float3& extents) const;
+
+    // Keeps the candidates whose boxes in bounds are visible, in order; returns how many
+    size_t Cull(JobSystem* jobSystem, const BoundsArray& bounds, const uint32_t* candidates, size_t count);
+
+    const uint32_t* GetVisible() const { return m_Visible.data(); }
+    size_t GetVisibleCount() const { return m_VisibleCount; }
+
+    // Nearest occluder depth of each pixel, row-major; 1 where no occluder covers the center
+    const float* GetDepth() const { return m_Depth.data(); }
+    // Farthest depth of each BlockSize x BlockSize block, GetWidth() / BlockSize blocks per row
+    const float* GetBlockMaxDepth() const { return m_BlockMaxDepth.data(); }
+
+    uint64_t GetTrianglesRasterized() const { return m_TrianglesRasterized; }
+
+private:
+    struct Occluder
+    {
+        const uint8_t* Positions;
+        uint32_t Stride;
+        uint32_t VertexCount;
+        // One of the two is set, by the index format
+        const uint16_t* Indices16;
+        const uint32_t* Indices32;
+        uint32_t TriangleCount;
+        uint32_t FirstTriangle;
+        Float4x4 WorldViewProjection;
+    };
+
+    // Edge functions A * x + B * y + C, >= EdgeMin inside, and the depth plane, in pixels
+    struct SetupTriangle
+    {
+        float EdgeA[3];
+        float EdgeB[3];
+        float EdgeC[3];
+        float EdgeMin[3];
+        float DepthA, DepthB, DepthC;
+        int MinX, MinY, MaxX, MaxY;
+    };
+
+    // Triangles set up by one job and the tiles each of them touches
+    struct BinChunk
+    {
+        std::vector<SetupTriangle> Triangles;
+        std::vector<std::vector<uint32_t>> TileBins;
+    };
+
+    void RecordOccluder(const Float3* positions, uint32_t stride, uint32_t vertexCount, const uint16_t* indices16,
+        const uint32_t* indices32, uint32_t indexCount, const Float4x4& world);
+    void SetupAndBin(const Float4 clip[3], BinChunk& chunk);
+    void RasterizeTile(int tile);
+    void RasterizeTriangle(const SetupTriangle& tri, int minX, int minY, int maxX, int maxY);
+
+    int m_Width = 0;
+    int m_Height = 0;
+    int m_TilesX = 0;
+    int m_TilesY = 0;
+    std::vector<float> m_Depth;
+    std::vector<float> m_BlockMaxDepth;
+
+    Float4x4 m_ViewProjection = MatrixIdentity();
+    std::vector<Occluder> m_Occluders;
+    uint32_t m_TotalTriangles = 0;
+    std::vector<BinChunk> m_Chunks;
+    uint64_t m_TrianglesRasterized = 0;
+
+    std::vector<uint32_t> m_Visible;
+    std::vector<size_t> m_ChunkCounts;
+    size_t m_VisibleCount = 0;
+};
+
+// The candidates whose boxes promise to hide the most seen from eye (largest face over squared
+// distance), at most maxOccluders of them, best first
+void SelectOccluders(const BoundsArray& bounds, const uint32_t* candidates, size_t count, const Float3& eye,
+    size_t maxOccluders, std::vector<uint32_t>* occluders);
+
+// "avx2" or "scalar", chosen at compile time
+const char* GetOcclusionCullingInstructionSet();
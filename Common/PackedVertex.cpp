@@ -0,0 +1,292 @@
+#include "PackedVertex.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iterator>
+
+namespace
+{
+    // Smallest half extent used for flat axes, so dequantization never divides by zero
+    constexpr float MinExtent = 1e-6f;
+
+    uint32_t FloatBits(float value)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+    float BitsToFloat(uint32_t bits)
+    {
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    // Position in the bounds as [-1, 1] per axis
+    struct Normalizer
+    {
+        Float3 Center;
+        Float3 InverseExtent;
+
+        explicit Normalizer(const PositionQuantization& quantization)
+            : Center(quantization.Center)
+            , InverseExtent{ 1.0f / quantization.Extent.x, 1.0f / quantization.Extent.y, 1.0f / quantization.Extent.z }
+        {
+        }
+
+        Float3 operator()(const Float3& position) const
+        {
+            return { (position.x - Center.x) * InverseExtent.x, (position.y - Center.y) * InverseExtent.y,
+                (position.z - Center.z) * InverseExtent.z };
+        }
+    };
+
+    void EncodeColor(const Float4& color, uint8_t encoded[4])
+    {
+        encoded[0] = FloatToUnorm8(color.x);
+        encoded[1] = FloatToUnorm8(color.y);
+        encoded[2] = FloatToUnorm8(color.z);
+        encoded[3] = FloatToUnorm8(color.w);
+    }
+
+    void EncodeSnormPosition(const Float3& normalized, int16_t encoded[4])
+    {
+        encoded[0] = FloatToSnorm16(normalized.x);
+        encoded[1] = FloatToSnorm16(normalized.y);
+        encoded[2] = FloatToSnorm16(normalized.z);
+        encoded[3] = 32767;
+    }
+
+    template <typename T>
+    T ReadUnaligned(const uint8_t* data)
+    {
+        T value;
+        std::memcpy(&value, data, sizeof(T));
+        return value;
+    }
+}
+
+uint32_t GetVertexStride(VertexFormat format)
+{
+    switch (format)
+    {
+    case VertexFormat::Float32: return sizeof(Vertex);
+    case VertexFormat::Snorm16: return sizeof(PackedVertex);
+    case VertexFormat::Half16: return sizeof(HalfVertex);
+    default: return 0;
+    }
+}
+
+const InputElementDesc* GetVertexInputLayout(VertexFormat format, uint32_t* count)
+{
+    switch (format)
+    {
+    case VertexFormat::Float32:
+        *count = static_cast<uint32_t>(std::size(VertexInputLayout));
+        return VertexInputLayout;
+    case VertexFormat::Snorm16:
+        *count = static_cast<uint32_t>(std::size(PackedVertexInputLayout));
+        return PackedVertexInputLayout;
+    case VertexFormat::Half16:
+        *count = static_cast<uint32_t>(std::size(HalfVertexInputLayout));
+        return HalfVertexInputLayout;
+    default:
+        *count = 0;
+        return nullptr;
+    }
+}
+
+Float4x4 PositionQuantization::GetDequantizeMatrix() const
+{
+    return MatrixScaling(Extent.x, Extent.y, Extent.z) * MatrixTranslation(Center.x, Center.y, Center.z);
+}
+
+PositionQuantization ComputePositionQuantization(const Vertex* vertices, size_t count)
+{
+    PositionQuantization quantization;
+    if (count == 0)
+        return quantization;
+
+    Float3 minimum = vertices[0].Position;
+    Float3 maximum = vertices[0].Position;
+    for (size_t i = 1; i < count; ++i)
+    {
+        const Float3& position = vertices[i].Position;
+        minimum = { std::min(minimum.x, position.x), std::min(minimum.y, position.y), std::min(minimum.z, position.z) };
+        maximum = { std::max(maximum.x, position.x), std::max(maximum.y, position.y), std::max(maximum.z, position.z) };
+    }
+
+    quantization.Center = { 0.5f * (minimum.x + maximum.x), 0.5f * (minimum.y + maximum.y), 0.5f * (minimum.z + maximum.z) };
+    quantization.Extent = { std::fmax(0.5f * (maximum.x - minimum.x), MinExtent),
+        std::fmax(0.5f * (maximum.y - minimum.y), MinExtent), std::fmax(0.5f * (maximum.z - minimum.z), MinExtent) };
+    return quantization;
+}
+
+uint16_t FloatToHalf(float value)
+{
+    uint32_t bits = FloatBits(value);
+    uint16_t sign = static_cast<uint16_t>((bits >> 16) & 0x8000);
+    uint32_t magnitude = bits & 0x7fffffff;
+
+    // Infinity stays infinity, NaN stays a quiet NaN
+    if (magnitude >= 0x7f800000)
+        return sign | 0x7c00 | (magnitude > 0x7f800000 ? 0x200 : 0);
+
+    // 65520 and above round to infinity
+    if (magnitude >= 0x477ff000)
+        return sign | 0x7c00;
+
+    // Below 2^-14 the result is subnormal: scale so the half's ulp is 1 and round to nearest even
+    if (magnitude < 0x38800000)
+        return sign | static_cast<uint16_t>(std::nearbyint(BitsToFloat(magnitude) * 16777216.0f));
+
+    // Rebias the exponent from 127 to 15, then round the mantissa from 23 to 10 bits, ties to even
+    uint32_t rebiased = magnitude - 0x38000000;
+    rebiased += 0xfff + ((rebiased >> 13) & 1);
+    return sign | static_cast<uint16_t>(rebiased >> 13);
+}
+
+float HalfToFloat(uint16_t value)
+{
+    uint32_t sign = static_cast<uint32_t>(value & 0x8000) << 16;
+    uint32_t exponent = (value >> 10) & 0x1f;
+    uint32_t mantissa = value & 0x3ff;
+
+    if (exponent == 0)
+    {
+        float magnitude = mantissa * (1.0f / 16777216.0f);
+        return sign ? -magnitude : magnitude;
+    }
+    if (exponent == 31)
+        return BitsToFloat(sign | 0x7f800000 | (mantissa << 13));
+    return BitsToFloat(sign | ((exponent + 112) << 23) | (mantissa << 13));
+}
+
+void OctahedralEncode(const Float3& normal, int16_t encoded[2])
+{
+    // Project onto the octahedron |x| + |y| + |z| = 1, then fold the lower half over the diagonals
+    float length = std::fabs(normal.x) + std::fabs(normal.y) + std::fabs(normal.z);
+    if (length == 0.0f)
+    {
+        encoded[0] = 0;
+        encoded[1] = 0;
+        return;
+    }
+
+    float u = normal.x / length;
+    float v = normal.y / length;
+    if (normal.z < 0.0f)
+    {
+        float foldedU = (1.0f - std::fabs(v)) * (u >= 0.0f ? 1.0f : -1.0f);
+        float foldedV = (1.0f - std::fabs(u)) * (v >= 0.0f ? 1.0f : -1.0f);
+        u = foldedU;
+        v = foldedV;
+    }
+    encoded[0] = FloatToSnorm16(u);
+    encoded[1] = FloatToSnorm16(v);
+}
+
+Float3 OctahedralDecode(const int16_t encoded[2])
+{
+    float u = Snorm16ToFloat(encoded[0]);
+    float v = Snorm16ToFloat(encoded[1]);
+    Float3 normal = { u, v, 1.0f - std::fabs(u) - std::fabs(v) };
+
+    // Unfold the lower half
+    float fold = std::fmax(-normal.z, 0.0f);
+    normal.x += normal.x >= 0.0f ? -fold : fold;
+    normal.y += normal.y >= 0.0f ? -fold : fold;
+    return Vector3Normalize(normal);
+}
+
+void EncodePackedVertices(const Vertex* vertices, size_t count, const PositionQuantization& quantization,
+    PackedVertex* output)
+{
+    Normalizer normalize(quantization);
+    for (size_t i = 0; i < count; ++i)
+    {
+        EncodeSnormPosition(normalize(vertices[i].Position), output[i].Position);
+        EncodeColor(vertices[i].Color, output[i].Color);
+    }
+}
+
+void EncodeHalfVertices(const Vertex* vertices, size_t count, const PositionQuantization& quantization,
+    HalfVertex* output)
+{
+    Normalizer normalize(quantization);
+    for (size_t i = 0; i < count; ++i)
+    {
+        Float3 position = normalize(vertices[i].Position);
+        output[i].Position[0] = FloatToHalf(position.x);
+        output[i].Position[1] = FloatToHalf(position.y);
+        output[i].Position[2] = FloatToHalf(position.z);
+        output[i].Position[3] = 0x3c00;
+        EncodeColor(vertices[i].Color, output[i].Color);
+    }
+}
+
+void EncodePackedLitVertices(const Vertex* vertices, const Float3* normals, size_t count,
+    const PositionQuantization& quantization, PackedLitVertex* output)
+{
+    Normalizer normalize(quantization);
+    for (size_t i = 0; i < count; ++i)
+    {
+        EncodeSnormPosition(normalize(vertices[i].Position), output[i].Position);
+        OctahedralEncode(normals[i], output[i].Normal);
+        EncodeColor(vertices[i].Color, output[i].Color);
+    }
+}
+
+void EncodeVertices(VertexFormat format, const Vertex* vertices, size_t count, const PositionQuantization& quantization,
+    void* output)
+{
+    switch (format)
+    {
+    case VertexFormat::Float32:
+        std::memcpy(output, vertices, count * sizeof(Vertex));
+        break;
+    case VertexFormat::Snorm16:
+        EncodePackedVertices(vertices, count, quantization, static_cast<PackedVertex*>(output));
+        break;
+    case VertexFormat::Half16:
+        EncodeHalfVertices(vertices, count, quantization, static_cast<HalfVertex*>(output));
+        break;
+    }
+}
+
+bool ReadVertexElement(Format format, const void* data, float value[4])
+{
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    value[0] = value[1] = value[2] = 0.0f;
+    value[3] = 1.0f;
+
+    switch (format)
+    {
+    case Format::R32G32B32Float:
+        std::memcpy(value, bytes, 3 * sizeof(float));
+        return true;
+    case Format::R32G32B32A32Float:
+        std::memcpy(value, bytes, 4 * sizeof(float));
+        return true;
+    case Format::R16G16B16A16SNorm:
+        for (int i = 0; i < 4; ++i)
+            value[i] = Snorm16ToFloat(ReadUnaligned<int16_t>(bytes + 2 * i));
+        return true;
+    case Format::R16G16B16A16Float:
+        for (int i = 0; i < 4; ++i)
+            value[i] = HalfToFloat(ReadUnaligned<uint16_t>(bytes + 2 * i));
+        return true;
+    case Format::R16G16SNorm:
+        for (int i = 0; i < 2; ++i)
+            value[i] = Snorm16ToFloat(ReadUnaligned<int16_t>(bytes + 2 * i));
+        return true;
+    case Format::R8G8B8A8UNorm:
+        for (int i = 0; i < 4; ++i)
+            value[i] = bytes[i] / 255.0f;
+        return true;
+    default:
+        return false;
+    }
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+// Compact alternatives to the 28-byte Vertex { Float3 Position; Float4 Color; }.
+// Positions are stored relative to the mesh bounds as SNORM16 or half floats,
+// colors as RGBA8_UNORM and normals octahedral-encoded in two SNORM16s. The
+// fourth position component is written as 1.0, so the unchanged VS of
+// Effects.fx still sees float4(position, 1) and the dequantization is folded
+// into the world matrix: world = GetDequantizeMatrix() * world.
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#include "MathUtil.h"
+#include "RenderTypes.h"
+#include "Vertex.h"
+
+enum class VertexFormat
+{
+    Float32,        // Vertex, 28 bytes
+    Snorm16,        // PackedVertex, 12 bytes
+    Half16,         // HalfVertex, 12 bytes
+};
+
+// SNORM16 position in the mesh bounds + RGBA8 color
+struct PackedVertex
+{
+    int16_t Position[4];
+    uint8_t Color[4];
+};
+
+// Half-float position in the mesh bounds + RGBA8 color. SNORM16 spends its 16 bits
+// evenly over the bounds; half keeps 11 significant bits and is more precise only
+// close to the center, so SNORM16 is the better default.
+struct HalfVertex
+{
+    uint16_t Position[4];
+    uint8_t Color[4];
+};
+
+// PackedVertex plus an octahedral normal, for lit shaders
+struct PackedLitVertex
+{
+    int16_t Position[4];
+    int16_t Normal[2];
+    uint8_t Color[4];
+};
+
+static_assert(sizeof(PackedVertex) == 12, "PackedVertex must match PackedVertexInputLayout");
+static_assert(sizeof(HalfVertex) == 12, "HalfVertex must match HalfVertexInputLayout");
+static_assert(sizeof(PackedLitVertex) == 16, "PackedLitVertex must match PackedLitVertexInputLayout");
+
+inline const InputElementDesc PackedVertexInputLayout[] =
+{
+    { "POSITION", 0, Format::R16G16B16A16SNorm, 0, 0, false, 0 },
+    { "COLOR", 0, Format::R8G8B8A8UNorm, 0, 8, false, 0 },
+};
+
+inline const InputElementDesc HalfVertexInputLayout[] =
+{
+    { "POSITION", 0, Format::R16G16B16A16Float, 0, 0, false, 0 },
+    { "COLOR", 0, Format::R8G8B8A8UNorm, 0, 8, false, 0 },
+};
+
+// The shader decodes NORMAL with OctahedralDecode
+inline const InputElementDesc PackedLitVertexInputLayout[] =
+{
+    { "POSITION", 0, Format::R16G16B16A16SNorm, 0, 0, false, 0 },
+    { "NORMAL", 0, Format::R16G16SNorm, 0, 8, false, 0 },
+    { "COLOR", 0, Format::R8G8B8A8UNorm, 0, 12, false, 0 },
+};
+
+uint32_t GetVertexStride(VertexFormat format);
+// Input layout of the per-vertex stream in slot 0; count receives the number of elements
+const InputElementDesc* GetVertexInputLayout(VertexFormat format, uint32_t* count);
+
+// Maps quantized positions in [-1, 1] back to the mesh bounds
+struct PositionQuantization
+{
+    Float3 Center = { 0.0f, 0.0f, 0.0f };
+    Float3 Extent = { 1.0f, 1.0f, 1.0f };     // Half size per axis, never 0
+
+    // Scale by Extent, then translate by Center; multiply it in front of the world matrix
+    Float4x4 GetDequantizeMatrix() const;
+};
+
+PositionQuantization ComputePositionQuantization(const Vertex* vertices, size_t count);
+
+// Round to nearest even, with subnormals, infinities and NaN like DXGI_FORMAT_R16_FLOAT
+uint16_t FloatToHalf(float value);
+float HalfToFloat(uint16_t value);
+
+// Round to nearest even; lrint compiles to one conversion, where rounding half away
+// from zero needs a branch on the sign that random positions mispredict
+inline int16_t FloatToSnorm16(float value)
+{
+    float clamped = value < -1.0f ? -1.0f : (value > 1.0f ? 1.0f : value);
+    return static_cast<int16_t>(std::lrint(clamped * 32767.0f));
+}
+
+// -32768 and -32767 both decode to -1, as on the GPU
+inline float Snorm16ToFloat(int16_t value)
+{
+    float decoded = value / 32767.0f;
+    return decoded < -1.0f ? -1.0f : decoded;
+}
+
+inline uint8_t FloatToUnorm8(float value)
+{
+    float clamped = value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value);
+    return static_cast<uint8_t>(clamped * 255.0f + 0.5f);
+}
+
+// Unit vector to two SNORM16 on the octahedron unfolded into a square; the zero vector encodes as +Z
+void OctahedralEncode(const Float3& normal, int16_t encoded[2]);
+Float3 OctahedralDecode(const int16_t encoded[2]);
+
+// Encoders for existing meshes; output holds count vertices
+void EncodePackedVertices(const Vertex* vertices, size_t count, const PositionQuantization& quantization,
+    PackedVertex* output);
+void EncodeHalfVertices(const Vertex* vertices, size_t count, const PositionQuantization& quantization,
+    HalfVertex* output);
+void EncodePackedLitVertices(const Vertex* vertices, const Float3* normals, size_t count,
+    const PositionQuantization& quantization, PackedLitVertex* output);
+
+// Encodes into output (GetVertexStride(format) * count bytes); Float32 copies
+void EncodeVertices(VertexFormat format, const Vertex* vertices, size_t count, const PositionQuantization& quantization,
+    void* output);
+
+// Reads one element of a vertex as the input assembler would: missing components
+// become 0 (1 for w), normalized formats are scaled to [-1, 1] or [0, 1].
+// Returns false for formats that are not vertex formats.
+bool ReadVertexElement(Format format, const void* data, float value[4]);
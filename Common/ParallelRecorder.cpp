@@ -0,0 +1,84 @@
+#include "ParallelRecorder.h"
+
+#include <chrono>
+
+ParallelRecorder::ParallelRecorder(RenderDevice& device, JobSystem& jobSystem)
+    : m_Device(device)
+    , m_JobSystem(jobSystem)
+{
+}
+
+bool ParallelRecorder::Initialize(uint32_t maxChunks)
+{
+    while (m_Contexts.size() < maxChunks)
+    {
+        RenderContext* context = m_Device.CreateDeferredContext();
+        if (!context)
+            return false;
+        m_Contexts.push_back(context);
+    }
+    m_Lists.resize(m_Contexts.size());
+    m_Finished.resize(m_Contexts.size());
+    return !m_Contexts.empty();
+}
+
+uint32_t ParallelRecorder::GetChunkCount(uint32_t itemCount) const
+{
+    uint32_t chunks = itemCount / m_MinChunkSize + (itemCount % m_MinChunkSize ? 1 : 0);
+    return chunks < GetMaxChunks() ? chunks : GetMaxChunks();
+}
+
+void ParallelRecorder::GetChunkRange(uint32_t itemCount, uint32_t chunkCount, uint32_t chunk, uint32_t* begin,
+    uint32_t* end)
+{
+    *begin = static_cast<uint32_t>(static_cast<uint64_t>(itemCount) * chunk / chunkCount);
+    *end = static_cast<uint32_t>(static_cast<uint64_t>(itemCount) * (chunk + 1) / chunkCount);
+}
+
+bool ParallelRecorder::Record(uint32_t itemCount, const RecordFunction& record)
+{
+    auto start = std::chrono::steady_clock::now();
+    uint32_t chunkCount = GetChunkCount(itemCount);
+
+    // One chunk per job; workers that finish early pick up the next chunk
+    m_JobSystem.ParallelFor(chunkCount, 1, [&](size_t first, size_t last, unsigned int)
+    {
+        for (size_t chunk = first; chunk < last; ++chunk)
+        {
+            uint32_t begin, end;
+            GetChunkRange(itemCount, chunkCount, static_cast<uint32_t>(chunk), &begin, &end);
+
+            RenderContext& context = *m_Contexts[chunk];
+            context.BeginCommandList();
+            record(context, begin, end);
+            m_Finished[chunk] = context.FinishCommandList(m_Lists[chunk]);
+        }
+    });
+
+    m_RecordedChunks = chunkCount;
+    bool finished = true;
+    for (uint32_t chunk = 0; chunk < chunkCount; ++chunk)
+        finished = finished && m_Finished[chunk];
+
+    ++m_Stats.Frames;
+    m_Stats.Chunks += chunkCount;
+    m_Stats.RecordMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return finished;
+}
+
+bool ParallelRecorder::Execute(RenderContext& immediateContext)
+{
+    auto start = std::chrono::steady_clock::now();
+    bool executed = true;
+    for (uint32_t chunk = 0; chunk < m_RecordedChunks; ++chunk)
+    {
+        if (m_Finished[chunk])
+            executed = immediateContext.ExecuteCommandList(*m_Lists[chunk]) && executed;
+        else
+            executed = false;
+    }
+    m_RecordedChunks = 0;
+
+    m_Stats.ExecuteMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return executed;
+}
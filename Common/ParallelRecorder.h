@@ -0,0 +1,68 @@
+#pragma once
+
+// Spreads the recording of a draw list over the job system. The items are cut
+// into contiguous chunks, each chunk is recorded into its own deferred context
+// by whichever worker picks it up, and Execute runs the finished command lists
+// on the immediate context in chunk order. Chunk boundaries depend only on the
+// item count, never on the worker count or on scheduling, so the GPU sees the
+// same command stream as a single-threaded recording of the same chunks.
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "JobSystem.h"
+#include "RenderDevice.h"
+
+struct ParallelRecorderStats
+{
+    uint64_t Frames = 0;
+    uint64_t Chunks = 0;
+    double RecordMs = 0.0;      // Wall time of Record, all chunks together
+    double ExecuteMs = 0.0;
+};
+
+class ParallelRecorder
+{
+public:
+    // Records items [begin, end) on context. Every chunk starts from the default pipeline
+    // state, so the function binds everything its draws need.
+    using RecordFunction = std::function<void(RenderContext& context, uint32_t begin, uint32_t end)>;
+
+    ParallelRecorder(RenderDevice& device, JobSystem& jobSystem);
+
+    // Creates up to maxChunks deferred contexts; call on the render thread while no other
+    // thread uses the device
+    bool Initialize(uint32_t maxChunks);
+
+    // Chunks are never smaller than this, so a short draw list is not split into tiny lists
+    void SetMinChunkSize(uint32_t minChunkSize) { m_MinChunkSize = minChunkSize ? minChunkSize : 1; }
+
+    // Records [0, itemCount) in chunks on the worker threads and returns when all lists are finished
+    bool Record(uint32_t itemCount, const RecordFunction& record);
+
+    // Runs the lists of the last Record on the immediate context, first chunk first
+    bool Execute(RenderContext& immediateContext);
+
+    uint32_t GetMaxChunks() const { return static_cast<uint32_t>(m_Contexts.size()); }
+    uint32_t GetChunkCount(uint32_t itemCount) const;
+    // [begin, end) of chunk for itemCount items split into chunkCount chunks
+    static void GetChunkRange(uint32_t itemCount, uint32_t chunkCount, uint32_t chunk, uint32_t* begin, uint32_t* end);
+
+    const ParallelRecorderStats& GetStats() const { return m_Stats; }
+    void ResetStats() { m_Stats = {}; }
+
+private:
+    RenderDevice& m_Device;
+    JobSystem& m_JobSystem;
+    uint32_t m_MinChunkSize = 64;
+
+    std::vector<RenderContext*> m_Contexts;
+    std::vector<std::unique_ptr<CommandList>> m_Lists;
+    // Whether FinishCommandList succeeded for each chunk of the last Record
+    std::vector<uint8_t> m_Finished;
+    uint32_t m_RecordedChunks = 0;
+
+    ParallelRecorderStats m_Stats;
+};
@@ -0,0 +1,649 @@
+#pragma once
+
+// Procedural cube, UV sphere, icosphere, cylinder, torus, plane and capsule,
+// each described by a small shape struct holding its tessellation. A shape
+// computes any of its vertices or triangles on its own, from nothing but the
+// vertex or triangle number, which serves two uses:
+//   - MakePrimitiveVertices / MakePrimitiveIndices and StaticPrimitive
+//     evaluate a low-tessellation shape at compile time into constexpr
+//     arrays, so it costs nothing at runtime:
+//         using Ball = StaticPrimitive<Vertex, UvSphereShape{ 16, 8 }>;
+//         device->CreateBuffer(..., Ball::Vertices.data(), sizeof(Ball::Vertices));
+//   - GeneratePrimitive fills high-tessellation vertex and index buffers in
+//     parallel blocks on the job system.
+// Both run the same code, the sines and square roots included (std::sin is
+// not constexpr), so a shape gives the same bits either way.
+//
+// Every shape fits in [-1, 1] on each axis, like the tutorials' cube, and
+// follows the left-handed, clockwise-front convention of the tutorials. The
+// vertex format is a template parameter: PrimitiveVertexTraits<VertexType>
+// turns each PrimitivePoint into a vertex. Vertex gets the normal as its
+// color, PackedLitVertex the packed position and normal (the default
+// PositionQuantization, the unit cube, is exact for these shapes).
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "JobSystem.h"
+#include "MathUtil.h"
+#include "PackedVertex.h"
+#include "RenderTypes.h"
+#include "Vertex.h"
+
+// Position and unit normal, the vertex every shape produces
+struct PrimitivePoint
+{
+    Float3 Position;
+    Float3 Normal;
+};
+
+namespace PrimitiveMath
+{
+    constexpr double Pi = 3.14159265358979323846;
+
+    // (cos, sin) of step / steps of a full turn. Reduced to the nearest quarter turn in
+    // integers, so quarter turns are exact, then Taylor series in double on [-pi/4, pi/4].
+    constexpr Float2 CirclePoint(uint32_t step, uint32_t steps)
+    {
+        uint64_t scaled = uint64_t(step % steps) * 4;
+        uint64_t quarter = (scaled * 2 + steps) / (uint64_t(steps) * 2);
+        double x = (double(scaled) - double(quarter * steps)) / steps * (Pi / 2.0);
+        double x2 = x * x;
+        double s = x * (1.0 - x2 / 6 * (1.0 - x2 / 20 * (1.0 - x2 / 42 * (1.0 - x2 / 72 * (1.0 - x2 / 110)))));
+        double c = 1.0 - x2 / 2 * (1.0 - x2 / 12 * (1.0 - x2 / 30 * (1.0 - x2 / 56 * (1.0 - x2 / 90))));
+        switch (quarter % 4)
+        {
+        case 0: return { float(c), float(s) };
+        case 1: return { float(-s), float(c) };
+        case 2: return { float(-c), float(-s) };
+        default: return { float(s), float(-c) };
+        }
+    }
+
+    // Newton's method after scaling into [1/4, 4], where six steps reach double precision
+    constexpr double Sqrt(double value)
+    {
+        if (!(value > 0.0))
+            return 0.0;
+        double scale = 1.0;
+        while (value > 4.0)
+        {
+            value *= 0.25;
+            scale *= 2.0;
+        }
+        while (value < 0.25)
+        {
+            value *= 4.0;
+            scale *= 0.5;
+        }
+        double root = (1.0 + value) * 0.5;
+        for (int i = 0; i < 6; ++i)
+            root = (root + value / root) * 0.5;
+        return root * scale;
+    }
+
+    constexpr Float3 Normalize(double x, double y, double z)
+    {
+        double inverseLength = 1.0 / Sqrt(x * x + y * y + z * z);
+        return { float(x * inverseLength), float(y * inverseLength), float(z * inverseLength) };
+    }
+
+    // -1 + 2 * step / steps: [0, steps] spread over [-1, 1]
+    constexpr float Spread(uint32_t step, uint32_t steps)
+    {
+        return float(-1.0 + 2.0 * step / steps);
+    }
+}
+
+namespace PrimitiveDetail
+{
+    using Triangle = std::array<uint32_t, 3>;
+
+    // Sphere-like topology shared by the UV sphere and the capsule: a pole, rings of
+    // segments vertices from top to bottom, the other pole. Returns triangle t of the
+    // top cap, the bands between the rings and the bottom cap, in that order.
+    constexpr Triangle LatheTriangle(uint32_t rings, uint32_t segments, uint32_t t)
+    {
+        uint32_t bottom = rings * segments + 1;
+        auto ring = [segments](uint32_t r, uint32_t s) { return 1 + r * segments + s % segments; };
+        if (t < segments)
+            return { 0, ring(0, t + 1), ring(0, t) };
+        t -= segments;
+        if (t >= (rings - 1) * segments * 2)
+        {
+            uint32_t s = t - (rings - 1) * segments * 2;
+            return { ring(rings - 1, s), ring(rings - 1, s + 1), bottom };
+        }
+        uint32_t r = t / (segments * 2), s = t % (segments * 2) / 2;
+        if (t % 2 == 0)
+            return { ring(r, s), ring(r, s + 1), ring(r + 1, s) };
+        return { ring(r, s + 1), ring(r + 1, s + 1), ring(r + 1, s) };
+    }
+
+    // Triangle t of a grid of columns quads per row, its vertices numbered row by row: the
+    // triangles face the side cross(next row - vertex, next column - vertex) points to
+    constexpr Triangle GridTriangle(uint32_t columns, uint32_t t)
+    {
+        uint32_t quad = t / 2, width = columns + 1;
+        uint32_t i = quad / columns * width + quad % columns;
+        if (t % 2 == 0)
+            return { i, i + width, i + width + 1 };
+        return { i, i + width + 1, i + 1 };
+    }
+
+    struct Icosahedron
+    {
+        double Corners[12][3];
+        uint8_t Faces[20][3];       // Clockwise seen from outside
+        uint8_t Edges[30][2];       // Lower corner first
+        uint8_t FaceEdges[20][3];   // Edges AB, AC and BC of each face ABC
+    };
+
+    constexpr Icosahedron MakeIcosahedron()
+    {
+        constexpr double t = 1.6180339887498948482;
+        constexpr double corners[12][3] =
+        {
+            { -1, t, 0 }, { 1, t, 0 }, { -1, -t, 0 }, { 1, -t, 0 },
+            { 0, -1, t }, { 0, 1, t }, { 0, -1, -t }, { 0, 1, -t },
+            { t, 0, -1 }, { t, 0, 1 }, { -t, 0, -1 }, { -t, 0, 1 },
+        };
+        constexpr uint8_t faces[20][3] =
+        {
+            { 0, 11, 5 }, { 0, 5, 1 }, { 0, 1, 7 }, { 0, 7, 10 }, { 0, 10, 11 },
+            { 1, 5, 9 }, { 5, 11, 4 }, { 11, 10, 2 }, { 10, 7, 6 }, { 7, 1, 8 },
+            { 3, 9, 4 }, { 3, 4, 2 }, { 3, 2, 6 }, { 3, 6, 8 }, { 3, 8, 9 },
+            { 4, 9, 5 }, { 2, 4, 11 }, { 6, 2, 10 }, { 8, 6, 7 }, { 9, 8, 1 },
+        };
+
+        Icosahedron result = {};
+        double inverseLength = 1.0 / PrimitiveMath::Sqrt(1.0 + t * t);
+        for (int c = 0; c < 12; ++c)
+        {
+            for (int k = 0; k < 3; ++k)
+                result.Corners[c][k] = corners[c][k] * inverseLength;
+        }
+
+        int edgeCount = 0;
+        auto findEdge = [&](uint8_t a, uint8_t b) -> uint8_t
+        {
+            uint8_t low = a < b ? a : b, high = a < b ? b : a;
+            for (int e = 0; e < edgeCount; ++e)
+            {
+                if (result.Edges[e][0] == low && result.Edges[e][1] == high)
+                    return uint8_t(e);
+            }
+            result.Edges[edgeCount][0] = low;
+            result.Edges[edgeCount][1] = high;
+            return uint8_t(edgeCount++);
+        };
+        for (int f = 0; f < 20; ++f)
+        {
+            // A face is clockwise seen from outside when cross(B - A, C - A) points outward,
+            // along A + B + C; the others are flipped
+            uint8_t a = faces[f][0], b = faces[f][1], c = faces[f][2];
+            const double* pa = corners[a];
+            const double* pb = corners[b];
+            const double* pc = corners[c];
+            double u[3] = { pb[0] - pa[0], pb[1] - pa[1], pb[2] - pa[2] };
+            double v[3] = { pc[0] - pa[0], pc[1] - pa[1], pc[2] - pa[2] };
+            double normal[3] = { u[1] * v[2] - u[2] * v[1], u[2] * v[0] - u[0] * v[2], u[0] * v[1] - u[1] * v[0] };
+            double outward = normal[0] * (pa[0] + pb[0] + pc[0]) + normal[1] * (pa[1] + pb[1] + pc[1]) +
+                normal[2] * (pa[2] + pb[2] + pc[2]);
+            if (outward < 0.0)
+            {
+                uint8_t swap = b;
+                b = c;
+                c = swap;
+            }
+            result.Faces[f][0] = a;
+            result.Faces[f][1] = b;
+            result.Faces[f][2] = c;
+            result.FaceEdges[f][0] = findEdge(a, b);
+            result.FaceEdges[f][1] = findEdge(a, c);
+            result.FaceEdges[f][2] = findEdge(b, c);
+        }
+        return result;
+    }
+
+    inline constexpr Icosahedron IcosahedronTable = MakeIcosahedron();
+}
+
+// 6 faces of divisions x divisions quads; every face has its own vertices and normal
+struct CubeShape
+{
+    uint32_t Divisions = 1;             // At least 1
+
+    constexpr uint32_t GetVertexCount() const { return 6 * (Divisions + 1) * (Divisions + 1); }
+    constexpr uint32_t GetIndexCount() const { return 36 * Divisions * Divisions; }
+
+    constexpr PrimitivePoint GetVertex(uint32_t index) const
+    {
+        uint32_t perFace = (Divisions + 1) * (Divisions + 1), face = index / perFace, local = index % perFace;
+        const FaceAxes& axes = Faces[face];
+        float point[3] = {};
+        float normal[3] = {};
+        point[axes.Normal] = normal[axes.Normal] = axes.Sign;
+        point[axes.U] = PrimitiveMath::Spread(local % (Divisions + 1), Divisions);
+        point[axes.V] = PrimitiveMath::Spread(local / (Divisions + 1), Divisions);
+        return { { point[0], point[1], point[2] }, { normal[0], normal[1], normal[2] } };
+    }
+
+    constexpr PrimitiveDetail::Triangle GetTriangle(uint32_t triangle) const
+    {
+        uint32_t perFace = 2 * Divisions * Divisions, face = triangle / perFace;
+        PrimitiveDetail::Triangle corners = PrimitiveDetail::GridTriangle(Divisions, triangle % perFace);
+        for (uint32_t& corner : corners)
+            corner += face * (Divisions + 1) * (Divisions + 1);
+        return corners;
+    }
+
+private:
+    // V x U is the normal, so grid triangles face outward
+    struct FaceAxes
+    {
+        int Normal, U, V;
+        float Sign;
+    };
+    static constexpr FaceAxes Faces[6] =
+    {
+        { 0, 2, 1, 1.0f }, { 0, 1, 2, -1.0f },
+        { 1, 0, 2, 1.0f }, { 1, 2, 0, -1.0f },
+        { 2, 1, 0, 1.0f }, { 2, 0, 1, -1.0f },
+    };
+};
+
+// Unit sphere of rings latitude bands and segments longitude steps; the poles are shared
+struct UvSphereShape
+{
+    uint32_t Segments = 16;             // At least 3
+    uint32_t Rings = 8;                 // At least 2
+
+    constexpr uint32_t GetVertexCount() const { return (Rings - 1) * Segments + 2; }
+    constexpr uint32_t GetIndexCount() const { return 6 * Segments * (Rings - 1); }
+
+    constexpr PrimitivePoint GetVertex(uint32_t index) const
+    {
+        if (index == 0 || index == GetVertexCount() - 1)
+        {
+            float y = index == 0 ? 1.0f : -1.0f;
+            return { { 0.0f, y, 0.0f }, { 0.0f, y, 0.0f } };
+        }
+        Float2 latitude = PrimitiveMath::CirclePoint((index - 1) / Segments + 1, Rings * 2);
+        Float2 longitude = PrimitiveMath::CirclePoint((index - 1) % Segments, Segments);
+        Float3 normal = { latitude.y * longitude.x, latitude.x, latitude.y * longitude.y };
+        return { normal, normal };
+    }
+
+    constexpr PrimitiveDetail::Triangle GetTriangle(uint32_t triangle) const
+    {
+        return PrimitiveDetail::LatheTriangle(Rings - 1, Segments, triangle);
+    }
+};
+
+// Subdivided icosahedron on the unit sphere: every face is cut into frequency^2
+// triangles, so frequency 2^n has the 10 * 4^n + 2 vertices of n midpoint subdivisions.
+// The vertices are the 12 corners, then those inside the 30 edges, then those inside
+// the 20 faces, each shared by all its triangles.
+struct IcosphereShape
+{
+    uint32_t Frequency = 2;             // At least 1
+
+    constexpr uint32_t GetVertexCount() const { return 10 * Frequency * Frequency + 2; }
+    constexpr uint32_t GetIndexCount() const { return 60 * Frequency * Frequency; }
+
+    constexpr PrimitivePoint GetVertex(uint32_t index) const
+    {
+        const PrimitiveDetail::Icosahedron& ico = PrimitiveDetail::IcosahedronTable;
+        uint32_t n = Frequency;
+        double point[3] = {};
+        if (index < 12)
+        {
+            for (int k = 0; k < 3; ++k)
+                point[k] = ico.Corners[index][k];
+        }
+        else if (index < 12 + 30 * (n - 1))
+        {
+            uint32_t edge = (index - 12) / (n - 1), step = (index - 12) % (n - 1) + 1;
+            const double* a = ico.Corners[ico.Edges[edge][0]];
+            const double* b = ico.Corners[ico.Edges[edge][1]];
+            for (int k = 0; k < 3; ++k)
+                point[k] = (a[k] * (n - step) + b[k] * step) / n;
+        }
+        else
+        {
+            uint32_t perFace = (n - 1) * (n - 2) / 2, local = (index - 12 - 30 * (n - 1)) % perFace;
+            const uint8_t* face = ico.Faces[(index - 12 - 30 * (n - 1)) / perFace];
+            uint32_t j = FindInteriorRow(local);
+            uint32_t i = local - GetInteriorRowStart(j) + 1;
+            for (int k = 0; k < 3; ++k)
+            {
+                point[k] = (ico.Corners[face[0]][k] * (n - i - j) + ico.Corners[face[1]][k] * i +
+                    ico.Corners[face[2]][k] * j) / n;
+            }
+        }
+        Float3 normal = PrimitiveMath::Normalize(point[0], point[1], point[2]);
+        return { normal, normal };
+    }
+
+    constexpr PrimitiveDetail::Triangle GetTriangle(uint32_t triangle) const
+    {
+        // Row j of a face holds 2 (n - j) - 1 triangles, so j (2n - j) precede it
+        uint32_t n = Frequency, face = triangle / (n * n), local = triangle % (n * n);
+        uint32_t low = 0, high = n - 1;
+        while (low < high)
+        {
+            uint32_t middle = (low + high + 1) / 2;
+            if (middle * (2 * n - middle) <= local)
+                low = middle;
+            else
+                high = middle - 1;
+        }
+        uint32_t j = low, k = local - j * (2 * n - j), i = k / 2;
+        if (k % 2 == 0)
+            return { GetFaceVertex(face, i, j), GetFaceVertex(face, i + 1, j), GetFaceVertex(face, i, j + 1) };
+        return { GetFaceVertex(face, i + 1, j), GetFaceVertex(face, i + 1, j + 1), GetFaceVertex(face, i, j + 1) };
+    }
+
+private:
+    // Vertex at A + (B - A) i / n + (C - A) j / n of face ABC
+    constexpr uint32_t GetFaceVertex(uint32_t face, uint32_t i, uint32_t j) const
+    {
+        const PrimitiveDetail::Icosahedron& ico = PrimitiveDetail::IcosahedronTable;
+        uint32_t n = Frequency;
+        const uint8_t* corners = ico.Faces[face];
+        auto edgeVertex = [&](int side, uint8_t from, uint32_t steps) -> uint32_t
+        {
+            uint32_t edge = ico.FaceEdges[face][side];
+            uint32_t step = ico.Edges[edge][0] == from ? steps : n - steps;
+            return 12 + edge * (n - 1) + step - 1;
+        };
+        if (i == 0 && j == 0)
+            return corners[0];
+        if (i == n)
+            return corners[1];
+        if (j == n)
+            return corners[2];
+        if (j == 0)
+            return edgeVertex(0, corners[0], i);
+        if (i == 0)
+            return edgeVertex(1, corners[0], j);
+        if (i + j == n)
+            return edgeVertex(2, corners[1], j);
+        return 12 + 30 * (n - 1) + face * ((n - 1) * (n - 2) / 2) + GetInteriorRowStart(j) + i - 1;
+    }
+
+    // The vertices inside a face are numbered in rows j = 1.. of n - 1 - j vertices each
+    constexpr uint32_t GetInteriorRowStart(uint32_t j) const
+    {
+        return (j - 1) * (Frequency - 1) - (j - 1) * j / 2;
+    }
+
+    constexpr uint32_t FindInteriorRow(uint32_t local) const
+    {
+        uint32_t low = 1, high = Frequency - 2;
+        while (low < high)
+        {
+            uint32_t middle = (low + high + 1) / 2;
+            if (GetInteriorRowStart(middle) <= local)
+                low = middle;
+            else
+                high = middle - 1;
+        }
+        return low;
+    }
+};
+
+// Radius 1 from y = -1 to 1, the side cut into stacks; the caps have their own vertices
+struct CylinderShape
+{
+    uint32_t Segments = 16;             // At least 3
+    uint32_t Stacks = 1;                // At least 1
+    bool Caps = true;
+
+    constexpr uint32_t GetVertexCount() const { return (Stacks + 1) * Segments + (Caps ? 2 * (Segments + 1) : 0); }
+    constexpr uint32_t GetIndexCount() const { return 6 * Segments * Stacks + (Caps ? 6 * Segments : 0); }
+
+    constexpr PrimitivePoint GetVertex(uint32_t index) const
+    {
+        uint32_t side = (Stacks + 1) * Segments;
+        if (index < side)
+        {
+            Float2 around = PrimitiveMath::CirclePoint(index % Segments, Segments);
+            float y = -PrimitiveMath::Spread(index / Segments, Stacks);
+            return { { around.x, y, around.y }, { around.x, 0.0f, around.y } };
+        }
+        // Top cap center and ring, then the bottom's
+        uint32_t cap = (index - side) / (Segments + 1), local = (index - side) % (Segments + 1);
+        float y = cap == 0 ? 1.0f : -1.0f;
+        Float2 around = local == 0 ? Float2{ 0.0f, 0.0f } : PrimitiveMath::CirclePoint(local - 1, Segments);
+        return { { around.x, y, around.y }, { 0.0f, y, 0.0f } };
+    }
+
+    constexpr PrimitiveDetail::Triangle GetTriangle(uint32_t triangle) const
+    {
+        if (triangle < 2 * Segments * Stacks)
+        {
+            uint32_t r = triangle / (Segments * 2), s = triangle % (Segments * 2) / 2;
+            auto ring = [this](uint32_t row, uint32_t column) { return row * Segments + column % Segments; };
+            if (triangle % 2 == 0)
+                return { ring(r, s), ring(r, s + 1), ring(r + 1, s) };
+            return { ring(r, s + 1), ring(r + 1, s + 1), ring(r + 1, s) };
+        }
+        uint32_t s = triangle - 2 * Segments * Stacks, top = (Stacks + 1) * Segments;
+        if (s < Segments)
+            return { top, top + 1 + (s + 1) % Segments, top + 1 + s };
+        uint32_t bottom = top + Segments + 1;
+        s -= Segments;
+        return { bottom + 1 + s, bottom + 1 + (s + 1) % Segments, bottom };
+    }
+};
+
+// Ring of the given radii around the y axis: segments steps around it, sides around the tube
+struct TorusShape
+{
+    uint32_t Segments = 24;             // At least 3
+    uint32_t Sides = 12;                // At least 3
+    float MajorRadius = 0.75f;
+    float MinorRadius = 0.25f;
+
+    constexpr uint32_t GetVertexCount() const { return Segments * Sides; }
+    constexpr uint32_t GetIndexCount() const { return 6 * Segments * Sides; }
+
+    constexpr PrimitivePoint GetVertex(uint32_t index) const
+    {
+        Float2 around = PrimitiveMath::CirclePoint(index / Sides, Segments);
+        Float2 tube = PrimitiveMath::CirclePoint(index % Sides, Sides);
+        Float3 normal = { tube.x * around.x, tube.y, tube.x * around.y };
+        float radius = MajorRadius + MinorRadius * tube.x;
+        return { { radius * around.x, MinorRadius * tube.y, radius * around.y }, normal };
+    }
+
+    constexpr PrimitiveDetail::Triangle GetTriangle(uint32_t triangle) const
+    {
+        uint32_t i = triangle / (Sides * 2), j = triangle % (Sides * 2) / 2;
+        auto vertex = [this](uint32_t segment, uint32_t side) { return segment % Segments * Sides + side % Sides; };
+        if (triangle % 2 == 0)
+            return { vertex(i, j), vertex(i, j + 1), vertex(i + 1, j) };
+        return { vertex(i, j + 1), vertex(i + 1, j + 1), vertex(i + 1, j) };
+    }
+};
+
+// Grid on y = 0 over [-1, 1] in x and z, facing +y
+struct PlaneShape
+{
+    uint32_t Columns = 1;               // Along x, at least 1
+    uint32_t Rows = 1;                  // Along z, at least 1
+
+    constexpr uint32_t GetVertexCount() const { return (Columns + 1) * (Rows + 1); }
+    constexpr uint32_t GetIndexCount() const { return 6 * Columns * Rows; }
+
+    constexpr PrimitivePoint GetVertex(uint32_t index) const
+    {
+        return { { PrimitiveMath::Spread(index % (Columns + 1), Columns), 0.0f,
+            PrimitiveMath::Spread(index / (Columns + 1), Rows) }, { 0.0f, 1.0f, 0.0f } };
+    }
+
+    constexpr PrimitiveDetail::Triangle GetTriangle(uint32_t triangle) const
+    {
+        return PrimitiveDetail::GridTriangle(Columns, triangle);
+    }
+};
+
+// Cylinder of the given radius between y = -HalfHeight and HalfHeight, closed by two
+// hemispheres of rings latitude bands each
+struct CapsuleShape
+{
+    uint32_t Segments = 16;             // At least 3
+    uint32_t Rings = 4;                 // Per hemisphere, at least 1
+    float Radius = 0.5f;
+    float HalfHeight = 0.5f;
+
+    constexpr uint32_t GetVertexCount() const { return 2 * Rings * Segments + 2; }
+    constexpr uint32_t GetIndexCount() const { return 12 * Segments * Rings; }
+
+    constexpr PrimitivePoint GetVertex(uint32_t index) const
+    {
+        if (index == 0 || index == GetVertexCount() - 1)
+        {
+            float y = index == 0 ? 1.0f : -1.0f;
+            return { { 0.0f, y * (HalfHeight + Radius), 0.0f }, { 0.0f, y, 0.0f } };
+        }
+        // The equator ring is there twice, at the top and at the bottom of the cylinder
+        uint32_t ring = (index - 1) / Segments + 1;
+        bool upper = ring <= Rings;
+        Float2 latitude = PrimitiveMath::CirclePoint(upper ? ring : ring - 1, Rings * 4);
+        Float2 longitude = PrimitiveMath::CirclePoint((index - 1) % Segments, Segments);
+        Float3 normal = { latitude.y * longitude.x, latitude.x, latitude.y * longitude.y };
+        float offset = upper ? HalfHeight : -HalfHeight;
+        return { { normal.x * Radius, normal.y * Radius + offset, normal.z * Radius }, normal };
+    }
+
+    constexpr PrimitiveDetail::Triangle GetTriangle(uint32_t triangle) const
+    {
+        return PrimitiveDetail::LatheTriangle(2 * Rings, Segments, triangle);
+    }
+};
+
+// Builds a VertexType from a PrimitivePoint; specialize it for other vertex formats
+template <typename VertexType>
+struct PrimitiveVertexTraits;
+
+template <>
+struct PrimitiveVertexTraits<PrimitivePoint>
+{
+    static constexpr PrimitivePoint Make(const PrimitivePoint& point) { return point; }
+};
+
+// The normal mapped to [0, 1] as the color, which the unlit shader of the tutorials shows
+template <>
+struct PrimitiveVertexTraits<Vertex>
+{
+    static constexpr Vertex Make(const PrimitivePoint& point)
+    {
+        const Float3& n = point.Normal;
+        return { point.Position, { n.x * 0.5f + 0.5f, n.y * 0.5f + 0.5f, n.z * 0.5f + 0.5f, 1.0f } };
+    }
+};
+
+// White, with the position quantized to the unit cube; runtime only, as the encoders are not constexpr
+template <>
+struct PrimitiveVertexTraits<PackedLitVertex>
+{
+    static PackedLitVertex Make(const PrimitivePoint& point)
+    {
+        PackedLitVertex vertex = {};
+        vertex.Position[0] = FloatToSnorm16(point.Position.x);
+        vertex.Position[1] = FloatToSnorm16(point.Position.y);
+        vertex.Position[2] = FloatToSnorm16(point.Position.z);
+        vertex.Position[3] = 32767;
+        OctahedralEncode(point.Normal, vertex.Normal);
+        for (uint8_t& channel : vertex.Color)
+            channel = 255;
+        return vertex;
+    }
+};
+
+template <typename VertexType, auto Shape>
+constexpr std::array<VertexType, Shape.GetVertexCount()> MakePrimitiveVertices()
+{
+    std::array<VertexType, Shape.GetVertexCount()> vertices = {};
+    for (uint32_t i = 0; i < vertices.size(); ++i)
+        vertices[i] = PrimitiveVertexTraits<VertexType>::Make(Shape.GetVertex(i));
+    return vertices;
+}
+
+template <auto Shape, typename IndexType = uint16_t>
+constexpr std::array<IndexType, Shape.GetIndexCount()> MakePrimitiveIndices()
+{
+    static_assert(Shape.GetVertexCount() - 1 <= IndexType(~IndexType(0)), "the shape has too many vertices");
+    std::array<IndexType, Shape.GetIndexCount()> indices = {};
+    for (uint32_t t = 0; t < indices.size() / 3; ++t)
+    {
+        PrimitiveDetail::Triangle corners = Shape.GetTriangle(t);
+        for (uint32_t k = 0; k < 3; ++k)
+            indices[t * 3 + k] = static_cast<IndexType>(corners[k]);
+    }
+    return indices;
+}
+
+// Compile-time vertex and index arrays of a shape, e.g. StaticPrimitive<Vertex, CubeShape{}>
+template <typename VertexType, auto Shape, typename IndexType = uint16_t>
+struct StaticPrimitive
+{
+    static constexpr std::array<VertexType, Shape.GetVertexCount()> Vertices =
+        MakePrimitiveVertices<VertexType, Shape>();
+    static constexpr std::array<IndexType, Shape.GetIndexCount()> Indices = MakePrimitiveIndices<Shape, IndexType>();
+    static constexpr Format IndexFormat = sizeof(IndexType) == 2 ? Format::R16UInt : Format::R32UInt;
+};
+
+// Vertices and triangles generated per block
+constexpr uint32_t PrimitiveBlockSize = 4096;
+
+// Writes shape.GetVertexCount() vertices and shape.GetIndexCount() indices. Blocks of
+// vertices and triangles run on the job system, or on the calling thread when it is null.
+template <typename VertexType, typename Shape, typename IndexType>
+void GeneratePrimitive(const Shape& shape, JobSystem* jobSystem, VertexType* vertices, IndexType* indices)
+{
+    uint32_t vertexCount = shape.GetVertexCount(), triangleCount = shape.GetIndexCount() / 3;
+    size_t vertexBlocks = (size_t(vertexCount) + PrimitiveBlockSize - 1) / PrimitiveBlockSize;
+    size_t triangleBlocks = (size_t(triangleCount) + PrimitiveBlockSize - 1) / PrimitiveBlockSize;
+    auto generate = [&](size_t begin, size_t end, unsigned int)
+    {
+        for (size_t block = begin; block < end; ++block)
+        {
+            if (block < vertexBlocks)
+            {
+                uint32_t first = static_cast<uint32_t>(block * PrimitiveBlockSize);
+                uint32_t last = std::min(first + PrimitiveBlockSize, vertexCount);
+                for (uint32_t i = first; i < last; ++i)
+                    vertices[i] = PrimitiveVertexTraits<VertexType>::Make(shape.GetVertex(i));
+                continue;
+            }
+            uint32_t first = static_cast<uint32_t>((block - vertexBlocks) * PrimitiveBlockSize);
+            uint32_t last = std::min(first + PrimitiveBlockSize, triangleCount);
+            for (uint32_t t = first; t < last; ++t)
+            {
+                PrimitiveDetail::Triangle corners = shape.GetTriangle(t);
+                for (uint32_t k = 0; k < 3; ++k)
+                    indices[size_t(t) * 3 + k] = static_cast<IndexType>(corners[k]);
+            }
+        }
+    };
+    if (jobSystem)
+        jobSystem->ParallelFor(vertexBlocks + triangleBlocks, 1, generate);
+    else
+        generate(0, vertexBlocks + triangleBlocks, 0);
+}
+
+template <typename VertexType, typename Shape, typename IndexType>
+void GeneratePrimitive(const Shape& shape, JobSystem* jobSystem, std::vector<VertexType>* vertices,
+    std::vector<IndexType>* indices)
+{
+    vertices->resize(shape.GetVertexCount());
+    indices->resize(shape.GetIndexCount());
+    GeneratePrimitive(shape, jobSystem, vertices->data(), indices->data());
+}
@@ -0,0 +1,236 @@
+#include "RangeAllocator.h"
+
+#include <algorithm>
+#include <bit>
+
+namespace
+{
+    constexpr uint32_t MantissaBits = 3;
+    constexpr uint32_t MantissaValue = 1u << MantissaBits;
+    constexpr uint32_t MantissaMask = MantissaValue - 1;
+
+    // Ranges of a request's own bin looked at before a larger bin
+    constexpr uint32_t OwnBinSearch = 8;
+
+    // Bin whose sizes are all <= size: free ranges go here, so any of them can hold the
+    // sizes the bin starts at
+    uint32_t BinRoundDown(uint32_t size)
+    {
+        if (size < MantissaValue)
+            return size;
+        uint32_t mantissaStart = 31 - std::countl_zero(size) - MantissaBits;
+        return ((mantissaStart + 1) << MantissaBits) | ((size >> mantissaStart) & MantissaMask);
+    }
+
+    // First bin whose sizes are all >= size: a request is served from here or above. The
+    // carry of a full mantissa moves on to the next exponent.
+    uint32_t BinRoundUp(uint32_t size)
+    {
+        if (size < MantissaValue)
+            return size;
+        uint32_t mantissaStart = 31 - std::countl_zero(size) - MantissaBits;
+        uint32_t bin = ((mantissaStart + 1) << MantissaBits) | ((size >> mantissaStart) & MantissaMask);
+        return (size & ((1u << mantissaStart) - 1)) ? bin + 1 : bin;
+    }
+}
+
+RangeAllocator::RangeAllocator(uint32_t capacity)
+{
+    Reset(capacity);
+}
+
+void RangeAllocator::Reset(uint32_t capacity)
+{
+    m_Capacity = capacity;
+    m_FreeSize = 0;
+    m_FreeRangeCount = 0;
+    m_TopMask = 0;
+    std::fill(std::begin(m_BinMasks), std::end(m_BinMasks), uint8_t(0));
+    std::fill(std::begin(m_BinHeads), std::end(m_BinHeads), RangeAllocation::NoNode);
+    m_Nodes.clear();
+    m_UnusedNodes.clear();
+    if (capacity > 0)
+        InsertFree(NewNode(0, capacity));
+}
+
+bool RangeAllocator::Allocate(uint32_t size, RangeAllocation* allocation)
+{
+    *allocation = {};
+    uint32_t node = RangeAllocation::NoNode;
+    if (size > 0 && size <= m_FreeSize)
+    {
+        // A few ranges of the bin of size itself first, which keeps the larger bins whole
+        uint32_t ownBin = BinRoundDown(size);
+        node = FindInBin(ownBin, size, OwnBinSearch);
+        if (node == RangeAllocation::NoNode)
+        {
+            uint32_t bin = FindFreeBin(BinRoundUp(size));
+            node = bin != BinCount ? m_BinHeads[bin] : FindInBin(ownBin, size, UINT32_MAX);
+        }
+    }
+    if (node == RangeAllocation::NoNode)
+    {
+        ++m_Stats.Failures;
+        return false;
+    }
+
+    RemoveFree(node);
+    uint32_t rest = m_Nodes[node].Size - size;
+    if (rest > 0)
+    {
+        // The rest becomes a free node right after the allocation
+        uint32_t restNode = NewNode(m_Nodes[node].Offset + size, rest);
+        uint32_t next = m_Nodes[node].NeighborNext;
+        m_Nodes[restNode].NeighborPrev = node;
+        m_Nodes[restNode].NeighborNext = next;
+        if (next != RangeAllocation::NoNode)
+            m_Nodes[next].NeighborPrev = restNode;
+        m_Nodes[node].NeighborNext = restNode;
+        m_Nodes[node].Size = size;
+        InsertFree(restNode);
+    }
+
+    m_Nodes[node].Used = true;
+    allocation->Offset = m_Nodes[node].Offset;
+    allocation->Node = node;
+    ++m_Stats.Allocations;
+    return true;
+}
+
+void RangeAllocator::Free(const RangeAllocation& allocation)
+{
+    uint32_t node = allocation.Node;
+    if (node >= m_Nodes.size() || !m_Nodes[node].Used)
+        return;
+
+    // Absorb free neighbours; the merged range keeps this node
+    uint32_t prev = m_Nodes[node].NeighborPrev;
+    if (prev != RangeAllocation::NoNode && !m_Nodes[prev].Used)
+    {
+        RemoveFree(prev);
+        m_Nodes[node].Offset = m_Nodes[prev].Offset;
+        m_Nodes[node].Size += m_Nodes[prev].Size;
+        m_Nodes[node].NeighborPrev = m_Nodes[prev].NeighborPrev;
+        if (m_Nodes[node].NeighborPrev != RangeAllocation::NoNode)
+            m_Nodes[m_Nodes[node].NeighborPrev].NeighborNext = node;
+        m_UnusedNodes.push_back(prev);
+    }
+    uint32_t next = m_Nodes[node].NeighborNext;
+    if (next != RangeAllocation::NoNode && !m_Nodes[next].Used)
+    {
+        RemoveFree(next);
+        m_Nodes[node].Size += m_Nodes[next].Size;
+        m_Nodes[node].NeighborNext = m_Nodes[next].NeighborNext;
+        if (m_Nodes[node].NeighborNext != RangeAllocation::NoNode)
+            m_Nodes[m_Nodes[node].NeighborNext].NeighborPrev = node;
+        m_UnusedNodes.push_back(next);
+    }
+
+    m_Nodes[node].Used = false;
+    InsertFree(node);
+    ++m_Stats.Frees;
+}
+
+uint32_t RangeAllocator::GetSize(const RangeAllocation& allocation) const
+{
+    return allocation.Node < m_Nodes.size() && m_Nodes[allocation.Node].Used ? m_Nodes[allocation.Node].Size : 0;
+}
+
+uint32_t RangeAllocator::GetLargestFreeRange() const
+{
+    if (m_TopMask == 0)
+        return 0;
+
+    // The highest bin holds the largest ranges, but they differ by up to 12.5%
+    uint32_t top = 31 - std::countl_zero(m_TopMask);
+    uint32_t bin = top * MantissaValue + 31 - std::countl_zero(uint32_t(m_BinMasks[top]));
+    uint32_t largest = 0;
+    for (uint32_t node = m_BinHeads[bin]; node != RangeAllocation::NoNode; node = m_Nodes[node].BinNext)
+        largest = std::max(largest, m_Nodes[node].Size);
+    return largest;
+}
+
+uint32_t RangeAllocator::NewNode(uint32_t offset, uint32_t size)
+{
+    uint32_t node;
+    if (m_UnusedNodes.empty())
+    {
+        node = static_cast<uint32_t>(m_Nodes.size());
+        m_Nodes.emplace_back();
+    }
+    else
+    {
+        node = m_UnusedNodes.back();
+        m_UnusedNodes.pop_back();
+    }
+    m_Nodes[node] = { offset, size, RangeAllocation::NoNode, RangeAllocation::NoNode, RangeAllocation::NoNode,
+        RangeAllocation::NoNode, false };
+    return node;
+}
+
+void RangeAllocator::InsertFree(uint32_t node)
+{
+    uint32_t bin = BinRoundDown(m_Nodes[node].Size);
+    uint32_t head = m_BinHeads[bin];
+    m_Nodes[node].BinPrev = RangeAllocation::NoNode;
+    m_Nodes[node].BinNext = head;
+    if (head != RangeAllocation::NoNode)
+        m_Nodes[head].BinPrev = node;
+    m_BinHeads[bin] = node;
+
+    m_BinMasks[bin / MantissaValue] |= uint8_t(1u << (bin % MantissaValue));
+    m_TopMask |= 1u << (bin / MantissaValue);
+    m_FreeSize += m_Nodes[node].Size;
+    ++m_FreeRangeCount;
+}
+
+void RangeAllocator::RemoveFree(uint32_t node)
+{
+    uint32_t prev = m_Nodes[node].BinPrev, next = m_Nodes[node].BinNext;
+    if (next != RangeAllocation::NoNode)
+        m_Nodes[next].BinPrev = prev;
+    if (prev != RangeAllocation::NoNode)
+    {
+        m_Nodes[prev].BinNext = next;
+    }
+    else
+    {
+        uint32_t bin = BinRoundDown(m_Nodes[node].Size);
+        m_BinHeads[bin] = next;
+        if (next == RangeAllocation::NoNode)
+        {
+            m_BinMasks[bin / MantissaValue] &= uint8_t(~(1u << (bin % MantissaValue)));
+            if (m_BinMasks[bin / MantissaValue] == 0)
+                m_TopMask &= ~(1u << (bin / MantissaValue));
+        }
+    }
+    m_FreeSize -= m_Nodes[node].Size;
+    --m_FreeRangeCount;
+}
+
+uint32_t RangeAllocator::FindInBin(uint32_t bin, uint32_t size, uint32_t limit) const
+{
+    uint32_t node = m_BinHeads[bin];
+    for (uint32_t i = 0; i < limit && node != RangeAllocation::NoNode; ++i, node = m_Nodes[node].BinNext)
+    {
+        if (m_Nodes[node].Size >= size)
+            return node;
+    }
+    return RangeAllocation::NoNode;
+}
+
+uint32_t RangeAllocator::FindFreeBin(uint32_t bin) const
+{
+    uint32_t top = bin / MantissaValue;
+    uint32_t bins = m_BinMasks[top] & (~0u << (bin % MantissaValue));
+    if (bins == 0)
+    {
+        // bin is at most BinRoundUp(UINT32_MAX) = 240, so top + 1 < 32
+        uint32_t tops = m_TopMask & (~0u << (top + 1));
+        if (tops == 0)
+            return BinCount;
+        top = std::countr_zero(tops);
+        bins = m_BinMasks[top];
+    }
+    return top * MantissaValue + std::countr_zero(bins);
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+// Two-level segregated fit (TLSF) allocator of ranges in a buffer of capacity
+// elements, e.g. the vertices or indices of GeometryBuffer. Free ranges are
+// kept in 256 bins by size: the bin of a size is its floating-point form with
+// a 5-bit exponent and a 3-bit mantissa, so every bin covers sizes within
+// 12.5% of each other, and one bit per bin in a two-level mask finds the
+// first bin whose ranges all fit a request with two bit scans. Allocate first
+// looks at a few ranges of the request's own bin, which keeps larger ranges
+// whole (streaming meshes then fragment about as little as with best fit),
+// then takes a range from that first bin and returns the rest of it to the
+// bins. Only when both fail does it search the whole own bin, so a request
+// fails only when no free range is large enough. Free merges the range with
+// its free neighbours in the buffer. Both are O(1) on the common path and
+// never touch the buffer itself: only offsets are managed here, like
+// ConstantBufferRing.
+
+#include <cstdint>
+#include <vector>
+
+struct RangeAllocation
+{
+    static constexpr uint32_t NoNode = UINT32_MAX;
+
+    uint32_t Offset = 0;
+    uint32_t Node = NoNode;     // Handle for Free; NoNode when the allocation failed
+
+    explicit operator bool() const { return Node != NoNode; }
+};
+
+struct RangeAllocatorStats
+{
+    uint64_t Allocations = 0;
+    uint64_t Frees = 0;
+    uint64_t Failures = 0;
+};
+
+class RangeAllocator
+{
+public:
+    static constexpr uint32_t BinCount = 256;
+
+    explicit RangeAllocator(uint32_t capacity = 0);
+
+    // Forgets every allocation; the whole capacity is one free range
+    void Reset(uint32_t capacity);
+    void Reset() { Reset(m_Capacity); }
+
+    // Reserves size elements. Returns false when no free range is large enough.
+    bool Allocate(uint32_t size, RangeAllocation* allocation);
+    // Releases an allocation made since the last Reset; empty allocations are ignored
+    void Free(const RangeAllocation& allocation);
+
+    uint32_t GetSize(const RangeAllocation& allocation) const;
+
+    uint32_t GetCapacity() const { return m_Capacity; }
+    uint32_t GetFreeSize() const { return m_FreeSize; }
+    uint32_t GetFreeRangeCount() const { return m_FreeRangeCount; }
+    // Largest single allocation that would succeed now
+    uint32_t GetLargestFreeRange() const;
+
+    const RangeAllocatorStats& GetStats() const { return m_Stats; }
+    void ResetStats() { m_Stats = {}; }
+
+private:
+    struct Node
+    {
+        uint32_t Offset;
+        uint32_t Size;
+        uint32_t BinPrev;           // Free nodes of the same bin
+        uint32_t BinNext;
+        uint32_t NeighborPrev;      // Nodes next to this one in the buffer, free or not
+        uint32_t NeighborNext;
+        bool Used;
+    };
+
+    uint32_t NewNode(uint32_t offset, uint32_t size);
+    void InsertFree(uint32_t node);
+    void RemoveFree(uint32_t node);
+    // First of at most limit free nodes of bin with at least size elements, NoNode if none
+    uint32_t FindInBin(uint32_t bin, uint32_t size, uint32_t limit) const;
+    // First bin at or above bin that holds a free node, BinCount if none
+    uint32_t FindFreeBin(uint32_t bin) const;
+
+    uint32_t m_Capacity = 0;
+    uint32_t m_FreeSize = 0;
+    uint32_t m_FreeRangeCount = 0;
+    uint32_t m_TopMask = 0;         // Bit t: some bin t * 8 + i is not empty
+    uint8_t m_BinMasks[BinCount / 8] = {};
+    uint32_t m_BinHeads[BinCount];
+    std::vector<Node> m_Nodes;
+    std::vector<uint32_t> m_UnusedNodes;
+    RangeAllocatorStats m_Stats;
+};
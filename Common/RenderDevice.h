@@ -0,0 +1,126 @@
+#pragma once
+
+// Device/context abstraction over the D3D11 calls every tutorial repeats in
+// InitializeDirect3D, InitializeScene and DrawScene. Scenes talk only to these
+// interfaces, so the same scene runs on D3D11RenderDevice on Windows and on
+// NullRenderDevice / SoftwareRenderDevice anywhere.
+
+#include <memory>
+
+#include "RenderTypes.h"
+
+// Commands recorded on a deferred context, the counterpart of ID3D11CommandList.
+// Only the device whose context recorded a list can execute it.
+class CommandList
+{
+public:
+    virtual ~CommandList() = default;
+};
+
+// Records state and draw calls, the counterpart of ID3D11DeviceContext
+class RenderContext
+{
+public:
+    virtual ~RenderContext() = default;
+
+    virtual void ClearRenderTarget(const float color[4]) = 0;
+    virtual void ClearDepthStencil(float depth, uint8_t stencil) = 0;
+    virtual void SetViewport(const Viewport& viewport) = 0;
+
+    virtual void SetRasterizerState(RasterizerStateHandle state) = 0;
+    virtual void SetVertexShader(VertexShaderHandle shader) = 0;
+    virtual void SetPixelShader(PixelShaderHandle shader) = 0;
+
+    virtual void SetVertexBuffer(uint32_t slot, BufferHandle buffer, uint32_t stride, uint32_t offset) = 0;
+    virtual void SetIndexBuffer(BufferHandle buffer, Format format, uint32_t offset) = 0;
+    virtual void SetVSConstantBuffer(uint32_t slot, BufferHandle buffer) = 0;
+    virtual void SetPSConstantBuffer(uint32_t slot, BufferHandle buffer) = 0;
+
+    // Replaces the whole contents of a Default usage buffer (UpdateSubresource). A Dynamic buffer is
+    // mapped with WRITE_DISCARD: the first size bytes are written and the rest becomes undefined.
+    virtual void UpdateBuffer(BufferHandle buffer, const void* data, uint32_t size) = 0;
+    // Replaces bytes [offset, offset + size) of a buffer and keeps the rest: UpdateSubresource with
+    // a box for Default usage, a WRITE_NO_OVERWRITE map for Dynamic usage, so the caller must not
+    // touch bytes the GPU may still be reading. Ranges past the end are ignored.
+    virtual void UpdateBufferRange(BufferHandle buffer, uint32_t offset, const void* data, uint32_t size) = 0;
+
+    // Copies constants that change per draw into the context's constant buffer ring and
+    // returns where they landed; the range stays valid until the frame is presented.
+    // Returns an empty range when size is 0 or larger than a constant buffer can be.
+    virtual ConstantBufferRange AllocateConstants(const void* data, uint32_t size) = 0;
+    virtual void SetVSConstantBufferRange(uint32_t slot, const ConstantBufferRange& range) = 0;
+    virtual void SetPSConstantBufferRange(uint32_t slot, const ConstantBufferRange& range) = 0;
+
+    // Triangle list only, like every tutorial
+    virtual void DrawIndexed(uint32_t indexCount, uint32_t startIndexLocation, int32_t baseVertexLocation) = 0;
+    // Per-instance input elements step through the buffer bound to their slot once per instance
+    virtual void DrawIndexedInstanced(uint32_t indexCountPerInstance, uint32_t instanceCount, uint32_t startIndexLocation,
+        int32_t baseVertexLocation, uint32_t startInstanceLocation) = 0;
+
+    // Deferred contexts only. A command list starts from the default pipeline state with the
+    // back buffer and the full-target viewport bound, whatever the context recorded before.
+    // Recording must not overlap resource creation on the device.
+    virtual void BeginCommandList() {}
+    // Closes the list recorded since BeginCommandList into list, reusing its storage when
+    // it already holds a list of this backend. A deferred context's stats cover one list.
+    virtual bool FinishCommandList(std::unique_ptr<CommandList>&) { return false; }
+
+    // Immediate context only. Runs a finished list; afterwards the context is back in the
+    // state BeginCommandList describes, so every setting must be bound again before drawing.
+    virtual bool ExecuteCommandList(const CommandList&) { return false; }
+
+    const RenderStats& GetStats() const { return m_Stats; }
+    void ResetStats() { m_Stats = {}; }
+
+protected:
+    RenderStats m_Stats;
+};
+
+// Creates resources and owns the swap chain, the counterpart of ID3D11Device + IDXGISwapChain
+class RenderDevice
+{
+public:
+    virtual ~RenderDevice() = default;
+
+    // Human readable backend name, e.g. "d3d11", "software", "null"
+    virtual const char* GetName() const = 0;
+
+    virtual bool CreateBuffer(const BufferDesc& desc, const void* initialData, BufferHandle* buffer) = 0;
+    // Immutable buffer initialized from memory the owner keeps valid and unchanged for the
+    // buffer's lifetime, e.g. a file mapping. A device that has to restore buffers after
+    // device loss reads the data again from there instead of holding its own copy.
+    virtual bool CreateBufferNoCopy(const BufferDesc& desc, const void* data, BufferHandle* buffer)
+    {
+        return desc.Usage == BufferUsage::Immutable && data && CreateBuffer(desc, data, buffer);
+    }
+    // Frees the buffer; the handle becomes invalid and is never handed out again
+    virtual void ReleaseBuffer(BufferHandle buffer) = 0;
+    virtual bool CreateVertexShader(const ShaderDesc& desc, VertexShaderHandle* shader) = 0;
+    virtual bool CreatePixelShader(const ShaderDesc& desc, PixelShaderHandle* shader) = 0;
+    // Equal descs share one state object, so asking again for a desc returns the same handle
+    virtual bool CreateRasterizerState(const RasterizerDesc& desc, RasterizerStateHandle* state) = 0;
+    virtual bool GetRasterizerDesc(RasterizerStateHandle state, RasterizerDesc* desc) const = 0;
+
+    // Recreates the back buffer and depth buffer (ResizeDirectXBuffers)
+    virtual bool Resize(uint32_t width, uint32_t height) = 0;
+    virtual uint32_t GetWidth() const = 0;
+    virtual uint32_t GetHeight() const = 0;
+
+    virtual RenderContext& GetImmediateContext() = 0;
+
+    // Context for recording command lists on another thread (ID3D11Device::CreateDeferredContext).
+    // The device owns it and keeps it valid until the device is destroyed; nullptr on failure.
+    virtual RenderContext* CreateDeferredContext() = 0;
+
+    // Shows the frame; returns false when the device could not be recovered
+    virtual bool Present() = 0;
+
+    // Full-target viewport for the current back buffer size
+    Viewport GetDefaultViewport() const
+    {
+        Viewport viewport;
+        viewport.Width = static_cast<float>(GetWidth());
+        viewport.Height = static_cast<float>(GetHeight());
+        return viewport;
+    }
+};
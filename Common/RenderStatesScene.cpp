@@ -0,0 +1,129 @@
+#include "RenderStatesScene.h"
+
+#include <iterator>
+#include <vector>
+
+#include "CubeMesh.h"
+
+bool RenderStatesScene::Initialize(RenderDevice& device)
+{
+    m_Device = &device;
+
+    // Create the shaders and input layout
+    uint32_t layoutCount;
+    const InputElementDesc* layout = GetVertexInputLayout(m_VertexFormat, &layoutCount);
+    ShaderDesc vsDesc = { "Effects.fx", "VS", "vs_5_0", { layout, layout + layoutCount } };
+    if (!device.CreateVertexShader(vsDesc, &m_VertexShader))
+        return false;
+
+    ShaderDesc psDesc = { "Effects.fx", "PS", "ps_5_0", {} };
+    if (!device.CreatePixelShader(psDesc, &m_PixelShader))
+        return false;
+
+    // Create vertex and index buffers
+    PositionQuantization quantization = ComputePositionQuantization(CubeVertices, std::size(CubeVertices));
+    m_Dequantize = m_VertexFormat == VertexFormat::Float32 ? MatrixIdentity() : quantization.GetDequantizeMatrix();
+    std::vector<uint8_t> vertices(GetVertexStride(m_VertexFormat) * std::size(CubeVertices));
+    EncodeVertices(m_VertexFormat, CubeVertices, std::size(CubeVertices), quantization, vertices.data());
+
+    BufferDesc bd;
+    bd.ByteWidth = static_cast<uint32_t>(vertices.size());
+    bd.Bind = BufferBind::VertexBuffer;
+    if (!device.CreateBuffer(bd, vertices.data(), &m_VertexBuffer))
+        return false;
+
+    bd.ByteWidth = sizeof(CubeIndices);
+    bd.Bind = BufferBind::IndexBuffer;
+    if (!device.CreateBuffer(bd, CubeIndices, &m_IndexBuffer))
+        return false;
+
+    // Create the rasterizer states
+    RasterizerDesc rasterDesc;
+    rasterDesc.Fill = FillMode::Solid;
+    rasterDesc.Cull = CullMode::Back;
+    if (!device.CreateRasterizerState(rasterDesc, &m_RasterizerStateSolid))
+        return false;
+
+    rasterDesc.Fill = FillMode::Wireframe;
+    rasterDesc.Cull = CullMode::None;
+    if (!device.CreateRasterizerState(rasterDesc, &m_RasterizerStateWireframe))
+        return false;
+
+    m_CurrentRasterizerState[0] = m_RasterizerStateSolid;
+    m_CurrentRasterizerState[1] = m_RasterizerStateWireframe;
+
+    // Initialize the view matrix
+    m_View = MatrixLookAtLH({ 0.0f, 3.0f, -8.0f }, { 0.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f });
+
+    Resize(device.GetWidth(), device.GetHeight());
+    return true;
+}
+
+void RenderStatesScene::Resize(uint32_t width, uint32_t height)
+{
+    if (width == 0 || height == 0)
+        return;
+
+    m_Viewport = m_Device->GetDefaultViewport();
+    m_Projection = MatrixPerspectiveFovLH(MathPiDiv2, width / static_cast<float>(height), 0.01f, 100.0f);
+}
+
+void RenderStatesScene::Update(float t)
+{
+    // Rotate the first cube
+    m_Worlds.Set(0, m_Dequantize * MatrixRotationY(t));
+
+    // Rotate the second cube
+    m_Worlds.Set(1, m_Dequantize * MatrixTranslation(4.0f, 0.0f, 0.0f) * MatrixRotationY(-t * 2));
+}
+
+void RenderStatesScene::Draw(RenderContext& context)
+{
+    float clearColor[4] = { 0.0f, 0.125f, 0.3f, 1.0f }; // RGBA
+    context.ClearRenderTarget(clearColor);
+    context.ClearDepthStencil(1.0f, 0);
+    context.SetViewport(m_Viewport);
+
+    context.SetVertexBuffer(0, m_VertexBuffer, GetVertexStride(m_VertexFormat), 0);
+    context.SetIndexBuffer(m_IndexBuffer, CubeIndexFormat, 0);
+
+    // Set shaders
+    context.SetVertexShader(m_VertexShader);
+    context.SetPixelShader(m_PixelShader);
+
+    // View * Projection once, then the transposed WVP of every cube in one batch
+    TransformWorldViewProjection(m_Worlds, m_View * m_Projection, 0, m_Worlds.GetCount(),
+        m_ObjectConstants, sizeof(ConstantBuffer));
+
+    for (int cube = 0; cube < 2; ++cube)
+    {
+        context.SetRasterizerState(m_CurrentRasterizerState[cube]);
+        ConstantBufferRange constants = context.AllocateConstants(&m_ObjectConstants[cube], sizeof(ConstantBuffer));
+        context.SetVSConstantBufferRange(0, constants);
+        context.DrawIndexed(CubeIndexCount, 0, 0);
+    }
+}
+
+void RenderStatesScene::ToggleFillMode(int cube)
+{
+    if (cube < 0 || cube > 1)
+        return;
+
+    m_CurrentRasterizerState[cube] = (m_CurrentRasterizerState[cube].Id == m_RasterizerStateSolid.Id) ?
+        m_RasterizerStateWireframe : m_RasterizerStateSolid;
+}
+
+bool RenderStatesScene::ToggleCulling()
+{
+    for (RasterizerStateHandle& state : m_CurrentRasterizerState)
+    {
+        RasterizerDesc desc;
+        if (!m_Device->GetRasterizerDesc(state, &desc))
+            return false;
+
+        desc.Cull = (desc.Cull == CullMode::Back) ? CullMode::None : CullMode::Back;
+        if (!m_Device->CreateRasterizerState(desc, &state))
+            return false;
+    }
+    return true;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+// "10. Render States": a solid cube spinning in place and a wireframe cube
+// orbiting it, with keys to toggle fill mode per cube and culling for both.
+
+#include "MathUtil.h"
+#include "PackedVertex.h"
+#include "Scene.h"
+#include "TransformBatch.h"
+
+class RenderStatesScene final : public Scene
+{
+public:
+    const char* GetName() const override { return "RenderStates"; }
+
+    // Vertex format of the cube mesh, before Initialize; the compact formats fold the
+    // dequantization into the world matrices
+    void SetVertexFormat(VertexFormat vertexFormat) { m_VertexFormat = vertexFormat; }
+
+    bool Initialize(RenderDevice& device) override;
+    void Resize(uint32_t width, uint32_t height) override;
+    void Update(float t) override;
+    void Draw(RenderContext& context) override;
+
+    // Key '1' / '2': switch one cube between solid and wireframe
+    void ToggleFillMode(int cube);
+    // Key '3': switch both cubes between back-face culling and no culling
+    bool ToggleCulling();
+
+private:
+    struct ConstantBuffer
+    {
+        Float4x4 mWVP;
+    };
+
+    RenderDevice* m_Device = nullptr;
+    VertexFormat m_VertexFormat = VertexFormat::Float32;
+    Float4x4 m_Dequantize = MatrixIdentity();
+    VertexShaderHandle m_VertexShader;
+    PixelShaderHandle m_PixelShader;
+    BufferHandle m_VertexBuffer;
+    BufferHandle m_IndexBuffer;
+    RasterizerStateHandle m_RasterizerStateSolid;
+    RasterizerStateHandle m_RasterizerStateWireframe;
+    RasterizerStateHandle m_CurrentRasterizerState[2];
+
+    WorldMatrixArray m_Worlds{ 2 };
+    ConstantBuffer m_ObjectConstants[2];
+    Float4x4 m_View = MatrixIdentity();
+    Float4x4 m_Projection = MatrixIdentity();
+    Viewport m_Viewport;
+};
@@ -0,0 +1,185 @@
+#pragma once
+
+// Backend-neutral descriptions shared by every RenderDevice implementation.
+// The names and fields follow the D3D11 structures they stand in for so the
+// D3D11 backend can translate them one to one.
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Subset of DXGI_FORMAT used for vertex and index data
+enum class Format
+{
+    Unknown,
+    R32G32B32Float,
+    R32G32B32A32Float,
+    R16G16B16A16SNorm,
+    R16G16B16A16Float,
+    R16G16SNorm,
+    R8G8B8A8UNorm,
+    R16UInt,
+    R32UInt,
+};
+
+inline uint32_t GetFormatSize(Format format)
+{
+    switch (format)
+    {
+    case Format::R32G32B32Float: return 12;
+    case Format::R32G32B32A32Float: return 16;
+    case Format::R16G16B16A16SNorm: return 8;
+    case Format::R16G16B16A16Float: return 8;
+    case Format::R16G16SNorm: return 4;
+    case Format::R8G8B8A8UNorm: return 4;
+    case Format::R16UInt: return 2;
+    case Format::R32UInt: return 4;
+    default: return 0;
+    }
+}
+
+enum class BufferBind
+{
+    VertexBuffer,
+    IndexBuffer,
+    ConstantBuffer,
+};
+
+// Matches D3D11_USAGE; Dynamic buffers are written by the CPU every frame
+enum class BufferUsage
+{
+    Default,
+    Immutable,
+    Dynamic,
+};
+
+struct BufferDesc
+{
+    uint32_t ByteWidth = 0;
+    BufferBind Bind = BufferBind::VertexBuffer;
+    BufferUsage Usage = BufferUsage::Default;
+};
+
+// Matches D3D11_INPUT_ELEMENT_DESC
+struct InputElementDesc
+{
+    const char* SemanticName;
+    uint32_t SemanticIndex;
+    Format ElementFormat;
+    uint32_t InputSlot;
+    uint32_t AlignedByteOffset;
+    bool PerInstance;
+    uint32_t InstanceDataStepRate;
+};
+
+// Preprocessor macro passed to the shader compiler (D3D_SHADER_MACRO)
+struct ShaderDefine
+{
+    std::string Name;
+    std::string Value;
+};
+
+// A shader entry point in an .fx/.hlsl file, e.g. { "Effects.fx", "VS", "vs_5_0" }
+struct ShaderDesc
+{
+    std::string FileName;
+    std::string EntryPoint;
+    std::string Profile;
+    // Only used for vertex shaders
+    std::vector<InputElementDesc> InputLayout;
+    std::vector<ShaderDefine> Defines = {};
+    // D3DCOMPILE_* flags
+    uint32_t CompileFlags = 0;
+};
+
+enum class FillMode
+{
+    Wireframe,
+    Solid,
+};
+
+enum class CullMode
+{
+    None,
+    Front,
+    Back,
+};
+
+// Matches the fields of D3D11_RASTERIZER_DESC the tutorials set
+struct RasterizerDesc
+{
+    FillMode Fill = FillMode::Solid;
+    CullMode Cull = CullMode::Back;
+    bool FrontCounterClockwise = false;
+    bool DepthClipEnable = true;
+};
+
+// Matches D3D11_VIEWPORT
+struct Viewport
+{
+    float TopLeftX = 0.0f;
+    float TopLeftY = 0.0f;
+    float Width = 0.0f;
+    float Height = 0.0f;
+    float MinDepth = 0.0f;
+    float MaxDepth = 1.0f;
+};
+
+// Handles are indices into the owning device's resource tables; 0 is never a valid handle
+struct BufferHandle
+{
+    uint32_t Id = 0;
+    explicit operator bool() const { return Id != 0; }
+};
+
+struct VertexShaderHandle
+{
+    uint32_t Id = 0;
+    explicit operator bool() const { return Id != 0; }
+};
+
+struct PixelShaderHandle
+{
+    uint32_t Id = 0;
+    explicit operator bool() const { return Id != 0; }
+};
+
+struct RasterizerStateHandle
+{
+    uint32_t Id = 0;
+    explicit operator bool() const { return Id != 0; }
+};
+
+// Largest constant buffer a shader can see (4096 float4 constants)
+constexpr uint32_t MaxConstantBufferSize = 65536;
+
+// Window of a constant buffer returned by RenderContext::AllocateConstants
+struct ConstantBufferRange
+{
+    BufferHandle Buffer;
+    uint32_t Offset = 0;    // Bytes, multiple of 256
+    uint32_t Size = 0;      // Bytes, multiple of 256
+    explicit operator bool() const { return static_cast<bool>(Buffer); }
+};
+
+// Work submitted through a RenderContext, reset with RenderContext::ResetStats()
+struct RenderStats
+{
+    uint64_t Draws = 0;
+    uint64_t Indices = 0;
+    uint64_t Instances = 0;
+    uint64_t StateChanges = 0;
+    uint64_t BufferUpdates = 0;
+    uint64_t BytesUploaded = 0;
+};
+
+inline RenderStats& operator+=(RenderStats& total, const RenderStats& stats)
+{
+    total.Draws += stats.Draws;
+    total.Indices += stats.Indices;
+    total.Instances += stats.Instances;
+    total.StateChanges += stats.StateChanges;
+    total.BufferUpdates += stats.BufferUpdates;
+    total.BytesUploaded += stats.BytesUploaded;
+    return total;
+}
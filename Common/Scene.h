@@ -0,0 +1,27 @@
+#pragma once
+
+// A tutorial scene written against RenderDevice instead of global D3D11 objects.
+// The window loop (or a benchmark) calls Initialize once, then Update and Draw
+// every frame, and finally RenderDevice::Present.
+
+#include "RenderDevice.h"
+
+class Scene
+{
+public:
+    virtual ~Scene() = default;
+
+    virtual const char* GetName() const = 0;
+
+    // InitializeScene(): creates shaders, buffers and states
+    virtual bool Initialize(RenderDevice& device) = 0;
+
+    // Called after RenderDevice::Resize so the projection matches the new aspect ratio
+    virtual void Resize(uint32_t width, uint32_t height) = 0;
+
+    // UpdateScene(): t is the time in seconds since the scene started
+    virtual void Update(float t) = 0;
+
+    // DrawScene() without the Present
+    virtual void Draw(RenderContext& context) = 0;
+};
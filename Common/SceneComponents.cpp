@@ -0,0 +1,93 @@
+#include "SceneComponents.h"
+
+#include <cmath>
+
+SceneComponentIds RegisterSceneComponents(EntityStore& store)
+{
+    SceneComponentIds ids;
+    ids.Transform = store.RegisterComponent<TransformComponent>();
+    ids.World = store.RegisterComponent<WorldComponent>();
+    ids.Bounds = store.RegisterComponent<BoundsComponent>();
+    ids.Mesh = store.RegisterComponent<MeshComponent>();
+    ids.RenderState = store.RegisterComponent<RenderStateComponent>();
+    ids.Animation = store.RegisterComponent<AnimationComponent>();
+    return ids;
+}
+
+namespace
+{
+    void AnimateChunk(const EntityChunk& chunk, const SceneComponentIds& ids, float dt)
+    {
+        TransformComponent* transforms = chunk.Get<TransformComponent>(ids.Transform);
+        AnimationComponent* animations = chunk.Get<AnimationComponent>(ids.Animation);
+        for (uint32_t i = 0; i < chunk.GetCount(); ++i)
+        {
+            AnimationComponent& animation = animations[i];
+            animation.Angle = std::fmod(animation.Angle + animation.Speed * dt, MathTwoPi);
+            transforms[i].Rotation = QuaternionRotationAxis(animation.Axis, animation.Angle);
+        }
+    }
+
+    void UpdateWorldMatricesChunk(const EntityChunk& chunk, const SceneComponentIds& ids)
+    {
+        const TransformComponent* transforms = chunk.Get<TransformComponent>(ids.Transform);
+        WorldComponent* worlds = chunk.Get<WorldComponent>(ids.World);
+        for (uint32_t i = 0; i < chunk.GetCount(); ++i)
+        {
+            const TransformComponent& t = transforms[i];
+            worlds[i].World = MatrixScaleRotationTranslation(t.Scale, t.Rotation, t.Position);
+        }
+    }
+
+    void UpdateWorldBoundsChunk(const EntityChunk& chunk, const SceneComponentIds& ids)
+    {
+        const WorldComponent* worlds = chunk.Get<WorldComponent>(ids.World);
+        const MeshComponent* meshes = chunk.Get<MeshComponent>(ids.Mesh);
+        BoundsComponent* bounds = chunk.Get<BoundsComponent>(ids.Bounds);
+        for (uint32_t i = 0; i < chunk.GetCount(); ++i)
+            BoxTransform(meshes[i].Center, meshes[i].Extents, worlds[i].World, &bounds[i].Center, &bounds[i].Extents);
+    }
+}
+
+void AnimateRotations(EntityStore& store, JobSystem* jobSystem, const SceneComponentIds& ids, float dt)
+{
+    ComponentMask required = ComponentBit(ids.Transform) | ComponentBit(ids.Animation);
+    store.ForEachChunk(jobSystem, required, [&](const EntityChunk& chunk, unsigned int)
+    {
+        AnimateChunk(chunk, ids, dt);
+    });
+}
+
+void UpdateWorldMatrices(EntityStore& store, JobSystem* jobSystem, const SceneComponentIds& ids)
+{
+    ComponentMask required = ComponentBit(ids.Transform) | ComponentBit(ids.World);
+    store.ForEachChunk(jobSystem, required, [&](const EntityChunk& chunk, unsigned int)
+    {
+        UpdateWorldMatricesChunk(chunk, ids);
+    });
+}
+
+void UpdateWorldBounds(EntityStore& store, JobSystem* jobSystem, const SceneComponentIds& ids)
+{
+    ComponentMask required = ComponentBit(ids.World) | ComponentBit(ids.Mesh) | ComponentBit(ids.Bounds);
+    store.ForEachChunk(jobSystem, required, [&](const EntityChunk& chunk, unsigned int)
+    {
+        UpdateWorldBoundsChunk(chunk, ids);
+    });
+}
+
+void UpdateScene(EntityStore& store, JobSystem* jobSystem, const SceneComponentIds& ids, float dt)
+{
+    // Every chunk any of the three systems visits, run through the steps whose components it
+    // has while it is in cache. Static objects have bounds but no transform, so the walk
+    // cannot require one.
+    store.ForEachChunk(jobSystem, 0, [&](const EntityChunk& chunk, unsigned int)
+    {
+        if (chunk.Has(ids.Transform) && chunk.Has(ids.Animation))
+            AnimateChunk(chunk, ids, dt);
+        if (chunk.Has(ids.Transform) && chunk.Has(ids.World))
+            UpdateWorldMatricesChunk(chunk, ids);
+        if (chunk.Has(ids.World) && chunk.Has(ids.Mesh) && chunk.Has(ids.Bounds))
+            UpdateWorldBoundsChunk(chunk, ids);
+    });
+}
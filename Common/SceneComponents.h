@@ -0,0 +1,81 @@
+#pragma once
+
+// The components of a drawable scene object in an EntityStore, and the systems
+// that update them once per frame. Each system walks the chunks that have its
+// components, in parallel when given a JobSystem. UpdateScene runs all of them
+// chunk by chunk instead, so each 16 KB chunk is loaded from memory once per
+// frame rather than once per system.
+
+#include <cstdint>
+
+#include "EntityStore.h"
+#include "MathUtil.h"
+
+// Local transform, applied as scale, then rotation (unit quaternion), then translation
+struct TransformComponent
+{
+    Float3 Position;
+    Float4 Rotation;
+    Float3 Scale;
+};
+
+struct WorldComponent
+{
+    Float4x4 World;
+};
+
+// World-space box as center and half extents, for culling
+struct BoundsComponent
+{
+    Float3 Center;
+    Float3 Extents;
+};
+
+// Geometry to draw and its local-space box
+struct MeshComponent
+{
+    uint32_t Mesh;
+    uint32_t IndexCount;
+    Float3 Center;
+    Float3 Extents;
+};
+
+// Ids as passed to MakeDrawKey
+struct RenderStateComponent
+{
+    uint32_t Pass;
+    uint32_t Shader;
+    uint32_t RasterizerState;
+};
+
+// Spin about a unit axis, in radians per second
+struct AnimationComponent
+{
+    Float3 Axis;
+    float Speed;
+    float Angle;
+};
+
+struct SceneComponentIds
+{
+    uint32_t Transform;
+    uint32_t World;
+    uint32_t Bounds;
+    uint32_t Mesh;
+    uint32_t RenderState;
+    uint32_t Animation;
+};
+
+SceneComponentIds RegisterSceneComponents(EntityStore& store);
+
+// Advances Angle by Speed * dt and sets the rotation of the transform to it
+void AnimateRotations(EntityStore& store, JobSystem* jobSystem, const SceneComponentIds& ids, float dt);
+
+// World = the local transform, for entities with a transform and a world matrix
+void UpdateWorldMatrices(EntityStore& store, JobSystem* jobSystem, const SceneComponentIds& ids);
+
+// Box around the mesh's local box transformed by the world matrix
+void UpdateWorldBounds(EntityStore& store, JobSystem* jobSystem, const SceneComponentIds& ids);
+
+// AnimateRotations, UpdateWorldMatrices and UpdateWorldBounds in one walk over the chunks
+void UpdateScene(EntityStore& store, JobSystem* jobSystem, const SceneComponentIds& ids, float dt);
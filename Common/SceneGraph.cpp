@@ -0,0 +1,247 @@
+#include "SceneGraph.h"
+
+#include <algorithm>
+
+namespace
+{
+    template <typename T>
+    void Permute(std::vector<T>& values, const std::vector<uint32_t>& order)
+    {
+        std::vector<T> result(values.size());
+        for (size_t i = 0; i < order.size(); ++i)
+            result[i] = values[order[i]];
+        values.swap(result);
+    }
+}
+
+uint32_t SceneGraph::CreateNode(uint32_t parent)
+{
+    uint32_t node = static_cast<uint32_t>(m_Slots.size());
+    uint32_t slot = static_cast<uint32_t>(m_Order.size());
+    m_Parents.push_back(parent == NoNode ? NoNode : m_Slots[parent]);
+    m_Positions.push_back({ 0.0f, 0.0f, 0.0f });
+    m_Rotations.push_back({ 0.0f, 0.0f, 0.0f, 1.0f });
+    m_Scales.push_back({ 1.0f, 1.0f, 1.0f });
+    m_Worlds.push_back(MatrixIdentity());
+    m_Dirty.push_back(0);
+    m_Order.push_back(node);
+    m_Slots.push_back(slot);
+    m_LayoutDirty = true;
+    MarkDirty(slot);
+    return node;
+}
+
+bool SceneGraph::SetParent(uint32_t node, uint32_t parent)
+{
+    uint32_t slot = m_Slots[node];
+    uint32_t parentSlot = parent == NoNode ? NoNode : m_Slots[parent];
+    for (uint32_t ancestor = parentSlot; ancestor != NoNode; ancestor = m_Parents[ancestor])
+    {
+        if (ancestor == slot)
+            return false;
+    }
+
+    if (m_Parents[slot] != parentSlot)
+    {
+        m_Parents[slot] = parentSlot;
+        m_LayoutDirty = true;
+        MarkDirty(slot);
+    }
+    return true;
+}
+
+uint32_t SceneGraph::GetParent(uint32_t node) const
+{
+    uint32_t parentSlot = m_Parents[m_Slots[node]];
+    return parentSlot == NoNode ? NoNode : m_Order[parentSlot];
+}
+
+void SceneGraph::SetLocalPosition(uint32_t node, const Float3& position)
+{
+    uint32_t slot = m_Slots[node];
+    m_Positions[slot] = position;
+    MarkDirty(slot);
+}
+
+void SceneGraph::SetLocalRotation(uint32_t node, const Float4& rotation)
+{
+    uint32_t slot = m_Slots[node];
+    m_Rotations[slot] = rotation;
+    MarkDirty(slot);
+}
+
+void SceneGraph::SetLocalScale(uint32_t node, const Float3& scale)
+{
+    uint32_t slot = m_Slots[node];
+    m_Scales[slot] = scale;
+    MarkDirty(slot);
+}
+
+void SceneGraph::SetLocalTransform(uint32_t node, const Float3& position, const Float4& rotation, const Float3& scale)
+{
+    uint32_t slot = m_Slots[node];
+    m_Positions[slot] = position;
+    m_Rotations[slot] = rotation;
+    m_Scales[slot] = scale;
+    MarkDirty(slot);
+}
+
+void SceneGraph::MarkDirty(uint32_t slot)
+{
+    if (!m_Dirty[slot])
+    {
+        m_Dirty[slot] = 1;
+        m_DirtySlots.push_back(slot);
+    }
+}
+
+size_t SceneGraph::Update()
+{
+    if (m_LayoutDirty)
+        Relayout();
+    if (m_DirtySlots.empty())
+        return 0;
+
+    // Consecutive or overlapping ranges are walked as one
+    auto append = [](std::vector<Range>& ranges, Range range)
+    {
+        if (range.Begin == range.End)
+            return;
+        if (!ranges.empty() && ranges.back().End >= range.Begin)
+            ranges.back().End = std::max(ranges.back().End, range.End);
+        else
+            ranges.push_back(range);
+    };
+
+    // Level by level, the nodes marked on it joined with the children of the ranges updated above it
+    // When much of the graph is dirty a scan of the flags is cheaper than sorting
+    if (m_DirtySlots.size() > m_Dirty.size() / 32)
+    {
+        m_DirtySlots.clear();
+        for (uint32_t slot = 0; slot < m_Dirty.size(); ++slot)
+        {
+            if (m_Dirty[slot])
+                m_DirtySlots.push_back(slot);
+        }
+    }
+    else
+    {
+        std::sort(m_DirtySlots.begin(), m_DirtySlots.end());
+    }
+    size_t nextDirty = 0;
+    size_t updated = 0;
+    m_Ranges.clear();
+    for (size_t level = 0; level + 1 < m_LevelStarts.size(); ++level)
+    {
+        if (m_Ranges.empty() && nextDirty == m_DirtySlots.size())
+            break;
+
+        uint32_t levelEnd = m_LevelStarts[level + 1];
+        size_t inherited = 0;
+        m_LevelRanges.clear();
+        for (;;)
+        {
+            bool hasDirty = nextDirty < m_DirtySlots.size() && m_DirtySlots[nextDirty] < levelEnd;
+            bool hasInherited = inherited < m_Ranges.size();
+            if (!hasDirty && !hasInherited)
+                break;
+            if (hasDirty && (!hasInherited || m_DirtySlots[nextDirty] < m_Ranges[inherited].Begin))
+            {
+                append(m_LevelRanges, { m_DirtySlots[nextDirty], m_DirtySlots[nextDirty] + 1 });
+                ++nextDirty;
+            }
+            else
+            {
+                append(m_LevelRanges, m_Ranges[inherited++]);
+            }
+        }
+
+        // The children of consecutive nodes are consecutive, so each range has one range of children
+        m_Ranges.clear();
+        for (const Range& range : m_LevelRanges)
+        {
+            for (uint32_t slot = range.Begin; slot < range.End; ++slot)
+            {
+                Float4x4 local = MatrixScaleRotationTranslation(m_Scales[slot], m_Rotations[slot], m_Positions[slot]);
+                uint32_t parent = m_Parents[slot];
+                m_Worlds[slot] = parent == NoNode ? local : local * m_Worlds[parent];
+                m_Dirty[slot] = 0;
+            }
+            updated += range.End - range.Begin;
+            append(m_Ranges, { m_FirstChildren[range.Begin], m_FirstChildren[range.End] });
+        }
+    }
+    m_DirtySlots.clear();
+    return updated;
+}
+
+void SceneGraph::Relayout()
+{
+    uint32_t count = static_cast<uint32_t>(m_Slots.size());
+
+    // Children of every slot, grouped by parent and kept in slot order
+    std::vector<uint32_t> childStarts(count + 1, 0);
+    for (uint32_t slot = 0; slot < count; ++slot)
+    {
+        if (m_Parents[slot] != NoNode)
+            ++childStarts[m_Parents[slot] + 1];
+    }
+    for (uint32_t slot = 0; slot < count; ++slot)
+        childStarts[slot + 1] += childStarts[slot];
+    std::vector<uint32_t> children(childStarts[count]);
+    std::vector<uint32_t> cursors(childStarts.begin(), childStarts.end() - 1);
+    for (uint32_t slot = 0; slot < count; ++slot)
+    {
+        if (m_Parents[slot] != NoNode)
+            children[cursors[m_Parents[slot]]++] = slot;
+    }
+
+    // Breadth-first: the roots, then the children of each node in turn; a level ends where the
+    // nodes queued while walking the previous one end
+    std::vector<uint32_t> order;
+    order.reserve(count);
+    for (uint32_t slot = 0; slot < count; ++slot)
+    {
+        if (m_Parents[slot] == NoNode)
+            order.push_back(slot);
+    }
+    m_FirstChildren.resize(count + 1);
+    m_LevelStarts.assign(1, 0);
+    size_t levelEnd = order.size();
+    for (size_t i = 0; i < order.size(); ++i)
+    {
+        if (i == levelEnd)
+        {
+            m_LevelStarts.push_back(static_cast<uint32_t>(i));
+            levelEnd = order.size();
+        }
+        uint32_t slot = order[i];
+        m_FirstChildren[i] = static_cast<uint32_t>(order.size());
+        order.insert(order.end(), children.begin() + childStarts[slot], children.begin() + childStarts[slot + 1]);
+    }
+    m_FirstChildren[count] = count;
+    m_LevelStarts.push_back(count);
+
+    std::vector<uint32_t> newSlots(count);
+    for (uint32_t i = 0; i < count; ++i)
+        newSlots[order[i]] = i;
+    Permute(m_Parents, order);
+    for (uint32_t& parent : m_Parents)
+        parent = parent == NoNode ? NoNode : newSlots[parent];
+    Permute(m_Positions, order);
+    Permute(m_Rotations, order);
+    Permute(m_Scales, order);
+    Permute(m_Worlds, order);
+    Permute(m_Dirty, order);
+    Permute(m_Order, order);
+    for (uint32_t i = 0; i < count; ++i)
+        m_Slots[m_Order[i]] = i;
+
+    m_DirtySlots.clear();
+    for (uint32_t slot = 0; slot < count; ++slot)
+    {
+        if (m_Dirty[slot])
+            m_DirtySlots.push_back(slot);
+    }
+    m_LayoutDirty = false;
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+// Transform hierarchy for scenes like "09. Transformations", whose cubes are
+// placed by chains of scalings, rotations, translations and orbits. Each node
+// has a position, rotation (unit quaternion) and scale relative to its parent,
+// and a cached world matrix: Scale * Rotation * Translation * parent's world,
+// in MathUtil's row-vector convention. Setting a local transform only marks
+// the node dirty. Update then recomputes the dirty nodes and their descendants
+// and nothing else, so subtrees that do not move cost nothing per frame.
+//
+// Nodes are kept in breadth-first order, where the children of consecutive
+// nodes are consecutive too. Update walks one level at a time over a few
+// contiguous ranges instead of following child pointers. The order is rebuilt
+// by the first Update after nodes are added or moved; handles stay valid.
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "MathUtil.h"
+
+class SceneGraph
+{
+public:
+    static constexpr uint32_t NoNode = ~0u;
+
+    // Adds a node with an identity transform under parent (NoNode for a root) and returns its handle
+    uint32_t CreateNode(uint32_t parent = NoNode);
+    // Moves the node and its subtree under parent; false if parent is the node or one of its descendants
+    bool SetParent(uint32_t node, uint32_t parent);
+    uint32_t GetParent(uint32_t node) const;
+
+    void SetLocalPosition(uint32_t node, const Float3& position);
+    void SetLocalRotation(uint32_t node, const Float4& rotation);
+    void SetLocalScale(uint32_t node, const Float3& scale);
+    void SetLocalTransform(uint32_t node, const Float3& position, const Float4& rotation, const Float3& scale);
+    const Float3& GetLocalPosition(uint32_t node) const { return m_Positions[m_Slots[node]]; }
+    const Float4& GetLocalRotation(uint32_t node) const { return m_Rotations[m_Slots[node]]; }
+    const Float3& GetLocalScale(uint32_t node) const { return m_Scales[m_Slots[node]]; }
+
+    // Recomputes the world matrices of dirty nodes and their descendants; returns how many
+    size_t Update();
+
+    // As of the last Update
+    const Float4x4& GetWorld(uint32_t node) const { return m_Worlds[m_Slots[node]]; }
+
+    size_t GetNodeCount() const { return m_Slots.size(); }
+    // Handles in breadth-first order and where each level starts in it, as of the last Update
+    const std::vector<uint32_t>& GetOrder() const { return m_Order; }
+    const std::vector<uint32_t>& GetLevelStarts() const { return m_LevelStarts; }
+
+private:
+    struct Range
+    {
+        uint32_t Begin;
+        uint32_t End;
+    };
+
+    void MarkDirty(uint32_t slot);
+    void Relayout();
+
+    // Per node by slot: breadth-first order after an Update, new nodes appended until the next one
+    std::vector<uint32_t> m_Parents;        // Slot of the parent, NoNode for roots
+    std::vector<uint32_t> m_FirstChildren;  // Children of slot i are [m_FirstChildren[i], m_FirstChildren[i + 1])
+    std::vector<Float3> m_Positions;
+    std::vector<Float4> m_Rotations;
+    std::vector<Float3> m_Scales;
+    std::vector<Float4x4> m_Worlds;
+    std::vector<uint8_t> m_Dirty;
+    std::vector<uint32_t> m_Order;          // Slot to handle
+    std::vector<uint32_t> m_Slots;          // Handle to slot
+    std::vector<uint32_t> m_LevelStarts;    // Level count + 1 entries, the last one the node count
+    bool m_LayoutDirty = false;
+
+    std::vector<uint32_t> m_DirtySlots;
+    std::vector<Range> m_Ranges;
+    std::vector<Range> m_LevelRanges;
+};
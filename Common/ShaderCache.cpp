@@ -0,0 +1,326 @@
+#include "ShaderCache.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+#include "Hash.h"
+
+namespace
+{
+    constexpr char FileMagic[8] = { 'S', 'H', 'C', 'A', 'C', 'H', 'E', '1' };
+
+    struct FileHeader
+    {
+        char Magic[8];
+        uint32_t Version;
+        uint32_t EntryCount;
+        uint64_t IndexOffset;
+        uint32_t DependencyCount;
+        uint32_t StringBytes;
+        uint64_t FileSize;
+    };
+
+    struct FileEntry
+    {
+        uint64_t Key;
+        uint64_t BlobOffset;
+        uint32_t BlobSize;
+        uint32_t FirstDependency;
+        uint32_t DependencyCount;
+        uint32_t Reserved;
+    };
+
+    struct FileDependency
+    {
+        uint64_t ContentHash;
+        uint32_t PathOffset;
+        uint32_t PathLength;
+    };
+
+    static_assert(sizeof(FileHeader) == 40 && sizeof(FileEntry) == 32 && sizeof(FileDependency) == 16,
+        "The cache file layout must not depend on the compiler's padding");
+
+    uint64_t AlignOffset(uint64_t offset, uint64_t alignment)
+    {
+        return (offset + alignment - 1) / alignment * alignment;
+    }
+
+    // Includes resolve relative to the source file, so the same text in another
+    // directory may pull in different headers
+    std::string GetDirectory(const std::string& path)
+    {
+        size_t slash = path.find_last_of("/\\");
+        return slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+    }
+
+    bool HashFile(const std::string& path, uint64_t* hash)
+    {
+        std::string text;
+        if (!ReadTextFile(path, &text))
+            return false;
+        *hash = HashBytes(text.data(), text.size());
+        return true;
+    }
+}
+
+bool ReadTextFile(const std::string& path, std::string* text)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        return false;
+    text->assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return !file.bad();
+}
+
+ShaderCache::ShaderCache(std::string path)
+    : m_Path(std::move(path))
+{
+}
+
+uint64_t ShaderCache::ComputeKey(const ShaderDesc& desc, uint64_t sourceHash, const std::string& compilerVersion)
+{
+    uint64_t hash = HashString(compilerVersion);
+    hash = HashValue(sourceHash, hash);
+    hash = HashString(GetDirectory(desc.FileName), hash);
+    hash = HashString(desc.EntryPoint, hash);
+    hash = HashString(desc.Profile, hash);
+    hash = HashValue(desc.CompileFlags, hash);
+    hash = HashValue(static_cast<uint64_t>(desc.Defines.size()), hash);
+    for (const ShaderDefine& define : desc.Defines)
+    {
+        hash = HashString(define.Name, hash);
+        hash = HashString(define.Value, hash);
+    }
+    return hash;
+}
+
+void ShaderCache::Clear()
+{
+    m_Entries.clear();
+    m_File.Close();
+    m_Dirty = false;
+}
+
+bool ShaderCache::Load()
+{
+    Clear();
+    if (!m_File.Open(m_Path))
+        return false;
+
+    const uint8_t* data = m_File.GetData();
+    uint64_t size = m_File.GetSize();
+
+    FileHeader header;
+    if (size < sizeof(header))
+    {
+        Clear();
+        return false;
+    }
+    std::memcpy(&header, data, sizeof(header));
+
+    uint64_t indexBytes = uint64_t(header.EntryCount) * sizeof(FileEntry);
+    uint64_t dependencyBytes = uint64_t(header.DependencyCount) * sizeof(FileDependency);
+    bool valid = std::memcmp(header.Magic, FileMagic, sizeof(FileMagic)) == 0 && header.Version == FileVersion &&
+        header.FileSize == size && header.IndexOffset >= sizeof(header) && header.IndexOffset <= size &&
+        indexBytes + dependencyBytes + header.StringBytes <= size - header.IndexOffset;
+    if (!valid)
+    {
+        Clear();
+        return false;
+    }
+
+    const uint8_t* index = data + header.IndexOffset;
+    const uint8_t* dependencies = index + indexBytes;
+    const char* strings = reinterpret_cast<const char*>(dependencies + dependencyBytes);
+
+    m_Entries.reserve(header.EntryCount);
+    for (uint32_t i = 0; i < header.EntryCount; ++i)
+    {
+        FileEntry fileEntry;
+        std::memcpy(&fileEntry, index + i * sizeof(FileEntry), sizeof(fileEntry));
+        if (fileEntry.BlobOffset < sizeof(header) || fileEntry.BlobOffset > header.IndexOffset ||
+            fileEntry.BlobSize > header.IndexOffset - fileEntry.BlobOffset ||
+            fileEntry.FirstDependency > header.DependencyCount ||
+            fileEntry.DependencyCount > header.DependencyCount - fileEntry.FirstDependency)
+        {
+            Clear();
+            return false;
+        }
+
+        Entry entry;
+        entry.Data = data + fileEntry.BlobOffset;
+        entry.Size = fileEntry.BlobSize;
+        for (uint32_t d = 0; d < fileEntry.DependencyCount; ++d)
+        {
+            FileDependency fileDependency;
+            std::memcpy(&fileDependency, dependencies + (fileEntry.FirstDependency + d) * sizeof(FileDependency),
+                sizeof(fileDependency));
+            if (fileDependency.PathOffset > header.StringBytes ||
+                fileDependency.PathLength > header.StringBytes - fileDependency.PathOffset)
+            {
+                Clear();
+                return false;
+            }
+            entry.Dependencies.push_back(
+                { std::string(strings + fileDependency.PathOffset, fileDependency.PathLength), fileDependency.ContentHash });
+        }
+        m_Entries.emplace(fileEntry.Key, std::move(entry));
+    }
+    return true;
+}
+
+bool ShaderCache::DependenciesUnchanged(const Entry& entry) const
+{
+    for (const Dependency& dependency : entry.Dependencies)
+    {
+        uint64_t hash = 0;
+        if (!HashFile(dependency.Path, &hash) || hash != dependency.ContentHash)
+            return false;
+    }
+    return true;
+}
+
+bool ShaderCache::GetBytecode(const ShaderDesc& desc, ShaderCompiler& compiler, ShaderBytecode* bytecode)
+{
+    if (!bytecode)
+        return false;
+
+    std::string source;
+    if (!ReadTextFile(desc.FileName, &source))
+        return false;
+
+    std::string compilerVersion = compiler.GetVersion();
+    uint64_t key = ComputeKey(desc, HashBytes(source.data(), source.size()), compilerVersion);
+
+    auto found = m_Entries.find(key);
+    if (found != m_Entries.end())
+    {
+        if (DependenciesUnchanged(found->second))
+        {
+            ++m_Stats.Hits;
+            *bytecode = { found->second.Data, found->second.Size };
+            return true;
+        }
+        ++m_Stats.Invalidations;
+    }
+    ++m_Stats.Misses;
+
+    Entry entry;
+    std::vector<std::string> includes;
+    std::string errors;
+    auto start = std::chrono::steady_clock::now();
+    bool compiled = compiler.Compile(desc, source, &entry.Bytecode, &includes, &errors);
+    m_Stats.CompileMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    if (!compiled)
+    {
+        ++m_Stats.CompileFailures;
+        std::fprintf(stderr, "%s(%s): %s\n", desc.FileName.c_str(), desc.EntryPoint.c_str(), errors.c_str());
+        return false;
+    }
+
+    std::sort(includes.begin(), includes.end());
+    includes.erase(std::unique(includes.begin(), includes.end()), includes.end());
+    for (const std::string& include : includes)
+    {
+        Dependency dependency;
+        dependency.Path = include;
+        if (!HashFile(include, &dependency.ContentHash))
+            return false;
+        entry.Dependencies.push_back(std::move(dependency));
+    }
+
+    entry.Data = entry.Bytecode.data();
+    entry.Size = entry.Bytecode.size();
+    Entry& stored = m_Entries.insert_or_assign(key, std::move(entry)).first->second;
+    m_Dirty = true;
+
+    *bytecode = { stored.Data, stored.Size };
+    return true;
+}
+
+bool ShaderCache::Save()
+{
+    if (!m_Dirty)
+        return true;
+
+    std::vector<uint64_t> keys;
+    keys.reserve(m_Entries.size());
+    for (const auto& [key, entry] : m_Entries)
+        keys.push_back(key);
+    std::sort(keys.begin(), keys.end());
+
+    // Lay out blobs first, then the index, dependencies and strings
+    std::vector<FileEntry> index;
+    std::vector<FileDependency> dependencies;
+    std::string strings;
+    uint64_t offset = AlignOffset(sizeof(FileHeader), BlobAlignment);
+    for (uint64_t key : keys)
+    {
+        const Entry& entry = m_Entries.at(key);
+        FileEntry fileEntry = {};
+        fileEntry.Key = key;
+        fileEntry.BlobOffset = offset;
+        fileEntry.BlobSize = static_cast<uint32_t>(entry.Size);
+        fileEntry.FirstDependency = static_cast<uint32_t>(dependencies.size());
+        fileEntry.DependencyCount = static_cast<uint32_t>(entry.Dependencies.size());
+        for (const Dependency& dependency : entry.Dependencies)
+        {
+            dependencies.push_back({ dependency.ContentHash, static_cast<uint32_t>(strings.size()),
+                static_cast<uint32_t>(dependency.Path.size()) });
+            strings += dependency.Path;
+        }
+        index.push_back(fileEntry);
+        offset = AlignOffset(offset + entry.Size, BlobAlignment);
+    }
+
+    FileHeader header = {};
+    std::memcpy(header.Magic, FileMagic, sizeof(FileMagic));
+    header.Version = FileVersion;
+    header.EntryCount = static_cast<uint32_t>(index.size());
+    header.IndexOffset = offset;
+    header.DependencyCount = static_cast<uint32_t>(dependencies.size());
+    header.StringBytes = static_cast<uint32_t>(strings.size());
+    header.FileSize = offset + index.size() * sizeof(FileEntry) + dependencies.size() * sizeof(FileDependency) +
+        strings.size();
+
+    std::vector<uint8_t> file(header.FileSize, 0);
+    std::memcpy(file.data(), &header, sizeof(header));
+    for (const FileEntry& fileEntry : index)
+        std::memcpy(file.data() + fileEntry.BlobOffset, m_Entries.at(fileEntry.Key).Data, fileEntry.BlobSize);
+    uint8_t* tail = file.data() + offset;
+    if (!index.empty())
+        std::memcpy(tail, index.data(), index.size() * sizeof(FileEntry));
+    tail += index.size() * sizeof(FileEntry);
+    if (!dependencies.empty())
+        std::memcpy(tail, dependencies.data(), dependencies.size() * sizeof(FileDependency));
+    tail += dependencies.size() * sizeof(FileDependency);
+    if (!strings.empty())
+        std::memcpy(tail, strings.data(), strings.size());
+
+    // Write beside the cache and rename over it, so a crash never leaves half a file behind
+    std::string tempPath = m_Path + ".tmp";
+    {
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        if (!out.write(reinterpret_cast<const char*>(file.data()), static_cast<std::streamsize>(file.size())))
+            return false;
+    }
+
+    // Windows cannot replace a file that is still mapped
+    m_Entries.clear();
+    m_File.Close();
+
+    std::error_code error;
+    std::filesystem::rename(tempPath, m_Path, error);
+    if (error)
+    {
+        std::filesystem::remove(tempPath, error);
+        Load();
+        return false;
+    }
+    return Load();
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+// Persistent cache of compiled shader bytecode. Every tutorial recompiles
+// Effects.fx with D3DCompileFromFile on each start; with a cache only the
+// first run pays for the compiler, later runs map the cache file and hand
+// the bytecode straight to CreateVertexShader / CreatePixelShader.
+//
+// An entry is keyed by the source text, its directory, entry point, profile,
+// defines, compile flags and the compiler version. The files the compiler
+// pulled in through #include are stored with the hash of their contents and
+// re-checked on every hit, so editing an include recompiles the shader.
+//
+// File layout (little endian, see ShaderCache.cpp):
+//   header | bytecode blobs (16-byte aligned) | index sorted by key | dependencies | path strings
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "MappedFile.h"
+#include "RenderTypes.h"
+
+// Compiles one entry point. D3D11RenderDevice wraps D3DCompile; the benchmark
+// uses a stand-in so the cache can be exercised without the D3D compiler.
+class ShaderCompiler
+{
+public:
+    virtual ~ShaderCompiler() = default;
+
+    // Identifies the compiler build; a different version never hits old entries
+    virtual std::string GetVersion() const = 0;
+
+    // source is the contents of desc.FileName. Appends the path of every file opened
+    // through #include to includes, errors receives the compiler output on failure.
+    virtual bool Compile(const ShaderDesc& desc, const std::string& source, std::vector<uint8_t>* bytecode,
+        std::vector<std::string>* includes, std::string* errors) = 0;
+};
+
+struct ShaderBytecode
+{
+    const uint8_t* Data = nullptr;
+    size_t Size = 0;
+};
+
+struct ShaderCacheStats
+{
+    uint64_t Hits = 0;
+    uint64_t Misses = 0;
+    uint64_t Invalidations = 0;     // Entries found but rejected because an include changed
+    uint64_t CompileFailures = 0;
+    double CompileMs = 0.0;
+};
+
+class ShaderCache
+{
+public:
+    static constexpr uint32_t FileVersion = 1;
+    static constexpr uint32_t BlobAlignment = 16;
+
+    explicit ShaderCache(std::string path);
+
+    ShaderCache(const ShaderCache&) = delete;
+    ShaderCache& operator=(const ShaderCache&) = delete;
+
+    // Maps the cache file. A missing, truncated or corrupt file leaves the cache
+    // empty and returns false; the cache is usable either way.
+    bool Load();
+
+    // Returns the bytecode for desc, compiling and remembering it on a miss. The
+    // pointer stays valid until Save() or the cache is destroyed.
+    bool GetBytecode(const ShaderDesc& desc, ShaderCompiler& compiler, ShaderBytecode* bytecode);
+
+    // Writes every entry to a temporary file, replaces the cache file with it and
+    // maps the result. Does nothing when no entry was added since Load().
+    bool Save();
+
+    void Clear();
+
+    size_t GetEntryCount() const { return m_Entries.size(); }
+    const std::string& GetPath() const { return m_Path; }
+    const ShaderCacheStats& GetStats() const { return m_Stats; }
+    void ResetStats() { m_Stats = {}; }
+
+    // Key of desc given the hash of its source text
+    static uint64_t ComputeKey(const ShaderDesc& desc, uint64_t sourceHash, const std::string& compilerVersion);
+
+private:
+    struct Dependency
+    {
+        std::string Path;
+        uint64_t ContentHash = 0;
+    };
+
+    struct Entry
+    {
+        std::vector<Dependency> Dependencies;
+        // Points into m_File for loaded entries and into Bytecode for new ones
+        const uint8_t* Data = nullptr;
+        size_t Size = 0;
+        std::vector<uint8_t> Bytecode;
+    };
+
+    bool DependenciesUnchanged(const Entry& entry) const;
+
+    std::string m_Path;
+    MappedFile m_File;
+    std::unordered_map<uint64_t, Entry> m_Entries;
+    bool m_Dirty = false;
+    ShaderCacheStats m_Stats;
+};
+
+// Reads a whole file; returns false when it cannot be opened
+bool ReadTextFile(const std::string& path, std::string* text);
@@ -0,0 +1,612 @@
+#include "SoftwareRasterizer.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace
+{
+    constexpr int SubPixelBits = 4;
+    constexpr int SubPixelScale = 1 << SubPixelBits;
+    constexpr uint32_t DepthMask = 0x00FFFFFF;
+
+    // Triangles further out than this many viewports are clipped instead of rasterized
+    constexpr float GuardBand = 4.0f;
+
+    using Clock = std::chrono::steady_clock;
+
+    double ElapsedMs(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    uint32_t PackColor(float r, float g, float b, float a)
+    {
+        auto toByte = [](float value)
+        {
+            value = std::clamp(value, 0.0f, 1.0f);
+            return static_cast<uint32_t>(value * 255.0f + 0.5f);
+        };
+        return toByte(r) | (toByte(g) << 8) | (toByte(b) << 16) | (toByte(a) << 24);
+    }
+
+    uint32_t PackDepth(float depth)
+    {
+        // A float cannot hold 2^24 - 0.5, so round in double to keep 1.0 at 0xFFFFFF
+        depth = std::clamp(depth, 0.0f, 1.0f);
+        return static_cast<uint32_t>(static_cast<double>(depth) * DepthMask + 0.5);
+    }
+
+    // Clip-space polygon vertex; EdgeFlag marks the edge to the next vertex as a real triangle edge
+    struct ClipVertex
+    {
+        Float4 Position;
+        Float4 Color;
+        bool EdgeFlag;
+    };
+
+    ClipVertex Lerp(const ClipVertex& a, const ClipVertex& b, float t)
+    {
+        ClipVertex result;
+        result.Position = { a.Position.x + (b.Position.x - a.Position.x) * t, a.Position.y + (b.Position.y - a.Position.y) * t,
+            a.Position.z + (b.Position.z - a.Position.z) * t, a.Position.w + (b.Position.w - a.Position.w) * t };
+        result.Color = { a.Color.x + (b.Color.x - a.Color.x) * t, a.Color.y + (b.Color.y - a.Color.y) * t,
+            a.Color.z + (b.Color.z - a.Color.z) * t, a.Color.w + (b.Color.w - a.Color.w) * t };
+        result.EdgeFlag = false;
+        return result;
+    }
+
+    // Signed distance to a clip plane: >= 0 is inside
+    float PlaneDistance(const Float4& p, int plane)
+    {
+        switch (plane)
+        {
+        case 0: return p.z;                    // near: z >= 0
+        case 1: return p.w - p.z;              // far: z <= w
+        case 2: return GuardBand * p.w + p.x;  // left
+        case 3: return GuardBand * p.w - p.x;  // right
+        case 4: return GuardBand * p.w + p.y;  // bottom
+        default: return GuardBand * p.w - p.y; // top
+        }
+    }
+
+    // Sutherland-Hodgman against one plane; returns the new vertex count
+    int ClipPolygon(const ClipVertex* in, int count, ClipVertex* out, int plane)
+    {
+        int outCount = 0;
+        for (int i = 0; i < count; ++i)
+        {
+            const ClipVertex& current = in[i];
+            const ClipVertex& next = in[(i + 1) % count];
+            float dCurrent = PlaneDistance(current.Position, plane);
+            float dNext = PlaneDistance(next.Position, plane);
+
+            if (dCurrent >= 0.0f)
+            {
+                out[outCount++] = current;
+
+                // Leaving: the edge from the intersection runs along the clip plane
+                if (dNext < 0.0f)
+                    out[outCount++] = Lerp(current, next, dCurrent / (dCurrent - dNext));
+            }
+            else if (dNext >= 0.0f)
+            {
+                // Entering: the remainder of the original edge is still visible
+                ClipVertex entry = Lerp(current, next, dCurrent / (dCurrent - dNext));
+                entry.EdgeFlag = current.EdgeFlag;
+                out[outCount++] = entry;
+            }
+        }
+        return outCount;
+    }
+}
+
+SoftwareRasterizer::SoftwareRasterizer(JobSystem& jobSystem)
+    : m_JobSystem(jobSystem)
+{
+}
+
+void SoftwareRasterizer::Resize(int width, int height)
+{
+    Flush();
+
+    m_Width = std::max(1, width);
+    m_Height = std::max(1, height);
+    m_TilesX = (m_Width + TileSize - 1) / TileSize;
+    m_TilesY = (m_Height + TileSize - 1) / TileSize;
+    m_ColorBuffer.assign(static_cast<size_t>(m_Width) * m_Height, 0);
+    m_DepthBuffer.assign(static_cast<size_t>(m_Width) * m_Height, DepthMask);
+    m_Chunks.clear();
+}
+
+void SoftwareRasterizer::ClearRenderTargetView(const float color[4])
+{
+    // Clears apply before any draw in the batch, so finish earlier draws first
+    if (!m_Draws.empty())
+        Flush();
+
+    m_ClearColor = PackColor(color[0], color[1], color[2], color[3]);
+    m_ClearColorPending = true;
+}
+
+void SoftwareRasterizer::ClearDepthStencilView(float depth, uint8_t stencil)
+{
+    if (!m_Draws.empty())
+        Flush();
+
+    m_ClearDepthStencil = PackDepth(depth) | (static_cast<uint32_t>(stencil) << 24);
+    m_ClearDepthPending = true;
+}
+
+void SoftwareRasterizer::RSSetViewport(const Viewport& viewport)
+{
+    m_Viewport = viewport;
+}
+
+void SoftwareRasterizer::RSSetState(const RasterizerDesc& desc)
+{
+    m_State = desc;
+}
+
+void SoftwareRasterizer::DrawIndexed(const Vertex* vertices, uint32_t vertexCount, const uint16_t* indices,
+    uint32_t indexCount, const Float4x4& wvp)
+{
+    RecordDraw(vertices, vertexCount, indices, nullptr, indexCount, wvp);
+}
+
+void SoftwareRasterizer::DrawIndexed(const Vertex* vertices, uint32_t vertexCount, const uint32_t* indices,
+    uint32_t indexCount, const Float4x4& wvp)
+{
+    RecordDraw(vertices, vertexCount, nullptr, indices, indexCount, wvp);
+}
+
+void SoftwareRasterizer::RecordDraw(const Vertex* vertices, uint32_t vertexCount, const uint16_t* indices16,
+    const uint32_t* indices32, uint32_t indexCount, const Float4x4& wvp)
+{
+    if (vertexCount == 0 || indexCount < 3)
+        return;
+
+    Draw draw;
+    draw.Vertices = vertices;
+    draw.Indices16 = indices16;
+    draw.Indices32 = indices32;
+    draw.VertexCount = vertexCount;
+    draw.IndexCount = indexCount - indexCount % 3;
+    draw.FirstTransformed = m_TotalVertices;
+    draw.FirstTriangle = m_TotalTriangles;
+    draw.WVP = wvp;
+    draw.State = m_State;
+    draw.View = m_Viewport;
+    m_Draws.push_back(draw);
+
+    m_TotalVertices += vertexCount;
+    m_TotalTriangles += draw.IndexCount / 3;
+}
+
+void SoftwareRasterizer::Flush()
+{
+    if (m_Width == 0 || (m_Draws.empty() && !m_ClearColorPending && !m_ClearDepthPending))
+        return;
+
+    Clock::time_point start = Clock::now();
+    TransformVertices();
+    m_Stats.VertexMs += ElapsedMs(start);
+
+    start = Clock::now();
+    BinTriangles();
+    m_Stats.BinningMs += ElapsedMs(start);
+
+    start = Clock::now();
+    RasterizeTiles();
+    m_Stats.RasterMs += ElapsedMs(start);
+
+    m_Stats.Draws += m_Draws.size();
+    m_Stats.TrianglesIn += m_TotalTriangles;
+
+    m_Draws.clear();
+    m_TotalVertices = 0;
+    m_TotalTriangles = 0;
+    m_ClearColorPending = false;
+    m_ClearDepthPending = false;
+}
+
+void SoftwareRasterizer::TransformVertices()
+{
+    m_Transformed.resize(m_TotalVertices);
+
+    for (const Draw& draw : m_Draws)
+    {
+        // Equivalent of mul(inPos, WVP) with the float4(pos, 1) the input assembler produces
+        m_JobSystem.ParallelFor(draw.VertexCount, 4096, [&](size_t begin, size_t end, unsigned int)
+        {
+            for (size_t i = begin; i < end; ++i)
+            {
+                TransformedVertex& out = m_Transformed[draw.FirstTransformed + i];
+                out.Position = Vector3Transform(draw.Vertices[i].Position, draw.WVP);
+                out.Color = draw.Vertices[i].Color;
+            }
+        });
+    }
+}
+
+void SoftwareRasterizer::BinTriangles()
+{
+    size_t chunkCount = std::max<size_t>(1, std::min<size_t>(m_JobSystem.GetWorkerCount() * 4, (m_TotalTriangles + 63) / 64));
+    size_t tileCount = static_cast<size_t>(m_TilesX) * m_TilesY;
+
+    if (m_Chunks.size() < chunkCount)
+        m_Chunks.resize(chunkCount);
+    for (BinChunk& chunk : m_Chunks)
+    {
+        chunk.Triangles.clear();
+        chunk.TileBins.resize(tileCount);
+        for (std::vector<uint32_t>& bin : chunk.TileBins)
+            bin.clear();
+    }
+
+    if (m_TotalTriangles == 0)
+        return;
+
+    std::vector<uint64_t> culledPerChunk(chunkCount, 0);
+    size_t trianglesPerChunk = (m_TotalTriangles + chunkCount - 1) / chunkCount;
+
+    // One job per chunk; each chunk owns a contiguous triangle range so tile bins stay in submission order
+    m_JobSystem.ParallelFor(chunkCount, 1, [&](size_t begin, size_t end, unsigned int)
+    {
+        for (size_t chunkIndex = begin; chunkIndex < end; ++chunkIndex)
+        {
+            uint32_t first = static_cast<uint32_t>(chunkIndex * trianglesPerChunk);
+            uint32_t last = static_cast<uint32_t>(std::min<size_t>(first + trianglesPerChunk, m_TotalTriangles));
+            if (first >= last)
+                continue;
+
+            // Find the draw that owns the first triangle of the chunk
+            auto drawIt = std::upper_bound(m_Draws.begin(), m_Draws.end(), first,
+                [](uint32_t triangle, const Draw& draw) { return triangle < draw.FirstTriangle; }) - 1;
+
+            for (uint32_t triangle = first; triangle < last; ++triangle)
+            {
+                while (triangle >= drawIt->FirstTriangle + drawIt->IndexCount / 3)
+                    ++drawIt;
+
+                const Draw& draw = *drawIt;
+                size_t first = size_t(triangle - draw.FirstTriangle) * 3;
+                uint32_t index[3];
+                for (int k = 0; k < 3; ++k)
+                    index[k] = draw.Indices32 ? draw.Indices32[first + k] : draw.Indices16[first + k];
+                if (index[0] >= draw.VertexCount || index[1] >= draw.VertexCount || index[2] >= draw.VertexCount)
+                    continue;
+
+                const TransformedVertex* base = m_Transformed.data() + draw.FirstTransformed;
+                SetupAndBin(draw, base + index[0], base + index[1], base + index[2], m_Chunks[chunkIndex], culledPerChunk[chunkIndex]);
+            }
+        }
+    });
+
+    for (size_t i = 0; i < chunkCount; ++i)
+    {
+        m_Stats.TrianglesCulled += culledPerChunk[i];
+        m_Stats.TrianglesBinned += m_Chunks[i].Triangles.size();
+    }
+}
+
+void SoftwareRasterizer::SetupAndBin(const Draw& draw, const TransformedVertex* v0, const TransformedVertex* v1,
+    const TransformedVertex* v2, BinChunk& chunk, uint64_t& culled)
+{
+    // Trivial reject when every vertex is outside the same plane
+    bool clipFar = draw.State.DepthClipEnable;
+    bool needsClip = false;
+    for (int plane = 0; plane < 6; ++plane)
+    {
+        if (plane == 1 && !clipFar)
+            continue;
+
+        int outside = (PlaneDistance(v0->Position, plane) < 0.0f) + (PlaneDistance(v1->Position, plane) < 0.0f) +
+            (PlaneDistance(v2->Position, plane) < 0.0f);
+        if (outside == 3)
+        {
+            ++culled;
+            return;
+        }
+        needsClip |= outside > 0;
+    }
+
+    ClipVertex bufferA[9];
+    ClipVertex bufferB[9];
+    bufferA[0] = { v0->Position, v0->Color, true };
+    bufferA[1] = { v1->Position, v1->Color, true };
+    bufferA[2] = { v2->Position, v2->Color, true };
+    int count = 3;
+
+    ClipVertex* polygon = bufferA;
+    if (needsClip)
+    {
+        ClipVertex* scratch = bufferB;
+        for (int plane = 0; plane < 6 && count >= 3; ++plane)
+        {
+            if (plane == 1 && !clipFar)
+                continue;
+            count = ClipPolygon(polygon, count, scratch, plane);
+            std::swap(polygon, scratch);
+        }
+        if (count < 3)
+        {
+            ++culled;
+            return;
+        }
+    }
+
+    const Viewport& vp = draw.View;
+    float viewMinX = std::max(0.0f, vp.TopLeftX);
+    float viewMinY = std::max(0.0f, vp.TopLeftY);
+    int scissorMinX = static_cast<int>(viewMinX);
+    int scissorMinY = static_cast<int>(viewMinY);
+    int scissorMaxX = std::min(m_Width, static_cast<int>(vp.TopLeftX + vp.Width)) - 1;
+    int scissorMaxY = std::min(m_Height, static_cast<int>(vp.TopLeftY + vp.Height)) - 1;
+    if (scissorMinX > scissorMaxX || scissorMinY > scissorMaxY)
+        return;
+
+    // Project the polygon once and fan-triangulate it
+    int64_t screenX[9];
+    int64_t screenY[9];
+    float screenZ[9];
+    float invW[9];
+    for (int i = 0; i < count; ++i)
+    {
+        const Float4& p = polygon[i].Position;
+        invW[i] = 1.0f / p.w;
+        float sx = vp.TopLeftX + (p.x * invW[i] + 1.0f) * 0.5f * vp.Width;
+        float sy = vp.TopLeftY + (1.0f - p.y * invW[i]) * 0.5f * vp.Height;
+        screenX[i] = static_cast<int64_t>(sx * SubPixelScale + 0.5f);
+        screenY[i] = static_cast<int64_t>(sy * SubPixelScale + 0.5f);
+        screenZ[i] = vp.MinDepth + p.z * invW[i] * (vp.MaxDepth - vp.MinDepth);
+    }
+
+    bool wireframe = draw.State.Fill == FillMode::Wireframe;
+    for (int i = 1; i + 1 < count; ++i)
+    {
+        int ids[3] = { 0, i, i + 1 };
+        int64_t area = (screenX[ids[1]] - screenX[ids[0]]) * (screenY[ids[2]] - screenY[ids[0]]) -
+            (screenX[ids[2]] - screenX[ids[0]]) * (screenY[ids[1]] - screenY[ids[0]]);
+        if (area == 0)
+        {
+            ++culled;
+            continue;
+        }
+
+        // Screen space is y-down, so a clockwise triangle has a positive area
+        bool frontFacing = draw.State.FrontCounterClockwise ? area < 0 : area > 0;
+        if ((draw.State.Cull == CullMode::Back && !frontFacing) || (draw.State.Cull == CullMode::Front && frontFacing))
+        {
+            ++culled;
+            continue;
+        }
+
+        // Only real triangle edges are drawn in wireframe, not clip or fan edges
+        unsigned int edgeMask = (i == 1 && polygon[0].EdgeFlag ? 1u : 0u) | (polygon[i].EdgeFlag ? 2u : 0u) |
+            (i + 2 == count && polygon[count - 1].EdgeFlag ? 4u : 0u);
+
+        // Normalize winding so the edge functions are positive inside
+        if (area < 0)
+        {
+            std::swap(ids[1], ids[2]);
+            area = -area;
+            edgeMask = ((edgeMask & 1u) << 2) | (edgeMask & 2u) | ((edgeMask & 4u) >> 2);
+        }
+
+        SetupTriangle tri;
+        int64_t minX = INT64_MAX, minY = INT64_MAX, maxX = INT64_MIN, maxY = INT64_MIN;
+        for (int v = 0; v < 3; ++v)
+        {
+            const ClipVertex& source = polygon[ids[v]];
+            tri.X[v] = screenX[ids[v]];
+            tri.Y[v] = screenY[ids[v]];
+            tri.Z[v] = screenZ[ids[v]];
+            tri.InvW[v] = invW[ids[v]];
+            tri.ColorOverW[v] = { source.Color.x * invW[ids[v]], source.Color.y * invW[ids[v]],
+                source.Color.z * invW[ids[v]], source.Color.w * invW[ids[v]] };
+            minX = std::min(minX, tri.X[v]);
+            minY = std::min(minY, tri.Y[v]);
+            maxX = std::max(maxX, tri.X[v]);
+            maxY = std::max(maxY, tri.Y[v]);
+        }
+        tri.Area = area;
+        tri.Wireframe = wireframe;
+        tri.EdgeMask = edgeMask;
+        tri.MinDepth = vp.MinDepth;
+        tri.MaxDepth = vp.MaxDepth;
+
+        // Pixel bounds (lines get one pixel of slack) clamped to the viewport scissor
+        int margin = wireframe ? 1 : 0;
+        tri.MinX = std::max(scissorMinX, static_cast<int>(minX >> SubPixelBits) - margin);
+        tri.MinY = std::max(scissorMinY, static_cast<int>(minY >> SubPixelBits) - margin);
+        tri.MaxX = std::min(scissorMaxX, static_cast<int>((maxX + SubPixelScale - 1) >> SubPixelBits) + margin);
+        tri.MaxY = std::min(scissorMaxY, static_cast<int>((maxY + SubPixelScale - 1) >> SubPixelBits) + margin);
+        if (tri.MinX > tri.MaxX || tri.MinY > tri.MaxY || (wireframe && edgeMask == 0))
+        {
+            ++culled;
+            continue;
+        }
+
+        uint32_t triangleIndex = static_cast<uint32_t>(chunk.Triangles.size());
+        chunk.Triangles.push_back(tri);
+
+        int tileMinX = tri.MinX / TileSize;
+        int tileMinY = tri.MinY / TileSize;
+        int tileMaxX = tri.MaxX / TileSize;
+        int tileMaxY = tri.MaxY / TileSize;
+        for (int ty = tileMinY; ty <= tileMaxY; ++ty)
+        {
+            for (int tx = tileMinX; tx <= tileMaxX; ++tx)
+                chunk.TileBins[static_cast<size_t>(ty) * m_TilesX + tx].push_back(triangleIndex);
+        }
+    }
+}
+
+void SoftwareRasterizer::RasterizeTiles()
+{
+    size_t tileCount = static_cast<size_t>(m_TilesX) * m_TilesY;
+    size_t chunkCount = m_Chunks.size();
+
+    m_JobSystem.ParallelFor(tileCount, 1, [&](size_t begin, size_t end, unsigned int)
+    {
+        for (size_t tile = begin; tile < end; ++tile)
+        {
+            int tileMinX = static_cast<int>(tile % m_TilesX) * TileSize;
+            int tileMinY = static_cast<int>(tile / m_TilesX) * TileSize;
+            int tileMaxX = std::min(tileMinX + TileSize, m_Width) - 1;
+            int tileMaxY = std::min(tileMinY + TileSize, m_Height) - 1;
+
+            if (m_ClearColorPending || m_ClearDepthPending)
+            {
+                for (int y = tileMinY; y <= tileMaxY; ++y)
+                {
+                    size_t row = static_cast<size_t>(y) * m_Width;
+                    if (m_ClearColorPending)
+                        std::fill(m_ColorBuffer.begin() + row + tileMinX, m_ColorBuffer.begin() + row + tileMaxX + 1, m_ClearColor);
+                    if (m_ClearDepthPending)
+                        std::fill(m_DepthBuffer.begin() + row + tileMinX, m_DepthBuffer.begin() + row + tileMaxX + 1, m_ClearDepthStencil);
+                }
+            }
+
+            for (size_t chunkIndex = 0; chunkIndex < chunkCount; ++chunkIndex)
+            {
+                const BinChunk& chunk = m_Chunks[chunkIndex];
+                if (chunk.TileBins.size() <= tile)
+                    continue;
+
+                for (uint32_t triangleIndex : chunk.TileBins[tile])
+                {
+                    const SetupTriangle& tri = chunk.Triangles[triangleIndex];
+                    int minX = std::max(tileMinX, tri.MinX);
+                    int minY = std::max(tileMinY, tri.MinY);
+                    int maxX = std::min(tileMaxX, tri.MaxX);
+                    int maxY = std::min(tileMaxY, tri.MaxY);
+
+                    if (tri.Wireframe)
+                    {
+                        for (int edge = 0; edge < 3; ++edge)
+                        {
+                            if (tri.EdgeMask & (1u << edge))
+                                RasterizeLine(tri, edge, (edge + 1) % 3, minX, minY, maxX, maxY);
+                        }
+                    }
+                    else
+                    {
+                        RasterizeTriangle(tri, minX, minY, maxX, maxY);
+                    }
+                }
+            }
+        }
+    });
+}
+
+void SoftwareRasterizer::RasterizeTriangle(const SetupTriangle& tri, int minX, int minY, int maxX, int maxY)
+{
+    // Edge i is opposite vertex i: E0 = v1->v2, E1 = v2->v0, E2 = v0->v1
+    int64_t stepX[3];
+    int64_t stepY[3];
+    int64_t rowStart[3];
+    int64_t bias[3];
+    int64_t sampleX = static_cast<int64_t>(minX) * SubPixelScale + SubPixelScale / 2;
+    int64_t sampleY = static_cast<int64_t>(minY) * SubPixelScale + SubPixelScale / 2;
+
+    for (int edge = 0; edge < 3; ++edge)
+    {
+        int a = (edge + 1) % 3;
+        int b = (edge + 2) % 3;
+        int64_t dx = tri.X[b] - tri.X[a];
+        int64_t dy = tri.Y[b] - tri.Y[a];
+
+        // Top-left fill convention for clockwise triangles in y-down space
+        bool topLeft = dy < 0 || (dy == 0 && dx > 0);
+        bias[edge] = topLeft ? 0 : -1;
+
+        rowStart[edge] = dx * (sampleY - tri.Y[a]) - dy * (sampleX - tri.X[a]) + bias[edge];
+        stepX[edge] = -dy * SubPixelScale;
+        stepY[edge] = dx * SubPixelScale;
+    }
+
+    float invArea = 1.0f / static_cast<float>(tri.Area);
+    for (int y = minY; y <= maxY; ++y)
+    {
+        int64_t e0 = rowStart[0];
+        int64_t e1 = rowStart[1];
+        int64_t e2 = rowStart[2];
+        for (int x = minX; x <= maxX; ++x)
+        {
+            // The fill-convention bias only decides coverage; the weights must still sum to one, or
+            // small triangles pull their depth towards zero
+            if ((e0 | e1 | e2) >= 0)
+            {
+                ShadePixel(tri, x, y, static_cast<float>(e0 - bias[0]) * invArea,
+                    static_cast<float>(e1 - bias[1]) * invArea, static_cast<float>(e2 - bias[2]) * invArea);
+            }
+            e0 += stepX[0];
+            e1 += stepX[1];
+            e2 += stepX[2];
+        }
+        rowStart[0] += stepY[0];
+        rowStart[1] += stepY[1];
+        rowStart[2] += stepY[2];
+    }
+}
+
+void SoftwareRasterizer::RasterizeLine(const SetupTriangle& tri, int a, int b, int minX, int minY, int maxX, int maxY)
+{
+    float x0 = static_cast<float>(tri.X[a]) / SubPixelScale;
+    float y0 = static_cast<float>(tri.Y[a]) / SubPixelScale;
+    float x1 = static_cast<float>(tri.X[b]) / SubPixelScale;
+    float y1 = static_cast<float>(tri.Y[b]) / SubPixelScale;
+    float dx = x1 - x0;
+    float dy = y1 - y0;
+
+    // Step one pixel at a time along the major axis, restricted to the tile
+    bool xMajor = std::abs(dx) >= std::abs(dy);
+    float start = xMajor ? std::min(x0, x1) : std::min(y0, y1);
+    float end = xMajor ? std::max(x0, x1) : std::max(y0, y1);
+    int first = std::max(static_cast<int>(std::floor(start)), xMajor ? minX : minY);
+    int last = std::min(static_cast<int>(std::ceil(end)) - 1, xMajor ? maxX : maxY);
+    float length = xMajor ? dx : dy;
+    if (length == 0.0f)
+        return;
+
+    for (int major = first; major <= last; ++major)
+    {
+        float t = ((static_cast<float>(major) + 0.5f) - (xMajor ? x0 : y0)) / length;
+        t = std::clamp(t, 0.0f, 1.0f);
+        int minor = static_cast<int>(std::floor((xMajor ? y0 + dy * t : x0 + dx * t)));
+        int x = xMajor ? major : minor;
+        int y = xMajor ? minor : major;
+        if (x < minX || x > maxX || y < minY || y > maxY)
+            continue;
+
+        float weights[3] = { 0.0f, 0.0f, 0.0f };
+        weights[a] = 1.0f - t;
+        weights[b] = t;
+        ShadePixel(tri, x, y, weights[0], weights[1], weights[2]);
+    }
+}
+
+void SoftwareRasterizer::ShadePixel(const SetupTriangle& tri, int x, int y, float b0, float b1, float b2)
+{
+    float depth = tri.Z[0] * b0 + tri.Z[1] * b1 + tri.Z[2] * b2;
+    if (depth < tri.MinDepth || depth > tri.MaxDepth)
+        return;
+
+    size_t offset = static_cast<size_t>(y) * m_Width + x;
+    uint32_t depthStencil = m_DepthBuffer[offset];
+    uint32_t newDepth = PackDepth(depth);
+
+    // D3D11_COMPARISON_LESS, the default depth-stencil state
+    if (newDepth >= (depthStencil & DepthMask))
+        return;
+    m_DepthBuffer[offset] = (depthStencil & ~DepthMask) | newDepth;
+
+    // Perspective-correct color, the pixel shader returns it unchanged
+    float w = 1.0f / (tri.InvW[0] * b0 + tri.InvW[1] * b1 + tri.InvW[2] * b2);
+    const Float4& c0 = tri.ColorOverW[0];
+    const Float4& c1 = tri.ColorOverW[1];
+    const Float4& c2 = tri.ColorOverW[2];
+    m_ColorBuffer[offset] = PackColor((c0.x * b0 + c1.x * b1 + c2.x * b2) * w, (c0.y * b0 + c1.y * b1 + c2.y * b2) * w,
+        (c0.z * b0 + c1.z * b1 + c2.z * b2) * w, (c0.w * b0 + c1.w * b1 + c2.w * b2) * w);
+}
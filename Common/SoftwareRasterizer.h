@@ -0,0 +1,153 @@
+#pragma once
+
+// Tile-based CPU rasterizer that runs the tutorial scenes without a GPU.
+// It mirrors the D3D11 pipeline the tutorials use: one WVP constant per draw,
+// the Effects.fx vertex/pixel shader pair (mul(pos, WVP) and pass-through color),
+// a D24S8 depth buffer with the default LESS depth test, and solid/wireframe
+// rasterizer states with front/back culling.
+//
+// Draws are recorded and executed on Flush() in three stages, each spread over
+// the JobSystem: vertex transform, triangle setup + tile binning, and per-tile
+// rasterization. Tiles are independent so the last stage scales with cores.
+
+#include <cstdint>
+#include <vector>
+
+#include "JobSystem.h"
+#include "MathUtil.h"
+#include "RenderTypes.h"
+#include "Vertex.h"
+
+// Time spent in each stage, in milliseconds, accumulated over all Flush() calls
+struct RasterizerStats
+{
+    double VertexMs = 0.0;
+    double BinningMs = 0.0;
+    double RasterMs = 0.0;
+    uint64_t Draws = 0;
+    uint64_t TrianglesIn = 0;
+    uint64_t TrianglesCulled = 0;
+    uint64_t TrianglesBinned = 0;
+};
+
+class SoftwareRasterizer
+{
+public:
+    static constexpr int TileSize = 32;
+
+    explicit SoftwareRasterizer(JobSystem& jobSystem);
+
+    // Creates the RGBA8 render target and the D24S8 depth buffer
+    void Resize(int width, int height);
+
+    int GetWidth() const { return m_Width; }
+    int GetHeight() const { return m_Height; }
+
+    void ClearRenderTargetView(const float color[4]);
+    void ClearDepthStencilView(float depth, uint8_t stencil);
+
+    void RSSetViewport(const Viewport& viewport);
+    void RSSetState(const RasterizerDesc& desc);
+
+    // Records a triangle list draw; vertices and indices must stay alive until Flush()
+    void DrawIndexed(const Vertex* vertices, uint32_t vertexCount, const uint16_t* indices,
+        uint32_t indexCount, const Float4x4& wvp);
+    void DrawIndexed(const Vertex* vertices, uint32_t vertexCount, const uint32_t* indices,
+        uint32_t indexCount, const Float4x4& wvp);
+
+    // Runs all recorded work; called by Present() in the render device
+    void Flush();
+
+    // R8G8B8A8_UNORM pixels, row-major, GetWidth() * GetHeight() entries
+    const uint32_t* GetColorBuffer() const { return m_ColorBuffer.data(); }
+    // D24_UNORM_S8_UINT texels: depth in the low 24 bits, stencil in the high 8
+    const uint32_t* GetDepthStencilBuffer() const { return m_DepthBuffer.data(); }
+
+    const RasterizerStats& GetStats() const { return m_Stats; }
+    void ResetStats() { m_Stats = {}; }
+
+private:
+    struct Draw
+    {
+        const Vertex* Vertices;
+        // One of the two is set, by the index format of the draw
+        const uint16_t* Indices16;
+        const uint32_t* Indices32;
+        uint32_t VertexCount;
+        uint32_t IndexCount;
+        uint32_t FirstTransformed;
+        uint32_t FirstTriangle;
+        Float4x4 WVP;
+        RasterizerDesc State;
+        Viewport View;
+    };
+
+    // Vertex shader output
+    struct TransformedVertex
+    {
+        Float4 Position;
+        Float4 Color;
+    };
+
+    // Screen-space triangle ready for edge-function rasterization
+    struct SetupTriangle
+    {
+        // 28.4 fixed point screen coordinates
+        int64_t X[3];
+        int64_t Y[3];
+        int64_t Area;
+        // Attributes divided by w so they interpolate linearly in screen space
+        float Z[3];
+        float InvW[3];
+        Float4 ColorOverW[3];
+        int MinX, MinY, MaxX, MaxY;
+        bool Wireframe;
+        unsigned int EdgeMask;
+        float MinDepth, MaxDepth;
+    };
+
+    // Triangles produced by one binning chunk; kept separate so draw order survives
+    struct BinChunk
+    {
+        std::vector<SetupTriangle> Triangles;
+        std::vector<std::vector<uint32_t>> TileBins;
+    };
+
+    void RecordDraw(const Vertex* vertices, uint32_t vertexCount, const uint16_t* indices16,
+        const uint32_t* indices32, uint32_t indexCount, const Float4x4& wvp);
+
+    void TransformVertices();
+    void BinTriangles();
+    void RasterizeTiles();
+
+    void SetupAndBin(const Draw& draw, const TransformedVertex* v0, const TransformedVertex* v1,
+        const TransformedVertex* v2, BinChunk& chunk, uint64_t& culled);
+    void RasterizeTriangle(const SetupTriangle& tri, int tileMinX, int tileMinY, int tileMaxX, int tileMaxY);
+    void RasterizeLine(const SetupTriangle& tri, int a, int b, int tileMinX, int tileMinY, int tileMaxX, int tileMaxY);
+    void ShadePixel(const SetupTriangle& tri, int x, int y, float b0, float b1, float b2);
+
+    JobSystem& m_JobSystem;
+
+    int m_Width = 0;
+    int m_Height = 0;
+    int m_TilesX = 0;
+    int m_TilesY = 0;
+    std::vector<uint32_t> m_ColorBuffer;
+    std::vector<uint32_t> m_DepthBuffer;
+
+    RasterizerDesc m_State;
+    Viewport m_Viewport;
+
+    bool m_ClearColorPending = false;
+    bool m_ClearDepthPending = false;
+    uint32_t m_ClearColor = 0;
+    uint32_t m_ClearDepthStencil = 0;
+
+    std::vector<Draw> m_Draws;
+    uint32_t m_TotalVertices = 0;
+    uint32_t m_TotalTriangles = 0;
+    std::vector<TransformedVertex> m_Transformed;
+    std::vector<BinChunk> m_Chunks;
+
+    RasterizerStats m_Stats;
+};
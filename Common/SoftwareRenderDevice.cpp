@@ -0,0 +1,247 @@
+#include "SoftwareRenderDevice.h"
+
+#include <cstring>
+
+#include "PackedVertex.h"
+
+SoftwareRenderContext::SoftwareRenderContext(SoftwareRenderDevice& device, SoftwareRasterizer& rasterizer)
+    : CpuRenderContext(device)
+    , m_Rasterizer(rasterizer)
+{
+}
+
+void SoftwareRenderContext::ClearRenderTarget(const float color[4])
+{
+    m_Rasterizer.ClearRenderTargetView(color);
+}
+
+void SoftwareRenderContext::ClearDepthStencil(float depth, uint8_t stencil)
+{
+    m_Rasterizer.ClearDepthStencilView(depth, stencil);
+}
+
+namespace
+{
+    // First of the four per-instance WORLD rows, if the layout has them
+    const InputElementDesc* FindInstanceWorld(const ShaderDesc& desc)
+    {
+        for (const InputElementDesc& element : desc.InputLayout)
+        {
+            if (element.PerInstance && element.SemanticIndex == 0 && std::strcmp(element.SemanticName, "WORLD") == 0)
+                return &element;
+        }
+        return nullptr;
+    }
+
+    // Per-vertex element of slot 0 with the given semantic
+    const InputElementDesc* FindVertexElement(const ShaderDesc& desc, const char* semanticName)
+    {
+        for (const InputElementDesc& element : desc.InputLayout)
+        {
+            if (element.InputSlot == 0 && !element.PerInstance && element.SemanticIndex == 0 &&
+                std::strcmp(element.SemanticName, semanticName) == 0)
+                return &element;
+        }
+        return nullptr;
+    }
+
+    bool IsPositionFormat(Format format)
+    {
+        return format == Format::R32G32B32Float || format == Format::R16G16B16A16SNorm ||
+            format == Format::R16G16B16A16Float;
+    }
+
+    bool IsColorFormat(Format format)
+    {
+        return format == Format::R32G32B32A32Float || format == Format::R8G8B8A8UNorm;
+    }
+
+    // The layout of Vertex, which the rasterizer reads directly
+    bool IsNativeLayout(const InputElementDesc& position, const InputElementDesc& color, uint32_t stride)
+    {
+        return stride == sizeof(Vertex) && position.ElementFormat == Format::R32G32B32Float &&
+            position.AlignedByteOffset == 0 && color.ElementFormat == Format::R32G32B32A32Float &&
+            color.AlignedByteOffset == 12;
+    }
+}
+
+bool SoftwareRenderContext::ReadConstantMatrix(uint32_t slot, Float4x4* matrix)
+{
+    CpuBuffer* constantBuffer = m_Device.GetBuffer(m_State.VSConstantBuffers[slot]);
+    uint32_t offset = m_State.VSConstantOffsets[slot];
+    if (!constantBuffer || constantBuffer->Data.size() < offset + sizeof(Float4x4))
+        return false;
+
+    // HLSL reads the matrix column-major, which is why the scenes upload the transpose
+    Float4x4 transposed;
+    std::memcpy(&transposed, constantBuffer->Data.data() + offset, sizeof(Float4x4));
+    *matrix = MatrixTranspose(transposed);
+    return true;
+}
+
+void SoftwareRenderContext::DrawMesh(uint32_t indexCount, uint32_t startIndexLocation, int32_t baseVertexLocation,
+    const Float4x4& wvp)
+{
+    CpuBuffer* vertexBuffer = m_Device.GetBuffer(m_State.VertexBuffers[0]);
+    CpuBuffer* indexBuffer = m_Device.GetBuffer(m_State.IndexBuffer);
+    uint32_t stride = m_State.VertexStrides[0];
+    if (stride == 0 || (m_State.IndexFormat != Format::R16UInt && m_State.IndexFormat != Format::R32UInt))
+        return;
+
+    size_t firstVertexByte = m_State.VertexOffsets[0] + static_cast<size_t>(baseVertexLocation) * stride;
+    if (firstVertexByte >= vertexBuffer->Data.size())
+        return;
+    uint32_t vertexCount = static_cast<uint32_t>((vertexBuffer->Data.size() - firstVertexByte) / stride);
+
+    const Vertex* vertices = DecodeVertices(*vertexBuffer, firstVertexByte, vertexCount);
+    if (!vertices)
+        return;
+
+    RasterizerDesc rasterizerDesc;
+    m_Device.GetRasterizerDesc(m_State.RasterizerState, &rasterizerDesc);
+    m_Rasterizer.RSSetState(rasterizerDesc);
+    m_Rasterizer.RSSetViewport(m_State.View);
+
+    const uint8_t* indices = indexBuffer->Data.data() + m_State.IndexOffset;
+    if (m_State.IndexFormat == Format::R32UInt)
+    {
+        m_Rasterizer.DrawIndexed(vertices, vertexCount, reinterpret_cast<const uint32_t*>(indices) + startIndexLocation,
+            indexCount, wvp);
+    }
+    else
+    {
+        m_Rasterizer.DrawIndexed(vertices, vertexCount, reinterpret_cast<const uint16_t*>(indices) + startIndexLocation,
+            indexCount, wvp);
+    }
+}
+
+const Vertex* SoftwareRenderContext::DecodeVertices(const CpuBuffer& buffer, size_t firstVertexByte,
+    uint32_t vertexCount)
+{
+    // Shader creation validated the layout
+    const ShaderDesc* shader = m_Device.GetVertexShader(m_State.VertexShader);
+    const InputElementDesc* position = FindVertexElement(*shader, "POSITION");
+    const InputElementDesc* color = FindVertexElement(*shader, "COLOR");
+    uint32_t stride = m_State.VertexStrides[0];
+    if (IsNativeLayout(*position, *color, stride))
+        return reinterpret_cast<const Vertex*>(buffer.Data.data() + firstVertexByte);
+
+    uint32_t bufferId = m_State.VertexBuffers[0].Id;
+    for (const DecodedVertices& decoded : m_DecodedVertices)
+    {
+        if (decoded.BufferId == bufferId && decoded.FirstVertexByte == firstVertexByte && decoded.Stride == stride &&
+            decoded.VertexShaderId == m_State.VertexShader.Id)
+            return decoded.Vertices.data();
+    }
+
+    // Elements must fit in the stride, or reading the last vertex would run off the buffer
+    if (position->AlignedByteOffset + GetFormatSize(position->ElementFormat) > stride ||
+        color->AlignedByteOffset + GetFormatSize(color->ElementFormat) > stride)
+        return nullptr;
+
+    DecodedVertices decoded = { bufferId, firstVertexByte, stride, m_State.VertexShader.Id,
+        std::vector<Vertex>(vertexCount) };
+    const uint8_t* source = buffer.Data.data() + firstVertexByte;
+    for (uint32_t i = 0; i < vertexCount; ++i, source += stride)
+    {
+        float value[4];
+        ReadVertexElement(position->ElementFormat, source + position->AlignedByteOffset, value);
+        decoded.Vertices[i].Position = { value[0], value[1], value[2] };
+        ReadVertexElement(color->ElementFormat, source + color->AlignedByteOffset, value);
+        decoded.Vertices[i].Color = { value[0], value[1], value[2], value[3] };
+    }
+    m_DecodedVertices.push_back(std::move(decoded));
+    return m_DecodedVertices.back().Vertices.data();
+}
+
+void SoftwareRenderContext::OnDrawIndexed(uint32_t indexCount, uint32_t startIndexLocation, int32_t baseVertexLocation)
+{
+    Float4x4 wvp;
+    if (ReadConstantMatrix(0, &wvp))
+        DrawMesh(indexCount, startIndexLocation, baseVertexLocation, wvp);
+}
+
+void SoftwareRenderContext::OnDrawIndexedInstanced(uint32_t indexCountPerInstance, uint32_t instanceCount,
+    uint32_t startIndexLocation, int32_t baseVertexLocation, uint32_t startInstanceLocation)
+{
+    const InputElementDesc* world = FindInstanceWorld(*m_Device.GetVertexShader(m_State.VertexShader));
+    if (!world)
+    {
+        // Shader without instance data: every instance lands in the same place
+        for (uint32_t instance = 0; instance < instanceCount; ++instance)
+            OnDrawIndexed(indexCountPerInstance, startIndexLocation, baseVertexLocation);
+        return;
+    }
+
+    Float4x4 viewProjection;
+    if (!ReadConstantMatrix(1, &viewProjection))
+        return;
+
+    // Draw validation already checked the instance stream covers every instance
+    const CpuBuffer* instanceBuffer = m_Device.GetBuffer(m_State.VertexBuffers[world->InputSlot]);
+    uint32_t stride = m_State.VertexStrides[world->InputSlot];
+    uint32_t stepRate = world->InstanceDataStepRate ? world->InstanceDataStepRate : 1;
+    const uint8_t* first = instanceBuffer->Data.data() + m_State.VertexOffsets[world->InputSlot] + world->AlignedByteOffset;
+
+    for (uint32_t instance = 0; instance < instanceCount; ++instance)
+    {
+        Float4x4 instanceWorld;
+        std::memcpy(&instanceWorld, first + static_cast<size_t>(startInstanceLocation + instance / stepRate) * stride,
+            sizeof(Float4x4));
+        DrawMesh(indexCountPerInstance, startIndexLocation, baseVertexLocation, instanceWorld * viewProjection);
+    }
+}
+
+void SoftwareRenderContext::OnBufferWrite(BufferHandle)
+{
+    // Recorded draws still point at the old contents
+    m_Rasterizer.Flush();
+    m_DecodedVertices.clear();
+}
+
+SoftwareRenderDevice::SoftwareRenderDevice(JobSystem& jobSystem, uint32_t width, uint32_t height)
+    : m_Rasterizer(jobSystem)
+    , m_Context(*this, m_Rasterizer)
+{
+    Resize(width, height);
+}
+
+bool SoftwareRenderDevice::Resize(uint32_t width, uint32_t height)
+{
+    if (!CpuRenderDevice::Resize(width, height))
+        return false;
+
+    m_Rasterizer.Resize(static_cast<int>(width), static_cast<int>(height));
+    return true;
+}
+
+bool SoftwareRenderDevice::Present()
+{
+    m_Context.EndFrame();
+    m_Rasterizer.Flush();
+    return true;
+}
+
+bool SoftwareRenderDevice::ValidateVertexShader(const ShaderDesc& desc) const
+{
+    // POSITION + COLOR in slot 0, as float or in the compact formats of PackedVertex.h
+    const InputElementDesc* position = FindVertexElement(desc, "POSITION");
+    const InputElementDesc* color = FindVertexElement(desc, "COLOR");
+    if (!position || !color || !IsPositionFormat(position->ElementFormat) || !IsColorFormat(color->ElementFormat))
+        return false;
+
+    // Instance worlds are read as one Float4x4, so WORLD0..3 must be consecutive float4 rows
+    const InputElementDesc* world = FindInstanceWorld(desc);
+    if (!world)
+        return true;
+
+    uint32_t rows = 0;
+    for (const InputElementDesc& element : desc.InputLayout)
+    {
+        if (element.PerInstance && std::strcmp(element.SemanticName, "WORLD") == 0 && element.SemanticIndex < 4 &&
+            element.InputSlot == world->InputSlot && element.ElementFormat == Format::R32G32B32A32Float &&
+            element.AlignedByteOffset == world->AlignedByteOffset + element.SemanticIndex * 16)
+            ++rows;
+    }
+    return rows == 4 && world->InputSlot < CpuPipelineState::MaxVertexBuffers;
+}
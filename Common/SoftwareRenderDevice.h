@@ -0,0 +1,73 @@
+#pragma once
+
+// Backend that draws through SoftwareRasterizer. It emulates the Effects.fx
+// shader pair of the tutorials: slot 0 holds a Vertex stream (POSITION + COLOR),
+// constant buffer b0 starts with the transposed WVP, and the pixel shader
+// returns the interpolated color; indices may be R16UInt or R32UInt. For VSInstanced, WORLD0..3 come from the
+// instance stream and b1 holds the transposed View * Projection; the per-instance
+// tint is not applied. Compact vertex layouts (PackedVertex.h) are decoded once
+// per buffer into Vertex, the way the input assembler would read them.
+
+#include <vector>
+
+#include "CpuRenderDevice.h"
+#include "SoftwareRasterizer.h"
+
+class SoftwareRenderDevice;
+
+class SoftwareRenderContext final : public CpuRenderContext
+{
+public:
+    SoftwareRenderContext(SoftwareRenderDevice& device, SoftwareRasterizer& rasterizer);
+
+    void ClearRenderTarget(const float color[4]) override;
+    void ClearDepthStencil(float depth, uint8_t stencil) override;
+
+protected:
+    void OnDrawIndexed(uint32_t indexCount, uint32_t startIndexLocation, int32_t baseVertexLocation) override;
+    void OnDrawIndexedInstanced(uint32_t indexCountPerInstance, uint32_t instanceCount, uint32_t startIndexLocation,
+        int32_t baseVertexLocation, uint32_t startInstanceLocation) override;
+    void OnBufferWrite(BufferHandle buffer) override;
+
+private:
+    // Transposed matrix at the start of the window bound to a VS constant buffer slot
+    bool ReadConstantMatrix(uint32_t slot, Float4x4* matrix);
+    void DrawMesh(uint32_t indexCount, uint32_t startIndexLocation, int32_t baseVertexLocation, const Float4x4& wvp);
+    // Vertices of a compact layout decoded to Vertex; null if the stream cannot be read
+    const Vertex* DecodeVertices(const CpuBuffer& buffer, size_t firstVertexByte, uint32_t vertexCount);
+
+    // Decoded copy of a vertex stream. The rasterizer keeps pointers into Vertices until
+    // Flush, so entries are only dropped in OnBufferWrite, after the flush.
+    struct DecodedVertices
+    {
+        uint32_t BufferId;
+        size_t FirstVertexByte;
+        uint32_t Stride;
+        uint32_t VertexShaderId;
+        std::vector<Vertex> Vertices;
+    };
+
+    SoftwareRasterizer& m_Rasterizer;
+    std::vector<DecodedVertices> m_DecodedVertices;
+};
+
+class SoftwareRenderDevice final : public CpuRenderDevice
+{
+public:
+    SoftwareRenderDevice(JobSystem& jobSystem, uint32_t width, uint32_t height);
+
+    const char* GetName() const override { return "software"; }
+
+    bool Resize(uint32_t width, uint32_t height) override;
+    RenderContext& GetImmediateContext() override { return m_Context; }
+    bool Present() override;
+
+    SoftwareRasterizer& GetRasterizer() { return m_Rasterizer; }
+
+protected:
+    bool ValidateVertexShader(const ShaderDesc& desc) const override;
+
+private:
+    SoftwareRasterizer m_Rasterizer;
+    SoftwareRenderContext m_Context;
+};
@@ -0,0 +1,190 @@
+#pragma once
+
+// Deduplicating cache of immutable state objects keyed by their description,
+// the way a renderer resolves rasterizer / depth-stencil / blend / sampler
+// descs per material without creating a new object every time.
+//
+// Lookups are lock-free: the open-addressing table is an array of atomic
+// pointers to nodes that never change after they are published, so recording
+// threads can resolve states while another thread inserts. Inserts take a
+// mutex. When the table fills up it is copied into one twice the size; old
+// tables and all nodes stay alive until Clear() or destruction, so a reader
+// that still holds an old table never touches freed memory.
+//
+// Desc needs two free functions found by overload resolution:
+//   uint64_t HashDesc(const Desc&)           hash of the fields (not of padding bytes)
+//   bool DescEqual(const Desc&, const Desc&)
+// Float fields go through HashValue and FloatKeyEqual (Hash.h): with == a NaN desc
+// would never find itself and every lookup would add another entry.
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "Hash.h"
+#include "RenderTypes.h"
+
+struct StateCacheStats
+{
+    uint64_t Hits = 0;
+    uint64_t Misses = 0;
+    uint64_t Entries = 0;
+    uint64_t Resizes = 0;
+};
+
+template <typename Desc, typename State>
+class StateCache
+{
+public:
+    explicit StateCache(uint32_t initialCapacity = 64)
+    {
+        uint32_t capacity = 16;
+        while (capacity < initialCapacity)
+            capacity *= 2;
+        m_Tables.push_back(std::make_unique<Table>(capacity));
+        m_Table.store(m_Tables.back().get(), std::memory_order_release);
+    }
+
+    StateCache(const StateCache&) = delete;
+    StateCache& operator=(const StateCache&) = delete;
+
+    // Lock-free; returns nullptr when desc has not been added yet. Counts a hit or a miss.
+    const State* Find(const Desc& desc) const
+    {
+        const State* state = FindNode(m_Table.load(std::memory_order_acquire), desc, HashDesc(desc));
+        (state ? m_Hits : m_Misses).fetch_add(1, std::memory_order_relaxed);
+        return state;
+    }
+
+    // Returns the shared state for desc, or nullptr when create fails. On a miss
+    // create(desc, &state) builds it under the insert lock, so every desc is created
+    // once even when threads race for it. The state lives until Clear().
+    template <typename Create>
+    const State* GetOrCreate(const Desc& desc, Create&& create)
+    {
+        uint64_t hash = HashDesc(desc);
+        if (const State* found = FindNode(m_Table.load(std::memory_order_acquire), desc, hash))
+        {
+            m_Hits.fetch_add(1, std::memory_order_relaxed);
+            return found;
+        }
+        m_Misses.fetch_add(1, std::memory_order_relaxed);
+
+        std::lock_guard<std::mutex> lock(m_InsertMutex);
+        Table* table = m_Table.load(std::memory_order_relaxed);
+        if (const State* found = FindNode(table, desc, hash))
+            return found;
+
+        auto node = std::make_unique<Node>(Node{ hash, desc, State() });
+        if (!create(desc, &node->Value))
+            return nullptr;
+
+        // Keep the load factor at or below one half so probes stay short
+        if ((m_Nodes.size() + 1) * 2 > table->Slots.size())
+        {
+            m_Tables.push_back(std::make_unique<Table>(static_cast<uint32_t>(table->Slots.size() * 2)));
+            table = m_Tables.back().get();
+            for (const std::unique_ptr<Node>& existing : m_Nodes)
+                InsertNode(table, existing.get());
+            m_Table.store(table, std::memory_order_release);
+            ++m_Resizes;
+        }
+
+        InsertNode(table, node.get());
+        m_Nodes.push_back(std::move(node));
+        return &m_Nodes.back()->Value;
+    }
+
+    // Drops every state, e.g. when the device that created them is lost.
+    // Not thread safe: no other thread may use the cache meanwhile.
+    void Clear()
+    {
+        std::lock_guard<std::mutex> lock(m_InsertMutex);
+        uint32_t capacity = static_cast<uint32_t>(m_Tables.front()->Slots.size());
+        m_Nodes.clear();
+        m_Tables.clear();
+        m_Tables.push_back(std::make_unique<Table>(capacity));
+        m_Table.store(m_Tables.back().get(), std::memory_order_release);
+    }
+
+    StateCacheStats GetStats() const
+    {
+        std::lock_guard<std::mutex> lock(m_InsertMutex);
+        StateCacheStats stats;
+        stats.Hits = m_Hits.load(std::memory_order_relaxed);
+        stats.Misses = m_Misses.load(std::memory_order_relaxed);
+        stats.Entries = m_Nodes.size();
+        stats.Resizes = m_Resizes;
+        return stats;
+    }
+
+    void ResetStats()
+    {
+        m_Hits.store(0, std::memory_order_relaxed);
+        m_Misses.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    struct Node
+    {
+        uint64_t Hash;
+        Desc Key;
+        State Value;
+    };
+
+    struct Table
+    {
+        explicit Table(uint32_t capacity)
+            : Slots(capacity)
+        {
+        }
+
+        std::vector<std::atomic<const Node*>> Slots;
+    };
+
+    static const State* FindNode(const Table* table, const Desc& desc, uint64_t hash)
+    {
+        size_t mask = table->Slots.size() - 1;
+        for (size_t i = HashMix(hash) & mask;; i = (i + 1) & mask)
+        {
+            const Node* node = table->Slots[i].load(std::memory_order_acquire);
+            if (!node)
+                return nullptr;
+            if (node->Hash == hash && DescEqual(node->Key, desc))
+                return &node->Value;
+        }
+    }
+
+    static void InsertNode(Table* table, const Node* node)
+    {
+        size_t mask = table->Slots.size() - 1;
+        size_t i = HashMix(node->Hash) & mask;
+        while (table->Slots[i].load(std::memory_order_relaxed))
+            i = (i + 1) & mask;
+        table->Slots[i].store(node, std::memory_order_release);
+    }
+
+    std::atomic<Table*> m_Table{ nullptr };
+    std::vector<std::unique_ptr<Table>> m_Tables;
+    std::vector<std::unique_ptr<Node>> m_Nodes;
+    mutable std::mutex m_InsertMutex;
+    mutable std::atomic<uint64_t> m_Hits{ 0 };
+    mutable std::atomic<uint64_t> m_Misses{ 0 };
+    uint64_t m_Resizes = 0;
+};
+
+inline uint64_t HashDesc(const RasterizerDesc& desc)
+{
+    uint64_t hash = HashValue(desc.Fill);
+    hash = HashValue(desc.Cull, hash);
+    hash = HashValue(desc.FrontCounterClockwise, hash);
+    return HashValue(desc.DepthClipEnable, hash);
+}
+
+inline bool DescEqual(const RasterizerDesc& a, const RasterizerDesc& b)
+{
+    return a.Fill == b.Fill && a.Cull == b.Cull && a.FrontCounterClockwise == b.FrontCounterClockwise &&
+        a.DepthClipEnable == b.DepthClipEnable;
+}
@@ -0,0 +1,297 @@
+#include "TransformBatch.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <new>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define TRANSFORM_BATCH_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TRANSFORM_BATCH_SSE2 1
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define TRANSFORM_BATCH_NEON 1
+#endif
+
+namespace
+{
+    constexpr size_t ElementAlignment = 32;
+
+    // Lanes handled per iteration of the SIMD loop
+#if defined(TRANSFORM_BATCH_AVX2)
+    constexpr size_t BatchSize = 8;
+#elif defined(TRANSFORM_BATCH_SSE2) || defined(TRANSFORM_BATCH_NEON)
+    constexpr size_t BatchSize = 4;
+#else
+    constexpr size_t BatchSize = 1;
+#endif
+
+    float* OutputMatrix(void* output, size_t index, size_t outputStride)
+    {
+        return reinterpret_cast<float*>(static_cast<uint8_t*>(output) + index * outputStride);
+    }
+
+#if defined(TRANSFORM_BATCH_AVX2)
+    // Rows r[0..7] of 8 lanes become 8 rows holding one lane each
+    void Transpose8x8(__m256 r[8])
+    {
+        __m256 t0 = _mm256_unpacklo_ps(r[0], r[1]);
+        __m256 t1 = _mm256_unpackhi_ps(r[0], r[1]);
+        __m256 t2 = _mm256_unpacklo_ps(r[2], r[3]);
+        __m256 t3 = _mm256_unpackhi_ps(r[2], r[3]);
+        __m256 t4 = _mm256_unpacklo_ps(r[4], r[5]);
+        __m256 t5 = _mm256_unpackhi_ps(r[4], r[5]);
+        __m256 t6 = _mm256_unpacklo_ps(r[6], r[7]);
+        __m256 t7 = _mm256_unpackhi_ps(r[6], r[7]);
+
+        __m256 s0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+        __m256 s1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+        __m256 s2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+        __m256 s3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+        __m256 s4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0));
+        __m256 s5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+        __m256 s6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0));
+        __m256 s7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+
+        r[0] = _mm256_permute2f128_ps(s0, s4, 0x20);
+        r[1] = _mm256_permute2f128_ps(s1, s5, 0x20);
+        r[2] = _mm256_permute2f128_ps(s2, s6, 0x20);
+        r[3] = _mm256_permute2f128_ps(s3, s7, 0x20);
+        r[4] = _mm256_permute2f128_ps(s0, s4, 0x31);
+        r[5] = _mm256_permute2f128_ps(s1, s5, 0x31);
+        r[6] = _mm256_permute2f128_ps(s2, s6, 0x31);
+        r[7] = _mm256_permute2f128_ps(s3, s7, 0x31);
+    }
+
+    size_t TransformBatches(const WorldMatrixArray& worlds, const Float4x4& vp, size_t begin, size_t end,
+        void* output, size_t outputStride)
+    {
+        __m256 viewProjection[4][4];
+        for (int k = 0; k < 4; ++k)
+            for (int c = 0; c < 4; ++c)
+                viewProjection[k][c] = _mm256_set1_ps(vp.m[k][c]);
+
+        size_t i = begin;
+        for (; i + BatchSize <= end; i += BatchSize)
+        {
+            // wvp[c * 4 + r] holds element [c][r] of the transposed result for 8 objects
+            __m256 wvp[16];
+            for (int r = 0; r < 4; ++r)
+            {
+                __m256 w0 = _mm256_loadu_ps(worlds.GetElements(r, 0) + i);
+                __m256 w1 = _mm256_loadu_ps(worlds.GetElements(r, 1) + i);
+                __m256 w2 = _mm256_loadu_ps(worlds.GetElements(r, 2) + i);
+                __m256 w3 = _mm256_loadu_ps(worlds.GetElements(r, 3) + i);
+                for (int c = 0; c < 4; ++c)
+                {
+                    __m256 sum = _mm256_mul_ps(w0, viewProjection[0][c]);
+                    sum = _mm256_add_ps(sum, _mm256_mul_ps(w1, viewProjection[1][c]));
+                    sum = _mm256_add_ps(sum, _mm256_mul_ps(w2, viewProjection[2][c]));
+                    sum = _mm256_add_ps(sum, _mm256_mul_ps(w3, viewProjection[3][c]));
+                    wvp[c * 4 + r] = sum;
+                }
+            }
+
+            // Two 8x8 transposes turn the lanes into the first and second half of each matrix
+            Transpose8x8(wvp);
+            Transpose8x8(wvp + 8);
+            for (size_t lane = 0; lane < BatchSize; ++lane)
+            {
+                float* matrix = OutputMatrix(output, i - begin + lane, outputStride);
+                _mm256_storeu_ps(matrix, wvp[lane]);
+                _mm256_storeu_ps(matrix + 8, wvp[8 + lane]);
+            }
+        }
+        return i;
+    }
+#elif defined(TRANSFORM_BATCH_SSE2)
+    size_t TransformBatches(const WorldMatrixArray& worlds, const Float4x4& vp, size_t begin, size_t end,
+        void* output, size_t outputStride)
+    {
+        __m128 viewProjection[4][4];
+        for (int k = 0; k < 4; ++k)
+            for (int c = 0; c < 4; ++c)
+                viewProjection[k][c] = _mm_set1_ps(vp.m[k][c]);
+
+        size_t i = begin;
+        for (; i + BatchSize <= end; i += BatchSize)
+        {
+            __m128 wvp[16];
+            for (int r = 0; r < 4; ++r)
+            {
+                __m128 w0 = _mm_loadu_ps(worlds.GetElements(r, 0) + i);
+                __m128 w1 = _mm_loadu_ps(worlds.GetElements(r, 1) + i);
+                __m128 w2 = _mm_loadu_ps(worlds.GetElements(r, 2) + i);
+                __m128 w3 = _mm_loadu_ps(worlds.GetElements(r, 3) + i);
+                for (int c = 0; c < 4; ++c)
+                {
+                    __m128 sum = _mm_mul_ps(w0, viewProjection[0][c]);
+                    sum = _mm_add_ps(sum, _mm_mul_ps(w1, viewProjection[1][c]));
+                    sum = _mm_add_ps(sum, _mm_mul_ps(w2, viewProjection[2][c]));
+                    sum = _mm_add_ps(sum, _mm_mul_ps(w3, viewProjection[3][c]));
+                    wvp[c * 4 + r] = sum;
+                }
+            }
+
+            // Each group of 4 vectors is one row of the transposed result for 4 objects
+            for (int row = 0; row < 4; ++row)
+            {
+                __m128* v = wvp + row * 4;
+                _MM_TRANSPOSE4_PS(v[0], v[1], v[2], v[3]);
+                for (size_t lane = 0; lane < BatchSize; ++lane)
+                    _mm_storeu_ps(OutputMatrix(output, i - begin + lane, outputStride) + row * 4, v[lane]);
+            }
+        }
+        return i;
+    }
+#elif defined(TRANSFORM_BATCH_NEON)
+    size_t TransformBatches(const WorldMatrixArray& worlds, const Float4x4& vp, size_t begin, size_t end,
+        void* output, size_t outputStride)
+    {
+        float32x4_t viewProjection[4][4];
+        for (int k = 0; k < 4; ++k)
+            for (int c = 0; c < 4; ++c)
+                viewProjection[k][c] = vdupq_n_f32(vp.m[k][c]);
+
+        size_t i = begin;
+        for (; i + BatchSize <= end; i += BatchSize)
+        {
+            float32x4_t wvp[16];
+            for (int r = 0; r < 4; ++r)
+            {
+                float32x4_t w0 = vld1q_f32(worlds.GetElements(r, 0) + i);
+                float32x4_t w1 = vld1q_f32(worlds.GetElements(r, 1) + i);
+                float32x4_t w2 = vld1q_f32(worlds.GetElements(r, 2) + i);
+                float32x4_t w3 = vld1q_f32(worlds.GetElements(r, 3) + i);
+                for (int c = 0; c < 4; ++c)
+                {
+                    float32x4_t sum = vmulq_f32(w0, viewProjection[0][c]);
+                    sum = vaddq_f32(sum, vmulq_f32(w1, viewProjection[1][c]));
+                    sum = vaddq_f32(sum, vmulq_f32(w2, viewProjection[2][c]));
+                    sum = vaddq_f32(sum, vmulq_f32(w3, viewProjection[3][c]));
+                    wvp[c * 4 + r] = sum;
+                }
+            }
+
+            for (int row = 0; row < 4; ++row)
+            {
+                const float32x4_t* v = wvp + row * 4;
+                float32x4x2_t t01 = vtrnq_f32(v[0], v[1]);
+                float32x4x2_t t23 = vtrnq_f32(v[2], v[3]);
+                float32x4_t lanes[4] =
+                {
+                    vcombine_f32(vget_low_f32(t01.val[0]), vget_low_f32(t23.val[0])),
+                    vcombine_f32(vget_low_f32(t01.val[1]), vget_low_f32(t23.val[1])),
+                    vcombine_f32(vget_high_f32(t01.val[0]), vget_high_f32(t23.val[0])),
+                    vcombine_f32(vget_high_f32(t01.val[1]), vget_high_f32(t23.val[1])),
+                };
+                for (size_t lane = 0; lane < BatchSize; ++lane)
+                    vst1q_f32(OutputMatrix(output, i - begin + lane, outputStride) + row * 4, lanes[lane]);
+            }
+        }
+        return i;
+    }
+#else
+    size_t TransformBatches(const WorldMatrixArray&, const Float4x4&, size_t begin, size_t, void*, size_t)
+    {
+        return begin;
+    }
+#endif
+}
+
+void WorldMatrixArray::AlignedDelete::operator()(float* p) const
+{
+    ::operator delete[](p, std::align_val_t(ElementAlignment));
+}
+
+WorldMatrixArray::WorldMatrixArray(size_t count)
+{
+    Resize(count);
+}
+
+void WorldMatrixArray::Resize(size_t count)
+{
+    // Round up so every element array starts on a 32-byte boundary
+    size_t capacity = (count + 7) & ~size_t(7);
+    std::unique_ptr<float[], AlignedDelete> elements;
+    if (capacity)
+        elements.reset(static_cast<float*>(::operator new[](capacity * 16 * sizeof(float), std::align_val_t(ElementAlignment))));
+
+    size_t kept = std::min(count, m_Count);
+    for (int element = 0; element < 16; ++element)
+    {
+        float* destination = elements.get() + element * capacity;
+        float identity = (element % 5 == 0) ? 1.0f : 0.0f;
+        if (kept)
+            std::memcpy(destination, m_Elements.get() + element * m_Capacity, kept * sizeof(float));
+        std::fill(destination + kept, destination + capacity, identity);
+    }
+
+    m_Count = count;
+    m_Capacity = capacity;
+    m_Elements = std::move(elements);
+}
+
+void WorldMatrixArray::Set(size_t index, const Float4x4& world)
+{
+    for (int row = 0; row < 4; ++row)
+        for (int col = 0; col < 4; ++col)
+            GetElements(row, col)[index] = world.m[row][col];
+}
+
+Float4x4 WorldMatrixArray::Get(size_t index) const
+{
+    Float4x4 world;
+    for (int row = 0; row < 4; ++row)
+        for (int col = 0; col < 4; ++col)
+            world.m[row][col] = GetElements(row, col)[index];
+    return world;
+}
+
+void TransformWorldViewProjection(const WorldMatrixArray& worlds, const Float4x4& viewProjection,
+    size_t begin, size_t end, void* output, size_t outputStride)
+{
+    size_t done = TransformBatches(worlds, viewProjection, begin, end, output, outputStride);
+    TransformWorldViewProjectionScalar(worlds, viewProjection, done, end,
+        static_cast<uint8_t*>(output) + (done - begin) * outputStride, outputStride);
+}
+
+void TransformWorldViewProjectionScalar(const WorldMatrixArray& worlds, const Float4x4& viewProjection,
+    size_t begin, size_t end, void* output, size_t outputStride)
+{
+    // Local copies so stores to output cannot force reloads
+    const Float4x4 vp = viewProjection;
+    const float* elements[16];
+    for (int e = 0; e < 16; ++e)
+        elements[e] = worlds.GetElements(e / 4, e % 4);
+
+    for (size_t i = begin; i < end; ++i)
+    {
+        float* matrix = OutputMatrix(output, i - begin, outputStride);
+        for (int r = 0; r < 4; ++r)
+        {
+            float w0 = elements[r * 4 + 0][i];
+            float w1 = elements[r * 4 + 1][i];
+            float w2 = elements[r * 4 + 2][i];
+            float w3 = elements[r * 4 + 3][i];
+            for (int c = 0; c < 4; ++c)
+                matrix[c * 4 + r] = w0 * vp.m[0][c] + w1 * vp.m[1][c] + w2 * vp.m[2][c] + w3 * vp.m[3][c];
+        }
+    }
+}
+
+const char* GetTransformBatchInstructionSet()
+{
+#if defined(TRANSFORM_BATCH_AVX2)
+    return "avx2";
+#elif defined(TRANSFORM_BATCH_SSE2)
+    return "sse2";
+#elif defined(TRANSFORM_BATCH_NEON)
+    return "neon";
+#else
+    return "scalar";
+#endif
+}
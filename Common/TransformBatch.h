@@ -0,0 +1,53 @@
+#pragma once
+
+// Batched World * View * Projection for many objects. World matrices are kept
+// structure-of-arrays (one array per matrix element) so 8 (AVX2) or 4 (SSE/NEON)
+// objects are multiplied per instruction; View * Projection is computed once per
+// frame by the caller. The result is written already transposed, in the layout
+// of a cbuffer float4x4, so the output pointer can be mapped upload memory.
+
+#include <cstddef>
+#include <memory>
+
+#include "MathUtil.h"
+
+class WorldMatrixArray
+{
+public:
+    explicit WorldMatrixArray(size_t count = 0);
+
+    // Keeps the first min(count, GetCount()) matrices; new ones are identity
+    void Resize(size_t count);
+    size_t GetCount() const { return m_Count; }
+
+    void Set(size_t index, const Float4x4& world);
+    Float4x4 Get(size_t index) const;
+
+    // Element [row][col] of every matrix, GetCount() floats, 32-byte aligned
+    float* GetElements(int row, int col) { return m_Elements.get() + (row * 4 + col) * m_Capacity; }
+    const float* GetElements(int row, int col) const { return m_Elements.get() + (row * 4 + col) * m_Capacity; }
+
+private:
+    struct AlignedDelete
+    {
+        void operator()(float* p) const;
+    };
+
+    size_t m_Count = 0;
+    size_t m_Capacity = 0;
+    std::unique_ptr<float[], AlignedDelete> m_Elements;
+};
+
+// Writes Transpose(worlds[i] * viewProjection) for every i in [begin, end) to
+// output + (i - begin) * outputStride. outputStride is in bytes and must be at
+// least sizeof(Float4x4), so the matrix can sit at the start of a larger cbuffer.
+// Independent ranges can run on different threads.
+void TransformWorldViewProjection(const WorldMatrixArray& worlds, const Float4x4& viewProjection,
+    size_t begin, size_t end, void* output, size_t outputStride);
+
+// Same result one matrix at a time, used for the tail of a batch and as reference
+void TransformWorldViewProjectionScalar(const WorldMatrixArray& worlds, const Float4x4& viewProjection,
+    size_t begin, size_t end, void* output, size_t outputStride);
+
+// "avx2", "sse2", "neon" or "scalar", chosen at compile time
+const char* GetTransformBatchInstructionSet();
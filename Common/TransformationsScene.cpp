@@ -0,0 +1,106 @@
+#include "TransformationsScene.h"
+
+#include <iterator>
+
+#include "CubeMesh.h"
+
+bool TransformationsScene::Initialize(RenderDevice& device)
+{
+    m_Device = &device;
+
+    // Create the shaders and input layout
+    ShaderDesc vsDesc = { "Effects.fx", "VS", "vs_5_0", { std::begin(VertexInputLayout), std::end(VertexInputLayout) } };
+    if (!device.CreateVertexShader(vsDesc, &m_VertexShader))
+        return false;
+
+    ShaderDesc psDesc = { "Effects.fx", "PS", "ps_5_0", {} };
+    if (!device.CreatePixelShader(psDesc, &m_PixelShader))
+        return false;
+
+    // Create vertex and index buffers
+    BufferDesc bd;
+    bd.ByteWidth = sizeof(CubeVertices);
+    bd.Bind = BufferBind::VertexBuffer;
+    if (!device.CreateBuffer(bd, CubeVertices, &m_VertexBuffer))
+        return false;
+
+    bd.ByteWidth = sizeof(CubeIndices);
+    bd.Bind = BufferBind::IndexBuffer;
+    if (!device.CreateBuffer(bd, CubeIndices, &m_IndexBuffer))
+        return false;
+
+    // The first cube is spun and scaled, offset along X, and the offset orbited; the second
+    // circles in the XY plane while its frame spins around Z
+    m_Orbit = m_Graph.CreateNode();
+    m_Offset = m_Graph.CreateNode(m_Orbit);
+    m_Cubes[0] = m_Graph.CreateNode(m_Offset);
+    m_Spin = m_Graph.CreateNode();
+    m_Cubes[1] = m_Graph.CreateNode(m_Spin);
+
+    // Initialize the view matrix
+    m_View = MatrixLookAtLH({ 0.0f, 3.0f, -8.0f }, { 0.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f });
+
+    Resize(device.GetWidth(), device.GetHeight());
+    return true;
+}
+
+void TransformationsScene::Resize(uint32_t width, uint32_t height)
+{
+    if (width == 0 || height == 0)
+        return;
+
+    m_Viewport = m_Device->GetDefaultViewport();
+    m_Projection = MatrixPerspectiveFovLH(MathPiDiv2, width / static_cast<float>(height), 0.01f, 100.0f);
+}
+
+void TransformationsScene::Update(float t)
+{
+    // Orbit the first cube around the (1, 1, 1) axis
+    m_Graph.SetLocalRotation(m_Orbit, QuaternionRotationAxis(Vector3Normalize({ 1.0f, 1.0f, 1.0f }), t));
+    m_Graph.SetLocalPosition(m_Offset, { 5.0f * std::sin(t * 0.5f), 0.0f, 0.0f });
+    float scale = 0.5f + 0.25f * std::sin(t);
+    m_Graph.SetLocalTransform(m_Cubes[0], { 0.0f, 0.0f, 0.0f }, QuaternionRotationAxis({ 0.0f, 1.0f, 0.0f }, t * 2.0f),
+        { scale, scale, scale });
+
+    // Update the second cube
+    m_Graph.SetLocalRotation(m_Spin, QuaternionRotationAxis({ 0.0f, 0.0f, 1.0f }, t * 3.0f));
+    m_Graph.SetLocalPosition(m_Cubes[1], { 4.0f * std::cos(t), 2.0f * std::sin(t), 0.0f });
+    m_Graph.Update();
+
+    // World-space boxes around the unit cube for culling
+    for (size_t i = 0; i < m_Worlds.GetCount(); ++i)
+    {
+        m_Worlds.Set(i, m_Graph.GetWorld(m_Cubes[i]));
+        m_Bounds.SetTransformed(i, { 0.0f, 0.0f, 0.0f }, { 1.0f, 1.0f, 1.0f }, m_Worlds.Get(i));
+    }
+}
+
+void TransformationsScene::Draw(RenderContext& context)
+{
+    float clearColor[4] = { 0.0f, 0.125f, 0.3f, 1.0f }; // RGBA
+    context.ClearRenderTarget(clearColor);
+    context.ClearDepthStencil(1.0f, 0);
+    context.SetViewport(m_Viewport);
+
+    context.SetVertexBuffer(0, m_VertexBuffer, sizeof(Vertex), 0);
+    context.SetIndexBuffer(m_IndexBuffer, CubeIndexFormat, 0);
+
+    // Set shaders
+    context.SetVertexShader(m_VertexShader);
+    context.SetPixelShader(m_PixelShader);
+
+    // View * Projection once, then the transposed WVP of every cube in one batch
+    Float4x4 viewProjection = m_View * m_Projection;
+    TransformWorldViewProjection(m_Worlds, viewProjection, 0, m_Worlds.GetCount(),
+        m_ObjectConstants, sizeof(ConstantBuffer));
+
+    // Only the cubes that can be on screen
+    m_Culler.Cull(nullptr, ExtractFrustum(viewProjection), m_Bounds, CullShape::Box);
+    for (size_t i = 0; i < m_Culler.GetVisibleCount(); ++i)
+    {
+        const ConstantBuffer& cb = m_ObjectConstants[m_Culler.GetVisible()[i]];
+        ConstantBufferRange constants = context.AllocateConstants(&cb, sizeof(cb));
+        context.SetVSConstantBufferRange(0, constants);
+        context.DrawIndexed(CubeIndexCount, 0, 0);
+    }
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+// "09. Transformations" exercise: one cube scaled, spun, translated and orbited
+// around the (1, 1, 1) axis, and a second cube circling in the XY plane. Each
+// step is a node of a SceneGraph, so the cubes' worlds are composed by the
+// hierarchy rather than by hand. Cubes outside the view frustum are not drawn.
+
+#include "FrustumCulling.h"
+#include "MathUtil.h"
+#include "Scene.h"
+#include "SceneGraph.h"
+#include "TransformBatch.h"
+
+class TransformationsScene final : public Scene
+{
+public:
+    const char* GetName() const override { return "Transformations"; }
+
+    bool Initialize(RenderDevice& device) override;
+    void Resize(uint32_t width, uint32_t height) override;
+    void Update(float t) override;
+    void Draw(RenderContext& context) override;
+
+private:
+    struct ConstantBuffer
+    {
+        Float4x4 mWVP;
+    };
+
+    RenderDevice* m_Device = nullptr;
+    VertexShaderHandle m_VertexShader;
+    PixelShaderHandle m_PixelShader;
+    BufferHandle m_VertexBuffer;
+    BufferHandle m_IndexBuffer;
+
+    // Orbit -> offset -> first cube, and spin -> second cube
+    SceneGraph m_Graph;
+    uint32_t m_Orbit = SceneGraph::NoNode;
+    uint32_t m_Offset = SceneGraph::NoNode;
+    uint32_t m_Spin = SceneGraph::NoNode;
+    uint32_t m_Cubes[2] = { SceneGraph::NoNode, SceneGraph::NoNode };
+
+    WorldMatrixArray m_Worlds{ 2 };
+    BoundsArray m_Bounds{ 2 };
+    FrustumCuller m_Culler;
+    ConstantBuffer m_ObjectConstants[2];
+    Float4x4 m_View = MatrixIdentity();
+    Float4x4 m_Projection = MatrixIdentity();
+    Viewport m_Viewport;
+};
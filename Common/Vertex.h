@@ -0,0 +1,20 @@
+#pragma once
+
+#include "MathUtil.h"
+#include "RenderTypes.h"
+
+// Same memory layout as the tutorials' Vertex { XMFLOAT3 Position; XMFLOAT4 Color; }
+struct Vertex
+{
+    Float3 Position;
+    Float4 Color;
+};
+
+static_assert(sizeof(Vertex) == 28, "Vertex must match the D3D11 input layout (POSITION + COLOR)");
+
+// Input layout matching Vertex and the VS input of Effects.fx
+inline const InputElementDesc VertexInputLayout[] =
+{
+    { "POSITION", 0, Format::R32G32B32Float, 0, 0, false, 0 },
+    { "COLOR", 0, Format::R32G32B32A32Float, 0, 12, false, 0 },
+};
@@ -0,0 +1,341 @@
+#include "VertexWelder.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#include "Hash.h"
+
+#if defined(_MSC_VER)
+#include <xmmintrin.h>
+#endif
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    constexpr size_t BlockSize = 1 << 16;
+    constexpr uint32_t VerticesPerPartition = 1 << 14;
+    constexpr uint32_t MaxPartitionBits = 12;
+
+    // Partition vertices are read this far ahead of the one being welded
+    constexpr uint32_t PrefetchDistance = 16;
+
+    double ElapsedMs(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    // Runs function over [0, count) on the job system, or inline without one
+    void RunParallel(JobSystem* jobSystem, size_t count, const JobSystem::RangeFunction& function)
+    {
+        if (jobSystem)
+            jobSystem->ParallelFor(count, 1, function);
+        else if (count)
+            function(0, count, 0);
+    }
+
+    void Prefetch(const void* address)
+    {
+#if defined(_MSC_VER)
+        _mm_prefetch(static_cast<const char*>(address), _MM_HINT_T0);
+#else
+        __builtin_prefetch(address);
+#endif
+    }
+
+    // Position and color reduced to what decides whether two vertices weld
+    struct WeldKey
+    {
+        uint32_t Words[8];
+
+        bool operator==(const WeldKey& other) const { return std::memcmp(Words, other.Words, sizeof(Words)) == 0; }
+    };
+
+    class KeyBuilder
+    {
+    public:
+        explicit KeyBuilder(const VertexWeldOptions& options)
+            : m_InversePosition(options.PositionTolerance > 0.0f ? 1.0f / options.PositionTolerance : 0.0f),
+            m_InverseColor(options.ColorTolerance > 0.0f ? 1.0f / options.ColorTolerance : 0.0f)
+        {
+        }
+
+        WeldKey GetKey(const Vertex& vertex) const
+        {
+            WeldKey key;
+            key.Words[0] = Quantize(vertex.Position.x, m_InversePosition);
+            key.Words[1] = Quantize(vertex.Position.y, m_InversePosition);
+            key.Words[2] = Quantize(vertex.Position.z, m_InversePosition);
+            key.Words[3] = Quantize(vertex.Color.x, m_InverseColor);
+            key.Words[4] = Quantize(vertex.Color.y, m_InverseColor);
+            key.Words[5] = Quantize(vertex.Color.z, m_InverseColor);
+            key.Words[6] = Quantize(vertex.Color.w, m_InverseColor);
+            key.Words[7] = 0;
+            return key;
+        }
+
+        static uint32_t GetHash(const WeldKey& key)
+        {
+            uint64_t hash = HashSeed;
+            for (int i = 0; i < 8; i += 2)
+                hash = HashWord(key.Words[i] | uint64_t(key.Words[i + 1]) << 32, hash);
+            return static_cast<uint32_t>(HashMix(hash) >> 32);
+        }
+
+    private:
+        // The bits of the value (with -0 made +0) when exact, otherwise the nearest multiple
+        // of the tolerance, clamped to 32 bits
+        static uint32_t Quantize(float value, float inverseStep)
+        {
+            if (inverseStep == 0.0f)
+            {
+                float normalized = value + 0.0f;
+                uint32_t bits;
+                std::memcpy(&bits, &normalized, sizeof(bits));
+                return bits;
+            }
+            // Clamped first so that the conversion is defined; NaN takes the low end. The truncation
+            // is corrected downwards instead of calling floor, which is not inlined without SSE4.1
+            float scaled = value * inverseStep + 0.5f;
+            if (!(scaled >= -2147483648.0f))
+                scaled = -2147483648.0f;
+            scaled = std::min(scaled, 2147483520.0f);
+            int32_t step = static_cast<int32_t>(scaled);
+            step -= static_cast<float>(step) > scaled;
+            return static_cast<uint32_t>(step);
+        }
+
+        float m_InversePosition;
+        float m_InverseColor;
+    };
+
+    uint32_t GetPartitionBits(uint32_t vertexCount, uint32_t requested)
+    {
+        if (requested > 0)
+            return std::min(requested, MaxPartitionBits);
+        uint32_t bits = 0;
+        while (bits < MaxPartitionBits && (uint64_t(VerticesPerPartition) << bits) < vertexCount)
+            ++bits;
+        return bits;
+    }
+
+    // Open addressing with linear probing; an entry holds the hash in the high half and the
+    // partition's representative + 1 in the low half, 0 when empty. The representatives' keys
+    // are kept next to the table so that a probe does not round the stored vertex again.
+    class WeldTable
+    {
+    public:
+        void Reset(uint32_t vertexCount)
+        {
+            size_t size = 16;
+            while (size < size_t(vertexCount) * 2)
+                size *= 2;
+            if (m_Entries.size() < size)
+                m_Entries.resize(size);
+            std::fill(m_Entries.begin(), m_Entries.begin() + size, 0);
+            m_Mask = size - 1;
+            m_Keys.clear();
+            m_Vertices.clear();
+        }
+
+        // Returns the first soup vertex with the key of vertex, inserting vertex if there is none
+        uint32_t FindOrInsert(uint32_t vertex, uint32_t hash, const WeldKey& key)
+        {
+            for (size_t slot = hash & m_Mask;; slot = (slot + 1) & m_Mask)
+            {
+                uint64_t entry = m_Entries[slot];
+                if (entry == 0)
+                {
+                    m_Entries[slot] = uint64_t(hash) << 32 | (m_Vertices.size() + 1);
+                    m_Keys.push_back(key);
+                    m_Vertices.push_back(vertex);
+                    return vertex;
+                }
+                uint32_t other = static_cast<uint32_t>(entry) - 1;
+                if (static_cast<uint32_t>(entry >> 32) == hash && m_Keys[other] == key)
+                    return m_Vertices[other];
+            }
+        }
+
+        size_t GetBytes() const
+        {
+            return m_Entries.capacity() * sizeof(uint64_t) + m_Keys.capacity() * sizeof(WeldKey) +
+                m_Vertices.capacity() * sizeof(uint32_t);
+        }
+
+    private:
+        std::vector<uint64_t> m_Entries;
+        std::vector<WeldKey> m_Keys;
+        std::vector<uint32_t> m_Vertices;
+        size_t m_Mask = 0;
+    };
+}
+
+bool WeldVertices(const Vertex* vertices, size_t vertexCount, const VertexWeldOptions& options,
+    JobSystem* jobSystem, MeshData* mesh, VertexWeldStats* stats)
+{
+    if (vertexCount >= std::numeric_limits<uint32_t>::max())
+        return false;
+
+    uint32_t count = static_cast<uint32_t>(vertexCount - vertexCount % 3);
+    KeyBuilder keys(options);
+    uint32_t partitionBits = GetPartitionBits(count, options.PartitionBits);
+    uint32_t partitionCount = 1u << partitionBits;
+    uint32_t partitionShift = 32 - partitionBits;
+    size_t blockCount = (size_t(count) + BlockSize - 1) / BlockSize;
+    VertexWeldStats result;
+    result.Partitions = partitionCount;
+
+    // 1. Keys, hashes and the partition histogram of every block
+    Clock::time_point start = Clock::now();
+    std::vector<uint32_t> hashes(count);
+    std::vector<uint32_t> blockOffsets(blockCount * partitionCount, 0);
+    RunParallel(jobSystem, blockCount, [&](size_t begin, size_t end, unsigned int)
+    {
+        for (size_t block = begin; block < end; ++block)
+        {
+            uint32_t* histogram = blockOffsets.data() + block * partitionCount;
+            uint32_t last = static_cast<uint32_t>(std::min<size_t>((block + 1) * BlockSize, count));
+            for (uint32_t i = static_cast<uint32_t>(block * BlockSize); i < last; ++i)
+            {
+                uint32_t hash = KeyBuilder::GetHash(keys.GetKey(vertices[i]));
+                hashes[i] = hash;
+                ++histogram[partitionBits ? hash >> partitionShift : 0];
+            }
+        }
+    });
+    result.HashMs = ElapsedMs(start);
+
+    // 2. Partition p gets the vertices of block 0, then block 1, ...: the counts in partition-major
+    // order turn into each block's write offset, and order lists every partition in soup order
+    start = Clock::now();
+    std::vector<uint32_t> partitionStarts(partitionCount + 1);
+    uint32_t offset = 0;
+    for (uint32_t p = 0; p < partitionCount; ++p)
+    {
+        partitionStarts[p] = offset;
+        for (size_t block = 0; block < blockCount; ++block)
+        {
+            uint32_t& slot = blockOffsets[block * partitionCount + p];
+            uint32_t blockVertices = slot;
+            slot = offset;
+            offset += blockVertices;
+        }
+    }
+    partitionStarts[partitionCount] = offset;
+
+    std::vector<uint32_t> order(count);
+    RunParallel(jobSystem, blockCount, [&](size_t begin, size_t end, unsigned int)
+    {
+        for (size_t block = begin; block < end; ++block)
+        {
+            uint32_t* offsets = blockOffsets.data() + block * partitionCount;
+            uint32_t last = static_cast<uint32_t>(std::min<size_t>((block + 1) * BlockSize, count));
+            for (uint32_t i = static_cast<uint32_t>(block * BlockSize); i < last; ++i)
+                order[offsets[partitionBits ? hashes[i] >> partitionShift : 0]++] = i;
+        }
+    });
+    result.PartitionMs = ElapsedMs(start);
+
+    // 3. Weld each partition; indices[i] receives the first soup vertex equal to vertex i
+    start = Clock::now();
+    std::vector<uint32_t>& indices = mesh->Indices;
+    indices.resize(count);
+    std::vector<WeldTable> tables(jobSystem ? jobSystem->GetWorkerCount() : 1);
+    RunParallel(jobSystem, partitionCount, [&](size_t begin, size_t end, unsigned int workerIndex)
+    {
+        WeldTable& table = tables[workerIndex];
+        for (size_t p = begin; p < end; ++p)
+        {
+            table.Reset(partitionStarts[p + 1] - partitionStarts[p]);
+            for (uint32_t j = partitionStarts[p]; j < partitionStarts[p + 1]; ++j)
+            {
+                // A partition's vertices are spread over the whole soup: fetch them ahead
+                if (j + PrefetchDistance < partitionStarts[p + 1])
+                {
+                    uint32_t ahead = order[j + PrefetchDistance];
+                    Prefetch(vertices + ahead);
+                    Prefetch(hashes.data() + ahead);
+                    Prefetch(indices.data() + ahead);
+                }
+                uint32_t i = order[j];
+                indices[i] = table.FindOrInsert(i, hashes[i], keys.GetKey(vertices[i]));
+            }
+        }
+    });
+    result.WeldMs = ElapsedMs(start);
+    result.TemporaryBytes = (hashes.size() + order.size() + blockOffsets.size() + partitionStarts.size()) *
+        sizeof(uint32_t);
+    for (const WeldTable& table : tables)
+        result.TemporaryBytes += table.GetBytes();
+    hashes = {};
+
+    // 4. Number the first occurrences in soup order (order now maps soup vertex -> output vertex),
+    // then point every index at its output vertex
+    start = Clock::now();
+    std::vector<uint32_t> blockFirsts(blockCount + 1, 0);
+    RunParallel(jobSystem, blockCount, [&](size_t begin, size_t end, unsigned int)
+    {
+        for (size_t block = begin; block < end; ++block)
+        {
+            uint32_t last = static_cast<uint32_t>(std::min<size_t>((block + 1) * BlockSize, count));
+            for (uint32_t i = static_cast<uint32_t>(block * BlockSize); i < last; ++i)
+                blockFirsts[block + 1] += indices[i] == i;
+        }
+    });
+    for (size_t block = 0; block < blockCount; ++block)
+        blockFirsts[block + 1] += blockFirsts[block];
+    result.UniqueVertices = blockFirsts[blockCount];
+
+    mesh->Vertices.resize(result.UniqueVertices);
+    RunParallel(jobSystem, blockCount, [&](size_t begin, size_t end, unsigned int)
+    {
+        for (size_t block = begin; block < end; ++block)
+        {
+            uint32_t next = blockFirsts[block];
+            uint32_t last = static_cast<uint32_t>(std::min<size_t>((block + 1) * BlockSize, count));
+            for (uint32_t i = static_cast<uint32_t>(block * BlockSize); i < last; ++i)
+            {
+                if (indices[i] == i)
+                {
+                    mesh->Vertices[next] = vertices[i];
+                    order[i] = next++;
+                }
+            }
+        }
+    });
+    RunParallel(jobSystem, blockCount, [&](size_t begin, size_t end, unsigned int)
+    {
+        for (size_t block = begin; block < end; ++block)
+        {
+            uint32_t last = static_cast<uint32_t>(std::min<size_t>((block + 1) * BlockSize, count));
+            for (uint32_t i = static_cast<uint32_t>(block * BlockSize); i < last; ++i)
+                indices[i] = order[indices[i]];
+        }
+    });
+
+    if (options.RemoveDegenerateTriangles)
+    {
+        uint32_t kept = 0;
+        for (uint32_t i = 0; i < count; i += 3)
+        {
+            uint32_t a = indices[i], b = indices[i + 1], c = indices[i + 2];
+            if (a == b || b == c || c == a)
+                continue;
+            indices[kept] = a;
+            indices[kept + 1] = b;
+            indices[kept + 2] = c;
+            kept += 3;
+        }
+        result.DegenerateTriangles = (count - kept) / 3;
+        indices.resize(kept);
+    }
+    result.OutputMs = ElapsedMs(start);
+
+    if (stats)
+        *stats = result;
+    return true;
+}
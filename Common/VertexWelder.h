@@ -0,0 +1,60 @@
+#pragma once
+
+// Builds an indexed mesh from a triangle soup: three Vertex records per
+// triangle, as tutorial 05 draws them before 06 indexes the cube by hand.
+// Vertices that are equal, or equal within a tolerance, are welded into one
+// and every soup vertex becomes an index to it.
+//
+// The soup is welded with a parallel hash in three passes over blocks of
+// vertices:
+//   1. Every vertex is reduced to a key (its attributes rounded to the
+//      tolerance) and a 32-bit hash, and each block counts how many of its
+//      vertices fall into each of the partitions the top hash bits select.
+//   2. The counts give every block its slice of each partition, and the
+//      blocks scatter their vertex numbers there (a radix partition), so each
+//      partition lists its vertices in soup order.
+//   3. The partitions are welded independently, one open-addressing table
+//      each, sized to stay in the worker's cache.
+// Welded vertices keep the attributes of their first occurrence, and the
+// output vertices are in first-occurrence order, so the result does not
+// depend on the number of threads.
+//
+// With a tolerance, values weld when they round to the same multiple of it:
+// values closer than the tolerance stay apart when a rounding boundary lies
+// between them.
+
+#include <cstddef>
+#include <cstdint>
+
+#include "JobSystem.h"
+#include "MeshImporter.h"
+#include "Vertex.h"
+
+struct VertexWeldOptions
+{
+    // Rounding steps; 0 welds only exact matches (0.0 and -0.0 are equal)
+    float PositionTolerance = 0.0f;
+    float ColorTolerance = 0.0f;
+    // Triangles whose corners welded together are dropped; their vertices stay
+    bool RemoveDegenerateTriangles = true;
+    // log2 of the partition count; 0 picks about 16K vertices per partition
+    uint32_t PartitionBits = 0;
+};
+
+struct VertexWeldStats
+{
+    uint32_t UniqueVertices = 0;
+    uint32_t DegenerateTriangles = 0;
+    uint32_t Partitions = 0;
+    uint64_t TemporaryBytes = 0;        // Peak working memory besides the soup and the output mesh
+    double HashMs = 0.0;
+    double PartitionMs = 0.0;
+    double WeldMs = 0.0;
+    double OutputMs = 0.0;
+};
+
+// Welds vertexCount soup vertices (a trailing partial triangle is ignored) into mesh.
+// jobSystem may be null to weld on the calling thread. Fails only when the soup has
+// more vertices than 32-bit indices address.
+bool WeldVertices(const Vertex* vertices, size_t vertexCount, const VertexWeldOptions& options,
+    JobSystem* jobSystem, MeshData* mesh, VertexWeldStats* stats = nullptr);
@@ -0,0 +1,112 @@
+#include "WVPScene.h"
+
+#include <iterator>
+
+#include "Vertex.h"
+
+namespace
+{
+    const Vertex SquareVertices[] =
+    {
+        { { -0.5f, -0.5f, 0.5f }, { 1.0f, 0.0f, 0.0f, 1.0f } },
+        { { -0.5f,  0.5f, 0.5f }, { 0.0f, 1.0f, 0.0f, 1.0f } },
+        { {  0.5f,  0.5f, 0.5f }, { 0.0f, 0.0f, 1.0f, 1.0f } },
+        { {  0.5f, -0.5f, 0.5f }, { 1.0f, 1.0f, 0.0f, 1.0f } },
+    };
+
+    const uint16_t SquareIndices[] =
+    {
+        0, 1, 2,
+        0, 2, 3,
+    };
+}
+
+bool WVPScene::Initialize(RenderDevice& device)
+{
+    m_Device = &device;
+
+    // Create the shaders and input layout
+    ShaderDesc vsDesc = { "Effects.fx", "VS", "vs_5_0", { std::begin(VertexInputLayout), std::end(VertexInputLayout) } };
+    if (!device.CreateVertexShader(vsDesc, &m_VertexShader))
+        return false;
+
+    ShaderDesc psDesc = { "Effects.fx", "PS", "ps_5_0", {} };
+    if (!device.CreatePixelShader(psDesc, &m_PixelShader))
+        return false;
+
+    // Create vertex and index buffers
+    BufferDesc bd;
+    bd.ByteWidth = sizeof(SquareVertices);
+    bd.Bind = BufferBind::VertexBuffer;
+    if (!device.CreateBuffer(bd, SquareVertices, &m_VertexBuffer))
+        return false;
+
+    bd.ByteWidth = sizeof(SquareIndices);
+    bd.Bind = BufferBind::IndexBuffer;
+    if (!device.CreateBuffer(bd, SquareIndices, &m_IndexBuffer))
+        return false;
+
+    // Initialize the view matrix
+    m_View = MatrixLookAtLH({ 0.0f, 1.0f, -5.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, 1.0f, 0.0f });
+
+    Resize(device.GetWidth(), device.GetHeight());
+    return true;
+}
+
+void WVPScene::Resize(uint32_t width, uint32_t height)
+{
+    if (width == 0 || height == 0)
+        return;
+
+    m_Viewport = m_Device->GetDefaultViewport();
+    m_Projection = MatrixPerspectiveFovLH(MathPiDiv2, width / static_cast<float>(height), 0.01f, 100.0f);
+}
+
+void WVPScene::Update(float t)
+{
+    // Rotate the camera, a fixed step per frame like the tutorial
+    m_CameraRotationAngle += 0.001f;
+    if (m_CameraRotationAngle > MathTwoPi)
+        m_CameraRotationAngle -= MathTwoPi;
+
+    float radius = 5.0f;
+    Float3 eye = { radius * std::sin(m_CameraRotationAngle), 2.0f, radius * std::cos(m_CameraRotationAngle) };
+    m_View = MatrixLookAtLH(eye, { 0.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f });
+
+    // Update the WVP matrix
+    m_WVP = m_World * m_View * m_Projection;
+
+    // Update Additional Colors
+    m_AdditionalColor.x = (std::sin(t) + 1.0f) * 0.5f;        // Red
+    m_AdditionalColor.y = (std::cos(t) + 1.0f) * 0.5f;        // Green
+    m_AdditionalColor.z = (std::sin(2.0f * t) + 1.0f) * 0.5f; // Blue
+    m_AdditionalColor.w = 1.0f;                               // Alpha
+}
+
+void WVPScene::Draw(RenderContext& context)
+{
+    float clearColor[4] = { 0.0f, 0.125f, 0.3f, 1.0f }; // RGBA
+    context.ClearRenderTarget(clearColor);
+    context.ClearDepthStencil(1.0f, 0);
+    context.SetViewport(m_Viewport);
+
+    context.SetVertexBuffer(0, m_VertexBuffer, sizeof(Vertex), 0);
+    context.SetIndexBuffer(m_IndexBuffer, Format::R16UInt, 0);
+
+    // Update constant buffer
+    ConstantBuffer cb;
+    cb.mWVP = MatrixTranspose(m_WVP);
+    cb.additionalColor = m_AdditionalColor;
+    ConstantBufferRange constants = context.AllocateConstants(&cb, sizeof(cb));
+
+    // Set vertex shader and constant buffer
+    context.SetVertexShader(m_VertexShader);
+    context.SetVSConstantBufferRange(0, constants);
+
+    // Set pixel shader and constant buffer
+    context.SetPixelShader(m_PixelShader);
+    context.SetPSConstantBufferRange(0, constants);
+
+    // Draw the square
+    context.DrawIndexed(6, 0, 0);
+}
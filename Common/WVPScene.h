@@ -0,0 +1,40 @@
+#pragma once
+
+// "08. World View and Local Spaces" exercise: a colored square seen by a camera
+// orbiting around it, tinted by a color that cycles over time. The tint is read
+// by the pixel shader, so the software backend draws the untinted square.
+
+#include "MathUtil.h"
+#include "Scene.h"
+
+class WVPScene final : public Scene
+{
+public:
+    const char* GetName() const override { return "WVP"; }
+
+    bool Initialize(RenderDevice& device) override;
+    void Resize(uint32_t width, uint32_t height) override;
+    void Update(float t) override;
+    void Draw(RenderContext& context) override;
+
+private:
+    struct ConstantBuffer
+    {
+        Float4x4 mWVP;
+        Float4 additionalColor;
+    };
+
+    RenderDevice* m_Device = nullptr;
+    VertexShaderHandle m_VertexShader;
+    PixelShaderHandle m_PixelShader;
+    BufferHandle m_VertexBuffer;
+    BufferHandle m_IndexBuffer;
+
+    Float4x4 m_World = MatrixIdentity();
+    Float4x4 m_View = MatrixIdentity();
+    Float4x4 m_Projection = MatrixIdentity();
+    Float4x4 m_WVP = MatrixIdentity();
+    Float4 m_AdditionalColor = { 0.0f, 0.0f, 0.0f, 0.0f };
+    float m_CameraRotationAngle = 0.0f;
+    Viewport m_Viewport;
+};